@@ -27,11 +27,43 @@
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
+/* TinyLFU frequency sketch. A count-min sketch with saturating 4 bit counts
+ * (stored in a byte each). Counts are halved periodically so the sketch tracks
+ * recent popularity instead of all time popularity. */
+#define M_CACHE_SKETCH_DEPTH     4
+#define M_CACHE_SKETCH_MAX_COUNT 15
+#define M_CACHE_SKETCH_MAX_WIDTH (1 << 24)
+
+typedef struct {
+	M_uint8  *counts;      /* M_CACHE_SKETCH_DEPTH rows of width counts. */
+	size_t    width;       /* Always a power of 2. */
+	size_t    additions;   /* Increments since the last halving. */
+	size_t    sample_size; /* Number of additions before halving. */
+	M_uint32  seed;
+} M_cache_sketch_t;
+
+/* Which list an entry is in. LRU only uses the window. */
+typedef enum {
+	M_CACHE_SEGMENT_WINDOW = 0,
+	M_CACHE_SEGMENT_PROBATION,
+	M_CACHE_SEGMENT_PROTECTED
+} M_cache_segment_t;
+
 struct M_cache {
 	M_hashtable_t          *kv_table; /* key -> llist_node. Pointers only, never copies or desroys. */
-	M_llist_t              *value_list; /* llist of cache_values. Never destroys. */
+	M_llist_t              *value_list; /* llist of cache_values. Never destroys. With TinyLFU this is the window. */
+	M_llist_t              *probation_list; /* TinyLFU main area entries seen once since admission. */
+	M_llist_t              *protected_list; /* TinyLFU main area entries seen more than once. */
+	M_cache_sketch_t        sketch;
+	M_hashtable_hash_func   key_hash;
+	M_uint32                flags;
 	size_t                  max_size;
-	size_t                  size;
+	size_t                  window_max; /* TinyLFU window size. */
+	size_t                  protected_max; /* TinyLFU protected size. */
+	size_t                  max_cost; /* 0 is unlimited. */
+	size_t                  cost;
+	M_uint64                default_ttl_ms;
+	M_cache_stats_t         stats;
 	M_cache_duplicate_func  key_duplicate;
 	M_cache_free_func       key_free;
 	M_cache_duplicate_func  value_duplicate;
@@ -39,13 +71,167 @@ struct M_cache {
 };
 
 typedef struct {
-	void *key; /* Key, kv_table's key points to this. */
-	void *value;
+	void              *key; /* Key, kv_table's key points to this. */
+	void              *value;
+	size_t             cost;
+	M_uint64           expire_ms; /* Monotonic time the entry expires. 0 never expires. */
+	M_cache_segment_t  segment;
 } M_cache_value_t;
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-static M_cache_value_t *M_cache_value_create(const M_cache_t *c, const void *key, const void *value)
+static M_uint64 M_cache_now_ms(void)
+{
+	M_timeval_t tv;
+
+	/* Elapsed start is monotonic so TTLs aren't affected by wall clock changes. */
+	M_time_elapsed_start(&tv);
+	return ((M_uint64)tv.tv_sec * 1000) + ((M_uint64)tv.tv_usec / 1000);
+}
+
+static M_bool M_cache_value_expired(const M_cache_value_t *cval, M_uint64 now_ms)
+{
+	return cval->expire_ms != 0 && cval->expire_ms <= now_ms;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static void M_cache_sketch_resize(M_cache_sketch_t *sketch, size_t max_size)
+{
+	size_t width;
+
+	width = M_size_t_round_up_to_power_of_two(max_size);
+	if (width < 16)
+		width = 16;
+	if (width > M_CACHE_SKETCH_MAX_WIDTH)
+		width = M_CACHE_SKETCH_MAX_WIDTH;
+
+	M_free(sketch->counts);
+	sketch->counts      = M_malloc_zero(width * M_CACHE_SKETCH_DEPTH);
+	sketch->width       = width;
+	sketch->additions   = 0;
+	sketch->sample_size = width * 10;
+}
+
+static void M_cache_sketch_indexes(const M_cache_t *c, const void *key, size_t *idx)
+{
+	M_uint32 h1;
+	M_uint32 h2;
+	size_t   i;
+
+	/* Double hashing to get an independent enough index per row. */
+	h1 = c->key_hash(key, c->sketch.seed);
+	h2 = (h1 * 0x9E3779B1) | 1;
+	for (i=0; i<M_CACHE_SKETCH_DEPTH; i++) {
+		idx[i] = (i * c->sketch.width) + ((h1 + ((M_uint32)i * h2)) & (c->sketch.width - 1));
+	}
+}
+
+static M_uint8 M_cache_sketch_frequency(const M_cache_t *c, const void *key)
+{
+	size_t  idx[M_CACHE_SKETCH_DEPTH];
+	M_uint8 freq = M_CACHE_SKETCH_MAX_COUNT;
+	size_t  i;
+
+	M_cache_sketch_indexes(c, key, idx);
+	for (i=0; i<M_CACHE_SKETCH_DEPTH; i++) {
+		if (c->sketch.counts[idx[i]] < freq) {
+			freq = c->sketch.counts[idx[i]];
+		}
+	}
+	return freq;
+}
+
+static void M_cache_sketch_increment(M_cache_t *c, const void *key)
+{
+	size_t  idx[M_CACHE_SKETCH_DEPTH];
+	M_uint8 freq = M_CACHE_SKETCH_MAX_COUNT;
+	size_t  i;
+
+	M_cache_sketch_indexes(c, key, idx);
+	for (i=0; i<M_CACHE_SKETCH_DEPTH; i++) {
+		if (c->sketch.counts[idx[i]] < freq) {
+			freq = c->sketch.counts[idx[i]];
+		}
+	}
+	if (freq == M_CACHE_SKETCH_MAX_COUNT)
+		return;
+
+	/* Conservative update, only raise the counts that are the minimum. */
+	for (i=0; i<M_CACHE_SKETCH_DEPTH; i++) {
+		if (c->sketch.counts[idx[i]] == freq) {
+			c->sketch.counts[idx[i]]++;
+		}
+	}
+
+	c->sketch.additions++;
+	if (c->sketch.additions >= c->sketch.sample_size) {
+		for (i=0; i<c->sketch.width * M_CACHE_SKETCH_DEPTH; i++) {
+			c->sketch.counts[i] >>= 1;
+		}
+		c->sketch.additions /= 2;
+	}
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static M_llist_t *M_cache_segment_list(const M_cache_t *c, M_cache_segment_t segment)
+{
+	switch (segment) {
+		case M_CACHE_SEGMENT_WINDOW:
+			break;
+		case M_CACHE_SEGMENT_PROBATION:
+			return c->probation_list;
+		case M_CACHE_SEGMENT_PROTECTED:
+			return c->protected_list;
+	}
+	return c->value_list;
+}
+
+/* Move an entry to the front of another segment. Returns the new node. */
+static M_llist_node_t *M_cache_segment_move(M_cache_t *c, M_llist_node_t *bucket, M_cache_segment_t segment)
+{
+	M_cache_value_t *cval;
+
+	cval          = M_llist_take_node(bucket);
+	cval->segment = segment;
+	bucket        = M_llist_insert_first(M_cache_segment_list(c, segment), cval);
+	/* Key is the same pointer so this only updates the node. */
+	M_hashtable_insert(c->kv_table, cval->key, bucket);
+	return bucket;
+}
+
+static void M_cache_calc_segments(M_cache_t *c)
+{
+	size_t main_max;
+
+	/* Window is 1% of the cache and the protected segment is 80% of the rest. */
+	c->window_max = c->max_size / 100;
+	if (c->window_max == 0)
+		c->window_max = 1;
+	main_max         = c->max_size > c->window_max ? c->max_size - c->window_max : 0;
+	c->protected_max = main_max - (main_max / 5);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static void M_cache_value_set(M_cache_t *c, M_cache_value_t *cval, const void *value, size_t cost, M_uint64 ttl_ms)
+{
+	if (c->value_duplicate != NULL && value != NULL) {
+		cval->value = c->value_duplicate(value);
+	} else {
+		cval->value = M_CAST_OFF_CONST(void *, value);
+	}
+
+	cval->cost      = cost;
+	cval->expire_ms = 0;
+	if (ttl_ms != 0)
+		cval->expire_ms = M_cache_now_ms() + ttl_ms;
+
+	c->cost += cost;
+}
+
+static M_cache_value_t *M_cache_value_create(M_cache_t *c, const void *key, const void *value, size_t cost, M_uint64 ttl_ms)
 {
 	M_cache_value_t *cval;
 
@@ -57,17 +243,14 @@ static M_cache_value_t *M_cache_value_create(const M_cache_t *c, const void *key
 		cval->key = M_CAST_OFF_CONST(void *, key);
 	}
 
-	if (c->value_duplicate != NULL) {
-		cval->value = c->value_duplicate(key);
-	} else {
-		cval->value = M_CAST_OFF_CONST(void *, value);
-	}
-
+	M_cache_value_set(c, cval, value, cost, ttl_ms);
 	return cval;
 }
 
-static void M_cache_value_destroy(const M_cache_t *c, M_cache_value_t *cval, M_bool destroy_container)
+static void M_cache_value_destroy(M_cache_t *c, M_cache_value_t *cval, M_bool destroy_container)
 {
+	c->cost -= cval->cost;
+
 	if (c->key_free != NULL)
 		c->key_free(cval->key);
 
@@ -81,14 +264,127 @@ static void M_cache_value_destroy(const M_cache_t *c, M_cache_value_t *cval, M_b
 	}
 }
 
+static void M_cache_remove_node(M_cache_t *c, M_llist_node_t *bucket)
+{
+	M_cache_value_t *cval;
+
+	cval = M_llist_take_node(bucket);
+	M_hashtable_remove(c->kv_table, cval->key, M_FALSE);
+	M_cache_value_destroy(c, cval, M_TRUE);
+}
+
+/* Remove an entry to make room, counting why it went away. */
+static void M_cache_evict_node(M_cache_t *c, M_llist_node_t *bucket)
+{
+	if (M_cache_value_expired(M_llist_node_val(bucket), M_cache_now_ms())) {
+		c->stats.expirations++;
+	} else {
+		c->stats.evictions++;
+	}
+	M_cache_remove_node(c, bucket);
+}
+
+/* The entry that would be evicted next. For TinyLFU this is the least valuable
+ * entry of the main area, falling back to the window. */
+static M_llist_node_t *M_cache_victim(const M_cache_t *c)
+{
+	M_llist_node_t *bucket = NULL;
+
+	if (c->flags & M_CACHE_POLICY_TINYLFU) {
+		bucket = M_llist_last(c->probation_list);
+		if (bucket == NULL) {
+			bucket = M_llist_last(c->protected_list);
+		}
+	}
+	if (bucket == NULL)
+		bucket = M_llist_last(c->value_list);
+	return bucket;
+}
+
+static void M_cache_evict(M_cache_t *c)
+{
+	M_llist_node_t *bucket;
+
+	bucket = M_cache_victim(c);
+	if (bucket == NULL)
+		return;
+	M_cache_evict_node(c, bucket);
+}
+
+/* Move the oldest window entry into the main area if it's more popular than what
+ * it would replace. Otherwise it's evicted. */
+static void M_cache_tinylfu_admit(M_cache_t *c)
+{
+	M_llist_node_t  *candidate;
+	M_llist_node_t  *victim;
+	M_cache_value_t *cval_candidate;
+	M_cache_value_t *cval_victim;
+	size_t           main_len;
+	M_uint64         now_ms;
+
+	while (M_llist_len(c->value_list) > c->window_max) {
+		candidate = M_llist_last(c->value_list);
+		main_len  = M_llist_len(c->probation_list) + M_llist_len(c->protected_list);
+
+		if (main_len + c->window_max < c->max_size) {
+			M_cache_segment_move(c, candidate, M_CACHE_SEGMENT_PROBATION);
+			continue;
+		}
+
+		victim = M_llist_last(c->probation_list);
+		if (victim == NULL)
+			victim = M_llist_last(c->protected_list);
+		if (victim == NULL) {
+			M_cache_evict_node(c, candidate);
+			continue;
+		}
+
+		cval_candidate = M_llist_node_val(candidate);
+		cval_victim    = M_llist_node_val(victim);
+		now_ms         = M_cache_now_ms();
+
+		/* Expired entries always lose. Ties go to the victim so a scan of
+		 * never before seen keys can't push out anything. */
+		if (!M_cache_value_expired(cval_candidate, now_ms) &&
+			(M_cache_value_expired(cval_victim, now_ms) ||
+			 M_cache_sketch_frequency(c, cval_candidate->key) > M_cache_sketch_frequency(c, cval_victim->key)))
+		{
+			M_cache_evict_node(c, victim);
+			M_cache_segment_move(c, candidate, M_CACHE_SEGMENT_PROBATION);
+		} else {
+			M_cache_evict_node(c, candidate);
+		}
+	}
+}
+
+/* A hit in the main area promotes the entry to protected. */
+static void M_cache_tinylfu_touch(M_cache_t *c, M_llist_node_t *bucket)
+{
+	M_cache_value_t *cval = M_llist_node_val(bucket);
+	M_llist_node_t  *demote;
+
+	switch (cval->segment) {
+		case M_CACHE_SEGMENT_WINDOW:
+		case M_CACHE_SEGMENT_PROTECTED:
+			M_llist_set_first(bucket);
+			return;
+		case M_CACHE_SEGMENT_PROBATION:
+			break;
+	}
+
+	M_cache_segment_move(c, bucket, M_CACHE_SEGMENT_PROTECTED);
+	while (M_llist_len(c->protected_list) > c->protected_max) {
+		demote = M_llist_last(c->protected_list);
+		M_cache_segment_move(c, demote, M_CACHE_SEGMENT_PROBATION);
+	}
+}
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 M_cache_t *M_cache_create(size_t max_size, M_hashtable_hash_func key_hash, M_sort_compar_t key_equality, M_uint32 flags, const struct M_cache_callbacks *callbacks)
 {
 	M_cache_t *c;
 
-	(void)flags;
-
 	c = M_malloc_zero(sizeof(*c));
 
 	c->kv_table = M_hashtable_create(16, 75, key_hash, key_equality, M_HASHTABLE_NONE, NULL);
@@ -97,8 +393,13 @@ M_cache_t *M_cache_create(size_t max_size, M_hashtable_hash_func key_hash, M_sor
 		return NULL;
 	}
 
-	c->value_list = M_llist_create(NULL, M_LLIST_NONE);
-	if (c->value_list == NULL) {
+	c->value_list     = M_llist_create(NULL, M_LLIST_NONE);
+	c->probation_list = M_llist_create(NULL, M_LLIST_NONE);
+	c->protected_list = M_llist_create(NULL, M_LLIST_NONE);
+	if (c->value_list == NULL || c->probation_list == NULL || c->protected_list == NULL) {
+		M_llist_destroy(c->value_list, M_FALSE);
+		M_llist_destroy(c->probation_list, M_FALSE);
+		M_llist_destroy(c->protected_list, M_FALSE);
 		M_hashtable_destroy(c->kv_table, M_TRUE);
 		M_free(c);
 		return NULL;
@@ -111,93 +412,139 @@ M_cache_t *M_cache_create(size_t max_size, M_hashtable_hash_func key_hash, M_sor
 		c->value_free      = callbacks->value_free;
 	}
 
+	if (key_hash == NULL)
+		key_hash = M_hash_func_hash_vp;
+
+	c->key_hash = key_hash;
+	c->flags    = flags;
 	c->max_size = max_size;
+	if (flags & M_CACHE_POLICY_TINYLFU) {
+		c->sketch.seed = (M_uint32)M_rand_range(NULL, 1, (M_uint64)(M_UINT32_MAX)+1);
+		M_cache_sketch_resize(&c->sketch, max_size);
+		M_cache_calc_segments(c);
+	}
 	return c;
 }
 
 void M_cache_destroy(M_cache_t *c)
 {
+	M_llist_t      *lists[3];
 	M_llist_node_t *bucket;
+	size_t          i;
 
 	if (c == NULL)
 		return;
 
 	M_hashtable_destroy(c->kv_table, M_FALSE);
 
-	bucket = M_llist_first(c->value_list);
-	while (bucket != NULL) {
-		M_cache_value_destroy(c, M_llist_take_node(bucket), M_TRUE);
-		bucket = M_llist_first(c->value_list);
+	lists[0] = c->value_list;
+	lists[1] = c->probation_list;
+	lists[2] = c->protected_list;
+	for (i=0; i<sizeof(lists)/sizeof(*lists); i++) {
+		bucket = M_llist_first(lists[i]);
+		while (bucket != NULL) {
+			M_cache_value_destroy(c, M_llist_take_node(bucket), M_TRUE);
+			bucket = M_llist_first(lists[i]);
+		}
+		M_llist_destroy(lists[i], M_FALSE);
 	}
-	M_llist_destroy(c->value_list, M_FALSE);
 
+	M_free(c->sketch.counts);
 	M_free(c);
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 M_bool M_cache_insert(M_cache_t *c, const void *key, const void *value)
+{
+	if (c == NULL)
+		return M_FALSE;
+	return M_cache_insert_ex(c, key, value, 0, c->default_ttl_ms);
+}
+
+M_bool M_cache_insert_ex(M_cache_t *c, const void *key, const void *value, size_t cost, M_uint64 ttl_ms)
 {
 	M_llist_node_t  *bucket = NULL;
 	M_cache_value_t *cval   = NULL;
-	M_bool           newval = M_FALSE;
 
 	if (c == NULL || key == NULL || c->max_size == 0)
 		return M_FALSE;
 
+	/* Could never fit. */
+	if (c->max_cost != 0 && cost > c->max_cost)
+		return M_FALSE;
+
+	if (c->flags & M_CACHE_POLICY_TINYLFU)
+		M_cache_sketch_increment(c, key);
+
 	/* Try to get an existing bucket if the key already exists. */
 	if (!M_hashtable_get(c->kv_table, key, (void **)&bucket))
 		bucket = NULL;
 
-	if (bucket == NULL) {
-		if (M_llist_len(c->value_list) == c->max_size) {
-			/* Out of space, reuse the coldest bucket. */
-			bucket = M_llist_last(c->value_list);
-			cval   = M_llist_node_val(bucket);
-
-			/* Remove the bucket for the cval from the hashtable. */
-			M_hashtable_remove(c->kv_table, cval->key, M_FALSE);
-			/* Clear the contents of the value (in bucket). */
-			M_cache_value_destroy(c, cval, M_FALSE);
-
-			/* Add the key. */
-			if (c->key_duplicate != NULL) {
-				cval->key = c->key_duplicate(key);
-			} else {
-				cval->key = M_CAST_OFF_CONST(void *, key);
-			}
+	if (bucket != NULL) {
+		/* Key matches a bucket so we only need to replace the value. */
+		cval     = M_llist_node_val(bucket);
+		c->cost -= cval->cost;
+		if (c->value_free != NULL) {
+			c->value_free(cval->value);
+		}
+		M_cache_value_set(c, cval, value, cost, ttl_ms);
+
+		if (c->flags & M_CACHE_POLICY_TINYLFU) {
+			M_cache_tinylfu_touch(c, bucket);
 		} else {
-			/* Still have space so we need to create a new bucket. */
-			cval   = M_cache_value_create(c, key, value);
-			bucket = M_llist_insert_first(c->value_list, cval);
-			newval = M_TRUE;
+			M_llist_set_first(bucket);
 		}
+	} else if (c->flags & M_CACHE_POLICY_TINYLFU) {
+		/* New entries always start in the window. Whatever falls out of
+		 * the window has to compete for a spot in the main area. */
+		cval          = M_cache_value_create(c, key, value, cost, ttl_ms);
+		cval->segment = M_CACHE_SEGMENT_WINDOW;
+		bucket        = M_llist_insert_first(c->value_list, cval);
 		M_hashtable_insert(c->kv_table, cval->key, bucket);
-	} else {
-		/* Key matches a bucket so we only need to clear the value. */
-		cval = M_llist_node_val(bucket);
-		if (c->value_free != NULL) {
-			c->value_free(cval->value);
+		M_cache_tinylfu_admit(c);
+	} else if (M_llist_len(c->value_list) == c->max_size) {
+		/* Out of space, reuse the coldest bucket. */
+		bucket = M_llist_last(c->value_list);
+		cval   = M_llist_node_val(bucket);
+		if (M_cache_value_expired(cval, M_cache_now_ms())) {
+			c->stats.expirations++;
+		} else {
+			c->stats.evictions++;
 		}
-	}
 
-	if (!newval) {
-		/* Update bucket data value. */
-		if (c->value_duplicate != NULL && value != NULL) {
-			cval->value = c->value_duplicate(key);
+		/* Remove the bucket for the cval from the hashtable. */
+		M_hashtable_remove(c->kv_table, cval->key, M_FALSE);
+		/* Clear the contents of the value (in bucket). */
+		M_cache_value_destroy(c, cval, M_FALSE);
+
+		/* Add the key. */
+		if (c->key_duplicate != NULL) {
+			cval->key = c->key_duplicate(key);
 		} else {
-			cval->value = M_CAST_OFF_CONST(void *, value);
+			cval->key = M_CAST_OFF_CONST(void *, key);
 		}
+		M_cache_value_set(c, cval, value, cost, ttl_ms);
+		M_hashtable_insert(c->kv_table, cval->key, bucket);
+		M_llist_set_first(bucket);
+	} else {
+		/* Still have space so we need to create a new bucket. */
+		cval   = M_cache_value_create(c, key, value, cost, ttl_ms);
+		bucket = M_llist_insert_first(c->value_list, cval);
+		M_hashtable_insert(c->kv_table, cval->key, bucket);
 	}
 
-	M_llist_set_first(bucket);
+	/* The entry fits by itself so this will stop before removing it unless
+	 * it's the least valuable entry under TinyLFU. */
+	while (c->max_cost != 0 && c->cost > c->max_cost)
+		M_cache_evict(c);
+
 	return M_TRUE;
 }
 
 M_bool M_cache_remove(M_cache_t *c, const void *key)
 {
 	M_llist_node_t  *bucket = NULL;
-	M_cache_value_t *cval   = NULL;
 
 	if (c == NULL || key == NULL)
 		return M_FALSE;
@@ -205,35 +552,84 @@ M_bool M_cache_remove(M_cache_t *c, const void *key)
 	if (!M_hashtable_get(c->kv_table, key, (void **)&bucket))
 		return M_FALSE;
 
-	cval = M_llist_take_node(bucket);
-	M_hashtable_remove(c->kv_table, key, M_FALSE);
-	M_cache_value_destroy(c, cval, M_TRUE);
-
+	M_cache_remove_node(c, bucket);
 	return M_TRUE;
 }
 
 M_bool M_cache_get(const M_cache_t *c, const void *key, void **value)
 {
+	/* Gets update hotness, expire entries and count hits so the cache does change. */
+	M_cache_t       *cm     = M_CAST_OFF_CONST(M_cache_t *, c);
 	M_llist_node_t  *bucket = NULL;
 	M_cache_value_t *cval   = NULL;
 
 	if (c == NULL || key == NULL)
 		return M_FALSE;
 
-	if (!M_hashtable_get(c->kv_table, key, (void **)&bucket))
+	/* Misses count too so keys that keep being requested get admitted. */
+	if (c->flags & M_CACHE_POLICY_TINYLFU)
+		M_cache_sketch_increment(cm, key);
+
+	if (!M_hashtable_get(c->kv_table, key, (void **)&bucket)) {
+		cm->stats.misses++;
+		return M_FALSE;
+	}
+
+	cval = M_llist_node_val(bucket);
+	if (M_cache_value_expired(cval, M_cache_now_ms())) {
+		cm->stats.misses++;
+		cm->stats.expirations++;
+		M_cache_remove_node(cm, bucket);
 		return M_FALSE;
+	}
 
-	M_llist_set_first(bucket);
+	cm->stats.hits++;
+	if (c->flags & M_CACHE_POLICY_TINYLFU) {
+		M_cache_tinylfu_touch(cm, bucket);
+	} else {
+		M_llist_set_first(bucket);
+	}
 
 	if (value == NULL)
 		return M_TRUE;
 
-	cval = M_llist_node_val(bucket);
 	*value = cval->value;
 
 	return M_TRUE;
 }
 
+size_t M_cache_expire(M_cache_t *c)
+{
+	M_llist_t      *lists[3];
+	M_llist_node_t *bucket;
+	M_llist_node_t *next;
+	M_uint64        now_ms;
+	size_t          cnt = 0;
+	size_t          i;
+
+	if (c == NULL)
+		return 0;
+
+	now_ms   = M_cache_now_ms();
+	lists[0] = c->value_list;
+	lists[1] = c->probation_list;
+	lists[2] = c->protected_list;
+	for (i=0; i<sizeof(lists)/sizeof(*lists); i++) {
+		bucket = M_llist_first(lists[i]);
+		while (bucket != NULL) {
+			next = M_llist_node_next(bucket);
+			if (M_cache_value_expired(M_llist_node_val(bucket), now_ms)) {
+				M_cache_remove_node(c, bucket);
+				cnt++;
+			}
+			bucket = next;
+		}
+	}
+
+	c->stats.expirations += cnt;
+	return cnt;
+}
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 size_t M_cache_size(const M_cache_t *c)
@@ -241,7 +637,7 @@ size_t M_cache_size(const M_cache_t *c)
 	if (c == NULL)
 		return 0;
 
-	return M_llist_len(c->value_list);
+	return M_llist_len(c->value_list) + M_llist_len(c->probation_list) + M_llist_len(c->protected_list);
 }
 
 size_t M_cache_max_size(const M_cache_t *c)
@@ -254,19 +650,79 @@ size_t M_cache_max_size(const M_cache_t *c)
 
 M_bool M_cache_set_max_size(M_cache_t *c, size_t max_size)
 {
-	M_llist_node_t  *bucket = NULL;
-	M_cache_value_t *cval   = NULL;
-
 	if (c == NULL)
 		return M_FALSE;
 
-	while (M_llist_len(c->value_list) > max_size) {
-		bucket = M_llist_last(c->value_list);
-		cval   = M_llist_take_node(bucket);
-		M_hashtable_remove(c->kv_table, cval->key, M_FALSE);
-		M_cache_value_destroy(c, cval, M_TRUE);
-	}
+	while (M_cache_size(c) > max_size)
+		M_cache_evict(c);
 
 	c->max_size = max_size;
+	if (c->flags & M_CACHE_POLICY_TINYLFU) {
+		/* Popularity is tracked for the new size from here on. */
+		M_cache_sketch_resize(&c->sketch, max_size);
+		M_cache_calc_segments(c);
+		while (M_llist_len(c->protected_list) > c->protected_max)
+			M_cache_segment_move(c, M_llist_last(c->protected_list), M_CACHE_SEGMENT_PROBATION);
+		while (M_llist_len(c->value_list) > c->window_max)
+			M_cache_segment_move(c, M_llist_last(c->value_list), M_CACHE_SEGMENT_PROBATION);
+	}
+	return M_TRUE;
+}
+
+size_t M_cache_cost(const M_cache_t *c)
+{
+	if (c == NULL)
+		return 0;
+
+	return c->cost;
+}
+
+size_t M_cache_max_cost(const M_cache_t *c)
+{
+	if (c == NULL)
+		return 0;
+
+	return c->max_cost;
+}
+
+M_bool M_cache_set_max_cost(M_cache_t *c, size_t max_cost)
+{
+	if (c == NULL)
+		return M_FALSE;
+
+	c->max_cost = max_cost;
+	while (c->max_cost != 0 && c->cost > c->max_cost)
+		M_cache_evict(c);
+
 	return M_TRUE;
 }
+
+void M_cache_set_default_ttl(M_cache_t *c, M_uint64 ttl_ms)
+{
+	if (c == NULL)
+		return;
+
+	c->default_ttl_ms = ttl_ms;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+void M_cache_stats(const M_cache_t *c, M_cache_stats_t *stats)
+{
+	if (stats == NULL)
+		return;
+
+	M_mem_set(stats, 0, sizeof(*stats));
+	if (c == NULL)
+		return;
+
+	M_mem_copy(stats, &c->stats, sizeof(*stats));
+}
+
+void M_cache_stats_reset(M_cache_t *c)
+{
+	if (c == NULL)
+		return;
+
+	M_mem_set(&c->stats, 0, sizeof(c->stats));
+}
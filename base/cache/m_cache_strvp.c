@@ -29,6 +29,7 @@ M_cache_strvp_t *M_cache_strvp_create(size_t max_size, M_uint32 flags, void (*de
 {
 	M_hashtable_hash_func    key_hash     = M_hash_func_hash_str;
 	M_sort_compar_t          key_equality = M_sort_compar_str;
+	M_cache_flags_t          cache_flags  = M_CACHE_NONE;
 	struct M_cache_callbacks callbacks = {
 		M_hash_void_strdup,
 		M_free,
@@ -42,7 +43,12 @@ M_cache_strvp_t *M_cache_strvp_create(size_t max_size, M_uint32 flags, void (*de
 		key_equality = M_sort_compar_str_casecmp;
 	}
 
-	return (M_cache_strvp_t *)M_cache_create(max_size, key_hash, key_equality, M_CACHE_NONE, &callbacks);
+	/* Cache options. */
+	if (flags & M_CACHE_STRVP_POLICY_TINYLFU) {
+		cache_flags |= M_CACHE_POLICY_TINYLFU;
+	}
+
+	return (M_cache_strvp_t *)M_cache_create(max_size, key_hash, key_equality, cache_flags, &callbacks);
 }
 
 void M_cache_strvp_destroy(M_cache_strvp_t *c)
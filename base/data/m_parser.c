@@ -165,46 +165,40 @@ static size_t M_parser_read_buf_mark_int(M_parser_t *parser, enum M_PARSER_MARKE
 }
 
 
-static size_t M_parser_consume_charset_int(M_parser_t *parser, const unsigned char *charset, size_t charset_len, M_bool inclusion)
+static size_t M_parser_consume_charset_compiled_int(M_parser_t *parser, const M_parser_charset_t *cs, M_bool inclusion)
 {
 	size_t len;
-	size_t i;
 
-	if (parser == NULL || charset == NULL || charset_len == 0)
+	if (parser == NULL || cs == NULL)
 		return 0;
 
-	for (len=0; len < parser->data_len; len++) {
-		for (i=0; i<charset_len; i++) {
-			if (parser->data[len] == charset[i])
-				break;
-		}
-		if (inclusion && i == charset_len)
-			break;
-		if (!inclusion && i != charset_len)
-			break;
-	}
+	len = M_parser_charset_span(cs, parser->data, parser->data_len, inclusion);
 
 	M_parser_consume(parser, len);
 	return len;
 }
 
-static size_t M_parser_read_bytes_charset_int(M_parser_t *parser, const unsigned char *charset, size_t charset_len, unsigned char *buf, size_t buf_len, M_bool inclusion)
+static size_t M_parser_consume_charset_int(M_parser_t *parser, const unsigned char *charset, size_t charset_len, M_bool inclusion)
 {
-	size_t cnt;
+	M_parser_charset_t cs;
 
-	if (parser == NULL || buf == NULL || buf_len == 0 || charset == NULL || charset_len == 0)
+	if (parser == NULL || charset == NULL || charset_len == 0)
+		return 0;
+
+	M_parser_charset_compile(&cs, charset, charset_len);
+	return M_parser_consume_charset_compiled_int(parser, &cs, inclusion);
+}
+
+static size_t M_parser_read_bytes_charset_compiled_int(M_parser_t *parser, const M_parser_charset_t *cs, unsigned char *buf, size_t buf_len, M_bool inclusion)
+{
+	if (parser == NULL || buf == NULL || buf_len == 0 || cs == NULL)
 		return 0;
 
 	/* Mark internal */
 	M_parser_mark_int(parser, M_PARSER_MARKED_INT);
 
 	/* Consume the charset */
-	if (inclusion) {
-		cnt = M_parser_consume_charset_int(parser, charset, charset_len, M_TRUE);
-	} else {
-		cnt = M_parser_consume_charset_int(parser, charset, charset_len, M_FALSE);
-	}
-	if (cnt == 0) {
+	if (M_parser_consume_charset_compiled_int(parser, cs, inclusion) == 0) {
 		M_parser_mark_clear_int(parser, M_PARSER_MARKED_INT);
 		return 0;
 	}
@@ -213,6 +207,17 @@ static size_t M_parser_read_bytes_charset_int(M_parser_t *parser, const unsigned
 	return M_parser_read_bytes_mark_int(parser, M_PARSER_MARKED_INT, buf, buf_len);
 }
 
+static size_t M_parser_read_bytes_charset_int(M_parser_t *parser, const unsigned char *charset, size_t charset_len, unsigned char *buf, size_t buf_len, M_bool inclusion)
+{
+	M_parser_charset_t cs;
+
+	if (parser == NULL || buf == NULL || buf_len == 0 || charset == NULL || charset_len == 0)
+		return 0;
+
+	M_parser_charset_compile(&cs, charset, charset_len);
+	return M_parser_read_bytes_charset_compiled_int(parser, &cs, buf, buf_len, inclusion);
+}
+
 static size_t M_parser_read_str_charset_int(M_parser_t *parser, const char *charset, char *buf, size_t buf_len, M_bool inclusion)
 {
 	size_t len;
@@ -234,23 +239,19 @@ static size_t M_parser_read_str_charset_int(M_parser_t *parser, const char *char
 	return len;
 }
 
-static char *M_parser_read_strdup_charset_int(M_parser_t *parser, const char *charset, M_bool inclusion)
+static char *M_parser_read_strdup_charset_compiled_int(M_parser_t *parser, const M_parser_charset_t *cs, M_bool inclusion)
 {
 	size_t len;
 	char  *out = NULL;
 
-	if (parser == NULL || charset == NULL || M_str_len(charset) == 0)
+	if (parser == NULL || cs == NULL)
 		return NULL;
 
 	/* Mark internal */
 	M_parser_mark_int(parser, M_PARSER_MARKED_INT);
 
 	/* Consume the charset */
-	if (inclusion) {
-		len = M_parser_consume_str_charset(parser, charset);
-	} else {
-		len = M_parser_consume_str_not_charset(parser, charset);
-	}
+	len = M_parser_consume_charset_compiled_int(parser, cs, inclusion);
 	if (len == 0) {
 		M_parser_mark_clear_int(parser, M_PARSER_MARKED_INT);
 		return NULL;
@@ -268,16 +269,27 @@ static char *M_parser_read_strdup_charset_int(M_parser_t *parser, const char *ch
 	return out;
 }
 
-static size_t M_parser_read_buf_charset_int(M_parser_t *parser, M_buf_t *buf, const unsigned char *charset, size_t charset_len, M_bool inclusion)
+static char *M_parser_read_strdup_charset_int(M_parser_t *parser, const char *charset, M_bool inclusion)
 {
-	if (parser == NULL || buf == NULL || charset == NULL || charset_len == 0)
+	M_parser_charset_t cs;
+
+	if (parser == NULL || charset == NULL || M_str_len(charset) == 0)
+		return NULL;
+
+	M_parser_charset_compile_str(&cs, charset);
+	return M_parser_read_strdup_charset_compiled_int(parser, &cs, inclusion);
+}
+
+static size_t M_parser_read_buf_charset_compiled_int(M_parser_t *parser, M_buf_t *buf, const M_parser_charset_t *cs, M_bool inclusion)
+{
+	if (parser == NULL || buf == NULL || cs == NULL)
 		return 0;
 
 	/* Mark internal */
 	M_parser_mark_int(parser, M_PARSER_MARKED_INT);
 
 	/* Consume the charset */
-	if (M_parser_consume_charset_int(parser, charset, charset_len, inclusion) == 0) {
+	if (M_parser_consume_charset_compiled_int(parser, cs, inclusion) == 0) {
 		M_parser_mark_clear_int(parser, M_PARSER_MARKED_INT);
 		return 0;
 	}
@@ -286,6 +298,17 @@ static size_t M_parser_read_buf_charset_int(M_parser_t *parser, M_buf_t *buf, co
 	return M_parser_read_buf_mark_int(parser, M_PARSER_MARKED_INT, buf);
 }
 
+static size_t M_parser_read_buf_charset_int(M_parser_t *parser, M_buf_t *buf, const unsigned char *charset, size_t charset_len, M_bool inclusion)
+{
+	M_parser_charset_t cs;
+
+	if (parser == NULL || buf == NULL || charset == NULL || charset_len == 0)
+		return 0;
+
+	M_parser_charset_compile(&cs, charset, charset_len);
+	return M_parser_read_buf_charset_compiled_int(parser, buf, &cs, inclusion);
+}
+
 static M_parser_t *M_parser_read_parser_mark_int(M_parser_t *parser, enum M_PARSER_MARKED_TYPE type)
 {
 	M_parser_t          *p;
@@ -821,23 +844,28 @@ size_t M_parser_truncate_until(M_parser_t *parser, const unsigned char *pat, siz
 
 size_t M_parser_truncate_charset(M_parser_t *parser, const unsigned char *charset, size_t charset_len)
 {
-	size_t i;
-	size_t j;
-	size_t v;
+	M_parser_charset_t cs;
 
 	if (parser == NULL || charset == NULL || charset_len == 0)
 		return 0;
 
-	for (i=parser->data_len, v=0; i-->0; v++) {
-		for (j=0; j<charset_len; j++) {
-			if (parser->data[i] == charset[j])
-				break;
-		}
-		if (j == charset_len)
-			break;
-	}
+	M_parser_charset_compile(&cs, charset, charset_len);
+	return M_parser_truncate_charset_compiled(parser, &cs);
+}
+
+
+size_t M_parser_truncate_charset_compiled(M_parser_t *parser, const M_parser_charset_t *cs)
+{
+	size_t len;
+	size_t v;
+
+	if (parser == NULL || cs == NULL)
+		return 0;
+
+	len = M_parser_charset_rspan(cs, parser->data, parser->data_len, M_TRUE);
+	v   = parser->data_len - len;
 
-	M_parser_truncate(parser, parser->data_len - v);
+	M_parser_truncate(parser, len);
 	return v;
 }
 
@@ -1091,6 +1119,18 @@ size_t M_parser_consume_str_not_charset(M_parser_t *parser, const char *charset)
 }
 
 
+size_t M_parser_consume_charset_compiled(M_parser_t *parser, const M_parser_charset_t *cs)
+{
+	return M_parser_consume_charset_compiled_int(parser, cs, M_TRUE);
+}
+
+
+size_t M_parser_consume_not_charset_compiled(M_parser_t *parser, const M_parser_charset_t *cs)
+{
+	return M_parser_consume_charset_compiled_int(parser, cs, M_FALSE);
+}
+
+
 size_t M_parser_consume_eol(M_parser_t *parser)
 {
 	size_t i;
@@ -1287,6 +1327,18 @@ size_t M_parser_read_bytes_not_charset(M_parser_t *parser, const unsigned char *
 }
 
 
+size_t M_parser_read_bytes_charset_compiled(M_parser_t *parser, const M_parser_charset_t *cs, unsigned char *buf, size_t buf_len)
+{
+	return M_parser_read_bytes_charset_compiled_int(parser, cs, buf, buf_len, M_TRUE);
+}
+
+
+size_t M_parser_read_bytes_not_charset_compiled(M_parser_t *parser, const M_parser_charset_t *cs, unsigned char *buf, size_t buf_len)
+{
+	return M_parser_read_bytes_charset_compiled_int(parser, cs, buf, buf_len, M_FALSE);
+}
+
+
 size_t M_parser_read_bytes_predicate(M_parser_t *parser, M_parser_predicate_func func, unsigned char *buf, size_t buf_len)
 {
 	if (parser == NULL || buf == NULL || buf_len == 0 || func == NULL)
@@ -1537,6 +1589,18 @@ char *M_parser_read_strdup_not_charset(M_parser_t *parser, const char *charset)
 }
 
 
+char *M_parser_read_strdup_charset_compiled(M_parser_t *parser, const M_parser_charset_t *cs)
+{
+	return M_parser_read_strdup_charset_compiled_int(parser, cs, M_TRUE);
+}
+
+
+char *M_parser_read_strdup_not_charset_compiled(M_parser_t *parser, const M_parser_charset_t *cs)
+{
+	return M_parser_read_strdup_charset_compiled_int(parser, cs, M_FALSE);
+}
+
+
 char *M_parser_read_strdup_predicate_max(M_parser_t *parser, M_parser_predicate_func func, size_t max)
 {
 	size_t len;
@@ -1994,6 +2058,16 @@ size_t M_parser_read_buf_not_charset(M_parser_t *parser, M_buf_t *buf, const uns
 	return M_parser_read_buf_charset_int(parser, buf, charset, charset_len, M_FALSE);
 }
 
+size_t M_parser_read_buf_charset_compiled(M_parser_t *parser, M_buf_t *buf, const M_parser_charset_t *cs)
+{
+	return M_parser_read_buf_charset_compiled_int(parser, buf, cs, M_TRUE);
+}
+
+size_t M_parser_read_buf_not_charset_compiled(M_parser_t *parser, M_buf_t *buf, const M_parser_charset_t *cs)
+{
+	return M_parser_read_buf_charset_compiled_int(parser, buf, cs, M_FALSE);
+}
+
 size_t M_parser_read_buf_predicate_max(M_parser_t *parser, M_buf_t *buf, M_parser_predicate_func func, size_t max)
 {
 	if (parser == NULL || buf == NULL || func == NULL || max == 0)
@@ -2060,27 +2134,24 @@ M_bool M_parser_is_chr_predicate(const M_parser_t *parser, size_t len, M_chr_pre
 
 M_bool M_parser_is_charset(const M_parser_t *parser, size_t len, const unsigned char *charset, size_t charset_len)
 {
-	size_t i;
-	size_t j;
+	M_parser_charset_t cs;
 
 	if (parser == NULL || len == 0 || charset == NULL || charset_len == 0)
 		return M_FALSE;
 
+	M_parser_charset_compile(&cs, charset, charset_len);
+	return M_parser_is_charset_compiled(parser, len, &cs);
+}
+
+M_bool M_parser_is_charset_compiled(const M_parser_t *parser, size_t len, const M_parser_charset_t *cs)
+{
+	if (parser == NULL || len == 0 || cs == NULL)
+		return M_FALSE;
+
 	if (len > parser->data_len)
 		len = parser->data_len;
 
-	for (i=0; i<len; i++) {
-		for (j=0; j<charset_len; j++) {
-			if (parser->data[i] == charset[j]) {
-				break;
-			}
-		}
-		if (j == charset_len) {
-			return M_FALSE;
-		}
-	}
-
-	return M_TRUE;
+	return M_parser_charset_span(cs, parser->data, len, M_TRUE) == len ? M_TRUE : M_FALSE;
 }
 
 M_bool M_parser_is_str_charset(const M_parser_t *parser, size_t len, const char *charset)
@@ -0,0 +1,348 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2026 Monetra Technologies, LLC.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "m_config.h"
+#include <mstdlib/mstdlib.h>
+#include "m_defs_int.h"
+#include "m_parser_int.h"
+#include "platform/m_cpu_int.h"
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* The set is a 256 bit bitmap laid out so it can be used directly as byte
+ * shuffle tables (Muła, "SIMD-ized faster parse of sets of bytes"). The low
+ * nibble of a byte and its top bit select one of 32 map bytes, bits 4-6 select
+ * the bit within it:
+ *
+ *   map[((c & 0x80) >> 3) | (c & 0x0F)] & (1 << ((c >> 4) & 0x07))
+ *
+ * For a vector of input the first 16 map bytes are shuffled by (c & 0x8F) and
+ * the last 16 by (c & 0x8F) ^ 0x80. A shuffle index with the top bit set gives
+ * 0, so exactly one of them returns the map byte. A third shuffle turns the
+ * high nibble into the bit to test. Every byte is checked in 3 shuffles no
+ * matter how many characters are in the set. */
+
+#define M_PARSER_CHARSET_IDX(c) ((((c) & 0x80) >> 3) | ((c) & 0x0F))
+#define M_PARSER_CHARSET_BIT(c) ((M_uint8)(1 << (((c) >> 4) & 0x07)))
+#define M_PARSER_CHARSET_HAS(cs, c) (((cs)->map[M_PARSER_CHARSET_IDX(c)] & M_PARSER_CHARSET_BIT(c)) != 0)
+
+#if defined(M_CPU_X86_DISPATCH) || (defined(M_CPU_NEON) && defined(__aarch64__))
+/* Indexed by the high nibble. */
+static const M_uint8 M_parser_charset_bits[16] = {
+	0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80,
+	0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80
+};
+#endif
+
+#if defined(M_CPU_X86_DISPATCH)
+
+M_CPU_TARGET("ssse3")
+static size_t M_parser_charset_span_ssse3(const M_parser_charset_t *cs, const unsigned char *s, size_t len, M_bool inclusion)
+{
+	const __m128i tbl_low  = _mm_loadu_si128((const __m128i *)(const void *)cs->map);
+	const __m128i tbl_high = _mm_loadu_si128((const __m128i *)(const void *)(cs->map + 16));
+	const __m128i bits     = _mm_loadu_si128((const __m128i *)(const void *)M_parser_charset_bits);
+	const __m128i idx_mask = _mm_set1_epi8((char)0x8F);
+	const __m128i top      = _mm_set1_epi8((char)0x80);
+	const __m128i nibble   = _mm_set1_epi8(0x0F);
+	M_uint32      want     = inclusion ? 0xFFFF : 0;
+	size_t        i        = 0;
+
+	for ( ; i + 16 <= len; i+=16) {
+		__m128i  in  = _mm_loadu_si128((const __m128i *)(const void *)(s + i));
+		__m128i  idx = _mm_and_si128(in, idx_mask);
+		__m128i  row = _mm_or_si128(_mm_shuffle_epi8(tbl_low, idx), _mm_shuffle_epi8(tbl_high, _mm_xor_si128(idx, top)));
+		__m128i  bit = _mm_shuffle_epi8(bits, _mm_and_si128(_mm_srli_epi16(in, 4), nibble));
+		M_uint32 end = (M_uint32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(row, bit), bit)) ^ want;
+
+		if (end != 0)
+			return i + M_CPU_CTZ32(end);
+	}
+
+	return i;
+}
+
+M_CPU_TARGET("ssse3")
+static size_t M_parser_charset_rspan_ssse3(const M_parser_charset_t *cs, const unsigned char *s, size_t len, M_bool inclusion)
+{
+	const __m128i tbl_low  = _mm_loadu_si128((const __m128i *)(const void *)cs->map);
+	const __m128i tbl_high = _mm_loadu_si128((const __m128i *)(const void *)(cs->map + 16));
+	const __m128i bits     = _mm_loadu_si128((const __m128i *)(const void *)M_parser_charset_bits);
+	const __m128i idx_mask = _mm_set1_epi8((char)0x8F);
+	const __m128i top      = _mm_set1_epi8((char)0x80);
+	const __m128i nibble   = _mm_set1_epi8(0x0F);
+	M_uint32      want     = inclusion ? 0xFFFF : 0;
+
+	for ( ; len >= 16; len-=16) {
+		__m128i  in  = _mm_loadu_si128((const __m128i *)(const void *)(s + len - 16));
+		__m128i  idx = _mm_and_si128(in, idx_mask);
+		__m128i  row = _mm_or_si128(_mm_shuffle_epi8(tbl_low, idx), _mm_shuffle_epi8(tbl_high, _mm_xor_si128(idx, top)));
+		__m128i  bit = _mm_shuffle_epi8(bits, _mm_and_si128(_mm_srli_epi16(in, 4), nibble));
+		M_uint32 end = (M_uint32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(row, bit), bit)) ^ want;
+
+		if (end != 0)
+			return len - 16 + M_CPU_MSB32(end) + 1;
+	}
+
+	return len;
+}
+
+M_CPU_TARGET("avx2")
+static size_t M_parser_charset_span_avx2(const M_parser_charset_t *cs, const unsigned char *s, size_t len, M_bool inclusion)
+{
+	const __m256i tbl_low  = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(const void *)cs->map));
+	const __m256i tbl_high = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(const void *)(cs->map + 16)));
+	const __m256i bits     = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(const void *)M_parser_charset_bits));
+	const __m256i idx_mask = _mm256_set1_epi8((char)0x8F);
+	const __m256i top      = _mm256_set1_epi8((char)0x80);
+	const __m256i nibble   = _mm256_set1_epi8(0x0F);
+	M_uint32      want     = inclusion ? 0xFFFFFFFF : 0;
+	size_t        i        = 0;
+
+	for ( ; i + 32 <= len; i+=32) {
+		__m256i  in  = _mm256_loadu_si256((const __m256i *)(const void *)(s + i));
+		__m256i  idx = _mm256_and_si256(in, idx_mask);
+		__m256i  row = _mm256_or_si256(_mm256_shuffle_epi8(tbl_low, idx), _mm256_shuffle_epi8(tbl_high, _mm256_xor_si256(idx, top)));
+		__m256i  bit = _mm256_shuffle_epi8(bits, _mm256_and_si256(_mm256_srli_epi16(in, 4), nibble));
+		M_uint32 end = (M_uint32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(row, bit), bit)) ^ want;
+
+		if (end != 0)
+			return i + M_CPU_CTZ32(end);
+	}
+
+	return i;
+}
+
+M_CPU_TARGET("avx2")
+static size_t M_parser_charset_rspan_avx2(const M_parser_charset_t *cs, const unsigned char *s, size_t len, M_bool inclusion)
+{
+	const __m256i tbl_low  = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(const void *)cs->map));
+	const __m256i tbl_high = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(const void *)(cs->map + 16)));
+	const __m256i bits     = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(const void *)M_parser_charset_bits));
+	const __m256i idx_mask = _mm256_set1_epi8((char)0x8F);
+	const __m256i top      = _mm256_set1_epi8((char)0x80);
+	const __m256i nibble   = _mm256_set1_epi8(0x0F);
+	M_uint32      want     = inclusion ? 0xFFFFFFFF : 0;
+
+	for ( ; len >= 32; len-=32) {
+		__m256i  in  = _mm256_loadu_si256((const __m256i *)(const void *)(s + len - 32));
+		__m256i  idx = _mm256_and_si256(in, idx_mask);
+		__m256i  row = _mm256_or_si256(_mm256_shuffle_epi8(tbl_low, idx), _mm256_shuffle_epi8(tbl_high, _mm256_xor_si256(idx, top)));
+		__m256i  bit = _mm256_shuffle_epi8(bits, _mm256_and_si256(_mm256_srli_epi16(in, 4), nibble));
+		M_uint32 end = (M_uint32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(row, bit), bit)) ^ want;
+
+		if (end != 0)
+			return len - 32 + M_CPU_MSB32(end) + 1;
+	}
+
+	return len;
+}
+
+#elif defined(M_CPU_NEON) && defined(__aarch64__)
+
+/* Table lookups with an index past the end give 0, same as a shuffle index
+ * with the top bit set. The match mask is narrowed to 4 bits per byte since
+ * there is no movemask. */
+static M_uint64 M_parser_charset_neon_match(uint8x16_t tbl_low, uint8x16_t tbl_high, uint8x16_t bits, uint8x16_t in)
+{
+	uint8x16_t idx = vandq_u8(in, vdupq_n_u8(0x8F));
+	uint8x16_t row = vorrq_u8(vqtbl1q_u8(tbl_low, idx), vqtbl1q_u8(tbl_high, veorq_u8(idx, vdupq_n_u8(0x80))));
+	uint8x16_t bit = vqtbl1q_u8(bits, vshrq_n_u8(in, 4));
+
+	return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(vtstq_u8(row, bit)), 4)), 0);
+}
+
+static size_t M_parser_charset_span_neon(const M_parser_charset_t *cs, const unsigned char *s, size_t len, M_bool inclusion)
+{
+	const uint8x16_t tbl_low  = vld1q_u8(cs->map);
+	const uint8x16_t tbl_high = vld1q_u8(cs->map + 16);
+	const uint8x16_t bits     = vld1q_u8(M_parser_charset_bits);
+	M_uint64         want     = inclusion ? 0xFFFFFFFFFFFFFFFFULL : 0;
+	size_t           i        = 0;
+
+	for ( ; i + 16 <= len; i+=16) {
+		M_uint64 end = M_parser_charset_neon_match(tbl_low, tbl_high, bits, vld1q_u8(s + i)) ^ want;
+
+		if (end != 0)
+			return i + (M_CPU_CTZ64(end) >> 2);
+	}
+
+	return i;
+}
+
+static size_t M_parser_charset_rspan_neon(const M_parser_charset_t *cs, const unsigned char *s, size_t len, M_bool inclusion)
+{
+	const uint8x16_t tbl_low  = vld1q_u8(cs->map);
+	const uint8x16_t tbl_high = vld1q_u8(cs->map + 16);
+	const uint8x16_t bits     = vld1q_u8(M_parser_charset_bits);
+	M_uint64         want     = inclusion ? 0xFFFFFFFFFFFFFFFFULL : 0;
+
+	for ( ; len >= 16; len-=16) {
+		M_uint64 end = M_parser_charset_neon_match(tbl_low, tbl_high, bits, vld1q_u8(s + len - 16)) ^ want;
+
+		if (end != 0)
+			return len - 16 + (M_CPU_MSB64(end) >> 2) + 1;
+	}
+
+	return len;
+}
+
+#endif
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+size_t M_parser_charset_span(const M_parser_charset_t *cs, const unsigned char *s, size_t len, M_bool inclusion)
+{
+	size_t i;
+
+	if (cs == NULL || s == NULL || len == 0)
+		return 0;
+
+	inclusion = inclusion ? M_TRUE : M_FALSE;
+
+#if defined(M_CPU_X86_DISPATCH)
+	if (M_cpu_has(M_CPU_FEATURE_AVX2)) {
+		i = M_parser_charset_span_avx2(cs, s, len, inclusion);
+	} else if (M_cpu_has(M_CPU_FEATURE_SSSE3)) {
+		i = M_parser_charset_span_ssse3(cs, s, len, inclusion);
+	} else {
+		i = 0;
+	}
+#elif defined(M_CPU_NEON) && defined(__aarch64__)
+	i = M_parser_charset_span_neon(cs, s, len, inclusion);
+#else
+	i = 0;
+#endif
+
+	/* Whatever is left is shorter than a vector or stops the run. */
+	for ( ; i < len; i++) {
+		if ((M_bool)M_PARSER_CHARSET_HAS(cs, s[i]) != inclusion) {
+			break;
+		}
+	}
+
+	return i;
+}
+
+size_t M_parser_charset_rspan(const M_parser_charset_t *cs, const unsigned char *s, size_t len, M_bool inclusion)
+{
+	size_t i;
+
+	if (cs == NULL || s == NULL || len == 0)
+		return len;
+
+	inclusion = inclusion ? M_TRUE : M_FALSE;
+
+#if defined(M_CPU_X86_DISPATCH)
+	if (M_cpu_has(M_CPU_FEATURE_AVX2)) {
+		i = M_parser_charset_rspan_avx2(cs, s, len, inclusion);
+	} else if (M_cpu_has(M_CPU_FEATURE_SSSE3)) {
+		i = M_parser_charset_rspan_ssse3(cs, s, len, inclusion);
+	} else {
+		i = len;
+	}
+#elif defined(M_CPU_NEON) && defined(__aarch64__)
+	i = M_parser_charset_rspan_neon(cs, s, len, inclusion);
+#else
+	i = len;
+#endif
+
+	for ( ; i > 0; i--) {
+		if ((M_bool)M_PARSER_CHARSET_HAS(cs, s[i-1]) != inclusion) {
+			break;
+		}
+	}
+
+	return i;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+void M_parser_charset_add(M_parser_charset_t *cs, const unsigned char *charset, size_t charset_len)
+{
+	size_t i;
+
+	if (cs == NULL || charset == NULL)
+		return;
+
+	for (i=0; i<charset_len; i++) {
+		cs->map[M_PARSER_CHARSET_IDX(charset[i])] |= M_PARSER_CHARSET_BIT(charset[i]);
+	}
+}
+
+void M_parser_charset_compile(M_parser_charset_t *cs, const unsigned char *charset, size_t charset_len)
+{
+	if (cs == NULL)
+		return;
+
+	M_mem_set(cs->map, 0, sizeof(cs->map));
+	M_parser_charset_add(cs, charset, charset_len);
+}
+
+void M_parser_charset_compile_str(M_parser_charset_t *cs, const char *charset)
+{
+	M_parser_charset_compile(cs, (const unsigned char *)charset, M_str_len(charset));
+}
+
+void M_parser_charset_compile_predicate(M_parser_charset_t *cs, M_parser_predicate_func func)
+{
+	size_t i;
+
+	if (cs == NULL)
+		return;
+
+	M_mem_set(cs->map, 0, sizeof(cs->map));
+	if (func == NULL)
+		return;
+
+	for (i=0; i<256; i++) {
+		if (func((unsigned char)i)) {
+			cs->map[M_PARSER_CHARSET_IDX(i)] |= M_PARSER_CHARSET_BIT(i);
+		}
+	}
+}
+
+void M_parser_charset_compile_chr_predicate(M_parser_charset_t *cs, M_chr_predicate_func func)
+{
+	size_t i;
+
+	if (cs == NULL)
+		return;
+
+	M_mem_set(cs->map, 0, sizeof(cs->map));
+	if (func == NULL)
+		return;
+
+	for (i=0; i<256; i++) {
+		if (func((char)i)) {
+			cs->map[M_PARSER_CHARSET_IDX(i)] |= M_PARSER_CHARSET_BIT(i);
+		}
+	}
+}
+
+M_bool M_parser_charset_contains(const M_parser_charset_t *cs, unsigned char c)
+{
+	if (cs == NULL)
+		return M_FALSE;
+	return M_PARSER_CHARSET_HAS(cs, c) ? M_TRUE : M_FALSE;
+}
@@ -55,6 +55,14 @@ struct M_parser {
 
 void M_parser_init(M_parser_t *parser, const unsigned char *buf, size_t len, M_uint32 flags);
 
+/* Length of the run at the start of s where every byte is (inclusion) or is
+ * not (!inclusion) in the set. */
+size_t M_parser_charset_span(const M_parser_charset_t *cs, const unsigned char *s, size_t len, M_bool inclusion);
+
+/* Start of the run at the end of s where every byte is (inclusion) or is not
+ * (!inclusion) in the set. */
+size_t M_parser_charset_rspan(const M_parser_charset_t *cs, const unsigned char *s, size_t len, M_bool inclusion);
+
 __END_DECLS
 
 #endif /* __M_PARSER_INT_H__ */
@@ -32,7 +32,7 @@ struct M_queue {
 };
 
 
-M_queue_t *M_queue_create(M_sort_compar_t sort_cb, void (*free_cb)(void *))
+M_queue_t *M_queue_create_ex(M_sort_compar_t sort_cb, void (*free_cb)(void *), M_uint32 flags)
 {
 	struct M_llist_callbacks callbacks = {
 		sort_cb, /* quality          */
@@ -40,14 +40,30 @@ M_queue_t *M_queue_create(M_sort_compar_t sort_cb, void (*free_cb)(void *))
 		NULL,    /* duplicate_copy   */
 		free_cb  /* value_free       */
 	};
-	M_queue_t *queue = M_malloc_zero(sizeof(*queue));
+	M_queue_t *queue       = M_malloc_zero(sizeof(*queue));
+	M_uint32   llist_flags = M_LLIST_NONE;
+	M_uint32   hash_flags  = M_HASHTABLE_NONE;
+
+	if (sort_cb)
+		llist_flags |= M_LLIST_SORTED;
 
-	queue->list      = M_llist_create((sort_cb || free_cb)?&callbacks:NULL, (sort_cb)?M_LLIST_SORTED:M_LLIST_NONE);
-	queue->hash      = M_hashtable_create(16, 75, M_hash_func_hash_vp, M_sort_compar_vp, M_HASHTABLE_NONE, NULL);
+	if (flags & M_QUEUE_MEMPOOL) {
+		llist_flags |= M_LLIST_MEMPOOL;
+		hash_flags  |= M_HASHTABLE_MEMPOOL;
+	}
+
+	queue->list      = M_llist_create((sort_cb || free_cb)?&callbacks:NULL, llist_flags);
+	queue->hash      = M_hashtable_create(16, 75, M_hash_func_hash_vp, M_sort_compar_vp, hash_flags, NULL);
 	return queue;
 }
 
 
+M_queue_t *M_queue_create(M_sort_compar_t sort_cb, void (*free_cb)(void *))
+{
+	return M_queue_create_ex(sort_cb, free_cb, M_QUEUE_NONE);
+}
+
+
 void M_queue_destroy(M_queue_t *queue)
 {
 	if (queue == NULL)
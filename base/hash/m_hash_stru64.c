@@ -85,6 +85,15 @@ M_hash_stru64_t *M_hash_stru64_create(size_t size, M_uint8 fillpct, M_uint32 fla
 	if (flags & M_HASH_STRU64_STATIC_SEED) {
 		hash_flags |= M_HASHTABLE_STATIC_SEED;
 	}
+	if (flags & M_HASH_STRU64_OPEN_ADDRESSING) {
+		hash_flags |= M_HASHTABLE_OPEN_ADDRESSING;
+	}
+	if (flags & M_HASH_STRU64_INCREMENTAL_REHASH) {
+		hash_flags |= M_HASHTABLE_INCREMENTAL_REHASH;
+	}
+	if (flags & M_HASH_STRU64_MEMPOOL) {
+		hash_flags |= M_HASHTABLE_MEMPOOL;
+	}
 
 	/* We are only dealing in opaque types here, and we don't have any
 	 * metadata of our own to store, so we are only casting one pointer
@@ -25,14 +25,16 @@
 
 #include <mstdlib/mstdlib.h>
 #include "m_defs_int.h"
+#include "hash/m_hashtable_int.h"
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-M_hash_strvp_t *M_hash_strvp_create(size_t size, M_uint8 fillpct, M_uint32 flags, M_hashtable_free_func destroy_func)
+static M_hash_strvp_t *M_hash_strvp_create_int(M_arena_t *arena, size_t size, M_uint8 fillpct, M_uint32 flags, M_hashtable_free_func destroy_func)
 {
 	M_hashtable_hash_func        key_hash     = M_hash_func_hash_str;
 	M_sort_compar_t              key_equality = M_sort_compar_str;
 	M_hashtable_flags_t          hash_flags   = M_HASHTABLE_NONE;
+	M_uint32                     arena_flags  = M_HASHTABLE_ARENA_KEYS_STR;
 	struct M_hashtable_callbacks callbacks    = {
 		M_hash_void_strdup,
 		M_hash_void_strdup,
@@ -70,10 +72,12 @@ M_hash_strvp_t *M_hash_strvp_create(size_t size, M_uint8 fillpct, M_uint32 flags
 	if (flags & M_HASH_STRVP_KEYS_UPPER) {
 		callbacks.key_duplicate_insert = (M_hashtable_duplicate_func)M_strdup_upper;
 		callbacks.key_duplicate_copy   = (M_hashtable_duplicate_func)M_strdup_upper;
+		arena_flags                   |= M_HASHTABLE_ARENA_KEYS_UPPER;
 	}
 	if (flags & M_HASH_STRVP_KEYS_LOWER) {
 		callbacks.key_duplicate_insert = (M_hashtable_duplicate_func)M_strdup_lower;
 		callbacks.key_duplicate_copy   = (M_hashtable_duplicate_func)M_strdup_lower;
+		arena_flags                   |= M_HASHTABLE_ARENA_KEYS_LOWER;
 	}
 
 	/* Multi-value options. */
@@ -88,11 +92,34 @@ M_hash_strvp_t *M_hash_strvp_create(size_t size, M_uint8 fillpct, M_uint32 flags
 	if (flags & M_HASH_STRVP_STATIC_SEED) {
 		hash_flags |= M_HASHTABLE_STATIC_SEED;
 	}
+	if (flags & M_HASH_STRVP_OPEN_ADDRESSING) {
+		hash_flags |= M_HASHTABLE_OPEN_ADDRESSING;
+	}
+	if (flags & M_HASH_STRVP_INCREMENTAL_REHASH) {
+		hash_flags |= M_HASHTABLE_INCREMENTAL_REHASH;
+	}
+	if (flags & M_HASH_STRVP_MEMPOOL) {
+		hash_flags |= M_HASHTABLE_MEMPOOL;
+	}
 
 	/* We are only dealing in opaque types here, and we don't have any
 	 * metadata of our own to store, so we are only casting one pointer
 	 * type to another.  This is a safe operation */
-	return (M_hash_strvp_t *)M_hashtable_create(size, fillpct, key_hash, key_equality, hash_flags, &callbacks);
+	return (M_hash_strvp_t *)M_hashtable_create_arena(arena, arena_flags, size, fillpct, key_hash, key_equality, hash_flags, &callbacks);
+}
+
+
+M_hash_strvp_t *M_hash_strvp_create(size_t size, M_uint8 fillpct, M_uint32 flags, M_hashtable_free_func destroy_func)
+{
+	return M_hash_strvp_create_int(NULL, size, fillpct, flags, destroy_func);
+}
+
+
+M_hash_strvp_t *M_hash_strvp_create_arena(M_arena_t *arena, size_t size, M_uint8 fillpct, M_uint32 flags, M_hashtable_free_func destroy_func)
+{
+	if (arena == NULL)
+		return NULL;
+	return M_hash_strvp_create_int(arena, size, fillpct, flags, destroy_func);
 }
 
 
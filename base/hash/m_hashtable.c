@@ -25,6 +25,19 @@
 
 #include <mstdlib/mstdlib.h>
 #include "m_defs_int.h"
+#include "hash/m_hashtable_int.h"
+#include "list/m_llist_int.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define M_HASHTABLE_GROUP_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  include <arm_neon.h>
+#  define M_HASHTABLE_GROUP_NEON 1
+#endif
+#if defined(_MSC_VER)
+#  include <intrin.h>
+#endif
 
 struct M_hashtable_bucket;
 
@@ -48,7 +61,14 @@ struct M_hashtable_bucket {
  *  callbacks that control behavior.  The h implementation uses
  *  chaining for hash collisions, and stores the first hash match in the
  *  bucket list itself to avoid additional memory allocations, though does
- *  waste some memory. */
+ *  waste some memory.
+ *
+ *  When M_HASHTABLE_OPEN_ADDRESSING is set the bucket list is instead used as a
+ *  flat array of slots (next is always NULL) and collisions are resolved by
+ *  probing groups of slots. Each slot has a control byte in ctrl which is
+ *  either empty, deleted (tombstone), or the low 7 bits of the key's hash.
+ *  A whole group of control bytes is compared at once so only slots with a
+ *  matching hash fragment have their keys compared. */
 struct M_hashtable {
 	M_sort_compar_t            key_equality;           /*!< Callback for key equality check */
 	M_hashtable_hash_func      key_hash;               /*!< Callback for key hash */
@@ -62,8 +82,20 @@ struct M_hashtable {
 	M_hashtable_free_func      value_free;             /*!< Callback to free a value */
 
 	struct M_hashtable_bucket *buckets;                /*!< Bucket list */
+	M_uint8                   *ctrl;                   /*!< Open addressing control bytes, one per bucket.
+	                                                        NULL when chaining is in use. */
+
+	struct M_hashtable_bucket *old_buckets;            /*!< Bucket list entries are being migrated out of during an
+	                                                        incremental rehash. NULL when not rehashing. */
+	M_uint8                   *old_ctrl;               /*!< Control bytes for old_buckets when using open addressing. */
+	M_uint32                   old_size;               /*!< Number of buckets in old_buckets. */
+	M_uint32                   migrate_idx;            /*!< Next bucket in old_buckets to be migrated. */
 
 	M_llist_t                 *keys;                   /*!< List of keys in the h used for ordering. */
+	M_mempool_t               *pool;                   /*!< Chained entry pool when M_HASHTABLE_MEMPOOL is set. */
+	M_arena_t                 *arena;                  /*!< Arena the h is allocated from. May be NULL. */
+	M_uint32                   arena_flags;            /*!< M_hashtable_arena_flags_t, how keys and values are
+	                                                        stored when using an arena. */
 
 	M_uint32                   key_hash_seed;          /*!< Used when computing hashes to prevent collision attacks. */
 	M_uint32                   size;                   /*!< Number of buckets. Power of 2 */
@@ -71,6 +103,7 @@ struct M_hashtable {
 	size_t                     num_values;             /*!< Number of values in the hash table */
 	size_t                     num_collisions;         /*!< Number of collisions in the hash table */
 	size_t                     num_expansions;         /*!< Number of times the hash table has been expanded/rehashed */
+	size_t                     num_deleted;            /*!< Number of open addressing tombstones */
 
 	M_uint8                    fillpct;                /*!< Percentage full before expansion/rehash. 0=no rehash */
 
@@ -101,7 +134,271 @@ static int M_hashtable_equality_func_default(const void *arg1, const void *arg2,
 	return 0;
 }
 
-M_hashtable_t *M_hashtable_create(size_t size, M_uint8 fillpct,
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* Open addressing control byte values. A full slot stores the low 7 bits of the
+ * hash (high bit clear) so empty and deleted can be found by the high bit alone. */
+#define M_HASHTABLE_CTRL_EMPTY   0x80
+#define M_HASHTABLE_CTRL_DELETED 0xFE
+
+/* Number of slots probed at once. Groups are aligned so the control bytes for a
+ * group never wrap around the end of the table. */
+#define M_HASHTABLE_GROUP_WIDTH  16
+
+/* Split of the hash between the group index (H1) and control byte (H2). */
+#define M_HASHTABLE_H1(hash)     ((hash) >> 7)
+#define M_HASHTABLE_H2(hash)     ((M_uint8)((hash) & 0x7F))
+
+/* Group match results are bit masks with one bit (or one nibble with NEON) per
+ * slot. Matches are walked by taking the lowest set bit and clearing it. */
+#ifdef M_HASHTABLE_GROUP_NEON
+#  define M_HASHTABLE_MASK_SHIFT 2
+#else
+#  define M_HASHTABLE_MASK_SHIFT 0
+#endif
+
+static __inline__ size_t M_hashtable_mask_lowest(M_uint64 mask)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return (size_t)__builtin_ctzll(mask) >> M_HASHTABLE_MASK_SHIFT;
+#elif defined(_MSC_VER) && defined(_WIN64)
+	unsigned long idx;
+	_BitScanForward64(&idx, mask);
+	return (size_t)idx >> M_HASHTABLE_MASK_SHIFT;
+#else
+	size_t idx = 0;
+	while (!(mask & 1)) {
+		mask >>= 1;
+		idx++;
+	}
+	return idx >> M_HASHTABLE_MASK_SHIFT;
+#endif
+}
+
+#if defined(M_HASHTABLE_GROUP_SSE2)
+
+static __inline__ M_uint64 M_hashtable_group_match(const M_uint8 *ctrl, M_uint8 h2)
+{
+	__m128i group = _mm_loadu_si128((const __m128i *)((const void *)ctrl));
+	return (M_uint64)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)h2)));
+}
+
+static __inline__ M_uint64 M_hashtable_group_match_free(const M_uint8 *ctrl)
+{
+	/* Empty and deleted both have the high bit set. */
+	__m128i group = _mm_loadu_si128((const __m128i *)((const void *)ctrl));
+	return (M_uint64)_mm_movemask_epi8(group);
+}
+
+#elif defined(M_HASHTABLE_GROUP_NEON)
+
+static __inline__ M_uint64 M_hashtable_neon_mask(uint8x16_t cmp)
+{
+	/* Narrow each 8 bit lane to 4 bits, there is no movemask on NEON. */
+	return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(cmp), 4)), 0) & 0x8888888888888888ULL;
+}
+
+static __inline__ M_uint64 M_hashtable_group_match(const M_uint8 *ctrl, M_uint8 h2)
+{
+	return M_hashtable_neon_mask(vceqq_u8(vld1q_u8(ctrl), vdupq_n_u8(h2)));
+}
+
+static __inline__ M_uint64 M_hashtable_group_match_free(const M_uint8 *ctrl)
+{
+	return M_hashtable_neon_mask(vcltq_s8(vreinterpretq_s8_u8(vld1q_u8(ctrl)), vdupq_n_s8(0)));
+}
+
+#else
+
+static __inline__ M_uint64 M_hashtable_group_match(const M_uint8 *ctrl, M_uint8 h2)
+{
+	M_uint64 mask = 0;
+	size_t   i;
+
+	for (i=0; i<M_HASHTABLE_GROUP_WIDTH; i++) {
+		if (ctrl[i] == h2) {
+			mask |= (M_uint64)1 << i;
+		}
+	}
+	return mask;
+}
+
+static __inline__ M_uint64 M_hashtable_group_match_free(const M_uint8 *ctrl)
+{
+	M_uint64 mask = 0;
+	size_t   i;
+
+	for (i=0; i<M_HASHTABLE_GROUP_WIDTH; i++) {
+		if (ctrl[i] & 0x80) {
+			mask |= (M_uint64)1 << i;
+		}
+	}
+	return mask;
+}
+
+#endif
+
+static __inline__ M_bool M_hashtable_group_has_empty(const M_uint8 *ctrl)
+{
+	return M_hashtable_group_match(ctrl, M_HASHTABLE_CTRL_EMPTY) != 0;
+}
+
+
+/*! Searches the probe sequence of a hash for a matching key when using open addressing.
+ *
+ *  Groups are visited using triangular probing which visits every group exactly
+ *  once because the number of groups is a power of 2. The search stops at the first
+ *  group containing an empty slot because an insert would have used it.
+ *
+ *  \param h       Pointer to the h
+ *  \param buckets Bucket list being searched (current or old)
+ *  \param ctrl    Control bytes for the bucket list
+ *  \param size    Number of buckets in the bucket list
+ *  \param hash    Full hash of the key
+ *  \param key     Key being searched for
+ *  \return Pointer to h bucket containing a match, or NULL if no match found */
+static struct M_hashtable_bucket *M_hashtable_open_get_match(const M_hashtable_t *h, struct M_hashtable_bucket *buckets,
+		const M_uint8 *ctrl, M_uint32 size, M_uint32 hash, const void *key)
+{
+	size_t   num_groups = size / M_HASHTABLE_GROUP_WIDTH;
+	size_t   group      = M_HASHTABLE_H1(hash) & (num_groups - 1);
+	M_uint8  h2         = M_HASHTABLE_H2(hash);
+	size_t   step;
+
+	for (step=1; step<=num_groups; step++) {
+		const M_uint8 *gctrl = ctrl + (group * M_HASHTABLE_GROUP_WIDTH);
+		M_uint64       mask  = M_hashtable_group_match(gctrl, h2);
+
+		while (mask != 0) {
+			size_t idx = (group * M_HASHTABLE_GROUP_WIDTH) + M_hashtable_mask_lowest(mask);
+			if (h->key_equality(&buckets[idx].key, &key, NULL) == 0)
+				return &buckets[idx];
+			mask &= mask - 1;
+		}
+
+		if (M_hashtable_group_has_empty(gctrl))
+			return NULL;
+
+		group = (group + step) & (num_groups - 1);
+	}
+
+	return NULL;
+}
+
+
+/*! Finds the first empty or deleted slot in the probe sequence of a hash.
+ *
+ *  \param h    Pointer to the h
+ *  \param hash Full hash of the key
+ *  \param home Set to M_TRUE if the slot is in the first group probed.
+ *  \return Index of the slot, or h->size if the table is completely full. */
+static size_t M_hashtable_open_find_free(const M_hashtable_t *h, M_uint32 hash, M_bool *home)
+{
+	size_t num_groups = h->size / M_HASHTABLE_GROUP_WIDTH;
+	size_t group      = M_HASHTABLE_H1(hash) & (num_groups - 1);
+	size_t step;
+
+	for (step=1; step<=num_groups; step++) {
+		M_uint64 mask = M_hashtable_group_match_free(h->ctrl + (group * M_HASHTABLE_GROUP_WIDTH));
+
+		if (mask != 0) {
+			*home = (step == 1)?M_TRUE:M_FALSE;
+			return (group * M_HASHTABLE_GROUP_WIDTH) + M_hashtable_mask_lowest(mask);
+		}
+
+		group = (group + step) & (num_groups - 1);
+	}
+
+	return h->size;
+}
+
+
+/*! Allocate zeroed memory for the h, from the arena if it has one. */
+static void *M_hashtable_malloc_zero(const M_hashtable_t *h, size_t size)
+{
+	if (h->arena != NULL)
+		return M_arena_alloc_zero(h->arena, size);
+	return M_malloc_zero(size);
+}
+
+
+/*! Free memory from M_hashtable_malloc_zero. Arena memory is released with the arena. */
+static void M_hashtable_mem_free(const M_hashtable_t *h, void *ptr)
+{
+	if (h->arena != NULL)
+		return;
+	M_free(ptr);
+}
+
+
+/*! Allocate the bucket list (and control bytes if using open addressing) for the current size. */
+static void M_hashtable_alloc_buckets(M_hashtable_t *h)
+{
+	h->buckets = M_hashtable_malloc_zero(h, sizeof(*h->buckets) * h->size);
+
+	if (h->flags & M_HASHTABLE_OPEN_ADDRESSING) {
+		h->ctrl = M_hashtable_malloc_zero(h, h->size);
+		M_mem_set(h->ctrl, M_HASHTABLE_CTRL_EMPTY, h->size);
+	}
+}
+
+
+/*! Allocate a zeroed chained collision entry. */
+static struct M_hashtable_bucket *M_hashtable_chain_alloc(M_hashtable_t *h)
+{
+	if (h->pool != NULL)
+		return M_mempool_alloc(h->pool);
+	return M_hashtable_malloc_zero(h, sizeof(struct M_hashtable_bucket));
+}
+
+
+/*! Free a chained collision entry. */
+static void M_hashtable_chain_free(M_hashtable_t *h, struct M_hashtable_bucket *entry)
+{
+	if (h->pool != NULL) {
+		M_mempool_free(h->pool, entry);
+		return;
+	}
+	M_hashtable_mem_free(h, entry);
+}
+
+
+/*! Duplicate a key for storing in the h. String keys of an arena h are copied
+ *  into the arena instead of using the callbacks. */
+static void *M_hashtable_key_duplicate(const M_hashtable_t *h, M_bool initial_insert, const void *key)
+{
+	char *out;
+
+	if (h->arena_flags & M_HASHTABLE_ARENA_KEYS_STR) {
+		out = M_arena_strdup(h->arena, key);
+		if (h->arena_flags & M_HASHTABLE_ARENA_KEYS_UPPER)
+			M_str_upper(out);
+		if (h->arena_flags & M_HASHTABLE_ARENA_KEYS_LOWER)
+			M_str_lower(out);
+		return out;
+	}
+
+	if (initial_insert)
+		return h->key_duplicate_insert(key);
+	return h->key_duplicate_copy(key);
+}
+
+
+/*! Duplicate a value for storing in the h. String values of an arena h are
+ *  copied into the arena instead of using the callbacks. */
+static void *M_hashtable_value_duplicate(const M_hashtable_t *h, M_bool initial_insert, const void *value)
+{
+	if (h->arena_flags & M_HASHTABLE_ARENA_VALS_STR)
+		return M_arena_strdup(h->arena, value);
+
+	if (initial_insert)
+		return h->value_duplicate_insert(value);
+	return h->value_duplicate_copy(value);
+}
+
+
+M_hashtable_t *M_hashtable_create_arena(M_arena_t *arena, M_uint32 arena_flags, size_t size, M_uint8 fillpct,
 		M_hashtable_hash_func key_hash, M_sort_compar_t key_equality,
 		M_uint32 flags, const struct M_hashtable_callbacks *callbacks)
 {
@@ -123,10 +420,25 @@ M_hashtable_t *M_hashtable_create(size_t size, M_uint8 fillpct,
 	if ((flags & M_HASHTABLE_KEYS_SORTED) && !(flags & M_HASHTABLE_KEYS_ORDERED))
 		return NULL;
 
-	h = M_malloc(sizeof(*h));
-	M_mem_set(h, 0, sizeof(*h));
+	/* The sorted key list can't be allocated from an arena. */
+	if (arena != NULL && (flags & M_HASHTABLE_KEYS_SORTED))
+		return NULL;
+
+	if (arena != NULL) {
+		h = M_arena_alloc_zero(arena, sizeof(*h));
+		/* Nothing is ever freed so a pool would only add overhead. */
+		flags &= ~((M_uint32)M_HASHTABLE_MEMPOOL);
+	} else {
+		h = M_malloc_zero(sizeof(*h));
+		arena_flags = M_HASHTABLE_ARENA_NONE;
+	}
+	h->arena       = arena;
+	h->arena_flags = arena_flags;
 
 	size = M_size_t_round_up_to_power_of_two(size);
+	/* Open addressing probes whole groups so we need at least one. */
+	if ((flags & M_HASHTABLE_OPEN_ADDRESSING) && size < M_HASHTABLE_GROUP_WIDTH)
+		size = M_HASHTABLE_GROUP_WIDTH;
 	if (size > M_HASHTABLE_MAX_BUCKETS) {
 		h->size = M_HASHTABLE_MAX_BUCKETS;
 	} else {
@@ -172,32 +484,54 @@ M_hashtable_t *M_hashtable_create(size_t size, M_uint8 fillpct,
 		if (callbacks->value_free             != NULL) h->value_free             = callbacks->value_free;
 	}
 
-	h->buckets = M_malloc(sizeof(*h->buckets) * h->size);
-	M_mem_set(h->buckets, 0, sizeof(*h->buckets) * h->size);
+	/* Strings copied into the arena are released with the arena. */
+	if (h->arena_flags & M_HASHTABLE_ARENA_KEYS_STR)
+		h->key_free   = M_hashtable_free_func_default;
+	if (h->arena_flags & M_HASHTABLE_ARENA_VALS_STR)
+		h->value_free = M_hashtable_free_func_default;
+
+	M_hashtable_alloc_buckets(h);
+
+	/* Open addressing never chains. */
+	if ((flags & M_HASHTABLE_MEMPOOL) && !(flags & M_HASHTABLE_OPEN_ADDRESSING))
+		h->pool = M_mempool_create(sizeof(struct M_hashtable_bucket), 0);
 
 	if (flags & M_HASHTABLE_KEYS_ORDERED) {
 		M_mem_set(&llist_callbacks, 0, sizeof(llist_callbacks));
 		llist_callbacks.equality = h->key_equality;
 		/* The ordered key list uses references to the key in the h itself. It does not copy or own
  		 * the keys it holds. */
-		h->keys = M_llist_create(&llist_callbacks, (h->flags & M_HASHTABLE_KEYS_SORTED)?M_LLIST_SORTED:M_LLIST_NONE);
+		if (h->arena != NULL) {
+			h->keys = M_llist_create_arena(h->arena, &llist_callbacks, M_LLIST_NONE);
+		} else {
+			h->keys = M_llist_create(&llist_callbacks, ((h->flags & M_HASHTABLE_KEYS_SORTED)?M_LLIST_SORTED:M_LLIST_NONE)|((h->flags & M_HASHTABLE_MEMPOOL)?M_LLIST_MEMPOOL:M_LLIST_NONE));
+		}
 	}
 
 	return h;
 }
 
 
+M_hashtable_t *M_hashtable_create(size_t size, M_uint8 fillpct,
+		M_hashtable_hash_func key_hash, M_sort_compar_t key_equality,
+		M_uint32 flags, const struct M_hashtable_callbacks *callbacks)
+{
+	return M_hashtable_create_arena(NULL, M_HASHTABLE_ARENA_NONE, size, fillpct, key_hash, key_equality, flags, callbacks);
+}
+
+
 /*! Searches the chained entries of a hash index for a matching key.
  *  \param h Pointer to the h
+ *  \param buckets   Bucket list being searched (current or old)
  *  \param idx       Hash index being searched
  *  \param key       key being searched for
  *  \return Pointer to h bucket containing a match, or NULL if no
  *          match found */
-static struct M_hashtable_bucket *M_hashtable_get_match(const M_hashtable_t *h, size_t idx, const void *key)
+static struct M_hashtable_bucket *M_hashtable_get_match(const M_hashtable_t *h, struct M_hashtable_bucket *buckets, size_t idx, const void *key)
 {
 	struct M_hashtable_bucket *entry;
 
-	entry = &h->buckets[idx];
+	entry = &buckets[idx];
 	if (entry->key == NULL)
 		return NULL;
 
@@ -211,11 +545,59 @@ static struct M_hashtable_bucket *M_hashtable_get_match(const M_hashtable_t *h,
 }
 
 
-/*! Grabs the Hashtable index from the key and length.  The h index is
- *  the hash of the function reduced to the size of the bucket list.
+/*! Find the bucket holding a key in a given bucket list regardless of the collision strategy in use.
+ *
+ *  When chaining, the h index is the hash of the function reduced to the size of the bucket list.
  *  We are doing "hash & (size - 1)" since we are guaranteeing a power of 2 for size.
- *  This is equivalent to "hash % size", but should be more efficient */
-#define HASH_IDX(h, key) h->key_hash(key, h->key_hash_seed) & (h->size - 1)
+ *  This is equivalent to "hash % size", but should be more efficient.
+ *
+ *  \param h       Pointer to the h
+ *  \param is_old  Search the old bucket list of an incremental rehash instead of the current one.
+ *  \param hash    Full hash of the key
+ *  \param key     key being searched for
+ *  \return Pointer to h bucket containing a match, or NULL if no match found */
+static struct M_hashtable_bucket *M_hashtable_find_in(const M_hashtable_t *h, M_bool is_old, M_uint32 hash, const void *key)
+{
+	struct M_hashtable_bucket *buckets = is_old?h->old_buckets:h->buckets;
+	const M_uint8             *ctrl    = is_old?h->old_ctrl:h->ctrl;
+	M_uint32                   size    = is_old?h->old_size:h->size;
+
+	if (buckets == NULL)
+		return NULL;
+
+	if (h->flags & M_HASHTABLE_OPEN_ADDRESSING)
+		return M_hashtable_open_get_match(h, buckets, ctrl, size, hash, key);
+	return M_hashtable_get_match(h, buckets, hash & (size - 1), key);
+}
+
+
+/*! Find the bucket holding a key. Entries that haven't been migrated yet by an
+ *  incremental rehash are found in the old bucket list.
+ *  \param h      Pointer to the h
+ *  \param key    key being searched for
+ *  \param hash   Optional. Full hash of the key.
+ *  \param is_old Optional. Set to whether the entry was found in the old bucket list.
+ *  \return Pointer to h bucket containing a match, or NULL if no match found */
+static struct M_hashtable_bucket *M_hashtable_find(const M_hashtable_t *h, const void *key, M_uint32 *hash, M_bool *is_old)
+{
+	struct M_hashtable_bucket *entry;
+	M_uint32                   myhash = h->key_hash(key, h->key_hash_seed);
+
+	if (hash != NULL)
+		*hash = myhash;
+	if (is_old != NULL)
+		*is_old = M_FALSE;
+
+	entry = M_hashtable_find_in(h, M_FALSE, myhash, key);
+	if (entry == NULL && h->old_buckets != NULL) {
+		entry = M_hashtable_find_in(h, M_TRUE, myhash, key);
+		if (entry != NULL && is_old != NULL) {
+			*is_old = M_TRUE;
+		}
+	}
+
+	return entry;
+}
 
 enum M_hashtable_insert_type {
 	M_HASHTABLE_INSERT_NODUP   = 0,      /*!< Do not duplicate the value. Store the pointer directly. */
@@ -225,6 +607,14 @@ enum M_hashtable_insert_type {
 	M_HASHTABLE_INSERT_REHASH  = 1 << 2  /*!< The value itself is a list and should be added directly. */
 };
 
+/* Number of old buckets moved into the current bucket list by each insert or remove
+ * while an incremental rehash is in progress. The new bucket list is twice the size of
+ * the old one so this always finishes well before the next expansion is needed. */
+#define M_HASHTABLE_MIGRATE_STEP 16
+
+static void M_hashtable_migrate(M_hashtable_t *h, size_t num_buckets);
+static void M_hashtable_migrate_entry(M_hashtable_t *h, size_t idx, struct M_hashtable_bucket *entry);
+
 
 /*! Internal function to insert into a h.  It only differs from the normal
  *  h insert function by the fact that it contains a 'duplicate' boolean
@@ -246,6 +636,8 @@ enum M_hashtable_insert_type {
 static M_bool M_hashtable_insert_direct(M_hashtable_t *h, enum M_hashtable_insert_type insert_type, const void *key, const void *value)
 {
 	size_t                     idx;
+	M_uint32                   hash;
+	M_bool                     home            = M_TRUE;
 	struct M_hashtable_bucket *entry;
 	void                      *myvalue;
 	struct M_list_callbacks    list_callbacks;
@@ -257,44 +649,63 @@ static M_bool M_hashtable_insert_direct(M_hashtable_t *h, enum M_hashtable_inser
 	/* Duplicate the value (before possibly freeing the old one in case the
 	 * new value references the old value as a pointer in some way) */
 	if (insert_type & M_HASHTABLE_INSERT_DUP) {
-		if (insert_type & M_HASHTABLE_INSERT_INITIAL) {
-			myvalue = h->value_duplicate_insert(value);
-		} else {
-			myvalue = h->value_duplicate_copy(value);
-		}
+		myvalue = M_hashtable_value_duplicate(h, (insert_type & M_HASHTABLE_INSERT_INITIAL)?M_TRUE:M_FALSE, value);
 	} else {
 		/* Must be in a rehash, don't duplicate! */
 		myvalue = M_CAST_OFF_CONST(void *, value);
 	}
 
-	idx   = HASH_IDX(h, key);
-	entry = M_hashtable_get_match(h, idx, key);
+	hash = h->key_hash(key, h->key_hash_seed);
 
-	if (entry == NULL) {
-		/* No matching entry */
-		if (!(insert_type & M_HASHTABLE_INSERT_REHASH))
-			h->num_keys++;
-		key_added = M_TRUE;
+	/* Move more of the old bucket list over if an incremental rehash is in progress.
+	 * If the key is still in the old bucket list move it now so it's only ever
+	 * in one place. */
+	if (!(insert_type & M_HASHTABLE_INSERT_REHASH) && h->old_buckets != NULL) {
+		M_hashtable_migrate(h, M_HASHTABLE_MIGRATE_STEP);
+		entry = M_hashtable_find_in(h, M_TRUE, hash, key);
+		if (entry != NULL) {
+			M_hashtable_migrate_entry(h, hash & (h->old_size - 1), entry);
+		}
+	}
+
+	idx   = hash & (h->size - 1);
+	entry = M_hashtable_find_in(h, M_FALSE, hash, key);
 
-		if (h->buckets[idx].key == NULL) {
+	if (entry == NULL) {
+		if (h->flags & M_HASHTABLE_OPEN_ADDRESSING) {
+			/* Take the first free slot in the probe sequence. The load limit
+			 * keeps free slots available unless we're at the maximum size. */
+			idx = M_hashtable_open_find_free(h, hash, &home);
+			if (idx == h->size) {
+				if (insert_type & M_HASHTABLE_INSERT_DUP)
+					h->value_free(myvalue);
+				return M_FALSE;
+			}
+			if (!home)
+				h->num_collisions++;
+			if (h->ctrl[idx] == M_HASHTABLE_CTRL_DELETED)
+				h->num_deleted--;
+			h->ctrl[idx] = M_HASHTABLE_H2(hash);
+			entry        = &h->buckets[idx];
+		} else if (h->buckets[idx].key == NULL) {
 			/* No collision */
 			entry = &h->buckets[idx];
 		} else {
 			/* Collision, chain it */
 			h->num_collisions++;
-			entry                       = M_malloc(sizeof(*entry));
-			M_mem_set(entry, 0, sizeof(*entry));
+			entry                       = M_hashtable_chain_alloc(h);
 			entry->next                 = h->buckets[idx].next;
 			h->buckets[idx].next = entry;
 		}
 
+		/* No matching entry */
+		if (!(insert_type & M_HASHTABLE_INSERT_REHASH))
+			h->num_keys++;
+		key_added = M_TRUE;
+
 		/* Store the key */
 		if (insert_type & M_HASHTABLE_INSERT_DUP) {
-			if (insert_type & M_HASHTABLE_INSERT_INITIAL) {
-				entry->key = h->key_duplicate_insert(key);
-			} else {
-				entry->key = h->key_duplicate_copy(key);
-			}
+			entry->key = M_hashtable_key_duplicate(h, (insert_type & M_HASHTABLE_INSERT_INITIAL)?M_TRUE:M_FALSE, key);
 		} else {
 			/* Must be in a rehash, don't duplicate! */
 			entry->key     = M_CAST_OFF_CONST(void *, key);
@@ -309,7 +720,11 @@ static M_bool M_hashtable_insert_direct(M_hashtable_t *h, enum M_hashtable_inser
 			/* Note: The h will handle duplicating values for the list */
 			list_callbacks.equality   = h->value_equality;
 			list_callbacks.value_free = h->value_free;
-			entry->value.multi_value  = M_list_create(&list_callbacks, (h->flags & M_HASHTABLE_MULTI_SORTED)?M_LIST_SORTED:M_LIST_NONE);
+			if (h->arena != NULL) {
+				entry->value.multi_value = M_list_create_arena(h->arena, &list_callbacks, (h->flags & M_HASHTABLE_MULTI_SORTED)?M_LIST_SORTED:M_LIST_NONE);
+			} else {
+				entry->value.multi_value = M_list_create(&list_callbacks, (h->flags & M_HASHTABLE_MULTI_SORTED)?M_LIST_SORTED:M_LIST_NONE);
+			}
 		}
 	} else {
 		if (!(h->flags & M_HASHTABLE_MULTI_VALUE)) {
@@ -369,92 +784,200 @@ static void M_hashtable_destroy_entry(M_hashtable_t *h, struct M_hashtable_bucke
 }
 
 
-/*! This function is used to either rehash a h or destroy a h.
- *  Though it seems odd that they'd be the same function, they both iterate
- *  over the h the same exact way.  So in order to reduce this error-prone
- *  logic, they were combined into a single function.
- *  \param h  Pointer to the h
- *  \param is_destroy Whether or not this is a destroy call or a rehash call.
- *                    M_TRUE for destroy, M_FALSE for rehash. */
-static void M_hashtable_rehash_or_destroy(M_hashtable_t *h, M_bool is_destroy, M_bool destroy_vals)
+/*! Take an entry out of a bucket list. The key and value are not touched, they
+ *  must have already been destroyed or moved elsewhere.
+ *  \param h      Pointer to the h
+ *  \param is_old Whether the entry is in the old bucket list of an incremental rehash.
+ *  \param idx    Hash index of the entry when chaining. Ignored for open addressing.
+ *  \param entry  Entry being removed. When chaining the next entry in the chain may be
+ *                moved into this memory. */
+static void M_hashtable_unlink_entry(M_hashtable_t *h, M_bool is_old, size_t idx, struct M_hashtable_bucket *entry)
 {
-	M_uint32                   i;
-	M_uint32                   old_size;
-	struct M_hashtable_bucket *old;
-	struct M_hashtable_bucket *ptr;
-	struct M_hashtable_bucket *next;
+	struct M_hashtable_bucket *buckets = is_old?h->old_buckets:h->buckets;
+	M_uint8                   *ctrl    = is_old?h->old_ctrl:h->ctrl;
+	struct M_hashtable_bucket *next    = entry->next;
+
+	if (h->flags & M_HASHTABLE_OPEN_ADDRESSING) {
+		/* If the group still has an empty slot no probe sequence ever went past
+		 * it so the slot can go back to empty. Otherwise it has to become a
+		 * tombstone so lookups for keys stored further along keep probing. */
+		idx = (size_t)(entry - buckets);
+		M_mem_set(entry, 0, sizeof(*entry));
+		if (M_hashtable_group_has_empty(ctrl + (idx & ~((size_t)M_HASHTABLE_GROUP_WIDTH - 1)))) {
+			ctrl[idx] = M_HASHTABLE_CTRL_EMPTY;
+		} else {
+			ctrl[idx] = M_HASHTABLE_CTRL_DELETED;
+			/* The old bucket list never gets inserted into so its tombstones don't matter. */
+			if (!is_old) {
+				h->num_deleted++;
+			}
+		}
+	} else if (next != NULL) {
+		/* If there is a chained entry following ours, then just copy
+		 * its contents over ours and free its chaining ptr memory */
+		M_mem_copy(entry, next, sizeof(*entry));
+		M_hashtable_chain_free(h, next);
+	} else if (entry == &buckets[idx]) {
+		/* If we are a non-chained entry, just zero out the
+		 * memory as we freed the bucket */
+		M_mem_set(entry, 0, sizeof(*entry));
+	} else {
+		/* We are the last in a chained entry ... crap, gotta iterate so we
+		 * can terminate the chain ... most expensive case */
+		struct M_hashtable_bucket *ptr;
 
-	if (h == NULL)
-		return;
+		ptr = &buckets[idx];
+		while (ptr->next != entry)
+			ptr = ptr->next;
 
-	/* If we are rehashing, we are going to create a new bucket list and
-	 * re-insert (and thus re-hash) each item in the h one by one.
-	 * We will NOT call the key_duplicate() or value_duplicate() callbacks
-	 * though, we will use the existing memory pointers for those */
-	old      = h->buckets;
-	old_size = h->size;
+		ptr->next = NULL;
+		M_hashtable_chain_free(h, entry);
+	}
+}
 
-	if (!is_destroy) {
-		/* No-op if we grow too large.  Do not need to rehash, just return */
-		if (h->size << 1 > M_HASHTABLE_MAX_BUCKETS)
-			return;
 
-		h->size      <<= 1;
-		h->num_expansions++;
-		h->buckets     = M_malloc(sizeof(*h->buckets) * h->size);
-		M_mem_set(h->buckets, 0, sizeof(*h->buckets) * h->size);
+/*! Move an entry from the old bucket list of an incremental rehash to the current one.
+ *  The key and value pointers are moved as is, they're not duplicated.
+ *  \param h     Pointer to the h
+ *  \param idx   Hash index of the entry in the old bucket list.
+ *  \param entry Entry in the old bucket list. */
+static void M_hashtable_migrate_entry(M_hashtable_t *h, size_t idx, struct M_hashtable_bucket *entry)
+{
+	if (h->flags & M_HASHTABLE_MULTI_VALUE) {
+		M_hashtable_insert_direct(h, M_HASHTABLE_INSERT_NODUP|M_HASHTABLE_INSERT_REHASH, entry->key, entry->value.multi_value);
+	} else {
+		M_hashtable_insert_direct(h, M_HASHTABLE_INSERT_NODUP|M_HASHTABLE_INSERT_REHASH, entry->key, entry->value.value);
 	}
+	M_hashtable_unlink_entry(h, M_TRUE, idx, entry);
+}
 
-	for (i=0; i<old_size; i++) {
-		if (old[i].key != NULL) {
-			if (is_destroy) {
-				/* Free base entry */
-				M_hashtable_destroy_entry(h, &old[i], destroy_vals);
-			} else {
-				/* Copy over base entry */
-				if (h->flags & M_HASHTABLE_MULTI_VALUE) {
-					M_hashtable_insert_direct(h, M_HASHTABLE_INSERT_NODUP|M_HASHTABLE_INSERT_REHASH, old[i].key, old[i].value.multi_value);
-				} else {
-					M_hashtable_insert_direct(h, M_HASHTABLE_INSERT_NODUP|M_HASHTABLE_INSERT_REHASH, old[i].key, old[i].value.value);
-				}
-			}
-			/* Copy then free any chained entries */
-			next = NULL;
-			ptr  = old[i].next;
-			while (ptr != NULL) {
-				next = ptr->next;
-				if (is_destroy) {
-					/* Destroy */
-					M_hashtable_destroy_entry(h, ptr, destroy_vals);
-				} else {
-					/* Copy */
-					if (h->flags & M_HASHTABLE_MULTI_VALUE) {
-						M_hashtable_insert_direct(h, M_HASHTABLE_INSERT_NODUP|M_HASHTABLE_INSERT_REHASH, ptr->key, ptr->value.multi_value);
-					} else {
-						M_hashtable_insert_direct(h, M_HASHTABLE_INSERT_NODUP|M_HASHTABLE_INSERT_REHASH, ptr->key, ptr->value.value);
-					}
-				}
-				M_free(ptr);
-				ptr = next;
-			}
+
+/*! Move buckets from the old bucket list of a rehash into the current bucket list.
+ *  Once every bucket has been moved the old bucket list is freed.
+ *  \param h           Pointer to the h
+ *  \param num_buckets Maximum number of old buckets to move. */
+static void M_hashtable_migrate(M_hashtable_t *h, size_t num_buckets)
+{
+	struct M_hashtable_bucket *entry;
+
+	while (h->old_buckets != NULL && num_buckets > 0) {
+		/* Moving the first entry of a chain copies the next one into the bucket. */
+		entry = &h->old_buckets[h->migrate_idx];
+		while (entry->key != NULL) {
+			M_hashtable_migrate_entry(h, h->migrate_idx, entry);
+		}
+
+		h->migrate_idx++;
+		num_buckets--;
+
+		if (h->migrate_idx == h->old_size) {
+			M_hashtable_mem_free(h, h->old_buckets);
+			M_hashtable_mem_free(h, h->old_ctrl);
+			h->old_buckets = NULL;
+			h->old_ctrl    = NULL;
+			h->old_size    = 0;
+			h->migrate_idx = 0;
 		}
 	}
+}
 
-	/* Kill the bucket list */
-	M_free(old);
 
-	if (is_destroy) {
-		if (h->flags & M_HASHTABLE_KEYS_ORDERED) {
-			M_llist_destroy(h->keys, M_FALSE);
+/*! Rehash the h into a new bucket list.
+ *
+ *  The new bucket list is normally twice the size of the current one. With open
+ *  addressing, if most of the used slots are tombstones the new bucket list is the
+ *  same size so they're cleared out without growing.
+ *
+ *  We will NOT call the key_duplicate() or value_duplicate() callbacks
+ *  though, we will use the existing memory pointers for those.
+ *
+ *  With M_HASHTABLE_INCREMENTAL_REHASH the entries are moved a few buckets at a time
+ *  by later inserts and removes, otherwise they're all moved now.
+ *
+ *  \param h Pointer to the h */
+static void M_hashtable_rehash(M_hashtable_t *h)
+{
+	M_uint32 old_size;
+
+	/* There can only be one old bucket list, finish off a rehash that's still going. */
+	M_hashtable_migrate(h, h->old_size);
+
+	old_size = h->size;
+	if (h->flags & M_HASHTABLE_OPEN_ADDRESSING && h->num_deleted >= h->num_keys) {
+		/* Mostly tombstones, rehash in place to clear them out instead of growing. */
+	} else if (h->size << 1 > M_HASHTABLE_MAX_BUCKETS) {
+		/* No-op if we grow too large.  Do not need to rehash, just return. Unless
+		 * we have tombstones to get rid of. */
+		if (!(h->flags & M_HASHTABLE_OPEN_ADDRESSING) || h->num_deleted == 0)
+			return;
+	} else {
+		h->size      <<= 1;
+		h->num_expansions++;
+	}
+
+	h->old_buckets = h->buckets;
+	h->old_ctrl    = h->ctrl;
+	h->old_size    = old_size;
+	h->migrate_idx = 0;
+	h->num_deleted = 0;
+	M_hashtable_alloc_buckets(h);
+
+	if (!(h->flags & M_HASHTABLE_INCREMENTAL_REHASH))
+		M_hashtable_migrate(h, h->old_size);
+}
+
+
+/*! Destroy all entries in a bucket list and the bucket list itself.
+ *  \param h            Pointer to the h
+ *  \param buckets      Bucket list.
+ *  \param size         Number of buckets in the bucket list.
+ *  \param destroy_vals Whether the values should be destroyed. */
+static void M_hashtable_destroy_buckets(M_hashtable_t *h, struct M_hashtable_bucket *buckets, M_uint32 size, M_bool destroy_vals)
+{
+	M_uint32                   i;
+	struct M_hashtable_bucket *ptr;
+	struct M_hashtable_bucket *next;
+
+	if (buckets == NULL)
+		return;
+
+	for (i=0; i<size; i++) {
+		if (buckets[i].key == NULL)
+			continue;
+
+		/* Free base entry */
+		M_hashtable_destroy_entry(h, &buckets[i], destroy_vals);
+
+		/* Free any chained entries */
+		ptr = buckets[i].next;
+		while (ptr != NULL) {
+			next = ptr->next;
+			M_hashtable_destroy_entry(h, ptr, destroy_vals);
+			M_hashtable_chain_free(h, ptr);
+			ptr = next;
 		}
-		M_free(h);
 	}
+
+	/* Kill the bucket list */
+	M_hashtable_mem_free(h, buckets);
 }
 
 
 void M_hashtable_destroy(M_hashtable_t *h, M_bool destroy_vals)
 {
-	M_hashtable_rehash_or_destroy(h, M_TRUE, destroy_vals);
+	if (h == NULL)
+		return;
+
+	M_hashtable_destroy_buckets(h, h->buckets, h->size, destroy_vals);
+	M_hashtable_destroy_buckets(h, h->old_buckets, h->old_size, destroy_vals);
+	M_hashtable_mem_free(h, h->ctrl);
+	M_hashtable_mem_free(h, h->old_ctrl);
+
+	if (h->flags & M_HASHTABLE_KEYS_ORDERED) {
+		M_llist_destroy(h->keys, M_FALSE);
+	}
+	M_mempool_destroy(h->pool);
+	M_hashtable_mem_free(h, h);
 }
 
 
@@ -463,6 +986,11 @@ void M_hashtable_destroy(M_hashtable_t *h, M_bool destroy_vals)
  *  \return M_TRUE if exceeded, M_FALSE if not */
 static M_bool M_hashtable_exceeds_load(const M_hashtable_t *h)
 {
+	/* Open addressing has to keep free slots around for probing to terminate so it
+	 * always has a hard limit of 7/8 full. Tombstones count against the limit
+	 * because they're never an end of probing. */
+	if (h->flags & M_HASHTABLE_OPEN_ADDRESSING && (h->num_keys + h->num_deleted) * 8 >= (size_t)h->size * 7)
+		return M_TRUE;
 	return h->fillpct && h->num_keys * 100 / h->size >= h->fillpct;
 }
 
@@ -479,7 +1007,7 @@ static M_bool M_hashtable_insert_int(M_hashtable_t *h, M_bool initial_insert, co
 
 	/* Check if we need to rehash */
 	if (M_hashtable_exceeds_load(h))
-		M_hashtable_rehash_or_destroy(h, M_FALSE, M_FALSE);
+		M_hashtable_rehash(h);
 
 	return M_TRUE;
 }
@@ -519,14 +1047,12 @@ static M_bool M_hashtable_get_int(const M_hashtable_t *h, struct M_hashtable_buc
 M_bool M_hashtable_get(const M_hashtable_t *h, const void *key, void **value)
 {
 	struct M_hashtable_bucket *entry;
-	size_t                     hash_idx;
 	size_t                     idx     = 0;
 
 	if (h == NULL || key == NULL)
 		return M_FALSE;
 
-	hash_idx = HASH_IDX(h, key);
-	entry    = M_hashtable_get_match(h, hash_idx, key);
+	entry = M_hashtable_find(h, key, NULL, NULL);
 
 	if (entry == NULL)
 		return M_FALSE;
@@ -546,50 +1072,30 @@ M_bool M_hashtable_get(const M_hashtable_t *h, const void *key, void **value)
 
 M_bool M_hashtable_remove(M_hashtable_t *h, const void *key, M_bool destroy_vals)
 {
-	size_t                     idx;
 	struct M_hashtable_bucket *entry;
-	struct M_hashtable_bucket *next;
+	M_uint32                   hash;
+	M_bool                     is_old;
 	size_t                     value_cnt;
 
 	if (h == NULL || key == NULL)
 		return M_FALSE;
 
-	idx   = HASH_IDX(h, key);
-	entry = M_hashtable_get_match(h, idx, key);
+	/* Removes help move an incremental rehash along too. */
+	if (h->old_buckets != NULL)
+		M_hashtable_migrate(h, M_HASHTABLE_MIGRATE_STEP);
+
+	entry = M_hashtable_find(h, key, &hash, &is_old);
 
 	if (entry == NULL)
 		return M_FALSE;
 
-	next  = entry->next;
-
 	if (h->flags & M_HASHTABLE_MULTI_VALUE) {
 		value_cnt = M_list_len(entry->value.multi_value);
 	} else {
 		value_cnt = 1;
 	}
 	M_hashtable_destroy_entry(h, entry, destroy_vals);
-
-	if (next != NULL) {
-		/* If there is a chained entry following ours, then just copy
-		 * its contents over ours and free its chaining ptr memory */
-		M_mem_copy(entry, next, sizeof(*entry));
-		M_free(next);
-	} else if (entry == &h->buckets[idx]) {
-		/* If we are a non-chained entry, just zero out the
-		 * memory as we freed the bucket */
-		M_mem_set(entry, 0, sizeof(*entry));
-	} else {
-		/* We are the last in a chained entry ... crap, gotta iterate so we
-		 * can terminate the chain ... most expensive case */
-		struct M_hashtable_bucket *ptr;
-
-		ptr = &h->buckets[idx];
-		while (ptr->next != entry)
-			ptr = ptr->next;
-
-		ptr->next = NULL;
-		M_free(entry);
-	}
+	M_hashtable_unlink_entry(h, is_old, hash & ((is_old?h->old_size:h->size) - 1), entry);
 
 	h->num_keys--;
 	h->num_values -= value_cnt;
@@ -609,7 +1115,6 @@ M_bool M_hashtable_is_multi(const M_hashtable_t *h)
 M_bool M_hashtable_multi_len(const M_hashtable_t *h, const void *key, size_t *len)
 {
 	struct M_hashtable_bucket *entry;
-	size_t                     hash_idx;
 	size_t                     mylen;
 
 	if (len == NULL) {
@@ -621,8 +1126,7 @@ M_bool M_hashtable_multi_len(const M_hashtable_t *h, const void *key, size_t *le
 	if (h == NULL || !(h->flags & M_HASHTABLE_MULTI_VALUE) || key == NULL)
 		return M_FALSE;
 
-	hash_idx = HASH_IDX(h, key);
-	entry    = M_hashtable_get_match(h, hash_idx, key);
+	entry = M_hashtable_find(h, key, NULL, NULL);
 
 	if (entry == NULL)
 		return M_FALSE;
@@ -640,13 +1144,11 @@ M_bool M_hashtable_multi_len(const M_hashtable_t *h, const void *key, size_t *le
 M_bool M_hashtable_multi_get(const M_hashtable_t *h, const void *key, size_t idx, void **value)
 {
 	struct M_hashtable_bucket *entry;
-	size_t                     hash_idx;
 
 	if (h == NULL || !(h->flags & M_HASHTABLE_MULTI_VALUE) || key == NULL)
 		return M_FALSE;
 
-	hash_idx = HASH_IDX(h, key);
-	entry    = M_hashtable_get_match(h, hash_idx, key);
+	entry = M_hashtable_find(h, key, NULL, NULL);
 
 	if (entry == NULL)
 		return M_FALSE;
@@ -659,14 +1161,12 @@ M_bool M_hashtable_multi_remove(M_hashtable_t *h, const void *key, size_t idx, M
 {
 	struct M_hashtable_bucket *entry;
 	void                      *value;
-	size_t                     hash_idx;
 	size_t                     value_len = 1;
 
 	if (h == NULL || !(h->flags & M_HASHTABLE_MULTI_VALUE) || key == NULL)
 		return M_FALSE;
 
-	hash_idx = HASH_IDX(h, key);
-	entry    = M_hashtable_get_match(h, hash_idx, key);
+	entry = M_hashtable_find(h, key, NULL, NULL);
 
 	if (entry == NULL)
 		return M_FALSE;
@@ -752,9 +1252,15 @@ static M_bool M_hashtable_enumerate_next_unordered(const M_hashtable_t *h, M_has
 		*value = NULL;
 	}
 
-	/* Go though each bucket looking for something in them. */
-	for (i=hashenum->entry.unordered.hash; i<h->size; i++) {
-		ptr = &h->buckets[i];
+	/* Go though each bucket looking for something in them. While an incremental
+	 * rehash is in progress the old bucket list is treated as following the
+	 * current one. */
+	for (i=hashenum->entry.unordered.hash; i<h->size+h->old_size; i++) {
+		if (i < h->size) {
+			ptr = &h->buckets[i];
+		} else {
+			ptr = &h->old_buckets[i - h->size];
+		}
 		/* having a key tell us there is something in the bucket. */
 		if (ptr->key != NULL) {
 			/* We're keeping track of which item in the chain we're currently processing.
@@ -874,6 +1380,28 @@ M_bool M_hashtable_enumerate_next(const M_hashtable_t *h, M_hashtable_enum_t *ha
 }
 
 
+/*! Merge by copying the keys (and values if dest duplicates them) into dest. Used
+ *  when src and dest don't share an arena so pointers can't be moved between them. */
+static void M_hashtable_merge_copy(M_hashtable_t *dest, M_hashtable_t *src)
+{
+	const void         *key;
+	const void         *value;
+	M_hashtable_enum_t  hashenum;
+	M_bool              vals_copied;
+
+	vals_copied = (dest->arena_flags & M_HASHTABLE_ARENA_VALS_STR) || dest->value_duplicate_copy != M_hashtable_duplicate_func_default;
+
+	if (M_hashtable_enumerate(src, &hashenum) != 0) {
+		while (M_hashtable_enumerate_next(src, &hashenum, &key, &value)) {
+			M_hashtable_insert_int(dest, M_FALSE, key, value);
+		}
+	}
+
+	/* Values that were moved instead of copied are now owned by dest. */
+	M_hashtable_destroy(src, vals_copied);
+}
+
+
 void M_hashtable_merge(M_hashtable_t **dest, M_hashtable_t *src)
 {
 	M_hashtable_t                *h3;
@@ -891,6 +1419,11 @@ void M_hashtable_merge(M_hashtable_t **dest, M_hashtable_t *src)
 		return;
 	}
 
+	if ((*dest)->arena != src->arena) {
+		M_hashtable_merge_copy(*dest, src);
+		return;
+	}
+
 	/* Create a h for tracking keys that are already present in dest. These keys will need to be
 	 * destroyed since we can't move them to dest. */
 	M_mem_set(&callbacks, 0, sizeof(callbacks));
@@ -945,7 +1478,7 @@ void M_hashtable_merge(M_hashtable_t **dest, M_hashtable_t *src)
 
 			/* See if we need to rehash it because we added so many entries */
 			if (M_hashtable_exceeds_load(*dest))
-				M_hashtable_rehash_or_destroy(*dest, M_FALSE, M_FALSE);
+				M_hashtable_rehash(*dest);
 		}
 	}
 
@@ -980,7 +1513,7 @@ M_hashtable_t *M_hashtable_duplicate(const M_hashtable_t *h)
 	callbacks.value_free             = h->value_free;
 
 	/* Initialize new h with same parameter as original */
-	dest = M_hashtable_create(h->size, h->fillpct, h->key_hash, h->key_equality, h->flags, &callbacks);
+	dest = M_hashtable_create_arena(h->arena, h->arena_flags, h->size, h->fillpct, h->key_hash, h->key_equality, h->flags, &callbacks);
 
 	/* Enumerate the table to be duplicated, and insert the key/value pairs */
 	if (M_hashtable_enumerate(h, &hashenum) != 0) {
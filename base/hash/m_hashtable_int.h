@@ -0,0 +1,56 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2026 Monetra Technologies, LLC.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef __M_HASHTABLE_INT_H__
+#define __M_HASHTABLE_INT_H__
+
+#include <mstdlib/mstdlib.h>
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+__BEGIN_DECLS
+
+/*! How keys and values are stored by a hashtable using an arena. The duplicate
+ *  callbacks can't allocate from the arena so string types are copied directly
+ *  into it instead. */
+typedef enum {
+	M_HASHTABLE_ARENA_NONE       = 0,      /*!< Keys and values are handled by the callbacks. */
+	M_HASHTABLE_ARENA_KEYS_STR   = 1 << 0, /*!< Keys are strings copied into the arena and never freed. */
+	M_HASHTABLE_ARENA_KEYS_UPPER = 1 << 1, /*!< Keys copied into the arena are upper cased. */
+	M_HASHTABLE_ARENA_KEYS_LOWER = 1 << 2, /*!< Keys copied into the arena are lower cased. */
+	M_HASHTABLE_ARENA_VALS_STR   = 1 << 3  /*!< Values are strings copied into the arena and never freed. */
+} M_hashtable_arena_flags_t;
+
+/* Create a hashtable whose structure, buckets and ordered key list are allocated
+ * from an arena. Nothing is freed, memory left behind by a rehash stays in the
+ * arena until it's reset. A NULL arena is the same as M_hashtable_create().
+ * M_HASHTABLE_MEMPOOL is ignored and M_HASHTABLE_KEYS_SORTED isn't supported when
+ * using an arena. M_hashtable_duplicate() allocates the copy from the same arena. */
+M_hashtable_t *M_hashtable_create_arena(M_arena_t *arena, M_uint32 arena_flags, size_t size, M_uint8 fillpct,
+		M_hashtable_hash_func key_hash, M_sort_compar_t key_equality,
+		M_uint32 flags, const struct M_hashtable_callbacks *callbacks);
+
+__END_DECLS
+
+#endif /* __M_HASHTABLE_INT_H__ */
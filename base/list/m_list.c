@@ -45,6 +45,8 @@ struct M_list {
 
 	M_bool                   multi_insert;     /*!< Are we in a multi-insert operation? */
 	void                    *thunk;            /*!< Variable passed to equality function. */
+
+	M_arena_t               *arena;            /*!< Arena the list and storage are allocated from. May be NULL. */
 };
 
 typedef enum {
@@ -125,6 +127,23 @@ static void M_list_shift_data(M_list_t *d, M_bool force)
 	}
 }
 
+/*! Resize the storage. Arena storage can't be resized so the data is copied
+ *  into a new block and the old one is left in the arena. */
+static void M_list_resize(M_list_t *d, size_t allocated)
+{
+	void **base;
+
+	if (d->arena == NULL) {
+		d->base = M_realloc(d->base, sizeof(*d->base)*allocated);
+	} else {
+		base    = M_arena_alloc(d->arena, sizeof(*d->base)*allocated);
+		M_mem_copy(base, d->start, sizeof(*d->base)*d->elements);
+		d->base = base;
+	}
+	d->allocated = allocated;
+	d->start     = d->base;
+}
+
 /*! Grows the array if necessary. */
 static void M_list_grow(M_list_t *d)
 {
@@ -134,9 +153,7 @@ static void M_list_grow(M_list_t *d)
 
 	M_list_shift_data(d, M_FALSE);
 	if (d->elements == d->allocated) {
-		d->allocated <<= 1;
-		d->base        = M_realloc(d->base, sizeof(*d->base)*d->allocated);
-		d->start       = d->base;
+		M_list_resize(d, d->allocated << 1);
 	}
 }
 
@@ -145,7 +162,8 @@ static void M_list_shrink(M_list_t *d)
 	size_t reduced_size;
 	size_t max_elements;
 
-	if (d == NULL || (d->flags & M_LIST_NEVERSHRINK))
+	/* Shrinking arena storage wouldn't free anything. */
+	if (d == NULL || (d->flags & M_LIST_NEVERSHRINK) || d->arena != NULL)
 		return;
 
 	/* We reduce by half but only when doing so leaves us with at least INITIAL_SIZE allocated space
@@ -154,9 +172,7 @@ static void M_list_shrink(M_list_t *d)
 	max_elements = (size_t)((double)reduced_size / 1.25);
 	if (reduced_size >= INITIAL_SIZE && d->elements <= max_elements) {
 		M_list_shift_data(d, M_TRUE);
-		d->allocated = reduced_size;
-		d->base      = M_realloc(d->base, sizeof(*d->base)*d->allocated);
-		d->start     = d->base;
+		M_list_resize(d, reduced_size);
 	}
 }
 
@@ -367,7 +383,7 @@ static size_t M_list_match_op_val_int(M_list_t *d, const void *val, const void *
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-M_list_t *M_list_create(const struct M_list_callbacks *callbacks, M_uint32 flags)
+static M_list_t *M_list_create_int(M_arena_t *arena, const struct M_list_callbacks *callbacks, M_uint32 flags)
 {
 	M_list_t *d = NULL;
 
@@ -379,10 +395,15 @@ M_list_t *M_list_create(const struct M_list_callbacks *callbacks, M_uint32 flags
 		return NULL;
 	}
 
-	d                   = M_malloc(sizeof(*d));
-	M_mem_set(d, 0, sizeof(*d));
+	if (arena != NULL) {
+		d               = M_arena_alloc_zero(arena, sizeof(*d));
+		d->base         = M_arena_alloc(arena, sizeof(*d->base)*INITIAL_SIZE);
+	} else {
+		d               = M_malloc_zero(sizeof(*d));
+		d->base         = M_malloc(sizeof(*d->base)*INITIAL_SIZE);
+	}
+	d->arena            = arena;
 	d->flags            = flags;
-	d->base             = M_malloc(sizeof(*d->base)*INITIAL_SIZE);
 	d->start            = d->base;
 	d->elements         = 0;
 	d->allocated        = INITIAL_SIZE;
@@ -403,6 +424,18 @@ M_list_t *M_list_create(const struct M_list_callbacks *callbacks, M_uint32 flags
 	return d;
 }
 
+M_list_t *M_list_create(const struct M_list_callbacks *callbacks, M_uint32 flags)
+{
+	return M_list_create_int(NULL, callbacks, flags);
+}
+
+M_list_t *M_list_create_arena(M_arena_t *arena, const struct M_list_callbacks *callbacks, M_uint32 flags)
+{
+	if (arena == NULL)
+		return NULL;
+	return M_list_create_int(arena, callbacks, flags);
+}
+
 void M_list_destroy(M_list_t *d, M_bool destroy_vals)
 {
 	size_t i;
@@ -415,6 +448,10 @@ void M_list_destroy(M_list_t *d, M_bool destroy_vals)
 			d->value_free(d->start[i]);
 		}
 	}
+
+	/* Arena memory is released with the arena. */
+	if (d->arena != NULL)
+		return;
 	M_free(d->base);
 	M_free(d);
 }
@@ -867,7 +904,8 @@ static void M_list_merge_int(M_list_t **dest, M_list_t *src, const M_list_t *dup
 		return;
 	}
 
-	if ((*dest == NULL || M_list_len(*dest) == 0) && dups == NULL) {
+	/* An empty dest is only replaced by src when it won't change where the list is allocated from. */
+	if ((*dest == NULL || (M_list_len(*dest) == 0 && (*dest)->arena == src->arena)) && dups == NULL) {
 		M_list_destroy(*dest, M_TRUE);
 		*dest = src;
 		return;
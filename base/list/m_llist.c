@@ -27,6 +27,7 @@
 
 #include <mstdlib/mstdlib.h>
 #include "m_defs_int.h"
+#include "list/m_llist_int.h"
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
@@ -41,6 +42,8 @@ struct M_llist {
 	M_llist_free_func        value_free;       /*!< Callback for free function */
 
 	M_llist_flags_t          flags;            /*!< Flags controlling behavior. */
+	M_mempool_t             *pool;             /*!< Node pool when M_LLIST_MEMPOOL is set. */
+	M_arena_t               *arena;            /*!< Arena the list and nodes are allocated from. May be NULL. */
 
 	size_t                   elements;         /*!< Number of elements in the list. */
 
@@ -143,7 +146,13 @@ static M_llist_node_t *M_llist_node_create(M_llist_t *d, const void *val, M_llis
 {
 	M_llist_node_t *node;
 
-	node         = M_malloc_zero(sizeof(*node));
+	if (d->arena != NULL) {
+		node = M_arena_alloc_zero(d->arena, sizeof(*node));
+	} else if (d->pool != NULL) {
+		node = M_mempool_alloc(d->pool);
+	} else {
+		node = M_malloc_zero(sizeof(*node));
+	}
 	node->parent = d;
 
 	node->val = M_CAST_OFF_CONST(void *, val);
@@ -160,6 +169,9 @@ static M_llist_node_t *M_llist_node_create(M_llist_t *d, const void *val, M_llis
 
 static void M_llist_node_destory(M_llist_node_t *n, M_bool destroy_val) 
 { 
+	M_mempool_t *pool;
+	M_arena_t   *arena;
+
 	if (n == NULL) 
 		return; 
 
@@ -176,9 +188,17 @@ static void M_llist_node_destory(M_llist_node_t *n, M_bool destroy_val)
 		n->links.unsorted.prev = NULL; 
 	} 
 
+	pool      = n->parent->pool;
+	arena     = n->parent->arena;
 	n->parent = NULL; 
 
-	M_free(n); 
+	if (arena != NULL) {
+		/* Released with the arena. */
+	} else if (pool != NULL) {
+		M_mempool_free(pool, n);
+	} else {
+		M_free(n); 
+	}
 } 
 
 static void M_llist_node_unlink(M_llist_node_t *n)
@@ -490,18 +510,26 @@ static M_bool M_llist_take_remove_node(M_llist_node_t *n, M_bool is_remove, void
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-M_llist_t *M_llist_create(const struct M_llist_callbacks *callbacks, M_uint32 flags)
+static M_llist_t *M_llist_create_int(M_arena_t *arena, const struct M_llist_callbacks *callbacks, M_uint32 flags)
 {
 	M_llist_t *d = NULL;
 
 	if (flags & M_LLIST_SORTED && flags & M_LLIST_CIRCULAR)
 		return NULL;
 
-	d           = M_malloc_zero(sizeof(*d));
+	if (arena != NULL) {
+		d       = M_arena_alloc_zero(arena, sizeof(*d));
+	} else {
+		d       = M_malloc_zero(sizeof(*d));
+	}
+	d->arena    = arena;
 	d->flags    = flags;
 	d->elements = 0;
 	d->tail     = NULL;
 
+	if (d->flags & M_LLIST_MEMPOOL && d->arena == NULL)
+		d->pool = M_mempool_create(sizeof(M_llist_node_t), 0);
+
 	if (d->flags & M_LLIST_SORTED) {
 		d->head.sorted.levels     = M_LLIST_START_LEVEL;
 		d->head.sorted.head       = M_malloc_zero(sizeof(*(d->head.sorted.head))*d->head.sorted.levels);
@@ -524,6 +552,20 @@ M_llist_t *M_llist_create(const struct M_llist_callbacks *callbacks, M_uint32 fl
 	return d;
 }
 
+M_llist_t *M_llist_create(const struct M_llist_callbacks *callbacks, M_uint32 flags)
+{
+	return M_llist_create_int(NULL, callbacks, flags);
+}
+
+M_llist_t *M_llist_create_arena(M_arena_t *arena, const struct M_llist_callbacks *callbacks, M_uint32 flags)
+{
+	/* Sorted lists reallocate their levels and hold a random state which can't
+	 * come from the arena. */
+	if (arena == NULL || flags & M_LLIST_SORTED)
+		return NULL;
+	return M_llist_create_int(arena, callbacks, flags);
+}
+
 M_bool M_llist_change_sorting(M_llist_t *d, M_sort_compar_t equality_cb, void *equality_thunk)
 {
 	if (d == NULL || (d->flags & M_LLIST_SORTED) == 0 || M_llist_len(d) > 0) {
@@ -568,7 +610,9 @@ void M_llist_destroy(M_llist_t *d, M_bool destroy_vals)
 		M_rand_destroy(d->head.sorted.rand_state);
 	}
 
-	M_free(d);
+	M_mempool_destroy(d->pool);
+	if (d->arena == NULL)
+		M_free(d);
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
@@ -0,0 +1,42 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2026 Monetra Technologies, LLC.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef __M_LLIST_INT_H__
+#define __M_LLIST_INT_H__
+
+#include <mstdlib/mstdlib.h>
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+__BEGIN_DECLS
+
+/* Create a linked list whose structure and nodes are allocated from an arena.
+ * Nothing is freed, removed nodes stay in the arena until it's reset. Values are
+ * still handled by the callbacks. Sorted lists aren't supported and NULL is
+ * returned. Nodes must not be moved to a list that isn't using the same arena. */
+M_llist_t *M_llist_create_arena(M_arena_t *arena, const struct M_llist_callbacks *callbacks, M_uint32 flags);
+
+__END_DECLS
+
+#endif /* __M_LLIST_INT_H__ */
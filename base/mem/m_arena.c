@@ -0,0 +1,252 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2026 Monetra Technologies, LLC.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "m_config.h"
+
+#include <mstdlib/mstdlib.h>
+#include "m_defs_int.h"
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define M_ARENA_CHUNK_SIZE_DEFAULT 8192
+
+typedef struct M_arena_chunk {
+	struct M_arena_chunk *next;
+	size_t                size; /* Usable bytes after the header. */
+	size_t                used;
+} M_arena_chunk_t;
+
+struct M_arena {
+	M_arena_chunk_t *chunks;     /* Standard sized chunks, in the order they're used. */
+	M_arena_chunk_t *cur;        /* Chunk allocations are currently served from. */
+	M_arena_chunk_t *large;      /* Chunks holding a single oversized allocation. */
+	size_t           chunk_size;
+	size_t           used;
+	size_t           allocated;
+};
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static size_t M_arena_align(size_t size)
+{
+	return (size + (M_SAFE_ALIGNMENT-1)) & ~((size_t)M_SAFE_ALIGNMENT-1);
+}
+
+static unsigned char *M_arena_chunk_data(M_arena_chunk_t *chunk)
+{
+	return ((unsigned char *)chunk) + M_arena_align(sizeof(*chunk));
+}
+
+static M_arena_chunk_t *M_arena_chunk_create(M_arena_t *arena, size_t size)
+{
+	M_arena_chunk_t *chunk;
+
+	if (size > SIZE_MAX - M_arena_align(sizeof(*chunk)) - M_SAFE_ALIGNMENT)
+		return NULL;
+
+	/* M_malloc returns memory aligned to M_SAFE_ALIGNMENT and the data
+	 * starts on an aligned offset past the header. */
+	chunk = M_malloc(M_arena_align(sizeof(*chunk)) + size);
+	if (chunk == NULL)
+		return NULL;
+
+	chunk->next       = NULL;
+	chunk->size       = size;
+	chunk->used       = 0;
+	arena->allocated += size;
+
+	return chunk;
+}
+
+static void M_arena_chunks_destroy(M_arena_chunk_t *chunk)
+{
+	M_arena_chunk_t *next;
+
+	while (chunk != NULL) {
+		next = chunk->next;
+		M_free(chunk);
+		chunk = next;
+	}
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+M_arena_t *M_arena_create(size_t chunk_size)
+{
+	M_arena_t *arena;
+
+	if (chunk_size == 0)
+		chunk_size = M_ARENA_CHUNK_SIZE_DEFAULT;
+	chunk_size = M_arena_align(M_MAX(chunk_size, M_SAFE_ALIGNMENT*4));
+
+	arena             = M_malloc_zero(sizeof(*arena));
+	arena->chunk_size = chunk_size;
+
+	return arena;
+}
+
+void M_arena_destroy(M_arena_t *arena)
+{
+	if (arena == NULL)
+		return;
+
+	M_arena_chunks_destroy(arena->chunks);
+	M_arena_chunks_destroy(arena->large);
+	M_free(arena);
+}
+
+void M_arena_reset(M_arena_t *arena)
+{
+	M_arena_chunk_t *chunk;
+
+	if (arena == NULL)
+		return;
+
+	M_arena_chunks_destroy(arena->large);
+	arena->large = NULL;
+
+	arena->allocated = 0;
+	for (chunk=arena->chunks; chunk!=NULL; chunk=chunk->next) {
+		/* Clear what was handed out, same as M_free would have. */
+		M_mem_set(M_arena_chunk_data(chunk), 0, chunk->used);
+		chunk->used       = 0;
+		arena->allocated += chunk->size;
+	}
+
+	arena->cur  = arena->chunks;
+	arena->used = 0;
+}
+
+void *M_arena_alloc(M_arena_t *arena, size_t size)
+{
+	M_arena_chunk_t *chunk;
+	void            *ptr;
+
+	if (arena == NULL || size == 0 || size > SIZE_MAX - M_SAFE_ALIGNMENT)
+		return NULL;
+
+	size = M_arena_align(size);
+
+	/* Large allocations get their own chunk so they don't waste what's left of
+	 * the current one. */
+	if (size > arena->chunk_size / 4) {
+		chunk = M_arena_chunk_create(arena, size);
+		if (chunk == NULL)
+			return NULL;
+		chunk->used  = size;
+		chunk->next  = arena->large;
+		arena->large = chunk;
+		arena->used += size;
+		return M_arena_chunk_data(chunk);
+	}
+
+	/* Move on to the next chunk (kept from before a reset) or chain on a new one. */
+	while (arena->cur == NULL || arena->cur->size - arena->cur->used < size) {
+		if (arena->cur != NULL && arena->cur->next != NULL) {
+			arena->cur = arena->cur->next;
+			continue;
+		}
+
+		chunk = M_arena_chunk_create(arena, arena->chunk_size);
+		if (chunk == NULL)
+			return NULL;
+
+		if (arena->cur == NULL) {
+			arena->chunks = chunk;
+		} else {
+			arena->cur->next = chunk;
+		}
+		arena->cur = chunk;
+	}
+
+	ptr               = M_arena_chunk_data(arena->cur) + arena->cur->used;
+	arena->cur->used += size;
+	arena->used      += size;
+
+	return ptr;
+}
+
+void *M_arena_alloc_zero(M_arena_t *arena, size_t size)
+{
+	void *ptr;
+
+	ptr = M_arena_alloc(arena, size);
+	if (ptr != NULL)
+		M_mem_set(ptr, 0, size);
+
+	return ptr;
+}
+
+void *M_arena_memdup(M_arena_t *arena, const void *src, size_t size)
+{
+	void *ptr;
+
+	if (src == NULL)
+		return NULL;
+
+	ptr = M_arena_alloc(arena, size);
+	if (ptr != NULL)
+		M_mem_copy(ptr, src, size);
+
+	return ptr;
+}
+
+char *M_arena_strdup(M_arena_t *arena, const char *s)
+{
+	if (s == NULL)
+		return NULL;
+	return M_arena_memdup(arena, s, M_str_len(s)+1);
+}
+
+char *M_arena_strdup_max(M_arena_t *arena, const char *s, size_t max)
+{
+	char   *ptr;
+	size_t  len;
+
+	if (s == NULL)
+		return NULL;
+
+	len = M_str_len_max(s, max);
+	ptr = M_arena_alloc(arena, len+1);
+	if (ptr == NULL)
+		return NULL;
+
+	M_mem_copy(ptr, s, len);
+	ptr[len] = '\0';
+
+	return ptr;
+}
+
+size_t M_arena_bytes_used(const M_arena_t *arena)
+{
+	if (arena == NULL)
+		return 0;
+	return arena->used;
+}
+
+size_t M_arena_bytes_allocated(const M_arena_t *arena)
+{
+	if (arena == NULL)
+		return 0;
+	return arena->allocated;
+}
@@ -28,6 +28,7 @@
 
 #include <mstdlib/mstdlib.h>
 #include "m_defs_int.h"
+#include "platform/m_cpu_int.h"
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
  * TODO:
@@ -354,12 +355,286 @@ int M_mem_cmpsort(const void *m1, size_t size1, const void *m2, size_t size2)
 	return memcmp(m1, m2, size1);
 }
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+ * Search kernels
+ *
+ * A multi byte needle is found by comparing the first and last byte of the
+ * needle against a block of positions at once and only comparing the rest of
+ * the needle where both match. Unlike finding the first byte with memchr and
+ * comparing from there this doesn't degrade when the first byte of the needle
+ * is common in the haystack.
+ *
+ * Kernels only handle whole blocks. They return how far they got and the
+ * scalar code handles whatever is left.
+ */
+
+/* Full compare of a candidate whose first and last bytes are known to match. */
+#define M_MEM_MEM_CANDIDATE(pos, needle, needle_len) \
+	((needle_len) <= 2 || memcmp((pos)+1, (needle)+1, (needle_len)-2) == 0)
+
+#if defined(M_CPU_SSE2)
+/* Returns number of positions checked from the start of haystack. */
+static size_t M_mem_mem_sse2(const M_uint8 *haystack, size_t haystack_len, const M_uint8 *needle, size_t needle_len, const M_uint8 **found)
+{
+	const __m128i first = _mm_set1_epi8((char)needle[0]);
+	const __m128i last  = _mm_set1_epi8((char)needle[needle_len-1]);
+	size_t        i;
+
+	for (i=0; i + needle_len - 1 + 16 <= haystack_len; i+=16) {
+		__m128i  f    = _mm_loadu_si128((const __m128i *)(const void *)(haystack + i));
+		__m128i  l    = _mm_loadu_si128((const __m128i *)(const void *)(haystack + i + needle_len - 1));
+		M_uint32 mask = (M_uint32)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(f, first), _mm_cmpeq_epi8(l, last)));
+
+		while (mask != 0) {
+			const M_uint8 *pos = haystack + i + M_CPU_CTZ32(mask);
+			if (M_MEM_MEM_CANDIDATE(pos, needle, needle_len)) {
+				*found = pos;
+				return i;
+			}
+			mask &= mask - 1;
+		}
+	}
+
+	return i;
+}
+
+/* Returns number of positions left unchecked at the start of haystack. */
+static size_t M_mem_rmem_sse2(const M_uint8 *haystack, size_t haystack_len, const M_uint8 *needle, size_t needle_len, const M_uint8 **found)
+{
+	const __m128i first = _mm_set1_epi8((char)needle[0]);
+	const __m128i last  = _mm_set1_epi8((char)needle[needle_len-1]);
+	size_t        end   = haystack_len - needle_len + 1;
+
+	while (end >= 16) {
+		size_t   i    = end - 16;
+		__m128i  f    = _mm_loadu_si128((const __m128i *)(const void *)(haystack + i));
+		__m128i  l    = _mm_loadu_si128((const __m128i *)(const void *)(haystack + i + needle_len - 1));
+		M_uint32 mask = (M_uint32)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(f, first), _mm_cmpeq_epi8(l, last)));
+
+		while (mask != 0) {
+			unsigned int   bit = M_CPU_MSB32(mask);
+			const M_uint8 *pos = haystack + i + bit;
+			if (M_MEM_MEM_CANDIDATE(pos, needle, needle_len)) {
+				*found = pos;
+				return end;
+			}
+			mask &= ~(1U << bit);
+		}
+		end = i;
+	}
+
+	return end;
+}
+
+/* Returns number of bytes counted. */
+static size_t M_mem_count_sse2(const M_uint8 *s, size_t s_len, M_uint8 b, size_t *cnt)
+{
+	const __m128i needle = _mm_set1_epi8((char)b);
+	const __m128i zero   = _mm_setzero_si128();
+	size_t        i      = 0;
+
+	while (i + 16 <= s_len) {
+		__m128i acc = _mm_setzero_si128();
+		__m128i sum;
+		size_t  j;
+
+		/* Matches are -1 so subtracting counts up. A byte lane can only hold
+		 * 255 before it has to be added into the total. */
+		for (j=0; j<255 && i + 16 <= s_len; j++, i+=16) {
+			acc = _mm_sub_epi8(acc, _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(const void *)(s + i)), needle));
+		}
+
+		sum   = _mm_sad_epu8(acc, zero);
+		*cnt += (size_t)_mm_cvtsi128_si32(sum) + (size_t)_mm_cvtsi128_si32(_mm_srli_si128(sum, 8));
+	}
+
+	return i;
+}
+#endif
+
+#if defined(M_CPU_X86_DISPATCH)
+M_CPU_TARGET("avx2")
+static size_t M_mem_mem_avx2(const M_uint8 *haystack, size_t haystack_len, const M_uint8 *needle, size_t needle_len, const M_uint8 **found)
+{
+	const __m256i first = _mm256_set1_epi8((char)needle[0]);
+	const __m256i last  = _mm256_set1_epi8((char)needle[needle_len-1]);
+	size_t        i;
+
+	for (i=0; i + needle_len - 1 + 32 <= haystack_len; i+=32) {
+		__m256i  f    = _mm256_loadu_si256((const __m256i *)(const void *)(haystack + i));
+		__m256i  l    = _mm256_loadu_si256((const __m256i *)(const void *)(haystack + i + needle_len - 1));
+		M_uint32 mask = (M_uint32)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(f, first), _mm256_cmpeq_epi8(l, last)));
+
+		while (mask != 0) {
+			const M_uint8 *pos = haystack + i + M_CPU_CTZ32(mask);
+			if (M_MEM_MEM_CANDIDATE(pos, needle, needle_len)) {
+				*found = pos;
+				return i;
+			}
+			mask &= mask - 1;
+		}
+	}
+
+	return i;
+}
+
+M_CPU_TARGET("avx2")
+static size_t M_mem_rmem_avx2(const M_uint8 *haystack, size_t haystack_len, const M_uint8 *needle, size_t needle_len, const M_uint8 **found)
+{
+	const __m256i first = _mm256_set1_epi8((char)needle[0]);
+	const __m256i last  = _mm256_set1_epi8((char)needle[needle_len-1]);
+	size_t        end   = haystack_len - needle_len + 1;
+
+	while (end >= 32) {
+		size_t   i    = end - 32;
+		__m256i  f    = _mm256_loadu_si256((const __m256i *)(const void *)(haystack + i));
+		__m256i  l    = _mm256_loadu_si256((const __m256i *)(const void *)(haystack + i + needle_len - 1));
+		M_uint32 mask = (M_uint32)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(f, first), _mm256_cmpeq_epi8(l, last)));
+
+		while (mask != 0) {
+			unsigned int   bit = M_CPU_MSB32(mask);
+			const M_uint8 *pos = haystack + i + bit;
+			if (M_MEM_MEM_CANDIDATE(pos, needle, needle_len)) {
+				*found = pos;
+				return end;
+			}
+			mask &= ~(1U << bit);
+		}
+		end = i;
+	}
+
+	return end;
+}
+
+M_CPU_TARGET("avx2")
+static size_t M_mem_count_avx2(const M_uint8 *s, size_t s_len, M_uint8 b, size_t *cnt)
+{
+	const __m256i needle = _mm256_set1_epi8((char)b);
+	const __m256i zero   = _mm256_setzero_si256();
+	size_t        i      = 0;
+
+	while (i + 32 <= s_len) {
+		__m256i acc = _mm256_setzero_si256();
+		__m256i sum;
+		__m128i sum128;
+		size_t  j;
+
+		for (j=0; j<255 && i + 32 <= s_len; j++, i+=32) {
+			acc = _mm256_sub_epi8(acc, _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(const void *)(s + i)), needle));
+		}
+
+		/* At most 255 * 32 matches per block so the total fits in the low 32
+		 * bits, which can be read on 32-bit builds too. */
+		sum    = _mm256_sad_epu8(acc, zero);
+		sum128 = _mm_add_epi64(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+		sum128 = _mm_add_epi64(sum128, _mm_unpackhi_epi64(sum128, sum128));
+		*cnt  += (size_t)(M_uint32)_mm_cvtsi128_si32(sum128);
+	}
+
+	return i;
+}
+#endif
+
+#if defined(M_CPU_NEON)
+/* NEON has no movemask. Narrowing the compare result gives 4 bits per byte
+ * which is just as usable for finding matches. */
+static M_uint64 M_mem_neon_mask(uint8x16_t eq)
+{
+	return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+}
+
+static size_t M_mem_mem_neon(const M_uint8 *haystack, size_t haystack_len, const M_uint8 *needle, size_t needle_len, const M_uint8 **found)
+{
+	const uint8x16_t first = vdupq_n_u8(needle[0]);
+	const uint8x16_t last  = vdupq_n_u8(needle[needle_len-1]);
+	size_t           i;
+
+	for (i=0; i + needle_len - 1 + 16 <= haystack_len; i+=16) {
+		uint8x16_t f    = vld1q_u8(haystack + i);
+		uint8x16_t l    = vld1q_u8(haystack + i + needle_len - 1);
+		M_uint64   mask = M_mem_neon_mask(vandq_u8(vceqq_u8(f, first), vceqq_u8(l, last)));
+
+		while (mask != 0) {
+			const M_uint8 *pos = haystack + i + (M_CPU_CTZ64(mask) / 4);
+			if (M_MEM_MEM_CANDIDATE(pos, needle, needle_len)) {
+				*found = pos;
+				return i;
+			}
+			mask &= ~((M_uint64)0xF << (M_CPU_CTZ64(mask) & ~3U));
+		}
+	}
+
+	return i;
+}
+
+static size_t M_mem_rmem_neon(const M_uint8 *haystack, size_t haystack_len, const M_uint8 *needle, size_t needle_len, const M_uint8 **found)
+{
+	const uint8x16_t first = vdupq_n_u8(needle[0]);
+	const uint8x16_t last  = vdupq_n_u8(needle[needle_len-1]);
+	size_t           end   = haystack_len - needle_len + 1;
+
+	while (end >= 16) {
+		size_t     i    = end - 16;
+		uint8x16_t f    = vld1q_u8(haystack + i);
+		uint8x16_t l    = vld1q_u8(haystack + i + needle_len - 1);
+		M_uint64   mask = M_mem_neon_mask(vandq_u8(vceqq_u8(f, first), vceqq_u8(l, last)));
+
+		while (mask != 0) {
+			unsigned int   nibble = M_CPU_MSB64(mask) / 4;
+			const M_uint8 *pos    = haystack + i + nibble;
+			if (M_MEM_MEM_CANDIDATE(pos, needle, needle_len)) {
+				*found = pos;
+				return end;
+			}
+			mask &= ~((M_uint64)0xF << (nibble * 4));
+		}
+		end = i;
+	}
+
+	return end;
+}
+
+static size_t M_mem_count_neon(const M_uint8 *s, size_t s_len, M_uint8 b, size_t *cnt)
+{
+	const uint8x16_t needle = vdupq_n_u8(b);
+	size_t           i      = 0;
+
+	while (i + 16 <= s_len) {
+		uint8x16_t acc = vdupq_n_u8(0);
+		size_t     j;
+
+		/* Matches are 0xFF, shifting down leaves 1 per match. */
+		for (j=0; j<255 && i + 16 <= s_len; j++, i+=16) {
+			acc = vaddq_u8(acc, vshrq_n_u8(vceqq_u8(vld1q_u8(s + i), needle), 7));
+		}
+
+		*cnt += (size_t)vgetq_lane_u64(vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(acc))), 0) +
+		        (size_t)vgetq_lane_u64(vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(acc))), 1);
+	}
+
+	return i;
+}
+#endif
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
  * Query
  */
 
+/* Byte search backwards. */
+static const M_uint8 *M_mem_rchr(const M_uint8 *s, M_uint8 b, size_t n)
+{
+	while (n-- > 0) {
+		if (s[n] == b) {
+			return s + n;
+		}
+	}
+	return NULL;
+}
+
 void *M_mem_chr(const void *m, M_uint8 b, size_t n)
 {
+	/* The C library's memchr is already vectorized, and picks its
+	 * implementation at run time, on all of the platforms we support. */
 	return m == NULL ? NULL : memchr(m,b,n);
 }
 
@@ -367,9 +642,10 @@ void *M_mem_chr(const void *m, M_uint8 b, size_t n)
 
 void *M_mem_mem(const void *haystack, size_t haystack_len, const void *needle, size_t needle_len)
 {
-	size_t i = 0;
+	const M_uint8 *h   = haystack;
 	const M_uint8 *pos;
 	const M_uint8 *ret = NULL;
+	size_t         i   = 0;
 
 	if (haystack == NULL || haystack_len == 0 || needle_len > haystack_len) {
 		return NULL;
@@ -377,16 +653,33 @@ void *M_mem_mem(const void *haystack, size_t haystack_len, const void *needle, s
 	if (needle == NULL || needle_len == 0) {
 		return M_CAST_OFF_CONST(void *, haystack);
 	}
+	if (needle_len == 1) {
+		return M_mem_chr(haystack, *(const M_uint8 *)needle, haystack_len);
+	}
+
+#if defined(M_CPU_X86_DISPATCH)
+	if (M_cpu_has(M_CPU_FEATURE_AVX2)) {
+		i = M_mem_mem_avx2(h, haystack_len, needle, needle_len, &ret);
+	} else if (M_cpu_has(M_CPU_FEATURE_SSE2)) {
+		i = M_mem_mem_sse2(h, haystack_len, needle, needle_len, &ret);
+	}
+#elif defined(M_CPU_SSE2)
+	i = M_mem_mem_sse2(h, haystack_len, needle, needle_len, &ret);
+#elif defined(M_CPU_NEON)
+	i = M_mem_mem_neon(h, haystack_len, needle, needle_len, &ret);
+#endif
+	if (ret != NULL)
+		return M_CAST_OFF_CONST(M_uint8 *, ret);
 
 	while (i <= haystack_len - needle_len) {
 		/* Lets use memchr to find the first character
 		 * of needle so we don't do a for loop and cycle
 		 * through the entire memory space doing a memcmp
 		 * moving forward one byte at a time */
-		pos = memchr((const M_uint8 *)haystack+i, *(const M_uint8 *)needle, haystack_len - i);
+		pos = memchr(h+i, *(const M_uint8 *)needle, haystack_len - i);
 		if (pos == NULL) break;
 
-		i += (size_t)(pos - ((const M_uint8 *)haystack + i));
+		i += (size_t)(pos - (h + i));
 
 		/* Sanity check, we need to make sure that the current
 		 * position plus the length of needle don't overflow the
@@ -394,10 +687,10 @@ void *M_mem_mem(const void *haystack, size_t haystack_len, const void *needle, s
 		if (i > haystack_len - needle_len) break;
 
 		/* We know the first character matches, do the rest? */
-		if (M_mem_eq((const M_uint8 *)haystack+i, needle, needle_len)) {
+		if (M_mem_eq(h+i, needle, needle_len)) {
 			/* Fugly cast, but stays in line with functions
 			 * like strstr, strchr, memchr, etc */
-			ret = (const M_uint8 *)haystack + i;
+			ret = h + i;
 			break;
 		}
 
@@ -410,9 +703,10 @@ void *M_mem_mem(const void *haystack, size_t haystack_len, const void *needle, s
 
 void *M_mem_rmem(const void *haystack, size_t haystack_len, const void *needle, size_t needle_len)
 {
-	size_t         i;
+	const M_uint8 *h   = haystack;
 	const M_uint8 *ret = NULL;
-	
+	size_t         i;
+
 	if (haystack == NULL || haystack_len == 0)
 		return NULL;
 
@@ -422,9 +716,30 @@ void *M_mem_rmem(const void *haystack, size_t haystack_len, const void *needle,
 	if (needle_len > haystack_len)
 		return NULL;
 
-	for (i=haystack_len-needle_len+1; i-->0; ) {
-		if (M_mem_eq((const M_uint8 *)haystack+i, needle, needle_len)) {
-			ret = (const M_uint8 *)haystack + i;
+	/* Positions left to check, counting up from 0. The kernels also work
+	 * for a single byte needle since the first and last byte are the same. */
+	i = haystack_len - needle_len + 1;
+
+#if defined(M_CPU_X86_DISPATCH)
+	if (M_cpu_has(M_CPU_FEATURE_AVX2)) {
+		i = M_mem_rmem_avx2(h, haystack_len, needle, needle_len, &ret);
+	} else if (M_cpu_has(M_CPU_FEATURE_SSE2)) {
+		i = M_mem_rmem_sse2(h, haystack_len, needle, needle_len, &ret);
+	}
+#elif defined(M_CPU_SSE2)
+	i = M_mem_rmem_sse2(h, haystack_len, needle, needle_len, &ret);
+#elif defined(M_CPU_NEON)
+	i = M_mem_rmem_neon(h, haystack_len, needle, needle_len, &ret);
+#endif
+	if (ret != NULL)
+		return M_CAST_OFF_CONST(M_uint8 *, ret);
+
+	if (needle_len == 1)
+		return M_CAST_OFF_CONST(M_uint8 *, M_mem_rchr(h, *(const M_uint8 *)needle, i));
+
+	while (i-- > 0) {
+		if (h[i] == *(const M_uint8 *)needle && M_mem_eq(h+i, needle, needle_len)) {
+			ret = h + i;
 			break;
 		}
 	}
@@ -459,7 +774,20 @@ size_t M_mem_count(const void *s, size_t s_len, M_uint8 b)
 	}
 	
 	p = s;
-	for (i=0; i<s_len; i++) {
+	i = 0;
+#if defined(M_CPU_X86_DISPATCH)
+	if (M_cpu_has(M_CPU_FEATURE_AVX2)) {
+		i = M_mem_count_avx2(p, s_len, b, &cnt);
+	} else if (M_cpu_has(M_CPU_FEATURE_SSE2)) {
+		i = M_mem_count_sse2(p, s_len, b, &cnt);
+	}
+#elif defined(M_CPU_SSE2)
+	i = M_mem_count_sse2(p, s_len, b, &cnt);
+#elif defined(M_CPU_NEON)
+	i = M_mem_count_neon(p, s_len, b, &cnt);
+#endif
+
+	for (; i<s_len; i++) {
 		if (p[i] == b) cnt++;
 	}
 
@@ -602,67 +930,6 @@ M_uint16 M_mem_calc_crc16_ccitt(const void *s, size_t s_len)
 	return val;
 }
 
-M_uint32 M_mem_calc_crc32(const void *s, size_t s_len)
-{
-	/* Based off of public domain code from here: www.hackersdelight.org/hdcodetxt/crc.c.txt (see crc32c() function)
-	 *
-	 * Using seed of 0xFFFFFFFF, with an inversion of the entire CRC value at the end, to match the
-	 * "standard" CRC32 calculation (the one used in PNG, MPEG-2, gzip, etc).
-	 */
-	M_uint32       val;
-	const M_uint8 *pos;
-	const M_uint8 *end;
-
-	static M_uint32 CRC_TABLE[256] = {
-		0x00000000,0x77073096,0xEE0E612C,0x990951BA,0x076DC419,0x706AF48F,0xE963A535,0x9E6495A3,
-		0x0EDB8832,0x79DCB8A4,0xE0D5E91E,0x97D2D988,0x09B64C2B,0x7EB17CBD,0xE7B82D07,0x90BF1D91,
-		0x1DB71064,0x6AB020F2,0xF3B97148,0x84BE41DE,0x1ADAD47D,0x6DDDE4EB,0xF4D4B551,0x83D385C7,
-		0x136C9856,0x646BA8C0,0xFD62F97A,0x8A65C9EC,0x14015C4F,0x63066CD9,0xFA0F3D63,0x8D080DF5,
-		0x3B6E20C8,0x4C69105E,0xD56041E4,0xA2677172,0x3C03E4D1,0x4B04D447,0xD20D85FD,0xA50AB56B,
-		0x35B5A8FA,0x42B2986C,0xDBBBC9D6,0xACBCF940,0x32D86CE3,0x45DF5C75,0xDCD60DCF,0xABD13D59,
-		0x26D930AC,0x51DE003A,0xC8D75180,0xBFD06116,0x21B4F4B5,0x56B3C423,0xCFBA9599,0xB8BDA50F,
-		0x2802B89E,0x5F058808,0xC60CD9B2,0xB10BE924,0x2F6F7C87,0x58684C11,0xC1611DAB,0xB6662D3D,
-		0x76DC4190,0x01DB7106,0x98D220BC,0xEFD5102A,0x71B18589,0x06B6B51F,0x9FBFE4A5,0xE8B8D433,
-		0x7807C9A2,0x0F00F934,0x9609A88E,0xE10E9818,0x7F6A0DBB,0x086D3D2D,0x91646C97,0xE6635C01,
-		0x6B6B51F4,0x1C6C6162,0x856530D8,0xF262004E,0x6C0695ED,0x1B01A57B,0x8208F4C1,0xF50FC457,
-		0x65B0D9C6,0x12B7E950,0x8BBEB8EA,0xFCB9887C,0x62DD1DDF,0x15DA2D49,0x8CD37CF3,0xFBD44C65,
-		0x4DB26158,0x3AB551CE,0xA3BC0074,0xD4BB30E2,0x4ADFA541,0x3DD895D7,0xA4D1C46D,0xD3D6F4FB,
-		0x4369E96A,0x346ED9FC,0xAD678846,0xDA60B8D0,0x44042D73,0x33031DE5,0xAA0A4C5F,0xDD0D7CC9,
-		0x5005713C,0x270241AA,0xBE0B1010,0xC90C2086,0x5768B525,0x206F85B3,0xB966D409,0xCE61E49F,
-		0x5EDEF90E,0x29D9C998,0xB0D09822,0xC7D7A8B4,0x59B33D17,0x2EB40D81,0xB7BD5C3B,0xC0BA6CAD,
-		0xEDB88320,0x9ABFB3B6,0x03B6E20C,0x74B1D29A,0xEAD54739,0x9DD277AF,0x04DB2615,0x73DC1683,
-		0xE3630B12,0x94643B84,0x0D6D6A3E,0x7A6A5AA8,0xE40ECF0B,0x9309FF9D,0x0A00AE27,0x7D079EB1,
-		0xF00F9344,0x8708A3D2,0x1E01F268,0x6906C2FE,0xF762575D,0x806567CB,0x196C3671,0x6E6B06E7,
-		0xFED41B76,0x89D32BE0,0x10DA7A5A,0x67DD4ACC,0xF9B9DF6F,0x8EBEEFF9,0x17B7BE43,0x60B08ED5,
-		0xD6D6A3E8,0xA1D1937E,0x38D8C2C4,0x4FDFF252,0xD1BB67F1,0xA6BC5767,0x3FB506DD,0x48B2364B,
-		0xD80D2BDA,0xAF0A1B4C,0x36034AF6,0x41047A60,0xDF60EFC3,0xA867DF55,0x316E8EEF,0x4669BE79,
-		0xCB61B38C,0xBC66831A,0x256FD2A0,0x5268E236,0xCC0C7795,0xBB0B4703,0x220216B9,0x5505262F,
-		0xC5BA3BBE,0xB2BD0B28,0x2BB45A92,0x5CB36A04,0xC2D7FFA7,0xB5D0CF31,0x2CD99E8B,0x5BDEAE1D,
-		0x9B64C2B0,0xEC63F226,0x756AA39C,0x026D930A,0x9C0906A9,0xEB0E363F,0x72076785,0x05005713,
-		0x95BF4A82,0xE2B87A14,0x7BB12BAE,0x0CB61B38,0x92D28E9B,0xE5D5BE0D,0x7CDCEFB7,0x0BDBDF21,
-		0x86D3D2D4,0xF1D4E242,0x68DDB3F8,0x1FDA836E,0x81BE16CD,0xF6B9265B,0x6FB077E1,0x18B74777,
-		0x88085AE6,0xFF0F6A70,0x66063BCA,0x11010B5C,0x8F659EFF,0xF862AE69,0x616BFFD3,0x166CCF45,
-		0xA00AE278,0xD70DD2EE,0x4E048354,0x3903B3C2,0xA7672661,0xD06016F7,0x4969474D,0x3E6E77DB,
-		0xAED16A4A,0xD9D65ADC,0x40DF0B66,0x37D83BF0,0xA9BCAE53,0xDEBB9EC5,0x47B2CF7F,0x30B5FFE9,
-		0xBDBDF21C,0xCABAC28A,0x53B39330,0x24B4A3A6,0xBAD03605,0xCDD70693,0x54DE5729,0x23D967BF,
-		0xB3667A2E,0xC4614AB8,0x5D681B02,0x2A6F2B94,0xB40BBE37,0xC30C8EA1,0x5A05DF1B,0x2D02EF8D
-	};
-
-	if (s == NULL || s_len == 0) {
-		return 0;
-	}
-
-	val = 0xFFFFFFFF;
-	pos = (const M_uint8 *)s;
-	end = pos + s_len;
-
-	while (pos < end) {
-		val = (val >> 8) ^ CRC_TABLE[(val ^ *pos) & 0xFF];
-		pos++;
-	}
-	return ~val;
-}
-
 M_bool M_mem_swap_bytes(M_uint8 *s, size_t s_len, size_t idx1, size_t idx2)
 {
 	M_uint8 b;
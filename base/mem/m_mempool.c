@@ -0,0 +1,179 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2026 Monetra Technologies, LLC.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "m_config.h"
+
+#include <mstdlib/mstdlib.h>
+#include "m_defs_int.h"
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define M_MEMPOOL_SLAB_SIZE_DEFAULT 4096
+
+typedef struct M_mempool_slab {
+	struct M_mempool_slab *next;
+} M_mempool_slab_t;
+
+/* Freed objects hold the link to the next free object in their first bytes. */
+typedef struct M_mempool_free {
+	struct M_mempool_free *next;
+} M_mempool_free_t;
+
+struct M_mempool {
+	size_t            obj_size;
+	size_t            slab_objs;
+	M_mempool_slab_t *slabs;      /*!< Newest first. */
+	size_t            slab_used;  /*!< Objects handed out from the newest slab that haven't been freed
+	                                   before. Objects past this have never been used. */
+	M_mempool_free_t *free_list;
+	size_t            num_used;
+	size_t            num_slabs;
+};
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static size_t M_mempool_slab_header_size(void)
+{
+	return (sizeof(M_mempool_slab_t) + (M_SAFE_ALIGNMENT-1)) & ~((size_t)M_SAFE_ALIGNMENT-1);
+}
+
+static unsigned char *M_mempool_slab_objs(M_mempool_slab_t *slab)
+{
+	return ((unsigned char *)slab) + M_mempool_slab_header_size();
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+M_mempool_t *M_mempool_create(size_t obj_size, size_t objs_per_slab)
+{
+	M_mempool_t *pool;
+
+	if (obj_size == 0 || obj_size > SIZE_MAX/2)
+		return NULL;
+
+	/* Every object has to be able to hold the free list link. Objects are
+	 * placed at multiples of obj_size from an M_SAFE_ALIGNMENT aligned base
+	 * so rounding to the pointer size keeps them aligned for any type of
+	 * that size. */
+	obj_size = M_MAX(obj_size, sizeof(M_mempool_free_t));
+	obj_size = (obj_size + (sizeof(void *)-1)) & ~(sizeof(void *)-1);
+
+	if (objs_per_slab == 0)
+		objs_per_slab = M_MAX(M_MEMPOOL_SLAB_SIZE_DEFAULT / obj_size, 8);
+	if (objs_per_slab > (SIZE_MAX - M_mempool_slab_header_size()) / obj_size)
+		return NULL;
+
+	pool            = M_malloc_zero(sizeof(*pool));
+	pool->obj_size  = obj_size;
+	pool->slab_objs = objs_per_slab;
+
+	return pool;
+}
+
+void M_mempool_destroy(M_mempool_t *pool)
+{
+	M_mempool_slab_t *slab;
+	M_mempool_slab_t *next;
+
+	if (pool == NULL)
+		return;
+
+	slab = pool->slabs;
+	while (slab != NULL) {
+		next = slab->next;
+		M_free(slab);
+		slab = next;
+	}
+
+	M_free(pool);
+}
+
+void *M_mempool_alloc(M_mempool_t *pool)
+{
+	M_mempool_free_t *obj;
+	M_mempool_slab_t *slab;
+
+	if (pool == NULL)
+		return NULL;
+
+	/* Reuse a freed object. */
+	if (pool->free_list != NULL) {
+		obj             = pool->free_list;
+		pool->free_list = obj->next;
+		obj->next       = NULL;
+		pool->num_used++;
+		return obj;
+	}
+
+	/* Objects in a new slab are handed out in order instead of being put
+	 * on the free list up front. */
+	if (pool->slabs == NULL || pool->slab_used == pool->slab_objs) {
+		slab            = M_malloc_zero(M_mempool_slab_header_size() + (pool->obj_size * pool->slab_objs));
+		slab->next      = pool->slabs;
+		pool->slabs     = slab;
+		pool->slab_used = 0;
+		pool->num_slabs++;
+	}
+
+	obj = (M_mempool_free_t *)(void *)(M_mempool_slab_objs(pool->slabs) + (pool->obj_size * pool->slab_used));
+	pool->slab_used++;
+	pool->num_used++;
+
+	return obj;
+}
+
+void M_mempool_free(M_mempool_t *pool, void *obj)
+{
+	M_mempool_free_t *entry = obj;
+
+	if (pool == NULL || obj == NULL)
+		return;
+
+	/* Clear the object same as M_free would. */
+	M_mem_set(obj, 0, pool->obj_size);
+
+	entry->next     = pool->free_list;
+	pool->free_list = entry;
+	pool->num_used--;
+}
+
+size_t M_mempool_obj_size(const M_mempool_t *pool)
+{
+	if (pool == NULL)
+		return 0;
+	return pool->obj_size;
+}
+
+size_t M_mempool_num_used(const M_mempool_t *pool)
+{
+	if (pool == NULL)
+		return 0;
+	return pool->num_used;
+}
+
+size_t M_mempool_num_allocated(const M_mempool_t *pool)
+{
+	if (pool == NULL)
+		return 0;
+	return pool->num_slabs * pool->slab_objs;
+}
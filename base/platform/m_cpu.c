@@ -0,0 +1,194 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2026 Monetra Technologies, LLC.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "m_config.h"
+
+#include <stdlib.h>
+
+#include <mstdlib/mstdlib.h>
+#include "platform/m_cpu_int.h"
+
+#if defined(M_CPU_X86_DISPATCH) && !defined(_MSC_VER)
+#  include <cpuid.h>
+#endif
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* Detection result with the high bit set once detection has run. Detection
+ * always produces the same value so threads racing to fill it in is harmless. */
+#define M_CPU_FEATURES_DETECTED (1U << 31)
+
+static volatile M_uint32 M_cpu_features_cache = 0;
+
+static const struct {
+	const char *name;
+	M_uint32    feature;
+} M_cpu_feature_names[] = {
+	{ "sse2",   M_CPU_FEATURE_SSE2   },
+	{ "ssse3",  M_CPU_FEATURE_SSSE3  },
+	{ "sse42",  M_CPU_FEATURE_SSE42  },
+	{ "pclmul", M_CPU_FEATURE_PCLMUL },
+	{ "avx2",   M_CPU_FEATURE_AVX2   },
+	{ "bmi2",   M_CPU_FEATURE_BMI2   },
+	{ "neon",   M_CPU_FEATURE_NEON   },
+	{ NULL, 0 }
+};
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#ifdef M_CPU_X86_DISPATCH
+static void M_cpu_cpuid(M_uint32 leaf, M_uint32 subleaf, M_uint32 *regs)
+{
+#  ifdef _MSC_VER
+	int r[4];
+
+	__cpuidex(r, (int)leaf, (int)subleaf);
+	regs[0] = (M_uint32)r[0];
+	regs[1] = (M_uint32)r[1];
+	regs[2] = (M_uint32)r[2];
+	regs[3] = (M_uint32)r[3];
+#  else
+	unsigned int a;
+	unsigned int b;
+	unsigned int c;
+	unsigned int d;
+
+	__cpuid_count(leaf, subleaf, a, b, c, d);
+	regs[0] = a;
+	regs[1] = b;
+	regs[2] = c;
+	regs[3] = d;
+#  endif
+}
+
+/* Registers the OS saves on a context switch. */
+static M_uint64 M_cpu_xgetbv(void)
+{
+#  ifdef _MSC_VER
+	return _xgetbv(0);
+#  else
+	M_uint32 eax;
+	M_uint32 edx;
+
+	/* Opcode rather than the intrinsic so the file doesn't need -mxsave. */
+	__asm__ __volatile__(".byte 0x0f, 0x01, 0xd0" : "=a"(eax), "=d"(edx) : "c"(0));
+	return ((M_uint64)edx << 32) | eax;
+#  endif
+}
+
+static M_uint32 M_cpu_detect(void)
+{
+	M_uint32 features = M_CPU_FEATURE_SSE2;
+	M_uint32 regs[4];
+	M_uint32 max_leaf;
+	M_bool   os_avx;
+
+	M_cpu_cpuid(0, 0, regs);
+	max_leaf = regs[0];
+	if (max_leaf < 1)
+		return features;
+
+	M_cpu_cpuid(1, 0, regs);
+	if (regs[2] & (1U << 9))
+		features |= M_CPU_FEATURE_SSSE3;
+	if (regs[2] & (1U << 20))
+		features |= M_CPU_FEATURE_SSE42;
+	if (regs[2] & (1U << 1))
+		features |= M_CPU_FEATURE_PCLMUL;
+
+	/* AVX needs the OS to save the YMM registers (OSXSAVE and XCR0 bits 1
+	 * and 2) in addition to the CPU supporting it. */
+	os_avx = ((regs[2] & (1U << 27)) && (regs[2] & (1U << 28)) && (M_cpu_xgetbv() & 0x6) == 0x6) ? M_TRUE : M_FALSE;
+
+	if (max_leaf >= 7) {
+		M_cpu_cpuid(7, 0, regs);
+		if (os_avx && (regs[1] & (1U << 5)))
+			features |= M_CPU_FEATURE_AVX2;
+		if (regs[1] & (1U << 8))
+			features |= M_CPU_FEATURE_BMI2;
+	}
+
+	return features;
+}
+#else
+static M_uint32 M_cpu_detect(void)
+{
+#  if defined(M_CPU_SSE2)
+	return M_CPU_FEATURE_SSE2;
+#  elif defined(M_CPU_NEON)
+	return M_CPU_FEATURE_NEON;
+#  else
+	return M_CPU_FEATURE_NONE;
+#  endif
+}
+#endif
+
+static M_uint32 M_cpu_disabled(void)
+{
+	const char  *env;
+	char       **parts;
+	size_t       num_parts = 0;
+	M_uint32     disabled  = 0;
+	size_t       i;
+	size_t       j;
+
+	env = getenv("MSTDLIB_CPU_DISABLE");
+	if (M_str_isempty(env))
+		return 0;
+
+	parts = M_str_explode_str(',', env, &num_parts);
+	for (i=0; i<num_parts; i++) {
+		M_str_trim(parts[i]);
+		if (M_str_caseeq(parts[i], "all")) {
+			disabled = M_UINT32_MAX;
+			continue;
+		}
+		for (j=0; M_cpu_feature_names[j].name != NULL; j++) {
+			if (M_str_caseeq(parts[i], M_cpu_feature_names[j].name)) {
+				disabled |= M_cpu_feature_names[j].feature;
+			}
+		}
+	}
+	M_str_explode_free(parts, num_parts);
+
+	return disabled;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+M_uint32 M_cpu_features(void)
+{
+	M_uint32 features = M_cpu_features_cache;
+
+	if (!(features & M_CPU_FEATURES_DETECTED)) {
+		features             = (M_cpu_detect() & ~M_cpu_disabled()) | M_CPU_FEATURES_DETECTED;
+		M_cpu_features_cache = features;
+	}
+
+	return features & ~M_CPU_FEATURES_DETECTED;
+}
+
+M_bool M_cpu_has(M_uint32 features)
+{
+	return (M_cpu_features() & features) == features ? M_TRUE : M_FALSE;
+}
@@ -0,0 +1,136 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2026 Monetra Technologies, LLC.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef __M_CPU_INT_H__
+#define __M_CPU_INT_H__
+
+#include <mstdlib/base/m_defs.h>
+#include <mstdlib/base/m_types.h>
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* Instruction sets that are either guaranteed by the target (SSE2 on x86-64,
+ * NEON on AArch64) and can be used directly, or that have to be checked for at
+ * run time before a kernel using them is called.
+ *
+ * Run time kernels need to be compiled for the instruction set without
+ * changing the flags for the rest of the library. GCC and Clang do this with
+ * the target attribute on the function, MSVC allows any intrinsic to be used
+ * anywhere. */
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define M_CPU_SSE2 1
+#  include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  define M_CPU_NEON 1
+#  include <arm_neon.h>
+#endif
+
+#if defined(M_CPU_SSE2) && (defined(_MSC_VER) || \
+	(defined(__clang__) && __clang_major__ >= 4) || \
+	(!defined(__clang__) && defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#  define M_CPU_X86_DISPATCH 1
+#  include <immintrin.h>
+#  if defined(_MSC_VER)
+#    define M_CPU_TARGET(x)
+#  else
+#    define M_CPU_TARGET(x) __attribute__((target(x)))
+#  endif
+#endif
+
+#if defined(_MSC_VER)
+#  include <intrin.h>
+#endif
+
+/* Index of the lowest and highest set bit of a non-zero mask. */
+#if defined(_MSC_VER)
+static __inline unsigned int M_cpu_ctz32(M_uint32 x)
+{
+	unsigned long idx;
+	_BitScanForward(&idx, x);
+	return (unsigned int)idx;
+}
+static __inline unsigned int M_cpu_msb32(M_uint32 x)
+{
+	unsigned long idx;
+	_BitScanReverse(&idx, x);
+	return (unsigned int)idx;
+}
+#  define M_CPU_CTZ32(x) M_cpu_ctz32(x)
+#  define M_CPU_MSB32(x) M_cpu_msb32(x)
+#  if defined(_M_X64) || defined(_M_ARM64)
+static __inline unsigned int M_cpu_ctz64(M_uint64 x)
+{
+	unsigned long idx;
+	_BitScanForward64(&idx, x);
+	return (unsigned int)idx;
+}
+static __inline unsigned int M_cpu_msb64(M_uint64 x)
+{
+	unsigned long idx;
+	_BitScanReverse64(&idx, x);
+	return (unsigned int)idx;
+}
+#    define M_CPU_CTZ64(x) M_cpu_ctz64(x)
+#    define M_CPU_MSB64(x) M_cpu_msb64(x)
+#  endif
+#else
+#  define M_CPU_CTZ32(x) ((unsigned int)__builtin_ctz(x))
+#  define M_CPU_MSB32(x) (31 - (unsigned int)__builtin_clz(x))
+#  define M_CPU_CTZ64(x) ((unsigned int)__builtin_ctzll(x))
+#  define M_CPU_MSB64(x) (63 - (unsigned int)__builtin_clzll(x))
+#endif
+
+typedef enum {
+	M_CPU_FEATURE_NONE   = 0,
+	M_CPU_FEATURE_SSE2   = 1 << 0,
+	M_CPU_FEATURE_SSSE3  = 1 << 1,
+	M_CPU_FEATURE_SSE42  = 1 << 2,
+	M_CPU_FEATURE_PCLMUL = 1 << 3,
+	M_CPU_FEATURE_AVX2   = 1 << 4,
+	M_CPU_FEATURE_BMI2   = 1 << 5,
+	M_CPU_FEATURE_NEON   = 1 << 6
+} M_cpu_feature_t;
+
+/*! Instruction sets available on the running CPU.
+ *
+ * Detected once and cached. Setting the environment variable
+ * MSTDLIB_CPU_DISABLE to a comma separated list of feature names
+ * (sse2, ssse3, sse42, pclmul, avx2, bmi2, neon, or all) before the first
+ * call masks them off so the fallback paths can be tested and compared.
+ * Features the build relies on unconditionally (SSE2 on x86-64, NEON on
+ * AArch64) can only be masked off for kernels that check for them.
+ *
+ * \return M_cpu_feature_t flags.
+ */
+M_API M_uint32 M_cpu_features(void);
+
+/*! Check if all of the given features are available.
+ *
+ * \param[in] features M_cpu_feature_t flags.
+ *
+ * \return M_TRUE if all are available.
+ */
+M_API M_bool M_cpu_has(M_uint32 features);
+
+#endif /* __M_CPU_INT_H__ */
@@ -70,36 +70,6 @@ static size_t M_utf8_cp_width(M_uint32 cp)
 	return 4;
 }
 
-static M_bool M_utf8_validate_int(const char *str, const char **endptr, size_t *len)
-{
-	M_utf8_error_t res = M_UTF8_ERROR_SUCCESS;
-
-	if (M_str_isempty(str))
-		return 0;
-
-	while (res == M_UTF8_ERROR_SUCCESS && *str != '\0') {
-		const char *next = NULL;
-
-		if (endptr != NULL) {
-			*endptr = str;
-		}
-
-		res = M_utf8_get_cp(str, NULL, &next);
-		str = next;
-
-		if (len != NULL) {
-			(*len)++;
-		}
-	}
-	if (res != M_UTF8_ERROR_SUCCESS)
-		return M_FALSE;
-
-	/* Set the end pointer to the NULL terminator. */
-	if (endptr != NULL)
-		*endptr = str;
-	return M_TRUE;
-}
-
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 M_bool M_utf8_is_valid(const char *str, const char **endptr)
@@ -110,7 +80,7 @@ M_bool M_utf8_is_valid(const char *str, const char **endptr)
 	if (M_str_isempty(str))
 		return M_TRUE;
 
-	return M_utf8_validate_int(str, endptr, NULL);
+	return M_utf8_is_valid_len(str, M_str_len(str), endptr);
 }
 
 M_bool M_utf8_is_valid_cp(M_uint32 cp)
@@ -218,6 +188,54 @@ M_utf8_error_t M_utf8_get_cp(const char *str, M_uint32 *cp, const char **next)
 	return M_UTF8_ERROR_SUCCESS;
 }
 
+M_utf8_error_t M_utf8_decode_int(const unsigned char *s, size_t len, M_uint32 *cp, size_t *width)
+{
+	M_uint32 mycp;
+	size_t   w;
+	size_t   i;
+
+	if (len == 0)
+		return M_UTF8_ERROR_TRUNCATED;
+
+	if (s[0] <= 0x7F) {
+		*cp    = s[0];
+		*width = 1;
+		return M_UTF8_ERROR_SUCCESS;
+	}
+
+	w = M_utf8_byte_width(s[0]);
+	if (w == 0)
+		return M_UTF8_ERROR_BAD_START;
+
+	for (i=1; i<w; i++) {
+		if (i >= len) {
+			return M_UTF8_ERROR_TRUNCATED;
+		}
+
+		if (!M_utf8_is_continue(s[i])) {
+			return M_UTF8_ERROR_EXPECT_CONTINUE;
+		}
+	}
+
+	if (w == 2) {
+		mycp = ((M_uint32)(s[0] & 0x1F) << 6) | (M_uint32)(s[1] & 0x3F);
+	} else if (w == 3) {
+		mycp = ((M_uint32)(s[0] & 0x0F) << 12) | ((M_uint32)(s[1] & 0x3F) << 6) | (M_uint32)(s[2] & 0x3F);
+	} else {
+		mycp = ((M_uint32)(s[0] & 0x07) << 18) | ((M_uint32)(s[1] & 0x3F) << 12) | ((M_uint32)(s[2] & 0x3F) << 6) | (M_uint32)(s[3] & 0x3F);
+	}
+
+	if (!M_utf8_is_valid_cp(mycp))
+		return M_UTF8_ERROR_BAD_CODE_POINT;
+
+	if (w != M_utf8_cp_width(mycp))
+		return M_UTF8_ERROR_OVERLONG;
+
+	*cp    = mycp;
+	*width = w;
+	return M_UTF8_ERROR_SUCCESS;
+}
+
 M_utf8_error_t M_utf8_get_chr(const char *str, char *buf, size_t buf_size, size_t *len, const char **next)
 {
 	M_utf8_error_t res;
@@ -316,11 +334,24 @@ M_utf8_error_t M_utf8_from_cp_buf(M_buf_t *buf, M_uint32 cp)
 
 size_t M_utf8_cnt(const char *str)
 {
-	size_t len = 0;
+	size_t len;
+	size_t cnt = 0;
+	size_t i;
 
-	if (!M_utf8_validate_int(str, NULL, &len))
+	if (M_str_isempty(str))
+		return 0;
+
+	len = M_str_len(str);
+	if (!M_utf8_is_valid_len(str, len, NULL))
 		return 0;
-	return len;
+
+	/* Every character has exactly one byte that isn't a continue. */
+	for (i=0; i<len; i++) {
+		if (((unsigned char)str[i] & 0xC0) != 0x80) {
+			cnt++;
+		}
+	}
+	return cnt;
 }
 
 M_utf8_error_t M_utf8_cp_at(const char *str, size_t idx, M_uint32 *cp)
@@ -0,0 +1,456 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2026 Monetra Technologies, LLC.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "m_utf8_int.h"
+#include "platform/m_cpu_int.h"
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* Most text is largely ascii. Runs of it are converted 16 characters at a time
+ * by widening or narrowing the bytes. Everything else goes a character at a
+ * time through the same validation M_utf8_get_cp uses. */
+
+#if defined(M_CPU_SSE2)
+static size_t M_utf8_ascii_to_utf16(const M_uint8 *s, size_t len, M_uint8 *out, M_bool big)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i       in;
+	size_t        pos  = 0;
+
+	while (pos + 16 <= len) {
+		in = _mm_loadu_si128((const __m128i *)(const void *)(s + pos));
+		if (_mm_movemask_epi8(in) != 0)
+			break;
+		if (big) {
+			_mm_storeu_si128((__m128i *)(void *)(out + pos*2),    _mm_unpacklo_epi8(zero, in));
+			_mm_storeu_si128((__m128i *)(void *)(out + pos*2+16), _mm_unpackhi_epi8(zero, in));
+		} else {
+			_mm_storeu_si128((__m128i *)(void *)(out + pos*2),    _mm_unpacklo_epi8(in, zero));
+			_mm_storeu_si128((__m128i *)(void *)(out + pos*2+16), _mm_unpackhi_epi8(in, zero));
+		}
+		pos += 16;
+	}
+
+	return pos;
+}
+
+static size_t M_utf8_ascii_to_utf32(const M_uint8 *s, size_t len, M_uint8 *out, M_bool big)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i       in;
+	__m128i       lo;
+	__m128i       hi;
+	size_t        pos  = 0;
+
+	while (pos + 16 <= len) {
+		in = _mm_loadu_si128((const __m128i *)(const void *)(s + pos));
+		if (_mm_movemask_epi8(in) != 0)
+			break;
+		if (big) {
+			lo = _mm_unpacklo_epi8(zero, in);
+			hi = _mm_unpackhi_epi8(zero, in);
+			_mm_storeu_si128((__m128i *)(void *)(out + pos*4),    _mm_unpacklo_epi16(zero, lo));
+			_mm_storeu_si128((__m128i *)(void *)(out + pos*4+16), _mm_unpackhi_epi16(zero, lo));
+			_mm_storeu_si128((__m128i *)(void *)(out + pos*4+32), _mm_unpacklo_epi16(zero, hi));
+			_mm_storeu_si128((__m128i *)(void *)(out + pos*4+48), _mm_unpackhi_epi16(zero, hi));
+		} else {
+			lo = _mm_unpacklo_epi8(in, zero);
+			hi = _mm_unpackhi_epi8(in, zero);
+			_mm_storeu_si128((__m128i *)(void *)(out + pos*4),    _mm_unpacklo_epi16(lo, zero));
+			_mm_storeu_si128((__m128i *)(void *)(out + pos*4+16), _mm_unpackhi_epi16(lo, zero));
+			_mm_storeu_si128((__m128i *)(void *)(out + pos*4+32), _mm_unpacklo_epi16(hi, zero));
+			_mm_storeu_si128((__m128i *)(void *)(out + pos*4+48), _mm_unpackhi_epi16(hi, zero));
+		}
+		pos += 16;
+	}
+
+	return pos;
+}
+
+/* Returns the number of input bytes consumed, one output byte per 2 input bytes. */
+static size_t M_utf8_ascii_from_utf16(const M_uint8 *s, size_t len, M_uint8 *out, M_bool big)
+{
+	/* Lanes are loaded little endian so big endian input has the bytes swapped. */
+	const __m128i mask = big ? _mm_set1_epi16((short)0x80FF) : _mm_set1_epi16((short)0xFF80);
+	const __m128i zero = _mm_setzero_si128();
+	__m128i       a;
+	__m128i       b;
+	size_t        pos  = 0;
+
+	while (pos + 32 <= len) {
+		a = _mm_loadu_si128((const __m128i *)(const void *)(s + pos));
+		b = _mm_loadu_si128((const __m128i *)(const void *)(s + pos + 16));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(_mm_or_si128(a, b), mask), zero)) != 0xFFFF)
+			break;
+		if (big) {
+			a = _mm_srli_epi16(a, 8);
+			b = _mm_srli_epi16(b, 8);
+		}
+		_mm_storeu_si128((__m128i *)(void *)(out + pos/2), _mm_packus_epi16(a, b));
+		pos += 32;
+	}
+
+	return pos;
+}
+
+/* Returns the number of input bytes consumed, one output byte per 4 input bytes. */
+static size_t M_utf8_ascii_from_utf32(const M_uint8 *s, size_t len, M_uint8 *out, M_bool big)
+{
+	const __m128i mask = big ? _mm_set1_epi32((int)0x80FFFFFF) : _mm_set1_epi32((int)0xFFFFFF80);
+	const __m128i zero = _mm_setzero_si128();
+	__m128i       a;
+	__m128i       b;
+	__m128i       c;
+	__m128i       d;
+	size_t        pos  = 0;
+
+	while (pos + 64 <= len) {
+		a = _mm_loadu_si128((const __m128i *)(const void *)(s + pos));
+		b = _mm_loadu_si128((const __m128i *)(const void *)(s + pos + 16));
+		c = _mm_loadu_si128((const __m128i *)(const void *)(s + pos + 32));
+		d = _mm_loadu_si128((const __m128i *)(const void *)(s + pos + 48));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)), mask), zero)) != 0xFFFF)
+			break;
+		if (big) {
+			a = _mm_srli_epi32(a, 24);
+			b = _mm_srli_epi32(b, 24);
+			c = _mm_srli_epi32(c, 24);
+			d = _mm_srli_epi32(d, 24);
+		}
+		_mm_storeu_si128((__m128i *)(void *)(out + pos/4), _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+		pos += 64;
+	}
+
+	return pos;
+}
+#endif
+
+static void M_utf8_put16(M_uint8 *out, M_uint32 u, M_bool big)
+{
+	if (big) {
+		out[0] = (M_uint8)(u >> 8);
+		out[1] = (M_uint8)u;
+	} else {
+		out[0] = (M_uint8)u;
+		out[1] = (M_uint8)(u >> 8);
+	}
+}
+
+static void M_utf8_put32(M_uint8 *out, M_uint32 u, M_bool big)
+{
+	if (big) {
+		out[0] = (M_uint8)(u >> 24);
+		out[1] = (M_uint8)(u >> 16);
+		out[2] = (M_uint8)(u >> 8);
+		out[3] = (M_uint8)u;
+	} else {
+		out[0] = (M_uint8)u;
+		out[1] = (M_uint8)(u >> 8);
+		out[2] = (M_uint8)(u >> 16);
+		out[3] = (M_uint8)(u >> 24);
+	}
+}
+
+static M_uint32 M_utf8_get16(const M_uint8 *s, M_bool big)
+{
+	if (big)
+		return ((M_uint32)s[0] << 8) | s[1];
+	return ((M_uint32)s[1] << 8) | s[0];
+}
+
+static M_uint32 M_utf8_get32(const M_uint8 *s, M_bool big)
+{
+	if (big)
+		return ((M_uint32)s[0] << 24) | ((M_uint32)s[1] << 16) | ((M_uint32)s[2] << 8) | s[3];
+	return ((M_uint32)s[3] << 24) | ((M_uint32)s[2] << 16) | ((M_uint32)s[1] << 8) | s[0];
+}
+
+/* Encodes a validated code point, returns the number of bytes written. */
+static size_t M_utf8_put_cp(M_uint8 *out, M_uint32 cp)
+{
+	if (cp < 0x80) {
+		out[0] = (M_uint8)cp;
+		return 1;
+	}
+	if (cp < 0x800) {
+		out[0] = (M_uint8)(0xC0 | (cp >> 6));
+		out[1] = (M_uint8)(0x80 | (cp & 0x3F));
+		return 2;
+	}
+	if (cp < 0x10000) {
+		out[0] = (M_uint8)(0xE0 | (cp >> 12));
+		out[1] = (M_uint8)(0x80 | ((cp >> 6) & 0x3F));
+		out[2] = (M_uint8)(0x80 | (cp & 0x3F));
+		return 3;
+	}
+	out[0] = (M_uint8)(0xF0 | (cp >> 18));
+	out[1] = (M_uint8)(0x80 | ((cp >> 12) & 0x3F));
+	out[2] = (M_uint8)(0x80 | ((cp >> 6) & 0x3F));
+	out[3] = (M_uint8)(0x80 | (cp & 0x3F));
+	return 4;
+}
+
+/* Start a direct write large enough for the worst case output. */
+static M_uint8 *M_utf8_convert_start(M_buf_t *buf, size_t len, size_t mul)
+{
+	size_t out_len;
+
+	if (len > SIZE_MAX / mul)
+		return NULL;
+
+	out_len = len * mul;
+	return M_buf_direct_write_start(buf, &out_len);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+M_utf8_error_t M_utf8_to_utf16_buf(const char *str, size_t len, M_endian_t endianness, M_buf_t *buf)
+{
+	const M_uint8  *s   = (const M_uint8 *)str;
+	M_bool          big = (endianness == M_ENDIAN_BIG) ? M_TRUE : M_FALSE;
+	M_uint8        *out;
+	size_t          o   = 0;
+	size_t          pos = 0;
+	size_t          width;
+	M_uint32        cp;
+	M_utf8_error_t  res;
+
+	if (buf == NULL || (str == NULL && len != 0))
+		return M_UTF8_ERROR_INVALID_PARAM;
+
+	if (len == 0)
+		return M_UTF8_ERROR_SUCCESS;
+
+	/* Every utf-8 byte is at most one utf-16 code unit. */
+	out = M_utf8_convert_start(buf, len, 2);
+	if (out == NULL)
+		return M_UTF8_ERROR_INVALID_PARAM;
+
+	while (pos < len) {
+		if (s[pos] < 0x80) {
+#if defined(M_CPU_SSE2)
+			width  = M_utf8_ascii_to_utf16(s + pos, len - pos, out + o, big);
+			pos   += width;
+			o     += width * 2;
+			if (width != 0)
+				continue;
+#endif
+			M_utf8_put16(out + o, s[pos], big);
+			o += 2;
+			pos++;
+			continue;
+		}
+
+		res = M_utf8_decode_int(s + pos, len - pos, &cp, &width);
+		if (res != M_UTF8_ERROR_SUCCESS) {
+			M_buf_direct_write_end(buf, 0);
+			return res;
+		}
+		pos += width;
+
+		if (cp >= 0x10000) {
+			cp -= 0x10000;
+			M_utf8_put16(out + o, 0xD800 | (cp >> 10), big);
+			M_utf8_put16(out + o + 2, 0xDC00 | (cp & 0x3FF), big);
+			o += 4;
+		} else {
+			M_utf8_put16(out + o, cp, big);
+			o += 2;
+		}
+	}
+
+	M_buf_direct_write_end(buf, o);
+	return M_UTF8_ERROR_SUCCESS;
+}
+
+M_utf8_error_t M_utf8_to_utf32_buf(const char *str, size_t len, M_endian_t endianness, M_buf_t *buf)
+{
+	const M_uint8  *s   = (const M_uint8 *)str;
+	M_bool          big = (endianness == M_ENDIAN_BIG) ? M_TRUE : M_FALSE;
+	M_uint8        *out;
+	size_t          o   = 0;
+	size_t          pos = 0;
+	size_t          width;
+	M_uint32        cp;
+	M_utf8_error_t  res;
+
+	if (buf == NULL || (str == NULL && len != 0))
+		return M_UTF8_ERROR_INVALID_PARAM;
+
+	if (len == 0)
+		return M_UTF8_ERROR_SUCCESS;
+
+	out = M_utf8_convert_start(buf, len, 4);
+	if (out == NULL)
+		return M_UTF8_ERROR_INVALID_PARAM;
+
+	while (pos < len) {
+		if (s[pos] < 0x80) {
+#if defined(M_CPU_SSE2)
+			width  = M_utf8_ascii_to_utf32(s + pos, len - pos, out + o, big);
+			pos   += width;
+			o     += width * 4;
+			if (width != 0)
+				continue;
+#endif
+			M_utf8_put32(out + o, s[pos], big);
+			o += 4;
+			pos++;
+			continue;
+		}
+
+		res = M_utf8_decode_int(s + pos, len - pos, &cp, &width);
+		if (res != M_UTF8_ERROR_SUCCESS) {
+			M_buf_direct_write_end(buf, 0);
+			return res;
+		}
+		pos += width;
+
+		M_utf8_put32(out + o, cp, big);
+		o += 4;
+	}
+
+	M_buf_direct_write_end(buf, o);
+	return M_UTF8_ERROR_SUCCESS;
+}
+
+M_utf8_error_t M_utf8_from_utf16_buf(M_buf_t *buf, const unsigned char *data, size_t len, M_endian_t endianness)
+{
+	M_bool    big = (endianness == M_ENDIAN_BIG) ? M_TRUE : M_FALSE;
+	M_uint8  *out;
+	size_t    o   = 0;
+	size_t    pos = 0;
+	M_uint32  cp;
+	M_uint32  lo;
+
+	if (buf == NULL || (data == NULL && len != 0))
+		return M_UTF8_ERROR_INVALID_PARAM;
+
+	if (len == 0)
+		return M_UTF8_ERROR_SUCCESS;
+
+	/* A code unit is at most 3 utf-8 bytes. Surrogate pairs are 4 bytes
+	 * in and out. */
+	out = M_utf8_convert_start(buf, len / 2 + 1, 3);
+	if (out == NULL)
+		return M_UTF8_ERROR_INVALID_PARAM;
+
+	while (pos < len) {
+		if (len - pos < 2) {
+			M_buf_direct_write_end(buf, 0);
+			return M_UTF8_ERROR_TRUNCATED;
+		}
+
+		cp = M_utf8_get16(data + pos, big);
+		if (cp < 0x80) {
+#if defined(M_CPU_SSE2)
+			size_t n = M_utf8_ascii_from_utf16(data + pos, len - pos, out + o, big);
+			pos += n;
+			o   += n / 2;
+			if (n != 0)
+				continue;
+#endif
+			out[o++]  = (M_uint8)cp;
+			pos      += 2;
+			continue;
+		}
+		pos += 2;
+
+		if (cp >= 0xD800 && cp <= 0xDBFF) {
+			if (len - pos < 2) {
+				M_buf_direct_write_end(buf, 0);
+				return M_UTF8_ERROR_TRUNCATED;
+			}
+			lo = M_utf8_get16(data + pos, big);
+			if (lo < 0xDC00 || lo > 0xDFFF) {
+				M_buf_direct_write_end(buf, 0);
+				return M_UTF8_ERROR_BAD_CODE_POINT;
+			}
+			pos += 2;
+			cp   = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+		}
+
+		/* Also catches unpaired low surrogates. */
+		if (!M_utf8_is_valid_cp(cp)) {
+			M_buf_direct_write_end(buf, 0);
+			return M_UTF8_ERROR_BAD_CODE_POINT;
+		}
+
+		o += M_utf8_put_cp(out + o, cp);
+	}
+
+	M_buf_direct_write_end(buf, o);
+	return M_UTF8_ERROR_SUCCESS;
+}
+
+M_utf8_error_t M_utf8_from_utf32_buf(M_buf_t *buf, const unsigned char *data, size_t len, M_endian_t endianness)
+{
+	M_bool    big = (endianness == M_ENDIAN_BIG) ? M_TRUE : M_FALSE;
+	M_uint8  *out;
+	size_t    o   = 0;
+	size_t    pos = 0;
+	M_uint32  cp;
+
+	if (buf == NULL || (data == NULL && len != 0))
+		return M_UTF8_ERROR_INVALID_PARAM;
+
+	if (len == 0)
+		return M_UTF8_ERROR_SUCCESS;
+
+	/* A code point is at most 4 utf-8 bytes. */
+	out = M_utf8_convert_start(buf, len, 1);
+	if (out == NULL)
+		return M_UTF8_ERROR_INVALID_PARAM;
+
+	while (pos < len) {
+		if (len - pos < 4) {
+			M_buf_direct_write_end(buf, 0);
+			return M_UTF8_ERROR_TRUNCATED;
+		}
+
+		cp = M_utf8_get32(data + pos, big);
+		if (cp < 0x80) {
+#if defined(M_CPU_SSE2)
+			size_t n = M_utf8_ascii_from_utf32(data + pos, len - pos, out + o, big);
+			pos += n;
+			o   += n / 4;
+			if (n != 0)
+				continue;
+#endif
+			out[o++]  = (M_uint8)cp;
+			pos      += 4;
+			continue;
+		}
+		pos += 4;
+
+		if (!M_utf8_is_valid_cp(cp)) {
+			M_buf_direct_write_end(buf, 0);
+			return M_UTF8_ERROR_BAD_CODE_POINT;
+		}
+
+		o += M_utf8_put_cp(out + o, cp);
+	}
+
+	M_buf_direct_write_end(buf, o);
+	return M_UTF8_ERROR_SUCCESS;
+}
@@ -40,6 +40,17 @@ typedef struct {
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
+/* Decode a single character from a length bounded buffer. Same validation as
+ * M_utf8_get_cp but a NULL byte is treated as data instead of the end. */
+M_utf8_error_t M_utf8_decode_int(const unsigned char *s, size_t len, M_uint32 *cp, size_t *width);
+
+/* Number of bytes at the start of s that are known to be valid. Always ends
+ * on a character boundary but may stop short of the first error. Anything
+ * after it needs to be checked with M_utf8_decode_int. */
+size_t M_utf8_validate_fast(const unsigned char *s, size_t len);
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
 extern const M_uint32 M_utf8_table_Cc[];
 extern const size_t M_utf8_table_Cc_len;
 
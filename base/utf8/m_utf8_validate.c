@@ -0,0 +1,373 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2026 Monetra Technologies, LLC.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "m_utf8_int.h"
+#include "platform/m_cpu_int.h"
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* Vectorized validation using the lookup algorithm from Keiser and Lemire,
+ * "Validating UTF-8 In Less Than One Instruction Per Byte". Every byte is
+ * classified by the high nibble of the previous byte, the low nibble of the
+ * previous byte and its own high nibble. Each lookup returns a set of error
+ * bits which are only all set for invalid pairs. 3 and 4 byte sequences are
+ * checked by requiring continues 2 and 3 bytes after their lead bytes.
+ *
+ * This validates standard utf-8. We also reject noncharacters, which the
+ * vector check doesn't know about. They're all encoded as EF B7 xx or with
+ * BF BE / BF BF at the end, so any vector with either pair stops the fast
+ * path and the scalar decoder checks it properly. */
+
+#define M_UTF8_TOO_SHORT      0x01 /* 11______ 0_______ or 11______ 11______ */
+#define M_UTF8_TOO_LONG       0x02 /* 0_______ 10______ */
+#define M_UTF8_OVERLONG_3     0x04 /* 11100000 100_____ */
+#define M_UTF8_TOO_LARGE      0x08 /* 11110100 1001____, 11110100 101_____ and above */
+#define M_UTF8_SURROGATE      0x10 /* 11101101 101_____ */
+#define M_UTF8_OVERLONG_2     0x20 /* 1100000_ 10______ */
+#define M_UTF8_TOO_LARGE_1000 0x40 /* 11110101 1000____ and above */
+#define M_UTF8_OVERLONG_4     0x40 /* 11110000 1000____ */
+#define M_UTF8_TWO_CONTS      0x80 /* 10______ 10______ */
+#define M_UTF8_CARRY          (M_UTF8_TOO_SHORT|M_UTF8_TOO_LONG|M_UTF8_TWO_CONTS)
+
+#if defined(M_CPU_X86_DISPATCH) || (defined(M_CPU_NEON) && defined(__aarch64__))
+/* Indexed by the high nibble of the previous byte. */
+static const M_uint8 M_utf8_byte1_high[16] = {
+	M_UTF8_TOO_LONG, M_UTF8_TOO_LONG, M_UTF8_TOO_LONG, M_UTF8_TOO_LONG,
+	M_UTF8_TOO_LONG, M_UTF8_TOO_LONG, M_UTF8_TOO_LONG, M_UTF8_TOO_LONG,
+	M_UTF8_TWO_CONTS, M_UTF8_TWO_CONTS, M_UTF8_TWO_CONTS, M_UTF8_TWO_CONTS,
+	M_UTF8_TOO_SHORT|M_UTF8_OVERLONG_2,
+	M_UTF8_TOO_SHORT,
+	M_UTF8_TOO_SHORT|M_UTF8_OVERLONG_3|M_UTF8_SURROGATE,
+	M_UTF8_TOO_SHORT|M_UTF8_TOO_LARGE|M_UTF8_TOO_LARGE_1000|M_UTF8_OVERLONG_4
+};
+
+/* Indexed by the low nibble of the previous byte. */
+static const M_uint8 M_utf8_byte1_low[16] = {
+	M_UTF8_CARRY|M_UTF8_OVERLONG_3|M_UTF8_OVERLONG_2|M_UTF8_OVERLONG_4,
+	M_UTF8_CARRY|M_UTF8_OVERLONG_2,
+	M_UTF8_CARRY,
+	M_UTF8_CARRY,
+	M_UTF8_CARRY|M_UTF8_TOO_LARGE,
+	M_UTF8_CARRY|M_UTF8_TOO_LARGE|M_UTF8_TOO_LARGE_1000,
+	M_UTF8_CARRY|M_UTF8_TOO_LARGE|M_UTF8_TOO_LARGE_1000,
+	M_UTF8_CARRY|M_UTF8_TOO_LARGE|M_UTF8_TOO_LARGE_1000,
+	M_UTF8_CARRY|M_UTF8_TOO_LARGE|M_UTF8_TOO_LARGE_1000,
+	M_UTF8_CARRY|M_UTF8_TOO_LARGE|M_UTF8_TOO_LARGE_1000,
+	M_UTF8_CARRY|M_UTF8_TOO_LARGE|M_UTF8_TOO_LARGE_1000,
+	M_UTF8_CARRY|M_UTF8_TOO_LARGE|M_UTF8_TOO_LARGE_1000,
+	M_UTF8_CARRY|M_UTF8_TOO_LARGE|M_UTF8_TOO_LARGE_1000,
+	M_UTF8_CARRY|M_UTF8_TOO_LARGE|M_UTF8_TOO_LARGE_1000|M_UTF8_SURROGATE,
+	M_UTF8_CARRY|M_UTF8_TOO_LARGE|M_UTF8_TOO_LARGE_1000,
+	M_UTF8_CARRY|M_UTF8_TOO_LARGE|M_UTF8_TOO_LARGE_1000
+};
+
+/* Indexed by the high nibble of the current byte. */
+static const M_uint8 M_utf8_byte2_high[16] = {
+	M_UTF8_TOO_SHORT, M_UTF8_TOO_SHORT, M_UTF8_TOO_SHORT, M_UTF8_TOO_SHORT,
+	M_UTF8_TOO_SHORT, M_UTF8_TOO_SHORT, M_UTF8_TOO_SHORT, M_UTF8_TOO_SHORT,
+	M_UTF8_TOO_LONG|M_UTF8_OVERLONG_2|M_UTF8_TWO_CONTS|M_UTF8_OVERLONG_3|M_UTF8_TOO_LARGE_1000|M_UTF8_OVERLONG_4,
+	M_UTF8_TOO_LONG|M_UTF8_OVERLONG_2|M_UTF8_TWO_CONTS|M_UTF8_OVERLONG_3|M_UTF8_TOO_LARGE,
+	M_UTF8_TOO_LONG|M_UTF8_OVERLONG_2|M_UTF8_TWO_CONTS|M_UTF8_SURROGATE|M_UTF8_TOO_LARGE,
+	M_UTF8_TOO_LONG|M_UTF8_OVERLONG_2|M_UTF8_TWO_CONTS|M_UTF8_SURROGATE|M_UTF8_TOO_LARGE,
+	M_UTF8_TOO_SHORT, M_UTF8_TOO_SHORT, M_UTF8_TOO_SHORT, M_UTF8_TOO_SHORT
+};
+
+/* Subtracting this from the last vector is non-zero if it ends with a lead
+ * byte that needs more bytes than are left in it. */
+static const M_uint8 M_utf8_incomplete[32] = {
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF0-1, 0xE0-1, 0xC0-1
+};
+#endif
+
+#if defined(M_CPU_X86_DISPATCH)
+
+M_CPU_TARGET("avx2")
+static size_t M_utf8_validate_avx2(const M_uint8 *s, size_t len)
+{
+	const __m256i b1h        = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(const void *)M_utf8_byte1_high));
+	const __m256i b1l        = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(const void *)M_utf8_byte1_low));
+	const __m256i b2h        = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(const void *)M_utf8_byte2_high));
+	const __m256i max_val    = _mm256_loadu_si256((const __m256i *)(const void *)M_utf8_incomplete);
+	const __m256i nibble     = _mm256_set1_epi8(0x0F);
+	__m256i       prev       = _mm256_setzero_si256();
+	__m256i       incomplete = _mm256_setzero_si256();
+	__m256i       in;
+	__m256i       p1;
+	__m256i       p2;
+	__m256i       p3;
+	__m256i       shift;
+	__m256i       err;
+	__m256i       nc;
+	size_t        pos        = 0;
+
+	while (pos + 32 <= len) {
+		in = _mm256_loadu_si256((const __m256i *)(const void *)(s + pos));
+
+		/* All ascii is valid as long as the last vector didn't end mid character. */
+		if (_mm256_movemask_epi8(in) == 0) {
+			if (!_mm256_testz_si256(incomplete, incomplete))
+				break;
+			prev  = in;
+			pos  += 32;
+			continue;
+		}
+
+		shift = _mm256_permute2x128_si256(prev, in, 0x21);
+		p1    = _mm256_alignr_epi8(in, shift, 15);
+		p2    = _mm256_alignr_epi8(in, shift, 14);
+		p3    = _mm256_alignr_epi8(in, shift, 13);
+
+		err = _mm256_and_si256(
+			_mm256_and_si256(
+				_mm256_shuffle_epi8(b1h, _mm256_and_si256(_mm256_srli_epi16(p1, 4), nibble)),
+				_mm256_shuffle_epi8(b1l, _mm256_and_si256(p1, nibble))),
+			_mm256_shuffle_epi8(b2h, _mm256_and_si256(_mm256_srli_epi16(in, 4), nibble)));
+		err = _mm256_xor_si256(err, _mm256_and_si256(_mm256_or_si256(
+			_mm256_subs_epu8(p2, _mm256_set1_epi8(0xE0-0x80)),
+			_mm256_subs_epu8(p3, _mm256_set1_epi8(0xF0-0x80))), _mm256_set1_epi8((char)0x80)));
+
+		nc = _mm256_or_si256(
+			_mm256_and_si256(_mm256_cmpeq_epi8(p1, _mm256_set1_epi8((char)0xEF)), _mm256_cmpeq_epi8(in, _mm256_set1_epi8((char)0xB7))),
+			_mm256_and_si256(_mm256_cmpeq_epi8(p1, _mm256_set1_epi8((char)0xBF)), _mm256_cmpeq_epi8(_mm256_or_si256(in, _mm256_set1_epi8(0x01)), _mm256_set1_epi8((char)0xBF))));
+		err = _mm256_or_si256(err, nc);
+
+		if (!_mm256_testz_si256(err, err))
+			break;
+
+		incomplete  = _mm256_subs_epu8(in, max_val);
+		prev        = in;
+		pos        += 32;
+	}
+
+	return pos;
+}
+
+M_CPU_TARGET("ssse3")
+static size_t M_utf8_validate_ssse3(const M_uint8 *s, size_t len)
+{
+	const __m128i b1h        = _mm_loadu_si128((const __m128i *)(const void *)M_utf8_byte1_high);
+	const __m128i b1l        = _mm_loadu_si128((const __m128i *)(const void *)M_utf8_byte1_low);
+	const __m128i b2h        = _mm_loadu_si128((const __m128i *)(const void *)M_utf8_byte2_high);
+	const __m128i max_val    = _mm_loadu_si128((const __m128i *)(const void *)(M_utf8_incomplete + 16));
+	const __m128i nibble     = _mm_set1_epi8(0x0F);
+	const __m128i zero       = _mm_setzero_si128();
+	__m128i       prev       = _mm_setzero_si128();
+	__m128i       incomplete = _mm_setzero_si128();
+	__m128i       in;
+	__m128i       p1;
+	__m128i       p2;
+	__m128i       p3;
+	__m128i       err;
+	__m128i       nc;
+	size_t        pos        = 0;
+
+	while (pos + 16 <= len) {
+		in = _mm_loadu_si128((const __m128i *)(const void *)(s + pos));
+
+		if (_mm_movemask_epi8(in) == 0) {
+			if (_mm_movemask_epi8(_mm_cmpeq_epi8(incomplete, zero)) != 0xFFFF)
+				break;
+			prev  = in;
+			pos  += 16;
+			continue;
+		}
+
+		p1 = _mm_alignr_epi8(in, prev, 15);
+		p2 = _mm_alignr_epi8(in, prev, 14);
+		p3 = _mm_alignr_epi8(in, prev, 13);
+
+		err = _mm_and_si128(
+			_mm_and_si128(
+				_mm_shuffle_epi8(b1h, _mm_and_si128(_mm_srli_epi16(p1, 4), nibble)),
+				_mm_shuffle_epi8(b1l, _mm_and_si128(p1, nibble))),
+			_mm_shuffle_epi8(b2h, _mm_and_si128(_mm_srli_epi16(in, 4), nibble)));
+		err = _mm_xor_si128(err, _mm_and_si128(_mm_or_si128(
+			_mm_subs_epu8(p2, _mm_set1_epi8(0xE0-0x80)),
+			_mm_subs_epu8(p3, _mm_set1_epi8(0xF0-0x80))), _mm_set1_epi8((char)0x80)));
+
+		nc = _mm_or_si128(
+			_mm_and_si128(_mm_cmpeq_epi8(p1, _mm_set1_epi8((char)0xEF)), _mm_cmpeq_epi8(in, _mm_set1_epi8((char)0xB7))),
+			_mm_and_si128(_mm_cmpeq_epi8(p1, _mm_set1_epi8((char)0xBF)), _mm_cmpeq_epi8(_mm_or_si128(in, _mm_set1_epi8(0x01)), _mm_set1_epi8((char)0xBF))));
+		err = _mm_or_si128(err, nc);
+
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(err, zero)) != 0xFFFF)
+			break;
+
+		incomplete  = _mm_subs_epu8(in, max_val);
+		prev        = in;
+		pos        += 16;
+	}
+
+	return pos;
+}
+
+#elif defined(M_CPU_NEON) && defined(__aarch64__)
+
+static size_t M_utf8_validate_neon(const M_uint8 *s, size_t len)
+{
+	const uint8x16_t b1h        = vld1q_u8(M_utf8_byte1_high);
+	const uint8x16_t b1l        = vld1q_u8(M_utf8_byte1_low);
+	const uint8x16_t b2h        = vld1q_u8(M_utf8_byte2_high);
+	const uint8x16_t max_val    = vld1q_u8(M_utf8_incomplete + 16);
+	const uint8x16_t nibble     = vdupq_n_u8(0x0F);
+	uint8x16_t       prev       = vdupq_n_u8(0);
+	uint8x16_t       incomplete = vdupq_n_u8(0);
+	uint8x16_t       in;
+	uint8x16_t       p1;
+	uint8x16_t       p2;
+	uint8x16_t       p3;
+	uint8x16_t       err;
+	uint8x16_t       nc;
+	size_t           pos        = 0;
+
+	while (pos + 16 <= len) {
+		in = vld1q_u8(s + pos);
+
+		if (vmaxvq_u8(in) < 0x80) {
+			if (vmaxvq_u8(incomplete) != 0)
+				break;
+			prev  = in;
+			pos  += 16;
+			continue;
+		}
+
+		p1 = vextq_u8(prev, in, 15);
+		p2 = vextq_u8(prev, in, 14);
+		p3 = vextq_u8(prev, in, 13);
+
+		err = vandq_u8(
+			vandq_u8(vqtbl1q_u8(b1h, vshrq_n_u8(p1, 4)), vqtbl1q_u8(b1l, vandq_u8(p1, nibble))),
+			vqtbl1q_u8(b2h, vshrq_n_u8(in, 4)));
+		err = veorq_u8(err, vandq_u8(vorrq_u8(
+			vqsubq_u8(p2, vdupq_n_u8(0xE0-0x80)),
+			vqsubq_u8(p3, vdupq_n_u8(0xF0-0x80))), vdupq_n_u8(0x80)));
+
+		nc = vorrq_u8(
+			vandq_u8(vceqq_u8(p1, vdupq_n_u8(0xEF)), vceqq_u8(in, vdupq_n_u8(0xB7))),
+			vandq_u8(vceqq_u8(p1, vdupq_n_u8(0xBF)), vceqq_u8(vorrq_u8(in, vdupq_n_u8(0x01)), vdupq_n_u8(0xBF))));
+		err = vorrq_u8(err, nc);
+
+		if (vmaxvq_u8(err) != 0)
+			break;
+
+		incomplete  = vqsubq_u8(in, max_val);
+		prev        = in;
+		pos        += 16;
+	}
+
+	return pos;
+}
+
+#endif
+
+/* Skip ascii a word at a time when there are no vector instructions. */
+static size_t M_utf8_validate_ascii(const M_uint8 *s, size_t len)
+{
+	M_uint64 w;
+	size_t   pos = 0;
+
+	while (pos + 8 <= len) {
+		w = (M_uint64)s[pos]         | ((M_uint64)s[pos+1] << 8)  | ((M_uint64)s[pos+2] << 16) | ((M_uint64)s[pos+3] << 24) |
+			((M_uint64)s[pos+4] << 32) | ((M_uint64)s[pos+5] << 40) | ((M_uint64)s[pos+6] << 48) | ((M_uint64)s[pos+7] << 56);
+		if (w & 0x8080808080808080ULL)
+			break;
+		pos += 8;
+	}
+
+	return pos;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+size_t M_utf8_validate_fast(const unsigned char *s, size_t len)
+{
+	size_t pos;
+	size_t end;
+
+#if defined(M_CPU_X86_DISPATCH)
+	if (M_cpu_has(M_CPU_FEATURE_AVX2)) {
+		pos = M_utf8_validate_avx2(s, len);
+	} else if (M_cpu_has(M_CPU_FEATURE_SSSE3)) {
+		pos = M_utf8_validate_ssse3(s, len);
+	} else {
+		pos = M_utf8_validate_ascii(s, len);
+	}
+#elif defined(M_CPU_NEON) && defined(__aarch64__)
+	pos = M_utf8_validate_neon(s, len);
+#else
+	pos = M_utf8_validate_ascii(s, len);
+#endif
+
+	/* The last character before pos might be cut off or only have been
+	 * partially checked. Back up to its lead byte so it's checked again. */
+	end = pos;
+	while (pos > 0 && end - pos < 3 && (s[pos-1] & 0xC0) == 0x80)
+		pos--;
+	if (pos > 0 && s[pos-1] >= 0xC0)
+		pos--;
+
+	return pos;
+}
+
+M_bool M_utf8_is_valid_len(const char *str, size_t len, const char **endptr)
+{
+	const unsigned char *s   = (const unsigned char *)str;
+	size_t               pos = 0;
+	size_t               stop;
+	size_t               width;
+	M_uint32             cp;
+
+	if (endptr != NULL)
+		*endptr = str;
+
+	if (len == 0)
+		return M_TRUE;
+
+	if (str == NULL)
+		return M_FALSE;
+
+	while (pos < len) {
+		pos += M_utf8_validate_fast(s + pos, len - pos);
+		if (pos == len)
+			break;
+
+		/* Decode past whatever stopped the fast path. This is either the
+		 * end, an error, or something it can't check (noncharacters). */
+		stop = pos + 64;
+		if (stop > len)
+			stop = len;
+		while (pos < stop) {
+			if (M_utf8_decode_int(s + pos, len - pos, &cp, &width) != M_UTF8_ERROR_SUCCESS) {
+				if (endptr != NULL)
+					*endptr = str + pos;
+				return M_FALSE;
+			}
+			pos += width;
+		}
+	}
+
+	if (endptr != NULL)
+		*endptr = str + len;
+	return M_TRUE;
+}
@@ -63,6 +63,8 @@
 #cmakedefine HAVE_ALIGNOF
 #cmakedefine HAVE_ACCEPT4
 #cmakedefine HAVE_PIPE2
+#cmakedefine HAVE_RECVMMSG
+#cmakedefine HAVE_SENDMMSG
 #cmakedefine HAVE_CONFSTR
 
 #cmakedefine _FILE_OFFSET_BITS @_FILE_OFFSET_BITS@
@@ -94,6 +96,7 @@
 #cmakedefine HAVE_KQUEUE
 #cmakedefine HAVE_EPOLL
 #cmakedefine HAVE_EPOLL_CREATE1
+#cmakedefine HAVE_IO_URING
 
 #cmakedefine HAVE_DLFCN_H
 #cmakedefine HAVE_DLOPEN
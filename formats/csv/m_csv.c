@@ -26,6 +26,7 @@
 #include <mstdlib/mstdlib.h>
 #include <mstdlib/mstdlib_formats.h>
 #include <mstdlib/mstdlib_text.h>
+#include "csv/m_csv_int.h"
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
@@ -43,31 +44,38 @@ struct M_csv {
 
 static void M_csv_parse_count(const char *str, size_t len, char delim, char quote, size_t *num_rows_out, size_t *num_cols_out)
 {
-	size_t i, row_len = 0;
-	M_bool on_quote   = M_FALSE;
-	size_t num_cols;
-	size_t num_rows;
+	M_csv_index_t index;
+	size_t        num_entries;
+	size_t        row_start = 0;
+	size_t        pos;
+	size_t        i;
+	M_bool        row_len   = M_FALSE;
+	size_t        num_cols;
+	size_t        num_rows;
 
 	/* Count rows, and for first row, count columns */
 	num_cols = num_rows = 0;
-	for (i=0; i<len; i++) {
-		if (str[i] == quote) {
-			row_len++;
-			if (str[i+1] == quote) {
-			   i++; /* Double Quote, skip next char */
-			} else {
-				on_quote = on_quote ? M_FALSE : M_TRUE;
+	M_csv_index_init(&index, str, len, delim, quote);
+	while ((num_entries = M_csv_index_fill(&index)) != 0) {
+		for (i=0; i<num_entries; i++) {
+			pos = M_CSV_INDEX_POS(index.entries[i]);
+			if (str[pos] == delim && num_rows == 0) {
+				/* If still on first row, increment column count */
+				num_cols++;
+			} else if (str[pos] == '\n') {
+				if (num_rows == 0) num_cols++;
+				row_start = pos+1;
+				num_rows++;
 			}
-		} else if (!on_quote && str[i] == delim && num_rows == 0) {
-			row_len++;
-			/* If still on first row, increment column count */
-			num_cols++;
-		} else if (!on_quote && str[i] == '\n') {
-			if (num_rows == 0) num_cols++;
-			row_len = 0;
-			num_rows++;
-		} else if (on_quote || str[i] != '\r') {
-			row_len++;
+		}
+	}
+
+	/* The last row only counts if it has more than carriage returns. Anything
+	 * quoted starts with a quote so checking outside of quotes is enough. */
+	for (i=row_start; i<len; i++) {
+		if (str[i] != '\r' || str[i] == quote || (str[i] == delim && num_rows == 0)) {
+			row_len = M_TRUE;
+			break;
 		}
 	}
 
@@ -78,8 +86,28 @@ static void M_csv_parse_count(const char *str, size_t len, char delim, char quot
 	*num_rows_out = num_rows;
 }
 
+/* Terminated cell. */
+static void M_csv_parse_cell(char **cell, M_bool had_quote, char quote, M_uint32 flags)
+{
+	/* If we know the previous column had quotes, lets
+	 * sanitize that data now */
+	if (had_quote) {
+		M_csv_remove_quotes(*cell, quote);
+		return;
+	}
 
-static void M_csv_remove_quotes(char *str, char quote)
+	if (flags & M_CSV_FLAG_TRIM_WHITESPACE) {
+		/* Trim whitespace if wasn't quoted */
+		M_str_trim(*cell);
+	}
+	/* If empty string and wasn't quoted, record as NULL to differentiate */
+	if (M_str_isempty(*cell)) {
+		*cell = NULL;
+	}
+}
+
+
+void M_csv_remove_quotes(char *str, char quote)
 {
 	size_t len, i, cnt = 0;
 
@@ -177,11 +205,12 @@ void M_csv_destroy(M_csv_t *csv)
 }
 
 
-M_csv_t *M_csv_parse_inplace(char *data, size_t len, char delim, char quote, M_uint32 flags)
+M_csv_t *M_csv_parse_inplace_cols(char *data, size_t len, char delim, char quote, M_uint32 flags, size_t set_num_cols)
 {
+	M_csv_index_t index;
 	size_t num_rows = 0, num_cols = 0;
-	size_t i, outlen;
-	int on_quote = 0, had_quote = 0;
+	size_t i, outlen, num_entries, pos;
+	M_bool had_quote = M_FALSE;
 	char ***out = NULL ,*buf = NULL;
 	size_t row = 0, col = 0;
 	M_csv_t *csv = NULL;
@@ -190,6 +219,8 @@ M_csv_t *M_csv_parse_inplace(char *data, size_t len, char delim, char quote, M_u
 		return NULL;
 
 	M_csv_parse_count(data, len, delim, quote, &num_rows, &num_cols);
+	if (set_num_cols != 0)
+		num_cols = set_num_cols;
 
 	/* Allocate as one large matrix of pointers */
 	outlen = (num_rows * sizeof(*out)) + (num_rows * (num_cols * sizeof(**out)));
@@ -203,103 +234,62 @@ M_csv_t *M_csv_parse_inplace(char *data, size_t len, char delim, char quote, M_u
 		out[i] = (char **)(void *)&buf[num_rows*sizeof(*out) + i*num_cols*sizeof(**out)];
 	}
 
-	/* Set pointers to positions in data for column starts */
+	/* Set pointers to positions in data for column starts. Cells are only
+	 * modified behind the separator being processed which has already been
+	 * indexed. */
 	row       = 0;
 	col       = 0;
-	on_quote  = 0;
-	had_quote = 0;
 	out[row][col] = data;
-	for (i=0; i<len; i++) {
-		if (data[i] == quote) {
-			had_quote = 1;
-			if (on_quote && data[i+1] == quote) {
-				/* Double Quote, skip next char */
-				i++;
-			} else if (on_quote) {
-				on_quote = 0;
-			} else {
-				on_quote = 1;
-			}
-		} else if (!on_quote && data[i] == delim) {
-			data[i] = 0;
-
-			if (col < num_cols) {
-				/* If we know the previous column had quotes, lets
-				 * sanitize that data now */
-				if (had_quote) {
-					M_csv_remove_quotes(out[row][col], quote);
-				} else {
-					if (flags & M_CSV_FLAG_TRIM_WHITESPACE) {
-						/* Trim whitespace if wasn't quoted */
-						M_str_trim(out[row][col]);
-					}
-					/* If empty string and wasn't quoted, record as NULL to differentiate */
-					if (M_str_isempty(out[row][col])) {
-						out[row][col] = NULL;
-					}
+	M_csv_index_init(&index, data, len, delim, quote);
+	while (row < num_rows && (num_entries = M_csv_index_fill(&index)) != 0) {
+		for (i=0; i<num_entries; i++) {
+			pos = M_CSV_INDEX_POS(index.entries[i]);
+			if (M_CSV_INDEX_QUOTED(index.entries[i]))
+				had_quote = M_TRUE;
+
+			if (data[pos] == delim) {
+				data[pos] = 0;
+
+				if (col < num_cols)
+					M_csv_parse_cell(&out[row][col], had_quote, quote, flags);
+				had_quote = M_FALSE;
+
+				col++;
+
+				/* Ensure we don't overflow by one row containing too
+				 * many columns.  We will effectively truncate every
+				 * row that contains more columns than our first row */
+				if (col < num_cols) {
+					out[row][col] = data+(pos+1);
 				}
-			}
-			had_quote = 0;
+			} else if (data[pos] == '\n') {
+				data[pos] = 0;
 
-			col++;
+				if (col < num_cols)
+					M_csv_parse_cell(&out[row][col], had_quote, quote, flags);
 
-			/* Ensure we don't overflow by one row containing too
-			 * many columns.  We will effectively truncate every
-			 * row that contains more columns than our first row */
-			if (col < num_cols) {
-				out[row][col] = data+(i+1);
-			}
-		} else if (!on_quote && data[i] == '\n') {
-			data[i] = 0;
-
-			if (col < num_cols) {
-				/* If we know the previous column had quotes, lets
-				 * sanitize that data now */
-				if (had_quote) {
-					M_csv_remove_quotes(out[row][col], quote);
-				} else {
-					if (flags & M_CSV_FLAG_TRIM_WHITESPACE) {
-						/* Trim whitespace if wasn't quoted */
-						M_str_trim(out[row][col]);
-					}
-					/* If empty string and wasn't quoted, record as NULL to differentiate */
-					if (M_str_isempty(out[row][col])) {
-						out[row][col] = NULL;
-					}
-				}
-			}
-
-			row++;
-			col = 0;
+				row++;
+				col = 0;
 
-			if (row == num_rows)
-				break;
+				if (row == num_rows)
+					break;
 
-			out[row][col] = data+(i+1);
+				out[row][col] = data+(pos+1);
 
-			had_quote = 0;
-		} else if (!on_quote && data[i] == '\r') {
-			data[i] = 0;
+				had_quote = M_FALSE;
+			} else {
+				/* '\r' */
+				data[pos] = 0;
+			}
 		}
 	}
 
 	/* If we know the previous column had quotes, lets
 	 * sanitize that data now */
 	if (row < num_rows && col < num_cols) {
-		/* If we know the previous column had quotes, lets
-		 * sanitize that data now */
-		if (had_quote) {
-			M_csv_remove_quotes(out[row][col], quote);
-		} else {
-			if (flags & M_CSV_FLAG_TRIM_WHITESPACE) {
-				/* Trim whitespace if wasn't quoted */
-				M_str_trim(out[row][col]);
-			}
-			/* If empty string and wasn't quoted, record as NULL to differentiate */
-			if (M_str_isempty(out[row][col])) {
-				out[row][col] = NULL;
-			}
-		}
+		if (index.prev_quote)
+			had_quote = M_TRUE;
+		M_csv_parse_cell(&out[row][col], had_quote, quote, flags);
 	}
 
 	csv = M_malloc(sizeof(*csv));
@@ -319,6 +309,12 @@ M_csv_t *M_csv_parse_inplace(char *data, size_t len, char delim, char quote, M_u
 }
 
 
+M_csv_t *M_csv_parse_inplace(char *data, size_t len, char delim, char quote, M_uint32 flags)
+{
+	return M_csv_parse_inplace_cols(data, len, delim, quote, flags, 0);
+}
+
+
 M_csv_t *M_csv_parse(const char *data, size_t len, char delim, char quote, M_uint32 flags)
 {
 	M_csv_t *csv;
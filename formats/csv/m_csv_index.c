@@ -0,0 +1,314 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2026 Monetra Technologies, LLC.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "m_config.h"
+
+#include <mstdlib/mstdlib.h>
+#include <mstdlib/mstdlib_formats.h>
+#include "csv/m_csv_int.h"
+#include "platform/m_cpu_int.h"
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* Each 64 byte block is classified into a mask of quotes and a mask of
+ * delimiters, new lines and carriage returns with vector compares. Every
+ * quote toggles between being inside and outside of a quoted region, a doubled
+ * quote toggles twice, so the quoted regions are the prefix xor of the quote
+ * mask. Only the kernel that builds the masks depends on the instruction set. */
+
+typedef struct {
+	M_uint64 quote;
+	M_uint64 sep;   /* Delimiter, '\n' and '\r' */
+} M_csv_index_masks_t;
+
+enum {
+	M_CSV_INDEX_ISA_SCALAR = 0,
+	M_CSV_INDEX_ISA_SSE2,
+	M_CSV_INDEX_ISA_AVX2,
+	M_CSV_INDEX_ISA_NEON
+};
+
+/* High bit of every byte in x that is 0, without carries between bytes. */
+static M_uint64 M_csv_index_swar_zero(M_uint64 x)
+{
+	const M_uint64 low7 = 0x7F7F7F7F7F7F7F7FULL;
+
+	return ~(((x & low7) + low7) | x | low7);
+}
+
+/* Eight bytes at a time. Bytes are assembled in memory order so the masks
+ * are the same on any byte order. */
+static void M_csv_index_classify_scalar(const M_csv_index_t *index, const M_uint8 *b, M_csv_index_masks_t *m)
+{
+	const M_uint64 ones  = 0x0101010101010101ULL;
+	const M_uint64 quote = ones * (M_uint8)index->quote;
+	const M_uint64 delim = ones * (M_uint8)index->delim;
+	const M_uint64 nl    = ones * '\n';
+	const M_uint64 cr    = ones * '\r';
+	size_t         i;
+	size_t         j;
+
+	m->quote = 0;
+	m->sep   = 0;
+
+	for (i=0; i<64; i+=8) {
+		M_uint64 w = 0;
+		M_uint64 q;
+		M_uint64 s;
+
+		for (j=8; j-->0; ) {
+			w = (w << 8) | b[i + j];
+		}
+
+		q = M_csv_index_swar_zero(w ^ quote);
+		s = M_csv_index_swar_zero(w ^ delim) | M_csv_index_swar_zero(w ^ nl) | M_csv_index_swar_zero(w ^ cr);
+
+		/* Gather the high bit of each byte into the low 8 bits. */
+		m->quote |= (((q >> 7) * 0x0102040810204080ULL) >> 56) << i;
+		m->sep   |= (((s >> 7) * 0x0102040810204080ULL) >> 56) << i;
+	}
+}
+
+#if defined(M_CPU_SSE2)
+static void M_csv_index_classify_sse2(const M_csv_index_t *index, const M_uint8 *b, M_csv_index_masks_t *m)
+{
+	const __m128i quote = _mm_set1_epi8(index->quote);
+	const __m128i delim = _mm_set1_epi8(index->delim);
+	const __m128i nl    = _mm_set1_epi8('\n');
+	const __m128i cr    = _mm_set1_epi8('\r');
+	size_t        i;
+
+	m->quote = 0;
+	m->sep   = 0;
+
+	for (i=0; i<64; i+=16) {
+		__m128i in  = _mm_loadu_si128((const __m128i *)(const void *)(b + i));
+		__m128i sep = _mm_or_si128(_mm_cmpeq_epi8(in, delim), _mm_or_si128(_mm_cmpeq_epi8(in, nl), _mm_cmpeq_epi8(in, cr)));
+
+		m->quote |= (M_uint64)(M_uint16)_mm_movemask_epi8(_mm_cmpeq_epi8(in, quote)) << i;
+		m->sep   |= (M_uint64)(M_uint16)_mm_movemask_epi8(sep) << i;
+	}
+}
+#endif
+
+#if defined(M_CPU_X86_DISPATCH)
+M_CPU_TARGET("avx2")
+static void M_csv_index_classify_avx2(const M_csv_index_t *index, const M_uint8 *b, M_csv_index_masks_t *m)
+{
+	const __m256i quote = _mm256_set1_epi8(index->quote);
+	const __m256i delim = _mm256_set1_epi8(index->delim);
+	const __m256i nl    = _mm256_set1_epi8('\n');
+	const __m256i cr    = _mm256_set1_epi8('\r');
+	size_t        i;
+
+	m->quote = 0;
+	m->sep   = 0;
+
+	for (i=0; i<64; i+=32) {
+		__m256i in  = _mm256_loadu_si256((const __m256i *)(const void *)(b + i));
+		__m256i sep = _mm256_or_si256(_mm256_cmpeq_epi8(in, delim), _mm256_or_si256(_mm256_cmpeq_epi8(in, nl), _mm256_cmpeq_epi8(in, cr)));
+
+		m->quote |= (M_uint64)(M_uint32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(in, quote)) << i;
+		m->sep   |= (M_uint64)(M_uint32)_mm256_movemask_epi8(sep) << i;
+	}
+}
+#endif
+
+#if defined(M_CPU_NEON) && defined(__aarch64__)
+/* One bit per byte from four compare results. Each byte keeps only its bit
+ * within its group of 8 and pairwise adds collapse the groups. */
+static M_uint64 M_csv_index_neon_mask(uint8x16_t a, uint8x16_t b, uint8x16_t c, uint8x16_t d)
+{
+	static const M_uint8 weights[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+	const uint8x16_t     w           = vld1q_u8(weights);
+	uint8x16_t           sum0;
+	uint8x16_t           sum1;
+
+	sum0 = vpaddq_u8(vandq_u8(a, w), vandq_u8(b, w));
+	sum1 = vpaddq_u8(vandq_u8(c, w), vandq_u8(d, w));
+	sum0 = vpaddq_u8(sum0, sum1);
+	sum0 = vpaddq_u8(sum0, sum0);
+	return vgetq_lane_u64(vreinterpretq_u64_u8(sum0), 0);
+}
+
+static void M_csv_index_classify_neon(const M_csv_index_t *index, const M_uint8 *b, M_csv_index_masks_t *m)
+{
+	const uint8x16_t quote = vdupq_n_u8((M_uint8)index->quote);
+	const uint8x16_t delim = vdupq_n_u8((M_uint8)index->delim);
+	const uint8x16_t nl    = vdupq_n_u8('\n');
+	const uint8x16_t cr    = vdupq_n_u8('\r');
+	uint8x16_t       in[4];
+	uint8x16_t       r[4];
+	size_t           i;
+
+	for (i=0; i<4; i++) {
+		in[i] = vld1q_u8(b + (i * 16));
+	}
+
+	for (i=0; i<4; i++) r[i] = vceqq_u8(in[i], quote);
+	m->quote = M_csv_index_neon_mask(r[0], r[1], r[2], r[3]);
+	for (i=0; i<4; i++) r[i] = vorrq_u8(vceqq_u8(in[i], delim), vorrq_u8(vceqq_u8(in[i], nl), vceqq_u8(in[i], cr)));
+	m->sep   = M_csv_index_neon_mask(r[0], r[1], r[2], r[3]);
+}
+#endif
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* Each bit is the xor of itself and every bit below it. Quote bits become
+ * runs covering each quoted region from the opening quote up to, not
+ * including, the closing quote. */
+static M_uint64 M_csv_index_prefix_xor(M_uint64 x)
+{
+	x ^= x << 1;
+	x ^= x << 2;
+	x ^= x << 4;
+	x ^= x << 8;
+	x ^= x << 16;
+	x ^= x << 32;
+	return x;
+}
+
+static void M_csv_index_block(M_csv_index_t *index, const M_csv_index_masks_t *m, size_t base, M_uint64 valid)
+{
+	size_t   *out   = index->entries + index->num_entries;
+	M_uint64  quote = m->quote & valid;
+	M_uint64  in_quote;
+	M_uint64  bits;
+
+	in_quote             = M_csv_index_prefix_xor(quote) ^ index->prev_in_quote;
+	index->prev_in_quote = (M_uint64)0 - (in_quote >> 63);
+
+	/* A quote is never a separator even if it's also the delimiter. */
+	bits = m->sep & valid & ~(in_quote | quote);
+
+	if (quote == 0 && !index->prev_quote) {
+		while (bits != 0) {
+			*out++  = (base + M_CPU_CTZ64(bits)) << 1;
+			bits   &= bits - 1;
+		}
+	} else {
+		/* Flag separators that have a quote between them and the one before. */
+		while (bits != 0) {
+			M_uint64 below = (bits & (~bits + 1)) - 1;
+			size_t   pos   = base + M_CPU_CTZ64(bits);
+
+			if (quote & below)
+				index->prev_quote = M_TRUE;
+			quote &= ~below;
+			bits  &= bits - 1;
+
+			*out++            = (pos << 1) | (index->prev_quote ? 1 : 0);
+			index->prev_quote = M_FALSE;
+		}
+		if (quote != 0) {
+			index->prev_quote = M_TRUE;
+		}
+	}
+
+	index->num_entries = (size_t)(out - index->entries);
+}
+
+static void M_csv_index_classify(const M_csv_index_t *index, const M_uint8 *b, M_csv_index_masks_t *m)
+{
+	switch (index->isa) {
+#if defined(M_CPU_X86_DISPATCH)
+		case M_CSV_INDEX_ISA_AVX2:
+			M_csv_index_classify_avx2(index, b, m);
+			return;
+#endif
+#if defined(M_CPU_SSE2)
+		case M_CSV_INDEX_ISA_SSE2:
+			M_csv_index_classify_sse2(index, b, m);
+			return;
+#endif
+#if defined(M_CPU_NEON) && defined(__aarch64__)
+		case M_CSV_INDEX_ISA_NEON:
+			M_csv_index_classify_neon(index, b, m);
+			return;
+#endif
+		default:
+			break;
+	}
+	M_csv_index_classify_scalar(index, b, m);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+void M_csv_index_init(M_csv_index_t *index, const char *data, size_t len, char delim, char quote)
+{
+	index->data          = data;
+	index->len           = len;
+	index->offset        = 0;
+	index->delim         = delim;
+	index->quote         = quote;
+	index->prev_in_quote = 0;
+	index->prev_quote    = M_FALSE;
+	index->num_entries   = 0;
+
+	index->isa = M_CSV_INDEX_ISA_SCALAR;
+#if defined(M_CPU_X86_DISPATCH)
+	if (M_cpu_has(M_CPU_FEATURE_AVX2)) {
+		index->isa = M_CSV_INDEX_ISA_AVX2;
+	} else if (M_cpu_has(M_CPU_FEATURE_SSE2)) {
+		index->isa = M_CSV_INDEX_ISA_SSE2;
+	}
+#elif defined(M_CPU_SSE2)
+	index->isa = M_CSV_INDEX_ISA_SSE2;
+#elif defined(M_CPU_NEON) && defined(__aarch64__)
+	if (M_cpu_has(M_CPU_FEATURE_NEON))
+		index->isa = M_CSV_INDEX_ISA_NEON;
+#endif
+}
+
+size_t M_csv_index_fill(M_csv_index_t *index)
+{
+	M_csv_index_masks_t m;
+	M_uint8             tail[64];
+	M_uint64            valid;
+	size_t              i;
+
+	index->num_entries = 0;
+
+	/* Blocks can be entirely inside of a cell or quoted region so keep going
+	 * until there is something to return. */
+	while (index->num_entries == 0 && index->offset < index->len) {
+		for (i=0; i<M_CSV_INDEX_BLOCKS && index->offset < index->len; i++) {
+			const M_uint8 *b = (const M_uint8 *)index->data + index->offset;
+
+			/* Bytes past the end of the last partial block are masked off. */
+			valid = ~(M_uint64)0;
+			if (index->len - index->offset < 64) {
+				M_mem_set(tail, 0, sizeof(tail));
+				M_mem_copy(tail, b, index->len - index->offset);
+				b     = tail;
+				valid = ((M_uint64)1 << (index->len - index->offset)) - 1;
+			}
+
+			M_csv_index_classify(index, b, &m);
+			M_csv_index_block(index, &m, index->offset, valid);
+			index->offset += 64;
+		}
+	}
+
+	return index->num_entries;
+}
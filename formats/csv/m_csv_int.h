@@ -0,0 +1,81 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2026 Monetra Technologies, LLC.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef __M_CSV_INT_H__
+#define __M_CSV_INT_H__
+
+#include <mstdlib/mstdlib.h>
+#include <mstdlib/mstdlib_formats.h>
+
+__BEGIN_DECLS
+
+/*! Remove quoting from a cell in place. Doubled quotes are replaced by a single quote. */
+void M_csv_remove_quotes(char *str, char quote);
+
+/*! M_csv_parse_inplace() with the number of columns set instead of taken from
+ * the first row. Used when data is a part of a larger document. 0 to use the
+ * first row. */
+M_csv_t *M_csv_parse_inplace_cols(char *data, size_t len, char delim, char quote, M_uint32 flags, size_t num_cols);
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/*! Number of 64 byte blocks indexed at a time. */
+#define M_CSV_INDEX_BLOCKS 16
+
+/*! Separator index of CSV data.
+ *
+ * Positions of every delimiter, '\n' and '\r' outside of a quoted region in
+ * order. A quote toggles between inside and outside of a quoted region and
+ * is never a separator.
+ *
+ * Entries are the position shifted left by one. The low bit is set when there
+ * is a quote between the separator and the one before it. prev_quote is set
+ * after the last batch when there is a quote after the last separator.
+ *
+ * The data is indexed in batches as entries are consumed. */
+typedef struct {
+	const char *data;
+	size_t      len;
+	size_t      offset;          /*!< Start of the next block to index. */
+	char        delim;
+	char        quote;
+	M_uint64    prev_in_quote;   /*!< All bits set if the last block ended inside a quoted region. */
+	M_bool      prev_quote;      /*!< There is a quote after the last entry. */
+	int         isa;
+	size_t      entries[M_CSV_INDEX_BLOCKS * 64];
+	size_t      num_entries;
+} M_csv_index_t;
+
+#define M_CSV_INDEX_POS(e)    ((e) >> 1)
+#define M_CSV_INDEX_QUOTED(e) ((e) & 1)
+
+/*! Start indexing data. */
+void M_csv_index_init(M_csv_index_t *index, const char *data, size_t len, char delim, char quote);
+
+/*! Index the next batch of blocks. Replaces all entries. Returns the number
+ * of entries, 0 when the end of the data has been reached. */
+size_t M_csv_index_fill(M_csv_index_t *index);
+
+__END_DECLS
+
+#endif /* __M_CSV_INT_H__ */
@@ -0,0 +1,359 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2026 Monetra Technologies, LLC.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "m_config.h"
+
+#include <mstdlib/mstdlib.h>
+#include <mstdlib/mstdlib_formats.h>
+#include "csv/m_csv_int.h"
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* Default amount read from a file at a time. */
+#define M_CSV_READER_READ_SIZE (64*1024)
+
+typedef struct {
+	size_t off;  /*!< Start of the cell in buf. */
+	size_t len;  /*!< Length of the cell. */
+	M_bool null; /*!< Cell was empty and not quoted. */
+} M_csv_reader_cell_t;
+
+struct M_csv_reader {
+	char                 *buf;          /*!< Unconsumed data. Cells are terminated and unquoted in place. */
+	size_t                buf_len;
+	size_t                buf_size;
+	size_t                row_start;    /*!< Start of the row being read. Everything before has been consumed. */
+	size_t                pos;          /*!< Next byte to scan. */
+
+	char                  delim;
+	char                  quote;
+	M_uint32              flags;        /*!< M_CSV_FLAGS */
+	M_uint8               special[256]; /*!< Bytes that need handling outside of a quote. */
+
+	M_bool                finished;     /*!< No more data will be fed. */
+	M_bool                row_done;     /*!< cells holds a complete row that was returned. */
+	M_bool                row_data;     /*!< Row has something other than '\r' in it. */
+	M_bool                on_quote;
+	M_bool                had_quote;    /*!< Current cell has a quote. */
+	size_t                cell_start;
+	size_t                cell_end;     /*!< First '\r' in the current cell. Anything after is dropped. */
+	size_t                num_rows;
+
+	M_csv_reader_cell_t  *cells;
+	size_t                num_cells;
+	size_t                cells_size;
+};
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static void M_csv_reader_row_start(M_csv_reader_t *reader)
+{
+	reader->row_start  = reader->pos;
+	reader->row_done   = M_FALSE;
+	reader->row_data   = M_FALSE;
+	reader->had_quote  = M_FALSE;
+	reader->cell_start = reader->pos;
+	reader->cell_end   = (size_t)-1;
+	reader->num_cells  = 0;
+}
+
+/* Ends the current cell at pos. Handles the cell the same way M_csv_parse does. */
+static void M_csv_reader_cell_end(M_csv_reader_t *reader, size_t pos)
+{
+	M_csv_reader_cell_t *cell;
+	char                *str;
+
+	if (reader->num_cells == reader->cells_size) {
+		reader->cells_size = reader->cells_size == 0 ? 16 : reader->cells_size * 2;
+		reader->cells      = M_realloc(reader->cells, reader->cells_size * sizeof(*reader->cells));
+	}
+	cell = &reader->cells[reader->num_cells++];
+
+	reader->buf[pos] = '\0';
+	str              = reader->buf + reader->cell_start;
+	cell->off        = reader->cell_start;
+	cell->len        = M_MIN(pos, reader->cell_end) - reader->cell_start;
+	cell->null       = M_FALSE;
+
+	if (reader->had_quote) {
+		M_csv_remove_quotes(str, reader->quote);
+		cell->len = M_str_len(str);
+	} else {
+		if (reader->flags & M_CSV_FLAG_TRIM_WHITESPACE) {
+			/* Trim whitespace if wasn't quoted */
+			M_str_trim(str);
+			cell->len = M_str_len(str);
+		}
+		/* If empty string and wasn't quoted, record as NULL to differentiate */
+		if (cell->len == 0) {
+			cell->null = M_TRUE;
+		}
+	}
+
+	reader->had_quote  = M_FALSE;
+	reader->cell_start = pos+1;
+	reader->cell_end   = (size_t)-1;
+}
+
+/* Make room for len more bytes plus a terminator. Data that has already been
+ * consumed is dropped. */
+static void M_csv_reader_reserve(M_csv_reader_t *reader, size_t len)
+{
+	size_t shift;
+	size_t i;
+
+	/* Cells of a row that has been returned are no longer needed. */
+	if (reader->row_done)
+		M_csv_reader_row_start(reader);
+
+	shift = reader->row_start;
+	if (shift != 0) {
+		M_mem_move(reader->buf, reader->buf+shift, reader->buf_len-shift);
+		reader->buf_len    -= shift;
+		reader->row_start   = 0;
+		reader->pos        -= shift;
+		reader->cell_start -= shift;
+		if (reader->cell_end != (size_t)-1)
+			reader->cell_end -= shift;
+		for (i=0; i<reader->num_cells; i++) {
+			reader->cells[i].off -= shift;
+		}
+	}
+
+	if (reader->buf_len + len + 1 <= reader->buf_size)
+		return;
+
+	reader->buf_size = M_size_t_round_up_to_power_of_two(reader->buf_len + len + 1);
+	reader->buf      = M_realloc(reader->buf, reader->buf_size);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+M_csv_reader_t *M_csv_reader_create(char delim, char quote, M_uint32 flags)
+{
+	M_csv_reader_t *reader;
+
+	reader        = M_malloc_zero(sizeof(*reader));
+	reader->delim = delim;
+	reader->quote = quote;
+	reader->flags = flags;
+
+	reader->special[(M_uint8)delim] = 1;
+	reader->special[(M_uint8)quote] = 1;
+	reader->special['\n']           = 1;
+	reader->special['\r']           = 1;
+
+	M_csv_reader_row_start(reader);
+	return reader;
+}
+
+void M_csv_reader_destroy(M_csv_reader_t *reader)
+{
+	if (reader == NULL)
+		return;
+
+	M_free(reader->buf);
+	M_free(reader->cells);
+	M_free(reader);
+}
+
+void M_csv_reader_reset(M_csv_reader_t *reader)
+{
+	if (reader == NULL)
+		return;
+
+	reader->buf_len  = 0;
+	reader->pos      = 0;
+	reader->finished = M_FALSE;
+	reader->on_quote = M_FALSE;
+	reader->num_rows = 0;
+	M_csv_reader_row_start(reader);
+}
+
+void M_csv_reader_feed(M_csv_reader_t *reader, const char *data, size_t len)
+{
+	if (reader == NULL || data == NULL || len == 0 || reader->finished)
+		return;
+
+	M_csv_reader_reserve(reader, len);
+	M_mem_copy(reader->buf+reader->buf_len, data, len);
+	reader->buf_len += len;
+}
+
+M_fs_error_t M_csv_reader_feed_file(M_csv_reader_t *reader, M_fs_file_t *fd, size_t read_size, size_t *read_len)
+{
+	M_fs_error_t res;
+	size_t       len = 0;
+
+	if (read_len != NULL)
+		*read_len = 0;
+
+	if (reader == NULL || fd == NULL || reader->finished)
+		return M_FS_ERROR_INVALID;
+
+	if (read_size == 0)
+		read_size = M_CSV_READER_READ_SIZE;
+
+	/* Read directly into the buffer. */
+	M_csv_reader_reserve(reader, read_size);
+	res = M_fs_file_read(fd, (unsigned char *)reader->buf+reader->buf_len, read_size, &len, M_FS_FILE_RW_NORMAL);
+	if (res != M_FS_ERROR_SUCCESS)
+		return res;
+
+	reader->buf_len += len;
+	if (read_len != NULL)
+		*read_len = len;
+	return M_FS_ERROR_SUCCESS;
+}
+
+void M_csv_reader_finish(M_csv_reader_t *reader)
+{
+	if (reader == NULL)
+		return;
+	reader->finished = M_TRUE;
+}
+
+M_csv_reader_result_t M_csv_reader_next_row(M_csv_reader_t *reader)
+{
+	const M_uint8 *special;
+	char          *buf;
+	char           c;
+	size_t         pos;
+	size_t         len;
+
+	if (reader == NULL)
+		return M_CSV_READER_DONE;
+
+	if (reader->row_done)
+		M_csv_reader_row_start(reader);
+
+	special = reader->special;
+	buf     = reader->buf;
+	pos     = reader->pos;
+	len     = reader->buf_len;
+
+	while (pos < len) {
+		if (reader->on_quote) {
+			/* Everything up to the next quote is part of the cell. */
+			const char *p = M_mem_chr(buf+pos, (M_uint8)reader->quote, len-pos);
+
+			reader->row_data = M_TRUE;
+			if (p == NULL) {
+				pos = len;
+				break;
+			}
+			pos = (size_t)(p - buf);
+
+			/* A doubled quote is an escaped quote and we need the next byte to know. */
+			if (pos+1 == len && !reader->finished)
+				break;
+
+			if (pos+1 < len && buf[pos+1] == reader->quote) {
+				pos += 2;
+			} else {
+				reader->on_quote = M_FALSE;
+				pos++;
+			}
+			continue;
+		}
+
+		c = buf[pos];
+		if (!special[(M_uint8)c]) {
+			reader->row_data = M_TRUE;
+			pos++;
+			while (pos < len && !special[(M_uint8)buf[pos]])
+				pos++;
+			continue;
+		}
+
+		if (c == reader->quote) {
+			reader->row_data  = M_TRUE;
+			reader->had_quote = M_TRUE;
+			reader->on_quote  = M_TRUE;
+			pos++;
+		} else if (c == reader->delim) {
+			reader->row_data = M_TRUE;
+			M_csv_reader_cell_end(reader, pos);
+			pos++;
+		} else if (c == '\n') {
+			M_csv_reader_cell_end(reader, pos);
+			pos++;
+			reader->pos      = pos;
+			reader->row_done = M_TRUE;
+			reader->num_rows++;
+			return M_CSV_READER_ROW;
+		} else if (c == '\r') {
+			buf[pos] = '\0';
+			if (reader->cell_end == (size_t)-1)
+				reader->cell_end = pos;
+			pos++;
+		}
+	}
+	reader->pos = pos;
+
+	if (!reader->finished || reader->pos < reader->buf_len)
+		return M_CSV_READER_NEED_MORE;
+
+	/* Last row doesn't have to end with a new line. */
+	if (!reader->row_data)
+		return M_CSV_READER_DONE;
+
+	/* There is always room for a terminator. */
+	M_csv_reader_cell_end(reader, reader->pos);
+	reader->row_done = M_TRUE;
+	reader->num_rows++;
+	return M_CSV_READER_ROW;
+}
+
+size_t M_csv_reader_num_cells(const M_csv_reader_t *reader)
+{
+	if (reader == NULL || !reader->row_done)
+		return 0;
+	return reader->num_cells;
+}
+
+const char *M_csv_reader_cell(const M_csv_reader_t *reader, size_t idx, size_t *len)
+{
+	const M_csv_reader_cell_t *cell;
+
+	if (len != NULL)
+		*len = 0;
+
+	if (reader == NULL || !reader->row_done || idx >= reader->num_cells)
+		return NULL;
+
+	cell = &reader->cells[idx];
+	if (cell->null)
+		return NULL;
+
+	if (len != NULL)
+		*len = cell->len;
+	return reader->buf + cell->off;
+}
+
+size_t M_csv_reader_num_rows(const M_csv_reader_t *reader)
+{
+	if (reader == NULL)
+		return 0;
+	return reader->num_rows;
+}
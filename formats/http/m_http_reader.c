@@ -219,6 +219,39 @@ static M_http_error_t M_http_reader_trailer_done_func_default(void *thunk)
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
+/* Temporary strings come from the arena when one is set. They're released
+ * when the caller resets the arena instead of individually. */
+static char *M_http_reader_strdup(M_http_reader_t *httpr, const char *s)
+{
+	if (httpr->arena != NULL)
+		return M_arena_strdup(httpr->arena, s);
+	return M_strdup(s);
+}
+
+static char *M_http_reader_parser_strdup(M_http_reader_t *httpr, M_parser_t *parser)
+{
+	char   *out;
+	size_t  len;
+
+	len = M_parser_len(parser);
+	if (httpr->arena == NULL || len == 0)
+		return M_parser_read_strdup(parser, len);
+
+	out = M_arena_alloc(httpr->arena, len+1);
+	if (!M_parser_read_str(parser, len, out, len+1))
+		return NULL;
+	return out;
+}
+
+static void M_http_reader_strfree(M_http_reader_t *httpr, char *s)
+{
+	if (httpr->arena != NULL)
+		return;
+	M_free(s);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
 static M_http_error_t M_http_read_version(M_parser_t *parser, M_http_version_t *version)
 {
 	char *temp;
@@ -373,12 +406,12 @@ static M_http_error_t M_http_read_start_line_response(M_http_reader_t *httpr, M_
 	/* Part 3: Reason phrase
 	 *   "a possibly empty textual phrase describing the status code" */
 	if (M_parser_len(parts[2]) != 0)
-		reason = M_parser_read_strdup(parts[2], M_parser_len(parts[2]));
+		reason = M_http_reader_parser_strdup(httpr, parts[2]);
 
 	/* Send along the data. */
 	res = httpr->cbs.start_func(M_HTTP_MESSAGE_TYPE_RESPONSE, version, M_HTTP_METHOD_UNKNOWN, NULL, (M_uint32)code, reason, httpr->thunk);
 	httpr->msg_type = M_HTTP_MESSAGE_TYPE_RESPONSE;
-	M_free(reason);
+	M_http_reader_strfree(httpr, reason);
 
 	return res;
 }
@@ -397,9 +430,9 @@ static M_http_error_t M_http_read_start_line_request(M_http_reader_t *httpr, M_p
 		return M_HTTP_ERROR_STARTLINE_MALFORMED;
 
 	/* Part 1: Method */
-	temp   = M_parser_read_strdup(parts[0], M_parser_len(parts[0]));
+	temp   = M_http_reader_parser_strdup(httpr, parts[0]);
 	method = M_http_method_from_str(temp);
-	M_free(temp);
+	M_http_reader_strfree(httpr, temp);
 	if (method == M_HTTP_METHOD_UNKNOWN)
 		return M_HTTP_ERROR_REQUEST_METHOD;
 
@@ -412,7 +445,7 @@ static M_http_error_t M_http_read_start_line_request(M_http_reader_t *httpr, M_p
 		httpr->no_body_method = M_TRUE;
 
 	/* Part 2: URI */
-	uri  = M_parser_read_strdup(parts[1], M_parser_len(parts[1]));
+	uri  = M_http_reader_parser_strdup(httpr, parts[1]);
 	http = M_http_create();
 	/* Validate the uri. */
 	if (!M_http_set_uri(http, uri)) {
@@ -431,7 +464,7 @@ static M_http_error_t M_http_read_start_line_request(M_http_reader_t *httpr, M_p
 
 done:
 	M_http_destroy(http);
-	M_free(uri);
+	M_http_reader_strfree(httpr, uri);
 	return res;
 }
 
@@ -545,7 +578,7 @@ static M_http_error_t M_http_read_header(M_http_reader_t *httpr, M_parser_t *par
 		}
 
 		/* Get the key. */
-		key = M_parser_read_strdup(kv[0], M_parser_len(kv[0]));
+		key = M_http_reader_parser_strdup(httpr, kv[0]);
 
 		/* We support a header being sent without a value. If there is a value
  		 * we'll pull it off. */
@@ -553,7 +586,7 @@ static M_http_error_t M_http_read_header(M_http_reader_t *httpr, M_parser_t *par
 		if (num_kv == 2) {
 			/* Spaces between the separator (:) and value are allowed and should be ignored. Consume them. */
 			M_parser_consume_whitespace(kv[1], M_PARSER_WHITESPACE_NONE);
-			val = M_parser_read_strdup(kv[1], M_parser_len(kv[1]));
+			val = M_http_reader_parser_strdup(httpr, kv[1]);
 			M_str_trim(val);
 		}
 
@@ -580,7 +613,7 @@ static M_http_error_t M_http_read_header(M_http_reader_t *httpr, M_parser_t *par
 
 		num_subvals = M_list_str_len(subvals);
 		for (i=0; i<num_subvals; i++) {
-			subval = M_strdup(M_list_str_at(subvals, i));
+			subval = M_http_reader_strdup(httpr, M_list_str_at(subvals, i));
 
 			/* We can't have an empty entry in the value list. */
 			M_str_trim(subval);
@@ -594,20 +627,20 @@ static M_http_error_t M_http_read_header(M_http_reader_t *httpr, M_parser_t *par
 				break;
 			}
 
-			M_free(subval);
+			M_http_reader_strfree(httpr, subval);
 			subval = NULL;
 		}
 
 		M_list_str_destroy(subvals);
-		M_free(subval);
+		M_http_reader_strfree(httpr, subval);
 
 		if (res != M_HTTP_ERROR_SUCCESS) {
 			break;
 		}
 
 end_of_header:
-		M_free(key);
-		M_free(val);
+		M_http_reader_strfree(httpr, key);
+		M_http_reader_strfree(httpr, val);
 		key = NULL;
 		val = NULL;
 		M_parser_split_free(kv, num_kv);
@@ -617,8 +650,8 @@ end_of_header:
 		header = NULL;
 	} while (res == M_HTTP_ERROR_SUCCESS && !(*full_read));
 
-	M_free(key);
-	M_free(val);
+	M_http_reader_strfree(httpr, key);
+	M_http_reader_strfree(httpr, val);
 	M_parser_split_free(kv, num_kv);
 	M_parser_destroy(header);
 	return res;
@@ -1359,3 +1392,10 @@ void M_http_reader_destroy(M_http_reader_t *httpr)
 	M_free(httpr->boundary);
 	M_free(httpr);
 }
+
+void M_http_reader_set_arena(M_http_reader_t *httpr, M_arena_t *arena)
+{
+	if (httpr == NULL)
+		return;
+	httpr->arena = arena;
+}
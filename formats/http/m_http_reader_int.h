@@ -49,6 +49,7 @@ struct M_http_reader {
 	struct M_http_reader_callbacks  cbs;
 	M_http_reader_flags_t           flags;
 	void                           *thunk;
+	M_arena_t                      *arena;
 	char                           *boundary;
 	size_t                          boundary_len;
 	M_http_reader_step_t            rstep;
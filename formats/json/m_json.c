@@ -44,7 +44,8 @@ static void M_json_node_clear(M_json_node_t *node)
 			node->data.json_array = NULL;
 			break;
 		case M_JSON_TYPE_STRING:
-			M_free(node->data.json_string);
+			if (node->arena == NULL)
+				M_free(node->data.json_string);
 			node->data.json_string = NULL;
 			break;
 		case M_JSON_TYPE_INTEGER:
@@ -62,7 +63,8 @@ static void M_json_node_clear(M_json_node_t *node)
 
 static void M_json_node_destroy_int(M_json_node_t *node)
 {
-	if (node == NULL)
+	/* Arena nodes, their children and their containers are released with the arena. */
+	if (node == NULL || node->arena != NULL)
 		return;
 	M_json_node_clear(node);
 	node->parent = NULL;
@@ -149,7 +151,7 @@ static void M_json_node_take_or_destory(M_json_node_t *node, M_bool destroy_valu
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-M_json_node_t *M_json_node_create(M_json_type_t type)
+M_json_node_t *M_json_node_create_arena(M_json_type_t type, M_arena_t *arena)
 {
 	M_json_node_t *out;
 	struct M_list_callbacks array_callbacks = {
@@ -159,16 +161,28 @@ M_json_node_t *M_json_node_create(M_json_type_t type)
 		M_json_node_destroy_int_vp
 	};
 
-	out = M_malloc(sizeof(*out));
-	M_mem_set(out, 0, sizeof(*out));
-	out->type = type;
+	if (arena != NULL) {
+		out = M_arena_alloc_zero(arena, sizeof(*out));
+	} else {
+		out = M_malloc_zero(sizeof(*out));
+	}
+	out->type  = type;
+	out->arena = arena;
 
 	switch (out->type) {
 		case M_JSON_TYPE_OBJECT:
-			out->data.json_object = M_hash_strvp_create(8, 75, M_HASH_STRVP_KEYS_ORDERED, M_json_node_destroy_int_vp);
+			if (arena != NULL) {
+				out->data.json_object = M_hash_strvp_create_arena(arena, 8, 75, M_HASH_STRVP_KEYS_ORDERED, M_json_node_destroy_int_vp);
+			} else {
+				out->data.json_object = M_hash_strvp_create(8, 75, M_HASH_STRVP_KEYS_ORDERED, M_json_node_destroy_int_vp);
+			}
 			break;
 		case M_JSON_TYPE_ARRAY:
-			out->data.json_array = M_list_create(&array_callbacks, M_LIST_NONE);
+			if (arena != NULL) {
+				out->data.json_array = M_list_create_arena(arena, &array_callbacks, M_LIST_NONE);
+			} else {
+				out->data.json_array = M_list_create(&array_callbacks, M_LIST_NONE);
+			}
 			break;
 		case M_JSON_TYPE_STRING:
 		case M_JSON_TYPE_INTEGER:
@@ -179,13 +193,24 @@ M_json_node_t *M_json_node_create(M_json_type_t type)
 		default:
 			/* A valid type was not set for this node. */
 			out->type = M_JSON_TYPE_UNKNOWN;
-			M_free(out);
+			M_json_node_destroy_int(out);
 			return NULL;
 	}
 
 	return out;
 }
 
+M_json_node_t *M_json_node_create(M_json_type_t type)
+{
+	return M_json_node_create_arena(type, NULL);
+}
+
+/*! Create a node for inserting into parent. Uses the parent's arena if it has one. */
+static M_json_node_t *M_json_node_create_child(const M_json_node_t *parent, M_json_type_t type)
+{
+	return M_json_node_create_arena(type, parent != NULL?parent->arena:NULL);
+}
+
 void M_json_node_destroy(M_json_node_t *node)
 {
 	if (node == NULL)
@@ -231,6 +256,99 @@ const char *M_json_errcode_to_str(M_json_error_t err)
 	return "unknown";
 }
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+M_bool M_json_unicode_escape(const char *s, size_t len, char *utf8, size_t *utf8_len)
+{
+	M_uint32 cp;
+
+	if (len < 4 || !M_str_ishex_max(s, 4) || M_str_to_uint32_ex(s, 4, 16, &cp, NULL) != M_STR_INT_SUCCESS)
+		return M_FALSE;
+	return M_utf8_from_cp(utf8, 4, utf8_len, cp) == M_UTF8_ERROR_SUCCESS;
+}
+
+M_json_error_t M_json_unescape(const char *s, size_t len, M_uint32 flags, char *out, size_t *out_len)
+{
+	char          utf8[4];
+	size_t        utf8_len;
+	size_t        i;
+	size_t        j;
+	size_t        o = 0;
+	unsigned char c;
+
+	for (i=0; i<len; i++) {
+		c = (unsigned char)s[i];
+
+		if (c < 32) {
+			if (!(flags & M_JSON_READER_REPLACE_BAD_CHARS))
+				return c == '\n' ? M_JSON_ERROR_UNEXPECTED_NEWLINE : M_JSON_ERROR_UNEXPECTED_CONTROL_CHAR;
+			out[o++] = '?';
+			continue;
+		}
+
+		if (c != '\\') {
+			out[o++] = (char)c;
+			continue;
+		}
+
+		if (i+1 >= len)
+			return M_JSON_ERROR_UNEXPECTED_ESCAPE;
+
+		c = (unsigned char)s[++i];
+		switch (c) {
+			case '"':
+			case '/':
+			case '\\':
+				out[o++] = (char)c;
+				break;
+			case 'b':
+				out[o++] = '\b';
+				break;
+			case 'f':
+				out[o++] = '\f';
+				break;
+			case 'n':
+				out[o++] = '\n';
+				break;
+			case 'r':
+				out[o++] = '\r';
+				break;
+			case 't':
+				out[o++] = '\t';
+				break;
+			case 'u':
+				if (M_json_unicode_escape(s+i+1, len-i-1, utf8, &utf8_len)) {
+					if (flags & M_JSON_READER_DONT_DECODE_UNICODE) {
+						/* Output never passes the input so this is safe in place. */
+						for (j=0; j<6; j++) {
+							out[o++] = s[i-1+j];
+						}
+					} else {
+						M_mem_copy(out+o, utf8, utf8_len);
+						o += utf8_len;
+					}
+					i += 4;
+					break;
+				}
+
+				if (!(flags & M_JSON_READER_REPLACE_BAD_CHARS))
+					return M_JSON_ERROR_INVALID_UNICODE_ESACPE;
+
+				out[o++] = '?';
+				/* Skip over whatever looks like part of the escape. */
+				for (j=0; j<4 && i+1<len && M_chr_ishex(s[i+1]); j++) {
+					i++;
+				}
+				break;
+			default:
+				return M_JSON_ERROR_UNEXPECTED_ESCAPE;
+		}
+	}
+
+	*out_len = o;
+	return M_JSON_ERROR_SUCCESS;
+}
+
 M_json_type_t M_json_node_type(const M_json_node_t *node)
 {
 	if (node == NULL)
@@ -313,7 +431,8 @@ size_t M_json_object_num_children(const M_json_node_t *node)
 
 M_bool M_json_object_insert(M_json_node_t *node, const char *key, M_json_node_t *value)
 {
-	if (node == NULL || node->type != M_JSON_TYPE_OBJECT || value == NULL || value->parent != NULL)
+	/* Arena and non-arena nodes can't be mixed, they'd either leak or dangle. */
+	if (node == NULL || node->type != M_JSON_TYPE_OBJECT || value == NULL || value->parent != NULL || value->arena != node->arena)
 		return M_FALSE;
 
 	if (M_hash_strvp_insert(node->data.json_object, key, (void *)value)) {
@@ -327,7 +446,7 @@ M_bool M_json_object_insert_string(M_json_node_t *node, const char *key, const c
 {
 	M_json_node_t *n;
 
-	n = M_json_node_create(M_JSON_TYPE_STRING);
+	n = M_json_node_create_child(node, M_JSON_TYPE_STRING);
 	if (!M_json_set_string(n, value)) {
 		M_json_node_destroy(n);
 		return M_FALSE;
@@ -345,7 +464,7 @@ M_bool M_json_object_insert_int(M_json_node_t *node, const char *key, M_int64 va
 {
 	M_json_node_t *n;
 
-	n = M_json_node_create(M_JSON_TYPE_INTEGER);
+	n = M_json_node_create_child(node, M_JSON_TYPE_INTEGER);
 	if (!M_json_set_int(n, value)) {
 		M_json_node_destroy(n);
 		return M_FALSE;
@@ -363,7 +482,7 @@ M_bool M_json_object_insert_decimal(M_json_node_t *node, const char *key, const
 {
 	M_json_node_t *n;
 
-	n = M_json_node_create(M_JSON_TYPE_DECIMAL);
+	n = M_json_node_create_child(node, M_JSON_TYPE_DECIMAL);
 	if (!M_json_set_decimal(n, value)) {
 		M_json_node_destroy(n);
 		return M_FALSE;
@@ -381,7 +500,7 @@ M_bool M_json_object_insert_bool(M_json_node_t *node, const char *key, M_bool va
 {
 	M_json_node_t *n;
 
-	n = M_json_node_create(M_JSON_TYPE_BOOL);
+	n = M_json_node_create_child(node, M_JSON_TYPE_BOOL);
 	if (!M_json_set_bool(n, value)) {
 		M_json_node_destroy(n);
 		return M_FALSE;
@@ -437,7 +556,7 @@ M_bool M_json_array_at_bool(const M_json_node_t *node, size_t idx)
 
 M_bool M_json_array_insert(M_json_node_t *node, M_json_node_t *value)
 {
-	if (node == NULL || node->type != M_JSON_TYPE_ARRAY || value == NULL || value->parent != NULL)
+	if (node == NULL || node->type != M_JSON_TYPE_ARRAY || value == NULL || value->parent != NULL || value->arena != node->arena)
 		return M_FALSE;
 
 	if (M_list_insert(node->data.json_array, value)) {
@@ -451,7 +570,7 @@ M_bool M_json_array_insert_string(M_json_node_t *node, const char *value)
 {
 	M_json_node_t *n;
 
-	n = M_json_node_create(M_JSON_TYPE_STRING);
+	n = M_json_node_create_child(node, M_JSON_TYPE_STRING);
 	if (!M_json_set_string(n, value)) {
 		M_json_node_destroy(n);
 		return M_FALSE;
@@ -469,7 +588,7 @@ M_bool M_json_array_insert_int(M_json_node_t *node, M_int64 value)
 {
 	M_json_node_t *n;
 
-	n = M_json_node_create(M_JSON_TYPE_INTEGER);
+	n = M_json_node_create_child(node, M_JSON_TYPE_INTEGER);
 	if (!M_json_set_int(n, value)) {
 		M_json_node_destroy(n);
 		return M_FALSE;
@@ -487,7 +606,7 @@ M_bool M_json_array_insert_decimal(M_json_node_t *node, const M_decimal_t *value
 {
 	M_json_node_t *n;
 
-	n = M_json_node_create(M_JSON_TYPE_DECIMAL);
+	n = M_json_node_create_child(node, M_JSON_TYPE_DECIMAL);
 	if (!M_json_set_decimal(n, value)) {
 		M_json_node_destroy(n);
 		return M_FALSE;
@@ -505,7 +624,7 @@ M_bool M_json_array_insert_bool(M_json_node_t *node, M_bool value)
 {
 	M_json_node_t *n;
 
-	n = M_json_node_create(M_JSON_TYPE_BOOL);
+	n = M_json_node_create_child(node, M_JSON_TYPE_BOOL);
 	if (!M_json_set_bool(n, value)) {
 		M_json_node_destroy(n);
 		return M_FALSE;
@@ -521,7 +640,7 @@ M_bool M_json_array_insert_bool(M_json_node_t *node, M_bool value)
 
 M_bool M_json_array_insert_at(M_json_node_t *node, M_json_node_t *value, size_t idx)
 {
-	if (node == NULL || node->type != M_JSON_TYPE_ARRAY || value == NULL || value->parent != NULL)
+	if (node == NULL || node->type != M_JSON_TYPE_ARRAY || value == NULL || value->parent != NULL || value->arena != node->arena)
 		return M_FALSE;
 
 	if (M_list_insert_at(node->data.json_array, value, idx)) {
@@ -535,7 +654,7 @@ M_bool M_json_array_insert_at_string(M_json_node_t *node, const char *value, siz
 {
 	M_json_node_t *n;
 
-	n = M_json_node_create(M_JSON_TYPE_STRING);
+	n = M_json_node_create_child(node, M_JSON_TYPE_STRING);
 	if (!M_json_set_string(n, value)) {
 		M_json_node_destroy(n);
 		return M_FALSE;
@@ -553,7 +672,7 @@ M_bool M_json_array_insert_at_int(M_json_node_t *node, M_int64 value, size_t idx
 {
 	M_json_node_t *n;
 
-	n = M_json_node_create(M_JSON_TYPE_INTEGER);
+	n = M_json_node_create_child(node, M_JSON_TYPE_INTEGER);
 	if (!M_json_set_int(n, value)) {
 		M_json_node_destroy(n);
 		return M_FALSE;
@@ -571,7 +690,7 @@ M_bool M_json_array_insert_at_decimal(M_json_node_t *node, const M_decimal_t *va
 {
 	M_json_node_t *n;
 
-	n = M_json_node_create(M_JSON_TYPE_DECIMAL);
+	n = M_json_node_create_child(node, M_JSON_TYPE_DECIMAL);
 	if (!M_json_set_decimal(n, value)) {
 		M_json_node_destroy(n);
 		return M_FALSE;
@@ -589,7 +708,7 @@ M_bool M_json_array_insert_at_bool(M_json_node_t *node, M_bool value, size_t idx
 {
 	M_json_node_t *n;
 
-	n = M_json_node_create(M_JSON_TYPE_BOOL);
+	n = M_json_node_create_child(node, M_JSON_TYPE_BOOL);
 	if (!M_json_set_bool(n, value)) {
 		M_json_node_destroy(n);
 		return M_FALSE;
@@ -618,7 +737,11 @@ M_bool M_json_set_string(M_json_node_t *node, const char *value)
 		return M_FALSE;
 
 	M_json_node_clear(node);
-	node->data.json_string = M_strdup(value);
+	if (node->arena != NULL) {
+		node->data.json_string = M_arena_strdup(node->arena, value);
+	} else {
+		node->data.json_string = M_strdup(value);
+	}
 	node->type = M_JSON_TYPE_STRING;
 
 	return M_TRUE;
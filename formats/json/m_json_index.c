@@ -0,0 +1,438 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2026 Monetra Technologies, LLC.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "m_config.h"
+
+#include <mstdlib/mstdlib.h>
+#include <mstdlib/mstdlib_formats.h>
+#include "json/m_json_int.h"
+#include "platform/m_cpu_int.h"
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* Stage 1 of the approach from Langdale and Lemire, "Parsing Gigabytes of JSON
+ * per Second". Each 64 byte block is classified into bit masks with vector
+ * compares. Escaped characters, the extent of strings and the start of every
+ * run of non-structural characters are then found with plain 64 bit
+ * arithmetic on the masks, so only the kernel that builds the masks depends on
+ * the instruction set. */
+
+typedef struct {
+	M_uint64 quote;
+	M_uint64 backslash;
+	M_uint64 op;        /* { } [ ] : , */
+	M_uint64 space;     /* Same set as M_json_read: ' ', \t, \n, \v, \f, \r */
+	M_uint64 control;   /* Below 0x20 */
+	M_uint64 slash;
+} M_json_index_masks_t;
+
+enum {
+	M_JSON_INDEX_ISA_SCALAR = 0,
+	M_JSON_INDEX_ISA_SSE2,
+	M_JSON_INDEX_ISA_AVX2,
+	M_JSON_INDEX_ISA_NEON
+};
+
+static void M_json_index_classify_scalar(const M_uint8 *b, M_json_index_masks_t *m)
+{
+	size_t i;
+
+	M_mem_set(m, 0, sizeof(*m));
+
+	for (i=0; i<64; i++) {
+		M_uint64 bit = (M_uint64)1 << i;
+
+		switch (b[i]) {
+			case '"':
+				m->quote     |= bit;
+				break;
+			case '\\':
+				m->backslash |= bit;
+				break;
+			case '{':
+			case '}':
+			case '[':
+			case ']':
+			case ':':
+			case ',':
+				m->op        |= bit;
+				break;
+			case '/':
+				m->slash     |= bit;
+				break;
+			case ' ':
+				m->space     |= bit;
+				break;
+			case '\t':
+			case '\n':
+			case '\v':
+			case '\f':
+			case '\r':
+				m->space     |= bit;
+				m->control   |= bit;
+				break;
+			default:
+				if (b[i] < 0x20)
+					m->control |= bit;
+				break;
+		}
+	}
+}
+
+#if defined(M_CPU_SSE2)
+/* '[' and ']' differ from '{' and '}' only by 0x20 so setting it folds them
+ * together. No other byte folds onto either. */
+static void M_json_index_classify_sse2(const M_uint8 *b, M_json_index_masks_t *m)
+{
+	const __m128i quote     = _mm_set1_epi8('"');
+	const __m128i backslash = _mm_set1_epi8('\\');
+	const __m128i slash     = _mm_set1_epi8('/');
+	const __m128i fold      = _mm_set1_epi8(0x20);
+	const __m128i lbrace    = _mm_set1_epi8('{');
+	const __m128i rbrace    = _mm_set1_epi8('}');
+	const __m128i colon     = _mm_set1_epi8(':');
+	const __m128i comma     = _mm_set1_epi8(',');
+	const __m128i ws_low    = _mm_set1_epi8(0x08);
+	const __m128i ws_high   = _mm_set1_epi8(0x0E);
+	const __m128i ctrl_low  = _mm_set1_epi8(-1);
+	size_t        i;
+
+	M_mem_set(m, 0, sizeof(*m));
+
+	for (i=0; i<64; i+=16) {
+		__m128i in = _mm_loadu_si128((const __m128i *)(const void *)(b + i));
+		__m128i f  = _mm_or_si128(in, fold);
+		__m128i op;
+		__m128i ws;
+		__m128i ctrl;
+
+		op   = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(f, lbrace), _mm_cmpeq_epi8(f, rbrace)),
+			_mm_or_si128(_mm_cmpeq_epi8(in, colon), _mm_cmpeq_epi8(in, comma)));
+		/* Compares are signed, bytes >= 0x80 are negative. */
+		ws   = _mm_or_si128(_mm_cmpeq_epi8(in, fold),
+			_mm_and_si128(_mm_cmpgt_epi8(in, ws_low), _mm_cmplt_epi8(in, ws_high)));
+		ctrl = _mm_and_si128(_mm_cmpgt_epi8(in, ctrl_low), _mm_cmplt_epi8(in, fold));
+
+		m->quote     |= (M_uint64)(M_uint16)_mm_movemask_epi8(_mm_cmpeq_epi8(in, quote)) << i;
+		m->backslash |= (M_uint64)(M_uint16)_mm_movemask_epi8(_mm_cmpeq_epi8(in, backslash)) << i;
+		m->slash     |= (M_uint64)(M_uint16)_mm_movemask_epi8(_mm_cmpeq_epi8(in, slash)) << i;
+		m->op        |= (M_uint64)(M_uint16)_mm_movemask_epi8(op) << i;
+		m->space     |= (M_uint64)(M_uint16)_mm_movemask_epi8(ws) << i;
+		m->control   |= (M_uint64)(M_uint16)_mm_movemask_epi8(ctrl) << i;
+	}
+}
+#endif
+
+#if defined(M_CPU_X86_DISPATCH)
+M_CPU_TARGET("avx2")
+static void M_json_index_classify_avx2(const M_uint8 *b, M_json_index_masks_t *m)
+{
+	const __m256i quote     = _mm256_set1_epi8('"');
+	const __m256i backslash = _mm256_set1_epi8('\\');
+	const __m256i slash     = _mm256_set1_epi8('/');
+	const __m256i fold      = _mm256_set1_epi8(0x20);
+	const __m256i lbrace    = _mm256_set1_epi8('{');
+	const __m256i rbrace    = _mm256_set1_epi8('}');
+	const __m256i colon     = _mm256_set1_epi8(':');
+	const __m256i comma     = _mm256_set1_epi8(',');
+	const __m256i ws_low    = _mm256_set1_epi8(0x08);
+	const __m256i ws_high   = _mm256_set1_epi8(0x0E);
+	const __m256i ctrl_low  = _mm256_set1_epi8(-1);
+	size_t        i;
+
+	M_mem_set(m, 0, sizeof(*m));
+
+	for (i=0; i<64; i+=32) {
+		__m256i in = _mm256_loadu_si256((const __m256i *)(const void *)(b + i));
+		__m256i f  = _mm256_or_si256(in, fold);
+		__m256i op;
+		__m256i ws;
+		__m256i ctrl;
+
+		op   = _mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpeq_epi8(f, lbrace), _mm256_cmpeq_epi8(f, rbrace)),
+			_mm256_or_si256(_mm256_cmpeq_epi8(in, colon), _mm256_cmpeq_epi8(in, comma)));
+		ws   = _mm256_or_si256(_mm256_cmpeq_epi8(in, fold),
+			_mm256_and_si256(_mm256_cmpgt_epi8(in, ws_low), _mm256_cmpgt_epi8(ws_high, in)));
+		ctrl = _mm256_and_si256(_mm256_cmpgt_epi8(in, ctrl_low), _mm256_cmpgt_epi8(fold, in));
+
+		m->quote     |= (M_uint64)(M_uint32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(in, quote)) << i;
+		m->backslash |= (M_uint64)(M_uint32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(in, backslash)) << i;
+		m->slash     |= (M_uint64)(M_uint32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(in, slash)) << i;
+		m->op        |= (M_uint64)(M_uint32)_mm256_movemask_epi8(op) << i;
+		m->space     |= (M_uint64)(M_uint32)_mm256_movemask_epi8(ws) << i;
+		m->control   |= (M_uint64)(M_uint32)_mm256_movemask_epi8(ctrl) << i;
+	}
+}
+#endif
+
+#if defined(M_CPU_NEON) && defined(__aarch64__)
+/* One bit per byte from four compare results. Each byte keeps only its bit
+ * within its group of 8 and pairwise adds collapse the groups. */
+static M_uint64 M_json_index_neon_mask(uint8x16_t a, uint8x16_t b, uint8x16_t c, uint8x16_t d)
+{
+	static const M_uint8 weights[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+	const uint8x16_t     w           = vld1q_u8(weights);
+	uint8x16_t           sum0;
+	uint8x16_t           sum1;
+
+	sum0 = vpaddq_u8(vandq_u8(a, w), vandq_u8(b, w));
+	sum1 = vpaddq_u8(vandq_u8(c, w), vandq_u8(d, w));
+	sum0 = vpaddq_u8(sum0, sum1);
+	sum0 = vpaddq_u8(sum0, sum0);
+	return vgetq_lane_u64(vreinterpretq_u64_u8(sum0), 0);
+}
+
+static void M_json_index_classify_neon(const M_uint8 *b, M_json_index_masks_t *m)
+{
+	const uint8x16_t quote     = vdupq_n_u8('"');
+	const uint8x16_t backslash = vdupq_n_u8('\\');
+	const uint8x16_t slash     = vdupq_n_u8('/');
+	const uint8x16_t fold      = vdupq_n_u8(0x20);
+	const uint8x16_t lbrace    = vdupq_n_u8('{');
+	const uint8x16_t rbrace    = vdupq_n_u8('}');
+	const uint8x16_t colon     = vdupq_n_u8(':');
+	const uint8x16_t comma     = vdupq_n_u8(',');
+	const uint8x16_t ws_low    = vdupq_n_u8(0x09);
+	const uint8x16_t ws_range  = vdupq_n_u8(0x0D - 0x09);
+	uint8x16_t       in[4];
+	uint8x16_t       r[4];
+	size_t           i;
+
+	for (i=0; i<4; i++) {
+		in[i] = vld1q_u8(b + (i * 16));
+	}
+
+	for (i=0; i<4; i++) r[i] = vceqq_u8(in[i], quote);
+	m->quote     = M_json_index_neon_mask(r[0], r[1], r[2], r[3]);
+	for (i=0; i<4; i++) r[i] = vceqq_u8(in[i], backslash);
+	m->backslash = M_json_index_neon_mask(r[0], r[1], r[2], r[3]);
+	for (i=0; i<4; i++) r[i] = vceqq_u8(in[i], slash);
+	m->slash     = M_json_index_neon_mask(r[0], r[1], r[2], r[3]);
+	for (i=0; i<4; i++) {
+		uint8x16_t f = vorrq_u8(in[i], fold);
+		r[i] = vorrq_u8(vorrq_u8(vceqq_u8(f, lbrace), vceqq_u8(f, rbrace)), vorrq_u8(vceqq_u8(in[i], colon), vceqq_u8(in[i], comma)));
+	}
+	m->op        = M_json_index_neon_mask(r[0], r[1], r[2], r[3]);
+	/* Unsigned compares, 0x09 - 0x0D is a single range check after subtracting. */
+	for (i=0; i<4; i++) r[i] = vorrq_u8(vceqq_u8(in[i], fold), vcleq_u8(vsubq_u8(in[i], ws_low), ws_range));
+	m->space     = M_json_index_neon_mask(r[0], r[1], r[2], r[3]);
+	for (i=0; i<4; i++) r[i] = vcltq_u8(in[i], fold);
+	m->control   = M_json_index_neon_mask(r[0], r[1], r[2], r[3]);
+}
+#endif
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* Characters preceded by an odd number of backslashes. A run of backslashes
+ * starting on an even bit escapes the character after it when it ends on an
+ * odd bit and the reverse when it starts on an odd bit. Adding the start of
+ * each run to the run carries out to the bit after the run which leaves the
+ * parity of where it started in that bit. */
+static M_uint64 M_json_index_escaped(M_uint64 backslash, M_uint64 *prev_escaped)
+{
+	const M_uint64 even = 0x5555555555555555ULL;
+	M_uint64       follows;
+	M_uint64       odd_starts;
+	M_uint64       sequences;
+	M_uint64       escaped;
+
+	if (backslash == 0) {
+		escaped       = *prev_escaped;
+		*prev_escaped = 0;
+		return escaped;
+	}
+
+	/* A backslash that is itself escaped doesn't start a run. */
+	backslash     &= ~*prev_escaped;
+	follows        = (backslash << 1) | *prev_escaped;
+	odd_starts     = backslash & ~even & ~follows;
+	sequences      = odd_starts + backslash;
+	*prev_escaped  = sequences < odd_starts ? 1 : 0;
+
+	return (even ^ (sequences << 1)) & follows;
+}
+
+/* Each bit is the xor of itself and every bit below it. Quote bits become
+ * runs covering each string from the opening quote up to, not including, the
+ * closing quote. */
+static M_uint64 M_json_index_prefix_xor(M_uint64 x)
+{
+	x ^= x << 1;
+	x ^= x << 2;
+	x ^= x << 4;
+	x ^= x << 8;
+	x ^= x << 16;
+	x ^= x << 32;
+	return x;
+}
+
+static void M_json_index_block(M_json_index_t *index, const M_json_index_masks_t *m, size_t base)
+{
+	size_t   *out = index->entries + index->num_entries;
+	M_uint64  escaped;
+	M_uint64  quote;
+	M_uint64  in_string;
+	M_uint64  scalar;
+	M_uint64  bits;
+	M_uint64  special;
+	M_uint64  stop;
+
+	escaped               = M_json_index_escaped(m->backslash, &index->prev_escaped);
+	quote                 = m->quote & ~escaped;
+	in_string             = M_json_index_prefix_xor(quote) ^ index->prev_in_string;
+	index->prev_in_string = (M_uint64)0 - (in_string >> 63);
+
+	/* Anything that isn't structural, whitespace or part of a string. Only the
+	 * first byte of each run is indexed. */
+	scalar             = ~(m->op | m->space | quote | in_string);
+	bits               = (m->op & ~in_string) | quote | (scalar & ~((scalar << 1) | index->prev_scalar));
+	index->prev_scalar = scalar >> 63;
+
+	/* Escapes and control characters inside of strings. The opening quote is
+	 * part of in_string but is neither. */
+	special = (m->backslash | m->control) & in_string;
+
+	stop = m->slash & ~in_string;
+	if (stop != 0) {
+		stop            = (stop & (~stop + 1)) - 1;
+		bits           &= stop;
+		special        &= stop;
+		index->stopped  = M_TRUE;
+	}
+
+	if (special == 0 && !index->prev_special) {
+		while (bits != 0) {
+			*out++  = (base + M_CPU_CTZ64(bits)) << 1;
+			bits   &= bits - 1;
+		}
+	} else {
+		/* Walk both in order so each closing quote knows if anything in its
+		 * string needs to be decoded. */
+		bits |= special;
+		while (bits != 0) {
+			M_uint64 bit = bits & (~bits + 1);
+			size_t   pos = base + M_CPU_CTZ64(bits);
+
+			bits &= bits - 1;
+			if (special & bit) {
+				index->prev_special = M_TRUE;
+				continue;
+			}
+			if ((quote & bit) && !(in_string & bit)) {
+				*out++              = (pos << 1) | (index->prev_special ? 1 : 0);
+				index->prev_special = M_FALSE;
+				continue;
+			}
+			*out++ = pos << 1;
+		}
+	}
+
+	index->num_entries = (size_t)(out - index->entries);
+}
+
+static void M_json_index_classify(const M_json_index_t *index, const M_uint8 *b, M_json_index_masks_t *m)
+{
+	switch (index->isa) {
+#if defined(M_CPU_X86_DISPATCH)
+		case M_JSON_INDEX_ISA_AVX2:
+			M_json_index_classify_avx2(b, m);
+			return;
+#endif
+#if defined(M_CPU_SSE2)
+		case M_JSON_INDEX_ISA_SSE2:
+			M_json_index_classify_sse2(b, m);
+			return;
+#endif
+#if defined(M_CPU_NEON) && defined(__aarch64__)
+		case M_JSON_INDEX_ISA_NEON:
+			M_json_index_classify_neon(b, m);
+			return;
+#endif
+		default:
+			break;
+	}
+	M_json_index_classify_scalar(b, m);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+void M_json_index_init(M_json_index_t *index, const char *data, size_t len)
+{
+	index->data           = data;
+	index->len            = len;
+	index->offset         = 0;
+	index->prev_escaped   = 0;
+	index->prev_in_string = 0;
+	index->prev_scalar    = 0;
+	index->prev_special   = M_FALSE;
+	index->stopped        = M_FALSE;
+	index->num_entries    = 0;
+	index->next           = 0;
+
+	index->isa = M_JSON_INDEX_ISA_SCALAR;
+#if defined(M_CPU_X86_DISPATCH)
+	if (M_cpu_has(M_CPU_FEATURE_AVX2)) {
+		index->isa = M_JSON_INDEX_ISA_AVX2;
+	} else if (M_cpu_has(M_CPU_FEATURE_SSE2)) {
+		index->isa = M_JSON_INDEX_ISA_SSE2;
+	}
+#elif defined(M_CPU_SSE2)
+	index->isa = M_JSON_INDEX_ISA_SSE2;
+#elif defined(M_CPU_NEON) && defined(__aarch64__)
+	if (M_cpu_has(M_CPU_FEATURE_NEON))
+		index->isa = M_JSON_INDEX_ISA_NEON;
+#endif
+}
+
+size_t M_json_index_fill(M_json_index_t *index)
+{
+	M_json_index_masks_t m;
+	M_uint8              tail[64];
+	size_t               i;
+
+	index->num_entries = 0;
+	index->next        = 0;
+
+	/* Blocks can be entirely inside of a string or whitespace so keep going
+	 * until there is something to return. */
+	while (index->num_entries == 0 && !index->stopped && index->offset < index->len) {
+		for (i=0; i<M_JSON_INDEX_BLOCKS && !index->stopped && index->offset < index->len; i++) {
+			const M_uint8 *b = (const M_uint8 *)index->data + index->offset;
+
+			/* The last partial block is padded with whitespace. */
+			if (index->len - index->offset < 64) {
+				M_mem_set(tail, ' ', sizeof(tail));
+				M_mem_copy(tail, b, index->len - index->offset);
+				b = tail;
+			}
+
+			M_json_index_classify(index, b, &m);
+			M_json_index_block(index, &m, index->offset);
+			index->offset += 64;
+		}
+	}
+
+	return index->num_entries;
+}
@@ -37,6 +37,7 @@ __BEGIN_DECLS
 struct M_json_node {
 	M_json_type_t  type;
 	M_json_node_t *parent;
+	M_arena_t     *arena;  /*!< Arena the node and its string are allocated from. NULL when using M_malloc. */
 	/* The data for the various node types.
  	 * There is no data object for the NULL node type becuase it represents
 	 * null and does not need to store a value. */
@@ -50,6 +51,110 @@ struct M_json_node {
 	} data;
 };
 
+/*! Create a node allocated from an arena (if not NULL). */
+M_json_node_t *M_json_node_create_arena(M_json_type_t type, M_arena_t *arena);
+
+/*! Decode a \\u escape. s points to the 4 hex characters following \\u.
+ * utf8 must be at least 4 bytes. Returns M_FALSE if the escape is invalid. */
+M_bool M_json_unicode_escape(const char *s, size_t len, char *utf8, size_t *utf8_len);
+
+/*! Decode escapes in string data and replace control characters based on
+ * M_json_reader_flags_t flags. Follows the same rules as M_json_read. out
+ * must be at least len bytes and can be the same as s to decode in place. */
+M_json_error_t M_json_unescape(const char *s, size_t len, M_uint32 flags, char *out, size_t *out_len);
+
+/*! Type of a compiled jsonpath segment. */
+typedef enum {
+	M_JSON_JSONPATH_SEG_RECURSE = 0, /*!< Blank segment. Search all levels for the next segment. */
+	M_JSON_JSONPATH_SEG_KEY,         /*!< Object values with a given key. */
+	M_JSON_JSONPATH_SEG_KEY_ANY,     /*!< All object values ("*"). */
+	M_JSON_JSONPATH_SEG_INDEX_ANY,   /*!< All array elements ("[*]"). */
+	M_JSON_JSONPATH_SEG_INDEX        /*!< Array elements at given offsets ("[...]"). */
+} M_json_jsonpath_seg_type_t;
+
+/*! One comma separated part of an array offset segment. */
+typedef struct {
+	M_bool  slice;   /*!< start:end:step slice instead of a single index. */
+	M_int32 vals[3]; /*!< Index, or slice start, end and step. Negative indexes count from the end of the array. */
+	M_bool  have[3]; /*!< Slice value was given. Defaults are used otherwise. */
+} M_json_jsonpath_offset_t;
+
+/*! Compiled jsonpath segment. */
+typedef struct {
+	M_json_jsonpath_seg_type_t  type;
+	char                       *key;         /*!< Key for M_JSON_JSONPATH_SEG_KEY. */
+	M_json_jsonpath_offset_t   *offsets;     /*!< Offsets for M_JSON_JSONPATH_SEG_INDEX. */
+	size_t                      num_offsets;
+	M_bool                      invalid;     /*!< M_JSON_JSONPATH_SEG_INDEX that never selects anything. */
+} M_json_jsonpath_seg_t;
+
+/*! Compiled jsonpath expression. */
+struct M_json_jsonpath {
+	M_json_jsonpath_seg_t *segs;
+	size_t                 num_segs;
+};
+
+/*! Iterates over the array indexes selected by a M_JSON_JSONPATH_SEG_INDEX segment.
+ * Indexes are returned in the order they're listed in the segment and can repeat. */
+typedef struct {
+	const M_json_jsonpath_seg_t *seg;
+	size_t                       array_len;
+	size_t                       part;     /*!< Current offset part. */
+	M_bool                       in_slice; /*!< Iterating over the slice in the current part. */
+	M_bool                       up;       /*!< Slice is counting up. */
+	M_int64                      pos;      /*!< Next slice position. */
+	M_int64                      end;      /*!< Slice end. */
+	M_int32                      step;
+} M_json_jsonpath_offset_iter_t;
+
+/*! Start iterating. Returns M_FALSE if the segment does not select anything from an array of array_len. */
+M_bool M_json_jsonpath_offset_iter_init(M_json_jsonpath_offset_iter_t *iter, const M_json_jsonpath_seg_t *seg, size_t array_len);
+
+/*! Next selected index. Returns M_FALSE when there are no more. */
+M_bool M_json_jsonpath_offset_iter_next(M_json_jsonpath_offset_iter_t *iter, size_t *idx);
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/*! Number of 64 byte blocks indexed at a time. */
+#define M_JSON_INDEX_BLOCKS 16
+
+/*! Structural index of a JSON document.
+ *
+ * Positions of every structural character ({}[]:,), every quote that opens or
+ * closes a string, and the first byte of every other run of characters outside
+ * of strings (numbers, literals, and anything invalid) in document order.
+ * Nothing inside a string is indexed and whitespace is skipped.
+ *
+ * Entries are the position shifted left by one. The low bit is set on the
+ * closing quote of a string that contains a backslash or a control character.
+ *
+ * The document is indexed in batches as entries are consumed. Indexing stops
+ * at the first '/' outside of a string because comments are not handled. */
+typedef struct {
+	const char *data;
+	size_t      len;
+	size_t      offset;          /*!< Start of the next block to index. */
+	M_uint64    prev_escaped;    /*!< First byte of the next block is escaped. */
+	M_uint64    prev_in_string;  /*!< All bits set if the last block ended inside a string. */
+	M_uint64    prev_scalar;     /*!< Last byte of the last block was part of a run. */
+	M_bool      prev_special;    /*!< Current string has a backslash or control character. */
+	M_bool      stopped;         /*!< A comment was found. */
+	int         isa;
+	size_t      entries[M_JSON_INDEX_BLOCKS * 64];
+	size_t      num_entries;
+	size_t      next;
+} M_json_index_t;
+
+#define M_JSON_INDEX_POS(e)     ((e) >> 1)
+#define M_JSON_INDEX_SPECIAL(e) ((e) & 1)
+
+/*! Start indexing data. */
+void M_json_index_init(M_json_index_t *index, const char *data, size_t len);
+
+/*! Index the next batch of blocks. Replaces all entries. Returns the number
+ * of entries, 0 when the end of the data or a comment has been reached. */
+size_t M_json_index_fill(M_json_index_t *index);
+
 __END_DECLS
 
 #endif /* __M_JSON_INT_H__ */
@@ -29,17 +29,12 @@
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-/*! Turn a string into an index. This will adjust negative numbers to count from the end of the array.
+/*! Adjust negative offsets to count from the end of the array.
  * On success out will never be < 0. Out can be >= array_len.
  */
-static M_bool M_json_jsonpath_search_array_offset_val(const char *val, size_t val_len, size_t array_len, M_uint32 *out)
+static M_bool M_json_jsonpath_offset_val(M_int32 offset, size_t array_len, M_uint32 *out)
 {
-	M_int32 offset;
-
 	*out = 0;
-	if (M_str_to_int32_ex(val, val_len, 10, &offset, NULL) != M_STR_INT_SUCCESS) {
-		return M_FALSE;
-	}
 
 	if (offset < 0) {
 		if ((M_int32)array_len + offset < 0) {
@@ -53,133 +48,273 @@ static M_bool M_json_jsonpath_search_array_offset_val(const char *val, size_t va
 	return M_TRUE;
 }
 
-static M_list_u64_t *M_json_jsonpath_search_array_offsets(const M_json_node_t *node, const char *segment)
+M_bool M_json_jsonpath_offset_iter_init(M_json_jsonpath_offset_iter_t *iter, const M_json_jsonpath_seg_t *seg, size_t array_len)
 {
-	M_list_u64_t  *offsets;
-	size_t         seg_len;
-	size_t         array_len;
-	char         **comma_parts      = NULL;
-	size_t        *comma_parts_lens = NULL;
-	size_t         comma_num_parts  = 0;
-	char         **slice_parts      = NULL;
-	size_t        *slice_parts_lens = NULL;
-	size_t         slice_num_parts  = 0;
-	size_t         i;
-	M_int64        j;
-	M_uint32       slice_start;
-	M_uint32       slice_end;
-	M_int32        slice_step;
-
-	if (M_json_node_type(node) != M_JSON_TYPE_ARRAY)
-		return NULL;
+	M_uint32 out;
+	size_t   i;
 
-	array_len = M_json_array_len(node);
-	seg_len   = M_str_len(segment);
+	M_mem_set(iter, 0, sizeof(*iter));
 
-	/* If we don't have any items in this node there is nothing to index. Or if there isn't any data between
- 	 * '[' and ']' then we don't have an offset to index. */
-	if (array_len == 0 || seg_len < 3)
-		return NULL;
+	/* If we don't have any items in this node there is nothing to index. */
+	if (array_len == 0 || seg->invalid)
+		return M_FALSE;
+
+	/* An invalid exact index invalidates the whole segment. */
+	for (i=0; i<seg->num_offsets; i++) {
+		if (!seg->offsets[i].slice && !M_json_jsonpath_offset_val(seg->offsets[i].vals[0], array_len, &out)) {
+			return M_FALSE;
+		}
+	}
+
+	iter->seg       = seg;
+	iter->array_len = array_len;
+	return M_TRUE;
+}
+
+M_bool M_json_jsonpath_offset_iter_next(M_json_jsonpath_offset_iter_t *iter, size_t *idx)
+{
+	const M_json_jsonpath_offset_t *offset;
+	M_uint32                        slice_start;
+	M_uint32                        slice_end;
+	M_int64                         j;
+
+	while (1) {
+		if (iter->in_slice) {
+			if ((iter->up && iter->pos < iter->end) || (!iter->up && iter->pos >= iter->end)) {
+				j          = iter->pos;
+				iter->pos += iter->step;
+				if (j >= 0 && j < (M_int64)iter->array_len) {
+					*idx = (size_t)j;
+					return M_TRUE;
+				}
+				continue;
+			}
+			iter->in_slice = M_FALSE;
+			iter->part++;
+		}
+
+		if (iter->seg == NULL || iter->part >= iter->seg->num_offsets)
+			return M_FALSE;
+
+		offset = &iter->seg->offsets[iter->part];
+
+		/* 1 exact index. */
+		if (!offset->slice) {
+			iter->part++;
+			M_json_jsonpath_offset_val(offset->vals[0], iter->array_len, &slice_start);
+			/* Check that we have a valid index. */
+			if (slice_start < iter->array_len) {
+				*idx = slice_start;
+				return M_TRUE;
+			}
+			continue;
+		}
 
-	/* The list is not sorted so we can have duplicates and out of order results can be returned, "[2,1]" */
-	offsets = M_list_u64_create(M_LIST_U64_NONE);
+		/* It's allowed to omit the start, end and step of a slice. */
+		slice_start = 0;
+		slice_end   = (M_uint32)iter->array_len;
+		iter->step  = offset->have[2] ? offset->vals[2] : 1;
+		if ((offset->have[0] && !M_json_jsonpath_offset_val(offset->vals[0], iter->array_len, &slice_start)) ||
+			(offset->have[1] && !M_json_jsonpath_offset_val(offset->vals[1], iter->array_len, &slice_end)))
+		{
+			iter->part++;
+			continue;
+		}
+
+		/* Cases where we won't calculate anything. */
+		if ((slice_start == slice_end) ||
+			(slice_start > slice_end && iter->step > 0) ||
+			(slice_start < slice_end && iter->step < 0))
+		{
+			iter->part++;
+			continue;
+		}
+
+		/* When counting up start is inclusive, when counting down end is inclusive. */
+		iter->in_slice = M_TRUE;
+		iter->end      = slice_end;
+		if (slice_start < slice_end) {
+			iter->up  = M_TRUE;
+			iter->pos = slice_start;
+		} else {
+			iter->up  = M_FALSE;
+			iter->pos = (M_int64)slice_start-1;
+		}
+	}
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* Parse the offsets between '[' and ']'. */
+static void M_json_jsonpath_compile_offsets(const char *segment, M_json_jsonpath_seg_t *seg)
+{
+	M_json_jsonpath_offset_t *offset;
+	size_t                    seg_len;
+	char                    **comma_parts      = NULL;
+	size_t                   *comma_parts_lens = NULL;
+	size_t                    comma_num_parts  = 0;
+	char                    **slice_parts      = NULL;
+	size_t                   *slice_parts_lens = NULL;
+	size_t                    slice_num_parts  = 0;
+	size_t                    i;
+	size_t                    j;
+	M_bool                    ok;
+
+	seg_len = M_str_len(segment);
+
+	/* If there isn't any data between '[' and ']' then we don't have an offset to index. */
+	if (seg_len < 3) {
+		seg->invalid = M_TRUE;
+		return;
+	}
 
 	/* We're going to first explode on ',' and go though each of our indexes. If there isn't a ',' then
  	 * the first and only element expoded with be the value we want to deal with. */
 	comma_parts = M_str_explode(',', segment+1, seg_len-2, &comma_num_parts, &comma_parts_lens);
-	if (comma_parts == NULL || comma_num_parts == 0)
-		goto error;
+	if (comma_parts == NULL || comma_num_parts == 0) {
+		seg->invalid = M_TRUE;
+		goto done;
+	}
 
-	/* Go thoguh each of the elements we expoded with ',' */
+	seg->offsets = M_malloc_zero(comma_num_parts * sizeof(*seg->offsets));
 	for (i=0; i<comma_num_parts; i++) {
 		/* we're going to explode on ':' and look for slices. If this isn't a slice and we have a single index
- 		 * the value will be the first and only element exploded. */
+ 		 * the value will be the first and only element exploded. Invalid slices are ignored. */
 		slice_parts = M_str_explode(':', comma_parts[i], comma_parts_lens[i], &slice_num_parts, &slice_parts_lens);
 		if (slice_parts == NULL || slice_num_parts == 0 || slice_num_parts > 3) {
 			goto slice_done;
 		}
 
-		/* If we have a slice we're going to set some defaults. It's allowed to omit the start, end and step. */
-		slice_start = 0;
-		slice_end   = (M_uint32)array_len;
-		slice_step  = 1;
-
-		/* If we have 2 or more parts we have a slice. */
-		if (slice_num_parts == 2 || slice_num_parts == 3) {
-			/* Start. */
-			if (slice_parts_lens[0] > 0) {
-				if (!M_json_jsonpath_search_array_offset_val(slice_parts[0], slice_parts_lens[0], array_len, &slice_start)) {
-					goto slice_done;
-				}
-			}
-			/* End. */
-			if (slice_parts_lens[1] > 0) {
-				if (!M_json_jsonpath_search_array_offset_val(slice_parts[1], slice_parts_lens[1], array_len, &slice_end)) {
-					goto slice_done;
-				}
-			}
-			/* Step. */
-			if (slice_num_parts == 3 && slice_parts_lens[2] > 0) {
-				if (M_str_to_int32_ex(slice_parts[2], slice_parts_lens[2], 10, &slice_step, NULL) != M_STR_INT_SUCCESS || slice_step == 0) {
-					goto slice_done;
-				}
-			}
+		offset = &seg->offsets[seg->num_offsets];
+		M_mem_set(offset, 0, sizeof(*offset));
 
-			/* Cases where we won't calculate anything. */
-			if ((slice_start == slice_end) ||
-				(slice_start > slice_end && slice_step > 0) ||
-				(slice_start < slice_end && slice_step < 0))
-			{
-				goto slice_done;
+		if (slice_num_parts == 1) {
+			/* 1 exact index. An invalid index means nothing is selected. */
+			if (M_str_to_int32_ex(slice_parts[0], slice_parts_lens[0], 10, &offset->vals[0], NULL) != M_STR_INT_SUCCESS) {
+				seg->invalid = M_TRUE;
+				goto done;
 			}
+			seg->num_offsets++;
+			goto slice_done;
+		}
 
-			/* Determine the values for each index we want to look at. */
-			if (slice_start < slice_end) {
-				/* Count up. */
-				for (j=slice_start; j<slice_end; j+=slice_step) {
-					if (j >= 0 && j < (M_int64)array_len) {
-						M_list_u64_insert(offsets, (M_uint64)j);
-					}
-				}
-			} else {
-				/* Count down. */
-				for (j=slice_start-1; j>=slice_end; j+=slice_step) {
-					if (j >= 0 && j < (M_int64)array_len) {
-						M_list_u64_insert(offsets, (M_uint64)j);
-					}
-				}
-			}
-		} else {
-			/* 1 exact index. */
-			if (!M_json_jsonpath_search_array_offset_val(slice_parts[0], slice_parts_lens[0], array_len, &slice_start)) {
-				goto error;
-			}
-			/* Check that we have a valid index. */
-			if (slice_start < array_len) {
-				M_list_u64_insert(offsets, slice_start);
+		offset->slice = M_TRUE;
+		ok            = M_TRUE;
+		for (j=0; j<slice_num_parts && ok; j++) {
+			if (slice_parts_lens[j] == 0)
+				continue;
+			offset->have[j] = M_TRUE;
+			if (M_str_to_int32_ex(slice_parts[j], slice_parts_lens[j], 10, &offset->vals[j], NULL) != M_STR_INT_SUCCESS) {
+				ok = M_FALSE;
 			}
 		}
+		/* Step can't be 0. */
+		if (ok && offset->have[2] && offset->vals[2] == 0) {
+			ok = M_FALSE;
+		}
+		if (ok) {
+			seg->num_offsets++;
+		}
 
 slice_done:
 		M_str_explode_free(slice_parts, slice_num_parts);
 		M_free(slice_parts_lens);
+		slice_parts      = NULL;
+		slice_parts_lens = NULL;
+		slice_num_parts  = 0;
 	}
 
-	M_str_explode_free(comma_parts, comma_num_parts);
-	M_free(comma_parts_lens);
-
-	return offsets;
-
-error:
+done:
 	M_str_explode_free(slice_parts, slice_num_parts);
 	M_free(slice_parts_lens);
 	M_str_explode_free(comma_parts, comma_num_parts);
 	M_free(comma_parts_lens);
-	M_list_u64_destroy(offsets);
-	return NULL;
+}
+
+static void M_json_jsonpath_compile_seg(const char *segment, M_json_jsonpath_seg_t *seg)
+{
+	if (segment == NULL || *segment == '\0') {
+		seg->type = M_JSON_JSONPATH_SEG_RECURSE;
+	} else if (M_str_eq(segment, "*")) {
+		seg->type = M_JSON_JSONPATH_SEG_KEY_ANY;
+	} else if (M_str_eq(segment, "[*]")) {
+		seg->type = M_JSON_JSONPATH_SEG_INDEX_ANY;
+	} else if (*segment == '[') {
+		seg->type = M_JSON_JSONPATH_SEG_INDEX;
+		M_json_jsonpath_compile_offsets(segment, seg);
+	} else {
+		seg->type = M_JSON_JSONPATH_SEG_KEY;
+		seg->key  = M_strdup(segment);
+	}
+}
+
+/* Split a search into segments. NULL if the search is invalid. */
+static M_list_str_t *M_json_jsonpath_segments(const char *search)
+{
+	char          **segments;
+	char          **idx_segments;
+	M_list_str_t   *seg_list;
+	M_buf_t        *buf;
+	char           *out;
+	size_t          num_segments     = 0;
+	size_t          num_idx_segments = 0;
+	size_t          i;
+	size_t          j;
+
+	/* All JSON search expressions must start with a '$'. */
+	if (M_str_len(search) < 1 || *search != '$')
+		return NULL;
+
+	segments = M_str_explode_str('.', search+1, &num_segments);
+	if (segments == NULL || num_segments == 0) {
+		/* Silence coverity, if num_segments is 0, segments should be NULL */
+		M_str_explode_free(segments, num_segments);
+		return NULL;
+	}
+
+	/* Further split on '[' to pull out indexes */
+	seg_list = M_list_str_create(M_LIST_STR_NONE);
+	for (i=0; i<num_segments; i++) {
+		if (*(segments[i]) == '\0') {
+			M_list_str_insert(seg_list, "");
+			continue;
+		}
+
+		idx_segments = M_str_explode_str('[', segments[i], &num_idx_segments);
+		if (idx_segments == NULL || num_idx_segments == 0) {
+			M_str_explode_free(idx_segments, num_idx_segments);
+			continue;
+		}
+
+		for (j=0; j<num_idx_segments; j++) {
+			/* Empty means we found a '[', skip it. */
+			if (idx_segments[j] == NULL || *(idx_segments[j]) == '\0')
+				continue;
+
+			/* First one may not start with '['. We need to check if the segement is something like:
+			 * 'abc'/'abc[1]' vs '[1]'. */
+			if (j == 0 && *(segments[i]) != '[') {
+				M_list_str_insert(seg_list, idx_segments[j]);
+				continue;
+			}
 
+			/* Put the '[' back on the front of the segement and add it to our list of segements. */
+			buf = M_buf_create();
+			M_buf_add_byte(buf, '[');
+			M_buf_add_str(buf, idx_segments[j]);
+			out = M_buf_finish_str(buf, NULL);
+			M_list_str_insert(seg_list, out);
+			M_free(out);
+		}
+		M_str_explode_free(idx_segments, num_idx_segments);
+	}
+	M_str_explode_free(segments, num_segments);
+
+	return seg_list;
 }
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
 static void M_json_jsonpath_search_add_match(const M_json_node_t *node, M_json_node_t ***matches, size_t *num_matches)
 {
 	if (*num_matches == 0 || *matches == NULL || M_size_t_round_up_to_power_of_two(*num_matches) == *num_matches) {
@@ -189,22 +324,21 @@ static void M_json_jsonpath_search_add_match(const M_json_node_t *node, M_json_n
 	(*num_matches)++;
 }
 
-static void M_json_jsonpath_search(const M_json_node_t *node, M_list_str_t *segments, size_t seg_offset, M_bool search_recursive, M_json_node_t ***matches, size_t *num_matches)
+static void M_json_jsonpath_search(const M_json_node_t *node, const M_json_jsonpath_t *path, size_t seg_offset, M_bool search_recursive, M_json_node_t ***matches, size_t *num_matches)
 {
-	M_hash_strvp_enum_t *hashenum;
-	M_list_u64_t        *array_offsets;
-	const char          *seg;
-	const char          *key;
-	void                *val;
-	size_t               num_segments;
-	size_t               array_len;
-	size_t               array_offsets_len;
-	size_t               i;
+	M_hash_strvp_enum_t           *hashenum;
+	M_json_jsonpath_offset_iter_t  iter;
+	const M_json_jsonpath_seg_t   *seg;
+	const char                    *key;
+	void                          *val;
+	size_t                         num_segments;
+	size_t                         array_len;
+	size_t                         i;
 
 	if (node == NULL)
 		return;
 
-	num_segments = M_list_str_len(segments)-seg_offset;
+	num_segments = path->num_segs-seg_offset;
 	if (num_segments == 0) {
 		M_json_jsonpath_search_add_match(node, matches, num_matches);
 		return;
@@ -214,129 +348,126 @@ static void M_json_jsonpath_search(const M_json_node_t *node, M_list_str_t *segm
 	if (node->type != M_JSON_TYPE_OBJECT && node->type != M_JSON_TYPE_ARRAY)
 		return;
 
-	seg = M_list_str_at(segments, seg_offset);
+	seg = &path->segs[seg_offset];
 	/* A blank segment denotes we want to search recursively for the next pattern */
-	if (seg == NULL || *seg == '\0') {
+	if (seg->type == M_JSON_JSONPATH_SEG_RECURSE) {
 		/* Only recurse if there is something else to match */
 		if (num_segments > 1) {
-			M_json_jsonpath_search(node, segments, seg_offset+1, M_TRUE, matches, num_matches);
+			M_json_jsonpath_search(node, path, seg_offset+1, M_TRUE, matches, num_matches);
 		}
 		return;
 	}
 
 	if (node->type == M_JSON_TYPE_OBJECT) {
 		/* Invalid search. We can't index an object. */
-		if (*seg == '[')
+		if (seg->type == M_JSON_JSONPATH_SEG_INDEX || seg->type == M_JSON_JSONPATH_SEG_INDEX_ANY)
 			return;
 
 		M_hash_strvp_enumerate(node->data.json_object, &hashenum);
 		while (M_hash_strvp_enumerate_next(node->data.json_object, hashenum, &key, &val)) {
 			/* If a wildcard match, or an exact name match, its a match */
-			if (M_str_eq(seg, "*") || M_str_caseeq(seg, key)) {
-				M_json_jsonpath_search(val, segments, seg_offset+1, M_FALSE, matches, num_matches);
+			if (seg->type == M_JSON_JSONPATH_SEG_KEY_ANY || M_str_caseeq(seg->key, key)) {
+				M_json_jsonpath_search(val, path, seg_offset+1, M_FALSE, matches, num_matches);
 			}
 
 			/* This should NOT be an "else if" to the prior statement as there could legitimately be additional
 			 * matches at deeper layers, and we need to search those too */
 			if (search_recursive) {
-				M_json_jsonpath_search(val, segments, seg_offset, M_TRUE, matches, num_matches);
+				M_json_jsonpath_search(val, path, seg_offset, M_TRUE, matches, num_matches);
 			}
 		}
 		M_hash_strvp_enumerate_free(hashenum);
 	} else if (node->type == M_JSON_TYPE_ARRAY) {
 		array_len = M_json_array_len(node);
-		if (M_str_eq(seg, "[*]")) {
+		if (seg->type == M_JSON_JSONPATH_SEG_INDEX_ANY) {
 			for (i=0; i<array_len; i++) {
-				M_json_jsonpath_search(M_json_array_at(node, i), segments, seg_offset+1, search_recursive, matches, num_matches);
+				M_json_jsonpath_search(M_json_array_at(node, i), path, seg_offset+1, search_recursive, matches, num_matches);
 			}
 		/* We have an indexed value lets try to find that index. */
-		} else if (*seg == '[') {
-			array_offsets     = M_json_jsonpath_search_array_offsets(node, seg);
-			array_offsets_len = M_list_u64_len(array_offsets);
-			for (i=0; i<array_offsets_len; i++) {
-				M_json_jsonpath_search(M_json_array_at(node, (size_t)M_list_u64_at(array_offsets, i)), segments, seg_offset+1, M_FALSE, matches, num_matches);
+		} else if (seg->type == M_JSON_JSONPATH_SEG_INDEX && M_json_jsonpath_offset_iter_init(&iter, seg, array_len)) {
+			while (M_json_jsonpath_offset_iter_next(&iter, &i)) {
+				M_json_jsonpath_search(M_json_array_at(node, i), path, seg_offset+1, M_FALSE, matches, num_matches);
 			}
-			M_list_u64_destroy(array_offsets);
 		}
 
 		/* This should NOT be an "else if" to the prior statement as there could legitimately be additional
 		 * matches at deeper layers, and we need to search those too */
 		if (search_recursive) {
 			for (i=0; i<array_len; i++) {
-				M_json_jsonpath_search(M_json_array_at(node, i), segments, seg_offset, M_TRUE, matches, num_matches);
+				M_json_jsonpath_search(M_json_array_at(node, i), path, seg_offset, M_TRUE, matches, num_matches);
 			}
 		}
 	}
 }
 
-M_json_node_t **M_json_jsonpath(const M_json_node_t *node, const char *search, size_t *num_matches)
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+M_json_jsonpath_t *M_json_jsonpath_compile(const char *search)
 {
-	M_json_node_t **matches          = NULL;
-	char          **segments;
-	char          **idx_segments;
-	M_list_str_t   *seg_list;
-	M_buf_t        *buf;
-	char           *out;
-	size_t          num_segments     = 0;
-	size_t          num_idx_segments = 0;
-	size_t          i;
-	size_t          j;
+	M_json_jsonpath_t *path;
+	M_list_str_t      *seg_list;
+	size_t             i;
 
-	if (node == NULL || search == NULL || num_matches == NULL)
+	seg_list = M_json_jsonpath_segments(search);
+	if (seg_list == NULL)
 		return NULL;
 
-	*num_matches = 0;
+	path           = M_malloc_zero(sizeof(*path));
+	path->num_segs = M_list_str_len(seg_list);
+	if (path->num_segs != 0) {
+		path->segs = M_malloc_zero(path->num_segs * sizeof(*path->segs));
+	}
+	for (i=0; i<path->num_segs; i++) {
+		M_json_jsonpath_compile_seg(M_list_str_at(seg_list, i), &path->segs[i]);
+	}
 
-	/* All JSON search expressions must start with a '$'. */
-	if (M_str_len(search) < 1 || *search != '$')
-		return NULL;
+	M_list_str_destroy(seg_list);
+	return path;
+}
 
-	segments = M_str_explode_str('.', search+1, &num_segments);
-	if (segments == NULL || num_segments == 0) {
-		/* Silence coverity, if num_segments is 0, segments should be NULL */
-		M_str_explode_free(segments, num_segments);
-		return NULL;
+void M_json_jsonpath_destroy(M_json_jsonpath_t *path)
+{
+	size_t i;
+
+	if (path == NULL)
+		return;
+
+	for (i=0; i<path->num_segs; i++) {
+		M_free(path->segs[i].key);
+		M_free(path->segs[i].offsets);
 	}
+	M_free(path->segs);
+	M_free(path);
+}
 
-	/* Further split on '[' to pull out indexes */
-	seg_list = M_list_str_create(M_LIST_STR_NONE);
-	for (i=0; i<num_segments; i++) {
-		if (*(segments[i]) == '\0') {
-			M_list_str_insert(seg_list, "");
-			continue;
-		}
+M_json_node_t **M_json_jsonpath_eval(const M_json_jsonpath_t *path, const M_json_node_t *node, size_t *num_matches)
+{
+	M_json_node_t **matches = NULL;
 
-		idx_segments = M_str_explode_str('[', segments[i], &num_idx_segments);
-		if (idx_segments == NULL || num_idx_segments == 0) {
-			M_str_explode_free(idx_segments, num_idx_segments);
-			continue;
-		}
+	if (path == NULL || node == NULL || num_matches == NULL)
+		return NULL;
 
-		for (j=0; j<num_idx_segments; j++) {
-			/* Empty means we found a '[', skip it. */
-			if (idx_segments[j] == NULL || *(idx_segments[j]) == '\0')
-				continue;
+	*num_matches = 0;
 
-			/* First one may not start with '['. We need to check if the segement is something like:
-			 * 'abc'/'abc[1]' vs '[1]'. */
-			if (j == 0 && *(segments[i]) != '[') {
-				M_list_str_insert(seg_list, idx_segments[j]);
-				continue;
-			}
+	M_json_jsonpath_search(node, path, 0, M_FALSE, &matches, num_matches);
+	return matches;
+}
 
-			/* Put the '[' back on the front of the segement and add it to our list of segements. */
-			buf = M_buf_create();
-			M_buf_add_byte(buf, '[');
-			M_buf_add_str(buf, idx_segments[j]);
-			out = M_buf_finish_str(buf, NULL);
-			M_list_str_insert(seg_list, out);
-			M_free(out);
-		}
-		M_str_explode_free(idx_segments, num_idx_segments);
-	}
-	M_str_explode_free(segments, num_segments);
+M_json_node_t **M_json_jsonpath(const M_json_node_t *node, const char *search, size_t *num_matches)
+{
+	M_json_node_t     **matches;
+	M_json_jsonpath_t  *path;
 
-	M_json_jsonpath_search(node, seg_list, 0, M_FALSE, &matches, num_matches);
-	M_list_str_destroy(seg_list);
+	if (node == NULL || search == NULL || num_matches == NULL)
+		return NULL;
+
+	*num_matches = 0;
+
+	path = M_json_jsonpath_compile(search);
+	if (path == NULL)
+		return NULL;
+
+	matches = M_json_jsonpath_eval(path, node, num_matches);
+	M_json_jsonpath_destroy(path);
 	return matches;
 }
@@ -29,7 +29,7 @@
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-static M_json_node_t *M_json_read_value(M_parser_t *parser, M_uint32 flags, M_json_error_t *error);
+static M_json_node_t *M_json_read_value(M_parser_t *parser, M_arena_t *arena, M_uint32 flags, M_json_error_t *error);
 
 /*! Eat comments.
  * Supports C and C++ style / * and / / (no spaces between the two characters) comments.
@@ -123,7 +123,7 @@ static M_bool M_json_eat_ignored(M_parser_t *parser, M_uint32 flags, M_json_erro
 	return M_TRUE;
 }
 
-static M_json_node_t *M_json_read_object(M_parser_t *parser, M_uint32 flags, M_json_error_t *error)
+static M_json_node_t *M_json_read_object(M_parser_t *parser, M_arena_t *arena, M_uint32 flags, M_json_error_t *error)
 {
 	M_json_node_t *key_node;
 	M_json_node_t *val_node;
@@ -132,7 +132,7 @@ static M_json_node_t *M_json_read_object(M_parser_t *parser, M_uint32 flags, M_j
 
 	/* Move past the opening '{'. */
 	M_parser_consume(parser, 1);
-	node = M_json_node_create(M_JSON_TYPE_OBJECT);
+	node = M_json_node_create_arena(M_JSON_TYPE_OBJECT, arena);
 
 	while (M_parser_peek_byte(parser, &c) && c != '}') {
 		if (!M_json_eat_ignored(parser, flags, error)) {
@@ -158,7 +158,7 @@ static M_json_node_t *M_json_read_object(M_parser_t *parser, M_uint32 flags, M_j
 		}
 
 		/* Read the key part of the pair. */
-		key_node = M_json_read_value(parser, flags, error);
+		key_node = M_json_read_value(parser, arena, flags, error);
 		if (key_node == NULL) {
 			M_json_node_destroy(node);
 			return NULL;
@@ -190,7 +190,7 @@ static M_json_node_t *M_json_read_object(M_parser_t *parser, M_uint32 flags, M_j
 		M_parser_consume(parser, 1);
 
 		/* Read the value part of the pair. */
-		val_node = M_json_read_value(parser, flags, error);
+		val_node = M_json_read_value(parser, arena, flags, error);
 		if (val_node == NULL) {
 			M_json_node_destroy(key_node);
 			M_json_node_destroy(node);
@@ -240,7 +240,7 @@ static M_json_node_t *M_json_read_object(M_parser_t *parser, M_uint32 flags, M_j
 	return node;
 }
 
-static M_json_node_t *M_json_read_array(M_parser_t *parser, M_uint32 flags, M_json_error_t *error)
+static M_json_node_t *M_json_read_array(M_parser_t *parser, M_arena_t *arena, M_uint32 flags, M_json_error_t *error)
 {
 	M_json_node_t *sub_node;
 	M_json_node_t *node    = NULL;
@@ -249,7 +249,7 @@ static M_json_node_t *M_json_read_array(M_parser_t *parser, M_uint32 flags, M_js
 
 	/* Move past the opening '['. */
 	M_parser_consume(parser, 1);
-	node = M_json_node_create(M_JSON_TYPE_ARRAY);
+	node = M_json_node_create_arena(M_JSON_TYPE_ARRAY, arena);
 
 	if (!M_json_eat_ignored(parser, flags, error)) {
 		M_json_node_destroy(node);
@@ -269,7 +269,7 @@ static M_json_node_t *M_json_read_array(M_parser_t *parser, M_uint32 flags, M_js
 		}
 
 		/* Read the value from the list*/
-		sub_node = M_json_read_value(parser, flags, error);
+		sub_node = M_json_read_value(parser, arena, flags, error);
 		if (sub_node == NULL) {
 			M_json_node_destroy(node);
 			return NULL;
@@ -316,11 +316,91 @@ static M_json_node_t *M_json_read_array(M_parser_t *parser, M_uint32 flags, M_js
 	return node;
 }
 
-static M_json_node_t *M_json_read_string(M_parser_t *parser, M_uint32 flags, M_json_error_t *error)
+/*! Destination for a string being decoded. Arena strings are decoded directly
+ *  into arena memory, otherwise into a buffer whose memory the node takes. */
+typedef struct {
+	M_arena_t *arena;
+	M_buf_t   *buf;
+	char      *data;
+	size_t     len;
+	size_t     size;
+} M_json_str_out_t;
+
+static void M_json_str_out_init(M_json_str_out_t *out, M_parser_t *parser, M_arena_t *arena)
+{
+	const unsigned char *end;
+
+	M_mem_set(out, 0, sizeof(*out));
+	out->arena = arena;
+
+	if (arena == NULL) {
+		out->buf = M_buf_create();
+		return;
+	}
+
+	/* Decoding never makes a string longer so the raw length up to the first
+	 * quote is usually enough. An escaped quote means it might have to grow. */
+	end = M_mem_chr(M_parser_peek(parser), '"', M_parser_len(parser));
+	if (end != NULL) {
+		out->size = (size_t)(end - M_parser_peek(parser)) + 1;
+	} else {
+		out->size = 16;
+	}
+	out->data = M_arena_alloc(arena, out->size);
+}
+
+static void M_json_str_out_add(M_json_str_out_t *out, const void *bytes, size_t len)
+{
+	char *data;
+
+	if (out->arena == NULL) {
+		M_buf_add_bytes(out->buf, bytes, len);
+		return;
+	}
+
+	/* Always keep room for the NULL terminator. The old memory stays in the arena. */
+	if (out->len + len >= out->size) {
+		out->size = (out->len + len + 1) * 2;
+		data      = M_arena_alloc(out->arena, out->size);
+		M_mem_copy(data, out->data, out->len);
+		out->data = data;
+	}
+
+	M_mem_copy(out->data + out->len, bytes, len);
+	out->len += len;
+}
+
+static void M_json_str_out_add_byte(M_json_str_out_t *out, unsigned char b)
+{
+	M_json_str_out_add(out, &b, 1);
+}
+
+static void M_json_str_out_cancel(M_json_str_out_t *out)
+{
+	M_buf_cancel(out->buf);
+	out->buf = NULL;
+}
+
+static char *M_json_str_out_finish(M_json_str_out_t *out)
+{
+	char *str;
+
+	if (out->arena != NULL) {
+		out->data[out->len] = '\0';
+		return out->data;
+	}
+
+	str      = M_buf_finish_str(out->buf, NULL);
+	out->buf = NULL;
+	if (str == NULL)
+		str = M_strdup("");
+	return str;
+}
+
+static M_json_node_t *M_json_read_string(M_parser_t *parser, M_arena_t *arena, M_uint32 flags, M_json_error_t *error)
 {
 	M_json_node_t       *node;
-	M_buf_t             *buf;
-	char                *out;
+	M_json_str_out_t     out;
 	const unsigned char *s;
 	char                 uchr[8];
 	M_uint32             codepoint;
@@ -334,19 +414,19 @@ static M_json_node_t *M_json_read_string(M_parser_t *parser, M_uint32 flags, M_j
 	/* Skip past the '"' that starts the string. */
 	M_parser_consume(parser, 1);
 
-	buf = M_buf_create();
+	M_json_str_out_init(&out, parser, arena);
 	while (M_parser_peek_byte(parser, &c) && c != '"' && cp != '\\') {
 		/* Control character. */
 		if (c < 32) {
 			if (flags & M_JSON_READER_REPLACE_BAD_CHARS) {
-				M_buf_add_byte(buf, '?');
+				M_json_str_out_add_byte(&out, '?');
 			} else {
 				if (c == '\n') {
 					*error = M_JSON_ERROR_UNEXPECTED_NEWLINE;
 				} else {
 					*error = M_JSON_ERROR_UNEXPECTED_CONTROL_CHAR;
 				}
-				M_buf_cancel(buf);
+				M_json_str_out_cancel(&out);
 				return NULL;
 			}
 		/* Escape. */
@@ -362,28 +442,28 @@ static M_json_node_t *M_json_read_string(M_parser_t *parser, M_uint32 flags, M_j
 			switch (ce) {
 				case '"':
 				case '/':
-					M_buf_add_byte(buf, ce);
+					M_json_str_out_add_byte(&out, ce);
 					break;
 				case '\\':
-					M_buf_add_byte(buf, ce);
+					M_json_str_out_add_byte(&out, ce);
 					/* We have \\ which is an escape for \. We don't want to set cp = \ later because
  					 * it will look like we are starting an escape instead of ending one. */
 					ce = 0;
 					break;
 				case 'b':
-					M_buf_add_byte(buf, '\b');
+					M_json_str_out_add_byte(&out, '\b');
 					break;
 				case 'f':
-					M_buf_add_byte(buf, '\f');
+					M_json_str_out_add_byte(&out, '\f');
 					break;
 				case 'n':
-					M_buf_add_byte(buf, '\n');
+					M_json_str_out_add_byte(&out, '\n');
 					break;
 				case 'r':
-					M_buf_add_byte(buf, '\r');
+					M_json_str_out_add_byte(&out, '\r');
 					break;
 				case 't':
-					M_buf_add_byte(buf, '\t');
+					M_json_str_out_add_byte(&out, '\t');
 					break;
 				case 'u':
 					/* Check if we have enough data, it's a hex number, and it's a valid
@@ -405,24 +485,24 @@ static M_json_node_t *M_json_read_string(M_parser_t *parser, M_uint32 flags, M_j
 									M_parser_consume(parser, 1);
 								}
 							}
-							M_buf_add_byte(buf, '?');
+							M_json_str_out_add_byte(&out, '?');
 							break;
 						} else {
-							M_buf_cancel(buf);
+							M_json_str_out_cancel(&out);
 							*error = M_JSON_ERROR_INVALID_UNICODE_ESACPE;
 							return NULL;
 						}
 					}
 					if (flags & M_JSON_READER_DONT_DECODE_UNICODE) {
-						M_buf_add_str(buf, "\\u");
-						M_buf_add_bytes(buf, s+1, 4);
+						M_json_str_out_add(&out, "\\u", 2);
+						M_json_str_out_add(&out, s+1, 4);
 					} else {
-						M_buf_add_bytes(buf, uchr, uchr_len);
+						M_json_str_out_add(&out, uchr, uchr_len);
 					}
 					M_parser_consume(parser, 4);
 					break;
 				default:
-					M_buf_cancel(buf);
+					M_json_str_out_cancel(&out);
 					*error = M_JSON_ERROR_UNEXPECTED_ESCAPE;
 					return NULL;
 			}
@@ -432,26 +512,24 @@ static M_json_node_t *M_json_read_string(M_parser_t *parser, M_uint32 flags, M_j
 		}
 
 		cp = c;
-		M_buf_add_byte(buf, c);
+		M_json_str_out_add_byte(&out, c);
 		M_parser_consume(parser, 1);
 	}
 
 	if (!M_parser_peek_byte(parser, &c) || c != '"') {
-		M_buf_cancel(buf);
+		M_json_str_out_cancel(&out);
 		*error = M_JSON_ERROR_UNCLOSED_STRING;
 		return NULL;
 	}
 	M_parser_consume(parser, 1);
 
-	out  = M_buf_finish_str(buf, NULL);
-	node = M_json_node_create(M_JSON_TYPE_STRING);
-	M_json_set_string(node, M_str_safe(out));
-	M_free(out);
+	node                   = M_json_node_create_arena(M_JSON_TYPE_STRING, arena);
+	node->data.json_string = M_json_str_out_finish(&out);
 
 	return node;
 }
 
-static M_json_node_t *M_json_read_bool(M_parser_t *parser, M_uint32 flags, M_json_error_t *error)
+static M_json_node_t *M_json_read_bool(M_parser_t *parser, M_arena_t *arena, M_uint32 flags, M_json_error_t *error)
 {
 	M_json_node_t       *node;
 	const unsigned char *s;
@@ -472,14 +550,14 @@ static M_json_node_t *M_json_read_bool(M_parser_t *parser, M_uint32 flags, M_jso
 	
 	istrue = *s=='t'?M_TRUE:M_FALSE;
 
-	node = M_json_node_create(M_JSON_TYPE_BOOL);
+	node = M_json_node_create_arena(M_JSON_TYPE_BOOL, arena);
 	M_json_set_bool(node, istrue);
 	M_parser_consume(parser, istrue?4:5);
 
 	return node;
 }
 
-static M_json_node_t *M_json_read_null(M_parser_t *parser, M_uint32 flags, M_json_error_t *error)
+static M_json_node_t *M_json_read_null(M_parser_t *parser, M_arena_t *arena, M_uint32 flags, M_json_error_t *error)
 {
 	(void)flags;
 
@@ -489,10 +567,10 @@ static M_json_node_t *M_json_read_null(M_parser_t *parser, M_uint32 flags, M_jso
 	}
 
 	M_parser_consume(parser, 4);
-	return M_json_node_create(M_JSON_TYPE_NULL);
+	return M_json_node_create_arena(M_JSON_TYPE_NULL, arena);
 }
 
-static M_json_node_t *M_json_read_number(M_parser_t *parser, M_uint32 flags, M_json_error_t *error)
+static M_json_node_t *M_json_read_number(M_parser_t *parser, M_arena_t *arena, M_uint32 flags, M_json_error_t *error)
 {
 	M_json_node_t         *node;
 	M_decimal_t            decimal;
@@ -507,17 +585,17 @@ static M_json_node_t *M_json_read_number(M_parser_t *parser, M_uint32 flags, M_j
 	}
 
 	if (M_decimal_num_decimals(&decimal) == 0) {
-		node = M_json_node_create(M_JSON_TYPE_INTEGER);
+		node = M_json_node_create_arena(M_JSON_TYPE_INTEGER, arena);
 		M_json_set_int(node, M_decimal_to_int(&decimal, 0));
 	} else {
-		node = M_json_node_create(M_JSON_TYPE_DECIMAL);
+		node = M_json_node_create_arena(M_JSON_TYPE_DECIMAL, arena);
 		M_json_set_decimal(node, &decimal);
 	}
 
 	return node;
 }
 
-static M_json_node_t *M_json_read_value(M_parser_t *parser, M_uint32 flags, M_json_error_t *error)
+static M_json_node_t *M_json_read_value(M_parser_t *parser, M_arena_t *arena, M_uint32 flags, M_json_error_t *error)
 {
 	unsigned char c;
 
@@ -529,16 +607,16 @@ static M_json_node_t *M_json_read_value(M_parser_t *parser, M_uint32 flags, M_js
 		c = *M_parser_peek(parser);
 		switch (c) {
 			case '{':
-				return M_json_read_object(parser, flags, error);
+				return M_json_read_object(parser, arena, flags, error);
 			case '[':
-				return M_json_read_array(parser, flags, error);
+				return M_json_read_array(parser, arena, flags, error);
 			case '"':
-				return M_json_read_string(parser, flags, error);
+				return M_json_read_string(parser, arena, flags, error);
 			case 't':
 			case 'f':
-				return M_json_read_bool(parser, flags, error);
+				return M_json_read_bool(parser, arena, flags, error);
 			case 'n':
-				return M_json_read_null(parser, flags, error);
+				return M_json_read_null(parser, arena, flags, error);
 			case '-':
 			case '0':
 			case '1':
@@ -550,7 +628,7 @@ static M_json_node_t *M_json_read_value(M_parser_t *parser, M_uint32 flags, M_js
 			case '7':
 			case '8':
 			case '9':
-				return M_json_read_number(parser, flags, error);
+				return M_json_read_number(parser, arena, flags, error);
 			case '\0':
 				*error = M_JSON_ERROR_UNEXPECTED_TERMINATION;
 				return NULL;
@@ -590,7 +668,7 @@ static void M_json_read_format_error_pos(M_parser_t *parser, size_t *error_line,
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-M_json_node_t *M_json_read(const char *data, size_t data_len, M_uint32 flags, size_t *processed_len, M_json_error_t *error, size_t *error_line, size_t *error_pos)
+M_json_node_t *M_json_read_arena(M_arena_t *arena, const char *data, size_t data_len, M_uint32 flags, size_t *processed_len, M_json_error_t *error, size_t *error_line, size_t *error_pos)
 {
 	M_json_node_t  *root;
 	M_parser_t     *parser;
@@ -615,7 +693,7 @@ M_json_node_t *M_json_read(const char *data, size_t data_len, M_uint32 flags, si
 	}
 
 	parser = M_parser_create_const((const unsigned char *)data, data_len, M_PARSER_FLAG_TRACKLINES);
-	root   = M_json_read_value(parser, flags, error);
+	root   = M_json_read_value(parser, arena, flags, error);
 	if (root == NULL) {
 		M_json_read_format_error_pos(parser, error_line, error_pos);
 		M_json_node_destroy(root);
@@ -655,6 +733,11 @@ M_json_node_t *M_json_read(const char *data, size_t data_len, M_uint32 flags, si
 	return root;
 }
 
+M_json_node_t *M_json_read(const char *data, size_t data_len, M_uint32 flags, size_t *processed_len, M_json_error_t *error, size_t *error_line, size_t *error_pos)
+{
+	return M_json_read_arena(NULL, data, data_len, flags, processed_len, error, error_line, error_pos);
+}
+
 M_json_node_t *M_json_read_file(const char *path, M_uint32 flags, size_t max_read, M_json_error_t *error, size_t *error_line, size_t *error_pos)
 {
 	char          *buf = NULL;
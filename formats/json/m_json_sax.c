@@ -0,0 +1,671 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2026 Monetra Technologies, LLC.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "m_config.h"
+
+#include <mstdlib/mstdlib.h>
+#include <mstdlib/mstdlib_formats.h>
+#include "json/m_json_int.h"
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* Numbers longer than this can't be represented by M_decimal_t anyway. Limiting
+ * them keeps a garbage stream of digits from growing the token buffer. */
+#define M_JSON_SAX_MAX_NUMBER 256
+
+typedef enum {
+	M_JSON_SAX_STATE_START = 0,    /* Before the root object or array. */
+	M_JSON_SAX_STATE_VALUE,        /* Value required after ':' or ','. */
+	M_JSON_SAX_STATE_ARRAY_FIRST,  /* After '[', value or ']'. */
+	M_JSON_SAX_STATE_OBJECT_FIRST, /* After '{', key or '}'. */
+	M_JSON_SAX_STATE_KEY,          /* Key required after ','. */
+	M_JSON_SAX_STATE_COLON,        /* After a key. */
+	M_JSON_SAX_STATE_NEXT,         /* After a value, ',' or close. */
+	M_JSON_SAX_STATE_DONE,         /* Root has been closed. */
+	M_JSON_SAX_STATE_STRING,
+	M_JSON_SAX_STATE_NUMBER,
+	M_JSON_SAX_STATE_LITERAL,
+	M_JSON_SAX_STATE_COMMENT_START,
+	M_JSON_SAX_STATE_COMMENT_LINE,
+	M_JSON_SAX_STATE_COMMENT_BLOCK,
+	M_JSON_SAX_STATE_COMMENT_BLOCK_STAR
+} M_json_sax_state_t;
+
+struct M_json_sax {
+	struct M_json_sax_callbacks   cbs;
+	void                         *thunk;
+	M_uint32                      flags;
+
+	M_json_sax_state_t            state;
+	M_json_sax_state_t            comment_return; /* State to go back to when a comment ends. */
+	M_json_error_t                error;
+	M_bool                        finished;
+
+	unsigned char                *stack;          /* '{' or '[' for every open container. */
+	M_hash_dict_t               **keys;           /* Keys seen in each open object. Only with OBJECT_UNIQUE_KEYS. */
+	size_t                        depth;
+	size_t                        stack_size;
+
+	M_buf_t                      *token;          /* Raw data of the string, number or literal being read. */
+	M_buf_t                      *decoded;        /* Unescaped string. */
+	M_bool                        is_key;
+	M_bool                        escape;         /* Last byte in the string was an unescaped '\'. */
+
+	size_t                        offset;         /* Bytes processed before the current feed. */
+	size_t                        line;
+	size_t                        line_start;     /* Offset of the first byte on the current line. */
+};
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static M_bool M_json_sax_isspace(unsigned char c)
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static M_bool M_json_sax_isnumber(unsigned char c)
+{
+	return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+static unsigned char M_json_sax_top(const M_json_sax_t *sax)
+{
+	if (sax->depth == 0)
+		return 0;
+	return sax->stack[sax->depth-1];
+}
+
+/* Where to go after a value has been fully read. */
+static void M_json_sax_value_done(M_json_sax_t *sax)
+{
+	sax->state = sax->depth == 0 ? M_JSON_SAX_STATE_DONE : M_JSON_SAX_STATE_NEXT;
+}
+
+static void M_json_sax_push(M_json_sax_t *sax, unsigned char c)
+{
+	size_t i;
+
+	if (sax->depth == sax->stack_size) {
+		sax->stack_size = sax->stack_size == 0 ? 16 : sax->stack_size * 2;
+		sax->stack      = M_realloc(sax->stack, sax->stack_size);
+		if (sax->flags & M_JSON_READER_OBJECT_UNIQUE_KEYS) {
+			sax->keys = M_realloc(sax->keys, sizeof(*sax->keys) * sax->stack_size);
+			for (i=sax->depth; i<sax->stack_size; i++) {
+				sax->keys[i] = NULL;
+			}
+		}
+	}
+
+	if (c == '{' && sax->keys != NULL) {
+		M_hash_dict_destroy(sax->keys[sax->depth]);
+		sax->keys[sax->depth] = M_hash_dict_create(16, 75, M_HASH_DICT_NONE);
+	}
+
+	sax->stack[sax->depth++] = c;
+}
+
+static M_json_error_t M_json_sax_open(M_json_sax_t *sax, unsigned char c)
+{
+	M_json_sax_push(sax, c);
+
+	if (c == '{') {
+		sax->state = M_JSON_SAX_STATE_OBJECT_FIRST;
+		if (sax->cbs.object_start_func != NULL)
+			return sax->cbs.object_start_func(sax->thunk);
+		return M_JSON_ERROR_SUCCESS;
+	}
+
+	sax->state = M_JSON_SAX_STATE_ARRAY_FIRST;
+	if (sax->cbs.array_start_func != NULL)
+		return sax->cbs.array_start_func(sax->thunk);
+	return M_JSON_ERROR_SUCCESS;
+}
+
+/* c must match the top of the stack. */
+static M_json_error_t M_json_sax_close(M_json_sax_t *sax, unsigned char c)
+{
+	sax->depth--;
+	M_json_sax_value_done(sax);
+
+	if (c == '}') {
+		if (sax->cbs.object_end_func != NULL)
+			return sax->cbs.object_end_func(sax->thunk);
+		return M_JSON_ERROR_SUCCESS;
+	}
+
+	if (sax->cbs.array_end_func != NULL)
+		return sax->cbs.array_end_func(sax->thunk);
+	return M_JSON_ERROR_SUCCESS;
+}
+
+static void M_json_sax_start_string(M_json_sax_t *sax, M_bool is_key)
+{
+	M_buf_truncate(sax->token, 0);
+	sax->is_key = is_key;
+	sax->escape = M_FALSE;
+	sax->state  = M_JSON_SAX_STATE_STRING;
+}
+
+static M_json_error_t M_json_sax_start_value(M_json_sax_t *sax, unsigned char c)
+{
+	switch (c) {
+		case '{':
+		case '[':
+			return M_json_sax_open(sax, c);
+		case '"':
+			M_json_sax_start_string(sax, M_FALSE);
+			return M_JSON_ERROR_SUCCESS;
+		case 't':
+		case 'f':
+		case 'n':
+			M_buf_truncate(sax->token, 0);
+			M_buf_add_byte(sax->token, c);
+			sax->state = M_JSON_SAX_STATE_LITERAL;
+			return M_JSON_ERROR_SUCCESS;
+		case '\0':
+			return M_JSON_ERROR_UNEXPECTED_TERMINATION;
+		default:
+			break;
+	}
+
+	if (c == '-' || (c >= '0' && c <= '9')) {
+		M_buf_truncate(sax->token, 0);
+		M_buf_add_byte(sax->token, c);
+		sax->state = M_JSON_SAX_STATE_NUMBER;
+		return M_JSON_ERROR_SUCCESS;
+	}
+
+	return M_JSON_ERROR_INVALID_IDENTIFIER;
+}
+
+/* Handle a byte between tokens. Whitespace and comments have already been dealt with. */
+static M_json_error_t M_json_sax_structural(M_json_sax_t *sax, unsigned char c)
+{
+	unsigned char top = M_json_sax_top(sax);
+
+	switch (sax->state) {
+		case M_JSON_SAX_STATE_START:
+			if (c != '{' && c != '[')
+				return M_JSON_ERROR_INVALID_START;
+			return M_json_sax_open(sax, c);
+
+		case M_JSON_SAX_STATE_VALUE:
+			if (c == '}' || c == ']')
+				return M_JSON_ERROR_EXPECTED_VALUE;
+			return M_json_sax_start_value(sax, c);
+
+		case M_JSON_SAX_STATE_ARRAY_FIRST:
+			if (c == ']')
+				return M_json_sax_close(sax, c);
+			return M_json_sax_start_value(sax, c);
+
+		case M_JSON_SAX_STATE_OBJECT_FIRST:
+			if (c == '}')
+				return M_json_sax_close(sax, c);
+			if (c != '"')
+				return M_JSON_ERROR_INVALID_PAIR_START;
+			M_json_sax_start_string(sax, M_TRUE);
+			return M_JSON_ERROR_SUCCESS;
+
+		case M_JSON_SAX_STATE_KEY:
+			if (c == '}')
+				return M_JSON_ERROR_EXPECTED_VALUE;
+			if (c != '"')
+				return M_JSON_ERROR_INVALID_PAIR_START;
+			M_json_sax_start_string(sax, M_TRUE);
+			return M_JSON_ERROR_SUCCESS;
+
+		case M_JSON_SAX_STATE_COLON:
+			if (c != ':')
+				return M_JSON_ERROR_MISSING_PAIR_SEPARATOR;
+			sax->state = M_JSON_SAX_STATE_VALUE;
+			return M_JSON_ERROR_SUCCESS;
+
+		case M_JSON_SAX_STATE_NEXT:
+			if (c == ',') {
+				sax->state = top == '{' ? M_JSON_SAX_STATE_KEY : M_JSON_SAX_STATE_VALUE;
+				return M_JSON_ERROR_SUCCESS;
+			}
+			if ((c == '}' && top == '{') || (c == ']' && top == '['))
+				return M_json_sax_close(sax, c);
+			return top == '{' ? M_JSON_ERROR_OBJECT_UNEXPECTED_CHAR : M_JSON_ERROR_ARRAY_UNEXPECTED_CHAR;
+
+		case M_JSON_SAX_STATE_DONE:
+			return M_JSON_ERROR_EXPECTED_END;
+
+		default:
+			break;
+	}
+
+	return M_JSON_ERROR_GENERIC;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static M_json_error_t M_json_sax_string_done(M_json_sax_t *sax)
+{
+	const unsigned char *s;
+	const char          *str;
+	char                *out;
+	size_t               len;
+	size_t               out_len;
+	size_t               i;
+	M_json_error_t       res;
+
+	s   = (const unsigned char *)M_buf_peek(sax->token);
+	len = M_buf_len(sax->token);
+
+	/* Most strings don't need any decoding so the raw data is passed through. */
+	for (i=0; i<len; i++) {
+		if (s[i] == '\\' || s[i] < 32) {
+			break;
+		}
+	}
+
+	if (i == len) {
+		M_buf_add_byte(sax->token, '\0');
+		str = M_buf_peek(sax->token);
+	} else {
+		M_buf_truncate(sax->decoded, 0);
+		out_len = len+1;
+		out     = (char *)M_buf_direct_write_start(sax->decoded, &out_len);
+		res     = M_json_unescape((const char *)s, len, sax->flags, out, &len);
+		if (res != M_JSON_ERROR_SUCCESS) {
+			M_buf_direct_write_end(sax->decoded, 0);
+			return res;
+		}
+		out[len] = '\0';
+		M_buf_direct_write_end(sax->decoded, len+1);
+		str = M_buf_peek(sax->decoded);
+	}
+
+	if (!sax->is_key) {
+		M_json_sax_value_done(sax);
+		if (sax->cbs.value_string_func != NULL)
+			return sax->cbs.value_string_func(str, len, sax->thunk);
+		return M_JSON_ERROR_SUCCESS;
+	}
+
+	if (sax->keys != NULL) {
+		if (M_hash_dict_get(sax->keys[sax->depth-1], str, NULL))
+			return M_JSON_ERROR_DUPLICATE_KEY;
+		M_hash_dict_insert(sax->keys[sax->depth-1], str, NULL);
+	}
+
+	sax->state = M_JSON_SAX_STATE_COLON;
+	if (sax->cbs.key_func != NULL)
+		return sax->cbs.key_func(str, len, sax->thunk);
+	return M_JSON_ERROR_SUCCESS;
+}
+
+/* Read string data. Returns the number of bytes consumed. */
+static size_t M_json_sax_string(M_json_sax_t *sax, const unsigned char *data, size_t len, M_json_error_t *res)
+{
+	size_t i = 0;
+	size_t start;
+
+	while (i < len) {
+		if (sax->escape) {
+			M_buf_add_byte(sax->token, data[i]);
+			sax->escape = M_FALSE;
+			i++;
+			continue;
+		}
+
+		if (data[i] == '"') {
+			*res = M_json_sax_string_done(sax);
+			return i+1;
+		}
+
+		if (data[i] == '\\') {
+			M_buf_add_byte(sax->token, data[i]);
+			sax->escape = M_TRUE;
+			i++;
+			continue;
+		}
+
+		start = i;
+		while (i < len && data[i] != '"' && data[i] != '\\') {
+			i++;
+		}
+		M_buf_add_bytes(sax->token, data+start, i-start);
+	}
+
+	return i;
+}
+
+static M_json_error_t M_json_sax_number_done(M_json_sax_t *sax)
+{
+	M_decimal_t            decimal;
+	enum M_DECIMAL_RETVAL  rv;
+	const char            *end = NULL;
+	const char            *s;
+	size_t                 len;
+
+	s   = M_buf_peek(sax->token);
+	len = M_buf_len(sax->token);
+
+	rv = M_decimal_from_str(s, len, &decimal, &end);
+	if (end != s+len ||
+		(!(sax->flags & M_JSON_READER_ALLOW_DECIMAL_TRUNCATION) && rv != M_DECIMAL_SUCCESS) ||
+		((sax->flags & M_JSON_READER_ALLOW_DECIMAL_TRUNCATION) && rv != M_DECIMAL_SUCCESS && rv != M_DECIMAL_TRUNCATION))
+	{
+		return M_JSON_ERROR_INVALID_NUMBER;
+	}
+
+	M_json_sax_value_done(sax);
+
+	if (M_decimal_num_decimals(&decimal) == 0) {
+		if (sax->cbs.value_int_func != NULL)
+			return sax->cbs.value_int_func(M_decimal_to_int(&decimal, 0), sax->thunk);
+		return M_JSON_ERROR_SUCCESS;
+	}
+
+	if (sax->cbs.value_decimal_func != NULL)
+		return sax->cbs.value_decimal_func(&decimal, sax->thunk);
+	return M_JSON_ERROR_SUCCESS;
+}
+
+static M_json_error_t M_json_sax_literal_done(M_json_sax_t *sax)
+{
+	const char *s   = M_buf_peek(sax->token);
+	size_t      len = M_buf_len(sax->token);
+
+	if (*s == 'n') {
+		if (len != 4 || !M_mem_eq(s, "null", 4))
+			return M_JSON_ERROR_INVALID_NULL;
+		M_json_sax_value_done(sax);
+		if (sax->cbs.value_null_func != NULL)
+			return sax->cbs.value_null_func(sax->thunk);
+		return M_JSON_ERROR_SUCCESS;
+	}
+
+	if ((len != 4 || !M_mem_eq(s, "true", 4)) && (len != 5 || !M_mem_eq(s, "false", 5)))
+		return M_JSON_ERROR_INVALID_BOOL;
+
+	M_json_sax_value_done(sax);
+	if (sax->cbs.value_bool_func != NULL)
+		return sax->cbs.value_bool_func(*s == 't' ? M_TRUE : M_FALSE, sax->thunk);
+	return M_JSON_ERROR_SUCCESS;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* Update the line tracking for data that has been processed. */
+static void M_json_sax_track(M_json_sax_t *sax, const unsigned char *data, size_t len)
+{
+	size_t i;
+	size_t cnt;
+
+	if (len == 0)
+		return;
+
+	cnt = M_mem_count(data, len, '\n');
+	if (cnt == 0)
+		return;
+
+	sax->line += cnt;
+	for (i=len; i-->0; ) {
+		if (data[i] == '\n') {
+			sax->line_start = sax->offset + i + 1;
+			break;
+		}
+	}
+}
+
+static M_json_error_t M_json_sax_process(M_json_sax_t *sax, const unsigned char *data, size_t len, size_t *processed)
+{
+	M_json_error_t res = M_JSON_ERROR_SUCCESS;
+	size_t         i   = 0;
+	unsigned char  c;
+
+	while (i < len && res == M_JSON_ERROR_SUCCESS) {
+		c = data[i];
+
+		switch (sax->state) {
+			case M_JSON_SAX_STATE_STRING:
+				i += M_json_sax_string(sax, data+i, len-i, &res);
+				/* Point the error at the end of the string. */
+				if (res != M_JSON_ERROR_SUCCESS)
+					i--;
+				continue;
+
+			case M_JSON_SAX_STATE_NUMBER:
+				if (M_json_sax_isnumber(c)) {
+					if (M_buf_len(sax->token) >= M_JSON_SAX_MAX_NUMBER) {
+						res = M_JSON_ERROR_INVALID_NUMBER;
+						continue;
+					}
+					M_buf_add_byte(sax->token, c);
+					i++;
+					continue;
+				}
+				/* The terminating character is handled by the next state. */
+				res = M_json_sax_number_done(sax);
+				continue;
+
+			case M_JSON_SAX_STATE_LITERAL:
+				if (c >= 'a' && c <= 'z') {
+					/* Longest literal is "false". */
+					if (M_buf_len(sax->token) >= 5) {
+						res = *M_buf_peek(sax->token) == 'n' ? M_JSON_ERROR_INVALID_NULL : M_JSON_ERROR_INVALID_BOOL;
+						continue;
+					}
+					M_buf_add_byte(sax->token, c);
+					i++;
+					continue;
+				}
+				res = M_json_sax_literal_done(sax);
+				continue;
+
+			case M_JSON_SAX_STATE_COMMENT_START:
+				if (c == '/') {
+					sax->state = M_JSON_SAX_STATE_COMMENT_LINE;
+				} else if (c == '*') {
+					sax->state = M_JSON_SAX_STATE_COMMENT_BLOCK;
+				} else {
+					res = M_JSON_ERROR_UNEXPECTED_COMMENT_START;
+					continue;
+				}
+				i++;
+				continue;
+
+			case M_JSON_SAX_STATE_COMMENT_LINE:
+				if (c == '\n')
+					sax->state = sax->comment_return;
+				i++;
+				continue;
+
+			case M_JSON_SAX_STATE_COMMENT_BLOCK:
+			case M_JSON_SAX_STATE_COMMENT_BLOCK_STAR:
+				if (c == '/' && sax->state == M_JSON_SAX_STATE_COMMENT_BLOCK_STAR) {
+					sax->state = sax->comment_return;
+				} else {
+					sax->state = c == '*' ? M_JSON_SAX_STATE_COMMENT_BLOCK_STAR : M_JSON_SAX_STATE_COMMENT_BLOCK;
+				}
+				i++;
+				continue;
+
+			default:
+				break;
+		}
+
+		if (M_json_sax_isspace(c)) {
+			i++;
+			continue;
+		}
+
+		if (c == '/' && !(sax->flags & M_JSON_READER_DISALLOW_COMMENTS)) {
+			sax->comment_return = sax->state;
+			sax->state          = M_JSON_SAX_STATE_COMMENT_START;
+			i++;
+			continue;
+		}
+
+		res = M_json_sax_structural(sax, c);
+		if (res == M_JSON_ERROR_SUCCESS) {
+			i++;
+		}
+	}
+
+	*processed = i;
+	return res;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+M_json_sax_t *M_json_sax_create(const struct M_json_sax_callbacks *cbs, M_uint32 flags, void *thunk)
+{
+	M_json_sax_t *sax;
+
+	sax          = M_malloc_zero(sizeof(*sax));
+	sax->thunk   = thunk;
+	sax->flags   = flags;
+	sax->token   = M_buf_create();
+	sax->decoded = M_buf_create();
+	if (cbs != NULL)
+		M_mem_copy(&sax->cbs, cbs, sizeof(sax->cbs));
+
+	M_json_sax_reset(sax);
+	return sax;
+}
+
+void M_json_sax_destroy(M_json_sax_t *sax)
+{
+	size_t i;
+
+	if (sax == NULL)
+		return;
+
+	if (sax->keys != NULL) {
+		for (i=0; i<sax->stack_size; i++) {
+			M_hash_dict_destroy(sax->keys[i]);
+		}
+		M_free(sax->keys);
+	}
+	M_free(sax->stack);
+	M_buf_cancel(sax->token);
+	M_buf_cancel(sax->decoded);
+	M_free(sax);
+}
+
+void M_json_sax_reset(M_json_sax_t *sax)
+{
+	if (sax == NULL)
+		return;
+
+	sax->state      = M_JSON_SAX_STATE_START;
+	sax->error      = M_JSON_ERROR_SUCCESS;
+	sax->finished   = M_FALSE;
+	sax->depth      = 0;
+	sax->offset     = 0;
+	sax->line       = 1;
+	sax->line_start = 0;
+	M_buf_truncate(sax->token, 0);
+	M_buf_truncate(sax->decoded, 0);
+}
+
+M_json_error_t M_json_sax_feed(M_json_sax_t *sax, const char *data, size_t data_len)
+{
+	size_t processed = 0;
+
+	if (sax == NULL || (data == NULL && data_len != 0) || sax->finished)
+		return M_JSON_ERROR_MISUSE;
+
+	if (sax->error != M_JSON_ERROR_SUCCESS)
+		return sax->error;
+
+	sax->error = M_json_sax_process(sax, (const unsigned char *)data, data_len, &processed);
+	M_json_sax_track(sax, (const unsigned char *)data, processed);
+	sax->offset += processed;
+
+	return sax->error;
+}
+
+M_json_error_t M_json_sax_finish(M_json_sax_t *sax)
+{
+	if (sax == NULL || sax->finished)
+		return M_JSON_ERROR_MISUSE;
+
+	sax->finished = M_TRUE;
+	if (sax->error != M_JSON_ERROR_SUCCESS)
+		return sax->error;
+
+	switch (sax->state) {
+		case M_JSON_SAX_STATE_DONE:
+			return M_JSON_ERROR_SUCCESS;
+		case M_JSON_SAX_STATE_START:
+			sax->error = M_JSON_ERROR_UNEXPECTED_END;
+			return sax->error;
+		case M_JSON_SAX_STATE_STRING:
+			sax->error = M_JSON_ERROR_UNCLOSED_STRING;
+			return sax->error;
+		case M_JSON_SAX_STATE_COMMENT_START:
+			sax->error = M_JSON_ERROR_UNEXPECTED_COMMENT_START;
+			return sax->error;
+		case M_JSON_SAX_STATE_COMMENT_BLOCK:
+		case M_JSON_SAX_STATE_COMMENT_BLOCK_STAR:
+			sax->error = M_JSON_ERROR_MISSING_COMMENT_CLOSE;
+			return sax->error;
+		case M_JSON_SAX_STATE_COMMENT_LINE:
+			/* A line comment can end the data. */
+			if (sax->comment_return == M_JSON_SAX_STATE_DONE)
+				return M_JSON_ERROR_SUCCESS;
+			break;
+		default:
+			break;
+	}
+
+	if (sax->depth == 0) {
+		sax->error = M_JSON_ERROR_UNEXPECTED_END;
+	} else {
+		sax->error = M_json_sax_top(sax) == '{' ? M_JSON_ERROR_UNCLOSED_OBJECT : M_JSON_ERROR_UNCLOSED_ARRAY;
+	}
+	return sax->error;
+}
+
+size_t M_json_sax_depth(const M_json_sax_t *sax)
+{
+	if (sax == NULL)
+		return 0;
+	return sax->depth;
+}
+
+void M_json_sax_position(const M_json_sax_t *sax, size_t *line, size_t *pos)
+{
+	if (line != NULL)
+		*line = 0;
+	if (pos != NULL)
+		*pos = 0;
+
+	if (sax == NULL)
+		return;
+
+	if (line != NULL) {
+		*line = sax->line;
+		if (pos != NULL)
+			*pos = sax->offset - sax->line_start + 1;
+	} else if (pos != NULL) {
+		*pos = sax->offset;
+	}
+}
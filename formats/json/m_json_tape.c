@@ -0,0 +1,1252 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2026 Monetra Technologies, LLC.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "m_config.h"
+
+#include <mstdlib/mstdlib.h>
+#include <mstdlib/mstdlib_formats.h>
+#include "json/m_json_int.h"
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* String still has escapes or control characters that need to be decoded. The
+ * reader flags that affect decoding are stored with it. */
+#define M_JSON_TAPE_NODE_ESCAPED (1U << 31)
+
+/* Every value in the document is one node in a contiguous array in document
+ * order. Children directly follow their parent. For objects each pair is a key
+ * string node followed by the value. */
+struct M_json_tape_node {
+	M_json_type_t type;
+	M_uint32      flags;
+	size_t        len;  /*!< String length. Number of pairs in an object or elements in an array. */
+	size_t        span; /*!< Number of nodes used by this node and everything under it. */
+	union {
+		char        *str;      /*!< Points into the tape's copy of the data. */
+		M_int64      integer;
+		M_decimal_t  decimal;
+		M_bool       boolean;
+		struct {
+			size_t idx;
+			size_t offset;
+		} last;                /*!< Last child accessed. Makes sequential access linear. */
+	} data;
+};
+
+struct M_json_tape {
+	char               *data;
+	size_t              data_len;
+	M_uint32            flags;
+	M_json_tape_node_t *nodes;
+	size_t              num_nodes;
+	size_t              num_alloc;
+};
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static M_bool M_json_tape_isspace(char c)
+{
+	return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+}
+
+static M_bool M_json_tape_isdigit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+static M_bool M_json_tape_isnumber(char c)
+{
+	return M_json_tape_isdigit(c) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+static M_json_tape_node_t *M_json_tape_add(M_json_tape_t *tape, M_json_type_t type)
+{
+	M_json_tape_node_t *node;
+
+	if (tape->num_nodes == tape->num_alloc) {
+		tape->num_alloc = tape->num_alloc == 0 ? 64 : tape->num_alloc * 2;
+		tape->nodes     = M_realloc(tape->nodes, sizeof(*tape->nodes) * tape->num_alloc);
+	}
+
+	node = &tape->nodes[tape->num_nodes++];
+	M_mem_set(node, 0, sizeof(*node));
+	node->type = type;
+	node->span = 1;
+	return node;
+}
+
+/* Whitespace and comments. Same rules as M_json_read. */
+static M_json_error_t M_json_tape_eat_ignored(const M_json_tape_t *tape, size_t *pos)
+{
+	const char *s   = tape->data;
+	size_t      len = tape->data_len;
+	size_t      p   = *pos;
+
+	for (;;) {
+		while (p < len && M_json_tape_isspace(s[p])) {
+			p++;
+		}
+
+		if (p >= len || s[p] != '/' || (tape->flags & M_JSON_READER_DISALLOW_COMMENTS))
+			break;
+
+		if (p+1 < len && s[p+1] == '*') {
+			p += 2;
+			while (p+1 < len && (s[p] != '*' || s[p+1] != '/')) {
+				p++;
+			}
+			if (p+1 >= len) {
+				*pos = p;
+				return M_JSON_ERROR_MISSING_COMMENT_CLOSE;
+			}
+			p += 2;
+		} else if (p+1 < len && s[p+1] == '/') {
+			while (p < len && s[p] != '\n') {
+				p++;
+			}
+		} else {
+			*pos = p;
+			return M_JSON_ERROR_UNEXPECTED_COMMENT_START;
+		}
+	}
+
+	*pos = p;
+	return M_JSON_ERROR_SUCCESS;
+}
+
+/* Strings are validated but escapes aren't decoded until the string is used.
+ * The closing quote is replaced with a NULL so the string can be used in place. */
+static M_json_error_t M_json_tape_read_string(M_json_tape_t *tape, size_t *pos)
+{
+	M_json_tape_node_t *node;
+	char               *s       = tape->data;
+	size_t              len     = tape->data_len;
+	size_t              start   = *pos + 1;
+	size_t              p       = start;
+	M_uint32            flags   = 0;
+	char                utf8[4];
+	size_t              utf8_len;
+	unsigned char       c;
+
+	for (;;) {
+		while (p < len && s[p] != '"' && s[p] != '\\' && (unsigned char)s[p] >= 32) {
+			p++;
+		}
+
+		if (p >= len) {
+			*pos = p;
+			return M_JSON_ERROR_UNCLOSED_STRING;
+		}
+
+		c = (unsigned char)s[p];
+		if (c == '"')
+			break;
+
+		flags = M_JSON_TAPE_NODE_ESCAPED;
+
+		if (c < 32) {
+			if (!(tape->flags & M_JSON_READER_REPLACE_BAD_CHARS)) {
+				*pos = p;
+				return c == '\n' ? M_JSON_ERROR_UNEXPECTED_NEWLINE : M_JSON_ERROR_UNEXPECTED_CONTROL_CHAR;
+			}
+			p++;
+			continue;
+		}
+
+		if (p+1 >= len) {
+			*pos = p;
+			return M_JSON_ERROR_UNCLOSED_STRING;
+		}
+
+		switch (s[p+1]) {
+			case '"':
+			case '/':
+			case '\\':
+			case 'b':
+			case 'f':
+			case 'n':
+			case 'r':
+			case 't':
+				p += 2;
+				break;
+			case 'u':
+				if (M_json_unicode_escape(s+p+2, len-p-2, utf8, &utf8_len)) {
+					p += 6;
+				} else if (tape->flags & M_JSON_READER_REPLACE_BAD_CHARS) {
+					p += 2;
+				} else {
+					*pos = p;
+					return M_JSON_ERROR_INVALID_UNICODE_ESACPE;
+				}
+				break;
+			default:
+				*pos = p;
+				return M_JSON_ERROR_UNEXPECTED_ESCAPE;
+		}
+	}
+
+	node           = M_json_tape_add(tape, M_JSON_TYPE_STRING);
+	node->data.str = s+start;
+	node->len      = p-start;
+	if (flags != 0)
+		node->flags = flags | (tape->flags & (M_JSON_READER_REPLACE_BAD_CHARS|M_JSON_READER_DONT_DECODE_UNICODE));
+	s[p] = '\0';
+
+	*pos = p+1;
+	return M_JSON_ERROR_SUCCESS;
+}
+
+static M_json_error_t M_json_tape_read_number(M_json_tape_t *tape, size_t *pos)
+{
+	M_json_tape_node_t    *node;
+	const char            *s    = tape->data + *pos;
+	size_t                 left = tape->data_len - *pos;
+	const char            *end  = NULL;
+	M_decimal_t            decimal;
+	enum M_DECIMAL_RETVAL  rv;
+	M_uint64               val  = 0;
+	size_t                 i    = 0;
+	size_t                 start;
+
+	/* Most numbers are small integers which can be converted directly. */
+	if (s[0] == '-')
+		i++;
+	start = i;
+	while (i < left && i-start < 18 && M_json_tape_isdigit(s[i])) {
+		val = (val * 10) + (M_uint64)(s[i] - '0');
+		i++;
+	}
+	if (i > start && (i == left || !M_json_tape_isnumber(s[i]))) {
+		node               = M_json_tape_add(tape, M_JSON_TYPE_INTEGER);
+		node->data.integer = s[0] == '-' ? -(M_int64)val : (M_int64)val;
+		*pos              += i;
+		return M_JSON_ERROR_SUCCESS;
+	}
+
+	/* Anything else uses the same conversion as M_json_read. */
+	for (i=0; i<left && M_json_tape_isnumber(s[i]); i++)
+		;
+
+	/* A trailing '.' doesn't set end. */
+	rv = M_decimal_from_str(s, i, &decimal, &end);
+	if (end == NULL || rv == M_DECIMAL_OVERFLOW || rv == M_DECIMAL_INVALID ||
+		(rv == M_DECIMAL_TRUNCATION && !(tape->flags & M_JSON_READER_ALLOW_DECIMAL_TRUNCATION)))
+	{
+		return M_JSON_ERROR_INVALID_NUMBER;
+	}
+
+	if (M_decimal_num_decimals(&decimal) == 0) {
+		node               = M_json_tape_add(tape, M_JSON_TYPE_INTEGER);
+		node->data.integer = M_decimal_to_int(&decimal, 0);
+	} else {
+		node = M_json_tape_add(tape, M_JSON_TYPE_DECIMAL);
+		M_decimal_duplicate(&node->data.decimal, &decimal);
+		M_decimal_reduce(&node->data.decimal);
+	}
+
+	*pos += (size_t)(end - s);
+	return M_JSON_ERROR_SUCCESS;
+}
+
+static M_json_error_t M_json_tape_read_literal(M_json_tape_t *tape, size_t *pos)
+{
+	M_json_tape_node_t *node;
+	const char         *s    = tape->data + *pos;
+	size_t              left = tape->data_len - *pos;
+
+	if (left >= 4 && M_mem_eq(s, "true", 4)) {
+		node               = M_json_tape_add(tape, M_JSON_TYPE_BOOL);
+		node->data.boolean = M_TRUE;
+		*pos              += 4;
+	} else if (left >= 5 && M_mem_eq(s, "false", 5)) {
+		node               = M_json_tape_add(tape, M_JSON_TYPE_BOOL);
+		node->data.boolean = M_FALSE;
+		*pos              += 5;
+	} else if (left >= 4 && M_mem_eq(s, "null", 4)) {
+		M_json_tape_add(tape, M_JSON_TYPE_NULL);
+		*pos += 4;
+	} else {
+		return *s == 'n' ? M_JSON_ERROR_INVALID_NULL : M_JSON_ERROR_INVALID_BOOL;
+	}
+
+	return M_JSON_ERROR_SUCCESS;
+}
+
+static M_json_error_t M_json_tape_read_value(M_json_tape_t *tape, size_t *pos)
+{
+	char c = tape->data[*pos];
+
+	switch (c) {
+		case '"':
+			return M_json_tape_read_string(tape, pos);
+		case 't':
+		case 'f':
+		case 'n':
+			return M_json_tape_read_literal(tape, pos);
+		case '\0':
+			return M_JSON_ERROR_UNEXPECTED_TERMINATION;
+		default:
+			break;
+	}
+
+	if (c == '-' || M_json_tape_isdigit(c))
+		return M_json_tape_read_number(tape, pos);
+	return M_JSON_ERROR_INVALID_IDENTIFIER;
+}
+
+/* Check the key just added to the tape hasn't been seen in the object.
+ *
+ * Escaped keys are decoded into a copy. Decoding in place would change the
+ * data error positions are calculated from. */
+static M_json_error_t M_json_tape_check_key(M_json_tape_t *tape, M_hash_dict_t **keys, size_t depth)
+{
+	const M_json_tape_node_t *node    = &tape->nodes[tape->num_nodes-1];
+	const char               *key     = node->data.str;
+	char                     *decoded = NULL;
+	size_t                    len;
+	M_json_error_t            res     = M_JSON_ERROR_SUCCESS;
+
+	if (node->flags & M_JSON_TAPE_NODE_ESCAPED) {
+		decoded      = M_malloc(node->len+1);
+		M_json_unescape(node->data.str, node->len, node->flags, decoded, &len);
+		decoded[len] = '\0';
+		key          = decoded;
+	}
+
+	if (keys[depth-1] == NULL)
+		keys[depth-1] = M_hash_dict_create(16, 75, M_HASH_DICT_NONE);
+
+	if (M_hash_dict_get(keys[depth-1], key, NULL)) {
+		res = M_JSON_ERROR_DUPLICATE_KEY;
+	} else {
+		M_hash_dict_insert(keys[depth-1], key, NULL);
+	}
+
+	M_free(decoded);
+	return res;
+}
+
+/* Grow the container stack. */
+static void M_json_tape_stack_grow(const M_json_tape_t *tape, size_t **stack, M_hash_dict_t ***keys, size_t *stack_alloc)
+{
+	size_t i = *stack_alloc;
+
+	*stack_alloc = *stack_alloc == 0 ? 16 : *stack_alloc * 2;
+	*stack       = M_realloc(*stack, sizeof(**stack) * *stack_alloc);
+	if (tape->flags & M_JSON_READER_OBJECT_UNIQUE_KEYS) {
+		*keys = M_realloc(*keys, sizeof(**keys) * *stack_alloc);
+		for ( ; i<*stack_alloc; i++) {
+			(*keys)[i] = NULL;
+		}
+	}
+}
+
+static void M_json_tape_keys_destroy(M_hash_dict_t **keys, size_t stack_alloc)
+{
+	size_t i;
+
+	if (keys == NULL)
+		return;
+
+	for (i=0; i<stack_alloc; i++) {
+		M_hash_dict_destroy(keys[i]);
+	}
+	M_free(keys);
+}
+
+/* Containers are tracked with a stack of tape indexes instead of recursion. */
+static M_json_error_t M_json_tape_parse(M_json_tape_t *tape, size_t *pos)
+{
+	const char      *s           = tape->data;
+	size_t           len         = tape->data_len;
+	size_t           p           = 0;
+	size_t          *stack       = NULL;
+	M_hash_dict_t  **keys        = NULL;
+	size_t           depth       = 0;
+	size_t           stack_alloc = 0;
+	size_t           idx;
+	M_json_error_t   res;
+	M_bool           is_obj;
+	char             c;
+
+	res = M_json_tape_eat_ignored(tape, &p);
+	if (res != M_JSON_ERROR_SUCCESS)
+		goto done;
+
+	if (p >= len || (s[p] != '{' && s[p] != '[')) {
+		res = p >= len ? M_JSON_ERROR_UNEXPECTED_END : M_JSON_ERROR_INVALID_START;
+		goto done;
+	}
+	c = s[p];
+
+	for (;;) {
+		/* c is the start of a value at p. */
+		if (c == '{' || c == '[') {
+			if (depth == stack_alloc)
+				M_json_tape_stack_grow(tape, &stack, &keys, &stack_alloc);
+			stack[depth++] = tape->num_nodes;
+			M_json_tape_add(tape, c == '{' ? M_JSON_TYPE_OBJECT : M_JSON_TYPE_ARRAY);
+			p++;
+		} else {
+			res = M_json_tape_read_value(tape, &p);
+			if (res != M_JSON_ERROR_SUCCESS)
+				goto done;
+		}
+
+		/* Close containers until there is another value to read. */
+		for (;;) {
+			idx    = stack[depth-1];
+			is_obj = tape->nodes[idx].type == M_JSON_TYPE_OBJECT;
+
+			res = M_json_tape_eat_ignored(tape, &p);
+			if (res != M_JSON_ERROR_SUCCESS)
+				goto done;
+			if (p >= len) {
+				res = is_obj ? M_JSON_ERROR_UNCLOSED_OBJECT : M_JSON_ERROR_UNCLOSED_ARRAY;
+				goto done;
+			}
+
+			c = s[p];
+			if (c != (is_obj ? '}' : ']'))
+				break;
+
+			tape->nodes[idx].span = tape->num_nodes - idx;
+			if (keys != NULL && keys[depth-1] != NULL) {
+				M_hash_dict_destroy(keys[depth-1]);
+				keys[depth-1] = NULL;
+			}
+			depth--;
+			p++;
+			if (depth == 0)
+				goto done;
+		}
+
+		if (tape->nodes[idx].len != 0) {
+			if (c != ',') {
+				res = is_obj ? M_JSON_ERROR_OBJECT_UNEXPECTED_CHAR : M_JSON_ERROR_ARRAY_UNEXPECTED_CHAR;
+				goto done;
+			}
+			p++;
+			res = M_json_tape_eat_ignored(tape, &p);
+			if (res != M_JSON_ERROR_SUCCESS)
+				goto done;
+			if (p >= len) {
+				res = is_obj ? M_JSON_ERROR_UNCLOSED_OBJECT : M_JSON_ERROR_UNCLOSED_ARRAY;
+				goto done;
+			}
+			c = s[p];
+			if (c == '}' || c == ']') {
+				res = M_JSON_ERROR_EXPECTED_VALUE;
+				goto done;
+			}
+		}
+
+		if (is_obj) {
+			if (c != '"') {
+				res = M_JSON_ERROR_INVALID_PAIR_START;
+				goto done;
+			}
+			res = M_json_tape_read_string(tape, &p);
+			if (res == M_JSON_ERROR_SUCCESS && keys != NULL) {
+				res = M_json_tape_check_key(tape, keys, depth);
+				/* Point at the closing quote of the key like the SAX reader. */
+				if (res != M_JSON_ERROR_SUCCESS)
+					p--;
+			}
+			if (res == M_JSON_ERROR_SUCCESS)
+				res = M_json_tape_eat_ignored(tape, &p);
+			if (res != M_JSON_ERROR_SUCCESS)
+				goto done;
+
+			if (p >= len) {
+				res = M_JSON_ERROR_UNCLOSED_OBJECT;
+				goto done;
+			}
+			if (s[p] != ':') {
+				res = M_JSON_ERROR_MISSING_PAIR_SEPARATOR;
+				goto done;
+			}
+			p++;
+
+			res = M_json_tape_eat_ignored(tape, &p);
+			if (res != M_JSON_ERROR_SUCCESS)
+				goto done;
+			if (p >= len) {
+				res = M_JSON_ERROR_UNCLOSED_OBJECT;
+				goto done;
+			}
+			c = s[p];
+			if (c == '}' || c == ']') {
+				res = M_JSON_ERROR_EXPECTED_VALUE;
+				goto done;
+			}
+		}
+
+		tape->nodes[idx].len++;
+	}
+
+done:
+	M_json_tape_keys_destroy(keys, stack_alloc);
+	M_free(stack);
+
+	*pos = p;
+	return res;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static M_bool M_json_tape_index_next(M_json_index_t *index, size_t *pos, M_bool *special)
+{
+	size_t e;
+
+	if (index->next == index->num_entries && M_json_index_fill(index) == 0)
+		return M_FALSE;
+
+	e    = index->entries[index->next++];
+	*pos = M_JSON_INDEX_POS(e);
+	if (special != NULL)
+		*special = M_JSON_INDEX_SPECIAL(e) ? M_TRUE : M_FALSE;
+	return M_TRUE;
+}
+
+/* The closing quote is always the next entry. Strings without escapes or
+ * control characters don't need to be looked at. */
+static M_bool M_json_tape_index_string(M_json_tape_t *tape, M_json_index_t *index, size_t start)
+{
+	M_json_tape_node_t *node;
+	size_t              end;
+	size_t              p       = start;
+	M_bool              special;
+
+	if (!M_json_tape_index_next(index, &end, &special))
+		return M_FALSE;
+
+	if (special)
+		return M_json_tape_read_string(tape, &p) == M_JSON_ERROR_SUCCESS && p == end+1;
+
+	node            = M_json_tape_add(tape, M_JSON_TYPE_STRING);
+	node->data.str  = tape->data + start + 1;
+	node->len       = end - start - 1;
+	tape->data[end] = '\0';
+	return M_TRUE;
+}
+
+/* Same structure as M_json_tape_parse but driven by the structural index so
+ * whitespace and string contents are never walked a byte at a time.
+ *
+ * Only handles valid documents without comments. Anything else returns
+ * M_FALSE and the document is parsed again with M_json_tape_parse which
+ * determines the error and where it is. */
+static M_bool M_json_tape_parse_indexed(M_json_tape_t *tape, size_t *pos)
+{
+	M_json_index_t  index;
+	const char     *s           = tape->data;
+	size_t          len         = tape->data_len;
+	size_t         *stack       = NULL;
+	M_hash_dict_t **keys        = NULL;
+	size_t          depth       = 0;
+	size_t          stack_alloc = 0;
+	size_t          idx         = 0;
+	size_t          p;
+	size_t          q;
+	M_bool          is_obj      = M_FALSE;
+	M_bool          ret         = M_FALSE;
+	char            c;
+
+	M_json_index_init(&index, s, len);
+
+	if (!M_json_tape_index_next(&index, &p, NULL) || (s[p] != '{' && s[p] != '['))
+		return M_FALSE;
+	c = s[p];
+
+	for (;;) {
+		if (c == '{' || c == '[') {
+			if (depth == stack_alloc)
+				M_json_tape_stack_grow(tape, &stack, &keys, &stack_alloc);
+			stack[depth++] = tape->num_nodes;
+			M_json_tape_add(tape, c == '{' ? M_JSON_TYPE_OBJECT : M_JSON_TYPE_ARRAY);
+		} else if (c == '"') {
+			if (!M_json_tape_index_string(tape, &index, p))
+				goto done;
+		} else {
+			q = p;
+			if (M_json_tape_read_value(tape, &q) != M_JSON_ERROR_SUCCESS)
+				goto done;
+			/* Every run starts with an entry so anything left of this one
+			 * means the value had trailing characters. */
+			if (q < len && !M_json_tape_isspace(s[q]) && s[q] != ',' && s[q] != ']' && s[q] != '}')
+				goto done;
+		}
+
+		/* Close containers until there is another value to read. */
+		for (;;) {
+			idx    = stack[depth-1];
+			is_obj = tape->nodes[idx].type == M_JSON_TYPE_OBJECT;
+
+			if (!M_json_tape_index_next(&index, &p, NULL))
+				goto done;
+
+			c = s[p];
+			if (c != (is_obj ? '}' : ']'))
+				break;
+
+			tape->nodes[idx].span = tape->num_nodes - idx;
+			if (keys != NULL && keys[depth-1] != NULL) {
+				M_hash_dict_destroy(keys[depth-1]);
+				keys[depth-1] = NULL;
+			}
+			depth--;
+			if (depth == 0) {
+				*pos = p+1;
+				ret  = M_TRUE;
+				goto done;
+			}
+		}
+
+		if (tape->nodes[idx].len != 0) {
+			if (c != ',' || !M_json_tape_index_next(&index, &p, NULL))
+				goto done;
+			c = s[p];
+		}
+
+		if (is_obj) {
+			if (c != '"' || !M_json_tape_index_string(tape, &index, p))
+				goto done;
+			if (keys != NULL && M_json_tape_check_key(tape, keys, depth) != M_JSON_ERROR_SUCCESS)
+				goto done;
+			if (!M_json_tape_index_next(&index, &p, NULL) || s[p] != ':' || !M_json_tape_index_next(&index, &p, NULL))
+				goto done;
+			c = s[p];
+		}
+
+		tape->nodes[idx].len++;
+	}
+
+done:
+	M_json_tape_keys_destroy(keys, stack_alloc);
+	M_free(stack);
+	return ret;
+}
+
+/* Undo everything M_json_tape_parse_indexed did to the tape. */
+static void M_json_tape_reset(M_json_tape_t *tape)
+{
+	size_t i;
+
+	for (i=0; i<tape->num_nodes; i++) {
+		if (tape->nodes[i].type == M_JSON_TYPE_STRING) {
+			tape->nodes[i].data.str[tape->nodes[i].len] = '"';
+		}
+	}
+	tape->num_nodes = 0;
+}
+
+static void M_json_tape_error_pos(const char *data, size_t pos, size_t *error_line, size_t *error_pos)
+{
+	size_t line       = 1;
+	size_t line_start = 0;
+	size_t i;
+
+	if (error_line == NULL) {
+		if (error_pos != NULL)
+			*error_pos = pos;
+		return;
+	}
+
+	for (i=0; i<pos; i++) {
+		if (data[i] == '\n') {
+			line++;
+			line_start = i+1;
+		}
+	}
+
+	*error_line = line;
+	if (error_pos != NULL)
+		*error_pos = pos - line_start + 1;
+}
+
+/* Takes ownership of data. */
+static M_json_tape_t *M_json_tape_read_int(char *data, size_t data_len, M_uint32 flags, size_t *processed_len, M_json_error_t *error, size_t *error_line, size_t *error_pos)
+{
+	M_json_tape_t  *tape;
+	M_json_error_t  res;
+	size_t          pos = 0;
+
+	tape           = M_malloc_zero(sizeof(*tape));
+	tape->data     = data;
+	tape->data_len = data_len;
+	tape->flags    = flags;
+
+	if (M_json_tape_parse_indexed(tape, &pos)) {
+		res = M_JSON_ERROR_SUCCESS;
+	} else {
+		M_json_tape_reset(tape);
+		pos = 0;
+		res = M_json_tape_parse(tape, &pos);
+	}
+	if (res == M_JSON_ERROR_SUCCESS)
+		res = M_json_tape_eat_ignored(tape, &pos);
+
+	if (res == M_JSON_ERROR_SUCCESS) {
+		if (processed_len != NULL) {
+			*processed_len = pos;
+		} else if (pos != data_len) {
+			res = M_JSON_ERROR_EXPECTED_END;
+		}
+	}
+
+	if (error != NULL)
+		*error = res;
+
+	if (res != M_JSON_ERROR_SUCCESS) {
+		M_json_tape_error_pos(data, pos, error_line, error_pos);
+		M_json_tape_destroy(tape);
+		return NULL;
+	}
+
+	return tape;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+M_json_tape_t *M_json_tape_read(const char *data, size_t data_len, M_uint32 flags, size_t *processed_len, M_json_error_t *error, size_t *error_line, size_t *error_pos)
+{
+	char *copy;
+
+	if (error != NULL)
+		*error = M_JSON_ERROR_SUCCESS;
+	if (error_line != NULL)
+		*error_line = 0;
+	if (error_pos != NULL)
+		*error_pos = 0;
+
+	if (data == NULL || data_len == 0 || *data == '\0') {
+		if (error != NULL)
+			*error = M_JSON_ERROR_MISUSE;
+		return NULL;
+	}
+
+	copy = M_malloc(data_len+1);
+	M_mem_copy(copy, data, data_len);
+	copy[data_len] = '\0';
+
+	return M_json_tape_read_int(copy, data_len, flags, processed_len, error, error_line, error_pos);
+}
+
+M_json_tape_t *M_json_tape_read_file(const char *path, M_uint32 flags, size_t max_read, M_json_error_t *error, size_t *error_line, size_t *error_pos)
+{
+	char         *buf = NULL;
+	size_t        bytes_read;
+	M_fs_error_t  res;
+
+	if (error_line != NULL)
+		*error_line = 0;
+	if (error_pos != NULL)
+		*error_pos = 0;
+
+	res = M_fs_file_read_bytes(path, max_read, (unsigned char **)&buf, &bytes_read);
+	if (res != M_FS_ERROR_SUCCESS || buf == NULL || bytes_read == 0) {
+		if (error != NULL)
+			*error = res != M_FS_ERROR_SUCCESS ? M_JSON_ERROR_GENERIC : M_JSON_ERROR_MISUSE;
+		M_free(buf);
+		return NULL;
+	}
+
+	/* The file data is used as the tape's data directly. */
+	return M_json_tape_read_int(buf, bytes_read, flags, NULL, error, error_line, error_pos);
+}
+
+void M_json_tape_destroy(M_json_tape_t *tape)
+{
+	if (tape == NULL)
+		return;
+
+	M_free(tape->nodes);
+	M_free(tape->data);
+	M_free(tape);
+}
+
+M_json_tape_node_t *M_json_tape_root(M_json_tape_t *tape)
+{
+	if (tape == NULL || tape->num_nodes == 0)
+		return NULL;
+	return &tape->nodes[0];
+}
+
+size_t M_json_tape_num_nodes(const M_json_tape_t *tape)
+{
+	if (tape == NULL)
+		return 0;
+	return tape->num_nodes;
+}
+
+M_json_type_t M_json_tape_node_type(const M_json_tape_node_t *node)
+{
+	if (node == NULL)
+		return M_JSON_TYPE_UNKNOWN;
+	return node->type;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* Offset from the container to the child at idx. For objects this is the key
+ * of the pair. */
+static size_t M_json_tape_child_offset(M_json_tape_node_t *node, size_t idx)
+{
+	size_t i   = 0;
+	size_t off = 1;
+
+	if (node->data.last.offset != 0 && node->data.last.idx <= idx) {
+		i   = node->data.last.idx;
+		off = node->data.last.offset;
+	}
+
+	for ( ; i<idx; i++) {
+		if (node->type == M_JSON_TYPE_OBJECT) {
+			off += 1 + node[off+1].span;
+		} else {
+			off += node[off].span;
+		}
+	}
+
+	node->data.last.idx    = idx;
+	node->data.last.offset = off;
+	return off;
+}
+
+M_json_tape_node_t *M_json_tape_object_value(M_json_tape_node_t *node, const char *key)
+{
+	size_t i   = 0;
+	size_t off = 1;
+	size_t n;
+
+	if (node == NULL || node->type != M_JSON_TYPE_OBJECT || key == NULL)
+		return NULL;
+
+	/* Values are usually read in the order they appear so start looking
+	 * after the last one found and wrap around. */
+	if (node->data.last.offset != 0) {
+		i   = node->data.last.idx;
+		off = node->data.last.offset;
+	}
+
+	for (n=0; n<node->len; n++) {
+		if (i == node->len) {
+			i   = 0;
+			off = 1;
+		}
+
+		if (M_str_eq(M_json_tape_get_string(node+off), key)) {
+			node->data.last.idx    = i;
+			node->data.last.offset = off;
+			return node+off+1;
+		}
+
+		off += 1 + node[off+1].span;
+		i++;
+	}
+
+	return NULL;
+}
+
+const char *M_json_tape_object_value_string(M_json_tape_node_t *node, const char *key)
+{
+	return M_json_tape_get_string(M_json_tape_object_value(node, key));
+}
+
+M_int64 M_json_tape_object_value_int(M_json_tape_node_t *node, const char *key)
+{
+	return M_json_tape_get_int(M_json_tape_object_value(node, key));
+}
+
+const M_decimal_t *M_json_tape_object_value_decimal(M_json_tape_node_t *node, const char *key)
+{
+	return M_json_tape_get_decimal(M_json_tape_object_value(node, key));
+}
+
+M_bool M_json_tape_object_value_bool(M_json_tape_node_t *node, const char *key)
+{
+	return M_json_tape_get_bool(M_json_tape_object_value(node, key));
+}
+
+M_list_str_t *M_json_tape_object_keys(M_json_tape_node_t *node)
+{
+	M_list_str_t *keys;
+	size_t        off = 1;
+	size_t        i;
+
+	if (node == NULL || node->type != M_JSON_TYPE_OBJECT)
+		return NULL;
+
+	keys = M_list_str_create(M_LIST_STR_NONE);
+	for (i=0; i<node->len; i++) {
+		M_list_str_insert(keys, M_json_tape_get_string(node+off));
+		off += 1 + node[off+1].span;
+	}
+
+	return keys;
+}
+
+size_t M_json_tape_object_num_children(const M_json_tape_node_t *node)
+{
+	if (node == NULL || node->type != M_JSON_TYPE_OBJECT)
+		return 0;
+	return node->len;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+size_t M_json_tape_array_len(const M_json_tape_node_t *node)
+{
+	if (node == NULL || node->type != M_JSON_TYPE_ARRAY)
+		return 0;
+	return node->len;
+}
+
+M_json_tape_node_t *M_json_tape_array_at(M_json_tape_node_t *node, size_t idx)
+{
+	if (node == NULL || node->type != M_JSON_TYPE_ARRAY || idx >= node->len)
+		return NULL;
+	return node + M_json_tape_child_offset(node, idx);
+}
+
+const char *M_json_tape_array_at_string(M_json_tape_node_t *node, size_t idx)
+{
+	return M_json_tape_get_string(M_json_tape_array_at(node, idx));
+}
+
+M_int64 M_json_tape_array_at_int(M_json_tape_node_t *node, size_t idx)
+{
+	return M_json_tape_get_int(M_json_tape_array_at(node, idx));
+}
+
+const M_decimal_t *M_json_tape_array_at_decimal(M_json_tape_node_t *node, size_t idx)
+{
+	return M_json_tape_get_decimal(M_json_tape_array_at(node, idx));
+}
+
+M_bool M_json_tape_array_at_bool(M_json_tape_node_t *node, size_t idx)
+{
+	return M_json_tape_get_bool(M_json_tape_array_at(node, idx));
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+const char *M_json_tape_get_string(M_json_tape_node_t *node)
+{
+	if (node == NULL || node->type != M_JSON_TYPE_STRING)
+		return NULL;
+
+	/* Decode in place the first time the string is used. Decoding never makes
+	 * the string longer. The string was validated when read so this can't fail. */
+	if (node->flags & M_JSON_TAPE_NODE_ESCAPED) {
+		M_json_unescape(node->data.str, node->len, node->flags, node->data.str, &node->len);
+		node->data.str[node->len] = '\0';
+		node->flags               = 0;
+	}
+
+	return node->data.str;
+}
+
+M_int64 M_json_tape_get_int(M_json_tape_node_t *node)
+{
+	if (node == NULL)
+		return 0;
+
+	switch (node->type) {
+		case M_JSON_TYPE_INTEGER:
+			return node->data.integer;
+		case M_JSON_TYPE_STRING:
+			return M_str_to_int64(M_json_tape_get_string(node));
+		case M_JSON_TYPE_BOOL:
+			return node->data.boolean?1:0;
+		case M_JSON_TYPE_DECIMAL:
+			return M_decimal_to_int(&(node->data.decimal), 0);
+		case M_JSON_TYPE_ARRAY:
+			return (M_int64)node->len;
+		case M_JSON_TYPE_OBJECT:
+		case M_JSON_TYPE_NULL:
+		case M_JSON_TYPE_UNKNOWN:
+			return 0;
+	}
+	return 0;
+}
+
+const M_decimal_t *M_json_tape_get_decimal(const M_json_tape_node_t *node)
+{
+	if (node == NULL || node->type != M_JSON_TYPE_DECIMAL)
+		return NULL;
+	return &node->data.decimal;
+}
+
+M_bool M_json_tape_get_bool(M_json_tape_node_t *node)
+{
+	M_decimal_t d;
+
+	if (node == NULL)
+		return M_FALSE;
+
+	switch (node->type) {
+		case M_JSON_TYPE_BOOL:
+			return node->data.boolean;
+		case M_JSON_TYPE_STRING:
+			return M_str_istrue(M_json_tape_get_string(node));
+		case M_JSON_TYPE_INTEGER:
+			return node->data.integer > 0 ? M_TRUE : M_FALSE;
+		case M_JSON_TYPE_DECIMAL:
+			M_decimal_from_int(&d, 0, 0);
+			return M_decimal_cmp(&(node->data.decimal), &d) == 1 ? M_TRUE : M_FALSE;
+		case M_JSON_TYPE_ARRAY:
+			return node->len > 0 ? M_TRUE : M_FALSE;
+		case M_JSON_TYPE_OBJECT:
+		case M_JSON_TYPE_NULL:
+		case M_JSON_TYPE_UNKNOWN:
+			return M_FALSE;
+	}
+	return M_FALSE;
+}
+
+M_bool M_json_tape_get_value(M_json_tape_node_t *node, char *buf, size_t buf_len)
+{
+	if (node == NULL || buf == NULL || buf_len == 0)
+		return M_FALSE;
+
+	switch (node->type) {
+		case M_JSON_TYPE_STRING:
+			if (M_snprintf(buf, buf_len, "%s", M_json_tape_get_string(node)) >= buf_len)
+				return M_FALSE;
+			break;
+		case M_JSON_TYPE_INTEGER:
+			if (M_snprintf(buf, buf_len, "%lld", node->data.integer) >= buf_len)
+				return M_FALSE;
+			break;
+		case M_JSON_TYPE_DECIMAL:
+			if (M_decimal_to_str(&(node->data.decimal), buf, buf_len) != M_DECIMAL_SUCCESS)
+				return M_FALSE;
+			break;
+		case M_JSON_TYPE_BOOL:
+			if (M_snprintf(buf, buf_len, "%s", node->data.boolean ? "true" : "false") >= buf_len)
+				return M_FALSE;
+			break;
+		case M_JSON_TYPE_NULL:
+			if (M_snprintf(buf, buf_len, "null") >= buf_len)
+				return M_FALSE;
+			break;
+		default:
+			return M_FALSE;
+	}
+
+	return M_TRUE;
+}
+
+char *M_json_tape_get_value_dup(M_json_tape_node_t *node)
+{
+	M_buf_t *buf;
+
+	if (node == NULL)
+		return NULL;
+
+	buf = M_buf_create();
+	switch (node->type) {
+		case M_JSON_TYPE_STRING:
+			M_buf_add_str(buf, M_json_tape_get_string(node));
+			break;
+		case M_JSON_TYPE_INTEGER:
+			M_buf_add_int(buf, node->data.integer);
+			break;
+		case M_JSON_TYPE_DECIMAL:
+			if (!M_buf_add_decimal(buf, &(node->data.decimal), M_FALSE, -1, 0)) {
+				M_buf_cancel(buf);
+				return NULL;
+			}
+			break;
+		case M_JSON_TYPE_BOOL:
+			M_buf_add_str(buf, node->data.boolean ? "true" : "false");
+			break;
+		case M_JSON_TYPE_NULL:
+			M_buf_add_str(buf, "null");
+			break;
+		default:
+			M_buf_cancel(buf);
+			return NULL;
+	}
+
+	return M_buf_finish_str(buf, NULL);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+M_json_node_t *M_json_tape_to_node(M_json_tape_node_t *node)
+{
+	M_json_node_t *out;
+	size_t         off = 1;
+	size_t         i;
+
+	if (node == NULL)
+		return NULL;
+
+	out = M_json_node_create(node->type);
+	switch (node->type) {
+		case M_JSON_TYPE_OBJECT:
+			for (i=0; i<node->len; i++) {
+				M_json_object_insert(out, M_json_tape_get_string(node+off), M_json_tape_to_node(node+off+1));
+				off += 1 + node[off+1].span;
+			}
+			break;
+		case M_JSON_TYPE_ARRAY:
+			for (i=0; i<node->len; i++) {
+				M_json_array_insert(out, M_json_tape_to_node(node+off));
+				off += node[off].span;
+			}
+			break;
+		case M_JSON_TYPE_STRING:
+			M_json_set_string(out, M_json_tape_get_string(node));
+			break;
+		case M_JSON_TYPE_INTEGER:
+			M_json_set_int(out, node->data.integer);
+			break;
+		case M_JSON_TYPE_DECIMAL:
+			M_json_set_decimal(out, &node->data.decimal);
+			break;
+		case M_JSON_TYPE_BOOL:
+			M_json_set_bool(out, node->data.boolean);
+			break;
+		case M_JSON_TYPE_NULL:
+		case M_JSON_TYPE_UNKNOWN:
+			break;
+	}
+
+	return out;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static void M_json_tape_jsonpath_add_match(M_json_tape_node_t *node, M_json_tape_node_t ***matches, size_t *num_matches)
+{
+	if (*num_matches == 0 || *matches == NULL || M_size_t_round_up_to_power_of_two(*num_matches) == *num_matches) {
+		*matches = M_realloc(*matches, M_size_t_round_up_to_power_of_two(*num_matches + 1) * sizeof(**matches));
+	}
+	(*matches)[*num_matches] = node;
+	(*num_matches)++;
+}
+
+/* Same matching rules as M_json_jsonpath. */
+static void M_json_tape_jsonpath_search(M_json_tape_node_t *node, const M_json_jsonpath_t *path, size_t seg_offset, M_bool search_recursive, M_json_tape_node_t ***matches, size_t *num_matches)
+{
+	M_json_jsonpath_offset_iter_t  iter;
+	const M_json_jsonpath_seg_t   *seg;
+	size_t                         num_segments;
+	size_t                         off;
+	size_t                         i;
+
+	if (node == NULL)
+		return;
+
+	num_segments = path->num_segs-seg_offset;
+	if (num_segments == 0) {
+		M_json_tape_jsonpath_add_match(node, matches, num_matches);
+		return;
+	}
+
+	/* Only objects and arrays can have things under them. */
+	if (node->type != M_JSON_TYPE_OBJECT && node->type != M_JSON_TYPE_ARRAY)
+		return;
+
+	seg = &path->segs[seg_offset];
+	/* A blank segment denotes we want to search recursively for the next pattern */
+	if (seg->type == M_JSON_JSONPATH_SEG_RECURSE) {
+		if (num_segments > 1) {
+			M_json_tape_jsonpath_search(node, path, seg_offset+1, M_TRUE, matches, num_matches);
+		}
+		return;
+	}
+
+	if (node->type == M_JSON_TYPE_OBJECT) {
+		if (seg->type == M_JSON_JSONPATH_SEG_INDEX || seg->type == M_JSON_JSONPATH_SEG_INDEX_ANY)
+			return;
+
+		off = 1;
+		for (i=0; i<node->len; i++) {
+			if (seg->type == M_JSON_JSONPATH_SEG_KEY_ANY || M_str_caseeq(seg->key, M_json_tape_get_string(node+off))) {
+				M_json_tape_jsonpath_search(node+off+1, path, seg_offset+1, M_FALSE, matches, num_matches);
+			}
+			if (search_recursive) {
+				M_json_tape_jsonpath_search(node+off+1, path, seg_offset, M_TRUE, matches, num_matches);
+			}
+			off += 1 + node[off+1].span;
+		}
+		return;
+	}
+
+	if (seg->type == M_JSON_JSONPATH_SEG_INDEX_ANY) {
+		off = 1;
+		for (i=0; i<node->len; i++) {
+			M_json_tape_jsonpath_search(node+off, path, seg_offset+1, search_recursive, matches, num_matches);
+			off += node[off].span;
+		}
+	} else if (seg->type == M_JSON_JSONPATH_SEG_INDEX && M_json_jsonpath_offset_iter_init(&iter, seg, node->len)) {
+		while (M_json_jsonpath_offset_iter_next(&iter, &i)) {
+			M_json_tape_jsonpath_search(M_json_tape_array_at(node, i), path, seg_offset+1, M_FALSE, matches, num_matches);
+		}
+	}
+
+	if (search_recursive) {
+		off = 1;
+		for (i=0; i<node->len; i++) {
+			M_json_tape_jsonpath_search(node+off, path, seg_offset, M_TRUE, matches, num_matches);
+			off += node[off].span;
+		}
+	}
+}
+
+M_json_tape_node_t **M_json_tape_jsonpath_eval(const M_json_jsonpath_t *path, M_json_tape_node_t *node, size_t *num_matches)
+{
+	M_json_tape_node_t **matches = NULL;
+
+	if (path == NULL || node == NULL || num_matches == NULL)
+		return NULL;
+
+	*num_matches = 0;
+
+	M_json_tape_jsonpath_search(node, path, 0, M_FALSE, &matches, num_matches);
+	return matches;
+}
+
+M_json_tape_node_t **M_json_tape_jsonpath(M_json_tape_node_t *node, const char *search, size_t *num_matches)
+{
+	M_json_tape_node_t **matches;
+	M_json_jsonpath_t   *path;
+
+	if (node == NULL || search == NULL || num_matches == NULL)
+		return NULL;
+
+	*num_matches = 0;
+
+	path = M_json_jsonpath_compile(search);
+	if (path == NULL)
+		return NULL;
+
+	matches = M_json_tape_jsonpath_eval(path, node, num_matches);
+	M_json_jsonpath_destroy(path);
+	return matches;
+}
@@ -84,8 +84,10 @@ static M_bool M_json_write_node_object(const M_json_node_t *node, M_buf_t *buf,
 		if (flags & (M_JSON_WRITER_PRETTYPRINT_SPACE|M_JSON_WRITER_PRETTYPRINT_TAB))
 			M_buf_add_byte(buf, ' ');
 
-		if (!M_json_write_node((const M_json_node_t *)value, buf, depth, flags))
+		if (!M_json_write_node((const M_json_node_t *)value, buf, depth, flags)) {
+			M_hash_strvp_enumerate_free(hashenum);
 			return M_FALSE;
+		}
 
 		len--;
 		if (len > 0) {
@@ -133,7 +135,7 @@ static M_bool M_json_write_node_array(const M_json_node_t *node, M_buf_t *buf, s
 	return M_TRUE;
 }
 
-static M_bool M_json_write_node_string(const M_json_node_t *node, M_buf_t *buf, M_uint32 flags)
+static M_bool M_json_write_str(M_buf_t *buf, const char *str, M_uint32 flags)
 {
 	const char *p;
 	char        uchr[8];
@@ -142,13 +144,10 @@ static M_bool M_json_write_node_string(const M_json_node_t *node, M_buf_t *buf,
 	size_t      len;
 	size_t      i;
 
-	if (buf == NULL || node == NULL || node->type != M_JSON_TYPE_STRING)
-		return M_FALSE;
-
 	M_buf_add_byte(buf, '"');
-	len = M_str_len(node->data.json_string);
+	len = M_str_len(str);
 	for (i=0; i<len; i++) {
-		c = node->data.json_string[i];
+		c = str[i];
 		switch (c) {
 			case '\b':
 				M_buf_add_str(buf, "\\b");
@@ -184,7 +183,7 @@ static M_bool M_json_write_node_string(const M_json_node_t *node, M_buf_t *buf,
 					M_snprintf(uchr, sizeof(uchr), "%04X", c);
 					M_buf_add_str(buf, uchr);
 				} else if ((unsigned char)c > 127) {
-					if (M_utf8_get_cp(node->data.json_string+i, &cp, &p) != M_UTF8_ERROR_SUCCESS) {
+					if (M_utf8_get_cp(str+i, &cp, &p) != M_UTF8_ERROR_SUCCESS) {
 						if (flags & M_JSON_WRITER_REPLACE_BAD_CHARS) {
 							M_buf_add_byte(buf, '?');
 						} else {
@@ -194,7 +193,7 @@ static M_bool M_json_write_node_string(const M_json_node_t *node, M_buf_t *buf,
 					}
 
 					if (flags & M_JSON_WRITER_DONT_ENCODE_UNICODE) {
-						M_buf_add_bytes(buf, node->data.json_string+i, (size_t)(p - (node->data.json_string+i)));
+						M_buf_add_bytes(buf, str+i, (size_t)(p - (str+i)));
 					} else {
 						M_buf_add_str(buf, "\\u");
 						M_snprintf(uchr, sizeof(uchr), "%04X", cp);
@@ -204,7 +203,7 @@ static M_bool M_json_write_node_string(const M_json_node_t *node, M_buf_t *buf,
 					 * when we come back around to the start of the loop it will
 					 * move one forward. This needs to be the byte before the next
 					 * one that will be processed. */
-					i += (size_t)(p - (node->data.json_string+i)-1);
+					i += (size_t)(p - (str+i)-1);
 				} else {
 					M_buf_add_byte(buf, (unsigned char)c);
 				}
@@ -215,45 +214,71 @@ static M_bool M_json_write_node_string(const M_json_node_t *node, M_buf_t *buf,
 	return M_TRUE;
 }
 
-static M_bool M_json_write_node_integer(const M_json_node_t *node, M_buf_t *buf, M_uint32 flags)
+static void M_json_write_int(M_buf_t *buf, M_int64 val, M_uint32 flags)
 {
-	if (buf == NULL || node == NULL || node->type != M_JSON_TYPE_INTEGER)
-		return M_FALSE;
+	M_bool quote = M_FALSE;
+
+	if (!(flags & M_JSON_WRITER_NUMBER_NOCOMPAT) && (val < JAVASCRIPT_MIN_INT || val > JAVASCRIPT_MAX_INT))
+		quote = M_TRUE;
 
-	if (!(flags & M_JSON_WRITER_NUMBER_NOCOMPAT) && (node->data.json_integer < JAVASCRIPT_MIN_INT || node->data.json_integer > JAVASCRIPT_MAX_INT))
+	if (quote)
 		M_buf_add_byte(buf, '"');
 
-	M_buf_add_int(buf, node->data.json_integer);
+	M_buf_add_int(buf, val);
 
-	if (node->data.json_integer < JAVASCRIPT_MIN_INT || node->data.json_integer > JAVASCRIPT_MAX_INT)
+	if (quote)
 		M_buf_add_byte(buf, '"');
-
-	return M_TRUE;
 }
 
-static M_bool M_json_write_node_decimal(const M_json_node_t *node, M_buf_t *buf, M_uint32 flags)
+static M_bool M_json_write_decimal(M_buf_t *buf, const M_decimal_t *val, M_uint32 flags)
 {
 	M_int64 i64v;
 	M_uint8 num_places;
+	M_bool  quote = M_FALSE;
 	M_bool  ret;
 
-	if (buf == NULL || node == NULL || node->type != M_JSON_TYPE_DECIMAL)
-		return M_FALSE;
-
-	i64v       = M_decimal_to_int(&(node->data.json_decimal), 0);
-	num_places = M_decimal_num_decimals(&(node->data.json_decimal));
+	i64v       = M_decimal_to_int(val, 0);
+	num_places = M_decimal_num_decimals(val);
 
 	if (!(flags & M_JSON_WRITER_NUMBER_NOCOMPAT) && (num_places > 15 || i64v < JAVASCRIPT_MIN_INT || i64v > JAVASCRIPT_MAX_INT))
+		quote = M_TRUE;
+
+	if (quote)
 		M_buf_add_byte(buf, '"');
 
-	ret = M_buf_add_decimal(buf, &(node->data.json_decimal), M_FALSE, -1, 0);
+	ret = M_buf_add_decimal(buf, val, M_FALSE, -1, 0);
 
-	if (!(flags & M_JSON_WRITER_NUMBER_NOCOMPAT) && (num_places > 15 || i64v < JAVASCRIPT_MIN_INT || i64v > JAVASCRIPT_MAX_INT))
+	if (quote)
 		M_buf_add_byte(buf, '"');
 
 	return ret;
 }
 
+static M_bool M_json_write_node_string(const M_json_node_t *node, M_buf_t *buf, M_uint32 flags)
+{
+	if (buf == NULL || node == NULL || node->type != M_JSON_TYPE_STRING)
+		return M_FALSE;
+
+	return M_json_write_str(buf, node->data.json_string, flags);
+}
+
+static M_bool M_json_write_node_integer(const M_json_node_t *node, M_buf_t *buf, M_uint32 flags)
+{
+	if (buf == NULL || node == NULL || node->type != M_JSON_TYPE_INTEGER)
+		return M_FALSE;
+
+	M_json_write_int(buf, node->data.json_integer, flags);
+	return M_TRUE;
+}
+
+static M_bool M_json_write_node_decimal(const M_json_node_t *node, M_buf_t *buf, M_uint32 flags)
+{
+	if (buf == NULL || node == NULL || node->type != M_JSON_TYPE_DECIMAL)
+		return M_FALSE;
+
+	return M_json_write_decimal(buf, &(node->data.json_decimal), flags);
+}
+
 static M_bool M_json_write_node_bool(const M_json_node_t *node, M_buf_t *buf)
 {
 	if (buf == NULL || node == NULL || node->type != M_JSON_TYPE_BOOL)
@@ -305,6 +330,28 @@ static M_bool M_json_write_node(const M_json_node_t *node, M_buf_t *buf, size_t
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
+#define M_JSON_WRITER_FLUSH_SIZE (64*1024)
+
+struct M_json_writer {
+	M_buf_t                  *buf;          /* Output. Only the part that hasn't been flushed when writing to a sink. */
+	M_bool                    buf_owned;
+	M_json_writer_flush_func  flush_func;
+	void                     *thunk;
+	M_fs_file_t              *fd;
+	size_t                    flush_size;
+	M_uint32                  flags;
+
+	unsigned char            *stack;        /* '{' or '[' for every open container. */
+	size_t                    depth;
+	size_t                    stack_size;
+	M_bool                    first;        /* Nothing has been written in the current container yet. */
+	M_bool                    have_key;     /* A key was written and the value is next. */
+	M_bool                    done;         /* The root value is complete. */
+	M_bool                    failed;       /* The sink failed. */
+};
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
 char *M_json_write(const M_json_node_t *node, M_uint32 flags, size_t *len)
 {
 	M_buf_t *buf;
@@ -339,3 +386,326 @@ M_fs_error_t M_json_write_file(const M_json_node_t *node, const char *path, M_ui
 	M_free(out);
 	return res;
 }
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static M_json_writer_t *M_json_writer_create_int(M_buf_t *buf, M_bool buf_owned, size_t flush_size, M_uint32 flags)
+{
+	M_json_writer_t *w;
+
+	w             = M_malloc_zero(sizeof(*w));
+	w->buf        = buf;
+	w->buf_owned  = buf_owned;
+	w->flush_size = flush_size == 0 ? M_JSON_WRITER_FLUSH_SIZE : flush_size;
+	w->flags      = flags;
+	return w;
+}
+
+static M_bool M_json_writer_flush_int(M_json_writer_t *w)
+{
+	size_t len;
+	size_t wrote;
+
+	if (w->failed)
+		return M_FALSE;
+
+	len = M_buf_len(w->buf);
+	if (!w->buf_owned || len == 0)
+		return M_TRUE;
+
+	if (w->fd != NULL) {
+		if (M_fs_file_write(w->fd, (const unsigned char *)M_buf_peek(w->buf), len, &wrote, M_FS_FILE_RW_FULLBUF) != M_FS_ERROR_SUCCESS || wrote != len) {
+			w->failed = M_TRUE;
+		}
+	} else if (!w->flush_func((const unsigned char *)M_buf_peek(w->buf), len, w->thunk)) {
+		w->failed = M_TRUE;
+	}
+
+	M_buf_truncate(w->buf, 0);
+	return !w->failed;
+}
+
+/* Write anything that needs to come before a value and check the value
+ * is allowed here. */
+static M_bool M_json_writer_value_start(M_json_writer_t *w)
+{
+	if (w == NULL || w->failed)
+		return M_FALSE;
+
+	if (w->depth == 0) {
+		return !w->done;
+	}
+
+	if (w->stack[w->depth-1] == '{') {
+		if (!w->have_key)
+			return M_FALSE;
+		w->have_key = M_FALSE;
+		return M_TRUE;
+	}
+
+	if (!w->first)
+		M_buf_add_byte(w->buf, ',');
+	M_json_write_newline(w->buf, w->flags);
+	M_json_write_depth(w->buf, &w->depth, w->flags);
+	w->first = M_FALSE;
+	return M_TRUE;
+}
+
+static M_bool M_json_writer_value_done(M_json_writer_t *w)
+{
+	if (w->depth == 0)
+		w->done = M_TRUE;
+
+	if (w->buf_owned && M_buf_len(w->buf) >= w->flush_size)
+		return M_json_writer_flush_int(w);
+	return M_TRUE;
+}
+
+/* A value that couldn't be written is removed along with its separator so
+ * the writer can still be used. */
+static M_bool M_json_writer_value_undo(M_json_writer_t *w, size_t start_len, M_bool first, M_bool have_key)
+{
+	M_buf_truncate(w->buf, start_len);
+	w->first    = first;
+	w->have_key = have_key;
+	return M_FALSE;
+}
+
+static M_bool M_json_writer_begin(M_json_writer_t *w, unsigned char c)
+{
+	if (!M_json_writer_value_start(w))
+		return M_FALSE;
+
+	if (w->depth == w->stack_size) {
+		w->stack_size = w->stack_size == 0 ? 16 : w->stack_size * 2;
+		w->stack      = M_realloc(w->stack, w->stack_size);
+	}
+	w->stack[w->depth++] = c;
+	w->first             = M_TRUE;
+
+	M_buf_add_byte(w->buf, c);
+	return M_TRUE;
+}
+
+static M_bool M_json_writer_end(M_json_writer_t *w, unsigned char c)
+{
+	if (w == NULL || w->failed || w->depth == 0 || w->stack[w->depth-1] != c || w->have_key)
+		return M_FALSE;
+
+	w->depth--;
+	M_json_write_newline(w->buf, w->flags);
+	M_json_write_depth(w->buf, &w->depth, w->flags);
+	M_buf_add_byte(w->buf, c == '{' ? '}' : ']');
+	w->first = M_FALSE;
+
+	return M_json_writer_value_done(w);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+M_json_writer_t *M_json_writer_create(M_buf_t *buf, M_uint32 flags)
+{
+	if (buf == NULL)
+		return NULL;
+	return M_json_writer_create_int(buf, M_FALSE, 0, flags);
+}
+
+M_json_writer_t *M_json_writer_create_cb(M_json_writer_flush_func flush_func, void *thunk, size_t flush_size, M_uint32 flags)
+{
+	M_json_writer_t *w;
+
+	if (flush_func == NULL)
+		return NULL;
+
+	w             = M_json_writer_create_int(M_buf_create(), M_TRUE, flush_size, flags);
+	w->flush_func = flush_func;
+	w->thunk      = thunk;
+	return w;
+}
+
+M_json_writer_t *M_json_writer_create_file(const char *path, size_t flush_size, M_uint32 flags)
+{
+	M_json_writer_t *w;
+	M_fs_file_t     *fd;
+
+	if (M_fs_file_open(&fd, path, M_FS_BUF_SIZE, M_FS_FILE_MODE_WRITE|M_FS_FILE_MODE_OVERWRITE, NULL) != M_FS_ERROR_SUCCESS)
+		return NULL;
+
+	w     = M_json_writer_create_int(M_buf_create(), M_TRUE, flush_size, flags);
+	w->fd = fd;
+	return w;
+}
+
+void M_json_writer_destroy(M_json_writer_t *w)
+{
+	if (w == NULL)
+		return;
+
+	if (w->buf_owned)
+		M_buf_cancel(w->buf);
+	if (w->fd != NULL)
+		M_fs_file_close(w->fd);
+	M_free(w->stack);
+	M_free(w);
+}
+
+M_bool M_json_writer_object_begin(M_json_writer_t *w)
+{
+	return M_json_writer_begin(w, '{');
+}
+
+M_bool M_json_writer_object_end(M_json_writer_t *w)
+{
+	return M_json_writer_end(w, '{');
+}
+
+M_bool M_json_writer_array_begin(M_json_writer_t *w)
+{
+	return M_json_writer_begin(w, '[');
+}
+
+M_bool M_json_writer_array_end(M_json_writer_t *w)
+{
+	return M_json_writer_end(w, '[');
+}
+
+M_bool M_json_writer_key(M_json_writer_t *w, const char *key)
+{
+	size_t start_len;
+	M_bool first;
+
+	if (w == NULL || w->failed || key == NULL || w->depth == 0 || w->stack[w->depth-1] != '{' || w->have_key)
+		return M_FALSE;
+
+	start_len = M_buf_len(w->buf);
+	first     = w->first;
+
+	if (!w->first)
+		M_buf_add_byte(w->buf, ',');
+	M_json_write_newline(w->buf, w->flags);
+	M_json_write_depth(w->buf, &w->depth, w->flags);
+
+	if (!M_json_write_str(w->buf, key, w->flags)) {
+		M_buf_truncate(w->buf, start_len);
+		w->first = first;
+		return M_FALSE;
+	}
+
+	if (w->flags & (M_JSON_WRITER_PRETTYPRINT_SPACE|M_JSON_WRITER_PRETTYPRINT_TAB))
+		M_buf_add_byte(w->buf, ' ');
+	M_buf_add_byte(w->buf, ':');
+	if (w->flags & (M_JSON_WRITER_PRETTYPRINT_SPACE|M_JSON_WRITER_PRETTYPRINT_TAB))
+		M_buf_add_byte(w->buf, ' ');
+
+	w->first    = M_FALSE;
+	w->have_key = M_TRUE;
+	return M_TRUE;
+}
+
+M_bool M_json_writer_value_string(M_json_writer_t *w, const char *val)
+{
+	size_t start_len;
+	M_bool first;
+	M_bool have_key;
+
+	if (w == NULL || val == NULL)
+		return M_FALSE;
+
+	start_len = M_buf_len(w->buf);
+	first     = w->first;
+	have_key  = w->have_key;
+
+	if (!M_json_writer_value_start(w))
+		return M_FALSE;
+	if (!M_json_write_str(w->buf, val, w->flags))
+		return M_json_writer_value_undo(w, start_len, first, have_key);
+	return M_json_writer_value_done(w);
+}
+
+M_bool M_json_writer_value_int(M_json_writer_t *w, M_int64 val)
+{
+	if (!M_json_writer_value_start(w))
+		return M_FALSE;
+	M_json_write_int(w->buf, val, w->flags);
+	return M_json_writer_value_done(w);
+}
+
+M_bool M_json_writer_value_decimal(M_json_writer_t *w, const M_decimal_t *val)
+{
+	size_t start_len;
+	M_bool first;
+	M_bool have_key;
+
+	if (w == NULL || val == NULL)
+		return M_FALSE;
+
+	start_len = M_buf_len(w->buf);
+	first     = w->first;
+	have_key  = w->have_key;
+
+	if (!M_json_writer_value_start(w))
+		return M_FALSE;
+	if (!M_json_write_decimal(w->buf, val, w->flags))
+		return M_json_writer_value_undo(w, start_len, first, have_key);
+	return M_json_writer_value_done(w);
+}
+
+M_bool M_json_writer_value_bool(M_json_writer_t *w, M_bool val)
+{
+	if (!M_json_writer_value_start(w))
+		return M_FALSE;
+	M_buf_add_str(w->buf, val?"true":"false");
+	return M_json_writer_value_done(w);
+}
+
+M_bool M_json_writer_value_null(M_json_writer_t *w)
+{
+	if (!M_json_writer_value_start(w))
+		return M_FALSE;
+	M_buf_add_str(w->buf, "null");
+	return M_json_writer_value_done(w);
+}
+
+M_bool M_json_writer_value_node(M_json_writer_t *w, const M_json_node_t *node)
+{
+	size_t start_len;
+	size_t depth;
+	M_bool first;
+	M_bool have_key;
+
+	if (w == NULL || node == NULL)
+		return M_FALSE;
+
+	start_len = M_buf_len(w->buf);
+	first     = w->first;
+	have_key  = w->have_key;
+
+	if (!M_json_writer_value_start(w))
+		return M_FALSE;
+	depth = w->depth;
+	if (!M_json_write_node(node, w->buf, &depth, w->flags))
+		return M_json_writer_value_undo(w, start_len, first, have_key);
+	return M_json_writer_value_done(w);
+}
+
+M_bool M_json_writer_flush(M_json_writer_t *w)
+{
+	if (w == NULL)
+		return M_FALSE;
+	return M_json_writer_flush_int(w);
+}
+
+M_bool M_json_writer_finish(M_json_writer_t *w)
+{
+	if (w == NULL || w->depth != 0 || !w->done)
+		return M_FALSE;
+	return M_json_writer_flush_int(w);
+}
+
+size_t M_json_writer_depth(const M_json_writer_t *w)
+{
+	if (w == NULL)
+		return 0;
+	return w->depth;
+}
@@ -25,6 +25,7 @@
 
 #include <mstdlib/mstdlib.h>
 #include <mstdlib/mstdlib_formats.h>
+#include "table/m_table_int.h"
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
@@ -510,6 +511,11 @@ size_t M_table_column_remove_empty_columns(M_table_t *table)
 	return cnt;
 }
 
+M_uint64 M_table_column_id_at(const M_table_t *table, size_t idx)
+{
+	return M_list_u64_at(table->col_order, idx);
+}
+
 size_t M_table_column_count(const M_table_t *table)
 {
 	if (table == NULL)
@@ -536,6 +542,16 @@ M_bool M_table_row_insert_at(M_table_t *table, size_t idx)
 	return M_table_row_insert_at_int(table, idx, NULL);
 }
 
+void M_table_row_insert_data(M_table_t *table, M_hash_u64str_t *row_data)
+{
+	M_uint64 rowid;
+
+	M_table_row_insert_at_int(table, M_list_u64_len(table->row_order), &rowid);
+	if (row_data != NULL) {
+		M_hash_u64vp_insert(table->rows, rowid, row_data);
+	}
+}
+
 M_bool M_table_row_insert_dict(M_table_t *table, const M_hash_dict_t *data, M_uint32 flags, size_t *idx)
 {
 	size_t rowidx;
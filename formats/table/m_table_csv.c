@@ -25,6 +25,106 @@
 
 #include <mstdlib/mstdlib.h>
 #include <mstdlib/mstdlib_formats.h>
+#include "csv/m_csv_int.h"
+#include "table/m_table_int.h"
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* Smallest amount of data given to a task when loading in parallel. */
+#define M_TABLE_CSV_CHUNK_MIN (256 * 1024)
+
+/* Number of tasks per worker so a slow chunk doesn't hold up the rest. */
+#define M_TABLE_CSV_CHUNKS_PER_WORKER 4
+
+typedef struct {
+	const char        *data;
+	size_t             len;
+	char               delim;
+	char               quote;
+	M_uint32           flags;
+	size_t             num_cols;
+	const M_uint64    *colids;     /* CSV column -> table column id. */
+	const M_bool      *colvalid;   /* CSV column has a table column. */
+	M_bool             any_valid;
+	M_bool             skip_first; /* First row is the header. */
+	size_t             num_quotes;
+	M_hash_u64str_t  **rows;
+	size_t             num_rows;
+} M_table_csv_chunk_t;
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static void M_table_csv_count_task(void *arg)
+{
+	M_table_csv_chunk_t *chunk = arg;
+
+	chunk->num_quotes = M_mem_count(chunk->data, chunk->len, (M_uint8)chunk->quote);
+}
+
+/* Parse a chunk and build the cell data for each row. Only the table column
+ * ids are shared so nothing here touches the table. */
+static void M_table_csv_parse_task(void *arg)
+{
+	M_table_csv_chunk_t *chunk = arg;
+	M_hash_u64str_t     *row_data;
+	M_csv_t             *csv;
+	const char          *val;
+	char                *buf;
+	size_t               numrows;
+	size_t               i;
+	size_t               j;
+
+	buf = M_malloc(chunk->len+1);
+	M_mem_copy(buf, chunk->data, chunk->len);
+	buf[chunk->len] = 0;
+
+	csv = M_csv_parse_inplace_cols(buf, chunk->len, chunk->delim, chunk->quote, chunk->flags, chunk->num_cols);
+	if (csv == NULL) {
+		M_free(buf);
+		return;
+	}
+
+	numrows     = M_csv_raw_num_rows(csv);
+	chunk->rows = M_malloc(sizeof(*chunk->rows) * numrows);
+	for (i=chunk->skip_first?1:0; i<numrows; i++) {
+		row_data = NULL;
+		if (chunk->any_valid) {
+			row_data = M_hash_u64str_create(8, 75, M_HASH_U64STR_NONE);
+		}
+
+		for (j=0; j<chunk->num_cols; j++) {
+			if (!chunk->colvalid[j])
+				continue;
+
+			/* Same as setting cells in order, a later NULL removes an
+			 * earlier value for the same column. */
+			val = M_csv_raw_cell(csv, i, j);
+			if (val == NULL) {
+				M_hash_u64str_remove(row_data, chunk->colids[j]);
+			} else {
+				M_hash_u64str_insert(row_data, chunk->colids[j], val);
+			}
+		}
+
+		chunk->rows[chunk->num_rows++] = row_data;
+	}
+
+	M_csv_destroy(csv);
+}
+
+/* Position after the first new line outside of a quote starting at pos. Every
+ * quote toggles being in a quote, doubled quotes toggle twice. */
+static size_t M_table_csv_row_boundary(const char *data, size_t len, size_t pos, char quote, M_bool in_quote)
+{
+	for (; pos<len; pos++) {
+		if (data[pos] == quote) {
+			in_quote = !in_quote;
+		} else if (!in_quote && data[pos] == '\n') {
+			return pos+1;
+		}
+	}
+	return len;
+}
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
@@ -94,6 +194,145 @@ M_bool M_table_load_csv(M_table_t *table, const char *data, size_t len, char del
 	return M_TRUE;
 }
 
+M_bool M_table_load_csv_parallel(M_table_t *table, const char *data, size_t len, char delim, char quote, M_uint32 flags, M_bool have_header, size_t num_workers, M_table_dispatch_t dispatch, void *thunk)
+{
+	M_table_csv_chunk_t    *chunks;
+	void                  **args;
+	M_csv_t                *csv;
+	M_uint64               *colids;
+	M_bool                 *colvalid;
+	M_bool                  any_valid = M_FALSE;
+	M_bool                  in_quote  = M_FALSE;
+	const char             *colname;
+	size_t                  num_chunks;
+	size_t                  num_args;
+	size_t                  num_cols;
+	size_t                  table_numcols;
+	size_t                  colidx;
+	size_t                  start;
+	size_t                  end;
+	size_t                  seg_len;
+	size_t                  i;
+	size_t                  j;
+
+	if (table == NULL)
+		return M_FALSE;
+
+	/* Nothing to load. */
+	if (M_str_isempty(data) || len == 0)
+		return M_TRUE;
+
+	num_chunks = M_MAX(num_workers, 1) * M_TABLE_CSV_CHUNKS_PER_WORKER;
+	num_chunks = M_MIN(num_chunks, len / M_TABLE_CSV_CHUNK_MIN);
+	if (dispatch == NULL || num_chunks <= 1)
+		return M_table_load_csv(table, data, len, delim, quote, flags, have_header);
+
+	/* The first row gives the number of columns and the header. */
+	end = M_table_csv_row_boundary(data, len, 0, quote, M_FALSE);
+	csv = M_csv_parse(data, end, delim, quote, flags);
+	if (csv == NULL)
+		return M_FALSE;
+	num_cols = M_csv_raw_num_cols(csv);
+
+	/* Ensure we have all the header or enough columns. */
+	if (have_header) {
+		for (i=0; i<num_cols; i++) {
+			colname = M_csv_get_header(csv, i);
+			if (!M_table_column_idx(table, colname, NULL)) {
+				M_table_column_insert(table, colname);
+			}
+		}
+	} else {
+		table_numcols = M_table_column_count(table);
+		for (i=num_cols; i<table_numcols; i++) {
+			M_table_column_insert(table, NULL);
+		}
+	}
+
+	/* Columns are resolved once instead of for every cell. */
+	colids   = M_malloc_zero(sizeof(*colids) * num_cols);
+	colvalid = M_malloc_zero(sizeof(*colvalid) * num_cols);
+	for (i=0; i<num_cols; i++) {
+		if (have_header) {
+			colvalid[i] = M_table_column_idx(table, M_csv_get_header(csv, i), &colidx);
+		} else {
+			colidx      = i;
+			colvalid[i] = i < M_table_column_count(table) ? M_TRUE : M_FALSE;
+		}
+		if (colvalid[i]) {
+			colids[i] = M_table_column_id_at(table, colidx);
+			any_valid = M_TRUE;
+		}
+	}
+	M_csv_destroy(csv);
+
+	chunks  = M_malloc_zero(sizeof(*chunks) * num_chunks);
+	args    = M_malloc(sizeof(*args) * num_chunks);
+	seg_len = len / num_chunks;
+
+	/* Whether an even split lands in a quote depends on the number of quotes
+	 * before it. Count them for each segment in parallel. */
+	for (i=0; i<num_chunks; i++) {
+		chunks[i].data  = data + (i * seg_len);
+		chunks[i].len   = i == num_chunks-1 ? len - (i * seg_len) : seg_len;
+		chunks[i].quote = quote;
+		args[i]         = &chunks[i];
+	}
+	dispatch(M_table_csv_count_task, args, num_chunks, thunk);
+
+	/* Move each split forward to the start of the next row. A split that ends
+	 * up behind the previous one, because a quoted cell spans segments, leaves
+	 * an empty chunk. */
+	start = 0;
+	for (i=0; i<num_chunks; i++) {
+		if (i == num_chunks-1) {
+			end = len;
+		} else {
+			if (chunks[i].num_quotes % 2 == 1)
+				in_quote = !in_quote;
+			end = (i+1) * seg_len;
+			if (end <= start) {
+				end = start;
+			} else {
+				end = M_table_csv_row_boundary(data, len, end, quote, in_quote);
+			}
+		}
+
+		chunks[i].data       = data + start;
+		chunks[i].len        = end - start;
+		chunks[i].delim      = delim;
+		chunks[i].flags      = flags;
+		chunks[i].num_cols   = num_cols;
+		chunks[i].colids     = colids;
+		chunks[i].colvalid   = colvalid;
+		chunks[i].any_valid  = any_valid;
+		chunks[i].skip_first = (i == 0 && have_header) ? M_TRUE : M_FALSE;
+		start                = end;
+	}
+
+	num_args = 0;
+	for (i=0; i<num_chunks; i++) {
+		if (chunks[i].len != 0) {
+			args[num_args++] = &chunks[i];
+		}
+	}
+	dispatch(M_table_csv_parse_task, args, num_args, thunk);
+
+	/* Rows are added in chunk order to keep the order of the data. */
+	for (i=0; i<num_chunks; i++) {
+		for (j=0; j<chunks[i].num_rows; j++) {
+			M_table_row_insert_data(table, chunks[i].rows[j]);
+		}
+		M_free(chunks[i].rows);
+	}
+
+	M_free(colvalid);
+	M_free(colids);
+	M_free(args);
+	M_free(chunks);
+	return M_TRUE;
+}
+
 char *M_table_write_csv(const M_table_t *table, char delim, char quote, M_bool write_header)
 {
 	M_buf_t    *buf;
@@ -27,12 +27,14 @@
 #include <mstdlib/mstdlib_formats.h>
 #include "m_defs_int.h"
 #include "xml/m_xml_entities.h"
+#include "xml/m_xml_int.h"
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 struct M_xml_node {
 	M_xml_node_type_t      type;       /*!< Type of node. */
 	M_xml_node_t          *parent;     /*!< Parent this node belongs to. */
+	M_arena_t             *arena;      /*!< Arena the node and its strings are allocated from. May be NULL. */
 
 	union {
 		struct {
@@ -142,11 +144,27 @@ static char **M_xml_get_tag_data(const M_xml_node_t *node)
 	return NULL;
 }
 
+static char *M_xml_node_strdup(const M_xml_node_t *node, const char *s)
+{
+	if (node->arena != NULL)
+		return M_arena_strdup(node->arena, s);
+	return M_strdup(s);
+}
+
+static void M_xml_node_strfree(const M_xml_node_t *node, char *s)
+{
+	/* Arena strings are released with the arena. */
+	if (node->arena != NULL)
+		return;
+	M_free(s);
+}
+
 static void M_xml_node_destroy_int(M_xml_node_t *node)
 {
 	M_xml_node_type_t type;
 
-	if (node == NULL)
+	/* Arena nodes, their children and their containers are released with the arena. */
+	if (node == NULL || node->arena != NULL)
 		return;
 
 	type = M_xml_node_type(node);
@@ -157,23 +175,23 @@ static void M_xml_node_destroy_int(M_xml_node_t *node)
 			M_list_destroy(node->d.doc.children, M_TRUE);
 			break;
 		case M_XML_NODE_TYPE_ELEMENT:
-			M_free(node->d.element.name);
+			M_xml_node_strfree(node, node->d.element.name);
 			M_list_destroy(node->d.element.children, M_TRUE);
 			M_hash_dict_destroy(node->d.element.attributes);
 			break;
 		case M_XML_NODE_TYPE_PROCESSING_INSTRUCTION:
-			M_free(node->d.processing_instruction.name);
+			M_xml_node_strfree(node, node->d.processing_instruction.name);
 			M_hash_dict_destroy(node->d.processing_instruction.attributes);
 			break;
 		case M_XML_NODE_TYPE_DECLARATION:
-			M_free(node->d.declaration.name);
-			M_free(node->d.declaration.tag_data);
+			M_xml_node_strfree(node, node->d.declaration.name);
+			M_xml_node_strfree(node, node->d.declaration.tag_data);
 			break;
 		case M_XML_NODE_TYPE_TEXT:
-			M_free(node->d.text.text);
+			M_xml_node_strfree(node, node->d.text.text);
 			break;
 		case M_XML_NODE_TYPE_COMMENT:
-			M_free(node->d.comment.tag_data);
+			M_xml_node_strfree(node, node->d.comment.tag_data);
 			break;
 
 	}
@@ -187,8 +205,24 @@ static void M_xml_node_destroy_vp(void *node)
 	M_xml_node_destroy_int(node);
 }
 
-/*! Create an empty node of a given type. */
-static M_xml_node_t *M_xml_node_create(M_xml_node_type_t type, M_xml_node_t *parent)
+static M_list_t *M_xml_node_create_children(const M_xml_node_t *node, const struct M_list_callbacks *callbacks)
+{
+	if (node->arena != NULL)
+		return M_list_create_arena(node->arena, callbacks, M_LIST_NONE);
+	return M_list_create(callbacks, M_LIST_NONE);
+}
+
+static M_hash_dict_t *M_xml_node_create_attributes(const M_xml_node_t *node)
+{
+	if (node->arena != NULL)
+		return M_hash_dict_create_arena(node->arena, 4, 75, M_HASH_DICT_KEYS_ORDERED|M_HASH_DICT_CASECMP);
+	return M_hash_dict_create(4, 75, M_HASH_DICT_KEYS_ORDERED|M_HASH_DICT_CASECMP);
+}
+
+/*! Create an empty node of a given type.
+ *
+ * Nodes created with a parent are allocated from the parent's arena. */
+static M_xml_node_t *M_xml_node_create_arena(M_xml_node_type_t type, M_xml_node_t *parent, M_arena_t *arena)
 {
 	M_xml_node_t            *node;
 	struct M_list_callbacks  list_callbacks;
@@ -207,26 +241,35 @@ static M_xml_node_t *M_xml_node_create(M_xml_node_type_t type, M_xml_node_t *par
 	M_mem_set(&list_callbacks, 0, sizeof(list_callbacks));
 	list_callbacks.value_free = M_xml_node_destroy_vp;
 
-	node       = M_malloc_zero(sizeof(*node));
-	node->type = type;
+	if (parent != NULL)
+		arena = parent->arena;
+
+	if (arena != NULL) {
+		node = M_arena_alloc_zero(arena, sizeof(*node));
+	} else {
+		node = M_malloc_zero(sizeof(*node));
+	}
+	node->type  = type;
+	node->arena = arena;
 
 	switch (type) {
 		case M_XML_NODE_TYPE_DOC:
-			node->d.doc.children = M_list_create(&list_callbacks, M_LIST_NONE);
+			node->d.doc.children = M_xml_node_create_children(node, &list_callbacks);
 			break;
 		case M_XML_NODE_TYPE_ELEMENT:
-			node->d.element.children   = M_list_create(&list_callbacks, M_LIST_NONE);
-			node->d.element.attributes = M_hash_dict_create(4, 75, M_HASH_DICT_KEYS_ORDERED|M_HASH_DICT_CASECMP);
+			node->d.element.children   = M_xml_node_create_children(node, &list_callbacks);
+			node->d.element.attributes = M_xml_node_create_attributes(node);
 			break;
 		case M_XML_NODE_TYPE_PROCESSING_INSTRUCTION:
-			node->d.processing_instruction.attributes = M_hash_dict_create(4, 75, M_HASH_DICT_KEYS_ORDERED|M_HASH_DICT_CASECMP);
+			node->d.processing_instruction.attributes = M_xml_node_create_attributes(node);
 			break;
 		case M_XML_NODE_TYPE_DECLARATION:
 		case M_XML_NODE_TYPE_TEXT:
 		case M_XML_NODE_TYPE_COMMENT:
 			break;
 		default:
-			M_free(node);
+			node->type = M_XML_NODE_TYPE_UNKNOWN;
+			M_xml_node_destroy_int(node);
 			return NULL;
 	}
 
@@ -240,6 +283,16 @@ static M_xml_node_t *M_xml_node_create(M_xml_node_type_t type, M_xml_node_t *par
 	return node;
 }
 
+static M_xml_node_t *M_xml_node_create(M_xml_node_type_t type, M_xml_node_t *parent)
+{
+	return M_xml_node_create_arena(type, parent, NULL);
+}
+
+M_xml_node_t *M_xml_create_doc_arena(M_arena_t *arena)
+{
+	return M_xml_node_create_arena(M_XML_NODE_TYPE_DOC, NULL, arena);
+}
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 M_xml_node_t *M_xml_create_doc(void)
@@ -468,7 +521,8 @@ M_bool M_xml_node_insert_node_at(M_xml_node_t *parent, M_xml_node_t *child, size
 {
 	M_list_t *children;
 
-	if (parent == NULL || child == NULL || M_xml_node_type(child) == M_XML_NODE_TYPE_DOC || M_xml_node_parent(child) != NULL)
+	/* Arena and non-arena nodes can't be mixed, they'd either leak or dangle. */
+	if (parent == NULL || child == NULL || M_xml_node_type(child) == M_XML_NODE_TYPE_DOC || M_xml_node_parent(child) != NULL || child->arena != parent->arena)
 		return M_FALSE;
 
 	children = M_xml_get_childen(parent);
@@ -557,8 +611,8 @@ M_bool M_xml_node_set_name(M_xml_node_t *node, const char *name)
 
 	/* XXX: Validate the name is valid format. */
 
-	M_free(*node_name);
-	*node_name = M_strdup(name);
+	M_xml_node_strfree(node, *node_name);
+	*node_name = M_xml_node_strdup(node, name);
 
 	return M_TRUE;
 }
@@ -596,8 +650,8 @@ M_bool M_xml_node_set_text(M_xml_node_t *node, const char *text, size_t max_len)
 		M_free(temp);
 	}
 
-	M_free(node->d.text.text);
-	node->d.text.text = M_strdup(text);
+	M_xml_node_strfree(node, node->d.text.text);
+	node->d.text.text = M_xml_node_strdup(node, text);
 
 	return M_TRUE;
 }
@@ -623,8 +677,8 @@ M_bool M_xml_node_set_tag_data(M_xml_node_t *node, const char *data)
 	if (tag_data == NULL)
 		return M_FALSE;
 	
-	M_free(*tag_data);
-	*tag_data = M_strdup(data);
+	M_xml_node_strfree(node, *tag_data);
+	*tag_data = M_xml_node_strdup(node, data);
 
 	return M_TRUE;
 }
@@ -0,0 +1,576 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2026 Monetra Technologies, LLC.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "m_config.h"
+
+#include <mstdlib/mstdlib.h>
+#include <mstdlib/mstdlib_formats.h>
+#include "xml/m_xml_entities.h"
+#include "xml/m_xml_int.h"
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+struct M_xml_pull {
+	M_parser_t          *parser;
+	M_uint32             flags;
+
+	M_xml_pull_token_t   token;
+	M_xml_error_t        error;
+	size_t               error_pos;
+	size_t               offset;         /* Bytes consumed from the parser. */
+
+	size_t               scan_len;       /* Bytes of the next token already scanned without finding its end. */
+	int                  scan_quote;     /* Quote the scan stopped in. */
+
+	M_buf_t             *names;          /* Names of open elements, NULL terminated one after another. */
+	size_t              *name_offsets;
+	size_t               depth;
+	size_t               stack_size;
+	M_bool               root_closed;
+	M_bool               pending_end;    /* Empty element was returned, its end is next. */
+	M_bool               skipping;
+	size_t               skip_depth;     /* Depth of the element being skipped. */
+
+	char                *name;
+	char                *text;
+	size_t               text_len;
+	char               **attr_keys;
+	char               **attr_vals;
+	size_t               num_attrs;
+	size_t               attr_size;
+};
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static void M_xml_pull_clear_token(M_xml_pull_t *pull)
+{
+	size_t i;
+
+	for (i=0; i<pull->num_attrs; i++) {
+		M_free(pull->attr_keys[i]);
+		M_free(pull->attr_vals[i]);
+	}
+	pull->num_attrs = 0;
+
+	M_free(pull->name);
+	pull->name = NULL;
+	M_free(pull->text);
+	pull->text     = NULL;
+	pull->text_len = 0;
+}
+
+static M_xml_pull_token_t M_xml_pull_set_error(M_xml_pull_t *pull, M_xml_error_t error)
+{
+	pull->error     = error;
+	pull->error_pos = pull->offset;
+	pull->token     = M_XML_PULL_ERROR;
+	return pull->token;
+}
+
+static void M_xml_pull_consume(M_xml_pull_t *pull, size_t len)
+{
+	M_parser_consume(pull->parser, len);
+	pull->offset     += len;
+	pull->scan_len    = 0;
+	pull->scan_quote  = 0;
+}
+
+static const char *M_xml_pull_top_name(const M_xml_pull_t *pull)
+{
+	return M_buf_peek(pull->names) + pull->name_offsets[pull->depth-1];
+}
+
+static void M_xml_pull_push(M_xml_pull_t *pull, const char *name)
+{
+	if (pull->depth == pull->stack_size) {
+		pull->stack_size   = pull->stack_size == 0 ? 16 : pull->stack_size * 2;
+		pull->name_offsets = M_realloc(pull->name_offsets, sizeof(*pull->name_offsets) * pull->stack_size);
+	}
+	pull->name_offsets[pull->depth++] = M_buf_len(pull->names);
+	M_buf_add_str(pull->names, name);
+	M_buf_add_byte(pull->names, '\0');
+}
+
+static void M_xml_pull_pop(M_xml_pull_t *pull)
+{
+	pull->depth--;
+	M_buf_truncate(pull->names, pull->name_offsets[pull->depth]);
+	if (pull->depth == 0)
+		pull->root_closed = M_TRUE;
+}
+
+/* Same rules as inserting into a node. Keys are case insensitive. */
+static M_bool M_xml_pull_attribute_add(const char *key, const char *val, void *thunk)
+{
+	M_xml_pull_t *pull = thunk;
+	size_t        i;
+
+	if (M_str_isempty(key) || val == NULL)
+		return M_FALSE;
+
+	for (i=0; i<pull->num_attrs; i++) {
+		if (M_str_caseeq(pull->attr_keys[i], key)) {
+			return M_FALSE;
+		}
+	}
+
+	if (pull->num_attrs == pull->attr_size) {
+		pull->attr_size = pull->attr_size == 0 ? 8 : pull->attr_size * 2;
+		pull->attr_keys = M_realloc(pull->attr_keys, sizeof(*pull->attr_keys) * pull->attr_size);
+		pull->attr_vals = M_realloc(pull->attr_vals, sizeof(*pull->attr_vals) * pull->attr_size);
+	}
+	pull->attr_keys[pull->num_attrs] = M_strdup(key);
+	pull->attr_vals[pull->num_attrs] = M_strdup(val);
+	pull->num_attrs++;
+	return M_TRUE;
+}
+
+/* Check if the data could still turn into str with more data. */
+static M_bool M_xml_pull_is_partial(const char *data, size_t len, const char *str)
+{
+	size_t str_len = M_str_len(str);
+
+	return len < str_len && M_mem_eq(data, str, len);
+}
+
+/* Find the end of the tag data starts with. Uses the same rules as the tree
+ * reader but picks up where the last call left off so a large tag arriving
+ * in small pieces isn't scanned over and over.
+ *
+ * Returns the length of the tag or 0 if more data is needed. */
+static size_t M_xml_pull_tag_end(M_xml_pull_t *pull, const char *data, size_t len)
+{
+	const char *end_tag = NULL;
+	const char *ptr;
+	size_t      i = 1;
+	size_t      start;
+	int         quote;
+
+	while (i < len && M_chr_isspace(data[i]))
+		i++;
+	if (i == len)
+		return 0;
+
+	if (data[i] == '!') {
+		i++;
+		while (i < len && M_chr_isspace(data[i]))
+			i++;
+		if (M_xml_pull_is_partial(data+i, len-i, "--") || M_xml_pull_is_partial(data+i, len-i, "[CDATA["))
+			return 0;
+
+		if (len-i >= 2 && M_mem_eq(data+i, "--", 2)) {
+			end_tag  = "-->";
+			i       += 2;
+		} else if (len-i >= 7 && M_mem_eq(data+i, "[CDATA[", 7)) {
+			end_tag  = "]]>";
+			i       += 7;
+		}
+	}
+
+	if (end_tag != NULL) {
+		start = i;
+		if (pull->scan_len > start+2)
+			start = pull->scan_len-2;
+		ptr = M_mem_mem(data+start, len-start, end_tag, 3);
+		if (ptr == NULL) {
+			pull->scan_len = len;
+			return 0;
+		}
+		return (size_t)(ptr - data) + 3;
+	}
+
+	quote = 0;
+	if (pull->scan_len > i) {
+		i     = pull->scan_len;
+		quote = pull->scan_quote;
+	}
+	for (; i<len; i++) {
+		if (data[i] == '\'' || data[i] == '"') {
+			if (quote == 0) {
+				quote = data[i];
+			} else if (data[i] == quote) {
+				quote = 0;
+			}
+		} else if (data[i] == '>' && quote == 0) {
+			return i+1;
+		}
+	}
+
+	pull->scan_len   = len;
+	pull->scan_quote = quote;
+	return 0;
+}
+
+static M_xml_pull_token_t M_xml_pull_read_text(M_xml_pull_t *pull, const char *data, size_t len)
+{
+	const char *ptr;
+	size_t      text_len;
+
+	ptr = M_mem_chr(data+pull->scan_len, '<', len-pull->scan_len);
+	if (ptr == NULL) {
+		pull->scan_len = len;
+		return M_XML_PULL_NEED_MORE;
+	}
+
+	text_len = (size_t)(ptr - data);
+	if (!pull->skipping) {
+		/* Leading whitespace was already consumed. */
+		while (text_len > 0 && M_chr_isspace(data[text_len-1]))
+			text_len--;
+
+		if (!(pull->flags & M_XML_READER_DONT_DECODE_TEXT))
+			pull->text = M_xml_entities_decode(data, text_len);
+		if (pull->text == NULL)
+			pull->text = M_strdup_max(data, text_len);
+		pull->text_len = M_str_len(pull->text);
+	}
+
+	M_xml_pull_consume(pull, (size_t)(ptr - data));
+	return M_XML_PULL_TEXT;
+}
+
+static M_xml_pull_token_t M_xml_pull_read_tag(M_xml_pull_t *pull, const char *data, size_t len)
+{
+	M_xml_reader_tag_info_t  info;
+	M_xml_pull_token_t       token = M_XML_PULL_NEED_MORE;
+	M_xml_error_t            error = M_XML_ERROR_SUCCESS;
+	const char              *tag_data;
+	size_t                   tag_len;
+	M_bool                   name_eq;
+
+	tag_len = M_xml_pull_tag_end(pull, data, len);
+	if (tag_len == 0)
+		return M_XML_PULL_NEED_MORE;
+
+	if (!M_xml_read_tag_info(data, tag_len, &info, &error)) {
+		M_free(info.name);
+		return M_xml_pull_set_error(pull, error);
+	}
+	tag_data = data + info.processed_len;
+
+	switch (info.type) {
+		case M_XML_TAG_ELEMENT_START:
+		case M_XML_TAG_ELEMENT_EMPTY:
+		case M_XML_TAG_PROCESSING_INSTRUCTION:
+			if (!pull->skipping && !M_xml_read_attributes(tag_data, info.len_left, pull->flags, M_xml_pull_attribute_add, pull, &error)) {
+				M_free(info.name);
+				return M_xml_pull_set_error(pull, error);
+			}
+
+			if (info.type == M_XML_TAG_PROCESSING_INSTRUCTION) {
+				token = M_XML_PULL_PROCESSING_INSTRUCTION;
+				break;
+			}
+
+			M_xml_pull_push(pull, info.name);
+			if (info.type == M_XML_TAG_ELEMENT_EMPTY)
+				pull->pending_end = M_TRUE;
+			token = M_XML_PULL_START_ELEMENT;
+			break;
+
+		case M_XML_TAG_ELEMENT_END:
+			if (pull->depth == 0) {
+				M_free(info.name);
+				return M_xml_pull_set_error(pull, M_XML_ERROR_INELIGIBLE_FOR_CLOSE);
+			}
+			if (pull->flags & M_XML_READER_TAG_CASECMP) {
+				name_eq = M_str_caseeq(info.name, M_xml_pull_top_name(pull));
+			} else {
+				name_eq = M_str_eq(info.name, M_xml_pull_top_name(pull));
+			}
+			if (!name_eq) {
+				M_free(info.name);
+				return M_xml_pull_set_error(pull, M_XML_ERROR_UNEXPECTED_CLOSE);
+			}
+
+			M_xml_pull_pop(pull);
+			token = M_XML_PULL_END_ELEMENT;
+			break;
+
+		case M_XML_TAG_DECLARATION:
+			if (!pull->skipping) {
+				pull->text     = M_strdup_max(tag_data, info.len_left);
+				pull->text_len = M_str_len(pull->text);
+			}
+			token = M_XML_PULL_DECLARATION;
+			break;
+
+		case M_XML_TAG_CDATA:
+			/* Standard text data would be encoded, so we need to treat this as encoded */
+			if (!pull->skipping) {
+				if (!(pull->flags & M_XML_READER_DONT_DECODE_TEXT))
+					pull->text = M_xml_entities_decode(tag_data, info.len_left);
+				if (pull->text == NULL)
+					pull->text = M_strdup_max(tag_data, info.len_left);
+				pull->text_len = M_str_len(pull->text);
+			}
+			token = M_XML_PULL_TEXT;
+			break;
+
+		case M_XML_TAG_COMMENT:
+			if (!pull->skipping && !(pull->flags & M_XML_READER_IGNORE_COMMENTS)) {
+				pull->text     = M_strdup_trim_max(tag_data, info.len_left);
+				pull->text_len = M_str_len(pull->text);
+			}
+			token = M_XML_PULL_COMMENT;
+			break;
+	}
+
+	pull->name = info.name;
+	M_xml_pull_consume(pull, tag_len);
+	return token;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+M_xml_pull_t *M_xml_pull_create(M_parser_t *parser, M_uint32 flags)
+{
+	M_xml_pull_t *pull;
+
+	if (parser == NULL)
+		return NULL;
+
+	pull         = M_malloc_zero(sizeof(*pull));
+	pull->parser = parser;
+	pull->flags  = flags;
+	pull->names  = M_buf_create();
+	pull->token  = M_XML_PULL_NEED_MORE;
+	return pull;
+}
+
+void M_xml_pull_destroy(M_xml_pull_t *pull)
+{
+	if (pull == NULL)
+		return;
+
+	M_xml_pull_clear_token(pull);
+	M_free(pull->attr_keys);
+	M_free(pull->attr_vals);
+	M_free(pull->name_offsets);
+	M_buf_cancel(pull->names);
+	M_free(pull);
+}
+
+void M_xml_pull_reset(M_xml_pull_t *pull)
+{
+	if (pull == NULL)
+		return;
+
+	M_xml_pull_clear_token(pull);
+	M_buf_truncate(pull->names, 0);
+	pull->token       = M_XML_PULL_NEED_MORE;
+	pull->error       = M_XML_ERROR_SUCCESS;
+	pull->error_pos   = 0;
+	pull->offset      = 0;
+	pull->scan_len    = 0;
+	pull->scan_quote  = 0;
+	pull->depth       = 0;
+	pull->root_closed = M_FALSE;
+	pull->pending_end = M_FALSE;
+	pull->skipping    = M_FALSE;
+	pull->skip_depth  = 0;
+}
+
+M_xml_pull_token_t M_xml_pull_next(M_xml_pull_t *pull)
+{
+	const char         *data;
+	size_t              len;
+	size_t              i;
+	M_xml_pull_token_t  token;
+
+	if (pull == NULL)
+		return M_XML_PULL_ERROR;
+
+	if (pull->token == M_XML_PULL_ERROR || pull->token == M_XML_PULL_END_DOCUMENT)
+		return pull->token;
+
+	/* A token that needed more data didn't set anything so there is nothing to clear. */
+	if (pull->token != M_XML_PULL_NEED_MORE) {
+		if (pull->pending_end) {
+			/* The name is the same for the end of an empty element. */
+			pull->pending_end = M_FALSE;
+			pull->skipping    = M_FALSE;
+			for (i=0; i<pull->num_attrs; i++) {
+				M_free(pull->attr_keys[i]);
+				M_free(pull->attr_vals[i]);
+			}
+			pull->num_attrs = 0;
+			M_xml_pull_pop(pull);
+			pull->token = M_XML_PULL_END_ELEMENT;
+			return pull->token;
+		}
+		M_xml_pull_clear_token(pull);
+	}
+
+	while (1) {
+		if (pull->root_closed) {
+			pull->token = M_XML_PULL_END_DOCUMENT;
+			return pull->token;
+		}
+
+		data = (const char *)M_parser_peek(pull->parser);
+		len  = M_parser_len(pull->parser);
+
+		/* Whitespace between tokens is never part of a token. */
+		for (i=0; i<len && M_chr_isspace(data[i]); i++)
+			;
+		if (i > 0) {
+			M_xml_pull_consume(pull, i);
+			data += i;
+			len  -= i;
+		}
+		if (len == 0) {
+			pull->token = M_XML_PULL_NEED_MORE;
+			return pull->token;
+		}
+
+		if (*data == '<') {
+			token = M_xml_pull_read_tag(pull, data, len);
+		} else {
+			token = M_xml_pull_read_text(pull, data, len);
+		}
+
+		if (token == M_XML_PULL_NEED_MORE || token == M_XML_PULL_ERROR) {
+			pull->token = token;
+			return token;
+		}
+
+		if (pull->skipping) {
+			/* The end of the skipped element is returned. */
+			if (token == M_XML_PULL_END_ELEMENT && pull->depth < pull->skip_depth) {
+				pull->skipping = M_FALSE;
+				pull->token    = token;
+				return token;
+			}
+			if (pull->pending_end) {
+				pull->pending_end = M_FALSE;
+				M_xml_pull_pop(pull);
+			}
+			M_xml_pull_clear_token(pull);
+			continue;
+		}
+
+		if (token == M_XML_PULL_COMMENT && pull->flags & M_XML_READER_IGNORE_COMMENTS) {
+			M_xml_pull_clear_token(pull);
+			continue;
+		}
+
+		pull->token = token;
+		return token;
+	}
+}
+
+M_bool M_xml_pull_skip(M_xml_pull_t *pull)
+{
+	if (pull == NULL || pull->token != M_XML_PULL_START_ELEMENT)
+		return M_FALSE;
+
+	/* An empty element has nothing to skip. Its end is next either way. */
+	if (pull->pending_end)
+		return M_TRUE;
+
+	pull->skipping   = M_TRUE;
+	pull->skip_depth = pull->depth;
+	return M_TRUE;
+}
+
+M_xml_pull_token_t M_xml_pull_token(const M_xml_pull_t *pull)
+{
+	if (pull == NULL)
+		return M_XML_PULL_ERROR;
+	return pull->token;
+}
+
+size_t M_xml_pull_depth(const M_xml_pull_t *pull)
+{
+	if (pull == NULL)
+		return 0;
+	return pull->depth;
+}
+
+const char *M_xml_pull_name(const M_xml_pull_t *pull)
+{
+	if (pull == NULL)
+		return NULL;
+	return pull->name;
+}
+
+const char *M_xml_pull_text(const M_xml_pull_t *pull, size_t *len)
+{
+	if (len != NULL)
+		*len = 0;
+
+	if (pull == NULL)
+		return NULL;
+
+	if (len != NULL)
+		*len = pull->text_len;
+	return pull->text;
+}
+
+size_t M_xml_pull_num_attributes(const M_xml_pull_t *pull)
+{
+	if (pull == NULL)
+		return 0;
+	return pull->num_attrs;
+}
+
+M_bool M_xml_pull_attribute(const M_xml_pull_t *pull, size_t idx, const char **key, const char **val)
+{
+	if (pull == NULL || idx >= pull->num_attrs)
+		return M_FALSE;
+
+	if (key != NULL)
+		*key = pull->attr_keys[idx];
+	if (val != NULL)
+		*val = pull->attr_vals[idx];
+	return M_TRUE;
+}
+
+const char *M_xml_pull_attribute_value(const M_xml_pull_t *pull, const char *key)
+{
+	size_t i;
+
+	if (pull == NULL || key == NULL)
+		return NULL;
+
+	for (i=0; i<pull->num_attrs; i++) {
+		if (M_str_caseeq(pull->attr_keys[i], key)) {
+			return pull->attr_vals[i];
+		}
+	}
+	return NULL;
+}
+
+M_xml_error_t M_xml_pull_error(const M_xml_pull_t *pull, size_t *error_pos)
+{
+	if (error_pos != NULL)
+		*error_pos = 0;
+
+	if (pull == NULL)
+		return M_XML_ERROR_MISUSE;
+
+	if (error_pos != NULL)
+		*error_pos = pull->error_pos;
+	return pull->error;
+}
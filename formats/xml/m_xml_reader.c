@@ -26,27 +26,7 @@
 #include <mstdlib/mstdlib.h>
 #include <mstdlib/mstdlib_formats.h>
 #include "xml/m_xml_entities.h"
-
-/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
-
-/*! Identify the various tags we can parse */
-typedef enum {
-	M_XML_TAG_PROCESSING_INSTRUCTION = 1,
-	M_XML_TAG_COMMENT                = 2,
-	M_XML_TAG_ELEMENT_START          = 3,
-	M_XML_TAG_ELEMENT_END            = 4,
-	M_XML_TAG_ELEMENT_EMPTY          = 5,
-	M_XML_TAG_CDATA                  = 6,
-	M_XML_TAG_DECLARATION            = 7
-} M_xml_reader_tags_t;
-
-typedef struct {
-	char                *name;          /*!< Named tag                            */
-	M_xml_reader_tags_t  type;          /*!< Type of XML tag being processed      */
-	size_t               processed_len; /*!< Number of bytes processed            */
-	size_t               tag_len;       /*!< Number of bytes in total tag size    */
-	size_t               len_left;      /*!< Number of bytes left to be processed */
-} M_xml_reader_tag_info_t;
+#include "xml/m_xml_int.h"
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
@@ -196,7 +176,7 @@ static char *M_xml_read_name(const char *data, size_t data_len)
  *  \param[in]  error_len Length of error buffer
  *  \returns M_TRUE on success, M_FALSE on failure
  */
-static M_bool M_xml_read_tag_info(const char *data, size_t data_len, M_xml_reader_tag_info_t *info, M_xml_error_t *error)
+M_bool M_xml_read_tag_info(const char *data, size_t data_len, M_xml_reader_tag_info_t *info, M_xml_error_t *error)
 {
 	const char *ptr;
 	size_t      ptr_len;
@@ -434,13 +414,7 @@ static char *M_xml_read_strip_surrounding_quotes(const char *data)
 }
 
 
-/*! Parse attributes into key/value pairs
- *  \param[in] node     Node to add attributes
- *  \param[in] data     Data to parse
- *  \param[in] data_len Length of data to parse
- *  \returns M_TRUE on success, M_FALSE on failure
- */
-static M_bool M_xml_read_tag_attributes(M_xml_node_t *node, const char *data, size_t data_len, M_uint32 flags, M_xml_error_t *error)
+M_bool M_xml_read_attributes(const char *data, size_t data_len, M_uint32 flags, M_xml_read_attribute_func func, void *thunk, M_xml_error_t *error)
 {
 	char       *sdata;
 	char      **kvdata;
@@ -480,7 +454,7 @@ static M_bool M_xml_read_tag_attributes(M_xml_node_t *node, const char *data, si
 			if (!(flags & M_XML_READER_DONT_DECODE_ATTRS)) {
 				decoded_val = M_xml_attribute_decode(val, M_str_len(val));
 			}
-			if (!M_xml_node_insert_attribute(node, key, decoded_val!=NULL?decoded_val:val, 0, M_FALSE)) {
+			if (!func(key, decoded_val!=NULL?decoded_val:val, thunk)) {
 				*error = M_XML_ERROR_ATTR_EXISTS;
 				M_free(keytemp);
 				M_free(valtemp);
@@ -504,6 +478,22 @@ static M_bool M_xml_read_tag_attributes(M_xml_node_t *node, const char *data, si
 	return M_TRUE;
 }
 
+static M_bool M_xml_read_tag_attribute_insert(const char *key, const char *val, void *thunk)
+{
+	return M_xml_node_insert_attribute(thunk, key, val, 0, M_FALSE);
+}
+
+/*! Parse attributes into key/value pairs
+ *  \param[in] node     Node to add attributes
+ *  \param[in] data     Data to parse
+ *  \param[in] data_len Length of data to parse
+ *  \returns M_TRUE on success, M_FALSE on failure
+ */
+static M_bool M_xml_read_tag_attributes(M_xml_node_t *node, const char *data, size_t data_len, M_uint32 flags, M_xml_error_t *error)
+{
+	return M_xml_read_attributes(data, data_len, flags, M_xml_read_tag_attribute_insert, node, error);
+}
+
 /*! Handle logic for tag encountered
  * \return M_TRUE on success, M_FALSE on failure
  */
@@ -530,11 +520,15 @@ static M_bool M_xml_read_tag_process(M_xml_node_t **node, const char *data, size
 			}
 
 			if (info->type == M_XML_TAG_DECLARATION) {
-				if (!M_xml_node_set_tag_data(new_node, data)) {
+				/* data isn't terminated at the end of the tag. */
+				text = M_strdup_max(data, data_len);
+				if (!M_xml_node_set_tag_data(new_node, text)) {
 					*error = M_XML_ERROR_GENERIC;
+					M_free(text);
 					M_xml_node_destroy(new_node);
 					return M_FALSE;
 				}
+				M_free(text);
 			} else {
 				if (!M_xml_read_tag_attributes(new_node, data, data_len, flags, error)) {
 					M_xml_node_destroy(new_node);
@@ -572,7 +566,10 @@ static M_bool M_xml_read_tag_process(M_xml_node_t **node, const char *data, size
 			if (!(flags & M_XML_READER_DONT_DECODE_TEXT)) {
 				text = M_xml_entities_decode(data, data_len);
 			}
-			new_node = M_xml_create_text(text!=NULL?text:data, 0, *node);
+			/* data isn't terminated at the end of the tag. */
+			if (text == NULL)
+				text = M_strdup_max(data, data_len);
+			new_node = M_xml_create_text(text, 0, *node);
 			M_free(text);
 			if (new_node == NULL) {
 				*error = M_XML_ERROR_GENERIC;
@@ -706,7 +703,7 @@ static M_bool M_xml_doc_has_element(M_xml_node_t *doc)
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-M_xml_node_t *M_xml_read(const char *data, size_t data_len, M_uint32 flags, size_t *processed_len, M_xml_error_t *error, size_t *error_line, size_t *error_pos)
+M_xml_node_t *M_xml_read_arena(M_arena_t *arena, const char *data, size_t data_len, M_uint32 flags, size_t *processed_len, M_xml_error_t *error, size_t *error_line, size_t *error_pos)
 {
 	M_xml_node_t  *doc;
 	M_xml_node_t  *curr_level;
@@ -731,7 +728,7 @@ M_xml_node_t *M_xml_read(const char *data, size_t data_len, M_uint32 flags, size
 		return NULL;
 	}
 
-	doc        = M_xml_create_doc();
+	doc        = M_xml_create_doc_arena(arena);
 	curr_level = doc;
 
 	for (i=0; i<data_len; i++) {
@@ -797,6 +794,11 @@ M_xml_node_t *M_xml_read(const char *data, size_t data_len, M_uint32 flags, size
 	return doc;
 }
 
+M_xml_node_t *M_xml_read(const char *data, size_t data_len, M_uint32 flags, size_t *processed_len, M_xml_error_t *error, size_t *error_line, size_t *error_pos)
+{
+	return M_xml_read_arena(NULL, data, data_len, flags, processed_len, error, error_line, error_pos);
+}
+
 M_xml_node_t *M_xml_read_file(const char *path, M_uint32 flags, size_t max_read, M_xml_error_t *error, size_t *error_line, size_t *error_pos)
 {
 	char         *buf;
@@ -20,7 +20,6 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
  * THE SOFTWARE.
  */
-
 #include "m_config.h"
 
 #include <mstdlib/mstdlib.h>
@@ -30,6 +29,8 @@
 
 typedef enum {
 	M_XML_XPATH_MATCH_TYPE_INVALID = 0,
+	M_XML_XPATH_MATCH_TYPE_DESCEND,
+	M_XML_XPATH_MATCH_TYPE_PARENT,
 	M_XML_XPATH_MATCH_TYPE_TAG,
 	M_XML_XPATH_MATCH_TYPE_ATTR_ANY,
 	M_XML_XPATH_MATCH_TYPE_ATTR_HAS,
@@ -46,9 +47,48 @@ typedef enum {
 	M_XML_XPATH_POS_EQUALITY_GT,
 } M_xml_xpath_pos_equality_t;
 
+/* A segment of the expression with everything that doesn't depend on the
+ * document already parsed out of it. */
+typedef struct {
+	M_xml_xpath_match_type_t    type;
+	char                       *name;     /*!< Tag name for TAG. Attribute name for ATTR_HAS and ATTR_VAL. */
+	char                       *val;      /*!< Attribute value for ATTR_VAL. */
+	M_bool                      any;      /*!< TAG matches all elements ("*"). */
+	M_bool                      skip_ns;  /*!< TAG ignores the namespace on the element ("*:tag"). */
+	M_xml_xpath_pos_equality_t  equality; /*!< POS modifier. */
+	M_int64                     offset;   /*!< POS offset. Negative counts back from the last match. 0 is last(). */
+} M_xml_xpath_seg_t;
+
+struct M_xml_xpath {
+	M_xml_xpath_seg_t *segs;
+	size_t             num_segs;
+	M_bool             absolute; /*!< Expression started with '/' and is evaluated from the doc node. */
+	M_uint32           flags;    /*!< M_xml_reader_flags_t. */
+};
+
+typedef struct {
+	M_xml_node_t **nodes;
+	size_t         num;
+	size_t         size;
+} M_xml_xpath_index_nodes_t;
+
+struct M_xml_xpath_index {
+	M_xml_node_t   *root;
+	M_hash_strvp_t *names; /*!< Case insensitive tag name to M_xml_xpath_index_nodes_t of descendant elements in document order. */
+};
+
+/* State of a single evaluation. */
+typedef struct {
+	const M_xml_xpath_t        *xpath;
+	const M_xml_xpath_index_t  *index;
+	M_xml_node_t              **matches;
+	size_t                      num_matches;
+} M_xml_xpath_eval_t;
+
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
-static void M_xml_xpath_search(M_xml_node_t *node, M_list_str_t *segments, size_t seg_offset, M_uint32 flags, M_bool search_recursive, M_xml_node_t ***matches, size_t *num_matches);
+
+static void M_xml_xpath_search(M_xml_xpath_eval_t *eval, M_xml_node_t *node, size_t seg_offset, M_bool search_recursive);
 
 static M_xml_node_t *M_xml_node_find_doc(M_xml_node_t *node)
 {
@@ -57,10 +97,13 @@ static M_xml_node_t *M_xml_node_find_doc(M_xml_node_t *node)
 	return node;
 }
 
-static M_xml_xpath_match_type_t M_xml_xpath_search_segment_type(const char *seg)
+static M_xml_xpath_match_type_t M_xml_xpath_segment_type(const char *seg)
 {
-	if (seg == NULL || *seg == '\0')
-		return M_XML_XPATH_MATCH_TYPE_TAG;
+	if (seg == NULL || *seg == '\0' || M_str_eq(seg, "."))
+		return M_XML_XPATH_MATCH_TYPE_DESCEND;
+
+	if (M_str_eq(seg, ".."))
+		return M_XML_XPATH_MATCH_TYPE_PARENT;
 
 	if (*seg == '[') {
 		/* Invalid predicate. */
@@ -86,34 +129,78 @@ static M_xml_xpath_match_type_t M_xml_xpath_search_segment_type(const char *seg)
 	return M_XML_XPATH_MATCH_TYPE_TAG;
 }
 
-static M_bool M_xml_xpath_search_tag_eq(M_xml_node_t *node, const char *tag, M_uint32 flags)
+static M_bool M_xml_xpath_compile_tag(const char *seg, M_xml_xpath_seg_t *xseg)
 {
-	const char *name;
-	size_t      len;
-	char       *p;
+	if (M_str_len(seg) > 2 && M_str_eq_max(seg, "*:", 2)) {
+		seg           += 2;
+		xseg->skip_ns  = M_TRUE;
+	}
 
-	name = M_xml_node_name(node);
+	if (M_str_eq(seg, "*"))
+		xseg->any = M_TRUE;
 
-	len = M_str_len(tag);
-	if (len > 2 && M_str_eq_max(tag, "*:", 2)) {
-		tag += 2;
-		p = M_str_chr(name, ':');
-		if (p != NULL) {
-			name = p+1;
+	xseg->name = M_strdup(seg);
+	return M_TRUE;
+}
+
+static M_bool M_xml_xpath_compile_attr_has(const char *seg, M_xml_xpath_seg_t *xseg)
+{
+	/* Silence coverity. Shouldn't be possible, should get [@] at end*/
+	if (M_str_len(seg) < 3)
+		return M_FALSE;
+
+	/* Remove [@] from the attribute name we need to match on. */
+	xseg->name = M_strdup_max(seg+2, M_str_len(seg)-3);
+	return M_TRUE;
+}
+
+static M_bool M_xml_xpath_compile_attr_val(const char *seg, M_xml_xpath_seg_t *xseg)
+{
+	char    **parts;
+	M_buf_t  *buf;
+	char     *out;
+	size_t    num_parts = 0;
+	size_t    i;
+	size_t    start     = 0;
+	size_t    len;
+
+	parts = M_str_explode_str('=', seg, &num_parts);
+	if (parts == NULL || num_parts == 0 || M_str_len(parts[0]) < 2) {
+		M_str_explode_free(parts, num_parts);
+		return M_FALSE;
+	}
+
+	/* Get the attribute. */
+	xseg->name = M_strdup_max(parts[0]+2, M_str_len(parts[0])-2);
+
+	/* Get the attribute value by putting the parts after the separtor '=' together. */
+	buf = M_buf_create();
+	for (i=1; i<num_parts; i++) {
+		if (parts[i] == NULL || *(parts[i]) == '\0') {
+			continue;
 		}
+		M_buf_add_str(buf, parts[i]);
 	}
+	M_str_explode_free(parts, num_parts);
 
-	if (M_str_eq(tag, "*") ||
-		(flags & M_XML_READER_TAG_CASECMP && M_str_caseeq(tag, name)) ||
-		(!(flags & M_XML_READER_TAG_CASECMP) && M_str_eq(tag, name)))
-	{
-		return M_TRUE;
+	/* The value "should" be wrapped in '' and end with ]. We need to remove these extra characters. */
+	out = M_buf_finish_str(buf, &len);
+	if (*out == '\'' || *out == '"') {
+		start++;
+		len--;
+	}
+	while (len > 0 && (out[start+len-1] == '\'' || out[start+len-1] == '"' || out[start+len-1] == ']')) {
+		len--;
 	}
+	xseg->val = M_strdup_max(out+start, len);
+	M_free(out);
 
-	return M_FALSE;
+	return M_TRUE;
 }
 
-static M_bool M_xml_xpath_search_match_node_pos_offset(const char *val, size_t val_len, size_t array_len, size_t *out_pos, size_t *out_max)
+/* Parses everything about a position predicate that doesn't depend on the number of
+ * nodes it will be matched against. M_xml_xpath_pos_range fills in the rest. */
+static M_bool M_xml_xpath_compile_pos(const char *seg, M_xml_xpath_seg_t *xseg)
 {
 	M_buf_t                    *buf;
 	char                       *myval;
@@ -121,14 +208,19 @@ static M_bool M_xml_xpath_search_match_node_pos_offset(const char *val, size_t v
 	char                        sign;
 	M_xml_xpath_pos_equality_t  equality      = M_XML_XPATH_POS_EQUALITY_EQ;
 	M_int64                     offset        = 0;
+	size_t                      val_len;
 	const size_t                wlen_position = 10; /* M_str_len("position()"); */
 	const size_t                wlen_last     = 6; /* M_str_len("last()"); */
 	M_bool                      has_last      = M_FALSE;
 
-	*out_pos = 0;
-	*out_max = 1;
+	/* Silence coverity. Shouldn't be possible, should always have at least [] */
+	if (M_str_len(seg) < 2)
+		return M_FALSE;
 
-	myval = M_strdup_trim(val);
+	/* Strip off []. */
+	myval   = M_strdup_max(seg+1, M_str_len(seg)-2);
+	val_len = M_str_len(myval);
+	M_str_trim(myval);
 
 	/* Checking for position() and last() are really relaxed. These could
  	 * skip invalid data when it really should error. */
@@ -157,7 +249,7 @@ static M_bool M_xml_xpath_search_match_node_pos_offset(const char *val, size_t v
 			p++;
 			equality = M_XML_XPATH_POS_EQUALITY_GT;
 		} else if ((p = M_str_chr(myval, '=')) != NULL) {
-			/* '=' needs to come last but before else because 
+			/* '=' needs to come last but before else because
  			 * str_chr would match "<=" or ">=" too. */
 			p++;
 			equality = M_XML_XPATH_POS_EQUALITY_EQ;
@@ -189,9 +281,7 @@ static M_bool M_xml_xpath_search_match_node_pos_offset(const char *val, size_t v
 	if (M_str_isempty(myval)) {
 		/* If last was used we could have an empty value. In this case
  		 * the offset is the last offset. Otherwise it's an invalid expression. */
-		if (has_last) {
-			offset = (M_int64)array_len;
-		} else {
+		if (!has_last) {
 			M_free(myval);
 			return M_FALSE;
 		}
@@ -213,30 +303,181 @@ static M_bool M_xml_xpath_search_match_node_pos_offset(const char *val, size_t v
 			return M_FALSE;
 		}
 
-		if (offset < 0) {
-			/* Negative means index from the right instead of the left. */
-			if ((M_int64)array_len + offset <= 0) {
-				M_free(myval);
-				return M_FALSE;
-			}
-			offset = (M_int64)array_len + offset;
-		} else if (offset == 0) {
-			/* 0 off set is invalid because XPath offsets start at 1. */
+		/* 0 off set is invalid because XPath offsets start at 1. We have a positive
+ 		 * value and last is present. Can't index more than the last item. */
+		if (offset == 0 || (offset > 0 && has_last)) {
 			M_free(myval);
 			return M_FALSE;
-		} else {
-			/* We have a positive value and last is present.
- 			 * Can't index more than the last item. */
-			if (has_last) {
-				M_free(myval);
-				return M_FALSE;
-			}
 		}
 	}
 	M_free(myval);
 
+	xseg->equality = equality;
+	xseg->offset   = offset;
+	return M_TRUE;
+}
+
+static void M_xml_xpath_seg_clear(M_xml_xpath_seg_t *xseg)
+{
+	M_free(xseg->name);
+	M_free(xseg->val);
+	M_mem_set(xseg, 0, sizeof(*xseg));
+}
+
+/* An invalid segment never matches anything. */
+static void M_xml_xpath_compile_seg(const char *seg, M_xml_xpath_seg_t *xseg)
+{
+	M_bool ret = M_TRUE;
+
+	xseg->type = M_xml_xpath_segment_type(seg);
+	switch (xseg->type) {
+		case M_XML_XPATH_MATCH_TYPE_TAG:
+			ret = M_xml_xpath_compile_tag(seg, xseg);
+			break;
+		case M_XML_XPATH_MATCH_TYPE_ATTR_HAS:
+			ret = M_xml_xpath_compile_attr_has(seg, xseg);
+			break;
+		case M_XML_XPATH_MATCH_TYPE_ATTR_VAL:
+			ret = M_xml_xpath_compile_attr_val(seg, xseg);
+			break;
+		case M_XML_XPATH_MATCH_TYPE_POS:
+			ret = M_xml_xpath_compile_pos(seg, xseg);
+			break;
+		case M_XML_XPATH_MATCH_TYPE_DESCEND:
+		case M_XML_XPATH_MATCH_TYPE_PARENT:
+		case M_XML_XPATH_MATCH_TYPE_ATTR_ANY:
+		case M_XML_XPATH_MATCH_TYPE_TEXT:
+		case M_XML_XPATH_MATCH_TYPE_INVALID:
+			break;
+	}
+
+	if (!ret) {
+		M_xml_xpath_seg_clear(xseg);
+		xseg->type = M_XML_XPATH_MATCH_TYPE_INVALID;
+	}
+}
+
+/* Split the expression on '/' and then further split on '[' to pull out predicate filters. */
+static M_list_str_t *M_xml_xpath_segments(const char *search)
+{
+	char         **segments;
+	char         **pred_segments;
+	M_list_str_t  *seg_list;
+	M_buf_t       *buf;
+	char          *out;
+	size_t         num_segments      = 0;
+	size_t         num_pred_segments = 0;
+	size_t         i;
+	size_t         j;
+
+	segments = M_str_explode_str('/', search, &num_segments);
+	if (segments == NULL || num_segments == 0) {
+		/* Silence coverity, but most likely if num_segments is 0, segments is NULL right? */
+		M_str_explode_free(segments, num_segments);
+		return NULL;
+	}
+
+	seg_list = M_list_str_create(M_LIST_STR_NONE);
+	for (i=0; i<num_segments; i++) {
+		if (*(segments[i]) == '\0') {
+			M_list_str_insert(seg_list, "");
+			continue;
+		}
+
+		pred_segments = M_str_explode_str('[', segments[i], &num_pred_segments);
+		if (pred_segments == NULL || num_pred_segments == 0) {
+			M_str_explode_free(pred_segments, num_pred_segments);
+			continue;
+		}
+
+		for (j=0; j<num_pred_segments; j++) {
+			/* Empty means we found a '[', skip it. */
+			if (pred_segments[j] == NULL || *(pred_segments[j]) == '\0')
+				continue;
+
+			/* First one may not start with '['. We need to check if the segment is something like:
+			 * 'abc'/'abc[1]' vs '[1]'. */
+			if (j == 0 && *(segments[i]) != '[') {
+				M_list_str_insert(seg_list, pred_segments[j]);
+				continue;
+			}
+
+			/* Verify that our predicate ends with a ']'. If it doesn't then this is an invaild expression. */
+			if (pred_segments[j][M_str_len(pred_segments[j])-1] != ']') {
+				M_str_explode_free(pred_segments, num_pred_segments);
+				M_str_explode_free(segments, num_segments);
+				M_list_str_destroy(seg_list);
+				return NULL;
+			}
+
+			/* Put the '[' back on the front of the segment and add it to our list of segments. */
+			buf = M_buf_create();
+			M_buf_add_byte(buf, '[');
+			M_buf_add_str(buf, pred_segments[j]);
+			out = M_buf_finish_str(buf, NULL);
+			M_list_str_insert(seg_list, out);
+			M_free(out);
+		}
+		M_str_explode_free(pred_segments, num_pred_segments);
+	}
+	M_str_explode_free(segments, num_segments);
+
+	if (M_list_str_len(seg_list) == 0) {
+		M_list_str_destroy(seg_list);
+		return NULL;
+	}
+
+	return seg_list;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static M_bool M_xml_xpath_search_tag_eq(M_xml_node_t *node, const M_xml_xpath_seg_t *xseg, M_uint32 flags)
+{
+	const char *name;
+	char       *p;
+
+	if (xseg->any)
+		return M_TRUE;
+
+	name = M_xml_node_name(node);
+	if (xseg->skip_ns) {
+		p = M_str_chr(name, ':');
+		if (p != NULL) {
+			name = p+1;
+		}
+	}
+
+	if ((flags & M_XML_READER_TAG_CASECMP && M_str_caseeq(xseg->name, name)) ||
+		(!(flags & M_XML_READER_TAG_CASECMP) && M_str_eq(xseg->name, name)))
+	{
+		return M_TRUE;
+	}
+
+	return M_FALSE;
+}
+
+/* Determine the start and number of positions a position predicate matches given the number of matching nodes. */
+static M_bool M_xml_xpath_pos_range(const M_xml_xpath_seg_t *xseg, size_t array_len, size_t *out_pos, size_t *out_max)
+{
+	M_int64 offset = xseg->offset;
+
+	*out_pos = 0;
+	*out_max = 1;
+
+	if (offset == 0) {
+		/* last() without an offset. */
+		offset = (M_int64)array_len;
+	} else if (offset < 0) {
+		/* Negative means index from the right instead of the left. */
+		if ((M_int64)array_len + offset <= 0) {
+			return M_FALSE;
+		}
+		offset = (M_int64)array_len + offset;
+	}
+
 	/* Set the start and number of positions the expression can match. */
-	switch (equality) {
+	switch (xseg->equality) {
 		case M_XML_XPATH_POS_EQUALITY_EQ:
 			*out_pos = (size_t)offset;
 			break;
@@ -261,7 +502,7 @@ static M_bool M_xml_xpath_search_match_node_pos_offset(const char *val, size_t v
 	return M_TRUE;
 }
 
-static void M_xml_xpath_search_match_node_tag(const char *seg, M_xml_node_t *node, M_list_str_t *segments, size_t seg_offset, M_uint32 flags, M_bool search_recursive, M_xml_node_t ***matches, size_t *num_matches)
+static void M_xml_xpath_search_match_node_tag(M_xml_xpath_eval_t *eval, const M_xml_xpath_seg_t *xseg, M_xml_node_t *node, size_t seg_offset, M_bool search_recursive)
 {
 	M_xml_node_t *ptr;
 	size_t        num_children;
@@ -274,124 +515,31 @@ static void M_xml_xpath_search_match_node_tag(const char *seg, M_xml_node_t *nod
 		if (M_xml_node_type(ptr) != M_XML_NODE_TYPE_ELEMENT)
 			continue;
 
-		if (M_xml_xpath_search_tag_eq(ptr, seg, flags)) {
-			M_xml_xpath_search(ptr, segments, seg_offset+1, flags, M_FALSE, matches, num_matches);
+		if (M_xml_xpath_search_tag_eq(ptr, xseg, eval->xpath->flags)) {
+			M_xml_xpath_search(eval, ptr, seg_offset+1, M_FALSE);
 		}
 
 		/* This should NOT be an "else if" to the prior statement as there could legitimately be additional
 		 * matches at deeper layers, and we need to search those too */
 		if (search_recursive) {
-			M_xml_xpath_search(ptr, segments, seg_offset, flags, M_TRUE, matches, num_matches);
+			M_xml_xpath_search(eval, ptr, seg_offset, M_TRUE);
 		}
 	}
 }
 
-static void M_xml_xpath_search_match_node_attr_any(const char *seg, M_xml_node_t *node, M_list_str_t *segments, size_t seg_offset, M_uint32 flags, M_bool search_recursive, M_xml_node_t ***matches, size_t *num_matches)
-{
-	(void)seg;
-	(void)search_recursive;
-
-	if (M_hash_dict_num_keys(M_xml_node_attributes(node)) != 0) {
-		M_xml_xpath_search(node, segments, seg_offset+1, flags, M_FALSE, matches, num_matches);
-	}
-}
-
-static void M_xml_xpath_search_match_node_attr_has(const char *seg, M_xml_node_t *node, M_list_str_t *segments, size_t seg_offset, M_uint32 flags, M_bool search_recursive, M_xml_node_t ***matches, size_t *num_matches)
+static void M_xml_xpath_search_match_node_pos(M_xml_xpath_eval_t *eval, const M_xml_xpath_seg_t *xseg, M_xml_node_t *node, size_t seg_offset)
 {
-	char *attr;
-	
-	(void)search_recursive;
-
-	/* Silence coverity. Shouldn't be possible, should get [@] at end*/
-	if (M_str_len(seg) < 3)
-		return;
-
-	/* Remove [@] from the attribute name we need to match on. */
-	attr = M_strdup_max(seg+2, M_str_len(seg)-3);
-	if (M_xml_node_attribute(node, attr) != NULL) {
-		M_xml_xpath_search(node, segments, seg_offset+1, flags, M_FALSE, matches, num_matches);
-	}
-	M_free(attr);
-}
-
-static void M_xml_xpath_search_match_node_attr_val(const char *seg, M_xml_node_t *node, M_list_str_t *segments, size_t seg_offset, M_uint32 flags, M_bool search_recursive, M_xml_node_t ***matches, size_t *num_matches)
-{
-	char    **parts;
-	M_buf_t  *buf   = NULL;
-	char     *attr;
-	char     *val;
-	char     *out;
-	size_t    num_parts = 0;
-	size_t    i;
-	size_t    start = 0;
-	size_t    len;
-
-	(void)search_recursive;
-
-	parts = M_str_explode_str('=', seg, &num_parts);
-	if (parts == NULL || num_parts == 0 || M_str_len(parts[0]) < 2) {
-		M_str_explode_free(parts, num_parts);
-		return;
-	}
-
-	/* Get the attribute. */
-	attr = M_strdup_max(parts[0]+2, M_str_len(parts[0])-2);
-
-	/* If the attribute doesn't exist in the node then we can't match a value. A value of NULL/"" is
- 	 * not the same as the node not being present. */
-	if (M_xml_node_attribute(node, attr) == NULL) {
-		M_str_explode_free(parts, num_parts);
-		M_free(attr);
-		return;
-	}
-
-	/* Get the attribute value by putting the parts after the separtor '=' together. */
-	buf = M_buf_create();
-	for (i=1; i<num_parts; i++) {
-		if (parts[i] == NULL || *(parts[i]) == '\0') {
-			continue;
-		}
-		M_buf_add_str(buf, parts[i]);
-	}
-	M_str_explode_free(parts, num_parts);
-
-	/* The value "should" be wrapped in '' and end with ]. We need to remove these extra characters. */
-	out = M_buf_finish_str(buf, &len);
-	if (*out == '\'' || *out == '"') {
-		start++;
-		len--;
-	}
-	while (len > 0 && (out[start+len-1] == '\'' || out[start+len-1] == '"' || out[start+len-1] == ']')) {
-		len--;
-	}
-	val = M_strdup_max(out+start, len);
-	M_free(out);
-
-	/* Check if the node's value matches. */
-	if (M_str_eq(M_xml_node_attribute(node, attr), val)) {
-		M_xml_xpath_search(node, segments, seg_offset+1, flags, M_FALSE, matches, num_matches);
-	}
-
-	M_free(attr);
-	M_free(val);
-}
-
-static void M_xml_xpath_search_match_node_pos(const char *seg, M_xml_node_t *node, M_list_str_t *segments, size_t seg_offset, M_uint32 flags, M_bool search_recursive, M_xml_node_t ***matches, size_t *num_matches)
-{
-	M_xml_node_t             *parent;
-	M_xml_node_t             *ptr;
-	char                     *val;
-	const char               *last_seg;
-	M_xml_xpath_match_type_t  match_type;
-	M_xml_node_type_t         node_type;
-	size_t                    off_pos;
-	size_t                    off_max;
-	size_t                    nidx               = 0;
-	size_t                    num_children;
-	size_t                    num_children_elems = 0;
-	size_t                    i;
-
-	(void)search_recursive;
+	const M_xml_xpath_seg_t *last_seg;
+	M_xml_node_t            *parent;
+	M_xml_node_t            *ptr;
+	M_xml_node_type_t        node_type;
+	M_uint32                 flags              = eval->xpath->flags;
+	size_t                   off_pos;
+	size_t                   off_max;
+	size_t                   nidx               = 0;
+	size_t                   num_children;
+	size_t                   num_children_elems = 0;
+	size_t                   i;
 
 	if (seg_offset == 0)
 		return;
@@ -407,17 +555,16 @@ static void M_xml_xpath_search_match_node_pos(const char *seg, M_xml_node_t *nod
 		return;
 
 	/* Get the last segment and verify it's a tag. We need to match based on the tag name. */
-	last_seg   = M_list_str_at(segments, seg_offset-1);
-	match_type = M_xml_xpath_search_segment_type(last_seg);
-	if (match_type != M_XML_XPATH_MATCH_TYPE_TAG && match_type != M_XML_XPATH_MATCH_TYPE_TEXT)
+	last_seg = &eval->xpath->segs[seg_offset-1];
+	if (last_seg->type != M_XML_XPATH_MATCH_TYPE_TAG && last_seg->type != M_XML_XPATH_MATCH_TYPE_TEXT)
 		return;
 
 	/* Determine how many elements of tag name are in the parent. */
 	for (i=0; i<num_children; i++) {
 		ptr       = M_xml_node_child(parent, i);
 		node_type = M_xml_node_type(ptr);
-		if ((match_type == M_XML_XPATH_MATCH_TYPE_TAG && node_type == M_XML_NODE_TYPE_ELEMENT && M_xml_xpath_search_tag_eq(ptr, last_seg, flags)) ||
-			(match_type == M_XML_XPATH_MATCH_TYPE_TEXT && node_type == M_XML_NODE_TYPE_TEXT))
+		if ((last_seg->type == M_XML_XPATH_MATCH_TYPE_TAG && node_type == M_XML_NODE_TYPE_ELEMENT && M_xml_xpath_search_tag_eq(ptr, last_seg, flags)) ||
+			(last_seg->type == M_XML_XPATH_MATCH_TYPE_TEXT && node_type == M_XML_NODE_TYPE_TEXT))
 		{
 			num_children_elems++;
 		}
@@ -425,18 +572,9 @@ static void M_xml_xpath_search_match_node_pos(const char *seg, M_xml_node_t *nod
 	if (num_children_elems == 0)
 		return;
 
-	/* Silence coverity. Shouldn't be possible, should always have at least [] */
-	if (M_str_len(seg) < 2)
-		return;
-
-	/* Strip off []. */
-	val = M_strdup_max(seg+1, M_str_len(seg)-2);
 	/* Get the position we need to check. */
-	if (!M_xml_xpath_search_match_node_pos_offset(val, M_str_len(val), num_children_elems, &off_pos, &off_max)) {
-		M_free(val);
+	if (!M_xml_xpath_pos_range(xseg, num_children_elems, &off_pos, &off_max))
 		return;
-	}
-	M_free(val);
 
 	/* Offsets are 1 based. */
 	if (off_pos == 0 || off_pos > num_children) {
@@ -454,7 +592,7 @@ static void M_xml_xpath_search_match_node_pos(const char *seg, M_xml_node_t *nod
 			continue;
 
 		/* If it's an element and it matches or it's a text node it is considered a possible node. */
-		if ((node_type == M_XML_NODE_TYPE_ELEMENT && M_xml_xpath_search_tag_eq(ptr, last_seg, flags)) ||
+		if ((node_type == M_XML_NODE_TYPE_ELEMENT && last_seg->type == M_XML_XPATH_MATCH_TYPE_TAG && M_xml_xpath_search_tag_eq(ptr, last_seg, flags)) ||
 				(node_type == M_XML_NODE_TYPE_TEXT))
 		{
 			/* Increment the index. */
@@ -467,7 +605,7 @@ static void M_xml_xpath_search_match_node_pos(const char *seg, M_xml_node_t *nod
 			/* If the index is between the allowed indexes from the expression, be it a single index
  			 * or a range continue processing with this node. */
 			if (nidx >= off_pos && nidx < off_pos+off_max) {
-				M_xml_xpath_search(ptr, segments, seg_offset+1, flags, M_FALSE, matches, num_matches);
+				M_xml_xpath_search(eval, ptr, seg_offset+1, M_FALSE);
 			}
 			/* Don't need to check later elements because we've found the node we're looking for. */
 			break;
@@ -475,50 +613,75 @@ static void M_xml_xpath_search_match_node_pos(const char *seg, M_xml_node_t *nod
 	}
 }
 
-static void M_xml_xpath_search_match_node_text(const char *seg, M_xml_node_t *node, M_list_str_t *segments, size_t seg_offset, M_uint32 flags, M_bool search_recursive, M_xml_node_t ***matches, size_t *num_matches)
+static void M_xml_xpath_search_match_node_text(M_xml_xpath_eval_t *eval, M_xml_node_t *node, size_t seg_offset, M_bool search_recursive)
 {
 	M_xml_node_t      *ptr;
 	M_xml_node_type_t  type;
 	size_t             num_children;
 	size_t             i;
 
-	(void)seg;
-
-	num_children = M_xml_node_num_children(node);	
+	num_children = M_xml_node_num_children(node);
 	for (i=0; i<num_children; i++) {
 		ptr  = M_xml_node_child(node, i);
 		type = M_xml_node_type(ptr);
 
 		if (type == M_XML_NODE_TYPE_TEXT) {
-			M_xml_xpath_search(ptr, segments, seg_offset+1, flags, M_FALSE, matches, num_matches);
+			M_xml_xpath_search(eval, ptr, seg_offset+1, M_FALSE);
 		} else if (search_recursive && type == M_XML_NODE_TYPE_ELEMENT) {
-			M_xml_xpath_search(ptr, segments, seg_offset, flags, M_TRUE, matches, num_matches);
+			M_xml_xpath_search(eval, ptr, seg_offset, M_TRUE);
+		}
+	}
+}
+
+/* Recursive search for a tag using the name index instead of walking the tree. The index
+ * holds the descendants in document order which is the order the walk would find them. */
+static M_bool M_xml_xpath_search_index(M_xml_xpath_eval_t *eval, M_xml_node_t *node, size_t seg_offset)
+{
+	const M_xml_xpath_seg_t   *xseg;
+	M_xml_xpath_index_nodes_t *nodes;
+	size_t                     i;
+
+	if (eval->index == NULL || eval->index->root != node)
+		return M_FALSE;
+
+	xseg = &eval->xpath->segs[seg_offset];
+	if (xseg->type != M_XML_XPATH_MATCH_TYPE_TAG || xseg->any || xseg->skip_ns)
+		return M_FALSE;
+
+	nodes = M_hash_strvp_get_direct(eval->index->names, xseg->name);
+	if (nodes == NULL)
+		return M_TRUE;
+
+	for (i=0; i<nodes->num; i++) {
+		/* The index is case insensitive. */
+		if (eval->xpath->flags & M_XML_READER_TAG_CASECMP || M_str_eq(xseg->name, M_xml_node_name(nodes->nodes[i]))) {
+			M_xml_xpath_search(eval, nodes->nodes[i], seg_offset+1, M_FALSE);
 		}
 	}
+	return M_TRUE;
 }
 
-static void M_xml_xpath_search_add_match(M_xml_node_t *node, M_xml_node_t ***matches, size_t *num_matches)
+static void M_xml_xpath_search_add_match(M_xml_xpath_eval_t *eval, M_xml_node_t *node)
 {
-	if (*num_matches == 0 || *matches == NULL || M_size_t_round_up_to_power_of_two(*num_matches) == *num_matches) {
-		*matches = M_realloc(*matches, M_size_t_round_up_to_power_of_two(*num_matches + 1) * sizeof(**matches));
+	if (eval->num_matches == 0 || eval->matches == NULL || M_size_t_round_up_to_power_of_two(eval->num_matches) == eval->num_matches) {
+		eval->matches = M_realloc(eval->matches, M_size_t_round_up_to_power_of_two(eval->num_matches + 1) * sizeof(*eval->matches));
 	}
-	(*matches)[*num_matches] = node;
-	(*num_matches)++;
+	eval->matches[eval->num_matches] = node;
+	eval->num_matches++;
 }
 
-static void M_xml_xpath_search(M_xml_node_t *node, M_list_str_t *segments, size_t seg_offset, M_uint32 flags, M_bool search_recursive, M_xml_node_t ***matches, size_t *num_matches)
+static void M_xml_xpath_search(M_xml_xpath_eval_t *eval, M_xml_node_t *node, size_t seg_offset, M_bool search_recursive)
 {
-	const char               *seg;
-	M_xml_node_type_t         type;
-	size_t                    num_segments;
-	M_xml_xpath_match_type_t  match_type;
+	const M_xml_xpath_seg_t *xseg;
+	M_xml_node_type_t        type;
+	size_t                   num_segments;
 
 	if (node == NULL)
 		return;
 
-	num_segments = M_list_str_len(segments)-seg_offset;
+	num_segments = eval->xpath->num_segs-seg_offset;
 	if (num_segments == 0) {
-		M_xml_xpath_search_add_match(node, matches, num_matches);
+		M_xml_xpath_search_add_match(eval, node);
 		return;
 	}
 
@@ -526,45 +689,47 @@ static void M_xml_xpath_search(M_xml_node_t *node, M_list_str_t *segments, size_
 	if (type != M_XML_NODE_TYPE_ELEMENT && type != M_XML_NODE_TYPE_DOC && type != M_XML_NODE_TYPE_TEXT)
 		return;
 
-	seg = M_list_str_at(segments, seg_offset);
-	/* A blank segment denotes we want to search recursively for the next pattern */
-	if (seg == NULL || *seg == '\0' || M_str_eq(seg, ".")) {
-		/* Only recurse if there is something else to match */
-		if (num_segments > 1) {
-			M_xml_xpath_search(node, segments, seg_offset+1, flags, M_TRUE, matches, num_matches);
-		}
-		return;
-	}
-
-	/* Are we moving up to the parent? */
-	if (M_str_eq(seg, "..")) {
-		if (M_xml_node_parent(node) != NULL) {
-			node = M_xml_node_parent(node);
-		}
-		M_xml_xpath_search(node, segments, seg_offset+1, flags, M_FALSE, matches, num_matches);
-		return;
-	}
-
-	/* Determine the type of match we need to use. */
-	match_type = M_xml_xpath_search_segment_type(seg);
-	switch (match_type) {
+	xseg = &eval->xpath->segs[seg_offset];
+	switch (xseg->type) {
+		case M_XML_XPATH_MATCH_TYPE_DESCEND:
+			/* A blank segment denotes we want to search recursively for the next pattern.
+			 * Only recurse if there is something else to match */
+			if (num_segments > 1 && !M_xml_xpath_search_index(eval, node, seg_offset+1)) {
+				M_xml_xpath_search(eval, node, seg_offset+1, M_TRUE);
+			}
+			break;
+		case M_XML_XPATH_MATCH_TYPE_PARENT:
+			/* Moving up to the parent. */
+			if (M_xml_node_parent(node) != NULL) {
+				node = M_xml_node_parent(node);
+			}
+			M_xml_xpath_search(eval, node, seg_offset+1, M_FALSE);
+			break;
 		case M_XML_XPATH_MATCH_TYPE_TAG:
-			M_xml_xpath_search_match_node_tag(seg, node, segments, seg_offset, flags, search_recursive, matches, num_matches);
+			M_xml_xpath_search_match_node_tag(eval, xseg, node, seg_offset, search_recursive);
 			break;
 		case M_XML_XPATH_MATCH_TYPE_ATTR_ANY:
-			M_xml_xpath_search_match_node_attr_any(seg, node, segments, seg_offset, flags, search_recursive, matches, num_matches);
+			if (M_hash_dict_num_keys(M_xml_node_attributes(node)) != 0) {
+				M_xml_xpath_search(eval, node, seg_offset+1, M_FALSE);
+			}
 			break;
 		case M_XML_XPATH_MATCH_TYPE_ATTR_HAS:
-			M_xml_xpath_search_match_node_attr_has(seg, node, segments, seg_offset, flags, search_recursive, matches, num_matches);
+			if (M_xml_node_attribute(node, xseg->name) != NULL) {
+				M_xml_xpath_search(eval, node, seg_offset+1, M_FALSE);
+			}
 			break;
 		case M_XML_XPATH_MATCH_TYPE_ATTR_VAL:
-			M_xml_xpath_search_match_node_attr_val(seg, node, segments, seg_offset, flags, search_recursive, matches, num_matches);
+			/* If the attribute doesn't exist in the node then we can't match a value. A value of NULL/"" is
+ 			 * not the same as the node not being present. */
+			if (M_xml_node_attribute(node, xseg->name) != NULL && M_str_eq(M_xml_node_attribute(node, xseg->name), xseg->val)) {
+				M_xml_xpath_search(eval, node, seg_offset+1, M_FALSE);
+			}
 			break;
 		case M_XML_XPATH_MATCH_TYPE_POS:
-			M_xml_xpath_search_match_node_pos(seg, node, segments, seg_offset, flags, search_recursive, matches, num_matches);
+			M_xml_xpath_search_match_node_pos(eval, xseg, node, seg_offset);
 			break;
 		case M_XML_XPATH_MATCH_TYPE_TEXT:
-			M_xml_xpath_search_match_node_text(seg, node, segments, seg_offset, flags, search_recursive, matches, num_matches);
+			M_xml_xpath_search_match_node_text(eval, node, seg_offset, search_recursive);
 			break;
 		case M_XML_XPATH_MATCH_TYPE_INVALID:
 			break;
@@ -573,108 +738,179 @@ static void M_xml_xpath_search(M_xml_node_t *node, M_list_str_t *segments, size_
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-M_xml_node_t **M_xml_xpath(M_xml_node_t *node, const char *search, M_uint32 flags, size_t *num_matches)
+M_xml_xpath_t *M_xml_xpath_compile(const char *search, M_uint32 flags)
 {
-	M_xml_node_t **matches           = NULL;
-	char         **segments;
-	char         **pred_segments;
+	M_xml_xpath_t *xpath;
 	M_list_str_t  *seg_list;
-	M_buf_t       *buf;
-	char          *out;
-	size_t         start_offset      = 0;
-	size_t         num_segments      = 0;
-	size_t         num_pred_segments = 0;
+	size_t         start_offset = 0;
 	size_t         i;
-	size_t         j;
 
-	if (num_matches == NULL) {
+	if (search == NULL)
+		return NULL;
+
+	seg_list = M_xml_xpath_segments(search);
+	if (seg_list == NULL)
 		return NULL;
+
+	xpath        = M_malloc_zero(sizeof(*xpath));
+	xpath->flags = flags;
+
+	if (M_str_len(M_list_str_at(seg_list, 0)) == 0) {
+		/* If the first node is blank, that means the search pattern started with '/',
+		 * which means we need to scan to the doc node. Anything else is the start of
+		 * the search pattern, so we'll use the passed node for searching. */
+		xpath->absolute = M_TRUE;
+		start_offset    = 1;
 	}
+
+	xpath->num_segs = M_list_str_len(seg_list) - start_offset;
+	if (xpath->num_segs != 0) {
+		xpath->segs = M_malloc_zero(xpath->num_segs * sizeof(*xpath->segs));
+	}
+	for (i=0; i<xpath->num_segs; i++) {
+		M_xml_xpath_compile_seg(M_list_str_at(seg_list, i+start_offset), &xpath->segs[i]);
+	}
+
+	M_list_str_destroy(seg_list);
+	return xpath;
+}
+
+void M_xml_xpath_destroy(M_xml_xpath_t *xpath)
+{
+	size_t i;
+
+	if (xpath == NULL)
+		return;
+
+	for (i=0; i<xpath->num_segs; i++) {
+		M_xml_xpath_seg_clear(&xpath->segs[i]);
+	}
+	M_free(xpath->segs);
+	M_free(xpath);
+}
+
+M_xml_node_t **M_xml_xpath_eval(const M_xml_xpath_t *xpath, M_xml_node_t *node, const M_xml_xpath_index_t *index, size_t *num_matches)
+{
+	M_xml_xpath_eval_t eval;
+
+	if (num_matches == NULL)
+		return NULL;
 	*num_matches = 0;
 
-	if (node == NULL || search == NULL)
+	if (xpath == NULL || node == NULL)
 		return NULL;
 
-	segments = M_str_explode_str('/', search, &num_segments);
-	if (segments == NULL || num_segments == 0) {
-		/* Silence coverity, but most likely if num_segments is 0, segments is NULL right? */
-		M_str_explode_free(segments, num_segments);
+	if (xpath->absolute)
+		node = M_xml_node_find_doc(node);
+
+	if (xpath->num_segs == 0) {
+		/* Nothing to search so I suppose it makes sense to return the current node */
+		eval.matches    = M_malloc(sizeof(*eval.matches));
+		eval.matches[0] = node;
+		*num_matches    = 1;
+		return eval.matches;
+	}
+
+	M_mem_set(&eval, 0, sizeof(eval));
+	eval.xpath = xpath;
+	eval.index = index;
+	M_xml_xpath_search(&eval, node, 0, M_FALSE);
+
+	*num_matches = eval.num_matches;
+	return eval.matches;
+}
+
+M_xml_node_t **M_xml_xpath(M_xml_node_t *node, const char *search, M_uint32 flags, size_t *num_matches)
+{
+	M_xml_xpath_t  *xpath;
+	M_xml_node_t  **matches;
+
+	if (num_matches == NULL) {
 		return NULL;
 	}
+	*num_matches = 0;
 
-	/* Further split on '[' to pull out predicate filters. */
-	seg_list = M_list_str_create(M_LIST_STR_NONE);
-	for (i=0; i<num_segments; i++) {
-		if (*(segments[i]) == '\0') {
-			M_list_str_insert(seg_list, "");
-			continue;
-		}
+	if (node == NULL || search == NULL)
+		return NULL;
 
-		pred_segments = M_str_explode_str('[', segments[i], &num_pred_segments);
-		if (pred_segments == NULL || num_pred_segments == 0) {
-			M_str_explode_free(pred_segments, num_pred_segments);
-			continue;
-		}
+	xpath   = M_xml_xpath_compile(search, flags);
+	matches = M_xml_xpath_eval(xpath, node, NULL, num_matches);
+	M_xml_xpath_destroy(xpath);
 
-		for (j=0; j<num_pred_segments; j++) {
-			/* Empty means we found a '[', skip it. */
-			if (pred_segments[j] == NULL || *(pred_segments[j]) == '\0')
-				continue;
+	return matches;
+}
 
-			/* First one may not start with '['. We need to check if the segment is something like:
-			 * 'abc'/'abc[1]' vs '[1]'. */
-			if (j == 0 && *(segments[i]) != '[') {
-				M_list_str_insert(seg_list, pred_segments[j]);
-				continue;
-			}
-			
-			/* Verify that our predicate ends with a ']'. If it doesn't then this is an invaild expression. */
-			if (pred_segments[j][M_str_len(pred_segments[j])-1] != ']') {
-				M_str_explode_free(pred_segments, num_pred_segments);
-				M_str_explode_free(segments, num_segments);
-				M_list_str_destroy(seg_list);
-				return NULL;
-			}
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-			/* Put the '[' back on the front of the segment and add it to our list of segments. */
-			buf = M_buf_create();
-			M_buf_add_byte(buf, '[');
-			M_buf_add_str(buf, pred_segments[j]);
-			out = M_buf_finish_str(buf, NULL);
-			M_list_str_insert(seg_list, out);
-			M_free(out);
+static void M_xml_xpath_index_nodes_destroy(void *arg)
+{
+	M_xml_xpath_index_nodes_t *nodes = arg;
+
+	if (nodes == NULL)
+		return;
+
+	M_free(nodes->nodes);
+	M_free(nodes);
+}
+
+static void M_xml_xpath_index_add(M_xml_xpath_index_t *index, M_xml_node_t *node)
+{
+	M_xml_xpath_index_nodes_t *nodes;
+	M_xml_node_t              *ptr;
+	size_t                     num_children;
+	size_t                     i;
+
+	/* Same walk as a recursive tag search. Only elements are indexed and
+	 * only their children are visited. */
+	num_children = M_xml_node_num_children(node);
+	for (i=0; i<num_children; i++) {
+		ptr = M_xml_node_child(node, i);
+		if (M_xml_node_type(ptr) != M_XML_NODE_TYPE_ELEMENT)
+			continue;
+
+		nodes = M_hash_strvp_get_direct(index->names, M_xml_node_name(ptr));
+		if (nodes == NULL) {
+			nodes = M_malloc_zero(sizeof(*nodes));
+			M_hash_strvp_insert(index->names, M_xml_node_name(ptr), nodes);
 		}
-		M_str_explode_free(pred_segments, num_pred_segments);
+		if (nodes->num == nodes->size) {
+			nodes->size  = nodes->size == 0 ? 4 : nodes->size * 2;
+			nodes->nodes = M_realloc(nodes->nodes, nodes->size * sizeof(*nodes->nodes));
+		}
+		nodes->nodes[nodes->num++] = ptr;
+
+		M_xml_xpath_index_add(index, ptr);
 	}
-	M_str_explode_free(segments, num_segments);
+}
 
-	if (M_list_str_len(seg_list) == 0) {
-		M_list_str_destroy(seg_list);
+M_xml_xpath_index_t *M_xml_xpath_index_create(M_xml_node_t *node)
+{
+	M_xml_xpath_index_t *index;
+	M_xml_node_type_t    type;
+
+	type = M_xml_node_type(node);
+	if (type != M_XML_NODE_TYPE_DOC && type != M_XML_NODE_TYPE_ELEMENT)
 		return NULL;
-	}
 
-	if (M_str_len(M_list_str_at(seg_list, 0)) == 0) {
-		/* If the first node is blank, that means the search pattern started with '/',
-		 * which means we need to scan to the doc node. Anything else is the start of
-		 * the search pattern, so we'll use the passed node for searching. */
-		node         = M_xml_node_find_doc(node);
-		start_offset = 1;
-	}
+	index        = M_malloc_zero(sizeof(*index));
+	index->root  = node;
+	index->names = M_hash_strvp_create(16, 75, M_HASH_STRVP_CASECMP, M_xml_xpath_index_nodes_destroy);
+	M_xml_xpath_index_add(index, node);
 
-	if (M_list_str_len(seg_list) - start_offset != 0) {
-		/* Only do the search if there is something to search */
-		M_xml_xpath_search(node, seg_list, start_offset, flags, M_FALSE, &matches, num_matches);
-	} else {
-		/* Otherwise I suppose it makes sense to return the current node */
-		matches      = M_malloc(sizeof(*matches));
-		matches[0]   = node;
-		*num_matches = 1;
-	}
+	return index;
+}
 
-	M_list_str_destroy(seg_list);
-	return matches;
+void M_xml_xpath_index_destroy(M_xml_xpath_index_t *index)
+{
+	if (index == NULL)
+		return;
+
+	M_hash_strvp_destroy(index->names, M_TRUE);
+	M_free(index);
 }
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
 const char *M_xml_xpath_text_first(M_xml_node_t *node, const char *search)
 {
 	M_xml_node_t **matches     = NULL;
@@ -0,0 +1,194 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2026 Monetra Technologies, LLC.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef __M_ARENA_H__
+#define __M_ARENA_H__
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#include <mstdlib/base/m_defs.h>
+#include <mstdlib/base/m_types.h>
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+__BEGIN_DECLS
+
+/*! \addtogroup m_arena Arena Allocator
+ *  \ingroup mstdlib_base
+ *
+ * Region based memory allocation.
+ *
+ * An arena hands out memory from large chunks by advancing a pointer. Individual
+ * allocations are never freed. Instead, all memory from the arena is released at
+ * once using M_arena_reset() or M_arena_destroy(). This is much cheaper than a
+ * large number of M_malloc and M_free calls for objects which all share the same
+ * lifetime, such as the nodes of a parsed document.
+ *
+ * When a chunk is full a new one is chained on. Allocations that are larger than
+ * a quarter of the chunk size are given their own chunk so they don't waste the
+ * remainder of the current one.
+ *
+ * M_arena_reset() keeps the standard sized chunks so the arena can be reused
+ * without allocating again. Like M_free, memory is zeroed when it is reset or
+ * released.
+ *
+ * All memory returned is suitably aligned for any type.
+ *
+ * The arena is not thread safe.
+ *
+ * Example:
+ *
+ * \code{.c}
+ *     M_arena_t     *arena;
+ *     M_json_node_t *json;
+ *     size_t         i;
+ *
+ *     arena = M_arena_create(0);
+ *     for (i=0; i<num_docs; i++) {
+ *         json = M_json_read_arena(arena, docs[i], M_str_len(docs[i]), M_JSON_READER_NONE, NULL, NULL, NULL, NULL);
+ *         ...
+ *         M_arena_reset(arena);
+ *     }
+ *     M_arena_destroy(arena);
+ * \endcode
+ *
+ * @{
+ */
+
+struct M_arena;
+typedef struct M_arena M_arena_t;
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/*! Create an arena.
+ *
+ * \param[in] chunk_size Size of each chunk of memory allocations are served from.
+ *                       0 to use the default (8 KB).
+ *
+ * \return Arena.
+ *
+ * \see M_arena_destroy
+ */
+M_API M_arena_t *M_arena_create(size_t chunk_size) M_MALLOC;
+
+
+/*! Destroy an arena.
+ *
+ * All memory allocated from the arena is released.
+ *
+ * \param[in] arena Arena.
+ */
+M_API void M_arena_destroy(M_arena_t *arena) M_FREE(1);
+
+
+/*! Release all allocations so the arena can be used again.
+ *
+ * All memory previously allocated from the arena becomes invalid. Standard
+ * sized chunks are kept for reuse. Chunks used for oversized allocations are
+ * released.
+ *
+ * \param[in] arena Arena.
+ */
+M_API void M_arena_reset(M_arena_t *arena);
+
+
+/*! Allocate memory from an arena.
+ *
+ * \param[in] arena Arena.
+ * \param[in] size  Number of bytes to allocate.
+ *
+ * \return Pointer to memory, or NULL if arena is NULL or size is 0. Must not be
+ *         passed to M_free. Valid until the arena is reset or destroyed.
+ */
+M_API void *M_arena_alloc(M_arena_t *arena, size_t size) M_ALLOC_SIZE(2) M_WARN_UNUSED_RESULT M_MALLOC;
+
+
+/*! Allocate memory from an arena and fill it with 0's.
+ *
+ * \param[in] arena Arena.
+ * \param[in] size  Number of bytes to allocate.
+ *
+ * \return Pointer to memory, or NULL if arena is NULL or size is 0. Must not be
+ *         passed to M_free. Valid until the arena is reset or destroyed.
+ */
+M_API void *M_arena_alloc_zero(M_arena_t *arena, size_t size) M_ALLOC_SIZE(2) M_WARN_UNUSED_RESULT M_MALLOC;
+
+
+/*! Copy memory into an arena.
+ *
+ * \param[in] arena Arena.
+ * \param[in] src   Memory to copy.
+ * \param[in] size  Number of bytes to copy.
+ *
+ * \return Copy of src, or NULL on error. Valid until the arena is reset or destroyed.
+ */
+M_API void *M_arena_memdup(M_arena_t *arena, const void *src, size_t size) M_ALLOC_SIZE(3) M_WARN_UNUSED_RESULT M_MALLOC;
+
+
+/*! Copy a string into an arena.
+ *
+ * \param[in] arena Arena.
+ * \param[in] s     NULL terminated string.
+ *
+ * \return Copy of s, or NULL if arena or s is NULL. Valid until the arena is reset or destroyed.
+ */
+M_API char *M_arena_strdup(M_arena_t *arena, const char *s) M_WARN_UNUSED_RESULT M_MALLOC;
+
+
+/*! Copy at most max bytes of a string into an arena.
+ *
+ * The result is always NULL terminated.
+ *
+ * \param[in] arena Arena.
+ * \param[in] s     String.
+ * \param[in] max   Maximum number of bytes to copy from s.
+ *
+ * \return Copy of s, or NULL if arena or s is NULL. Valid until the arena is reset or destroyed.
+ */
+M_API char *M_arena_strdup_max(M_arena_t *arena, const char *s, size_t max) M_WARN_UNUSED_RESULT M_MALLOC;
+
+
+/*! Number of bytes currently handed out by the arena.
+ *
+ * Includes alignment padding.
+ *
+ * \param[in] arena Arena.
+ *
+ * \return Bytes used.
+ */
+M_API size_t M_arena_bytes_used(const M_arena_t *arena);
+
+
+/*! Number of bytes the arena has allocated from the system.
+ *
+ * \param[in] arena Arena.
+ *
+ * \return Bytes allocated for chunks.
+ */
+M_API size_t M_arena_bytes_allocated(const M_arena_t *arena);
+
+/*! @} */
+
+__END_DECLS
+
+#endif /* __M_ARENA_H__ */
@@ -48,6 +48,15 @@ __BEGIN_DECLS
  *
  * Hot cache.
  *
+ * Entries are evicted least recently used first once the cache reaches its maximum
+ * number of entries, or using W-TinyLFU if M_CACHE_POLICY_TINYLFU is specified.
+ * Optionally entries can have a cost (such as their size in bytes) with the total
+ * cost bounded, and a time to live after which they are treated as not present. Expired entries are removed lazily when they are accessed or when they
+ * would be evicted. M_cache_expire() can be used to purge all expired entries.
+ *
+ * The cache is not thread safe. See M_cache_concurrent_t for a cache that can be
+ * shared between threads.
+ *
  * @{
  */
 
@@ -65,10 +74,27 @@ typedef void (*M_cache_free_func)(void *);
 
 /*! Flags for controlling the behavior of the hash */
 typedef enum {
-	M_CACHE_NONE = 0, /*!< Default. */
+	M_CACHE_NONE           = 0,      /*!< Default. Least recently used eviction. */
+	M_CACHE_POLICY_TINYLFU = 1 << 0  /*!< Scan resistant W-TinyLFU eviction. New entries go into a small
+	                                      LRU window. Entries leaving the window are only kept if they have
+	                                      been requested more often than the entry they would evict from the
+	                                      main segmented LRU area. Access frequency is estimated with a
+	                                      compact sketch, including gets for keys that aren't cached. One off
+	                                      sequential access (such as a report scanning all records) will not
+	                                      push out frequently used entries. Costs a few bytes of memory per
+	                                      entry for the sketch. */
 } M_cache_flags_t;
 
 
+/*! Statistics about cache use. */
+typedef struct {
+	M_uint64 hits;        /*!< Number of gets that found the key. */
+	M_uint64 misses;      /*!< Number of gets that did not find the key (including expired keys). */
+	M_uint64 evictions;   /*!< Number of entries removed to make room for others. */
+	M_uint64 expirations; /*!< Number of entries removed because their time to live passed. */
+} M_cache_stats_t;
+
+
 /*! Structure of callbacks that can be registered to override default
  *  behavior for implementation. */
 struct M_cache_callbacks {
@@ -91,7 +117,7 @@ struct M_cache_callbacks {
  *                         the pointer address as the key.
  * \param[in] key_equality The function to use to determine if two keys are equal.  If not 
  *                         specified, will compare pointer addresses.
- * \param[in] flags        M_hash_strvp_flags_t flags for modifying behavior.
+ * \param[in] flags        M_cache_flags_t flags for modifying behavior.
  * \param[in] callbacks    Register callbacks for overriding default behavior.
  *
  * \return Allocated cache.
@@ -113,6 +139,8 @@ M_API void M_cache_destroy(M_cache_t *c);
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 /*! Insert an entry into the cache.
+ *
+ * The entry has a cost of 0 and uses the default time to live.
  *
  * \param[in] c     Cache being referenced.
  * \param[in] key   Key to insert.
@@ -120,10 +148,32 @@ M_API void M_cache_destroy(M_cache_t *c);
  *                  The c will take ownership of the value. Maybe NULL.
  *
  * \return M_TRUE on success, or M_FALSE on failure.
+ *
+ * \see M_cache_insert_ex
+ * \see M_cache_set_default_ttl
  */
 M_API M_bool M_cache_insert(M_cache_t *c, const void *key, const void *value);
 
 
+/*! Insert an entry into the cache with a cost and time to live.
+ *
+ * Colder entries will be evicted until the total cost is within the maximum cost.
+ *
+ * \param[in] c      Cache being referenced.
+ * \param[in] key    Key to insert.
+ * \param[in] value  Value to insert into h.
+ *                   The c will take ownership of the value. Maybe NULL.
+ * \param[in] cost   Cost of the entry. Typically the size of the value in bytes.
+ * \param[in] ttl_ms Number of milliseconds before the entry expires. 0 to never expire.
+ *
+ * \return M_TRUE on success, or M_FALSE on failure. Fails if cost is larger than the
+ *         maximum cost in which case ownership of the value remains with the caller.
+ *
+ * \see M_cache_set_max_cost
+ */
+M_API M_bool M_cache_insert_ex(M_cache_t *c, const void *key, const void *value, size_t cost, M_uint64 ttl_ms);
+
+
 /*! Remove an entry from the cache.
  *
  * \param[in] c   Cache being referenced.
@@ -140,10 +190,19 @@ M_API M_bool M_cache_remove(M_cache_t *c, const void *key);
  * \param[in]  key    Key for value.
  * \param[out] value  Pointer to value stored in the h. Optional, pass NULL if not needed.
  *
- * \return M_TRUE if value retrieved, M_FALSE if key does not exist.
+ * \return M_TRUE if value retrieved, M_FALSE if key does not exist or has expired.
  */
 M_API M_bool M_cache_get(const M_cache_t *c, const void *key, void **value);
 
+
+/*! Remove all expired entries from the cache.
+ *
+ * \param[in] c Cache being referenced.
+ *
+ * \return Number of entries removed.
+ */
+M_API size_t M_cache_expire(M_cache_t *c);
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 /*! Get the number of items in the cache.
@@ -177,6 +236,62 @@ M_API size_t M_cache_max_size(const M_cache_t *c);
  */
 M_API M_bool M_cache_set_max_size(M_cache_t *c, size_t max_size);
 
+
+/*! Get the total cost of all items in the cache.
+ *
+ * \param[in] c Cache being referenced.
+ *
+ * \return Cost.
+ */
+M_API size_t M_cache_cost(const M_cache_t *c);
+
+
+/*! Get the maximum total cost allowed in the cache.
+ *
+ * \param[in] c Cache being referenced.
+ *
+ * \return Max cost. 0 if unlimited.
+ */
+M_API size_t M_cache_max_cost(const M_cache_t *c);
+
+
+/*! Set the maximum total cost allowed in the cache.
+ *
+ * If the total cost is larger than the maximum, older items will be removed.
+ *
+ * \param[in] c        Cache being referenced.
+ * \param[in] max_cost Maximum cost. 0 for unlimited (default).
+ *
+ * \return M_TRUE if the max cost was changed, otherwise M_FALSE on error.
+ */
+M_API M_bool M_cache_set_max_cost(M_cache_t *c, size_t max_cost);
+
+
+/*! Set the time to live used by M_cache_insert.
+ *
+ * Only applies to entries inserted after the call.
+ *
+ * \param[in] c      Cache being referenced.
+ * \param[in] ttl_ms Number of milliseconds before entries expire. 0 to never expire (default).
+ */
+M_API void M_cache_set_default_ttl(M_cache_t *c, M_uint64 ttl_ms);
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/*! Get the usage statistics for the cache.
+ *
+ * \param[in]  c     Cache being referenced.
+ * \param[out] stats Statistics.
+ */
+M_API void M_cache_stats(const M_cache_t *c, M_cache_stats_t *stats);
+
+
+/*! Reset the usage statistics for the cache.
+ *
+ * \param[in] c Cache being referenced.
+ */
+M_API void M_cache_stats_reset(M_cache_t *c);
+
 /*! @} */
 
 __END_DECLS
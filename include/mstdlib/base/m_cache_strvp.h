@@ -48,8 +48,9 @@ typedef struct M_cache_strvp M_cache_strvp_t;
 
 /*! Flags for controlling the behavior of the hash */
 typedef enum {
-	M_CACHE_STRVP_NONE    = 0,      /*!< Default. */
-	M_CACHE_STRVP_CASECMP = 1 << 0, /*!< Compare keys case insensitive. */
+	M_CACHE_STRVP_NONE           = 0,      /*!< Default. */
+	M_CACHE_STRVP_CASECMP        = 1 << 0, /*!< Compare keys case insensitive. */
+	M_CACHE_STRVP_POLICY_TINYLFU = 1 << 1  /*!< Scan resistant eviction. See M_CACHE_POLICY_TINYLFU. */
 } M_cache_strvp_flags_t;
 
 
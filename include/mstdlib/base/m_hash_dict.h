@@ -28,6 +28,7 @@
 
 #include <mstdlib/base/m_defs.h>
 #include <mstdlib/base/m_types.h>
+#include <mstdlib/base/m_arena.h>
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
@@ -82,6 +83,14 @@ typedef enum {
 	                                           DO _NOT_ use this flag with any hashtable that could store user
 	                                           generated data! Be very careful about duplicating a hashtable that
 	                                           was created with this flag. All duplicates will use the static seed. */
+	M_HASH_DICT_OPEN_ADDRESSING    = 1 << 12, /*!< Use open addressing instead of chaining for collisions. Collisions
+	                                               do not allocate and lookups have better cache locality.
+	                                               See M_HASHTABLE_OPEN_ADDRESSING. */
+	M_HASH_DICT_INCREMENTAL_REHASH = 1 << 13, /*!< Move entries into the expanded table a few at a time during
+	                                               later inserts and removes instead of all at once.
+	                                               See M_HASHTABLE_INCREMENTAL_REHASH. */
+	M_HASH_DICT_MEMPOOL            = 1 << 14, /*!< Allocate chained entries from a pool owned by the table.
+	                                               See M_HASHTABLE_MEMPOOL. */
 	M_HASH_DICT_DESER_TRIM_WHITESPACE = 1 << 26, /*!< During deserialization, trim whitespace. */
 } M_hash_dict_flags_t;
 
@@ -109,6 +118,31 @@ typedef enum {
 M_API M_hash_dict_t *M_hash_dict_create(size_t size, M_uint8 fillpct, M_uint32 flags) M_MALLOC;
 
 
+/*! Create a new hashtable allocated from an arena.
+ *
+ * The same as M_hash_dict_create() except the hashtable, its keys and its
+ * values are allocated from the arena and are released by M_arena_reset() or
+ * M_arena_destroy(). Nothing is freed before then, including removed or replaced
+ * entries. Calling M_hash_dict_destroy() is not required.
+ *
+ * M_hash_dict_duplicate() allocates the copy from the same arena.
+ *
+ * \param[in] arena    Arena.
+ * \param[in] size     Size of the hash table. If not specified as a power of 2, will
+ *                     be rounded up to the nearest power of 2.
+ * \param[in] fillpct  The maximum fill percentage before the hash table is expanded. If
+ *                     0 is specified, the hashtable will never expand, otherwise the
+ *                     value must be between 1 and 99 (recommended: 75).
+ * \param[in] flags    M_hash_dict_flags_t flags for modifying behavior. M_HASH_DICT_KEYS_SORTASC
+ *                     and M_HASH_DICT_KEYS_SORTDESC are not supported.
+ *
+ * \return Hashtable. NULL if arena is NULL or on error. Valid until the arena is reset or destroyed.
+ *
+ * \see M_hash_dict_create
+ */
+M_API M_hash_dict_t *M_hash_dict_create_arena(M_arena_t *arena, size_t size, M_uint8 fillpct, M_uint32 flags);
+
+
 /*! Destroy the hashtable.
  *
  * \param[in] h Hashtable to destroy
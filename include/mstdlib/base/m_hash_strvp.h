@@ -28,6 +28,7 @@
 
 #include <mstdlib/base/m_defs.h>
 #include <mstdlib/base/m_types.h>
+#include <mstdlib/base/m_arena.h>
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
@@ -73,13 +74,21 @@ typedef enum {
 	                                          Sorted in insertion order another sorting is specified. */
 	M_HASH_STRVP_MULTI_GETLAST = 1 << 7, /*!< When using get and get_direct function get the last value from the list
 	                                          when allowing multiple values. The default is to get the first value. */
-	M_HASH_STRVP_STATIC_SEED   = 1 << 8  /*!< Use a static seed for hash function initialization. This greatly reduces
+	M_HASH_STRVP_STATIC_SEED   = 1 << 8, /*!< Use a static seed for hash function initialization. This greatly reduces
 	                                           the security of the hashtable and removes collision attack protections.
 	                                           This should only be used as a performance optimization when creating
 	                                           millions of hashtables with static data specifically for quick look up.
 	                                           DO _NOT_ use this flag with any hashtable that could store user
 	                                           generated data! Be very careful about duplicating a hashtable that
 	                                           was created with this flag. All duplicates will use the static seed. */
+	M_HASH_STRVP_OPEN_ADDRESSING    = 1 << 9, /*!< Use open addressing instead of chaining for collisions. Collisions
+	                                               do not allocate and lookups have better cache locality.
+	                                               See M_HASHTABLE_OPEN_ADDRESSING. */
+	M_HASH_STRVP_INCREMENTAL_REHASH = 1 << 10, /*!< Move entries into the expanded table a few at a time during
+	                                               later inserts and removes instead of all at once.
+	                                               See M_HASHTABLE_INCREMENTAL_REHASH. */
+	M_HASH_STRVP_MEMPOOL            = 1 << 11  /*!< Allocate chained entries from a pool owned by the table.
+	                                               See M_HASHTABLE_MEMPOOL. */
 } M_hash_strvp_flags_t;
 
 
@@ -108,6 +117,33 @@ typedef enum {
 M_API M_hash_strvp_t *M_hash_strvp_create(size_t size, M_uint8 fillpct, M_uint32 flags, void (*destroy_func)(void *)) M_MALLOC_ALIASED;
 
 
+/*! Create a new hashtable allocated from an arena.
+ *
+ * The same as M_hash_strvp_create() except the hashtable and its keys are
+ * allocated from the arena and are released by M_arena_reset() or
+ * M_arena_destroy(). Nothing is freed before then, including removed keys.
+ * Calling M_hash_strvp_destroy() is not required but will still call
+ * destroy_func for the values if requested. Values are not allocated from the
+ * arena.
+ *
+ * \param[in] arena        Arena.
+ * \param[in] size         Size of the hash table. If not specified as a power of 2, will
+ *                         be rounded up to the nearest power of 2.
+ * \param[in] fillpct      The maximum fill percentage before the hash table is expanded. If
+ *                         0 is specified, the hashtable will never expand, otherwise the
+ *                         value must be between 1 and 99 (recommended: 75).
+ * \param[in] flags        M_hash_strvp_flags_t flags for modifying behavior. M_HASH_STRVP_KEYS_SORTASC
+ *                         and M_HASH_STRVP_KEYS_SORTDESC are not supported.
+ * \param[in] destroy_func The function to be called to destroy value when the hashtable
+ *                         itself is destroyed. Can be NULL.
+ *
+ * \return Hashtable. NULL if arena is NULL or on error. Valid until the arena is reset or destroyed.
+ *
+ * \see M_hash_strvp_create
+ */
+M_API M_hash_strvp_t *M_hash_strvp_create_arena(M_arena_t *arena, size_t size, M_uint8 fillpct, M_uint32 flags, void (*destroy_func)(void *));
+
+
 /*! Destroy the hashtable.
  *
  * \param[in] h            Hashtable to destroy
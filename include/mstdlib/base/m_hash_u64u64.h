@@ -71,13 +71,21 @@ typedef enum {
 	M_HASH_U64U64_MULTI_SORTDESC = 1 << 5, /*!< Allow keys to contain multiple values sorted in descending order */
 	M_HASH_U64U64_MULTI_GETLAST  = 1 << 6, /*!< When using get and get_direct function get the last value from the list
 	                                            when allowing multiple values. The default is to get the first value. */
-	M_HASH_U64U64_STATIC_SEED    = 1 << 7  /*!< Use a static seed for hash function initialization. This greatly reduces
+	M_HASH_U64U64_STATIC_SEED    = 1 << 7, /*!< Use a static seed for hash function initialization. This greatly reduces
 	                                            the security of the hashtable and removes collision attack protections.
 	                                            This should only be used as a performance optimization when creating
 	                                            millions of hashtables with static data specifically for quick look up.
 	                                            DO _NOT_ use this flag with any hashtable that could store user
 	                                            generated data! Be very careful about duplicating a hashtable that
 	                                            was created with this flag. All duplicates will use the static seed. */
+	M_HASH_U64U64_OPEN_ADDRESSING    = 1 << 8, /*!< Use open addressing instead of chaining for collisions. Collisions
+	                                                do not allocate and lookups have better cache locality.
+	                                                See M_HASHTABLE_OPEN_ADDRESSING. */
+	M_HASH_U64U64_INCREMENTAL_REHASH = 1 << 9, /*!< Move entries into the expanded table a few at a time during
+	                                                later inserts and removes instead of all at once.
+	                                                See M_HASHTABLE_INCREMENTAL_REHASH. */
+	M_HASH_U64U64_MEMPOOL            = 1 << 10 /*!< Allocate chained entries from a pool owned by the table.
+	                                                See M_HASHTABLE_MEMPOOL. */
 } M_hash_u64u64_flags_t;
 
 
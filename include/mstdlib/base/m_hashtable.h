@@ -205,13 +205,30 @@ typedef enum {
 	M_HASHTABLE_MULTI_SORTED  = 1 << 3, /*!< Allow keys to contain multiple values sorted in ascending order */
 	M_HASHTABLE_MULTI_GETLAST = 1 << 4, /*!< When using the get function will get the last value from the list
 	                                         when allowing multiple values. The default is to get the first value. */
-	M_HASHTABLE_STATIC_SEED   = 1 << 5  /*!< Use a static seed for hash function initialization. This greatly reduces
+	M_HASHTABLE_STATIC_SEED   = 1 << 5, /*!< Use a static seed for hash function initialization. This greatly reduces
 	                                         the security of the hashtable and removes collision attack protections.
 	                                         This should only be used as a performance optimization when creating
 	                                         millions of hashtables with static data specifically for quick look up.
 	                                         DO _NOT_ use this flag with any hashtable that could store user
 	                                         generated data! Be very careful about duplicating a hashtable that
 	                                         was created with this flag. All duplicates will use the static seed. */
+	M_HASHTABLE_OPEN_ADDRESSING    = 1 << 6, /*!< Store entries in a flat slot array using open addressing instead of chaining
+	                                             collisions. Collisions do not allocate and lookups compare a group of per
+	                                             slot hash fragments at once (SIMD when available) before comparing keys.
+	                                             The table always expands before it is 7/8 full regardless of fillpct and
+	                                             is a minimum of 16 buckets. Good for large tables with small keys. */
+	M_HASHTABLE_INCREMENTAL_REHASH = 1 << 7, /*!< Expand the table incrementally. When the fill percentage is reached
+	                                             a new bucket list is allocated but entries are moved into it a few
+	                                             buckets at a time by each following insert and remove instead of
+	                                             all at once. Lookups and enumeration check both bucket lists while
+	                                             the move is in progress. This bounds the time any single insert can
+	                                             take at the cost of briefly holding both bucket lists. Gets do not
+	                                             move entries so a table can be read while being enumerated. */
+	M_HASHTABLE_MEMPOOL            = 1 << 8  /*!< Allocate chained collision entries, and ordered key list nodes,
+	                                             from pools owned by the table instead of individually. The memory
+	                                             is kept for reuse until the table is destroyed. Useful for tables
+	                                             with frequent inserts and removes. Has no effect on the bucket
+	                                             list itself or on open addressing which doesn't chain. */
 } M_hashtable_flags_t;
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
@@ -219,7 +236,8 @@ typedef enum {
 /*! Create a new h.
  *
  * The h will pre-allocate an array of buckets based on the rounded up size specified. Any hash collisions
- * will result in those collisions being chained together via a linked list. The h will auto-expand by a
+ * will result in those collisions being chained together via a linked list, unless M_HASHTABLE_OPEN_ADDRESSING
+ * is specified in which case collisions are stored in other free buckets. The h will auto-expand by a
  * power of 2 when the fill percentage specified is reached. All key entries are compared in a case-insensitive
  * fashion, and are duplicated internally. Values are duplicated. Case is preserved for both keys and values.
  *
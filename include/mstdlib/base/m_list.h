@@ -29,6 +29,7 @@
 #include <mstdlib/base/m_defs.h>
 #include <mstdlib/base/m_types.h>
 #include <mstdlib/base/m_sort.h>
+#include <mstdlib/base/m_arena.h>
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
@@ -163,6 +164,29 @@ typedef enum {
 M_API M_list_t *M_list_create(const struct M_list_callbacks *callbacks, M_uint32 flags) M_MALLOC;
 
 
+/*! Create a new dynamic list allocated from an arena.
+ *
+ * The list and its storage are allocated from the arena and are released by
+ * M_arena_reset() or M_arena_destroy(). Calling M_list_destroy() is not required
+ * but will still free the values if requested. Storage is never shrunk and memory
+ * left behind when the list grows stays in use until the arena is reset.
+ *
+ * Values are not allocated from the arena, they're handled by the callbacks
+ * the same as M_list_create(). M_list_duplicate() of an arena list returns a list
+ * that is not allocated from the arena.
+ *
+ * \param[in] arena     Arena.
+ * \param[in] callbacks Register callbacks for overriding default behavior. May pass NULL
+ *                      if not overriding default behavior.
+ * \param[in] flags     M_list_flags_t flags controlling behavior.
+ *
+ * \return Dynamic list. NULL if arena is NULL. Valid until the arena is reset or destroyed.
+ *
+ * \see M_list_create
+ */
+M_API M_list_t *M_list_create_arena(M_arena_t *arena, const struct M_list_callbacks *callbacks, M_uint32 flags);
+
+
 /*! Destroy the list.
  *
  * \param[in] d            The list to destory.
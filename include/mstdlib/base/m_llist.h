@@ -105,8 +105,11 @@ typedef enum {
 	M_LLIST_NONE     = 0,      /*!< LList mode (unsorted). */
 	M_LLIST_SORTED   = 1 << 0, /*!< Whether the data in the list should be kept in sorted order. callbacks cannot
 	                                be NULL and the equality function must be set if this is M_TRUE. */
-	M_LLIST_CIRCULAR = 1 << 1  /*!< Whether the nodes are linked in a circular manner. Last node points to first.
-	                                This cannot be used while sorted. */								 
+	M_LLIST_CIRCULAR = 1 << 1, /*!< Whether the nodes are linked in a circular manner. Last node points to first.
+	                                This cannot be used while sorted. */
+	M_LLIST_MEMPOOL  = 1 << 2  /*!< Allocate nodes from a pool owned by the list instead of individually.
+	                                Node memory is kept for reuse until the list is destroyed. Useful for
+	                                lists with frequent inserts and removes. */								 
 } M_llist_flags_t;
 
 
@@ -561,13 +561,75 @@ M_API M_uint16 M_mem_calc_crc16_ccitt(const void *s, size_t s_len);
  * It's calculated using an initial value of 0xFFFFFFFF, and XOR'ing the CRC value by 0xFFFFFFFF after
  * the computation is done to invert it.
  *
+ * Carry-less multiplication (PCLMULQDQ) is used when the CPU supports it, otherwise
+ * a slice-by-8 table implementation is used.
+ *
  * \param[in] s     Pointer to data to perform check on.
  * \param[in] s_len Size of memory area s.
  * \return          CRC-32 value.
+ *
+ * \see M_mem_calc_crc32_update
  */
 M_API M_uint32 M_mem_calc_crc32(const void *s, size_t s_len);
 
 
+/*! Update a running CRC (CRC-32).
+ *
+ * Allows data to be checksummed in pieces. Start with a CRC of 0 and pass
+ * the result of each call into the next. The final value is the same as
+ * calling M_mem_calc_crc32() on all of the data at once.
+ *
+ * \code{.c}
+ *     M_uint32 crc = 0;
+ *
+ *     while ((len = read_chunk(buf, sizeof(buf))) > 0) {
+ *         crc = M_mem_calc_crc32_update(crc, buf, len);
+ *     }
+ * \endcode
+ *
+ * \param[in] crc   CRC of the preceding data. 0 if this is the first piece.
+ * \param[in] s     Pointer to data to perform check on.
+ * \param[in] s_len Size of memory area s.
+ * \return          CRC-32 value of all data so far.
+ */
+M_API M_uint32 M_mem_calc_crc32_update(M_uint32 crc, const void *s, size_t s_len);
+
+
+/*! Calculate a CRC (CRC-32C).
+ *
+ * This is a 32-bit cyclic redundancy check (CRC), using the Castagnoli polynomial
+ * <tt>0x1EDC6F41</tt>. It's used by iSCSI, SCTP, ext4, Btrfs and others. It has
+ * better error detection than CRC-32 and many CPUs can calculate it directly.
+ *
+ * It's calculated using an initial value of 0xFFFFFFFF, and XOR'ing the CRC value by 0xFFFFFFFF after
+ * the computation is done to invert it.
+ *
+ * The SSE4.2 or ARMv8 CRC instructions are used when available, otherwise
+ * a slice-by-8 table implementation is used.
+ *
+ * \param[in] s     Pointer to data to perform check on.
+ * \param[in] s_len Size of memory area s.
+ * \return          CRC-32C value.
+ *
+ * \see M_mem_calc_crc32c_update
+ */
+M_API M_uint32 M_mem_calc_crc32c(const void *s, size_t s_len);
+
+
+/*! Update a running CRC (CRC-32C).
+ *
+ * Start with a CRC of 0 and pass the result of each call into the next.
+ * The final value is the same as calling M_mem_calc_crc32c() on all of the
+ * data at once.
+ *
+ * \param[in] crc   CRC of the preceding data. 0 if this is the first piece.
+ * \param[in] s     Pointer to data to perform check on.
+ * \param[in] s_len Size of memory area s.
+ * \return          CRC-32C value of all data so far.
+ */
+M_API M_uint32 M_mem_calc_crc32c_update(M_uint32 crc, const void *s, size_t s_len);
+
+
 /*! Swap byes between positions.
  *
  * \param[in,out] s     Buffer with data to swap.
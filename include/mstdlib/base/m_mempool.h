@@ -0,0 +1,139 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2026 Monetra Technologies, LLC.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef __M_MEMPOOL_H__
+#define __M_MEMPOOL_H__
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#include <mstdlib/base/m_defs.h>
+#include <mstdlib/base/m_types.h>
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+__BEGIN_DECLS
+
+/*! \addtogroup m_mempool Object Pool
+ *  \ingroup mstdlib_base
+ *
+ * Fixed size object allocator.
+ *
+ * Objects are carved out of larger slabs and freed objects are kept on a free
+ * list to be handed out again. Allocating and freeing an object is a few pointer
+ * operations instead of a call into the system allocator, and objects allocated
+ * together are close together in memory.
+ *
+ * Slabs are only released when the pool is destroyed. A pool holds on to as much
+ * memory as it needed at its peak.
+ *
+ * Objects are zeroed when freed, the same as M_free, and are returned zeroed
+ * when allocated.
+ *
+ * The pool is not thread safe. See M_mempool_concurrent_t for a pool that can
+ * be shared between threads.
+ *
+ * M_llist_t, M_hashtable_t (and the hashtable wrappers) and M_queue_t can use a
+ * pool for their internal nodes by passing their MEMPOOL flag on creation.
+ *
+ * @{
+ */
+
+struct M_mempool;
+typedef struct M_mempool M_mempool_t;
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/*! Create an object pool.
+ *
+ * \param[in] obj_size      Size of each object.
+ * \param[in] objs_per_slab Number of objects allocated at a time. 0 to size slabs at
+ *                          around 4 KB.
+ *
+ * \return Pool. NULL if obj_size is 0.
+ *
+ * \see M_mempool_destroy
+ */
+M_API M_mempool_t *M_mempool_create(size_t obj_size, size_t objs_per_slab) M_MALLOC;
+
+
+/*! Destroy an object pool.
+ *
+ * All objects allocated from the pool are released, even if they haven't been
+ * returned with M_mempool_free().
+ *
+ * \param[in] pool Pool.
+ */
+M_API void M_mempool_destroy(M_mempool_t *pool) M_FREE(1);
+
+
+/*! Allocate an object from a pool.
+ *
+ * \param[in] pool Pool.
+ *
+ * \return Zeroed object suitably aligned for an object of the pool's object size.
+ *         Must be returned with M_mempool_free() and never passed to M_free.
+ */
+M_API void *M_mempool_alloc(M_mempool_t *pool) M_WARN_UNUSED_RESULT M_MALLOC;
+
+
+/*! Return an object to a pool.
+ *
+ * \param[in] pool Pool the object was allocated from.
+ * \param[in] obj  Object. May be NULL.
+ */
+M_API void M_mempool_free(M_mempool_t *pool, void *obj);
+
+
+/*! Size of objects allocated by the pool.
+ *
+ * May be larger than requested due to alignment.
+ *
+ * \param[in] pool Pool.
+ *
+ * \return Object size.
+ */
+M_API size_t M_mempool_obj_size(const M_mempool_t *pool);
+
+
+/*! Number of objects currently allocated from the pool.
+ *
+ * \param[in] pool Pool.
+ *
+ * \return Count.
+ */
+M_API size_t M_mempool_num_used(const M_mempool_t *pool);
+
+
+/*! Number of objects the pool has memory for.
+ *
+ * \param[in] pool Pool.
+ *
+ * \return Count of used and available objects.
+ */
+M_API size_t M_mempool_num_allocated(const M_mempool_t *pool);
+
+/*! @} */
+
+__END_DECLS
+
+#endif /* __M_MEMPOOL_H__ */
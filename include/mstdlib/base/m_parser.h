@@ -55,6 +55,21 @@ typedef struct M_parser M_parser_t;
 typedef M_bool (*M_parser_predicate_func)(unsigned char c);
 
 
+/*! Precompiled character set.
+ *
+ * Holds one bit per byte value and is filled by one of the
+ * M_parser_charset_compile functions. Compiling a set once and passing it to
+ * the _compiled parser functions avoids comparing every byte against every
+ * character in the set and lets the data be checked many bytes at a time.
+ *
+ * Members are internal and should not be accessed directly. This is a plain
+ * structure so it can be placed on the stack or in static storage.
+ */
+typedef struct {
+	M_uint8 map[32];
+} M_parser_charset_t;
+
+
 /*! Flags controlling behavior of the parser. */
 enum M_PARSER_FLAGS {
 	M_PARSER_FLAG_NONE       = 0,      /*!< No Flags. */
@@ -483,6 +498,20 @@ M_API size_t M_parser_truncate_str_until(M_parser_t *parser, const char *pat, M_
  */
 M_API size_t M_parser_truncate_str_charset(M_parser_t *parser, const char *charset);
 
+
+/*! Truncate all bytes matching the given precompiled charset.
+ *
+ * Searches backwards from end to start.
+ *
+ * \param[in,out] parser Parser object.
+ * \param[in]     cs     Compiled character set.
+ *
+ * \return Number of bytes consumed, or 0 if none/error.
+ *
+ * \see M_parser_charset_compile
+ */
+M_API size_t M_parser_truncate_charset_compiled(M_parser_t *parser, const M_parser_charset_t *cs);
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 /*! Consume the given number of bytes.
@@ -659,6 +688,30 @@ M_API size_t M_parser_consume_not_charset(M_parser_t *parser, const unsigned cha
 M_API size_t M_parser_consume_str_not_charset(M_parser_t *parser, const char *charset);
 
 
+/*! Consume all bytes matching the given precompiled charset.
+ *
+ * \param[in,out] parser Parser object.
+ * \param[in]     cs     Compiled character set.
+ *
+ * \return Number of bytes consumed, or 0 if none/error.
+ *
+ * \see M_parser_charset_compile
+ */
+M_API size_t M_parser_consume_charset_compiled(M_parser_t *parser, const M_parser_charset_t *cs);
+
+
+/*! Consume all bytes not matching the given precompiled charset.
+ *
+ * \param[in,out] parser Parser object.
+ * \param[in]     cs     Compiled character set.
+ *
+ * \return Number of bytes consumed, or 0 if none/error.
+ *
+ * \see M_parser_charset_compile
+ */
+M_API size_t M_parser_consume_not_charset_compiled(M_parser_t *parser, const M_parser_charset_t *cs);
+
+
 /*! Consume all bytes until and including the next end of line.
  *
  * Useful for ignoring data until end of single-line comment. If there is no new line, will consume all remaining data.
@@ -848,6 +901,34 @@ M_API size_t M_parser_read_bytes_charset(M_parser_t *parser, const unsigned char
 M_API size_t M_parser_read_bytes_not_charset(M_parser_t *parser, const unsigned char *charset, size_t charset_len, unsigned char *buf, size_t buf_len);
 
 
+/*! Read bytes (binary) from the buffer for as long as they match the precompiled charset and advance.
+ *
+ * \param[in,out] parser  Parser object.
+ * \param[in]     cs      Compiled character set.
+ * \param[out]    buf     Buffer to store result.
+ * \param[in]     buf_len Length of buffer to store result.
+ *
+ * \return Length of data read, or 0 on error.
+ *
+ * \see M_parser_charset_compile
+ */
+M_API size_t M_parser_read_bytes_charset_compiled(M_parser_t *parser, const M_parser_charset_t *cs, unsigned char *buf, size_t buf_len);
+
+
+/*! Read bytes (binary) from the buffer for as long as they do not match the precompiled charset and advance.
+ *
+ * \param[in,out] parser  Parser object.
+ * \param[in]     cs      Compiled character set.
+ * \param[out]    buf     Buffer to store result.
+ * \param[in]     buf_len Length of buffer to store result.
+ *
+ * \return Length of data read, or 0 on error.
+ *
+ * \see M_parser_charset_compile
+ */
+M_API size_t M_parser_read_bytes_not_charset_compiled(M_parser_t *parser, const M_parser_charset_t *cs, unsigned char *buf, size_t buf_len);
+
+
 /*! Read bytes (binary) from the current buffer as long as the bytes match the
  * provided predicate, output in the user-provided buffer and advance.
  *
@@ -1126,6 +1207,34 @@ M_API char *M_parser_read_strdup_charset(M_parser_t *parser, const char *charset
 M_API char *M_parser_read_strdup_not_charset(M_parser_t *parser, const char *charset);
 
 
+/*! Read data from the buffer for as long as it matches the precompiled charset and advance.
+ *
+ * Put the resulting bytes in a newly allocated buffer.
+ *
+ * \param[in,out] parser Parser object.
+ * \param[in]     cs     Compiled character set.
+ *
+ * \return NULL-terminated result buffer, or NULL on error.
+ *
+ * \see M_parser_charset_compile
+ */
+M_API char *M_parser_read_strdup_charset_compiled(M_parser_t *parser, const M_parser_charset_t *cs);
+
+
+/*! Read data from the buffer for as long as it does not match the precompiled charset and advance.
+ *
+ * Put the resulting bytes in a newly allocated buffer.
+ *
+ * \param[in,out] parser Parser object.
+ * \param[in]     cs     Compiled character set.
+ *
+ * \return NULL-terminated result buffer, or NULL on error.
+ *
+ * \see M_parser_charset_compile
+ */
+M_API char *M_parser_read_strdup_not_charset_compiled(M_parser_t *parser, const M_parser_charset_t *cs);
+
+
 /*! Read data from the buffer for as long as it matches the given predicate function and advance.
  *
  * Put the resulting bytes in a newly allocated buffer.
@@ -1304,6 +1413,32 @@ M_API size_t M_parser_read_buf_charset(M_parser_t *parser, M_buf_t *buf, const u
 M_API size_t M_parser_read_buf_not_charset(M_parser_t *parser, M_buf_t *buf, const unsigned char *charset, size_t charset_len);
 
 
+/*! Read data from the buffer for as long as it matches the precompiled charset and advance.
+ *
+ * \param[in,out] parser Parser object.
+ * \param[out]    buf    Buffer to store result.
+ * \param[in]     cs     Compiled character set.
+ *
+ * \return Length of data read, or 0 on error.
+ *
+ * \see M_parser_charset_compile
+ */
+M_API size_t M_parser_read_buf_charset_compiled(M_parser_t *parser, M_buf_t *buf, const M_parser_charset_t *cs);
+
+
+/*! Read data from the buffer for as long as it does not match the precompiled charset and advance.
+ *
+ * \param[in,out] parser Parser object.
+ * \param[out]    buf    Buffer to store result.
+ * \param[in]     cs     Compiled character set.
+ *
+ * \return Length of data read, or 0 on error.
+ *
+ * \see M_parser_charset_compile
+ */
+M_API size_t M_parser_read_buf_not_charset_compiled(M_parser_t *parser, M_buf_t *buf, const M_parser_charset_t *cs);
+
+
 /*! Read bytes (binary) from the current buffer as long as the bytes match the
  * provided predicate, output in the user-provided buffer and advance.
  *
@@ -1615,6 +1750,79 @@ M_API M_bool M_parser_is_not_charset(const M_parser_t *parser, size_t len, const
 M_API M_bool M_parser_is_not_str_charset(const M_parser_t *parser, size_t len, const char *charset);
 
 
+/*! Validate the parser matches the given precompiled charset.
+ *
+ * \param[in] parser Parser object.
+ * \param[in] len    Length to validate. If larger than the parser length the parser length is used.
+ * \param[in] cs     Compiled character set.
+ *
+ * \return M_TRUE if matching. Otherwise M_FALSE. If parser is NULL, len is 0, or cs is NULL, this will return M_FALSE.
+ */
+M_API M_bool M_parser_is_charset_compiled(const M_parser_t *parser, size_t len, const M_parser_charset_t *cs);
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/*! Compile a character set for use with the _compiled parser functions.
+ *
+ * \param[out] cs          Compiled character set.
+ * \param[in]  charset     Character set. May be NULL if charset_len is 0.
+ * \param[in]  charset_len Length of given character set.
+ *
+ * \see M_parser_charset_add
+ */
+M_API void M_parser_charset_compile(M_parser_charset_t *cs, const unsigned char *charset, size_t charset_len);
+
+
+/*! Compile a NULL-terminated character set for use with the _compiled parser functions.
+ *
+ * \param[out] cs      Compiled character set.
+ * \param[in]  charset Character set.
+ */
+M_API void M_parser_charset_compile_str(M_parser_charset_t *cs, const char *charset);
+
+
+/*! Compile the bytes matching a predicate function into a character set.
+ *
+ * The function is called once for each of the 256 byte values. It can be
+ * used in place of the _predicate parser functions when the same predicate
+ * is used repeatedly on large amounts of data.
+ *
+ * \param[out] cs   Compiled character set.
+ * \param[in]  func Predicate function.
+ */
+M_API void M_parser_charset_compile_predicate(M_parser_charset_t *cs, M_parser_predicate_func func);
+
+
+/*! Compile the bytes matching a chr predicate function into a character set.
+ *
+ * \param[out] cs   Compiled character set.
+ * \param[in]  func Predicate function.
+ *
+ * \see M_parser_charset_compile_predicate
+ */
+M_API void M_parser_charset_compile_chr_predicate(M_parser_charset_t *cs, M_chr_predicate_func func);
+
+
+/*! Add bytes to a compiled character set.
+ *
+ * \param[in,out] cs          Compiled character set.
+ * \param[in]     charset     Characters to add.
+ * \param[in]     charset_len Length of characters to add.
+ */
+M_API void M_parser_charset_add(M_parser_charset_t *cs, const unsigned char *charset, size_t charset_len);
+
+
+/*! Check if a byte is part of a compiled character set.
+ *
+ * \param[in] cs Compiled character set.
+ * \param[in] c  Byte to check.
+ *
+ * \return M_TRUE if the byte is in the set.
+ */
+M_API M_bool M_parser_charset_contains(const M_parser_charset_t *cs, unsigned char c);
+
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 /*! Split the data in the parser object by the delimiter specified into
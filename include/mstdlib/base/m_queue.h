@@ -77,6 +77,14 @@ struct M_queue_foreach;
 /*! Data type used for enumeration of a queue */
 typedef struct M_queue_foreach M_queue_foreach_t;
 
+/*! Flags for controlling the behavior of the queue. */
+typedef enum {
+	M_QUEUE_NONE    = 0,      /*!< Default. */
+	M_QUEUE_MEMPOOL = 1 << 0  /*!< Allocate internal list and lookup nodes from pools owned by the queue.
+	                               Node memory is kept for reuse until the queue is destroyed. Reduces
+	                               allocator calls for queues with frequent inserts and removes. */
+} M_queue_flags_t;
+
 /*! Create a queue (list of objects) that stores user-provided pointers.  The pointers
  *  stored may be kept in insertion order or sorted, depending on how the queue is
  *  initialized.
@@ -92,6 +100,17 @@ typedef struct M_queue_foreach M_queue_foreach_t;
 M_API M_queue_t *M_queue_create(M_sort_compar_t sort_cb, void (*free_cb)(void *));
 
 
+/*! Create a queue with flags.
+ *
+ * \param sort_cb See M_queue_create().
+ * \param free_cb See M_queue_create().
+ * \param flags   M_queue_flags_t flags.
+ * \return Allocated M_queue_t * on success that should be free'd with M_queue_destroy(),
+ *         otherwise NULL.
+ */
+M_API M_queue_t *M_queue_create_ex(M_sort_compar_t sort_cb, void (*free_cb)(void *), M_uint32 flags);
+
+
 /*! Destroy's an initialized M_queue_t * object.
  * \param queue Initialized queue object returned by M_queue_create()
  */
@@ -28,6 +28,7 @@
 
 #include <mstdlib/base/m_defs.h>
 #include <mstdlib/base/m_types.h>
+#include <mstdlib/base/m_endian.h>
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
@@ -72,6 +73,24 @@ typedef enum {
 M_API M_bool M_utf8_is_valid(const char *str, const char **endptr);
 
 
+/*! Check if a given length of data is valid utf-8 encoded.
+ *
+ * Unlike M_utf8_is_valid the data does not need to be NULL terminated and
+ * a NULL byte is treated as a valid character.
+ *
+ * Validation is vectorized when the CPU supports it and runs a block at a time
+ * over ascii and multi-byte sequences alike.
+ *
+ * \param[in]  str    utf-8 data.
+ * \param[in]  len    Length of str in bytes.
+ * \param[out] endptr On success, will be set to str + len.
+ *                    On error, will be set to the character that caused the failure.
+ *
+ * \return M_TRUE if str is a valid utf-8 sequence. Otherwise, M_FALSE.
+ */
+M_API M_bool M_utf8_is_valid_len(const char *str, size_t len, const char **endptr);
+
+
 /*! Check if a given code point is valid for utf-8.
  *
  * \param[in] cp Code point.
@@ -94,6 +113,64 @@ M_API M_bool M_utf8_is_valid_cp(M_uint32 cp);
 M_API size_t M_utf8_cnt(const char *str);
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/*! Convert utf-8 to utf-16.
+ *
+ * The input is validated while converting. Characters outside of the
+ * Basic Multilingual Plane are written as surrogate pairs. No byte order
+ * mark is written.
+ *
+ * \param[in]     str        utf-8 data.
+ * \param[in]     len        Length of str in bytes.
+ * \param[in]     endianness Byte order of the output code units.
+ * \param[in,out] buf        Buffer to append the utf-16 data to. Not modified on error.
+ *
+ * \return Result.
+ */
+M_API M_utf8_error_t M_utf8_to_utf16_buf(const char *str, size_t len, M_endian_t endianness, M_buf_t *buf);
+
+
+/*! Convert utf-8 to utf-32.
+ *
+ * \param[in]     str        utf-8 data.
+ * \param[in]     len        Length of str in bytes.
+ * \param[in]     endianness Byte order of the output code units.
+ * \param[in,out] buf        Buffer to append the utf-32 data to. Not modified on error.
+ *
+ * \return Result.
+ */
+M_API M_utf8_error_t M_utf8_to_utf32_buf(const char *str, size_t len, M_endian_t endianness, M_buf_t *buf);
+
+
+/*! Convert utf-16 to utf-8.
+ *
+ * Unpaired surrogates and code points that are not valid for utf-8 are an
+ * error. A byte order mark is not interpreted and is converted like any other
+ * character.
+ *
+ * \param[in,out] buf        Buffer to append the utf-8 data to. Not modified on error.
+ * \param[in]     data       utf-16 data.
+ * \param[in]     len        Length of data in bytes. Must be a multiple of 2.
+ * \param[in]     endianness Byte order of the input code units.
+ *
+ * \return Result.
+ */
+M_API M_utf8_error_t M_utf8_from_utf16_buf(M_buf_t *buf, const unsigned char *data, size_t len, M_endian_t endianness);
+
+
+/*! Convert utf-32 to utf-8.
+ *
+ * \param[in,out] buf        Buffer to append the utf-8 data to. Not modified on error.
+ * \param[in]     data       utf-32 data.
+ * \param[in]     len        Length of data in bytes. Must be a multiple of 4.
+ * \param[in]     endianness Byte order of the input code units.
+ *
+ * \return Result.
+ */
+M_API M_utf8_error_t M_utf8_from_utf32_buf(M_buf_t *buf, const unsigned char *data, size_t len, M_endian_t endianness);
+
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 /*! Read a utf-8 sequence as a code point.
@@ -30,6 +30,7 @@
 #include <mstdlib/base/m_types.h>
 #include <mstdlib/base/m_buf.h>
 #include <mstdlib/base/m_list_str.h>
+#include <mstdlib/base/m_fs.h>
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
@@ -351,6 +352,172 @@ M_API void M_csv_output_rows_buf(M_buf_t *buf, const M_csv_t *csv, M_list_str_t
 
 /*! @} */
 
+
+/*! \addtogroup m_csv_reader CSV Streaming Reader
+ *  \ingroup m_csv
+ *
+ * Read CSV data one row at a time.
+ *
+ * M_csv_parse() needs all of the data at once and keeps every row in memory.
+ * The streaming reader is given data in chunks of any size and returns each
+ * row as soon as it is complete. Only the row currently being read is kept,
+ * so memory use depends on the length of the longest row, not the size of
+ * the data. Quoted cells can span multiple chunks.
+ *
+ * Cells are handled the same way as M_csv_parse(). Cells are returned as
+ * pointers into the reader's buffer. They are NULL terminated and quoting
+ * is removed in place so nothing is copied. Unlike M_csv_parse() rows are
+ * returned with the number of cells they contain and the first row is not
+ * treated differently.
+ *
+ * Cells are only valid until the next call to M_csv_reader_next_row(),
+ * M_csv_reader_feed() or M_csv_reader_feed_file().
+ *
+ * Example:
+ *
+ * \code{.c}
+ *     M_csv_reader_t        *reader;
+ *     M_csv_reader_result_t  res;
+ *     char                   buf[8192];
+ *     size_t                 len;
+ *     size_t                 i;
+ *
+ *     reader = M_csv_reader_create(',', '"', M_CSV_FLAG_NONE);
+ *     do {
+ *         len = read_more(buf, sizeof(buf));
+ *         if (len == 0) {
+ *             M_csv_reader_finish(reader);
+ *         } else {
+ *             M_csv_reader_feed(reader, buf, len);
+ *         }
+ *
+ *         while ((res = M_csv_reader_next_row(reader)) == M_CSV_READER_ROW) {
+ *             for (i=0; i<M_csv_reader_num_cells(reader); i++) {
+ *                 M_printf("%s%s", i==0?"":" | ", M_csv_reader_cell(reader, i, NULL));
+ *             }
+ *             M_printf("\n");
+ *         }
+ *     } while (res == M_CSV_READER_NEED_MORE);
+ *
+ *     M_csv_reader_destroy(reader);
+ * \endcode
+ *
+ * @{
+ */
+
+struct M_csv_reader;
+typedef struct M_csv_reader M_csv_reader_t;
+
+/*! Result of reading a row. */
+typedef enum {
+	M_CSV_READER_ROW = 0,   /*!< A row was read. */
+	M_CSV_READER_NEED_MORE, /*!< More data is needed to complete the next row. */
+	M_CSV_READER_DONE       /*!< M_csv_reader_finish() was called and all rows have been read. */
+} M_csv_reader_result_t;
+
+
+/*! Create a streaming CSV reader.
+ *
+ * \param[in] delim CSV delimiter character. Typically comma (",").
+ * \param[in] quote CSV quote character. Typically double quote (""").
+ * \param[in] flags Flags controlling parse behavior. From M_CSV_FLAGS.
+ *
+ * \return Object.
+ */
+M_API M_csv_reader_t *M_csv_reader_create(char delim, char quote, M_uint32 flags) M_MALLOC;
+
+
+/*! Destroy a streaming CSV reader.
+ *
+ * \param[in] reader Reader.
+ */
+M_API void M_csv_reader_destroy(M_csv_reader_t *reader) M_FREE(1);
+
+
+/*! Reset a reader so it can read other data.
+ *
+ * All unread data is dropped. Internal buffers are kept for reuse.
+ *
+ * \param[in] reader Reader.
+ */
+M_API void M_csv_reader_reset(M_csv_reader_t *reader);
+
+
+/*! Add data.
+ *
+ * The data is copied.
+ *
+ * \param[in] reader Reader.
+ * \param[in] data   Data.
+ * \param[in] len    Length of data.
+ */
+M_API void M_csv_reader_feed(M_csv_reader_t *reader, const char *data, size_t len);
+
+
+/*! Add data read from a file.
+ *
+ * Reads directly into the reader's buffer. M_csv_reader_finish() needs to be
+ * called when read_len is 0 and the end of the file has been reached.
+ *
+ * \param[in]  reader    Reader.
+ * \param[in]  fd        File to read from.
+ * \param[in]  read_size Maximum number of bytes to read. 0 to use the default of 64 KB.
+ * \param[out] read_len  Number of bytes read. Optional, pass NULL if not needed.
+ *
+ * \return Result of reading the file.
+ */
+M_API M_fs_error_t M_csv_reader_feed_file(M_csv_reader_t *reader, M_fs_file_t *fd, size_t read_size, size_t *read_len);
+
+
+/*! Signal there is no more data.
+ *
+ * The last row does not need to end with a new line. It is returned by
+ * M_csv_reader_next_row() once no more data is coming.
+ *
+ * \param[in] reader Reader.
+ */
+M_API void M_csv_reader_finish(M_csv_reader_t *reader);
+
+
+/*! Read the next row.
+ *
+ * \param[in] reader Reader.
+ *
+ * \return Result.
+ */
+M_API M_csv_reader_result_t M_csv_reader_next_row(M_csv_reader_t *reader);
+
+
+/*! Number of cells in the row that was read.
+ *
+ * \param[in] reader Reader.
+ *
+ * \return Count.
+ */
+M_API size_t M_csv_reader_num_cells(const M_csv_reader_t *reader);
+
+
+/*! Get a cell from the row that was read.
+ *
+ * \param[in]  reader Reader.
+ * \param[in]  idx    Index of the cell.
+ * \param[out] len    Length of the cell. Optional, pass NULL if not needed.
+ *
+ * \return NULL terminated cell or NULL if the cell is empty and was not quoted.
+ */
+M_API const char *M_csv_reader_cell(const M_csv_reader_t *reader, size_t idx, size_t *len);
+
+
+/*! Number of rows that have been read.
+ *
+ * \param[in] reader Reader.
+ *
+ * \return Count.
+ */
+M_API size_t M_csv_reader_num_rows(const M_csv_reader_t *reader);
+
+/*! @} */
+
 __END_DECLS
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
@@ -32,6 +32,7 @@
 #include <mstdlib/base/m_hash_multi.h>
 #include <mstdlib/base/m_parser.h>
 #include <mstdlib/base/m_buf.h>
+#include <mstdlib/base/m_arena.h>
 #include <mstdlib/text/m_textcodec.h>
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
@@ -712,6 +713,29 @@ M_API M_http_reader_t *M_http_reader_create(struct M_http_reader_callbacks *cbs,
 M_API void M_http_reader_destroy(M_http_reader_t *httpr);
 
 
+/*! Allocate temporary strings from an arena.
+ *
+ * The start line, header and trailer strings passed to callbacks are normally
+ * allocated and freed for every header. When an arena is set they are allocated
+ * from the arena instead and are not released until the arena is reset or
+ * destroyed. This avoids a large number of small allocations when processing a
+ * high volume of messages.
+ *
+ * Only these temporary strings use the arena. Body and chunk data is passed to
+ * callbacks directly from the input buffer, and anything the callbacks store,
+ * such as the headers and body kept by M_http_simple_read(), is heap allocated
+ * as usual.
+ *
+ * The arena must not be reset from within a callback. Typically it is reset
+ * after M_http_reader_read() returns and the message is complete. Header size
+ * limits bound the amount of arena memory used per message.
+ *
+ * \param[in] httpr Http reader object.
+ * \param[in] arena Arena. NULL to stop using an arena.
+ */
+M_API void M_http_reader_set_arena(M_http_reader_t *httpr, M_arena_t *arena);
+
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 /*! Parse http message from given data.
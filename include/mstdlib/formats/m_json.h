@@ -30,6 +30,8 @@
 #include <mstdlib/base/m_types.h>
 #include <mstdlib/base/m_list_str.h>
 #include <mstdlib/base/m_fs.h>
+#include <mstdlib/base/m_arena.h>
+#include <mstdlib/base/m_buf.h>
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
@@ -55,6 +57,31 @@ __BEGIN_DECLS
  * Not supported are features considered redundant or potential
  * security risks (script expressions).
  *
+ * The SAX reader (M_json_sax_feed()) and the tape reader (M_json_tape_read())
+ * are stricter than M_json_read() and report some malformed documents with a
+ * different error:
+ *
+ * - Array elements and object members must be separated by a comma.
+ *   M_json_read() accepts `[1 2]`, `[-3[2]]` and `{"a":1 "b":2}`, these
+ *   readers fail with M_JSON_ERROR_ARRAY_UNEXPECTED_CHAR or
+ *   M_JSON_ERROR_OBJECT_UNEXPECTED_CHAR.
+ * - Closing a container with the wrong bracket, such as `[1}`, is
+ *   M_JSON_ERROR_ARRAY_UNEXPECTED_CHAR or M_JSON_ERROR_OBJECT_UNEXPECTED_CHAR
+ *   instead of M_JSON_ERROR_INVALID_IDENTIFIER or
+ *   M_JSON_ERROR_INVALID_PAIR_START.
+ * - Data that ends inside an array or object is M_JSON_ERROR_UNCLOSED_ARRAY
+ *   or M_JSON_ERROR_UNCLOSED_OBJECT. M_json_read() reports what it expected
+ *   next, for example M_JSON_ERROR_MISSING_PAIR_SEPARATOR for `[{"a"` and
+ *   M_JSON_ERROR_EXPECTED_VALUE for `[1,`. An unterminated string is
+ *   M_JSON_ERROR_UNCLOSED_STRING for all of them.
+ * - A missing value after a key, `{"a":}`, is M_JSON_ERROR_EXPECTED_VALUE
+ *   instead of M_JSON_ERROR_INVALID_IDENTIFIER.
+ * - A document that does not start with an object or array is
+ *   M_JSON_ERROR_INVALID_START, even if the value itself is malformed.
+ *
+ * How malformed numbers and literals are reported differs by reader and is
+ * described with each of them.
+ *
  * Example:
  *
  * \code{.c}
@@ -94,6 +121,10 @@ __BEGIN_DECLS
 struct M_json_node;
 typedef struct M_json_node M_json_node_t;
 
+struct M_json_jsonpath;
+/*! Compiled JSONPath expression. */
+typedef struct M_json_jsonpath M_json_jsonpath_t;
+
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
@@ -216,6 +247,40 @@ M_API void M_json_node_destroy(M_json_node_t *node) M_FREE(1);
 M_API M_json_node_t *M_json_read(const char *data, size_t data_len, M_uint32 flags, size_t *processed_len, M_json_error_t *error, size_t *error_line, size_t *error_pos) M_MALLOC;
 
 
+/*! Parse a string into a JSON object allocating the nodes from an arena.
+ *
+ * Nodes, object and array storage, object keys and string values are all
+ * allocated from the arena which avoids a large number of small allocations
+ * when parsing big documents. A single M_arena_reset() or M_arena_destroy()
+ * releases the whole document. M_json_node_destroy() does not free anything for
+ * an arena node and does not need to be called. The memory used by a document
+ * that fails to parse stays in the arena until it's reset.
+ *
+ * Nodes added using the M_json_object_insert_* and M_json_array_insert_*
+ * functions, and string values set on an arena node, are allocated from the
+ * same arena. A node can only be inserted into a node from the same arena, or
+ * into a non-arena node if it isn't from an arena either.
+ *
+ * Every node from the arena, including one that has been taken out of the tree
+ * with M_json_take_from_parent(), is invalid once the arena is reset or destroyed.
+ *
+ * \param[in]  arena         Arena to allocate nodes from. If NULL this is the same as M_json_read.
+ * \param[in]  data          The data to parse.
+ * \param[in]  data_len      The length of the data to parse.
+ * \param[in]  flags         M_json_reader_flags_t flags to control the behavior of the reader.
+ * \param[out] processed_len Length of data processed. Optional pass NULL if not needed.
+ * \param[out] error         On error this will be populated with an error reason. Optional, pass NULL if not needed.
+ * \param[out] error_line    The line the error occurred. Optional, pass NULL if not needed.
+ * \param[out] error_pos     The column the error occurred if error_line is not NULL, otherwise the position
+ *                           in the stream the error occurred. Optional, pass NULL if not needed.
+ *
+ * \return The root JSON node of the parsed data, or NULL on error.
+ *
+ * \see M_json_read
+ */
+M_API M_json_node_t *M_json_read_arena(M_arena_t *arena, const char *data, size_t data_len, M_uint32 flags, size_t *processed_len, M_json_error_t *error, size_t *error_line, size_t *error_pos) M_MALLOC;
+
+
 /*! Parse a file into a JSON object.
  *
  * \param[in]  path       The file to read.
@@ -231,6 +296,587 @@ M_API M_json_node_t *M_json_read(const char *data, size_t data_len, M_uint32 fla
 M_API M_json_node_t *M_json_read_file(const char *path, M_uint32 flags, size_t max_read, M_json_error_t *error, size_t *error_line, size_t *error_pos) M_MALLOC;
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/*! \addtogroup m_json_sax JSON SAX Reader
+ *  \ingroup m_json
+ *
+ * Event based reader that does not build a node tree.
+ *
+ * Data is passed to the reader in chunks as it becomes available. Chunks can
+ * be split anywhere, including in the middle of a string, number or escape.
+ * Callbacks are called as each part of the document is read. Memory use is
+ * bounded by the nesting depth and the length of the longest string in the
+ * document instead of the size of the document.
+ *
+ * Callbacks return M_JSON_ERROR_SUCCESS to continue. Any other value stops
+ * processing and is returned by M_json_sax_feed(). All callbacks are optional.
+ * Strings passed to callbacks are NULL terminated and are only valid for the
+ * duration of the callback. They can contain embedded NULL characters if the
+ * document has \u0000 escapes so the length should be used.
+ *
+ * The same flags as M_json_read() are supported. Malformed documents are
+ * rejected as described in the JSON module. There is no processed length so
+ * anything other than whitespace and comments after the root is
+ * M_JSON_ERROR_EXPECTED_END. Empty input is M_JSON_ERROR_UNEXPECTED_END
+ * instead of M_JSON_ERROR_MISUSE.
+ *
+ * Malformed numbers and literals are M_JSON_ERROR_INVALID_NUMBER,
+ * M_JSON_ERROR_INVALID_BOOL or M_JSON_ERROR_INVALID_NULL, reported at the
+ * character that made them invalid. This includes extra characters after a
+ * valid value, such as `1.2.3` or `trueq`, which M_json_read() reports as
+ * M_JSON_ERROR_INVALID_IDENTIFIER. A literal cut off by the end of the data,
+ * such as `[tru`, is M_JSON_ERROR_UNCLOSED_ARRAY or
+ * M_JSON_ERROR_UNCLOSED_OBJECT.
+ *
+ * Example:
+ *
+ * \code{.c}
+ *     static M_json_error_t key_cb(const char *key, size_t len, void *thunk)
+ *     {
+ *         M_printf("key: %s\n", key);
+ *         return M_JSON_ERROR_SUCCESS;
+ *     }
+ *
+ *     struct M_json_sax_callbacks cbs;
+ *     M_json_sax_t               *sax;
+ *     M_json_error_t              res;
+ *     char                        buf[8192];
+ *     size_t                      len;
+ *
+ *     M_mem_set(&cbs, 0, sizeof(cbs));
+ *     cbs.key_func = key_cb;
+ *
+ *     sax = M_json_sax_create(&cbs, M_JSON_READER_NONE, NULL);
+ *     do {
+ *         len = read_more(buf, sizeof(buf));
+ *         res = M_json_sax_feed(sax, buf, len);
+ *     } while (len != 0 && res == M_JSON_ERROR_SUCCESS);
+ *     if (res == M_JSON_ERROR_SUCCESS)
+ *         res = M_json_sax_finish(sax);
+ *     M_json_sax_destroy(sax);
+ * \endcode
+ *
+ * @{
+ */
+
+struct M_json_sax;
+typedef struct M_json_sax M_json_sax_t;
+
+/*! Function definition for the start or end of an object or array.
+ *
+ * \param[in] thunk Thunk.
+ *
+ * \return Result.
+ */
+typedef M_json_error_t (*M_json_sax_container_func)(void *thunk);
+
+/*! Function definition for an object key or a string value.
+ *
+ * \param[in] str   NULL terminated string with escapes decoded.
+ * \param[in] len   Length of the string.
+ * \param[in] thunk Thunk.
+ *
+ * \return Result.
+ */
+typedef M_json_error_t (*M_json_sax_string_func)(const char *str, size_t len, void *thunk);
+
+/*! Function definition for an integer value.
+ *
+ * \param[in] val   Value.
+ * \param[in] thunk Thunk.
+ *
+ * \return Result.
+ */
+typedef M_json_error_t (*M_json_sax_int_func)(M_int64 val, void *thunk);
+
+/*! Function definition for a decimal value.
+ *
+ * \param[in] val   Value.
+ * \param[in] thunk Thunk.
+ *
+ * \return Result.
+ */
+typedef M_json_error_t (*M_json_sax_decimal_func)(const M_decimal_t *val, void *thunk);
+
+/*! Function definition for a bool value.
+ *
+ * \param[in] val   Value.
+ * \param[in] thunk Thunk.
+ *
+ * \return Result.
+ */
+typedef M_json_error_t (*M_json_sax_bool_func)(M_bool val, void *thunk);
+
+/*! Function definition for a null value.
+ *
+ * \param[in] thunk Thunk.
+ *
+ * \return Result.
+ */
+typedef M_json_error_t (*M_json_sax_null_func)(void *thunk);
+
+
+/*! Callbacks for events while reading. */
+struct M_json_sax_callbacks {
+	M_json_sax_container_func object_start_func;
+	M_json_sax_container_func object_end_func;
+	M_json_sax_container_func array_start_func;
+	M_json_sax_container_func array_end_func;
+	M_json_sax_string_func    key_func;
+	M_json_sax_string_func    value_string_func;
+	M_json_sax_int_func       value_int_func;
+	M_json_sax_decimal_func   value_decimal_func;
+	M_json_sax_bool_func      value_bool_func;
+	M_json_sax_null_func      value_null_func;
+};
+
+
+/*! Create a SAX reader.
+ *
+ * \param[in] cbs   Callbacks. Copied, does not need to persist.
+ * \param[in] flags M_json_reader_flags_t flags to control the behavior of the reader.
+ * \param[in] thunk Thunk passed to callbacks.
+ *
+ * \return Object.
+ */
+M_API M_json_sax_t *M_json_sax_create(const struct M_json_sax_callbacks *cbs, M_uint32 flags, void *thunk) M_MALLOC;
+
+
+/*! Destroy a SAX reader.
+ *
+ * \param[in] sax SAX reader.
+ */
+M_API void M_json_sax_destroy(M_json_sax_t *sax) M_FREE(1);
+
+
+/*! Reset a SAX reader so it can read another document.
+ *
+ * Clears any error and all state. Internal buffers are kept for reuse.
+ *
+ * \param[in] sax SAX reader.
+ */
+M_API void M_json_sax_reset(M_json_sax_t *sax);
+
+
+/*! Process more data.
+ *
+ * All data is consumed unless an error occurs. Only whitespace and comments
+ * are allowed after the root object or array has been closed.
+ *
+ * Errors are sticky. Once an error has been returned every following call
+ * returns the same error until the reader is reset.
+ *
+ * \param[in] sax      SAX reader.
+ * \param[in] data     Data.
+ * \param[in] data_len Length of data.
+ *
+ * \return M_JSON_ERROR_SUCCESS if the data was valid so far. Otherwise an error.
+ *
+ * \see M_json_sax_position
+ */
+M_API M_json_error_t M_json_sax_feed(M_json_sax_t *sax, const char *data, size_t data_len);
+
+
+/*! Signal there is no more data.
+ *
+ * Verifies the document was complete.
+ *
+ * \param[in] sax SAX reader.
+ *
+ * \return M_JSON_ERROR_SUCCESS if a complete document was read. Otherwise an error
+ *         such as M_JSON_ERROR_UNCLOSED_OBJECT.
+ */
+M_API M_json_error_t M_json_sax_finish(M_json_sax_t *sax);
+
+
+/*! Current nesting depth.
+ *
+ * \param[in] sax SAX reader.
+ *
+ * \return Number of open objects and arrays.
+ */
+M_API size_t M_json_sax_depth(const M_json_sax_t *sax);
+
+
+/*! Current position in the data.
+ *
+ * After an error this is the location of the error.
+ *
+ * \param[in]  sax  SAX reader.
+ * \param[out] line The current line. Optional, pass NULL if not needed.
+ * \param[out] pos  The column if line is not NULL, otherwise the number of bytes
+ *                  processed. Optional, pass NULL if not needed.
+ */
+M_API void M_json_sax_position(const M_json_sax_t *sax, size_t *line, size_t *pos);
+
+/*! @} */
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/*! \addtogroup m_json_tape JSON Tape
+ *  \ingroup m_json
+ *
+ * Compact read only document.
+ *
+ * The entire document is stored as a single array of nodes in document order
+ * along with one copy of the data. Strings point into the copy of the data
+ * and escapes are only decoded the first time a string is accessed. Reading a
+ * document only needs a handful of allocations no matter how large it is.
+ * This is much faster than M_json_read() for large documents that only need
+ * to be read.
+ *
+ * The data is first scanned with SIMD instructions (SSE2, AVX2 or NEON
+ * depending on the CPU) to find every structural character, string and
+ * value. Parsing then only visits those positions and never walks through
+ * whitespace or the contents of strings that have no escapes. Documents that
+ * contain comments, or that fail to parse, are handled a byte at a time so
+ * errors and their positions are the same either way.
+ *
+ * M_json_tape_read() takes the same flags as M_json_read() and handles
+ * processed_len the same way. Malformed documents are rejected as described
+ * in the JSON module. Extra characters after a valid number or literal, such as
+ * `1.2.3` or `trueq`, are M_JSON_ERROR_ARRAY_UNEXPECTED_CHAR or
+ * M_JSON_ERROR_OBJECT_UNEXPECTED_CHAR instead of
+ * M_JSON_ERROR_INVALID_IDENTIFIER. Numbers and literals that are invalid from
+ * the start are reported the same as by M_json_read().
+ *
+ * The M_json_tape_* accessors behave the same as their M_json_* counterparts.
+ * jsonpath searches use the same syntax and return the same matches as
+ * M_json_jsonpath(). M_json_tape_to_node() can be used to convert all or
+ * part of a document to M_json_node_t for use with the rest of the JSON API.
+ *
+ * Looking up object keys is a linear search. Reading the values of an object
+ * in the order they appear in the document or reading array elements in order
+ * is fast because the position of the last access is remembered.
+ *
+ * Nodes are owned by the tape and are valid until the tape is destroyed.
+ * Accessing nodes can modify the tape (strings are decoded in place and
+ * access positions are remembered) so a tape must not be accessed by multiple
+ * threads at the same time.
+ *
+ * @{
+ */
+
+struct M_json_tape;
+typedef struct M_json_tape M_json_tape_t;
+
+struct M_json_tape_node;
+typedef struct M_json_tape_node M_json_tape_node_t;
+
+
+/*! Parse a string into a tape.
+ *
+ * \param[in]  data          The data to parse. Copied, does not need to persist.
+ * \param[in]  data_len      The length of the data to parse.
+ * \param[in]  flags         M_json_reader_flags_t flags to control the behavior of the reader.
+ * \param[out] processed_len Length of data processed. Useful if you could have multiple JSON documents
+ *                           in a stream. Optional pass NULL if not needed.
+ * \param[out] error         On error this will be populated with an error reason. Optional, pass NULL if not needed.
+ * \param[out] error_line    The line the error occurred. Optional, pass NULL if not needed.
+ * \param[out] error_pos     The column the error occurred if error_line is not NULL, otherwise the position
+ *                           in the stream the error occurred. Optional, pass NULL if not needed.
+ *
+ * \return Tape, or NULL on error.
+ *
+ * \see M_json_read
+ */
+M_API M_json_tape_t *M_json_tape_read(const char *data, size_t data_len, M_uint32 flags, size_t *processed_len, M_json_error_t *error, size_t *error_line, size_t *error_pos) M_MALLOC;
+
+
+/*! Parse a file into a tape.
+ *
+ * The file data is used directly by the tape and is not copied.
+ *
+ * \param[in]  path       The file to read.
+ * \param[in]  flags      M_json_reader_flags_t flags to control the behavior of the reader.
+ * \param[in]  max_read   The maximum number of bytes to read from the file. Optional pass 0 to read all data.
+ * \param[out] error      On error this will be populated with an error reason. Optional, pass NULL if not needed.
+ * \param[out] error_line The line the error occurred. Optional, pass NULL if not needed.
+ * \param[out] error_pos  The column the error occurred if error_line is not NULL, otherwise the position
+ *                        in the stream the error occurred. Optional, pass NULL if not needed.
+ *
+ * \return Tape, or NULL on error.
+ */
+M_API M_json_tape_t *M_json_tape_read_file(const char *path, M_uint32 flags, size_t max_read, M_json_error_t *error, size_t *error_line, size_t *error_pos) M_MALLOC;
+
+
+/*! Destroy a tape.
+ *
+ * All nodes and strings from the tape are invalid after this is called.
+ *
+ * \param[in] tape Tape.
+ */
+M_API void M_json_tape_destroy(M_json_tape_t *tape) M_FREE(1);
+
+
+/*! Root node of the document.
+ *
+ * \param[in] tape Tape.
+ *
+ * \return Root object or array node.
+ */
+M_API M_json_tape_node_t *M_json_tape_root(M_json_tape_t *tape);
+
+
+/*! Number of nodes in the tape.
+ *
+ * Includes a node for every object key.
+ *
+ * \param[in] tape Tape.
+ *
+ * \return Count.
+ */
+M_API size_t M_json_tape_num_nodes(const M_json_tape_t *tape);
+
+
+/*! Get the type of node.
+ *
+ * \param[in] node The node.
+ *
+ * \return The type.
+ */
+M_API M_json_type_t M_json_tape_node_type(const M_json_tape_node_t *node);
+
+
+/*! Evaluate a jsonpath expression against a node.
+ *
+ * \param[in]  node        The node.
+ * \param[in]  search      The jsonpath expression. See M_json_jsonpath() for the supported syntax.
+ * \param[out] num_matches Number of matches found.
+ *
+ * \return Array of matching nodes, or NULL if no matches. The array must be freed with M_free()
+ *         but the nodes are owned by the tape.
+ */
+M_API M_json_tape_node_t **M_json_tape_jsonpath(M_json_tape_node_t *node, const char *search, size_t *num_matches) M_MALLOC;
+
+
+/*! Evaluate a compiled jsonpath expression against a node.
+ *
+ * \param[in]  path        Compiled expression. See M_json_jsonpath_compile().
+ * \param[in]  node        The node.
+ * \param[out] num_matches Number of matches found.
+ *
+ * \return Array of matching nodes, or NULL if no matches. The array must be freed with M_free()
+ *         but the nodes are owned by the tape.
+ */
+M_API M_json_tape_node_t **M_json_tape_jsonpath_eval(const M_json_jsonpath_t *path, M_json_tape_node_t *node, size_t *num_matches) M_MALLOC;
+
+
+/*! Get the value of an object node for a given key.
+ *
+ * \param[in] node The node. Must be an object.
+ * \param[in] key  The key.
+ *
+ * \return The value node, or NULL if not found.
+ */
+M_API M_json_tape_node_t *M_json_tape_object_value(M_json_tape_node_t *node, const char *key);
+
+
+/*! Get the string value of an object node for a given key.
+ *
+ * \param[in] node The node. Must be an object.
+ * \param[in] key  The key.
+ *
+ * \return String, or NULL if not found or not a string.
+ *
+ * \see M_json_tape_get_string
+ */
+M_API const char *M_json_tape_object_value_string(M_json_tape_node_t *node, const char *key);
+
+
+/*! Get the integer value of an object node for a given key.
+ *
+ * \param[in] node The node. Must be an object.
+ * \param[in] key  The key.
+ *
+ * \return Integer value.
+ *
+ * \see M_json_tape_get_int
+ */
+M_API M_int64 M_json_tape_object_value_int(M_json_tape_node_t *node, const char *key);
+
+
+/*! Get the decimal value of an object node for a given key.
+ *
+ * \param[in] node The node. Must be an object.
+ * \param[in] key  The key.
+ *
+ * \return Decimal, or NULL if not found or not a decimal.
+ */
+M_API const M_decimal_t *M_json_tape_object_value_decimal(M_json_tape_node_t *node, const char *key);
+
+
+/*! Get the bool value of an object node for a given key.
+ *
+ * \param[in] node The node. Must be an object.
+ * \param[in] key  The key.
+ *
+ * \return Bool value.
+ *
+ * \see M_json_tape_get_bool
+ */
+M_API M_bool M_json_tape_object_value_bool(M_json_tape_node_t *node, const char *key);
+
+
+/*! Get a list of all keys for an object node in document order.
+ *
+ * \param[in] node The node. Must be an object.
+ *
+ * \return List of keys. NULL if the node is not an object.
+ */
+M_API M_list_str_t *M_json_tape_object_keys(M_json_tape_node_t *node);
+
+
+/*! Get the number of child nodes in an object node.
+ *
+ * \param[in] node The node.
+ *
+ * \return Count.
+ */
+M_API size_t M_json_tape_object_num_children(const M_json_tape_node_t *node);
+
+
+/*! Get the number of items in an array node.
+ *
+ * \param[in] node The node.
+ *
+ * \return Count.
+ */
+M_API size_t M_json_tape_array_len(const M_json_tape_node_t *node);
+
+
+/*! Get the item in an array at a given index.
+ *
+ * \param[in] node The node. Must be an array.
+ * \param[in] idx  The index.
+ *
+ * \return The node at the index, or NULL if out of range.
+ */
+M_API M_json_tape_node_t *M_json_tape_array_at(M_json_tape_node_t *node, size_t idx);
+
+
+/*! Get the string value of an array node at a given index.
+ *
+ * \param[in] node The node. Must be an array.
+ * \param[in] idx  The index.
+ *
+ * \return String, or NULL if out of range or not a string.
+ */
+M_API const char *M_json_tape_array_at_string(M_json_tape_node_t *node, size_t idx);
+
+
+/*! Get the integer value of an array node at a given index.
+ *
+ * \param[in] node The node. Must be an array.
+ * \param[in] idx  The index.
+ *
+ * \return Integer value.
+ *
+ * \see M_json_tape_get_int
+ */
+M_API M_int64 M_json_tape_array_at_int(M_json_tape_node_t *node, size_t idx);
+
+
+/*! Get the decimal value of an array node at a given index.
+ *
+ * \param[in] node The node. Must be an array.
+ * \param[in] idx  The index.
+ *
+ * \return Decimal, or NULL if out of range or not a decimal.
+ */
+M_API const M_decimal_t *M_json_tape_array_at_decimal(M_json_tape_node_t *node, size_t idx);
+
+
+/*! Get the bool value of an array node at a given index.
+ *
+ * \param[in] node The node. Must be an array.
+ * \param[in] idx  The index.
+ *
+ * \return Bool value.
+ *
+ * \see M_json_tape_get_bool
+ */
+M_API M_bool M_json_tape_array_at_bool(M_json_tape_node_t *node, size_t idx);
+
+
+/*! Get the value of a string node.
+ *
+ * \param[in] node The node.
+ *
+ * \return String, or NULL if not a string node.
+ */
+M_API const char *M_json_tape_get_string(M_json_tape_node_t *node);
+
+
+/*! Get the value of an integer node.
+ *
+ * Conversion is performed the same way as M_json_get_int().
+ *
+ * \param[in] node The node.
+ *
+ * \return Integer value.
+ */
+M_API M_int64 M_json_tape_get_int(M_json_tape_node_t *node);
+
+
+/*! Get the value of a decimal node.
+ *
+ * \param[in] node The node.
+ *
+ * \return Decimal, or NULL if not a decimal node.
+ */
+M_API const M_decimal_t *M_json_tape_get_decimal(const M_json_tape_node_t *node);
+
+
+/*! Get the value of a bool node.
+ *
+ * Conversion is performed the same way as M_json_get_bool().
+ *
+ * \param[in] node The node.
+ *
+ * \return Bool value.
+ */
+M_API M_bool M_json_tape_get_bool(M_json_tape_node_t *node);
+
+
+/*! Get the node value as a string.
+ *
+ * This will only work on value type nodes (string, integer, decimal, bool, null).
+ *
+ * \param[in]  node    The node.
+ * \param[out] buf     An allocated buffer to write the value as a string to. The result will be null terminated
+ *                     on success.
+ * \param[in]  buf_len The length of the buffer.
+ *
+ * \return M_TRUE on success. Otherwise M_FALSE.
+ */
+M_API M_bool M_json_tape_get_value(M_json_tape_node_t *node, char *buf, size_t buf_len);
+
+
+/*! Get the node value as a string.
+ *
+ * This will only work on value type nodes (string, integer, decimal, bool, null).
+ *
+ * \param[in] node The node.
+ *
+ * \return String or NULL on error.
+ */
+M_API char *M_json_tape_get_value_dup(M_json_tape_node_t *node) M_MALLOC;
+
+
+/*! Convert a node and everything under it to a JSON node.
+ *
+ * \param[in] node The node.
+ *
+ * \return JSON node, or NULL on error.
+ */
+M_API M_json_node_t *M_json_tape_to_node(M_json_tape_node_t *node) M_MALLOC;
+
+/*! @} */
+
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 /*! Write JSON to a string.
@@ -261,6 +907,260 @@ M_API char *M_json_write(const M_json_node_t *node, M_uint32 flags, size_t *len)
 M_API M_fs_error_t M_json_write_file(const M_json_node_t *node, const char *path, M_uint32 flags);
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/*! \addtogroup m_json_writer JSON Stream Writer
+ *  \ingroup m_json
+ *
+ * Write a document one element at a time without building a node tree.
+ *
+ * Output is either appended to an M_buf_t, or collected internally and handed
+ * to a flush callback or written to a file every time it reaches the flush
+ * size. Memory use is bounded by the flush size and the nesting depth instead
+ * of the size of the document.
+ *
+ * Output is identical to M_json_write() for the same document and flags.
+ * Unlike M_json_write(), keys are escaped the same as string values.
+ *
+ * Every function returns M_FALSE if the call is not valid at the current
+ * position in the document. For example, a value in an object without a key,
+ * a key in an array or closing the wrong type of container. A string that
+ * can't be encoded (invalid utf-8 without M_JSON_WRITER_REPLACE_BAD_CHARS) is
+ * also rejected. Nothing is written for a rejected call and the writer can
+ * continue to be used. If the sink fails every following call fails.
+ *
+ * To stream to an M_io_t, write to an M_buf_t and send it with
+ * M_io_write_from_buf() when the connection is writable. Generate more
+ * output once M_buf_len() drops low enough.
+ *
+ * Example:
+ *
+ * \code{.c}
+ *     M_json_writer_t *w;
+ *     size_t           i;
+ *
+ *     w = M_json_writer_create_file("out.json", 0, M_JSON_WRITER_NONE);
+ *     M_json_writer_array_begin(w);
+ *     for (i=0; i<1000000; i++) {
+ *         M_json_writer_object_begin(w);
+ *         M_json_writer_key(w, "id");
+ *         M_json_writer_value_int(w, (M_int64)i);
+ *         M_json_writer_key(w, "name");
+ *         M_json_writer_value_string(w, "abc");
+ *         M_json_writer_object_end(w);
+ *     }
+ *     M_json_writer_array_end(w);
+ *     if (!M_json_writer_finish(w))
+ *         M_printf("write failed\n");
+ *     M_json_writer_destroy(w);
+ * \endcode
+ *
+ * @{
+ */
+
+struct M_json_writer;
+typedef struct M_json_writer M_json_writer_t;
+
+/*! Function definition for receiving output.
+ *
+ * \param[in] data  Data.
+ * \param[in] len   Length of data.
+ * \param[in] thunk Thunk.
+ *
+ * \return M_TRUE if all data was consumed. M_FALSE on error which will cause
+ *         all further writes to fail.
+ */
+typedef M_bool (*M_json_writer_flush_func)(const unsigned char *data, size_t len, void *thunk);
+
+
+/*! Create a writer that appends to a buffer.
+ *
+ * The buffer is never flushed by the writer. The caller can consume data from
+ * it at any time.
+ *
+ * \param[in] buf   Buffer. Must stay valid for the life of the writer.
+ * \param[in] flags M_json_writer_flags_t flags to control writing.
+ *
+ * \return Object. NULL if buf is NULL.
+ */
+M_API M_json_writer_t *M_json_writer_create(M_buf_t *buf, M_uint32 flags) M_MALLOC;
+
+
+/*! Create a writer that passes output to a callback.
+ *
+ * \param[in] flush_func Function called with output.
+ * \param[in] thunk      Thunk passed to flush_func.
+ * \param[in] flush_size Amount of data to collect before calling flush_func.
+ *                       0 to use the default of 64 KB.
+ * \param[in] flags      M_json_writer_flags_t flags to control writing.
+ *
+ * \return Object. NULL if flush_func is NULL.
+ */
+M_API M_json_writer_t *M_json_writer_create_cb(M_json_writer_flush_func flush_func, void *thunk, size_t flush_size, M_uint32 flags) M_MALLOC;
+
+
+/*! Create a writer that writes to a file.
+ *
+ * The file is overwritten if it exists.
+ *
+ * \param[in] path       The filename and path to write the data to.
+ * \param[in] flush_size Amount of data to collect before writing to the file.
+ *                       0 to use the default of 64 KB.
+ * \param[in] flags      M_json_writer_flags_t flags to control writing.
+ *
+ * \return Object. NULL if the file could not be opened.
+ */
+M_API M_json_writer_t *M_json_writer_create_file(const char *path, size_t flush_size, M_uint32 flags) M_MALLOC;
+
+
+/*! Destroy a writer.
+ *
+ * Data that has not been flushed is discarded. Use M_json_writer_finish()
+ * first.
+ *
+ * \param[in] w Writer.
+ */
+M_API void M_json_writer_destroy(M_json_writer_t *w) M_FREE(1);
+
+
+/*! Start an object.
+ *
+ * \param[in] w Writer.
+ *
+ * \return M_TRUE on success, otherwise M_FALSE.
+ */
+M_API M_bool M_json_writer_object_begin(M_json_writer_t *w);
+
+
+/*! End the current object.
+ *
+ * \param[in] w Writer.
+ *
+ * \return M_TRUE on success, otherwise M_FALSE.
+ */
+M_API M_bool M_json_writer_object_end(M_json_writer_t *w);
+
+
+/*! Start an array.
+ *
+ * \param[in] w Writer.
+ *
+ * \return M_TRUE on success, otherwise M_FALSE.
+ */
+M_API M_bool M_json_writer_array_begin(M_json_writer_t *w);
+
+
+/*! End the current array.
+ *
+ * \param[in] w Writer.
+ *
+ * \return M_TRUE on success, otherwise M_FALSE.
+ */
+M_API M_bool M_json_writer_array_end(M_json_writer_t *w);
+
+
+/*! Write an object key.
+ *
+ * Must be followed by a value. Keys are not checked for uniqueness.
+ *
+ * \param[in] w   Writer.
+ * \param[in] key Key.
+ *
+ * \return M_TRUE on success, otherwise M_FALSE.
+ */
+M_API M_bool M_json_writer_key(M_json_writer_t *w, const char *key);
+
+
+/*! Write a string value.
+ *
+ * \param[in] w   Writer.
+ * \param[in] val Value.
+ *
+ * \return M_TRUE on success, otherwise M_FALSE.
+ */
+M_API M_bool M_json_writer_value_string(M_json_writer_t *w, const char *val);
+
+
+/*! Write an integer value.
+ *
+ * \param[in] w   Writer.
+ * \param[in] val Value.
+ *
+ * \return M_TRUE on success, otherwise M_FALSE.
+ */
+M_API M_bool M_json_writer_value_int(M_json_writer_t *w, M_int64 val);
+
+
+/*! Write a decimal value.
+ *
+ * \param[in] w   Writer.
+ * \param[in] val Value.
+ *
+ * \return M_TRUE on success, otherwise M_FALSE.
+ */
+M_API M_bool M_json_writer_value_decimal(M_json_writer_t *w, const M_decimal_t *val);
+
+
+/*! Write a bool value.
+ *
+ * \param[in] w   Writer.
+ * \param[in] val Value.
+ *
+ * \return M_TRUE on success, otherwise M_FALSE.
+ */
+M_API M_bool M_json_writer_value_bool(M_json_writer_t *w, M_bool val);
+
+
+/*! Write a null value.
+ *
+ * \param[in] w Writer.
+ *
+ * \return M_TRUE on success, otherwise M_FALSE.
+ */
+M_API M_bool M_json_writer_value_null(M_json_writer_t *w);
+
+
+/*! Write a node and everything under it as a value.
+ *
+ * \param[in] w    Writer.
+ * \param[in] node Node.
+ *
+ * \return M_TRUE on success, otherwise M_FALSE.
+ */
+M_API M_bool M_json_writer_value_node(M_json_writer_t *w, const M_json_node_t *node);
+
+
+/*! Flush collected output to the callback or file.
+ *
+ * Does nothing for a writer created with M_json_writer_create().
+ *
+ * \param[in] w Writer.
+ *
+ * \return M_TRUE on success, otherwise M_FALSE.
+ */
+M_API M_bool M_json_writer_flush(M_json_writer_t *w);
+
+
+/*! Verify the document is complete and flush all output.
+ *
+ * \param[in] w Writer.
+ *
+ * \return M_TRUE if a complete document was written, otherwise M_FALSE.
+ */
+M_API M_bool M_json_writer_finish(M_json_writer_t *w);
+
+
+/*! Current nesting depth.
+ *
+ * \param[in] w Writer.
+ *
+ * \return Number of open objects and arrays.
+ */
+M_API size_t M_json_writer_depth(const M_json_writer_t *w);
+
+/*! @} */
+
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 /*! Convert a JSON error code to a string.
@@ -313,6 +1213,48 @@ M_API M_json_type_t M_json_node_type(const M_json_node_t *node);
 M_API M_json_node_t **M_json_jsonpath(const M_json_node_t *node, const char *search, size_t *num_matches) M_MALLOC;
 
 
+/*! Compile a JSONPath expression for repeated evaluation.
+ *
+ * M_json_jsonpath() parses the expression every time it is called. A compiled
+ * expression is parsed once and can be evaluated against any number of nodes
+ * and documents. The compiled expression is not modified by evaluation so it
+ * can be shared between threads.
+ *
+ * \see M_json_jsonpath for information about supported JSONPath features.
+ *
+ * \param[in] search Search expression.
+ *
+ * \return Compiled expression or NULL if the expression is invalid.
+ *
+ * \see M_json_jsonpath_eval
+ * \see M_json_tape_jsonpath_eval
+ * \see M_json_jsonpath_destroy
+ */
+M_API M_json_jsonpath_t *M_json_jsonpath_compile(const char *search) M_MALLOC;
+
+
+/*! Destroy a compiled JSONPath expression.
+ *
+ * \param[in] path Compiled expression.
+ */
+M_API void M_json_jsonpath_destroy(M_json_jsonpath_t *path) M_FREE(1);
+
+
+/*! Evaluate a compiled JSONPath expression.
+ *
+ * Returns the same matches as M_json_jsonpath() does for the expression.
+ *
+ * \param[in]  path        Compiled expression.
+ * \param[in]  node        The node.
+ * \param[out] num_matches Number of matches found
+ *
+ * \return array of M_json_node_t pointers on success (must free array, but not internal pointers), NULL on failure
+ *
+ * \see M_free
+ */
+M_API M_json_node_t **M_json_jsonpath_eval(const M_json_jsonpath_t *path, const M_json_node_t *node, size_t *num_matches) M_MALLOC;
+
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 /*! Get the parent node of a given node.
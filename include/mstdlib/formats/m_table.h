@@ -73,6 +73,19 @@ typedef enum {
 	M_TABLE_MARKDOWN_LINEEND_WIN = 1 << 3  /*!< Use Windows line endings (\\r\\n). */
 } M_table_markdown_flags_t;
 
+
+/*! Run tasks for M_table_load_csv_parallel().
+ *
+ * \param[in] task     Function to call for each argument.
+ * \param[in] args     Arguments, one per task.
+ * \param[in] num_args Number of arguments.
+ * \param[in] thunk    Thunk passed to M_table_load_csv_parallel().
+ *
+ * Every task must have completed before returning. Tasks can run in any order
+ * and on any thread.
+ */
+typedef void (*M_table_dispatch_t)(void (*task)(void *), void **args, size_t num_args, void *thunk);
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 /*! Create a table.
@@ -440,6 +453,50 @@ M_API M_table_t *M_table_duplicate(const M_table_t *table) M_MALLOC;
 M_API M_bool M_table_load_csv(M_table_t *table, const char *data, size_t len, char delim, char quote, M_uint32 flags, M_bool have_header);
 
 
+/*! Load CSV formatted data into the table in parallel.
+ *
+ * The data is split into chunks at row boundaries which are parsed by tasks
+ * run with the dispatch callback. Rows are added to the table in the same
+ * order as they appear in the data and the result is the same as
+ * M_table_load_csv().
+ *
+ * Splitting isn't worthwhile for small amounts of data which will be loaded
+ * using M_table_load_csv() in the calling thread. The table is only modified
+ * by the calling thread.
+ *
+ * Using a thread pool:
+ *
+ * \code{.c}
+ *     static void dispatch(void (*task)(void *), void **args, size_t num_args, void *thunk)
+ *     {
+ *         M_threadpool_parent_t *parent = M_threadpool_parent_create(thunk);
+ *
+ *         M_threadpool_dispatch(parent, task, args, num_args);
+ *         M_threadpool_parent_wait(parent);
+ *         M_threadpool_parent_destroy(parent);
+ *     }
+ *
+ *     M_table_load_csv_parallel(table, data, len, ',', '"', M_CSV_FLAG_NONE, M_TRUE, M_threadpool_num_threads(pool), dispatch, pool);
+ * \endcode
+ *
+ * \param[in] table       Table.
+ * \param[in] data        CSV data.
+ * \param[in] len         Length of data to load.
+ * \param[in] delim       CSV delimiter character. Typically comma (",").
+ * \param[in] quote       CSV quote character. Typically double quote (""").
+ * \param[in] flags       M_CSV_FLAGS flags controlling parse behavior.
+ * \param[in] have_header Whether the CSV data has a header.
+ * \param[in] num_workers Number of tasks that can run at once. The number of
+ *                        chunks is based on this.
+ * \param[in] dispatch    Callback that runs the tasks. NULL to load in the
+ *                        calling thread.
+ * \param[in] thunk       Thunk passed to dispatch.
+ *
+ * \return M_TRUE if the data was loaded. Otherwise, M_FALSE.
+ */
+M_API M_bool M_table_load_csv_parallel(M_table_t *table, const char *data, size_t len, char delim, char quote, M_uint32 flags, M_bool have_header, size_t num_workers, M_table_dispatch_t dispatch, void *thunk);
+
+
 /*! Write the table as CSV.
  *
  * \param[in] table        Table.
@@ -32,6 +32,8 @@
 #include <mstdlib/base/m_hash_dict.h>
 #include <mstdlib/base/m_list_str.h>
 #include <mstdlib/base/m_buf.h>
+#include <mstdlib/base/m_parser.h>
+#include <mstdlib/base/m_arena.h>
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
@@ -352,6 +354,38 @@ M_API void M_xml_node_destroy(M_xml_node_t *node) M_FREE(1);
 M_API M_xml_node_t *M_xml_read(const char *data, size_t data_len, M_uint32 flags, size_t *processed_len, M_xml_error_t *error, size_t *error_line, size_t *error_pos) M_MALLOC;
 
 
+/*! Parse a string into an XML object allocating the nodes from an arena.
+ *
+ * Nodes, child lists, attributes and all names, values, text and tag data are
+ * allocated from the arena which avoids a large number of small allocations when
+ * parsing big documents. A single M_arena_reset() or M_arena_destroy() releases
+ * the whole document. M_xml_node_destroy() does not free anything for an arena
+ * node and does not need to be called. The memory used by a document that fails
+ * to parse stays in the arena until it's reset.
+ *
+ * Nodes later created with a parent in the returned tree are also allocated from
+ * the arena. A node can only be inserted into a node from the same arena, or
+ * into a non-arena node if it isn't from an arena either.
+ *
+ * Every node from the arena, including one that has been taken out of the tree
+ * with M_xml_take_from_parent(), is invalid once the arena is reset or destroyed.
+ *
+ * \param[in]  arena         Arena to allocate nodes from. If NULL this is the same as M_xml_read.
+ * \param[in]  data          The data to parse.
+ * \param[in]  data_len      The length of the data to parse.
+ * \param[in]  flags         M_xml_reader_flags_t flags to control the behavior of the reader.
+ * \param[out] processed_len Length of data processed. Optional pass NULL if not needed.
+ * \param[out] error         Error code if creation failed. Optional, Pass NULL if not needed.
+ * \param[out] error_line    The line the error occurred. Optional, pass NULL if not needed.
+ * \param[out] error_pos     The column the error occurred if error_line is not NULL, otherwise the position
+ *                           in the stream the error occurred. Optional, pass NULL if not needed.
+ * \return The XML doc node of the parsed data, or NULL on error.
+ *
+ * \see M_xml_read
+ */
+M_API M_xml_node_t *M_xml_read_arena(M_arena_t *arena, const char *data, size_t data_len, M_uint32 flags, size_t *processed_len, M_xml_error_t *error, size_t *error_line, size_t *error_pos) M_MALLOC;
+
+
 /*! Parse a file into an XML object.
  *
  * \param[in]  path       The file to read.
@@ -368,6 +402,220 @@ M_API M_xml_node_t *M_xml_read(const char *data, size_t data_len, M_uint32 flags
 M_API M_xml_node_t *M_xml_read_file(const char *path, M_uint32 flags, size_t max_read, M_xml_error_t *error, size_t *error_line, size_t *error_pos) M_MALLOC;
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/*! \addtogroup m_xml_pull XML Pull Reader
+ *  \ingroup m_xml
+ *
+ * Reader that returns one token at a time instead of building a node tree.
+ *
+ * Data is read from a parser that the caller fills as data becomes available.
+ * For example, with M_parser_append() or M_io_read_into_parser(). Each token
+ * is consumed from the parser when it is returned so memory use is bounded by
+ * the nesting depth and the size of the largest single token instead of the
+ * size of the document. When the parser doesn't hold a complete token
+ * M_XML_PULL_NEED_MORE is returned. Add more data to the parser and call
+ * M_xml_pull_next() again.
+ *
+ * Tokens follow the same rules as M_xml_read() and the same flags are
+ * supported. Text is trimmed and whitespace only text is not returned. CDATA
+ * is returned as text. An empty element (<a/>) is returned as a start element
+ * immediately followed by an end element.
+ *
+ * Reading stops after the root element is closed and M_XML_PULL_END_DOCUMENT
+ * is returned. Any data after the root element is left in the parser. Call
+ * M_xml_pull_reset() to read another document from the same parser.
+ *
+ * Example:
+ *
+ * \code{.c}
+ *     M_parser_t         *parser = M_parser_create(M_PARSER_FLAG_NONE);
+ *     M_xml_pull_t       *pull   = M_xml_pull_create(parser, M_XML_READER_NONE);
+ *     M_xml_pull_token_t  token;
+ *
+ *     while ((token = M_xml_pull_next(pull)) != M_XML_PULL_END_DOCUMENT) {
+ *         if (token == M_XML_PULL_NEED_MORE) {
+ *             if (!read_more(parser))
+ *                 break;
+ *         } else if (token == M_XML_PULL_ERROR) {
+ *             break;
+ *         } else if (token == M_XML_PULL_START_ELEMENT) {
+ *             if (M_str_eq(M_xml_pull_name(pull), "Signature")) {
+ *                 M_xml_pull_skip(pull);
+ *             } else {
+ *                 M_printf("%s id=%s\n", M_xml_pull_name(pull), M_xml_pull_attribute_value(pull, "id"));
+ *             }
+ *         }
+ *     }
+ *
+ *     M_xml_pull_destroy(pull);
+ *     M_parser_destroy(parser);
+ * \endcode
+ *
+ * @{
+ */
+
+struct M_xml_pull;
+typedef struct M_xml_pull M_xml_pull_t;
+
+/*! Tokens returned by the pull reader. */
+typedef enum {
+	M_XML_PULL_ERROR = 0,               /*!< Error. See M_xml_pull_error(). */
+	M_XML_PULL_NEED_MORE,               /*!< The parser doesn't have a complete token. */
+	M_XML_PULL_END_DOCUMENT,            /*!< The root element was closed. */
+	M_XML_PULL_START_ELEMENT,           /*!< Start of an element. Has a name and attributes. */
+	M_XML_PULL_END_ELEMENT,             /*!< End of an element. Has a name. */
+	M_XML_PULL_TEXT,                    /*!< Text or CDATA. Has text. */
+	M_XML_PULL_COMMENT,                 /*!< Comment. Has text. */
+	M_XML_PULL_PROCESSING_INSTRUCTION,  /*!< Processing instruction. Has a name and attributes. */
+	M_XML_PULL_DECLARATION              /*!< Declaration (DOCTYPE, ELEMENT...). Has a name and the rest of the tag
+	                                         as text. */
+} M_xml_pull_token_t;
+
+
+/*! Create a pull reader.
+ *
+ * \param[in] parser Parser data is read from. Must stay valid for the life of the reader.
+ * \param[in] flags  M_xml_reader_flags_t flags to control the behavior of the reader.
+ *
+ * \return Object. NULL if parser is NULL.
+ */
+M_API M_xml_pull_t *M_xml_pull_create(M_parser_t *parser, M_uint32 flags) M_MALLOC;
+
+
+/*! Destroy a pull reader.
+ *
+ * The parser is not destroyed.
+ *
+ * \param[in] pull Pull reader.
+ */
+M_API void M_xml_pull_destroy(M_xml_pull_t *pull) M_FREE(1);
+
+
+/*! Reset a pull reader so it can read another document.
+ *
+ * Clears any error and all state. Data in the parser is not touched.
+ *
+ * \param[in] pull Pull reader.
+ */
+M_API void M_xml_pull_reset(M_xml_pull_t *pull);
+
+
+/*! Read the next token.
+ *
+ * The name, text and attributes of the previous token are invalidated.
+ *
+ * Errors are sticky. Once M_XML_PULL_ERROR has been returned it is returned
+ * by every following call until the reader is reset.
+ *
+ * \param[in] pull Pull reader.
+ *
+ * \return Token.
+ */
+M_API M_xml_pull_token_t M_xml_pull_next(M_xml_pull_t *pull);
+
+
+/*! Skip the rest of the current element.
+ *
+ * Only valid right after M_XML_PULL_START_ELEMENT was returned. Everything
+ * inside the element is read without being returned or decoded and the next
+ * call to M_xml_pull_next() returns the end of the element. Nesting is still
+ * checked. M_XML_PULL_NEED_MORE can be returned while skipping.
+ *
+ * \param[in] pull Pull reader.
+ *
+ * \return M_TRUE if the element will be skipped. M_FALSE if the current token
+ *         is not the start of an element.
+ */
+M_API M_bool M_xml_pull_skip(M_xml_pull_t *pull);
+
+
+/*! The last token returned.
+ *
+ * \param[in] pull Pull reader.
+ *
+ * \return Token.
+ */
+M_API M_xml_pull_token_t M_xml_pull_token(const M_xml_pull_t *pull);
+
+
+/*! Current nesting depth.
+ *
+ * The depth includes the current element after a start and excludes it after
+ * an end.
+ *
+ * \param[in] pull Pull reader.
+ *
+ * \return Number of open elements.
+ */
+M_API size_t M_xml_pull_depth(const M_xml_pull_t *pull);
+
+
+/*! Name of the current element, processing instruction or declaration.
+ *
+ * \param[in] pull Pull reader.
+ *
+ * \return Name. NULL if the current token doesn't have a name.
+ */
+M_API const char *M_xml_pull_name(const M_xml_pull_t *pull);
+
+
+/*! Text of the current text, comment or declaration.
+ *
+ * \param[in]  pull Pull reader.
+ * \param[out] len  Length of the text. Optional, pass NULL if not needed.
+ *
+ * \return Text. NULL if the current token doesn't have text.
+ */
+M_API const char *M_xml_pull_text(const M_xml_pull_t *pull, size_t *len);
+
+
+/*! Number of attributes on the current element or processing instruction.
+ *
+ * \param[in] pull Pull reader.
+ *
+ * \return Count.
+ */
+M_API size_t M_xml_pull_num_attributes(const M_xml_pull_t *pull);
+
+
+/*! Get an attribute of the current element or processing instruction by index.
+ *
+ * Attributes are in the order they appear in the tag.
+ *
+ * \param[in]  pull Pull reader.
+ * \param[in]  idx  Index.
+ * \param[out] key  Attribute name. Optional, pass NULL if not needed.
+ * \param[out] val  Attribute value. Optional, pass NULL if not needed.
+ *
+ * \return M_TRUE if idx is valid, otherwise M_FALSE.
+ */
+M_API M_bool M_xml_pull_attribute(const M_xml_pull_t *pull, size_t idx, const char **key, const char **val);
+
+
+/*! Get an attribute of the current element or processing instruction by name.
+ *
+ * \param[in] pull Pull reader.
+ * \param[in] key  Attribute name. Case insensitive.
+ *
+ * \return Value. NULL if the attribute doesn't exist.
+ */
+M_API const char *M_xml_pull_attribute_value(const M_xml_pull_t *pull, const char *key);
+
+
+/*! Get the error.
+ *
+ * \param[in]  pull      Pull reader.
+ * \param[out] error_pos Offset in the data where the token that caused the error starts.
+ *                       Optional, pass NULL if not needed.
+ *
+ * \return M_XML_ERROR_SUCCESS if there was no error, otherwise the error.
+ */
+M_API M_xml_error_t M_xml_pull_error(const M_xml_pull_t *pull, size_t *error_pos);
+
+/*! @} */
+
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 /*! Write XML to a string.
@@ -498,10 +746,92 @@ M_API M_xml_node_t **M_xml_xpath(M_xml_node_t *node, const char *search, M_uint3
  * \param[in]  search      search expression
  *
  * \return Text on success otherwise  NULL.
- */ 
+ */
 M_API const char *M_xml_xpath_text_first(M_xml_node_t *node, const char *search);
 
 
+struct M_xml_xpath;
+/*! Compiled XPath expression. */
+typedef struct M_xml_xpath M_xml_xpath_t;
+
+struct M_xml_xpath_index;
+/*! Tag name index of an XML tree. */
+typedef struct M_xml_xpath_index M_xml_xpath_index_t;
+
+
+/*! Compile an XPath expression for repeated evaluation.
+ *
+ * M_xml_xpath() parses the expression every time it is called. A compiled
+ * expression is parsed once and can be evaluated against any number of nodes
+ * and documents. The compiled expression is not modified by evaluation so it
+ * can be shared between threads.
+ *
+ * \see M_xml_xpath for information about supported XPath features.
+ *
+ * \param[in] search Search expression.
+ * \param[in] flags  M_xml_reader_flags_t flags to control the behavior of the search.
+ *                   valid flags are:
+ *                   - M_XML_READER_NONE
+ *                   - M_XML_READER_TAG_CASECMP
+ *
+ * \return Compiled expression or NULL if the expression is invalid.
+ *
+ * \see M_xml_xpath_eval
+ * \see M_xml_xpath_destroy
+ */
+M_API M_xml_xpath_t *M_xml_xpath_compile(const char *search, M_uint32 flags) M_MALLOC;
+
+
+/*! Destroy a compiled XPath expression.
+ *
+ * \param[in] xpath Compiled expression.
+ */
+M_API void M_xml_xpath_destroy(M_xml_xpath_t *xpath) M_FREE(1);
+
+
+/*! Evaluate a compiled XPath expression.
+ *
+ * Returns the same matches as M_xml_xpath() does for the expression.
+ *
+ * \param[in]  xpath       Compiled expression.
+ * \param[in]  node        The node.
+ * \param[in]  index       Optional tag name index. Used for "//tag" searches that start at
+ *                         the node the index was created from. NULL to always walk the tree.
+ * \param[out] num_matches Number of matches found
+ *
+ * \return array of M_xml_node_t pointers on success (must free array, but not internal pointers), NULL on failure
+ */
+M_API M_xml_node_t **M_xml_xpath_eval(const M_xml_xpath_t *xpath, M_xml_node_t *node, const M_xml_xpath_index_t *index, size_t *num_matches) M_MALLOC;
+
+
+/*! Create a tag name index for a tree.
+ *
+ * Recursive searches for a tag name ("//tag") normally walk every node under
+ * the starting node. With an index they only visit the elements with that name.
+ * Expressions that start with '/' are evaluated from the doc node so the index
+ * should be created from the doc node to be used by them.
+ *
+ * The index is a snapshot of the tree. It must be destroyed and created again
+ * if any nodes are added to or removed from the tree. It is not modified by
+ * evaluation so it can be shared between threads as long as the tree is not
+ * modified.
+ *
+ * \param[in] node Doc or element node to index the descendant elements of.
+ *
+ * \return Index or NULL if node is not a doc or element node.
+ *
+ * \see M_xml_xpath_eval
+ */
+M_API M_xml_xpath_index_t *M_xml_xpath_index_create(M_xml_node_t *node) M_MALLOC;
+
+
+/*! Destroy a tag name index.
+ *
+ * \param[in] index Index.
+ */
+M_API void M_xml_xpath_index_destroy(M_xml_xpath_index_t *index) M_FREE(1);
+
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 /*! Get the parent node of a given node.
@@ -235,7 +235,7 @@ enum M_EVENT_FLAGS {
                                                      *   need to use it without your knowledge. */
 	M_EVENT_FLAG_EXITONEMPTY          = 1 << 1, /*!< Exit the event loop when there are no registered events */
 	M_EVENT_FLAG_EXITONEMPTY_NOTIMERS = 1 << 2, /*!< When combined with M_EVENT_FLAG_EXITONEMPTY, will ignore timers */
-	M_EVENT_FLAG_NON_SCALABLE         = 1 << 3  /*!< Utilize the 'non-scalable/small' event subsystem, generally
+	M_EVENT_FLAG_NON_SCALABLE         = 1 << 3, /*!< Utilize the 'non-scalable/small' event subsystem, generally
 	                                             *   implemented using poll() instead of the more scalable solution
 	                                             *   using kqueue() or epoll().  The main reason one might want to use
 	                                             *   this is if a large number of event loops are being created such
@@ -244,6 +244,13 @@ enum M_EVENT_FLAGS {
 	                                             *   desirable.  Not all systems have different subsystems, in which
 	                                             *   case this flag will be ignored.
 	                                             */
+	M_EVENT_FLAG_IO_URING             = 1 << 4  /*!< On Linux, use io_uring instead of epoll() to wait for events.
+	                                             *   Registrations made from the event thread are batched into the
+	                                             *   same system call used to wait, which reduces system call overhead
+	                                             *   when connections come and go frequently.  Requires kernel 5.13 or
+	                                             *   newer, if io_uring is unavailable (older kernel, disabled by
+	                                             *   sysctl or seccomp) epoll() is used instead.  Ignored on other
+	                                             *   systems and when combined with M_EVENT_FLAG_NON_SCALABLE. */
 };
 
 /*! Possible values to pass to M_event_get_statistic() */
@@ -252,7 +259,16 @@ typedef enum {
 	M_EVENT_STATISTIC_OSEVENT_COUNT,    /*!< Get the number of OS-delivered events */
 	M_EVENT_STATISTIC_SOFTEVENT_COUNT,  /*!< Get the number of soft-events delivered */
 	M_EVENT_STATISTIC_TIMER_COUNT,      /*!< Get the number of timer (or queued) events delivered */
-	M_EVENT_STATISTIC_PROCESS_TIME_MS   /*!< Get the about of non-idle time spent by the event loop in ms */
+	M_EVENT_STATISTIC_PROCESS_TIME_MS,  /*!< Get the about of non-idle time spent by the event loop in ms */
+	M_EVENT_STATISTIC_LOAD,             /*!< Get the recent load of the event loop, the portion of time over roughly
+	                                     *   the last second spent processing events rather than waiting, in tenths
+	                                     *   of a percent (0 - 1000).  For a pool this is the sum of all threads. */
+	M_EVENT_STATISTIC_LOAD_EVENTS,      /*!< Get the number of events processed over the same recent period as
+	                                     *   M_EVENT_STATISTIC_LOAD */
+	M_EVENT_STATISTIC_TASKS_STOLEN,     /*!< Get the number of tasks queued to a pool that this thread took from
+	                                     *   another thread in the pool */
+	M_EVENT_STATISTIC_IO_MIGRATED       /*!< Get the number of io objects moved to this thread by
+	                                     *   M_event_pool_rebalance() */
 } M_event_statistic_t;
 
 
@@ -299,6 +315,26 @@ M_API M_event_t *M_event_create(M_uint32 flags);
 M_API M_event_t *M_event_pool_create(size_t max_threads);
 
 
+/*! Create a pool of M_event_t objects with flags applied to each thread's event loop.
+ *
+ *  Same as M_event_pool_create() but the flags are used when initializing the event
+ *  loop for each thread in the pool.  Each thread applies them on its own, so with
+ *  M_EVENT_FLAG_EXITONEMPTY M_event_loop() returns once every thread has run out of
+ *  objects.  M_EVENT_FLAG_NOWAKE is ignored when a pool is created as the threads
+ *  need to wake each other.
+ *
+ *  \param[in] max_threads Artificial limitation on the maximum number of threads, the
+ *                         actual number of threads will be the lesser of this value
+ *                         and the number of cpu cores in the system.  Use 0 for this
+ *                         value to simply use the number of cpu cores.
+ *  \param[in] flags       One or more enum M_EVENT_FLAGS
+ *
+ *  \return Initialized event pool, or in the case only a single thread would be used,
+ *          a normal event object created with the flags.
+ */
+M_API M_event_t *M_event_pool_create_ex(size_t max_threads, M_uint32 flags);
+
+
 /*! Retrieve the distributed pool handle for balancing the load across an event pool, or
  *  self if not part of a pool.
  *
@@ -317,6 +353,44 @@ M_API M_event_t *M_event_pool_create(size_t max_threads);
 M_API M_event_t *M_event_get_pool(M_event_t *event);
 
 
+/*! Retrieve the event handle of a single thread in an event pool.
+ *
+ *  Useful for looking at the statistics of each thread with M_event_get_statistic().
+ *
+ *  \param[in] event Event pool handle, or an event handle of a thread in the pool.
+ *  \param[in] idx   Index of the thread, starting at 0.
+ *
+ *  \return Event handle for the thread or NULL if idx is past the number of threads.  If
+ *          event is not part of a pool, event itself is returned for idx 0.
+ */
+M_API M_event_t *M_event_get_pool_thread(M_event_t *event, size_t idx);
+
+
+/*! Move idle io objects from the busiest thread in an event pool to the least busy.
+ *
+ *  Objects are assigned to the least loaded thread when added to a pool and otherwise
+ *  never move, so over time a few busy objects can leave one thread loaded while the
+ *  others are idle.  This evens out the number of objects between the two threads
+ *  by moving connected objects that have not had an event delivered for at least a
+ *  second, so that once they become active again they do so on the less loaded thread.
+ *
+ *  Moving an object is the same as calling M_event_remove() followed by M_event_add()
+ *  with the same callback.  It happens within the thread the object currently belongs to,
+ *  between callbacks, but after the move callbacks for the object are delivered on a
+ *  different thread.  Do not use this if the application depends on an object staying on
+ *  the same thread as other co-joined objects, or if it accesses objects from threads
+ *  other than the event thread.
+ *
+ *  This is intended to be called periodically, such as from a timer.
+ *
+ *  \param[in] event Event pool handle, or an event handle of a thread in the pool.
+ *
+ *  \return M_TRUE if objects are being moved, M_FALSE if the load is already balanced
+ *          or event is not a pool.
+ */
+M_API M_bool M_event_pool_rebalance(M_event_t *event);
+
+
 /*! Get the registered event handle for the io object
  *
  * \param[in] io IO object.
@@ -667,8 +741,12 @@ M_API M_bool M_event_timer_edit_cb(M_event_timer_t *timer, M_event_callback_t ca
  *
  *  This is currently implemented as a oneshot timer set for 0ms.
  *
- *  \param[in] event       Event handle to add task to.  Does not make sense to hand an event
- *                         pool object since the purpose is to choose the event loop to use.
+ *  If an event pool is passed the task is not tied to any thread.  It is queued on
+ *  the least loaded thread, and a thread in the pool that runs out of work may take
+ *  it instead, so tasks queued to a pool may run in any thread and in any order.
+ *
+ *  \param[in] event       Event handle to add task to.  If an event pool, the task may be
+ *                         run by any thread in the pool.
  *  \param[in] callback    User-specified callback to call
  *  \param[in] cb_data     Optional. User-specified data supplied to user-specified callback when
  *                         executed.
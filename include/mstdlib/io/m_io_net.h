@@ -356,6 +356,63 @@ typedef enum M_io_net_type M_io_net_type_t;
 M_API M_io_error_t M_io_net_server_create(M_io_t **io_out, unsigned short port, const char *bind_ip, M_io_net_type_t type);
 
 
+/*! Create a server listener net object that shares its port with other listeners.
+ *
+ * This behaves like M_io_net_server_create() except the socket is bound with SO_REUSEPORT
+ * (SO_REUSEPORT_LB on FreeBSD) so multiple listeners can be bound to the same address and port.
+ * The OS load balances new connections across all listeners sharing the port.
+ *
+ * This is intended to be used with an event pool to remove the single accepting thread
+ * bottleneck.  Create one listener per pool thread and add each to its own thread so every
+ * event loop accepts its own connections:
+ *
+ * \code{.c}
+ *     for (i=0; (thread = M_event_get_pool_thread(pool, i)) != NULL; i++) {
+ *         if (M_io_net_server_create_reuseport(&listeners[i], port, NULL, M_IO_NET_ANY) != M_IO_ERROR_SUCCESS)
+ *             break;
+ *         port = M_io_net_get_port(listeners[i]);
+ *         M_event_add(thread, listeners[i], accept_cb, NULL);
+ *     }
+ * \endcode
+ *
+ * All listeners sharing a port must be created by the same user.  A port bound by
+ * M_io_net_server_create() cannot be shared and will return M_IO_ERROR_ADDRINUSE.
+ *
+ * \param[out] io_out  io object for communication.
+ * \param[in]  port    Port to listen on.  If 0 is used, the OS will assign an unused port which can be retrieved
+ *                     via M_io_net_get_port() and passed when creating the remaining listeners.
+ * \param[in]  bind_ip NULL to listen on all interfaces, or an explicit ip address to listen on.
+ * \param[in]  type    Connection type.
+ *
+ * \return Result.  M_IO_ERROR_NOTIMPL if the OS cannot load balance connections across listeners.
+ *
+ * \see M_io_net_server_set_cpu_steering
+ */
+M_API M_io_error_t M_io_net_server_create_reuseport(M_io_t **io_out, unsigned short port, const char *bind_ip, M_io_net_type_t type);
+
+
+/*! Steer new connections to the listener matching the CPU that received them.
+ *
+ * By default the OS picks the listener sharing a port by hashing the connection.  This instead
+ * attaches a classic BPF program to the group of listeners created by M_io_net_server_create_reuseport()
+ * which selects the listener by the CPU handling the incoming packet modulo \p num_listeners.
+ * Listeners are indexed in the order they were created.
+ *
+ * Event pool threads are bound to CPUs in order, so when one listener is created per pool
+ * thread (in thread order) and the pool has one thread per CPU, connections are accepted on
+ * the same CPU that processed their packets.  Combine with NIC receive side scaling for best
+ * results.
+ *
+ * Only supported on Linux.  Must be called after all listeners sharing the port are created.
+ *
+ * \param[in] io            Any listener in the group, created by M_io_net_server_create_reuseport().
+ * \param[in] num_listeners Number of listeners sharing the port.
+ *
+ * \return M_TRUE on success, otherwise M_FALSE if not supported or on error.
+ */
+M_API M_bool M_io_net_server_set_cpu_steering(M_io_t *io, size_t num_listeners);
+
+
 /*! Create a client net object.
  *
  * \param[out] io_out  io object for communication.
@@ -0,0 +1,249 @@
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Monetra Technologies, LLC.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef __M_IO_UDP_H__
+#define __M_IO_UDP_H__
+
+#include <mstdlib/base/m_defs.h>
+#include <mstdlib/base/m_types.h>
+#include <mstdlib/io/m_io.h>
+#include <mstdlib/io/m_io_net.h>
+#include <mstdlib/io/m_event.h>
+
+__BEGIN_DECLS
+
+/*! \addtogroup m_io_udp UDP I/O
+ *  \ingroup m_eventio_base
+ *
+ * UDP (datagram) network I/O.
+ *
+ * Each read returns exactly one datagram and each write sends exactly one
+ * datagram.  The peer a datagram was received from, or should be sent to, is
+ * carried in an M_io_meta_t object passed to M_io_read_meta() and
+ * M_io_write_meta().  Reusing the meta object from a read for a write sends
+ * the reply back to the sender.
+ *
+ * A read buffer smaller than the datagram receives the start of the datagram,
+ * the remainder is discarded.  M_io_read_into_buf() and similar functions
+ * concatenate datagrams and should not be used when datagram boundaries matter.
+ *
+ * Datagrams are received and sent in batches (recvmmsg() and sendmmsg() where
+ * available) to reduce the number of system calls.  Reads are served from the
+ * last batch received.  Writes are queued and sent together once the event
+ * loop regains control, or immediately when the queue is full.  A write only
+ * returns M_IO_ERROR_WOULDBLOCK when the queue is full and the OS cannot
+ * accept more data, an M_EVENT_TYPE_WRITE event will follow once there is
+ * room.  Errors sending a queued datagram are not reported, the datagram is
+ * dropped as if it were lost on the network.
+ *
+ * An M_EVENT_TYPE_CONNECTED event is delivered once the object is added to an
+ * event loop.  There is no connection so a DISCONNECTED event is only
+ * delivered in response to M_io_disconnect().
+ *
+ * Example
+ * =======
+ *
+ * Echo server:
+ *
+ * \code{.c}
+ *     static void echo_cb(M_event_t *el, M_event_type_t etype, M_io_t *io, void *thunk)
+ *     {
+ *         M_io_meta_t   *meta = thunk;
+ *         unsigned char  buf[9216];
+ *         size_t         len;
+ *
+ *         (void)el;
+ *
+ *         if (etype != M_EVENT_TYPE_READ)
+ *             return;
+ *
+ *         while (M_io_read_meta(io, buf, sizeof(buf), &len, meta) == M_IO_ERROR_SUCCESS) {
+ *             M_printf("%zu bytes from %s:%u\n", len, M_io_udp_meta_get_ipaddr(io, meta), M_io_udp_meta_get_port(io, meta));
+ *             M_io_write_meta(io, buf, len, &len, meta);
+ *         }
+ *     }
+ *
+ *     int main(int argc, char **argv)
+ *     {
+ *         M_event_t   *el   = M_event_create(M_EVENT_FLAG_NONE);
+ *         M_io_meta_t *meta = M_io_meta_create();
+ *         M_io_t      *io   = NULL;
+ *
+ *         if (M_io_udp_create(&io, 8125, NULL, M_IO_NET_ANY) != M_IO_ERROR_SUCCESS)
+ *             return 1;
+ *
+ *         M_event_add(el, io, echo_cb, meta);
+ *         M_event_loop(el, M_TIMEOUT_INF);
+ *
+ *         M_io_destroy(io);
+ *         M_io_meta_destroy(meta);
+ *         M_event_destroy(el);
+ *         return 0;
+ *     }
+ * \endcode
+ *
+ * @{
+ */
+
+/*! Create a UDP object bound to a local port.
+ *
+ * The object can receive datagrams from and send datagrams to any peer.  Every
+ * write must specify the destination with M_io_udp_meta_set_peer() or by
+ * reusing the meta object from a read.
+ *
+ * \param[out] io_out  io object for communication.
+ * \param[in]  port    Port to bind to.  If 0 is used, the OS will assign an unused port which can be retrieved
+ *                     via M_io_udp_get_port().
+ * \param[in]  bind_ip NULL to bind to all interfaces, or an explicit ip address to bind to.
+ * \param[in]  type    Connection type.
+ *
+ * \return Result.
+ */
+M_API M_io_error_t M_io_udp_create(M_io_t **io_out, unsigned short port, const char *bind_ip, M_io_net_type_t type);
+
+
+/*! Create a UDP object associated with a single peer.
+ *
+ * All writes are sent to the peer, any peer set in the meta object is ignored.
+ * Only datagrams from the peer are received.  No DNS resolution is performed.
+ *
+ * If the peer is not listening, reads may return M_IO_ERROR_CONNREFUSED.  This
+ * only reflects an earlier datagram and the object remains usable.
+ *
+ * \param[out] io_out  io object for communication.
+ * \param[in]  ipaddr  IP address of the peer.
+ * \param[in]  port    Port of the peer.
+ * \param[in]  type    Connection type.  Must match the address family of \p ipaddr unless M_IO_NET_ANY.
+ *
+ * \return Result.
+ */
+M_API M_io_error_t M_io_udp_client_create(M_io_t **io_out, const char *ipaddr, unsigned short port, M_io_net_type_t type);
+
+
+/*! Get the local port the object is bound to.
+ *
+ * \param[in] io io object.
+ *
+ * \return Port or 0 on error.
+ */
+M_API unsigned short M_io_udp_get_port(M_io_t *io);
+
+
+/*! Set the number of datagrams read or written per system call and the largest datagram that can be received.
+ *
+ * Defaults to 32 datagrams of up to 9216 bytes.  Larger datagrams are truncated.
+ * Memory used is roughly twice \p num_msgs multiplied by \p max_datagram_size.
+ *
+ * Can only be changed while no received datagrams are waiting to be read and
+ * no written datagrams are waiting to be sent.
+ *
+ * \param[in] io                io object.
+ * \param[in] num_msgs          Number of datagrams per batch.  1 disables batching.
+ * \param[in] max_datagram_size Largest datagram that can be received, at most 65535.
+ *
+ * \return M_TRUE on success, otherwise M_FALSE.
+ */
+M_API M_bool M_io_udp_set_batch(M_io_t *io, size_t num_msgs, size_t max_datagram_size);
+
+
+/*! Enable UDP generic segmentation offload (GSO) for writes.
+ *
+ * A single write larger than \p segment_size is split by the OS (or the network
+ * card) into datagrams of \p segment_size bytes, the last one possibly shorter.
+ * This allows sending up to 64 datagrams to the same peer for the cost of one.
+ *
+ * Only supported on Linux.
+ *
+ * \param[in] io           io object.
+ * \param[in] segment_size Size of each datagram, 0 to disable.
+ *
+ * \return M_TRUE on success, otherwise M_FALSE if not supported.
+ */
+M_API M_bool M_io_udp_set_gso(M_io_t *io, size_t segment_size);
+
+
+/*! Enable UDP generic receive offload (GRO) for reads.
+ *
+ * The OS may coalesce consecutive datagrams from the same peer of the same size
+ * into a single read.  Use M_io_udp_meta_get_segment_size() to split the data
+ * back into individual datagrams.  Enabling raises the maximum datagram size
+ * to 65535.
+ *
+ * Only supported on Linux.
+ *
+ * \param[in] io     io object.
+ * \param[in] enable Whether or not to enable.
+ *
+ * \return M_TRUE on success, otherwise M_FALSE if not supported.
+ */
+M_API M_bool M_io_udp_set_gro(M_io_t *io, M_bool enable);
+
+
+/*! Get the ip address of the peer associated with a meta object.
+ *
+ * \param[in] io   io object.
+ * \param[in] meta Meta filled by a read or set by M_io_udp_meta_set_peer().
+ *
+ * \return IP address or NULL if no peer.  IPv4 peers received on IPv6 objects are returned as IPv4.
+ */
+M_API const char *M_io_udp_meta_get_ipaddr(M_io_t *io, M_io_meta_t *meta);
+
+
+/*! Get the port of the peer associated with a meta object.
+ *
+ * \param[in] io   io object.
+ * \param[in] meta Meta filled by a read or set by M_io_udp_meta_set_peer().
+ *
+ * \return Port or 0 if no peer.
+ */
+M_API unsigned short M_io_udp_meta_get_port(M_io_t *io, M_io_meta_t *meta);
+
+
+/*! Get the size of each datagram coalesced into a read.
+ *
+ * \param[in] io   io object.
+ * \param[in] meta Meta filled by a read.
+ *
+ * \return Segment size, or 0 if the read contained a single datagram.
+ *
+ * \see M_io_udp_set_gro
+ */
+M_API size_t M_io_udp_meta_get_segment_size(M_io_t *io, M_io_meta_t *meta);
+
+
+/*! Set the peer a write should be sent to.
+ *
+ * \param[in] io     io object.
+ * \param[in] meta   Meta.
+ * \param[in] ipaddr IP address of the peer.
+ * \param[in] port   Port of the peer.
+ *
+ * \return M_TRUE on success, otherwise M_FALSE if the address is invalid.
+ */
+M_API M_bool M_io_udp_meta_set_peer(M_io_t *io, M_io_meta_t *meta, const char *ipaddr, unsigned short port);
+
+/*! @} */
+
+__END_DECLS
+
+#endif
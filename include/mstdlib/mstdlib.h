@@ -16,6 +16,7 @@
  *   Data Structures and Algorithms
  */
 
+#include <mstdlib/base/m_arena.h>
 #include <mstdlib/base/m_bin.h>
 #include <mstdlib/base/m_bincodec.h>
 #include <mstdlib/base/m_bit_buf.h>
@@ -52,6 +53,7 @@
 #include <mstdlib/base/m_llist_u64.h>
 #include <mstdlib/base/m_math.h>
 #include <mstdlib/base/m_mem.h>
+#include <mstdlib/base/m_mempool.h>
 #include <mstdlib/base/m_parser.h>
 #include <mstdlib/base/m_queue.h>
 #include <mstdlib/base/m_rand.h>
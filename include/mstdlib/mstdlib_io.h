@@ -75,6 +75,7 @@
 #include <mstdlib/io/m_io.h>
 #include <mstdlib/io/m_io_net.h>
 #include <mstdlib/io/m_io_net_iface_ips.h>
+#include <mstdlib/io/m_io_udp.h>
 #include <mstdlib/io/m_dns.h>
 #include <mstdlib/io/m_io_pipe.h>
 #include <mstdlib/io/m_event.h>
@@ -14,6 +14,9 @@
  */
 
 #include <mstdlib/thread/m_atomic.h>
+#include <mstdlib/thread/m_cache_concurrent.h>
+#include <mstdlib/thread/m_hash_concurrent.h>
+#include <mstdlib/thread/m_mempool_concurrent.h>
 #include <mstdlib/thread/m_popen.h>
 #include <mstdlib/thread/m_thread.h>
 #include <mstdlib/thread/m_threadpool.h>
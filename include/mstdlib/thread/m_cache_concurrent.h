@@ -0,0 +1,292 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2026 Monetra Technologies, LLC.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef __M_CACHE_CONCURRENT_H__
+#define __M_CACHE_CONCURRENT_H__
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#include <mstdlib/base/m_defs.h>
+#include <mstdlib/base/m_types.h>
+#include <mstdlib/base/m_cache.h>
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+__BEGIN_DECLS
+
+/*! \addtogroup m_cache_concurrent Concurrent Cache
+ *  \ingroup    m_thread
+ *
+ * Cache that can be shared by multiple threads without external locking.
+ *
+ * Keys are split across a number of shards. Each shard is an M_cache_t protected by
+ * its own lock, so threads using keys in different shards do not contend. The
+ * maximum number of entries is divided evenly between the shards and eviction
+ * happens within a shard. Which entry is evicted is therefore only approximately
+ * the least recently used for the cache as a whole. The maximum cost is shared,
+ * a shard can use what the others aren't. When an insert takes the total over
+ * the maximum, entries are evicted from that shard first, then from the others.
+ *
+ * Entry cost, time to live and statistics behave as they do for M_cache_t.
+ *
+ * Values returned by M_cache_concurrent_get() are only valid until another thread
+ * causes them to be replaced, removed or evicted. Use M_cache_concurrent_get_copy()
+ * unless values are managed externally.
+ *
+ * Example:
+ *
+ * \code{.c}
+ *     struct M_cache_callbacks  callbacks = { M_hash_void_strdup, M_free, NULL, M_free };
+ *     M_cache_concurrent_t     *c;
+ *     M_cache_stats_t           stats;
+ *     char                     *val;
+ *
+ *     c = M_cache_concurrent_create(0, 10000, M_hash_func_hash_str, M_sort_compar_str, M_CACHE_NONE, &callbacks);
+ *     M_cache_concurrent_set_max_cost(c, 4*1024*1024);
+ *
+ *     // From any thread.
+ *     M_cache_concurrent_insert_ex(c, "host.example.com", M_strdup("192.0.2.1"), 10, 60*1000);
+ *     if (M_cache_concurrent_get_copy(c, "host.example.com", M_hash_void_strdup, (void **)&val)) {
+ *         M_printf("%s\n", val);
+ *         M_free(val);
+ *     }
+ *
+ *     M_cache_concurrent_stats(c, &stats);
+ *     M_printf("hits=%llu misses=%llu\n", stats.hits, stats.misses);
+ *
+ *     M_cache_concurrent_destroy(c);
+ * \endcode
+ *
+ * @{
+ */
+
+struct M_cache_concurrent;
+typedef struct M_cache_concurrent M_cache_concurrent_t;
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/*! Create a concurrent cache.
+ *
+ * \param[in] num_shards   Number of independently locked shards. Rounded up to a power of 2.
+ *                         If 0, a value based on the number of CPU cores and max_size will be used.
+ * \param[in] max_size     Maximum number of entries in the cache.
+ * \param[in] key_hash     The function to use for hashing a key. If not specified will use
+ *                         the pointer address as the key.
+ * \param[in] key_equality The function to use to determine if two keys are equal. If not
+ *                         specified, will compare pointer addresses.
+ * \param[in] flags        M_cache_flags_t flags for modifying behavior.
+ * \param[in] callbacks    Register callbacks for overriding default behavior.
+ *
+ * \return Allocated cache.
+ *
+ * \see M_cache_concurrent_destroy
+ */
+M_API M_cache_concurrent_t *M_cache_concurrent_create(size_t num_shards, size_t max_size,
+		M_hashtable_hash_func key_hash, M_sort_compar_t key_equality,
+		M_uint32 flags, const struct M_cache_callbacks *callbacks) M_MALLOC;
+
+
+/*! Destroy the cache.
+ *
+ * No other thread can be using the cache when it is destroyed.
+ *
+ * \param[in] c Cache to destroy
+ */
+M_API void M_cache_concurrent_destroy(M_cache_concurrent_t *c);
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/*! Insert an entry into the cache.
+ *
+ * \param[in] c     Cache being referenced.
+ * \param[in] key   Key to insert.
+ * \param[in] value Value to insert. The cache will take ownership of the value. Maybe NULL.
+ *
+ * \return M_TRUE on success, or M_FALSE on failure.
+ *
+ * \see M_cache_insert
+ */
+M_API M_bool M_cache_concurrent_insert(M_cache_concurrent_t *c, const void *key, const void *value);
+
+
+/*! Insert an entry into the cache with a cost and time to live.
+ *
+ * \param[in] c      Cache being referenced.
+ * \param[in] key    Key to insert.
+ * \param[in] value  Value to insert. The cache will take ownership of the value. Maybe NULL.
+ * \param[in] cost   Cost of the entry. Typically the size of the value in bytes.
+ * \param[in] ttl_ms Number of milliseconds before the entry expires. 0 to never expire.
+ *
+ * \return M_TRUE on success, or M_FALSE on failure. Fails if cost is larger than the
+ *         maximum cost in which case ownership of the value remains with the caller.
+ *
+ * \see M_cache_insert_ex
+ */
+M_API M_bool M_cache_concurrent_insert_ex(M_cache_concurrent_t *c, const void *key, const void *value, size_t cost, M_uint64 ttl_ms);
+
+
+/*! Remove an entry from the cache.
+ *
+ * \param[in] c   Cache being referenced.
+ * \param[in] key Key to remove.
+ *
+ * \return M_TRUE on success, or M_FALSE if key does not exist.
+ */
+M_API M_bool M_cache_concurrent_remove(M_cache_concurrent_t *c, const void *key);
+
+
+/*! Retrieve the value for a key from the cache.
+ *
+ * The value returned is the one stored in the cache. It can be destroyed by another
+ * thread at any time. Only use this when values are managed externally.
+ *
+ * \param[in]  c     Cache being referenced.
+ * \param[in]  key   Key for value.
+ * \param[out] value Pointer to value stored in the cache. Optional, pass NULL if not needed.
+ *
+ * \return M_TRUE if value retrieved, M_FALSE if key does not exist or has expired.
+ *
+ * \see M_cache_concurrent_get_copy
+ */
+M_API M_bool M_cache_concurrent_get(M_cache_concurrent_t *c, const void *key, void **value);
+
+
+/*! Retrieve a copy of the value for a key from the cache.
+ *
+ * The value is duplicated while the shard is locked.
+ *
+ * \param[in]  c         Cache being referenced.
+ * \param[in]  key       Key for value.
+ * \param[in]  duplicate Function used to duplicate the value.
+ * \param[out] value     Copy of the value. Must be freed by the caller.
+ *
+ * \return M_TRUE if value retrieved, M_FALSE if key does not exist or has expired.
+ */
+M_API M_bool M_cache_concurrent_get_copy(M_cache_concurrent_t *c, const void *key, M_cache_duplicate_func duplicate, void **value);
+
+
+/*! Remove all expired entries from the cache.
+ *
+ * \param[in] c Cache being referenced.
+ *
+ * \return Number of entries removed.
+ */
+M_API size_t M_cache_concurrent_expire(M_cache_concurrent_t *c);
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/*! Get the number of items in the cache.
+ *
+ * \param[in] c Cache being referenced.
+ *
+ * \return Count.
+ */
+M_API size_t M_cache_concurrent_size(M_cache_concurrent_t *c);
+
+
+/*! Get the maximum number of items allowed in the cache.
+ *
+ * \param[in] c Cache being referenced.
+ *
+ * \return Max.
+ */
+M_API size_t M_cache_concurrent_max_size(const M_cache_concurrent_t *c);
+
+
+/*! Set the maximum number of items allowed in the cache.
+ *
+ * \param[in] c        Cache being referenced.
+ * \param[in] max_size Maximum size.
+ *
+ * \return M_TRUE if the max size was changed, otherwise M_FALSE on error.
+ */
+M_API M_bool M_cache_concurrent_set_max_size(M_cache_concurrent_t *c, size_t max_size);
+
+
+/*! Get the total cost of all items in the cache.
+ *
+ * \param[in] c Cache being referenced.
+ *
+ * \return Cost.
+ */
+M_API size_t M_cache_concurrent_cost(M_cache_concurrent_t *c);
+
+
+/*! Get the maximum total cost allowed in the cache.
+ *
+ * \param[in] c Cache being referenced.
+ *
+ * \return Max cost. 0 if unlimited.
+ */
+M_API size_t M_cache_concurrent_max_cost(const M_cache_concurrent_t *c);
+
+
+/*! Set the maximum total cost allowed in the cache.
+ *
+ * \param[in] c        Cache being referenced.
+ * \param[in] max_cost Maximum cost. 0 for unlimited (default).
+ *
+ * \return M_TRUE if the max cost was changed, otherwise M_FALSE on error.
+ */
+M_API M_bool M_cache_concurrent_set_max_cost(M_cache_concurrent_t *c, size_t max_cost);
+
+
+/*! Set the time to live used by M_cache_concurrent_insert.
+ *
+ * \param[in] c      Cache being referenced.
+ * \param[in] ttl_ms Number of milliseconds before entries expire. 0 to never expire (default).
+ */
+M_API void M_cache_concurrent_set_default_ttl(M_cache_concurrent_t *c, M_uint64 ttl_ms);
+
+
+/*! Get the number of shards in the cache.
+ *
+ * \param[in] c Cache being referenced.
+ *
+ * \return Number of shards.
+ */
+M_API size_t M_cache_concurrent_num_shards(const M_cache_concurrent_t *c);
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/*! Get the usage statistics for the cache.
+ *
+ * Statistics from all shards are combined.
+ *
+ * \param[in]  c     Cache being referenced.
+ * \param[out] stats Statistics.
+ */
+M_API void M_cache_concurrent_stats(M_cache_concurrent_t *c, M_cache_stats_t *stats);
+
+
+/*! Reset the usage statistics for the cache.
+ *
+ * \param[in] c Cache being referenced.
+ */
+M_API void M_cache_concurrent_stats_reset(M_cache_concurrent_t *c);
+
+/*! @} */
+
+__END_DECLS
+
+#endif /* __M_CACHE_CONCURRENT_H__ */
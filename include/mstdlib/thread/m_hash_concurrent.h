@@ -0,0 +1,245 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2026 Monetra Technologies, LLC.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef __M_HASH_CONCURRENT_H__
+#define __M_HASH_CONCURRENT_H__
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#include <mstdlib/base/m_defs.h>
+#include <mstdlib/base/m_types.h>
+#include <mstdlib/base/m_hashtable.h>
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+__BEGIN_DECLS
+
+/*! \addtogroup m_hash_concurrent Concurrent Hashtable
+ *  \ingroup    m_thread
+ *
+ * Hashtable that can be shared by multiple threads without external locking.
+ *
+ * Keys are split across a number of shards. Each shard is an M_hashtable_t protected
+ * by its own read/write lock. Threads working with keys in different shards never
+ * contend with each other and readers of the same shard can run in parallel. This
+ * scales far better than wrapping a single hashtable with one lock once many threads
+ * are using the table.
+ *
+ * Behavior (callbacks, flags, multi-value support) is the same as M_hashtable_t with
+ * the exception that keys cannot be ordered.
+ *
+ * Values returned by M_hash_concurrent_get() are only valid until another thread
+ * replaces or removes the key. Use M_hash_concurrent_get_copy() when values can be
+ * changed while they are in use.
+ *
+ * Example:
+ *
+ * \code{.c}
+ *     M_hash_concurrent_t *h;
+ *     char                *val;
+ *
+ *     h = M_hash_concurrent_create(0, 1024, 75, M_hash_func_hash_str, M_sort_compar_str, M_HASHTABLE_NONE, NULL);
+ *
+ *     // From any thread.
+ *     M_hash_concurrent_insert(h, "key", "value");
+ *     if (M_hash_concurrent_get_copy(h, "key", (void **)&val)) {
+ *         M_printf("%s\n", val);
+ *         M_free(val);
+ *     }
+ *
+ *     M_hash_concurrent_destroy(h, M_TRUE);
+ * \endcode
+ *
+ * With the above example the callbacks need to duplicate and free the keys and values.
+ * See M_hash_strvp_create() for how the M_hashtable callbacks are used for string keys.
+ *
+ * @{
+ */
+
+struct M_hash_concurrent;
+typedef struct M_hash_concurrent M_hash_concurrent_t;
+
+
+/*! Callback for M_hash_concurrent_foreach.
+ *
+ * Called with the shard holding the key locked for reading. The table must not
+ * be modified from within the callback.
+ *
+ * \param[in] key   Key.
+ * \param[in] value Value.
+ * \param[in] thunk Thunk passed to M_hash_concurrent_foreach.
+ *
+ * \return M_TRUE to continue, M_FALSE to stop enumerating.
+ */
+typedef M_bool (*M_hash_concurrent_foreach_cb)(const void *key, const void *value, void *thunk);
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/*! Create a new concurrent hashtable.
+ *
+ * \param[in] num_shards   Number of independently locked shards. Rounded up to a power of 2.
+ *                         If 0, a value based on the number of CPU cores will be used.
+ * \param[in] size         Total initial size of the hash table across all shards. If not
+ *                         specified as a power of 2, will be rounded up to the nearest power of 2.
+ * \param[in] fillpct      The maximum fill percentage before a shard is expanded. If 0 is specified,
+ *                         the shards will never expand, otherwise the value must be between 1 and
+ *                         99 (recommended: 75).
+ * \param[in] key_hash     The function to use for hashing a key. If not specified will use
+ *                         the pointer address as the key and use FNV1a.
+ * \param[in] key_equality The function to use to determine if two keys are equal. If not
+ *                         specified, will compare pointer addresses.
+ * \param[in] flags        M_hashtable_flags_t flags for modifying behavior. M_HASHTABLE_KEYS_ORDERED
+ *                         and M_HASHTABLE_KEYS_SORTED are not supported.
+ * \param[in] callbacks    Register callbacks for overriding default behavior.
+ *
+ * \return Allocated hashtable, or NULL on error.
+ *
+ * \see M_hash_concurrent_destroy
+ */
+M_API M_hash_concurrent_t *M_hash_concurrent_create(size_t num_shards, size_t size, M_uint8 fillpct,
+		M_hashtable_hash_func key_hash, M_sort_compar_t key_equality,
+		M_uint32 flags, const struct M_hashtable_callbacks *callbacks) M_MALLOC;
+
+
+/*! Destroy the hashtable.
+ *
+ * No other thread can be using the hashtable when it is destroyed.
+ *
+ * \param[in] h            Hashtable to destroy.
+ * \param[in] destroy_vals M_TRUE if the values held by the hashtable should be destroyed.
+ *                         This will almost always be M_TRUE. This should only be set to M_FALSE
+ *                         when all values held by the hashtable are being managed externally.
+ */
+M_API void M_hash_concurrent_destroy(M_hash_concurrent_t *h, M_bool destroy_vals) M_FREE(1);
+
+
+/*! Insert an entry into the hashtable.
+ *
+ * \param[in] h     Hashtable being referenced.
+ * \param[in] key   Key to insert.
+ * \param[in] value Value to insert. The hashtable will take ownership of the value. Maybe NULL.
+ *
+ * \return M_TRUE on success, or M_FALSE on failure.
+ */
+M_API M_bool M_hash_concurrent_insert(M_hash_concurrent_t *h, const void *key, const void *value);
+
+
+/*! Insert an entry into the hashtable only if the key is not already present.
+ *
+ * The check and insert happen while holding the shard lock so only one of any
+ * number of threads inserting the same key will succeed.
+ *
+ * \param[in] h     Hashtable being referenced.
+ * \param[in] key   Key to insert.
+ * \param[in] value Value to insert. The hashtable will take ownership of the value. Maybe NULL.
+ *
+ * \return M_TRUE if inserted, or M_FALSE if the key exists or on failure. On failure
+ *         ownership of the value remains with the caller.
+ */
+M_API M_bool M_hash_concurrent_insert_unique(M_hash_concurrent_t *h, const void *key, const void *value);
+
+
+/*! Remove an entry from the hashtable.
+ *
+ * \param[in] h            Hashtable being referenced.
+ * \param[in] key          Key to remove.
+ * \param[in] destroy_vals M_TRUE if the value held by the hashtable should be destroyed.
+ *                         This will almost always be M_TRUE. This should only be set to M_FALSE
+ *                         when the value held by the hashtable is being managed externally.
+ *
+ * \return M_TRUE on success, or M_FALSE if key does not exist.
+ */
+M_API M_bool M_hash_concurrent_remove(M_hash_concurrent_t *h, const void *key, M_bool destroy_vals);
+
+
+/*! Retrieve the value for a key.
+ *
+ * The value returned is the one stored in the hashtable. It will be destroyed if
+ * another thread replaces or removes the key. Only use this when values are not
+ * changed once inserted or are managed externally.
+ *
+ * \param[in]  h     Hashtable being referenced.
+ * \param[in]  key   Key for value.
+ * \param[out] value Pointer to value stored in the hashtable. Optional, pass NULL if not needed.
+ *
+ * \return M_TRUE if value retrieved, M_FALSE if key does not exist.
+ *
+ * \see M_hash_concurrent_get_copy
+ */
+M_API M_bool M_hash_concurrent_get(const M_hash_concurrent_t *h, const void *key, void **value);
+
+
+/*! Retrieve a copy of the value for a key.
+ *
+ * The value is duplicated using the value_duplicate_copy callback while the shard is
+ * locked. If the callback is not set the value stored in the hashtable is returned
+ * as with M_hash_concurrent_get().
+ *
+ * \param[in]  h     Hashtable being referenced.
+ * \param[in]  key   Key for value.
+ * \param[out] value Copy of the value. Must be freed by the caller.
+ *
+ * \return M_TRUE if value retrieved, M_FALSE if key does not exist.
+ */
+M_API M_bool M_hash_concurrent_get_copy(const M_hash_concurrent_t *h, const void *key, void **value);
+
+
+/*! Call a function for every entry in the hashtable.
+ *
+ * Shards are locked for reading one at a time. Entries inserted or removed by other
+ * threads while enumerating may or may not be seen.
+ *
+ * \param[in] h     Hashtable being referenced.
+ * \param[in] cb    Callback called for each entry.
+ * \param[in] thunk Passed to the callback.
+ *
+ * \return Number of entries the callback was called for.
+ */
+M_API size_t M_hash_concurrent_foreach(const M_hash_concurrent_t *h, M_hash_concurrent_foreach_cb cb, void *thunk);
+
+
+/*! Retrieve the number of keys in the hashtable.
+ *
+ * Other threads can change the table while shards are counted so this is only
+ * exact when the table is not being modified.
+ *
+ * \param[in] h Hashtable being referenced.
+ *
+ * \return Number of keys.
+ */
+M_API size_t M_hash_concurrent_num_keys(const M_hash_concurrent_t *h);
+
+
+/*! Retrieve the number of shards in the hashtable.
+ *
+ * \param[in] h Hashtable being referenced.
+ *
+ * \return Number of shards.
+ */
+M_API size_t M_hash_concurrent_num_shards(const M_hash_concurrent_t *h);
+
+/*! @} */
+
+__END_DECLS
+
+#endif /* __M_HASH_CONCURRENT_H__ */
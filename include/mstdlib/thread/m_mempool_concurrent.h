@@ -0,0 +1,149 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2026 Monetra Technologies, LLC.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef __M_MEMPOOL_CONCURRENT_H__
+#define __M_MEMPOOL_CONCURRENT_H__
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#include <mstdlib/base/m_defs.h>
+#include <mstdlib/base/m_types.h>
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+__BEGIN_DECLS
+
+/*! \addtogroup m_mempool_concurrent Concurrent Object Pool
+ *  \ingroup    m_thread
+ *
+ * Fixed size object allocator that can be shared by multiple threads without
+ * external locking.
+ *
+ * Objects come from a shared depot, an M_mempool_t protected by a lock. Each
+ * thread allocates from and frees into a small cache of objects selected by
+ * its thread id. A cache is only refilled from, or flushed to, the depot in
+ * batches once it runs empty or full. Threads only contend on the depot once
+ * per batch instead of once per object and objects freed by a thread tend to
+ * be handed back to the same thread while still in its CPU cache.
+ *
+ * Caches are selected by hashing the thread id into a fixed number of slots.
+ * With more threads than slots some threads share a cache. A thread that finds
+ * its cache in use moves on to the next one instead of waiting.
+ *
+ * Objects are zeroed when freed and returned zeroed when allocated. An object
+ * can be freed by a different thread than the one that allocated it.
+ *
+ * Example:
+ *
+ * \code{.c}
+ *     typedef struct {
+ *         M_uint64 id;
+ *         char     name[32];
+ *     } my_obj_t;
+ *
+ *     M_mempool_concurrent_t *pool;
+ *     my_obj_t               *obj;
+ *
+ *     pool = M_mempool_concurrent_create(sizeof(my_obj_t), 0);
+ *
+ *     obj     = M_mempool_concurrent_alloc(pool);
+ *     obj->id = 1;
+ *     M_mempool_concurrent_free(pool, obj);
+ *
+ *     M_mempool_concurrent_destroy(pool);
+ * \endcode
+ *
+ * @{
+ */
+
+struct M_mempool_concurrent;
+typedef struct M_mempool_concurrent M_mempool_concurrent_t;
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/*! Create a concurrent object pool.
+ *
+ * \param[in] obj_size   Size of each object.
+ * \param[in] cache_size Maximum number of objects held by each thread cache. Half
+ *                       of this is moved to or from the depot at a time. 0 to pick
+ *                       a size based on obj_size.
+ *
+ * \return Pool. NULL if obj_size is 0.
+ *
+ * \see M_mempool_concurrent_destroy
+ */
+M_API M_mempool_concurrent_t *M_mempool_concurrent_create(size_t obj_size, size_t cache_size) M_MALLOC;
+
+
+/*! Destroy a concurrent object pool.
+ *
+ * All objects allocated from the pool are released, even if they haven't been
+ * returned with M_mempool_concurrent_free(). The pool cannot be in use by any
+ * other threads.
+ *
+ * \param[in] pool Pool.
+ */
+M_API void M_mempool_concurrent_destroy(M_mempool_concurrent_t *pool) M_FREE(1);
+
+
+/*! Allocate an object.
+ *
+ * \param[in] pool Pool.
+ *
+ * \return Zeroed object. Must be returned with M_mempool_concurrent_free().
+ */
+M_API void *M_mempool_concurrent_alloc(M_mempool_concurrent_t *pool) M_WARN_UNUSED_RESULT M_MALLOC;
+
+
+/*! Return an object to the pool.
+ *
+ * \param[in] pool Pool the object was allocated from.
+ * \param[in] obj  Object. May be NULL.
+ */
+M_API void M_mempool_concurrent_free(M_mempool_concurrent_t *pool, void *obj);
+
+
+/*! Number of objects currently allocated from the pool.
+ *
+ * Objects held in thread caches are not counted.
+ *
+ * \param[in] pool Pool.
+ *
+ * \return Count.
+ */
+M_API size_t M_mempool_concurrent_num_used(M_mempool_concurrent_t *pool);
+
+
+/*! Number of thread caches.
+ *
+ * \param[in] pool Pool.
+ *
+ * \return Count.
+ */
+M_API size_t M_mempool_concurrent_num_caches(const M_mempool_concurrent_t *pool);
+
+/*! @} */
+
+__END_DECLS
+
+#endif /* __M_MEMPOOL_CONCURRENT_H__ */
@@ -121,6 +121,10 @@ static void M_event_loop_init(M_event_t *event, M_uint32 flags)
 	/* On destroy, this will auto-free any soft event handles left over */
 	event->u.loop.soft_events   = M_llist_create(&softevent_cbs, M_LLIST_NONE);
 
+	/* On destroy, this will auto-free any pool tasks left over */
+	event->u.loop.task_lock     = M_thread_mutex_create(M_THREAD_MUTEXATTR_NONE);
+	event->u.loop.tasks         = M_llist_create(&softevent_cbs, M_LLIST_NONE);
+
 #if defined(_WIN32)
 	event->u.loop.impl          = &M_event_impl_win32;
 #elif defined(HAVE_KQUEUE)
@@ -132,6 +136,11 @@ static void M_event_loop_init(M_event_t *event, M_uint32 flags)
 #elif defined(HAVE_EPOLL)
 	if (flags & M_EVENT_FLAG_NON_SCALABLE) {
 		event->u.loop.impl      = &M_event_impl_poll;
+#  ifdef HAVE_IO_URING
+	} else if (flags & M_EVENT_FLAG_IO_URING) {
+		/* Falls back to epoll if the kernel doesn't support it */
+		event->u.loop.impl      = &M_event_impl_uring;
+#  endif
 	} else {
 		event->u.loop.impl      = &M_event_impl_epoll;
 	}
@@ -165,9 +174,16 @@ M_event_t *M_event_create(M_uint32 flags)
 
 M_event_t *M_event_pool_create(size_t max_threads)
 {
-	size_t     num_threads;
-	size_t     i;
-	M_event_t *event;
+	return M_event_pool_create_ex(max_threads, M_EVENT_FLAG_NONE);
+}
+
+
+M_event_t *M_event_pool_create_ex(size_t max_threads, M_uint32 flags)
+{
+	enum M_EVENT_FLAGS  mask = M_EVENT_FLAG_NOWAKE;
+	size_t              num_threads;
+	size_t              i;
+	M_event_t          *event;
 
 	if (max_threads == 0)
 		max_threads = SIZE_MAX;
@@ -178,7 +194,10 @@ M_event_t *M_event_pool_create(size_t max_threads)
 
 	/* If there's only one core, we won't create a pool */
 	if (num_threads == 1)
-		return M_event_create(M_EVENT_FLAG_NONE);
+		return M_event_create(flags);
+
+	/* Threads in the pool wake each other to hand over objects and tasks */
+	flags &= ~mask;
 
 	event                       = M_malloc_zero(sizeof(*event));
 	event->type                 = M_EVENT_BASE_TYPE_POOL;
@@ -186,7 +205,7 @@ M_event_t *M_event_pool_create(size_t max_threads)
 	event->u.pool.thread_ids    = M_malloc_zero(sizeof(*event->u.pool.thread_ids)    * num_threads);
 	event->u.pool.thread_evloop = M_malloc_zero(sizeof(*event->u.pool.thread_evloop) * num_threads);
 	for (i=0; i<num_threads; i++) {
-		M_event_loop_init(&event->u.pool.thread_evloop[i], M_EVENT_FLAG_NONE);
+		M_event_loop_init(&event->u.pool.thread_evloop[i], flags);
 		event->u.pool.thread_evloop[i].u.loop.parent = event;
 	}
 
@@ -218,8 +237,10 @@ static void M_event_destroy_loop(M_event_t *event)
 	event->u.loop.soft_events          = NULL;
 
 	/* Should auto-destroy any lingering timer handles automatically */
-	M_queue_destroy(event->u.loop.timers);
-	event->u.loop.timers        = NULL;
+	M_event_timer_destroy_all(event);
+
+	M_llist_destroy(event->u.loop.tasks, M_TRUE);
+	event->u.loop.tasks                = NULL;
 
 	if (event->u.loop.impl_data != NULL) {
 		if (event->u.loop.impl->data_free != NULL) {
@@ -229,6 +250,7 @@ static void M_event_destroy_loop(M_event_t *event)
 	}
 
 	M_event_unlock(event);
+	M_thread_mutex_destroy(event->u.loop.task_lock);
 	M_thread_mutex_destroy(event->u.loop.lock);
 }
 
@@ -585,10 +607,85 @@ cleanup:
 }
 
 
+/* Load is tracked over roughly this window, older history decays away */
+#define M_EVENT_LOAD_WINDOW_US     1000000
+/* Loads (in tenths of a percent) within this of each other are considered equal when distributing */
+#define M_EVENT_LOAD_SLACK         50
+/* Most tasks taken from another thread in one go */
+#define M_EVENT_STEAL_MAX          32
+/* Rebalancing only happens when the busiest thread is this much (in tenths of a percent) busier than the least */
+#define M_EVENT_REBALANCE_LOAD     200
+/* io objects without an event delivered for this long are considered idle */
+#define M_EVENT_IO_IDLE_MS         1000
+
+static M_uint64 M_event_elapsed_us(const M_timeval_t *start_tv, const M_timeval_t *end_tv)
+{
+	M_int64 us = ((M_int64)end_tv->tv_sec - (M_int64)start_tv->tv_sec) * 1000000 + ((M_int64)end_tv->tv_usec - (M_int64)start_tv->tv_usec);
+
+	if (us < 0)
+		return 0;
+	return (M_uint64)us;
+}
+
+
+static M_uint64 M_event_now_ms(void)
+{
+	M_timeval_t tv;
+
+	M_time_elapsed_start(&tv);
+	return (M_uint64)tv.tv_sec * 1000 + (M_uint64)tv.tv_usec / 1000;
+}
+
+
+/* Event must be locked */
+static void M_event_load_update(M_event_t *event, M_uint64 busy_us, M_uint64 idle_us, M_uint64 num_events)
+{
+	event->u.loop.load_busy_us  += busy_us;
+	event->u.loop.load_total_us += busy_us + idle_us;
+	event->u.loop.load_events   += num_events;
+
+	/* Halve the history once it covers more than the window so the load
+	 * follows what the loop has been doing recently rather than its lifetime
+	 * average. */
+	while (event->u.loop.load_total_us > M_EVENT_LOAD_WINDOW_US) {
+		event->u.loop.load_busy_us  /= 2;
+		event->u.loop.load_total_us /= 2;
+		event->u.loop.load_events   /= 2;
+	}
+}
+
+
+/* Event must be locked */
+static M_uint64 M_event_load(M_event_t *event)
+{
+	M_uint64    busy_us  = event->u.loop.load_busy_us;
+	M_uint64    total_us = event->u.loop.load_total_us;
+	M_timeval_t now;
+
+	/* Count the wait or processing in progress, otherwise a loop stuck in a
+	 * long callback, or idle for a long time, would still report the load from
+	 * before it. */
+	if (event->u.loop.threadid != 0) {
+		M_time_elapsed_start(&now);
+		if (event->u.loop.waiting) {
+			total_us += M_event_elapsed_us(&event->u.loop.wait_tv, &now);
+		} else {
+			M_uint64 us = M_event_elapsed_us(&event->u.loop.busy_tv, &now);
+			busy_us    += us;
+			total_us   += us;
+		}
+	}
+
+	if (total_us == 0)
+		return 0;
+	return busy_us * 1000 / total_us;
+}
+
+
 M_event_t *M_event_distribute(M_event_t *event)
 {
 	M_event_t *best_event       = NULL;
-	M_uint64   best_event_time  = 0;    /* Lower is better */
+	M_uint64   best_event_load  = 0;    /* Lower is better */
 	size_t     best_event_count = 0;    /* Lower is better */
 	size_t     i;
 
@@ -600,7 +697,9 @@ M_event_t *M_event_distribute(M_event_t *event)
 
 	/* If a pool, choose the best thread */
 	for (i=0; i<event->u.pool.thread_count; i++) {
-		M_uint64 curr_time  = M_event_get_statistic(&event->u.pool.thread_evloop[i], M_EVENT_STATISTIC_PROCESS_TIME_MS);
+		/* Loads that are close are treated as equal so the object count decides, otherwise a burst of new
+		 * objects would all go to the same thread before its load reflects them. */
+		M_uint64 curr_load  = M_event_get_statistic(&event->u.pool.thread_evloop[i], M_EVENT_STATISTIC_LOAD) / M_EVENT_LOAD_SLACK;
 		size_t   curr_count = M_event_num_objects(&event->u.pool.thread_evloop[i]);
 
 		/* If the event loop has nothing, it automatically wins */
@@ -608,16 +707,16 @@ M_event_t *M_event_distribute(M_event_t *event)
 			return &event->u.pool.thread_evloop[i];
 
 		/* Worse match */
-		if (best_event != NULL && curr_time > best_event_time)
+		if (best_event != NULL && curr_load > best_event_load)
 			continue;
 
 		/* Worse match */
-		if (best_event != NULL && curr_time == best_event_time && curr_count > best_event_count)
+		if (best_event != NULL && curr_load == best_event_load && curr_count > best_event_count)
 			continue;
 
 		/* Best so far */
 		best_event       = &event->u.pool.thread_evloop[i];
-		best_event_time  = curr_time;
+		best_event_load  = curr_load;
 		best_event_count = curr_count;
 	}
 
@@ -654,9 +753,10 @@ M_bool M_event_add(M_event_t *event, M_io_t *comm, M_event_callback_t callback,
 
 	comm->reg_event = event;
 
-	ioev            = M_malloc_zero(sizeof(*ioev));
-	ioev->callback  = callback;
-	ioev->cb_data   = cb_data;
+	ioev                 = M_malloc_zero(sizeof(*ioev));
+	ioev->callback       = callback;
+	ioev->cb_data        = cb_data;
+	ioev->last_active_ms = M_event_now_ms();
 	M_hashtable_insert(event->u.loop.reg_ios, comm, ioev);
 
 	num = M_list_len(comm->layer);
@@ -771,10 +871,124 @@ void M_event_remove(M_io_t *io)
 }
 
 
+static M_bool M_event_pool_queue_task(M_event_t *event, M_event_callback_t callback, void *cb_data)
+{
+	M_event_task_t *task;
+
+	if (callback == NULL)
+		return M_FALSE;
+
+	event          = M_event_distribute(event);
+
+	task           = M_malloc_zero(sizeof(*task));
+	task->callback = callback;
+	task->cb_data  = cb_data;
+
+	M_thread_mutex_lock(event->u.loop.task_lock);
+	M_llist_insert(event->u.loop.tasks, task);
+	M_thread_mutex_unlock(event->u.loop.task_lock);
+
+	M_event_lock(event);
+	M_event_wake(event);
+	M_event_unlock(event);
+
+	return M_TRUE;
+}
+
+
+static size_t M_event_task_count(M_event_t *event)
+{
+	size_t cnt;
+
+	M_thread_mutex_lock(event->u.loop.task_lock);
+	cnt = M_llist_len(event->u.loop.tasks);
+	M_thread_mutex_unlock(event->u.loop.task_lock);
+
+	return cnt;
+}
+
+
+/* Take up to half of the tasks queued on another thread in the pool, oldest
+ * first as they have been waiting the longest.  Event must be locked. */
+static M_bool M_event_task_steal(M_event_t *event)
+{
+	M_event_t      *pool = event->u.loop.parent;
+	M_event_task_t *stolen[M_EVENT_STEAL_MAX];
+	size_t          self;
+	size_t          cnt  = 0;
+	size_t          i;
+	size_t          j;
+
+	if (pool == NULL)
+		return M_FALSE;
+
+	self = (size_t)(event - pool->u.pool.thread_evloop);
+	for (i=1; i<pool->u.pool.thread_count && cnt == 0; i++) {
+		M_event_t *victim = &pool->u.pool.thread_evloop[(self + i) % pool->u.pool.thread_count];
+
+		/* Only one task lock is ever held at a time */
+		M_thread_mutex_lock(victim->u.loop.task_lock);
+		cnt = M_MIN((M_llist_len(victim->u.loop.tasks) + 1) / 2, M_EVENT_STEAL_MAX);
+		for (j=0; j<cnt; j++) {
+			stolen[j] = M_llist_take_node(M_llist_first(victim->u.loop.tasks));
+		}
+		M_thread_mutex_unlock(victim->u.loop.task_lock);
+	}
+
+	if (cnt == 0)
+		return M_FALSE;
+
+	M_thread_mutex_lock(event->u.loop.task_lock);
+	for (j=0; j<cnt; j++) {
+		M_llist_insert(event->u.loop.tasks, stolen[j]);
+	}
+	M_thread_mutex_unlock(event->u.loop.task_lock);
+
+	event->u.loop.tasks_stolen += cnt;
+	return M_TRUE;
+}
+
+
+/* Run tasks queued to the pool.  Only those already queued are run so tasks
+ * queueing more tasks can't keep the loop from getting back to io.  Event must
+ * be locked. */
+static void M_event_task_process(M_event_t *event)
+{
+	size_t cnt = M_event_task_count(event);
+
+	while (cnt-- > 0) {
+		M_event_task_t *task;
+
+		/* Another thread may have taken it in the mean time */
+		M_thread_mutex_lock(event->u.loop.task_lock);
+		task = M_llist_take_node(M_llist_first(event->u.loop.tasks));
+		M_thread_mutex_unlock(event->u.loop.task_lock);
+		if (task == NULL)
+			break;
+
+		event->u.loop.timer_cnt++;
+
+		/* Unlock event lock since the callback may take some time */
+		M_event_unlock(event);
+		task->callback(event, M_EVENT_TYPE_OTHER, NULL, task->cb_data);
+		M_free(task);
+		M_event_lock(event);
+	}
+}
+
+
 M_bool M_event_queue_task(M_event_t *event, M_event_callback_t callback, void *cb_data)
 {
 	M_event_timer_t *timer;
 
+	if (event == NULL)
+		return M_FALSE;
+
+	/* Tasks queued to the pool aren't tied to a thread, anything queued to a
+	 * thread of the pool has to stay there. */
+	if (event->type == M_EVENT_BASE_TYPE_POOL)
+		return M_event_pool_queue_task(event, callback, cb_data);
+
 	timer = M_event_timer_oneshot(event, 0, M_TRUE, callback, cb_data);
 
 	if (timer != NULL) {
@@ -903,8 +1117,9 @@ static void M_event_deliver(M_event_t *event, M_io_t *io, size_t layer_id, M_eve
 		M_event_queue_pending_delivered(event, io, type, num_layers /* User layer */);
 
 		if (ioev != NULL) {
-			callback = ioev->callback;
-			cb_data  = ioev->cb_data;
+			callback             = ioev->callback;
+			cb_data              = ioev->cb_data;
+			ioev->last_active_ms = event->u.loop.now_ms;
 		}
 	}
 
@@ -943,7 +1158,9 @@ static void M_event_queue_deliver(M_event_t *event)
 
 		io = M_CAST_OFF_CONST(M_io_t *, key);
 
-		if (io->flags & M_IO_FLAG_USER_DESTROY)
+		/* Events are cleared when the io object is destroyed by an earlier
+		 * callback, in which case io must not be dereferenced. */
+		if (entry->events[0] == 0 || io->flags & M_IO_FLAG_USER_DESTROY)
 			continue;
 
 		/* Process all events, even if there are no events for this layer, the high
@@ -1226,6 +1443,18 @@ M_uint64 M_event_get_statistic(M_event_t *event, M_event_statistic_t type)
 		case M_EVENT_STATISTIC_PROCESS_TIME_MS:
 			cnt = event->u.loop.process_time_ms;
 			break;
+		case M_EVENT_STATISTIC_LOAD:
+			cnt = M_event_load(event);
+			break;
+		case M_EVENT_STATISTIC_LOAD_EVENTS:
+			cnt = event->u.loop.load_events;
+			break;
+		case M_EVENT_STATISTIC_TASKS_STOLEN:
+			cnt = event->u.loop.tasks_stolen;
+			break;
+		case M_EVENT_STATISTIC_IO_MIGRATED:
+			cnt = event->u.loop.io_migrated;
+			break;
 	}
 	M_event_unlock(event);
 
@@ -1250,8 +1479,8 @@ size_t M_event_num_objects(M_event_t *event)
 	}
 
 	M_event_lock(event);
-	num_objects = M_hashtable_num_keys(event->u.loop.reg_ios) + M_queue_len(event->u.loop.timers);
-//M_printf("%s(): ev:%p io objects = %zu, timers = %zu\n", __FUNCTION__, event, M_hashtable_num_keys(event->u.loop.reg_ios), M_queue_len(event->u.loop.timers));
+	num_objects = M_hashtable_num_keys(event->u.loop.reg_ios) + M_event_timer_count(event) + M_event_task_count(event);
+//M_printf("%s(): ev:%p io objects = %zu, timers = %zu\n", __FUNCTION__, event, M_hashtable_num_keys(event->u.loop.reg_ios), M_event_timer_count(event));
 	if (!(event->u.loop.flags & M_EVENT_FLAG_NOWAKE) && num_objects && event->u.loop.parent_wake)
 		num_objects--;
 	M_event_unlock(event);
@@ -1261,14 +1490,23 @@ size_t M_event_num_objects(M_event_t *event)
 
 #define M_EVENT_LARGE_MEMBERS 32
 
+static M_uint64 M_event_loop_num_events(M_event_t *event)
+{
+	return event->u.loop.osevent_cnt + event->u.loop.softevent_cnt + event->u.loop.timer_cnt;
+}
+
+
 static M_event_err_t M_event_loop_loop(M_event_t *event, M_uint64 timeout_ms)
 {
-	M_timeval_t     event_process_tv;
+	M_timeval_t     now;
 	M_uint64        elapsed   = 0;
+	M_uint64        idle_us;
+	M_uint64        num_events;
 	M_bool          has_events;
 	M_uint64        event_timeout_ms;
 	M_uint64        min_timer_ms;
 	M_bool          has_soft_events;
+	M_bool          has_tasks;
 	size_t          num_objects;
 	M_event_err_t   retval = M_EVENT_ERR_TIMEOUT;
 
@@ -1290,6 +1528,7 @@ static M_event_err_t M_event_loop_loop(M_event_t *event, M_uint64 timeout_ms)
 	event->u.loop.threadid      = M_thread_self();
 
 	M_time_elapsed_start(&event->u.loop.start_tv);
+	event->u.loop.busy_tv       = event->u.loop.start_tv;
 	do {
 		/* User requested we exit the loop */
 		if (event->u.loop.status_change != 0)
@@ -1300,7 +1539,7 @@ static M_event_err_t M_event_loop_loop(M_event_t *event, M_uint64 timeout_ms)
 
 			/* Only count timers if they are not stopped and we haven't been explicitly told not to count them */
 			if (M_event_timer_minimum_ms(event) != M_TIMEOUT_INF && !(event->u.loop.flags & M_EVENT_FLAG_EXITONEMPTY_NOTIMERS))
-				num_objects += M_queue_len(event->u.loop.timers);
+				num_objects += M_event_timer_count(event);
 
 			/* Subtract the internal wake object */
 			if (!(event->u.loop.flags & M_EVENT_FLAG_NOWAKE) && num_objects && event->u.loop.parent_wake)
@@ -1320,6 +1559,12 @@ static M_event_err_t M_event_loop_loop(M_event_t *event, M_uint64 timeout_ms)
 		if (M_llist_len(event->u.loop.soft_events))
 			has_soft_events = M_TRUE;
 
+		/* Rather than go idle, help out other threads in the pool */
+		has_tasks              = M_event_task_count(event) != 0;
+		if (!has_tasks && !has_soft_events && min_timer_ms != 0)
+			has_tasks = M_event_task_steal(event);
+
+		M_time_elapsed_start(&event->u.loop.wait_tv);
 		M_event_unlock(event);
 
 		event_timeout_ms = event->u.loop.timeout_ms;
@@ -1332,7 +1577,7 @@ static M_event_err_t M_event_loop_loop(M_event_t *event, M_uint64 timeout_ms)
 		}
 		if (min_timer_ms < event_timeout_ms)
 			event_timeout_ms = min_timer_ms;
-		if (has_soft_events)
+		if (has_soft_events || has_tasks)
 			event_timeout_ms = 0;
 //M_printf("%s(): ev:%p waiting on events for %llums\n", __FUNCTION__, event, event_timeout_ms);
 		has_events = event->u.loop.impl->wait_event(event, event_timeout_ms);
@@ -1347,7 +1592,10 @@ static M_event_err_t M_event_loop_loop(M_event_t *event, M_uint64 timeout_ms)
 		/* ----- Process Events ----- */
 
 		/* Start recording how much time event processing takes */
-		M_time_elapsed_start(&event_process_tv);
+		M_time_elapsed_start(&event->u.loop.busy_tv);
+		idle_us                          = M_event_elapsed_us(&event->u.loop.wait_tv, &event->u.loop.busy_tv);
+		event->u.loop.now_ms             = (M_uint64)event->u.loop.busy_tv.tv_sec * 1000 + (M_uint64)event->u.loop.busy_tv.tv_usec / 1000;
+		num_events                       = M_event_loop_num_events(event);
 //M_printf("%s(): %p processing soft events\n", __FUNCTION__, event);
 
 		/* Process soft events -- NOTE: we must always process these first, as a CONNECTED event
@@ -1368,6 +1616,9 @@ static M_event_err_t M_event_loop_loop(M_event_t *event, M_uint64 timeout_ms)
 		/* Process timer events */
 		M_event_timer_process(event);
 
+		/* Process tasks queued to the pool */
+		M_event_task_process(event);
+
 
 		/* NOTE: Re-process any soft events that might have been delivered, as calling
 		 * out to a syscall to check for new OS-events can add significant latency
@@ -1379,7 +1630,9 @@ static M_event_err_t M_event_loop_loop(M_event_t *event, M_uint64 timeout_ms)
 
 
 		/* Record event processing time */
-		event->u.loop.process_time_ms += M_time_elapsed(&event_process_tv);
+		event->u.loop.process_time_ms += M_time_elapsed(&event->u.loop.busy_tv);
+		M_time_elapsed_start(&now);
+		M_event_load_update(event, M_event_elapsed_us(&event->u.loop.busy_tv, &now), idle_us, M_event_loop_num_events(event) - num_events);
 		/* ----- End Process Events ----- */
 
 	} while ((elapsed = M_time_elapsed(&event->u.loop.start_tv)) < event->u.loop.timeout_ms);
@@ -1508,3 +1761,166 @@ M_event_t *M_event_get_pool(M_event_t *event)
 	return event->u.loop.parent;
 }
 
+
+M_event_t *M_event_get_pool_thread(M_event_t *event, size_t idx)
+{
+	event = M_event_get_pool(event);
+	if (event == NULL)
+		return NULL;
+
+	if (event->type == M_EVENT_BASE_TYPE_LOOP)
+		return (idx == 0)?event:NULL;
+
+	if (idx >= event->u.pool.thread_count)
+		return NULL;
+
+	return &event->u.pool.thread_evloop[idx];
+}
+
+
+typedef struct {
+	M_event_t *dest;
+	size_t     cnt;
+} M_event_rebalance_t;
+
+
+/* Event must be locked */
+static M_bool M_event_io_can_migrate(M_event_t *event, M_io_t *io, M_event_io_t *ioev)
+{
+	M_event_pending_t *entry = NULL;
+	M_io_state_t       state;
+
+	/* Internal to the event loop */
+	if (io->type == M_IO_TYPE_EVENT)
+		return M_FALSE;
+
+	if (io->flags & (M_IO_FLAG_USER_DISCONNECT|M_IO_FLAG_USER_DESTROY))
+		return M_FALSE;
+
+	/* Soft events would be lost by the move */
+	if (ioev->softevent_node != NULL)
+		return M_FALSE;
+
+	if (event->u.loop.pending_events != NULL && M_hashtable_get(event->u.loop.pending_events, io, (void **)&entry) && entry->events[0] != 0)
+		return M_FALSE;
+
+	/* M_event_add() stamps the current time which can be ahead of the time
+	 * cached by the loop, so that counts as active too. */
+	if (ioev->last_active_ms >= event->u.loop.now_ms || event->u.loop.now_ms - ioev->last_active_ms < M_EVENT_IO_IDLE_MS)
+		return M_FALSE;
+
+	/* Layers drop their timers when removed from the event, which are only in
+	 * use while connecting or disconnecting. */
+	state = M_io_get_state(io);
+	return (state == M_IO_STATE_CONNECTED || state == M_IO_STATE_LISTENING)?M_TRUE:M_FALSE;
+}
+
+
+static void M_event_pool_rebalance_task(M_event_t *event, M_event_type_t type, M_io_t *io, void *cb_arg)
+{
+	M_event_rebalance_t *rebalance = cb_arg;
+	M_list_t            *ios       = M_list_create(NULL, M_LIST_NONE);
+	M_hashtable_enum_t   hashenum;
+	const void          *key;
+	const void          *val;
+	size_t               i;
+
+	(void)type;
+	(void)io;
+
+	M_event_lock(event);
+	M_hashtable_enumerate(event->u.loop.reg_ios, &hashenum);
+	while (M_list_len(ios) < rebalance->cnt && M_hashtable_enumerate_next(event->u.loop.reg_ios, &hashenum, &key, &val)) {
+		M_io_t *mio = M_CAST_OFF_CONST(M_io_t *, key);
+
+		if (!M_event_io_can_migrate(event, mio, M_CAST_OFF_CONST(M_event_io_t *, val)))
+			continue;
+
+		M_list_insert(ios, mio);
+	}
+	M_event_unlock(event);
+
+	/* Runs in the thread the objects belong to, so no callbacks can be
+	 * running for them while they're moved. */
+	for (i=0; i<M_list_len(ios); i++) {
+		M_io_t             *mio      = M_CAST_OFF_CONST(M_io_t *, M_list_at(ios, i));
+		void               *cb_data  = NULL;
+		M_event_callback_t  callback = M_event_get_io_cb(mio, &cb_data);
+
+		M_event_remove(mio);
+		if (!M_event_add(rebalance->dest, mio, callback, cb_data)) {
+			M_event_add(event, mio, callback, cb_data);
+			continue;
+		}
+
+		M_event_lock(rebalance->dest);
+		rebalance->dest->u.loop.io_migrated++;
+		M_event_unlock(rebalance->dest);
+	}
+
+	M_list_destroy(ios, M_FALSE);
+	M_free(rebalance);
+}
+
+
+static size_t M_event_num_ios(M_event_t *event)
+{
+	size_t cnt;
+
+	M_event_lock(event);
+	cnt = M_hashtable_num_keys(event->u.loop.reg_ios);
+	M_event_unlock(event);
+
+	return cnt;
+}
+
+
+M_bool M_event_pool_rebalance(M_event_t *event)
+{
+	M_event_t           *busiest      = NULL;
+	M_event_t           *idlest       = NULL;
+	M_uint64             busiest_load = 0;
+	M_uint64             idlest_load  = 0;
+	size_t               busiest_cnt  = 0;
+	size_t               idlest_cnt   = 0;
+	M_event_rebalance_t *rebalance;
+	size_t               i;
+
+	event = M_event_get_pool(event);
+	if (event == NULL || event->type != M_EVENT_BASE_TYPE_POOL)
+		return M_FALSE;
+
+	for (i=0; i<event->u.pool.thread_count; i++) {
+		M_event_t *thread = &event->u.pool.thread_evloop[i];
+		M_uint64   load   = M_event_get_statistic(thread, M_EVENT_STATISTIC_LOAD);
+		size_t     cnt    = M_event_num_ios(thread);
+
+		if (busiest == NULL || load > busiest_load) {
+			busiest      = thread;
+			busiest_load = load;
+			busiest_cnt  = cnt;
+		}
+
+		if (idlest == NULL || load < idlest_load || (load == idlest_load && cnt < idlest_cnt)) {
+			idlest       = thread;
+			idlest_load  = load;
+			idlest_cnt   = cnt;
+		}
+	}
+
+	if (busiest == idlest || busiest_load < idlest_load + M_EVENT_REBALANCE_LOAD || busiest_cnt <= idlest_cnt + 1)
+		return M_FALSE;
+
+	rebalance       = M_malloc_zero(sizeof(*rebalance));
+	rebalance->dest = idlest;
+	rebalance->cnt  = (busiest_cnt - idlest_cnt) / 2;
+
+	/* Has to run in the thread that owns the objects */
+	if (!M_event_queue_task(busiest, M_event_pool_rebalance_task, rebalance)) {
+		M_free(rebalance);
+		return M_FALSE;
+	}
+
+	return M_TRUE;
+}
+
@@ -80,15 +80,27 @@ struct M_event_io {
 	M_event_callback_t callback;       /*!< User-supplied callback                                       */
 	void              *cb_data;        /*!< Data to pass to user-supplied callback                       */
 	M_llist_node_t    *softevent_node; /*!< Reference to the node in the soft event list for this M_io_t */
+	M_uint64           last_active_ms; /*!< Event loop time of the last event delivered to the callback  */
 };
 typedef struct M_event_io M_event_io_t;
 
+struct M_event_task {
+	M_event_callback_t callback;       /*!< User-supplied callback                 */
+	void              *cb_data;        /*!< Data to pass to user-supplied callback */
+};
+typedef struct M_event_task M_event_task_t;
+
 struct M_event_trigger {
 	M_io_t *io;
 };
 
+struct M_event_timer_wheel;
+typedef struct M_event_timer_wheel M_event_timer_wheel_t;
+
 M_uint64 M_event_timer_minimum_ms(M_event_t *event);
 void M_event_timer_process(M_event_t *event);
+size_t M_event_timer_count(M_event_t *event);
+void M_event_timer_destroy_all(M_event_t *event);
 void M_event_deliver_io(M_event_t *event, M_io_t *io, M_event_type_t type);
 void M_io_softevent_add(M_io_t *io, size_t layer_id, M_event_type_t type, M_io_error_t err);
 
@@ -143,7 +155,7 @@ struct M_event_loop {
 	M_io_t             *parent_wake;          /*!< Event handle for waking self when changes are made */
 	M_bool              waiting;              /*!< Whether or not the event loop is currently blocked waiting on new events (event->impl->wait_event()) */
 
-	M_queue_t          *timers;               /*!< Sorted list of M_event_timer_t members */
+	M_event_timer_wheel_t *timers;            /*!< Timing wheel of M_event_timer_t members */
 
 	M_llist_t          *soft_events;          /*!< Linked list of M_event_softevent_t which are M_event-generated events to turn edge-triggered events into resettable events */
 	M_hashtable_t      *reg_ios;              /*!< M_io_t * to M_event_io_t * for tracking M_io_t handles and associated user callbacks and soft events */
@@ -155,6 +167,18 @@ struct M_event_loop {
 	M_uint64            softevent_cnt;        /*!< Number of soft events */
 	M_uint64            timer_cnt;            /*!< Number of timer events */
 
+	M_timeval_t         wait_tv;              /*!< When the event loop last started waiting, to track idle time */
+	M_timeval_t         busy_tv;              /*!< When the event loop last started processing, to track busy time */
+	M_uint64            now_ms;               /*!< Monotonic time in ms as of the last wake */
+	M_uint64            load_busy_us;         /*!< Recent time spent processing events, decays */
+	M_uint64            load_total_us;        /*!< Recent time spent processing and waiting, decays */
+	M_uint64            load_events;          /*!< Recent number of events processed, decays */
+	M_uint64            tasks_stolen;         /*!< Number of pool tasks taken from other threads in the pool */
+	M_uint64            io_migrated;          /*!< Number of M_io_t objects moved to this loop by rebalancing */
+
+	M_thread_mutex_t   *task_lock;            /*!< Protects tasks. Never held while acquiring another lock */
+	M_llist_t          *tasks;                /*!< M_event_task_t queued to the pool, may be run by any thread in the pool */
+
 	M_event_impl_cbs_t *impl;                 /*!< Which callback is currently in use */
 	M_event_data_t     *impl_data;            /*!< Implementation data used by the registered callbacks above */
 };
@@ -209,6 +233,9 @@ extern struct M_event_impl_cbs M_event_impl_win32;
 extern struct M_event_impl_cbs M_event_impl_kqueue;
 #elif defined(HAVE_EPOLL)
 extern struct M_event_impl_cbs M_event_impl_epoll;
+#  ifdef HAVE_IO_URING
+extern struct M_event_impl_cbs M_event_impl_uring;
+#  endif
 #endif
 
 __END_DECLS
@@ -49,6 +49,43 @@ struct M_event_timer {
 	M_timeval_t          next_run;     /* Next run, based on M_time_elapse_start() */
 	M_timeval_t          last_run;     /* Last run time, to prevent starvation of other tasks */
 	M_bool               executing;    /* If we are currently executing this timer's callback -- make sure we don't really destroy ourselves */
+
+	/* Timing wheel linkage */
+	M_event_timer_t    **list;         /* Wheel slot, stopped or expired list the timer is on, NULL if not queued */
+	M_event_timer_t     *prev;
+	M_event_timer_t     *next;
+};
+
+/* Timers are kept in a hierarchical timing wheel (Varghese and Lauck) keyed by
+ * the millisecond of the elapsed clock they're due in. The first level has a
+ * slot per millisecond for the next 256 ms, each level after it has 64 slots
+ * that each cover a whole rotation of the level below. Starting, stopping and
+ * resetting a timer only links or unlinks it from a slot. When the wheel
+ * reaches a slot boundary of an upper level, the timers in that slot are
+ * moved down to the level that now covers them.
+ *
+ * Five levels cover 2^32 ms (about 49 days), anything later sits in the last
+ * slot and is moved down as time passes. Stopped timers are kept on their own
+ * list so they're still owned by the event. */
+#define M_EVENT_TIMER_WHEEL_BITS0  8
+#define M_EVENT_TIMER_WHEEL_BITS   6
+#define M_EVENT_TIMER_WHEEL_LEVELS 5
+#define M_EVENT_TIMER_WHEEL_SIZE0  (1 << M_EVENT_TIMER_WHEEL_BITS0)
+#define M_EVENT_TIMER_WHEEL_SIZE   (1 << M_EVENT_TIMER_WHEEL_BITS)
+#define M_EVENT_TIMER_WHEEL_SLOTS  (M_EVENT_TIMER_WHEEL_SIZE0 + ((M_EVENT_TIMER_WHEEL_LEVELS - 1) * M_EVENT_TIMER_WHEEL_SIZE))
+#define M_EVENT_TIMER_WHEEL_RANGE  ((M_uint64)1 << (M_EVENT_TIMER_WHEEL_BITS0 + ((M_EVENT_TIMER_WHEEL_LEVELS - 1) * M_EVENT_TIMER_WHEEL_BITS)))
+
+struct M_event_timer_wheel {
+	M_uint64          curr;                                      /*!< Next tick to expire, all earlier ticks are done */
+	M_event_timer_t  *slots[M_EVENT_TIMER_WHEEL_SLOTS];          /*!< Level 0 slots followed by the upper levels */
+	M_uint64          used[M_EVENT_TIMER_WHEEL_SLOTS / 64];      /*!< Bitmap of non-empty slots */
+	size_t            pending;                                   /*!< Number of timers in slots */
+	M_event_timer_t  *due;                                       /*!< Timers started already due */
+	M_event_timer_t  *stopped;                                   /*!< Timers that aren't started */
+	M_event_timer_t  *expired;                                   /*!< Timers being processed */
+	M_event_timer_t **batch;                                     /*!< Scratch space for ordering expired timers */
+	size_t            batch_size;
+	M_hashtable_t    *timers;                                    /*!< All timers owned by the event for lookups of ones that may have been destroyed */
 };
 
 /* Max interval is 30 days (in milliseconds).  This is due to Windows using a 32bit timer
@@ -92,6 +129,225 @@ static int M_event_timer_compar_cb(const void *arg1, const void *arg2, void *thu
 }
 
 
+/* Milliseconds of the elapsed clock, matches the rounding of M_time_timeval_diff() */
+static M_uint64 M_event_timer_tick(const M_timeval_t *tv)
+{
+	if (tv->tv_sec < 0)
+		return 0;
+	return ((M_uint64)tv->tv_sec * 1000) + ((M_uint64)tv->tv_usec / 1000);
+}
+
+
+/* Level 0 slots are one tick, upper level slots are a whole rotation of the
+ * level below. */
+static size_t M_event_timer_wheel_shift(size_t level)
+{
+	if (level == 0)
+		return 0;
+	return M_EVENT_TIMER_WHEEL_BITS0 + ((level - 1) * M_EVENT_TIMER_WHEEL_BITS);
+}
+
+
+static size_t M_event_timer_wheel_base(size_t level)
+{
+	if (level == 0)
+		return 0;
+	return M_EVENT_TIMER_WHEEL_SIZE0 + ((level - 1) * M_EVENT_TIMER_WHEEL_SIZE);
+}
+
+
+static size_t M_event_timer_wheel_size(size_t level)
+{
+	if (level == 0)
+		return M_EVENT_TIMER_WHEEL_SIZE0;
+	return M_EVENT_TIMER_WHEEL_SIZE;
+}
+
+
+static void M_event_timer_list_push(M_event_timer_t **list, M_event_timer_t *timer)
+{
+	timer->list = list;
+	timer->prev = NULL;
+	timer->next = *list;
+	if (*list != NULL)
+		(*list)->prev = timer;
+	*list = timer;
+}
+
+
+static void M_event_timer_wheel_slot_add(M_event_timer_wheel_t *wheel, M_event_timer_t *timer)
+{
+	M_uint64 tick  = M_event_timer_tick(&timer->next_run);
+	M_uint64 delta;
+	size_t   level;
+	size_t   slot;
+
+	/* Already due, run on the next pass without waiting for a tick */
+	if (tick < wheel->curr) {
+		M_event_timer_list_push(&wheel->due, timer);
+		return;
+	}
+
+	delta = tick - wheel->curr;
+	if (delta >= M_EVENT_TIMER_WHEEL_RANGE) {
+		delta = M_EVENT_TIMER_WHEEL_RANGE - 1;
+		tick  = wheel->curr + delta;
+	}
+
+	for (level=0; level<M_EVENT_TIMER_WHEEL_LEVELS-1; level++) {
+		if (delta < ((M_uint64)1 << M_event_timer_wheel_shift(level+1)))
+			break;
+	}
+
+	slot = M_event_timer_wheel_base(level) + (size_t)((tick >> M_event_timer_wheel_shift(level)) & (M_event_timer_wheel_size(level) - 1));
+
+	M_event_timer_list_push(&wheel->slots[slot], timer);
+	wheel->used[slot / 64] |= (M_uint64)1 << (slot % 64);
+	wheel->pending++;
+}
+
+
+static M_event_timer_wheel_t *M_event_timer_wheel_create(void)
+{
+	M_event_timer_wheel_t *wheel = M_malloc_zero(sizeof(*wheel));
+	M_timeval_t            tv;
+
+	M_time_elapsed_start(&tv);
+	wheel->curr   = M_event_timer_tick(&tv);
+	wheel->timers = M_hashtable_create(16, 75, M_hash_func_hash_vp, M_sort_compar_vp, M_HASHTABLE_NONE, NULL);
+	return wheel;
+}
+
+
+static void M_event_timer_wheel_destroy_list(M_event_timer_t *timer)
+{
+	M_event_timer_t *next;
+
+	for ( ; timer != NULL; timer = next) {
+		next = timer->next;
+		M_free(timer);
+	}
+}
+
+
+/* Distance from start to the first used slot of a level going around once, or
+ * size if none are used. */
+static size_t M_event_timer_wheel_find(const M_uint64 *used, size_t size, size_t start)
+{
+	size_t i    = start;
+	size_t dist = 0;
+
+	while (dist < size) {
+		M_uint64 bits = used[i / 64] >> (i % 64);
+
+		if (bits != 0) {
+			dist += M_uint64_log2(bits & (~bits + 1));
+			return dist < size ? dist : size;
+		}
+
+		dist += 64 - (i % 64);
+		i     = (i + 64 - (i % 64)) % size;
+	}
+
+	return size;
+}
+
+
+/* Tick of the next slot with a timer or the next boundary an upper level slot
+ * with timers is moved down at, whichever is first. Nothing can happen before
+ * then. */
+static M_uint64 M_event_timer_wheel_next(const M_event_timer_wheel_t *wheel)
+{
+	M_uint64 next = M_UINT64_MAX;
+	size_t   level;
+
+	if (wheel->pending == 0)
+		return M_UINT64_MAX;
+
+	for (level=0; level<M_EVENT_TIMER_WHEEL_LEVELS; level++) {
+		size_t   shift = M_event_timer_wheel_shift(level);
+		size_t   size  = M_event_timer_wheel_size(level);
+		M_uint64 pos   = (wheel->curr + (((M_uint64)1 << shift) - 1)) >> shift;
+		size_t   dist;
+
+		dist = M_event_timer_wheel_find(wheel->used + (M_event_timer_wheel_base(level) / 64), size, (size_t)(pos & (size - 1)));
+		if (dist != size && ((pos + dist) << shift) < next)
+			next = (pos + dist) << shift;
+	}
+
+	return next;
+}
+
+
+/* Move all timers in an upper level slot down to the levels now covering them. */
+static void M_event_timer_wheel_cascade(M_event_timer_wheel_t *wheel, size_t slot)
+{
+	M_event_timer_t *timer;
+	M_event_timer_t *next;
+
+	timer              = wheel->slots[slot];
+	wheel->slots[slot] = NULL;
+	wheel->used[slot / 64] &= ~((M_uint64)1 << (slot % 64));
+
+	for ( ; timer != NULL; timer = next) {
+		next = timer->next;
+		wheel->pending--;
+		M_event_timer_wheel_slot_add(wheel, timer);
+	}
+}
+
+
+/* Move every timer due at or before now to the expired list. */
+static void M_event_timer_wheel_expire(M_event_timer_wheel_t *wheel, M_uint64 now)
+{
+	M_event_timer_t *timer;
+	M_event_timer_t *next;
+	M_uint64         tick;
+	size_t           level;
+	size_t           slot;
+
+	for (timer = wheel->due; timer != NULL; timer = next) {
+		next = timer->next;
+		M_event_timer_list_push(&wheel->expired, timer);
+	}
+	wheel->due = NULL;
+
+	while ((tick = M_event_timer_wheel_next(wheel)) <= now) {
+		wheel->curr = tick;
+
+		/* Upper levels are moved down starting with the lowest one when
+		 * the wheel passes their slot boundary. */
+		for (level=1; level<M_EVENT_TIMER_WHEEL_LEVELS; level++) {
+			size_t shift = M_event_timer_wheel_shift(level);
+			size_t idx;
+
+			if (tick & (((M_uint64)1 << shift) - 1))
+				break;
+
+			idx = (size_t)((tick >> shift) & (M_EVENT_TIMER_WHEEL_SIZE - 1));
+			M_event_timer_wheel_cascade(wheel, M_event_timer_wheel_base(level) + idx);
+			if (idx != 0)
+				break;
+		}
+
+		slot               = (size_t)(tick & (M_EVENT_TIMER_WHEEL_SIZE0 - 1));
+		timer              = wheel->slots[slot];
+		wheel->slots[slot] = NULL;
+		wheel->used[slot / 64] &= ~((M_uint64)1 << (slot % 64));
+		for ( ; timer != NULL; timer = next) {
+			next = timer->next;
+			wheel->pending--;
+			M_event_timer_list_push(&wheel->expired, timer);
+		}
+
+		wheel->curr = tick + 1;
+	}
+
+	if (wheel->curr <= now)
+		wheel->curr = now + 1;
+}
+
+
 static void M_event_timer_enqueue(M_event_timer_t *timer)
 {
 	M_event_t *event = timer->event;
@@ -100,18 +356,84 @@ static void M_event_timer_enqueue(M_event_timer_t *timer)
 	 *       need timers, so detect that it wasn't initialized and initialize when
 	 *       needed */
 	if (event->u.loop.timers == NULL) {
-		event->u.loop.timers = M_queue_create(M_event_timer_compar_cb, M_free);
+		event->u.loop.timers = M_event_timer_wheel_create();
 	}
 
-	M_queue_insert(event->u.loop.timers, timer);
+	if (timer->list != NULL)
+		return;
+
+	if (timer->started) {
+		M_event_timer_wheel_slot_add(event->u.loop.timers, timer);
+	} else {
+		M_event_timer_list_push(&event->u.loop.timers->stopped, timer);
+	}
 }
 
 
 static void M_event_timer_dequeue(M_event_timer_t *timer)
 {
-	M_event_t *event = timer->event;
+	M_event_timer_wheel_t *wheel = timer->event->u.loop.timers;
+	M_event_timer_t      **list  = timer->list;
+
+	if (list == NULL)
+		return;
+
+	if (timer->prev != NULL) {
+		timer->prev->next = timer->next;
+	} else {
+		*list = timer->next;
+	}
+	if (timer->next != NULL)
+		timer->next->prev = timer->prev;
+
+	if (list >= wheel->slots && list < wheel->slots + M_EVENT_TIMER_WHEEL_SLOTS) {
+		size_t slot = (size_t)(list - wheel->slots);
 
-	M_queue_take(event->u.loop.timers, timer);
+		if (*list == NULL)
+			wheel->used[slot / 64] &= ~((M_uint64)1 << (slot % 64));
+		wheel->pending--;
+	}
+
+	timer->list = NULL;
+	timer->prev = NULL;
+	timer->next = NULL;
+}
+
+
+static void M_event_timer_destroy(M_event_timer_t *timer)
+{
+	M_event_timer_dequeue(timer);
+	M_hashtable_remove(timer->event->u.loop.timers->timers, timer, M_FALSE);
+	M_free(timer);
+}
+
+
+void M_event_timer_destroy_all(M_event_t *event)
+{
+	M_event_timer_wheel_t *wheel = event->u.loop.timers;
+	size_t                 i;
+
+	if (wheel == NULL)
+		return;
+
+	for (i=0; i<M_EVENT_TIMER_WHEEL_SLOTS; i++)
+		M_event_timer_wheel_destroy_list(wheel->slots[i]);
+	M_event_timer_wheel_destroy_list(wheel->due);
+	M_event_timer_wheel_destroy_list(wheel->stopped);
+	M_event_timer_wheel_destroy_list(wheel->expired);
+
+	M_hashtable_destroy(wheel->timers, M_FALSE);
+	M_free(wheel->batch);
+	M_free(wheel);
+	event->u.loop.timers = NULL;
+}
+
+
+size_t M_event_timer_count(M_event_t *event)
+{
+	if (event->u.loop.timers == NULL)
+		return 0;
+	return M_hashtable_num_keys(event->u.loop.timers->timers);
 }
 
 
@@ -133,6 +455,7 @@ M_event_timer_t *M_event_timer_add(M_event_t *event, M_event_callback_t callback
 
 	M_event_lock(timer->event);
 	M_event_timer_enqueue(timer);
+	M_hashtable_insert(event->u.loop.timers->timers, timer, timer);
 	M_event_unlock(timer->event);
 //M_printf("%s(): timer %p created\n", __FUNCTION__, timer); fflush(stdout);
 
@@ -183,10 +506,8 @@ M_bool M_event_timer_remove(M_event_timer_t *timer)
 		return M_TRUE;
 	}
 
-	M_event_timer_dequeue(timer);
 //M_printf("%s(): timer %p destroyed\n", __FUNCTION__, timer); fflush(stdout);
-
-	M_free(timer);
+	M_event_timer_destroy(timer);
 	M_event_unlock(event);
 
 	return M_TRUE;
@@ -201,7 +522,7 @@ static void M_event_timer_remove_cb(M_event_t *event, M_event_type_t type, M_io_
 	(void)io;
 
 	/* Destroyed out from under us */
-	if (!M_queue_exists(event->u.loop.timers, timer))
+	if (event->u.loop.timers == NULL || !M_hashtable_get(event->u.loop.timers->timers, timer, NULL))
 		return;
 
 	M_event_timer_remove(timer);
@@ -490,46 +811,91 @@ M_event_timer_t *M_event_timer_oneshot(M_event_t *event, M_uint64 interval_ms, M
 
 
 /*! Returns time in ms for the minimum timer trigger value, or M_TIMEOUT_INF if there
- *  are no timers.  A lock on M_event_t should already be held before calling this. */
+ *  are no timers.  A lock on M_event_t should already be held before calling this.
+ *
+ *  Timers in upper wheel levels report the time until they're moved down a
+ *  level, which is never later than when they're due. */
 M_uint64 M_event_timer_minimum_ms(M_event_t *event)
 {
-	M_event_timer_t   *timer;
-	M_int64            time_ms;
-	M_timeval_t        curr;
+	M_event_timer_wheel_t *wheel = event->u.loop.timers;
+	M_uint64               next;
+	M_uint64               now;
+	M_timeval_t            curr;
 
-	timer = M_queue_first(event->u.loop.timers);
-	if (timer == NULL) {
+	if (wheel == NULL)
 		return M_TIMEOUT_INF;
-	}
 
-	if (!timer->started) {
+	if (wheel->due != NULL || wheel->expired != NULL)
+		return 0;
+
+	next = M_event_timer_wheel_next(wheel);
+	if (next == M_UINT64_MAX)
 		return M_TIMEOUT_INF;
-	}
 
 	/* Elapsed_start just pulls the current counter */
 	M_time_elapsed_start(&curr);
+	now = M_event_timer_tick(&curr);
 
-	time_ms = M_time_timeval_diff(&curr, &timer->next_run);
-	if (time_ms < 0)
-		time_ms = 0;
-	return (M_uint64)time_ms;
+	if (next <= now)
+		return 0;
+	return next - now;
+}
+
+
+/* Put the expired timers in the order they would have run from a sorted
+ * list. Timers due in the same millisecond run in the order they were
+ * scheduled, and ones that have run most recently go last. */
+static void M_event_timer_wheel_sort_expired(M_event_timer_wheel_t *wheel)
+{
+	M_event_timer_t *timer;
+	size_t           cnt = 0;
+	size_t           i;
+
+	for (timer = wheel->expired; timer != NULL; timer = timer->next)
+		cnt++;
+
+	if (cnt < 2)
+		return;
+
+	if (cnt > wheel->batch_size) {
+		wheel->batch_size = cnt;
+		wheel->batch      = M_realloc(wheel->batch, cnt * sizeof(*wheel->batch));
+	}
+
+	for (timer = wheel->expired, i=0; timer != NULL; timer = timer->next, i++)
+		wheel->batch[i] = timer;
+
+	M_sort_qsort(wheel->batch, cnt, sizeof(*wheel->batch), M_event_timer_compar_cb, NULL);
+
+	wheel->expired = NULL;
+	for (i=cnt; i-->0; )
+		M_event_timer_list_push(&wheel->expired, wheel->batch[i]);
 }
 
 
 /* NOTE: event handle must be locked when this function is called */
 void M_event_timer_process(M_event_t *event)
 {
-	M_event_timer_t   *timer;
-	M_event_timer_t   *last_timer = NULL;
-	M_timeval_t        curr;
-	size_t             cnt = 0;
+	M_event_timer_wheel_t *wheel = event->u.loop.timers;
+	M_event_timer_t       *timer;
+	M_timeval_t            curr;
+	size_t                 cnt = 0;
+
+	if (wheel == NULL)
+		return;
 
 	M_time_elapsed_start(&curr);
 
-	/* Iterate across timers until either we run out or hit one that isn't yet triggered */
-	while ((timer = M_queue_first(event->u.loop.timers)) != NULL && timer != last_timer && timer->started && M_time_timeval_diff(&timer->next_run, &curr) >= 0) {
+	/* Take everything due now as one batch. Timers rescheduled while it runs
+	 * go back in the wheel and wait for the next pass, that way one that
+	 * keeps coming due can't starve the other tasks. */
+	M_event_timer_wheel_expire(wheel, M_event_timer_tick(&curr));
+	M_event_timer_wheel_sort_expired(wheel);
+
+	/* Callbacks may stop, restart or remove other timers in the batch which
+	 * takes them off the expired list. */
+	while ((timer = wheel->expired) != NULL) {
 //M_printf("%s(): processing timer %p\n", __FUNCTION__, timer); fflush(stdout);
-		last_timer = timer;
 		/* We always dequeue the timer from the list as we may add it back in if it is to be rescheduled */
 		M_event_timer_dequeue(timer);
 
@@ -579,13 +945,13 @@ void M_event_timer_process(M_event_t *event)
 
 		/* If autodestroy and timer went to stopped mode, kill it */
 		if (!timer->started && timer->autodestroy) {
-			M_free(timer);
+			M_event_timer_destroy(timer);
 			continue;
 		}
 
 		/* If self-deleted during the callback, cleanup now */
 		if (timer->delay_destroy) {
-			M_free(timer);
+			M_event_timer_destroy(timer);
 			continue;
 		}
 
@@ -599,9 +965,6 @@ void M_event_timer_process(M_event_t *event)
 
 		/* re-enqueue */
 		M_event_timer_enqueue(timer);
-
-		/* Pull current time as we do not know how long this iteration took */
-		M_time_elapsed_start(&curr);
 	}
 
 	event->u.loop.timer_cnt += cnt;
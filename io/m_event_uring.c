@@ -0,0 +1,466 @@
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Monetra Technologies, LLC.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "m_config.h"
+#include <mstdlib/mstdlib_io.h>
+#include "m_event_int.h"
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <endian.h>
+#include <poll.h>
+#include <unistd.h>
+
+/* io_uring based readiness notification.
+ *
+ * Every handle gets a multishot IORING_OP_POLL_ADD which, like EPOLLET, only
+ * posts a completion when the state of the descriptor changes.  The
+ * difference from epoll is in how registrations reach the kernel: adds made
+ * from the event thread (accepted connections, re-arms) are queued in the
+ * submission ring and handed to the kernel by the same io_uring_enter() call
+ * that waits for completions, so a busy loop does one system call per
+ * iteration instead of one epoll_ctl() per change.  Adds from other threads
+ * are submitted right away since the event thread may be blocked in the
+ * kernel.
+ *
+ * Removals are always submitted right away as a pending poll holds a
+ * reference to the file, which would otherwise delay the close of the
+ * descriptor.
+ *
+ * The user_data of each poll is the descriptor in the low 32 bits and a
+ * generation counter in the high 32 bits so completions from a poll that has
+ * since been removed (possibly with the descriptor being reused) can be
+ * ignored.  Entries with a user_data of 0 are POLL_REMOVE requests and carry
+ * no information. */
+
+#define URING_SQ_ENTRIES    256
+#define URING_CQ_ENTRIES    4096
+#define URING_WAIT_EVENTS   64
+
+/* Multishot poll (5.13) has no feature bit of its own, it was released
+ * together with resource tags which do. */
+#define URING_REQUIRED_FEATURES (IORING_FEAT_SINGLE_MMAP|IORING_FEAT_NODROP|IORING_FEAT_EXT_ARG|IORING_FEAT_RSRC_TAGS)
+
+struct M_event_data {
+	int                  ring_fd;
+	void                *ring;
+	size_t               ring_size;
+	struct io_uring_sqe *sqes;
+	size_t               sqes_size;
+
+	unsigned            *sq_head;
+	unsigned            *sq_tail;
+	unsigned             sq_mask;
+	unsigned             sq_entries;
+
+	unsigned            *cq_head;
+	unsigned            *cq_tail;
+	unsigned             cq_mask;
+	struct io_uring_cqe *cq_cqes;
+
+	M_uint32             generation;
+	M_hash_u64u64_t     *armed;       /*!< fd -> user_data of the active poll */
+	M_list_u64_t        *pending_add; /*!< fds that need a poll armed */
+	M_list_u64_t        *pending_del; /*!< user_data of polls that need to be removed */
+
+	struct io_uring_cqe  events[URING_WAIT_EVENTS];
+	int                  nevents;
+};
+
+
+static int M_event_impl_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags, const void *arg, size_t argsz)
+{
+	return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, arg, argsz);
+}
+
+
+static void M_event_impl_uring_data_free(M_event_data_t *data)
+{
+	if (data == NULL)
+		return;
+	if (data->sqes != NULL)
+		munmap(data->sqes, data->sqes_size);
+	if (data->ring != NULL)
+		munmap(data->ring, data->ring_size);
+	/* Closing the ring cancels any polls still armed. */
+	if (data->ring_fd != -1)
+		close(data->ring_fd);
+	M_hash_u64u64_destroy(data->armed);
+	M_list_u64_destroy(data->pending_add);
+	M_list_u64_destroy(data->pending_del);
+	M_free(data);
+}
+
+
+static M_event_data_t *M_event_impl_uring_data_create(void)
+{
+	struct io_uring_params  params;
+	M_event_data_t         *data;
+	M_uint8                *ring;
+	unsigned               *sq_array;
+	unsigned                i;
+
+	data          = M_malloc_zero(sizeof(*data));
+	data->ring_fd = -1;
+
+	M_mem_set(&params, 0, sizeof(params));
+	params.flags      = IORING_SETUP_CQSIZE;
+	params.cq_entries = URING_CQ_ENTRIES;
+
+	/* May fail for reasons other than age, such as a seccomp filter or
+	 * io_uring being disabled by sysctl. */
+	data->ring_fd = (int)syscall(__NR_io_uring_setup, URING_SQ_ENTRIES, &params);
+	if (data->ring_fd == -1)
+		goto fail;
+
+	if ((params.features & URING_REQUIRED_FEATURES) != URING_REQUIRED_FEATURES)
+		goto fail;
+
+	/* With a single mmap the SQ and CQ rings share the same region. */
+	data->ring_size = M_MAX(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+	                        params.cq_off.cqes  + params.cq_entries * sizeof(struct io_uring_cqe));
+	data->ring      = mmap(NULL, data->ring_size, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, data->ring_fd, IORING_OFF_SQ_RING);
+	if (data->ring == MAP_FAILED) {
+		data->ring = NULL;
+		goto fail;
+	}
+
+	data->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+	data->sqes      = mmap(NULL, data->sqes_size, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, data->ring_fd, IORING_OFF_SQES);
+	if (data->sqes == MAP_FAILED) {
+		data->sqes = NULL;
+		goto fail;
+	}
+
+	ring             = data->ring;
+	data->sq_head    = (unsigned *)((void *)(ring + params.sq_off.head));
+	data->sq_tail    = (unsigned *)((void *)(ring + params.sq_off.tail));
+	data->sq_mask    = *(unsigned *)((void *)(ring + params.sq_off.ring_mask));
+	data->sq_entries = params.sq_entries;
+	data->cq_head    = (unsigned *)((void *)(ring + params.cq_off.head));
+	data->cq_tail    = (unsigned *)((void *)(ring + params.cq_off.tail));
+	data->cq_mask    = *(unsigned *)((void *)(ring + params.cq_off.ring_mask));
+	data->cq_cqes    = (struct io_uring_cqe *)((void *)(ring + params.cq_off.cqes));
+
+	/* Submission entries are always used in ring order so the indirection
+	 * array is an identity map. */
+	sq_array = (unsigned *)((void *)(ring + params.sq_off.array));
+	for (i=0; i<params.sq_entries; i++)
+		sq_array[i] = i;
+
+	data->armed       = M_hash_u64u64_create(16, 75, M_HASH_U64U64_NONE);
+	data->pending_add = M_list_u64_create(M_LIST_U64_NONE);
+	data->pending_del = M_list_u64_create(M_LIST_U64_NONE);
+
+	return data;
+
+fail:
+	M_event_impl_uring_data_free(data);
+	return NULL;
+}
+
+
+/* Number of entries in the submission ring the kernel hasn't consumed yet. */
+static unsigned M_event_impl_uring_unsubmitted(M_event_data_t *data)
+{
+	return __atomic_load_n(data->sq_tail, __ATOMIC_ACQUIRE) - __atomic_load_n(data->sq_head, __ATOMIC_ACQUIRE);
+}
+
+
+static void M_event_impl_uring_submit(M_event_data_t *data)
+{
+	unsigned to_submit = M_event_impl_uring_unsubmitted(data);
+
+	if (to_submit == 0)
+		return;
+
+	/* Failure (EAGAIN, EBUSY on a backlogged completion ring) leaves the
+	 * entries in the ring, they go out with the next wait. */
+	M_event_impl_uring_enter(data->ring_fd, to_submit, 0, 0, NULL, 0);
+}
+
+
+/* Must hold the event lock. */
+static struct io_uring_sqe *M_event_impl_uring_get_sqe(M_event_data_t *data)
+{
+	struct io_uring_sqe *sqe;
+	unsigned             tail = *data->sq_tail;
+
+	if (tail - __atomic_load_n(data->sq_head, __ATOMIC_ACQUIRE) >= data->sq_entries) {
+		M_event_impl_uring_submit(data);
+		if (tail - __atomic_load_n(data->sq_head, __ATOMIC_ACQUIRE) >= data->sq_entries)
+			return NULL;
+	}
+
+	sqe = &data->sqes[tail & data->sq_mask];
+	M_mem_set(sqe, 0, sizeof(*sqe));
+	return sqe;
+}
+
+
+static void M_event_impl_uring_put_sqe(M_event_data_t *data)
+{
+	__atomic_store_n(data->sq_tail, *data->sq_tail + 1, __ATOMIC_RELEASE);
+}
+
+
+/* Writes submission entries for everything pending.  Anything that doesn't
+ * fit stays pending and is retried on the next loop iteration.  Must hold the
+ * event lock. */
+static void M_event_impl_uring_flush(M_event_t *event)
+{
+	M_event_data_t      *data = event->u.loop.impl_data;
+	struct io_uring_sqe *sqe;
+
+	while (M_list_u64_len(data->pending_del)) {
+		sqe = M_event_impl_uring_get_sqe(data);
+		if (sqe == NULL)
+			return;
+		sqe->opcode    = IORING_OP_POLL_REMOVE;
+		sqe->fd        = -1;
+		sqe->addr      = M_list_u64_take_first(data->pending_del);
+		sqe->user_data = 0;
+		M_event_impl_uring_put_sqe(data);
+	}
+
+	while (M_list_u64_len(data->pending_add)) {
+		M_event_evhandle_t *member = NULL;
+		M_uint64            fd     = M_list_u64_first(data->pending_add);
+		M_uint32            mask;
+
+		/* Removed before it was ever armed, or listed more than once. */
+		if (!M_hash_u64vp_get(event->u.loop.evhandles, fd, (void **)&member) || M_hash_u64u64_get(data->armed, fd, NULL)) {
+			M_list_u64_take_first(data->pending_add);
+			continue;
+		}
+
+		sqe = M_event_impl_uring_get_sqe(data);
+		if (sqe == NULL)
+			return;
+		M_list_u64_take_first(data->pending_add);
+
+		/* Same as epoll, always listen for read events as that is how a
+		 * closure is reported for write-only pipes. */
+		mask = POLLIN|POLLRDHUP;
+		if (member->caps & M_EVENT_CAPS_WRITE)
+			mask |= POLLOUT;
+#if __BYTE_ORDER == __BIG_ENDIAN
+		mask = (mask << 16) | (mask >> 16);
+#endif
+
+		data->generation++;
+		if (data->generation == 0)
+			data->generation = 1;
+
+		sqe->opcode        = IORING_OP_POLL_ADD;
+		sqe->fd            = (int)fd;
+		sqe->len           = IORING_POLL_ADD_MULTI;
+		sqe->poll32_events = mask;
+		sqe->user_data     = ((M_uint64)data->generation << 32) | fd;
+		M_event_impl_uring_put_sqe(data);
+
+		M_hash_u64u64_insert(data->armed, fd, sqe->user_data);
+	}
+}
+
+
+static void M_event_impl_uring_modify_event(M_event_t *event, M_event_modify_type_t modtype, M_EVENT_HANDLE handle, M_event_wait_type_t waittype, M_event_caps_t caps)
+{
+	M_event_data_t *data = event->u.loop.impl_data;
+	M_uint64        user_data;
+	(void)waittype;
+	(void)caps;
+
+	if (data == NULL)
+		return;
+
+	switch (modtype) {
+		case M_EVENT_MODTYPE_ADD_HANDLE:
+			M_list_u64_insert(data->pending_add, (M_uint64)handle);
+			M_event_impl_uring_flush(event);
+
+			/* The event thread submits along with its next wait, anyone else
+			 * has to submit now as the event thread may be blocked. */
+			if (event->u.loop.threadid != 0 && event->u.loop.threadid != M_thread_self())
+				M_event_impl_uring_submit(data);
+
+			/* Didn't fit in the ring, have the event thread arm it. */
+			if (M_list_u64_len(data->pending_add))
+				M_event_wake(event);
+			break;
+		case M_EVENT_MODTYPE_DEL_HANDLE:
+			if (!M_hash_u64u64_get(data->armed, (M_uint64)handle, &user_data))
+				break;
+			M_hash_u64u64_remove(data->armed, (M_uint64)handle);
+			M_list_u64_insert(data->pending_del, user_data);
+			M_event_impl_uring_flush(event);
+			M_event_impl_uring_submit(data);
+			break;
+		default:
+			return;
+	}
+}
+
+
+static void M_event_impl_uring_data_structure(M_event_t *event)
+{
+	M_hash_u64vp_enum_t *hashenum = NULL;
+	M_event_evhandle_t  *member   = NULL;
+
+	if (event->u.loop.impl_data != NULL) {
+		/* Pick up anything that didn't fit in the ring previously. */
+		M_event_impl_uring_flush(event);
+		return;
+	}
+
+	event->u.loop.impl_data = M_event_impl_uring_data_create();
+	if (event->u.loop.impl_data == NULL) {
+		/* Kernel doesn't have what we need, use epoll instead. */
+		event->u.loop.impl = &M_event_impl_epoll;
+		event->u.loop.impl->data_structure(event);
+		return;
+	}
+
+	M_hash_u64vp_enumerate(event->u.loop.evhandles, &hashenum);
+	while (M_hash_u64vp_enumerate_next(event->u.loop.evhandles, hashenum, NULL, (void **)&member)) {
+		M_list_u64_insert(event->u.loop.impl_data->pending_add, (M_uint64)member->handle);
+	}
+	M_hash_u64vp_enumerate_free(hashenum);
+
+	M_event_impl_uring_flush(event);
+}
+
+
+static M_bool M_event_impl_uring_wait(M_event_t *event, M_uint64 timeout_ms)
+{
+	M_event_data_t                *data = event->u.loop.impl_data;
+	struct io_uring_getevents_arg  arg;
+	struct __kernel_timespec       ts;
+	unsigned                       head;
+	unsigned                       tail;
+
+	data->nevents = 0;
+
+	/* Submit queued registrations and wait in the same call.  Completions
+	 * left over from a previous iteration satisfy the wait immediately. */
+	M_mem_set(&arg, 0, sizeof(arg));
+	if (timeout_ms != M_TIMEOUT_INF) {
+		ts.tv_sec  = (long long)(timeout_ms / 1000);
+		ts.tv_nsec = (long long)(timeout_ms % 1000) * 1000000;
+		arg.ts     = (M_uint64)((M_uintptr)&ts);
+	}
+	M_event_impl_uring_enter(data->ring_fd, M_event_impl_uring_unsubmitted(data), 1, IORING_ENTER_GETEVENTS|IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+
+	/* Only the event thread consumes completions. */
+	head = *data->cq_head;
+	tail = __atomic_load_n(data->cq_tail, __ATOMIC_ACQUIRE);
+	while (head != tail && data->nevents < URING_WAIT_EVENTS) {
+		data->events[data->nevents++] = data->cq_cqes[head & data->cq_mask];
+		head++;
+	}
+	__atomic_store_n(data->cq_head, head, __ATOMIC_RELEASE);
+
+	if (data->nevents > 0) {
+		return M_TRUE;
+	}
+	return M_FALSE;
+}
+
+
+static void M_event_impl_uring_process(M_event_t *event)
+{
+	M_event_data_t *data = event->u.loop.impl_data;
+	size_t          i;
+
+	if (data->nevents <= 0)
+		return;
+
+	/* Process events */
+	for (i=0; i<(size_t)data->nevents; i++) {
+		M_event_evhandle_t *member    = NULL;
+		M_uint64            user_data = data->events[i].user_data;
+		M_uint64            fd        = user_data & 0xFFFFFFFF;
+		M_uint64            armed     = 0;
+		M_uint32            revents;
+
+		/* Removal acknowledgement, or a poll that has since been removed. */
+		if (user_data == 0 || !M_hash_u64u64_get(data->armed, fd, &armed) || armed != user_data)
+			continue;
+
+		/* A multishot poll that stops posting needs to be re-armed.  A
+		 * failed poll is dropped, retrying would likely fail the same way. */
+		if (!(data->events[i].flags & IORING_CQE_F_MORE)) {
+			M_hash_u64u64_remove(data->armed, fd);
+			if (data->events[i].res >= 0) {
+				M_list_u64_insert(data->pending_add, fd);
+			}
+		}
+
+		if (data->events[i].res < 0 || !M_hash_u64vp_get(event->u.loop.evhandles, fd, (void **)&member))
+			continue;
+
+		revents = (M_uint32)data->events[i].res;
+
+		/* Error */
+		if (revents & POLLERR) {
+			/* NOTE: always deliver READ event first on an error to make sure any
+			 *       possible pending data is flushed. */
+			if (member->waittype & M_EVENT_WAIT_READ) {
+				M_event_deliver_io(event, member->io, M_EVENT_TYPE_READ);
+			}
+			M_event_deliver_io(event, member->io, M_EVENT_TYPE_ERROR);
+		}
+
+		/* Read */
+		if (revents & POLLIN) {
+			M_event_deliver_io(event, member->io, M_EVENT_TYPE_READ);
+		}
+
+		/* Disconnect */
+		if (revents & (POLLHUP|POLLRDHUP)) {
+			/* NOTE: always deliver READ event first on a disconnect to make sure any
+			 *       possible pending data is flushed. */
+			if (member->waittype & M_EVENT_WAIT_READ) {
+				M_event_deliver_io(event, member->io, M_EVENT_TYPE_READ);
+			}
+			M_event_deliver_io(event, member->io, M_EVENT_TYPE_DISCONNECTED);
+		}
+
+		/* Write */
+		if (revents & POLLOUT) {
+			M_event_deliver_io(event, member->io, M_EVENT_TYPE_WRITE);
+		}
+	}
+
+	/* Re-arms go out with the next wait. */
+	M_event_impl_uring_flush(event);
+}
+
+
+struct M_event_impl_cbs M_event_impl_uring = {
+	M_event_impl_uring_data_free,
+	M_event_impl_uring_data_structure,
+	M_event_impl_uring_wait,
+	M_event_impl_uring_process,
+	M_event_impl_uring_modify_event
+};
@@ -37,6 +37,9 @@
 #    ifdef __sun__
 #        include <xti.h>
 #    endif
+#    ifdef __linux__
+#        include <linux/filter.h>
+#    endif
 #endif
 
 #include <errno.h>
@@ -63,6 +66,15 @@ typedef int socklen_t;
 /* XXX: currently needed for M_io_setnonblock() which should be moved */
 #include "m_io_int.h"
 
+/* Sharing a port between listeners is only useful if the OS load balances new
+ * connections across them.  FreeBSD needs SO_REUSEPORT_LB for that, other BSDs
+ * and macOS deliver everything to a single listener with plain SO_REUSEPORT. */
+#if defined(SO_REUSEPORT_LB)
+#  define M_IO_NET_SO_REUSEPORT SO_REUSEPORT_LB
+#elif defined(SO_REUSEPORT) && defined(__linux__)
+#  define M_IO_NET_SO_REUSEPORT SO_REUSEPORT
+#endif
+
 /* For some reason this is defined on OS X but we get a compile error. We are
  * setting _DARWIN_C_SOURCE which should allow the define to be used but it's not
  * so we just check if it's defined and if not define it ourselves.
@@ -921,6 +933,16 @@ static M_io_error_t M_io_net_listen_bind_int(M_io_handle_t *handle)
 	(void)rv; /* silence coverity */
 #endif
 
+#ifdef M_IO_NET_SO_REUSEPORT
+	/* Listener shares the port with others, the OS load balances connections between them */
+	if (handle->reuseport && setsockopt(handle->data.net.sock, SOL_SOCKET, M_IO_NET_SO_REUSEPORT, (const void *)&enable, sizeof(enable)) != 0) {
+		M_io_net_resolve_error(handle);
+		close(handle->data.net.sock);
+		M_free(sa);
+		return handle->data.net.last_error;
+	}
+#endif
+
 #ifdef AF_INET6
 	/* Requested ipv6 only, need to set the socket option for this */
 	if (aftype == AF_INET6) {
@@ -1447,7 +1469,7 @@ M_io_t *M_io_netraw_client_create(const char *host, unsigned short port, M_io_ne
 }
 
 
-M_io_error_t M_io_net_server_create(M_io_t **io_out, unsigned short port, const char *bind_ip, M_io_net_type_t type)
+static M_io_error_t M_io_net_server_create_int(M_io_t **io_out, unsigned short port, const char *bind_ip, M_io_net_type_t type, M_bool reuseport)
 {
 	M_io_handle_t    *handle;
 	M_io_callbacks_t *callbacks;
@@ -1467,6 +1489,7 @@ M_io_error_t M_io_net_server_create(M_io_t **io_out, unsigned short port, const
 	handle->host                           = M_strdup(bind_ip);
 	handle->type                           = type;
 	handle->port                           = port;
+	handle->reuseport                      = reuseport;
 	M_io_net_settings_set_default(&handle->settings);
 
 	err = M_io_net_listen_bind(handle);
@@ -1485,6 +1508,73 @@ M_io_error_t M_io_net_server_create(M_io_t **io_out, unsigned short port, const
 }
 
 
+M_io_error_t M_io_net_server_create(M_io_t **io_out, unsigned short port, const char *bind_ip, M_io_net_type_t type)
+{
+	return M_io_net_server_create_int(io_out, port, bind_ip, type, M_FALSE);
+}
+
+
+M_io_error_t M_io_net_server_create_reuseport(M_io_t **io_out, unsigned short port, const char *bind_ip, M_io_net_type_t type)
+{
+#ifdef M_IO_NET_SO_REUSEPORT
+	return M_io_net_server_create_int(io_out, port, bind_ip, type, M_TRUE);
+#else
+	(void)port;
+	(void)bind_ip;
+	(void)type;
+	if (io_out == NULL)
+		return M_IO_ERROR_INVALID;
+	*io_out = NULL;
+	return M_IO_ERROR_NOTIMPL;
+#endif
+}
+
+
+M_bool M_io_net_server_set_cpu_steering(M_io_t *io, size_t num_listeners)
+{
+#if defined(M_IO_NET_SO_REUSEPORT) && defined(SO_ATTACH_REUSEPORT_CBPF)
+	/* A = current cpu; A = A % num_listeners; return A.  The return value is the
+	 * index of the listener in the reuseport group, which is creation order. */
+	struct sock_filter  code[3];
+	struct sock_fprog   prog;
+	M_io_layer_t       *layer;
+	M_io_handle_t      *handle;
+	M_bool              ret    = M_FALSE;
+
+	if (io == NULL || M_io_get_type(io) != M_IO_TYPE_LISTENER || num_listeners == 0 || num_listeners > M_UINT32_MAX)
+		return M_FALSE;
+
+	M_mem_set(code, 0, sizeof(code));
+	code[0].code = BPF_LD | BPF_W | BPF_ABS;
+	code[0].k    = (M_uint32)(SKF_AD_OFF + SKF_AD_CPU);
+	code[1].code = BPF_ALU | BPF_MOD | BPF_K;
+	code[1].k    = (M_uint32)num_listeners;
+	code[2].code = BPF_RET | BPF_A;
+
+	M_mem_set(&prog, 0, sizeof(prog));
+	prog.len    = 3;
+	prog.filter = code;
+
+	layer  = M_io_layer_acquire(io, 0, "NET");
+	handle = M_io_layer_get_handle(layer);
+	if (layer == NULL || handle == NULL)
+		return M_FALSE;
+
+	if (handle->reuseport && handle->state == M_IO_NET_STATE_LISTENING &&
+		setsockopt(handle->data.net.sock, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, (const void *)&prog, sizeof(prog)) == 0) {
+		ret = M_TRUE;
+	}
+
+	M_io_layer_release(layer);
+	return ret;
+#else
+	(void)io;
+	(void)num_listeners;
+	return M_FALSE;
+#endif
+}
+
+
 /* XXX: this shouldn't be here and isn't necessarily right for everything */
 #ifdef _WIN32
 M_bool M_io_setnonblock(SOCKET fd)
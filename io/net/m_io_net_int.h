@@ -91,6 +91,7 @@ struct M_io_handle {
 	M_event_timer_t    *timer;         /*!< Happy Eyeballs (DNS) or connection timer                  */
 	M_bool              notify_down;   /*!< Whether or not a signal has been delivered to notify down */
 	M_bool              is_netdns;     /*!< Whether or not to use the DNS wrapper                     */
+	M_bool              reuseport;     /*!< Listener shares its port with other listeners             */
 	union {
 		struct M_io_handle_net    net;     /*!< used for non-dns */
 		struct M_io_handle_netdns netdns;  /*!< used for dns     */
@@ -0,0 +1,1323 @@
+/* The MIT License (MIT)
+ *
+ * Copyright (c) 2026 Monetra Technologies, LLC.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "m_config.h"
+#include <mstdlib/mstdlib_io.h>
+#include <mstdlib/io/m_io_layer.h>
+#include "m_event_int.h"
+#include "m_io_meta.h"
+#include "base/m_defs_int.h"
+#ifndef _WIN32
+#  include <sys/socket.h>
+#  include <sys/uio.h>
+#  include <netinet/in.h>
+#  include <netinet/udp.h>
+#  include <arpa/inet.h>
+#endif
+
+#include <errno.h>
+#include <string.h>
+#ifndef _WIN32
+#  include <unistd.h>
+#endif
+
+#ifndef HAVE_SOCKLEN_T
+typedef int socklen_t;
+#endif
+
+#ifdef _WIN32
+#  include "m_io_win32_common.h"
+#else
+#  include "m_io_posix_common.h"
+#endif
+
+/* XXX: currently needed for M_io_setnonblock() which should be moved */
+#include "m_io_int.h"
+
+#define M_IO_UDP_NAME              "UDP"
+#define M_IO_UDP_BATCH_DEFAULT     32
+#define M_IO_UDP_BATCH_MAX         1024
+#define M_IO_UDP_DATAGRAM_DEFAULT  9216
+#define M_IO_UDP_DATAGRAM_MAX      65535
+
+#ifdef _WIN32
+#  define RECV_TYPE     char *
+#  define RECV_LEN_TYPE int
+#  define SEND_TYPE     const char *
+#  define SEND_LEN_TYPE int
+#else
+#  define RECV_TYPE     unsigned char *
+#  define RECV_LEN_TYPE size_t
+#  define SEND_TYPE     const unsigned char *
+#  define SEND_LEN_TYPE size_t
+#endif
+
+#if defined(HAVE_RECVMMSG) && defined(UDP_GRO)
+/* Room for the single int the OS reports the GRO segment size in */
+#  define M_IO_UDP_CONTROL_LEN CMSG_SPACE(sizeof(int))
+#endif
+
+#ifdef HAVE_SOCKADDR_STORAGE
+typedef struct sockaddr_storage M_io_udp_addr_t;
+#elif defined(AF_INET6)
+typedef struct sockaddr_in6     M_io_udp_addr_t;
+#else
+typedef struct sockaddr_in      M_io_udp_addr_t;
+#endif
+
+typedef enum {
+	M_IO_UDP_STATE_INIT         = 0,
+	M_IO_UDP_STATE_CONNECTED    = 1,
+	M_IO_UDP_STATE_DISCONNECTED = 2,
+	M_IO_UDP_STATE_ERROR        = 3
+} M_io_udp_state_t;
+
+/*! A queued datagram, either received and waiting to be read or written and waiting to be sent. */
+typedef struct {
+	M_io_udp_addr_t addr;         /*!< Peer address                                   */
+	socklen_t       addr_len;     /*!< Length of peer address, 0 if none (connected)  */
+	size_t          len;          /*!< Length of datagram                             */
+	size_t          segment_size; /*!< GRO segment size if datagrams were coalesced   */
+} M_io_udp_msg_t;
+
+/*! Layer data stored in the user's M_io_meta_t */
+typedef struct {
+	M_io_udp_addr_t addr;         /*!< Peer address                                   */
+	socklen_t       addr_len;     /*!< Length of peer address, 0 if not set           */
+	size_t          segment_size; /*!< GRO segment size of the last read              */
+	char            ipaddr[64];   /*!< Cached string form of addr, empty if not built */
+} M_io_udp_meta_t;
+
+struct M_io_handle {
+	M_EVENT_HANDLE    evhandle;     /*!< Event handle                                     */
+	M_EVENT_SOCKET    sock;         /*!< Socket                                           */
+	M_io_udp_state_t  state;        /*!< Current state                                    */
+	M_io_net_type_t   type;         /*!< Network type                                     */
+	int               family;       /*!< Address family of the socket                     */
+	char             *host;         /*!< Bind address, or peer address for clients        */
+	unsigned short    port;         /*!< Bind port, or peer port for clients              */
+	unsigned short    local_port;   /*!< Port the socket is bound to                      */
+	M_bool            is_client;    /*!< Socket is connected to a single peer             */
+	size_t            gso_size;     /*!< GSO segment size, 0 if disabled                  */
+	M_bool            gro;          /*!< Whether GRO is enabled                           */
+	size_t            batch;        /*!< Datagrams per system call                        */
+	size_t            max_datagram; /*!< Largest datagram that can be received or queued  */
+
+	unsigned char    *rx_data;      /*!< Receive slots, batch * rx_slot bytes             */
+	size_t            rx_slot;      /*!< Size of each receive slot                        */
+	M_io_udp_msg_t   *rx;           /*!< Received datagrams                               */
+	size_t            rx_cnt;       /*!< Number of datagrams received in the last batch   */
+	size_t            rx_idx;       /*!< Next datagram to hand to the user                */
+	M_bool            rx_signaled;  /*!< Soft READ event is pending                       */
+
+	unsigned char    *tx_data;      /*!< Send slots, batch * max_datagram bytes           */
+	M_io_udp_msg_t   *tx;           /*!< Queued datagrams                                 */
+	size_t            tx_cnt;       /*!< Number of queued datagrams                       */
+	size_t            tx_idx;       /*!< Next queued datagram to send                     */
+	M_bool            tx_signaled;  /*!< Soft WRITE event is pending to flush the queue   */
+	M_bool            tx_blocked;   /*!< User was told WOULDBLOCK, owed a WRITE event     */
+
+#ifdef HAVE_RECVMMSG
+	struct mmsghdr   *rx_hdr;
+	struct iovec     *rx_iov;
+	unsigned char    *rx_control;   /*!< GRO control messages, NULL if GRO disabled       */
+#endif
+#ifdef HAVE_SENDMMSG
+	struct mmsghdr   *tx_hdr;
+	struct iovec     *tx_iov;
+#endif
+
+#ifdef _WIN32
+	DWORD             last_error_sys;
+#else
+	int               last_error_sys; /*!< Last recorded system error                     */
+#endif
+	M_io_error_t      last_error;     /*!< Last recorded error mapped                     */
+};
+
+
+static void M_io_udp_resolve_error(M_io_handle_t *handle)
+{
+#ifdef _WIN32
+	handle->last_error_sys = (DWORD)WSAGetLastError();
+	handle->last_error     = M_io_win32_err_to_ioerr(handle->last_error_sys);
+#else
+	handle->last_error_sys = errno;
+	errno                  = 0;
+	handle->last_error     = M_io_posix_err_to_ioerr(handle->last_error_sys);
+#endif
+}
+
+
+/* Errors that only apply to a single datagram (or a prior datagram's ICMP
+ * response) and leave the socket usable */
+static M_bool M_io_udp_error_is_fatal(M_io_error_t err)
+{
+	switch (err) {
+		case M_IO_ERROR_SUCCESS:
+		case M_IO_ERROR_WOULDBLOCK:
+		case M_IO_ERROR_INTERRUPTED:
+		case M_IO_ERROR_CONNREFUSED:
+		case M_IO_ERROR_CONNRESET:
+		case M_IO_ERROR_NETUNREACHABLE:
+		case M_IO_ERROR_TIMEDOUT:
+		case M_IO_ERROR_NOSYSRESOURCES:
+			return M_FALSE;
+		default:
+			break;
+	}
+	return M_TRUE;
+}
+
+
+static M_bool M_io_udp_addr_set(M_io_udp_addr_t *addr, socklen_t *addr_len, const char *ipaddr, unsigned short port)
+{
+	struct in_addr  addr4;
+#ifdef AF_INET6
+	struct in6_addr addr6;
+#endif
+
+	M_mem_set(addr, 0, sizeof(*addr));
+	*addr_len = 0;
+
+	if (M_str_isempty(ipaddr))
+		return M_FALSE;
+
+	if (M_dns_pton(AF_INET, ipaddr, &addr4)) {
+		struct sockaddr_in *sin = (struct sockaddr_in *)((void *)addr);
+		sin->sin_family         = AF_INET;
+		sin->sin_port           = M_hton16(port);
+		M_mem_copy(&sin->sin_addr, &addr4, sizeof(addr4));
+		*addr_len               = sizeof(*sin);
+		return M_TRUE;
+	}
+#ifdef AF_INET6
+	if (M_dns_pton(AF_INET6, ipaddr, &addr6)) {
+		struct sockaddr_in6 *sin6 = (struct sockaddr_in6 *)((void *)addr);
+		sin6->sin6_family         = AF_INET6;
+		sin6->sin6_port           = M_hton16(port);
+		M_mem_copy(&sin6->sin6_addr, &addr6, sizeof(addr6));
+		*addr_len                 = sizeof(*sin6);
+		return M_TRUE;
+	}
+#endif
+	return M_FALSE;
+}
+
+
+/* Get the destination for a write in the form the socket needs */
+static M_io_error_t M_io_udp_addr_dest(const M_io_handle_t *handle, const M_io_udp_meta_t *mdata, M_io_udp_addr_t *addr, socklen_t *addr_len)
+{
+	int family;
+
+	*addr_len = 0;
+
+	/* Connected sockets can only send to their peer */
+	if (handle->is_client)
+		return M_IO_ERROR_SUCCESS;
+
+	if (mdata == NULL || mdata->addr_len == 0)
+		return M_IO_ERROR_INVALID;
+
+	family = ((const struct sockaddr *)((const void *)&mdata->addr))->sa_family;
+	if (family == handle->family) {
+		M_mem_copy(addr, &mdata->addr, (size_t)mdata->addr_len);
+		*addr_len = mdata->addr_len;
+		return M_IO_ERROR_SUCCESS;
+	}
+
+#ifdef AF_INET6
+	/* IPv4 peer on a dual stack socket, send to the IPv4 mapped address */
+	if (handle->family == AF_INET6 && family == AF_INET) {
+		const struct sockaddr_in *sin  = (const struct sockaddr_in *)((const void *)&mdata->addr);
+		struct sockaddr_in6      *sin6 = (struct sockaddr_in6 *)((void *)addr);
+
+		M_mem_set(sin6, 0, sizeof(*sin6));
+		sin6->sin6_family             = AF_INET6;
+		sin6->sin6_port               = sin->sin_port;
+		sin6->sin6_addr.s6_addr[10]   = 0xFF;
+		sin6->sin6_addr.s6_addr[11]   = 0xFF;
+		M_mem_copy(&sin6->sin6_addr.s6_addr[12], &sin->sin_addr, 4);
+		*addr_len = sizeof(*sin6);
+		return M_IO_ERROR_SUCCESS;
+	}
+#endif
+
+	return M_IO_ERROR_INVALID;
+}
+
+
+static M_io_udp_meta_t *M_io_udp_meta_data(M_io_meta_t *meta, M_io_layer_t *layer, M_bool create)
+{
+	M_io_udp_meta_t *mdata;
+
+	mdata = M_io_meta_get_layer_data(meta, layer);
+	if (mdata == NULL && create) {
+		mdata = M_malloc_zero(sizeof(*mdata));
+		M_io_meta_insert_layer_data(meta, layer, mdata, M_free);
+	}
+	return mdata;
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static void M_io_udp_buffers_free(M_io_handle_t *handle)
+{
+	M_free(handle->rx_data);
+	M_free(handle->rx);
+	M_free(handle->tx_data);
+	M_free(handle->tx);
+	handle->rx_data = NULL;
+	handle->rx      = NULL;
+	handle->tx_data = NULL;
+	handle->tx      = NULL;
+	handle->rx_cnt  = 0;
+	handle->rx_idx  = 0;
+	handle->tx_cnt  = 0;
+	handle->tx_idx  = 0;
+#ifdef HAVE_RECVMMSG
+	M_free(handle->rx_hdr);
+	M_free(handle->rx_iov);
+	M_free(handle->rx_control);
+	handle->rx_hdr     = NULL;
+	handle->rx_iov     = NULL;
+	handle->rx_control = NULL;
+#endif
+#ifdef HAVE_SENDMMSG
+	M_free(handle->tx_hdr);
+	M_free(handle->tx_iov);
+	handle->tx_hdr = NULL;
+	handle->tx_iov = NULL;
+#endif
+}
+
+
+/* Buffers are allocated on first use since many sockets only ever read or only ever write */
+static void M_io_udp_rx_alloc(M_io_handle_t *handle)
+{
+#ifdef HAVE_RECVMMSG
+	size_t i;
+#endif
+
+	if (handle->rx != NULL)
+		return;
+
+	handle->rx_slot = handle->gro?M_IO_UDP_DATAGRAM_MAX:handle->max_datagram;
+	handle->rx_data = M_malloc(handle->batch * handle->rx_slot);
+	handle->rx      = M_malloc_zero(handle->batch * sizeof(*handle->rx));
+
+#ifdef HAVE_RECVMMSG
+	handle->rx_hdr  = M_malloc_zero(handle->batch * sizeof(*handle->rx_hdr));
+	handle->rx_iov  = M_malloc_zero(handle->batch * sizeof(*handle->rx_iov));
+#  ifdef M_IO_UDP_CONTROL_LEN
+	if (handle->gro)
+		handle->rx_control = M_malloc_zero(handle->batch * M_IO_UDP_CONTROL_LEN);
+#  endif
+	for (i=0; i<handle->batch; i++) {
+		handle->rx_iov[i].iov_base        = handle->rx_data + (i * handle->rx_slot);
+		handle->rx_hdr[i].msg_hdr.msg_name = &handle->rx[i].addr;
+		handle->rx_hdr[i].msg_hdr.msg_iov  = &handle->rx_iov[i];
+		handle->rx_hdr[i].msg_hdr.msg_iovlen = 1;
+	}
+#endif
+}
+
+
+static void M_io_udp_tx_alloc(M_io_handle_t *handle)
+{
+#ifdef HAVE_SENDMMSG
+	size_t i;
+#endif
+
+	if (handle->tx != NULL)
+		return;
+
+	handle->tx_data = M_malloc(handle->batch * handle->max_datagram);
+	handle->tx      = M_malloc_zero(handle->batch * sizeof(*handle->tx));
+
+#ifdef HAVE_SENDMMSG
+	handle->tx_hdr  = M_malloc_zero(handle->batch * sizeof(*handle->tx_hdr));
+	handle->tx_iov  = M_malloc_zero(handle->batch * sizeof(*handle->tx_iov));
+	for (i=0; i<handle->batch; i++) {
+		handle->tx_iov[i].iov_base           = handle->tx_data + (i * handle->max_datagram);
+		handle->tx_hdr[i].msg_hdr.msg_iov    = &handle->tx_iov[i];
+		handle->tx_hdr[i].msg_hdr.msg_iovlen = 1;
+	}
+#endif
+}
+
+
+#if defined(HAVE_RECVMMSG) && defined(M_IO_UDP_CONTROL_LEN)
+static size_t M_io_udp_gro_segment_size(struct msghdr *msg)
+{
+	struct cmsghdr *cmsg;
+	int             segment_size;
+
+	for (cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL; cmsg = CMSG_NXTHDR(msg, cmsg)) {
+		if (cmsg->cmsg_level == IPPROTO_UDP && cmsg->cmsg_type == UDP_GRO) {
+			M_mem_copy(&segment_size, CMSG_DATA(cmsg), sizeof(segment_size));
+			return segment_size > 0?(size_t)segment_size:0;
+		}
+	}
+	return 0;
+}
+#endif
+
+
+/* Receive as many datagrams as are available, up to the batch size */
+static M_io_error_t M_io_udp_rx_fill(M_io_handle_t *handle)
+{
+	ssize_t rv;
+	size_t  i;
+
+	M_io_udp_rx_alloc(handle);
+	handle->rx_cnt = 0;
+	handle->rx_idx = 0;
+
+#ifdef HAVE_RECVMMSG
+	for (i=0; i<handle->batch; i++) {
+		struct msghdr *hdr = &handle->rx_hdr[i].msg_hdr;
+
+		handle->rx_iov[i].iov_len = handle->rx_slot;
+		hdr->msg_namelen          = sizeof(handle->rx[i].addr);
+		hdr->msg_flags            = 0;
+#  ifdef M_IO_UDP_CONTROL_LEN
+		if (handle->rx_control != NULL) {
+			hdr->msg_control    = handle->rx_control + (i * M_IO_UDP_CONTROL_LEN);
+			hdr->msg_controllen = M_IO_UDP_CONTROL_LEN;
+		}
+#  endif
+	}
+
+	errno = 0;
+	rv    = recvmmsg(handle->sock, handle->rx_hdr, (unsigned int)handle->batch, 0, NULL);
+	if (rv < 0) {
+		M_io_udp_resolve_error(handle);
+		return handle->last_error;
+	}
+
+	for (i=0; i<(size_t)rv; i++) {
+		handle->rx[i].len          = handle->rx_hdr[i].msg_len;
+		handle->rx[i].addr_len     = handle->rx_hdr[i].msg_hdr.msg_namelen;
+		handle->rx[i].segment_size = 0;
+#  ifdef M_IO_UDP_CONTROL_LEN
+		if (handle->rx_control != NULL)
+			handle->rx[i].segment_size = M_io_udp_gro_segment_size(&handle->rx_hdr[i].msg_hdr);
+#  endif
+	}
+	handle->rx_cnt = (size_t)rv;
+#else
+	for (i=0; i<handle->batch; i++) {
+		M_io_udp_msg_t *msg = &handle->rx[i];
+
+		msg->addr_len     = sizeof(msg->addr);
+		msg->segment_size = 0;
+		errno             = 0;
+		rv                = (ssize_t)recvfrom(handle->sock, (RECV_TYPE)(handle->rx_data + (i * handle->rx_slot)), (RECV_LEN_TYPE)handle->rx_slot, 0, (struct sockaddr *)((void *)&msg->addr), &msg->addr_len);
+		if (rv < 0) {
+			/* Only report an error if nothing was received, otherwise it will be seen next time */
+			if (i == 0) {
+				M_io_udp_resolve_error(handle);
+				return handle->last_error;
+			}
+			break;
+		}
+		msg->len = (size_t)rv;
+	}
+	handle->rx_cnt = i;
+#endif
+
+	return M_IO_ERROR_SUCCESS;
+}
+
+
+static M_io_error_t M_io_udp_send(M_io_handle_t *handle, const unsigned char *buf, size_t len, const M_io_udp_addr_t *addr, socklen_t addr_len)
+{
+	ssize_t rv;
+
+	errno = 0;
+	rv    = (ssize_t)sendto(handle->sock, (SEND_TYPE)buf, (SEND_LEN_TYPE)len, 0, addr_len?(const struct sockaddr *)((const void *)addr):NULL, addr_len);
+	if (rv < 0) {
+		M_io_udp_resolve_error(handle);
+		return handle->last_error;
+	}
+	return M_IO_ERROR_SUCCESS;
+}
+
+
+/* Send everything queued.  Returns M_IO_ERROR_WOULDBLOCK if the OS can't take
+ * it all right now, anything not sent remains queued. */
+static M_io_error_t M_io_udp_tx_flush(M_io_handle_t *handle)
+{
+	while (handle->tx_idx < handle->tx_cnt) {
+#ifdef HAVE_SENDMMSG
+		int rv;
+
+		errno = 0;
+		rv    = sendmmsg(handle->sock, &handle->tx_hdr[handle->tx_idx], (unsigned int)(handle->tx_cnt - handle->tx_idx), 0);
+		if (rv > 0) {
+			handle->tx_idx += (size_t)rv;
+			continue;
+		}
+		M_io_udp_resolve_error(handle);
+#else
+		M_io_udp_msg_t *msg = &handle->tx[handle->tx_idx];
+
+		if (M_io_udp_send(handle, handle->tx_data + (handle->tx_idx * handle->max_datagram), msg->len, &msg->addr, msg->addr_len) == M_IO_ERROR_SUCCESS) {
+			handle->tx_idx++;
+			continue;
+		}
+#endif
+		if (handle->last_error == M_IO_ERROR_WOULDBLOCK)
+			return M_IO_ERROR_WOULDBLOCK;
+
+		/* Drop the datagram that failed, delivery isn't guaranteed anyhow */
+		handle->tx_idx++;
+	}
+
+	handle->tx_cnt = 0;
+	handle->tx_idx = 0;
+	return M_IO_ERROR_SUCCESS;
+}
+
+
+static void M_io_udp_tx_queue(M_io_handle_t *handle, const unsigned char *buf, size_t len, const M_io_udp_addr_t *addr, socklen_t addr_len)
+{
+	M_io_udp_msg_t *msg;
+
+	M_io_udp_tx_alloc(handle);
+
+	msg           = &handle->tx[handle->tx_cnt];
+	msg->len      = len;
+	msg->addr_len = addr_len;
+	if (addr_len)
+		M_mem_copy(&msg->addr, addr, (size_t)addr_len);
+	M_mem_copy(handle->tx_data + (handle->tx_cnt * handle->max_datagram), buf, len);
+
+#ifdef HAVE_SENDMMSG
+	handle->tx_iov[handle->tx_cnt].iov_len            = len;
+	handle->tx_hdr[handle->tx_cnt].msg_hdr.msg_name    = addr_len?&msg->addr:NULL;
+	handle->tx_hdr[handle->tx_cnt].msg_hdr.msg_namelen = addr_len;
+#endif
+
+	handle->tx_cnt++;
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static M_bool M_io_udp_set_sockopt_int(M_io_handle_t *handle, int optname, int val)
+{
+	if (handle->sock == M_EVENT_INVALID_SOCKET)
+		return M_TRUE;
+
+	if (setsockopt(handle->sock, IPPROTO_UDP, optname, (const void *)&val, sizeof(val)) != 0) {
+		M_io_udp_resolve_error(handle);
+		return M_FALSE;
+	}
+	return M_TRUE;
+}
+
+
+static void M_io_udp_close(M_io_t *io, M_io_handle_t *handle)
+{
+	M_event_t *event = M_io_get_event(io);
+
+	if (handle->evhandle == M_EVENT_INVALID_HANDLE && handle->sock == M_EVENT_INVALID_SOCKET)
+		return;
+
+	if (event)
+		M_event_handle_modify(event, M_EVENT_MODTYPE_DEL_HANDLE, io, handle->evhandle, handle->sock, 0, 0);
+#ifdef _WIN32
+	if (handle->sock != M_EVENT_INVALID_SOCKET && handle->evhandle != M_EVENT_INVALID_HANDLE)
+		WSAEventSelect(handle->sock, handle->evhandle, 0);
+	if (handle->sock != M_EVENT_INVALID_SOCKET)
+		closesocket(handle->sock);
+	if (handle->evhandle != M_EVENT_INVALID_HANDLE)
+		WSACloseEvent(handle->evhandle);
+#else
+	if (handle->sock != M_EVENT_INVALID_SOCKET)
+		close(handle->sock);
+#endif
+	handle->evhandle = M_EVENT_INVALID_HANDLE;
+	handle->sock     = M_EVENT_INVALID_SOCKET;
+}
+
+
+static void M_io_udp_close_sock(M_io_handle_t *handle)
+{
+#ifdef _WIN32
+	closesocket(handle->sock);
+#else
+	close(handle->sock);
+#endif
+	handle->sock = M_EVENT_INVALID_SOCKET;
+}
+
+
+static M_io_error_t M_io_udp_open(M_io_handle_t *handle)
+{
+	M_io_udp_addr_t  addr;
+	M_io_udp_addr_t  local;
+	socklen_t        addr_len;
+	socklen_t        local_len = sizeof(local);
+	const char      *ipaddr    = handle->host;
+	int              type      = SOCK_DGRAM;
+	int              enable;
+
+	/* No bind address means all interfaces, pick based on the type requested */
+	if (!handle->is_client && M_str_isempty(ipaddr)) {
+#ifdef AF_INET6
+		if (handle->type == M_IO_NET_ANY || handle->type == M_IO_NET_IPV6)
+			ipaddr = "::";
+#endif
+		if (ipaddr == NULL && (handle->type == M_IO_NET_ANY || handle->type == M_IO_NET_IPV4))
+			ipaddr = "0.0.0.0";
+	}
+
+	if (!M_io_udp_addr_set(&addr, &addr_len, ipaddr, handle->port))
+		return M_IO_ERROR_INVALID;
+
+	handle->family = ((struct sockaddr *)((void *)&addr))->sa_family;
+
+	/* Explicit type requested must match the address given */
+#ifdef AF_INET6
+	if (handle->type == M_IO_NET_IPV6 && handle->family != AF_INET6)
+		return M_IO_ERROR_INVALID;
+#endif
+	if (handle->type == M_IO_NET_IPV4 && handle->family != AF_INET)
+		return M_IO_ERROR_INVALID;
+
+#ifdef SOCK_CLOEXEC
+	type |= SOCK_CLOEXEC;
+#endif
+	handle->sock = socket(handle->family, type, IPPROTO_UDP);
+	if (handle->sock == M_EVENT_INVALID_SOCKET) {
+		M_io_udp_resolve_error(handle);
+		return handle->last_error;
+	}
+#if !defined(SOCK_CLOEXEC) && !defined(_WIN32)
+	M_io_posix_fd_set_closeonexec(handle->sock, M_TRUE);
+#endif
+
+#if defined(AF_INET6) && defined(IPV6_V6ONLY)
+	/* Some OS's may set IPV6_V6ONLY on by default.  So always override the flag
+	 * with our intended behavior */
+	if (handle->family == AF_INET6) {
+		enable = (handle->type == M_IO_NET_IPV6)?1:0;
+		(void)setsockopt(handle->sock, IPPROTO_IPV6, IPV6_V6ONLY, (const void *)&enable, sizeof(enable));
+	}
+#endif
+
+	/* NOTE: SO_REUSEADDR is intentionally not set, for UDP it allows multiple
+	 *       sockets to bind the same port and silently steal each other's datagrams */
+	if (handle->is_client) {
+		if (connect(handle->sock, (struct sockaddr *)((void *)&addr), addr_len) != 0) {
+			M_io_udp_resolve_error(handle);
+			M_io_udp_close_sock(handle);
+			return handle->last_error;
+		}
+	} else {
+		if (bind(handle->sock, (struct sockaddr *)((void *)&addr), addr_len) != 0) {
+			M_io_udp_resolve_error(handle);
+#ifdef _WIN32
+			if (handle->last_error == M_IO_ERROR_NOTPERM)
+				handle->last_error = M_IO_ERROR_ADDRINUSE;
+#endif
+			M_io_udp_close_sock(handle);
+			return handle->last_error;
+		}
+	}
+
+	M_mem_set(&local, 0, sizeof(local));
+	if (getsockname(handle->sock, (struct sockaddr *)((void *)&local), &local_len) == 0) {
+		if (((struct sockaddr *)((void *)&local))->sa_family == AF_INET) {
+			handle->local_port = M_ntoh16(((struct sockaddr_in *)((void *)&local))->sin_port);
+#ifdef AF_INET6
+		} else if (((struct sockaddr *)((void *)&local))->sa_family == AF_INET6) {
+			handle->local_port = M_ntoh16(((struct sockaddr_in6 *)((void *)&local))->sin6_port);
+#endif
+		}
+	}
+
+	/* port of 0 means let the OS assign, record it so a re-open binds the same port */
+	if (!handle->is_client && handle->port == 0)
+		handle->port = handle->local_port;
+
+	/* Re-apply offloads on a re-open */
+#ifdef UDP_SEGMENT
+	if (handle->gso_size != 0)
+		M_io_udp_set_sockopt_int(handle, UDP_SEGMENT, (int)handle->gso_size);
+#endif
+#ifdef UDP_GRO
+	if (handle->gro)
+		M_io_udp_set_sockopt_int(handle, UDP_GRO, 1);
+#endif
+
+	M_io_setnonblock(handle->sock);
+#ifdef _WIN32
+	handle->evhandle = WSACreateEvent();
+	WSAEventSelect(handle->sock, handle->evhandle, FD_READ|FD_WRITE);
+#else
+	handle->evhandle = handle->sock;
+#endif
+
+	handle->state          = M_IO_UDP_STATE_CONNECTED;
+	handle->last_error     = M_IO_ERROR_SUCCESS;
+	handle->last_error_sys = 0;
+	return M_IO_ERROR_SUCCESS;
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static M_bool M_io_udp_init_cb(M_io_layer_t *layer)
+{
+	M_io_t        *io     = M_io_layer_get_io(layer);
+	M_io_handle_t *handle = M_io_layer_get_handle(layer);
+	M_event_t     *event  = M_io_get_event(io);
+	M_io_error_t   err;
+
+	if (handle->state == M_IO_UDP_STATE_INIT) {
+		err = M_io_udp_open(handle);
+		if (err != M_IO_ERROR_SUCCESS) {
+			handle->state = M_IO_UDP_STATE_ERROR;
+			M_io_layer_softevent_add(layer, M_FALSE, M_EVENT_TYPE_ERROR, err);
+			return M_TRUE;
+		}
+	}
+
+	if (handle->state != M_IO_UDP_STATE_CONNECTED)
+		return M_TRUE;
+
+	M_event_handle_modify(event, M_EVENT_MODTYPE_ADD_HANDLE, io, handle->evhandle, handle->sock, M_EVENT_WAIT_READ, M_EVENT_CAPS_READ|M_EVENT_CAPS_WRITE);
+	M_io_layer_softevent_add(layer, M_FALSE, M_EVENT_TYPE_CONNECTED, M_IO_ERROR_SUCCESS);
+
+	/* Anything left over from a previous event loop still needs to be delivered */
+	handle->rx_signaled = M_FALSE;
+	handle->tx_signaled = M_FALSE;
+	if (handle->rx_idx < handle->rx_cnt) {
+		handle->rx_signaled = M_TRUE;
+		M_io_layer_softevent_add(layer, M_FALSE, M_EVENT_TYPE_READ, M_IO_ERROR_SUCCESS);
+	}
+	if (handle->tx_cnt != 0) {
+		handle->tx_signaled = M_TRUE;
+		M_io_layer_softevent_add(layer, M_FALSE, M_EVENT_TYPE_WRITE, M_IO_ERROR_SUCCESS);
+	}
+
+	return M_TRUE;
+}
+
+
+static M_io_error_t M_io_udp_read_cb(M_io_layer_t *layer, unsigned char *buf, size_t *read_len, M_io_meta_t *meta)
+{
+	M_io_handle_t   *handle = M_io_layer_get_handle(layer);
+	M_io_t          *io     = M_io_layer_get_io(layer);
+	M_event_t       *event  = M_io_get_event(io);
+	M_io_udp_msg_t  *msg;
+	M_io_udp_meta_t *mdata;
+	M_io_error_t     err;
+
+	if (layer == NULL || buf == NULL || read_len == NULL || *read_len == 0)
+		return M_IO_ERROR_INVALID;
+
+	if (handle->state != M_IO_UDP_STATE_CONNECTED)
+		return (handle->state == M_IO_UDP_STATE_DISCONNECTED)?M_IO_ERROR_DISCONNECT:M_IO_ERROR_NOTCONNECTED;
+
+	if (handle->rx_idx == handle->rx_cnt) {
+		err = M_io_udp_rx_fill(handle);
+		if (err != M_IO_ERROR_SUCCESS) {
+			if (M_io_udp_error_is_fatal(err)) {
+				M_io_udp_close(io, handle);
+				handle->state = M_IO_UDP_STATE_ERROR;
+			} else {
+				M_event_handle_modify(event, M_EVENT_MODTYPE_ADD_WAITTYPE, io, handle->evhandle, handle->sock, M_EVENT_WAIT_READ, 0);
+			}
+			return err;
+		}
+	}
+
+	msg = &handle->rx[handle->rx_idx];
+
+	/* Datagram semantics, whatever doesn't fit is discarded */
+	if (*read_len > msg->len)
+		*read_len = msg->len;
+	M_mem_copy(buf, handle->rx_data + (handle->rx_idx * handle->rx_slot), *read_len);
+
+	if (meta != NULL) {
+		mdata               = M_io_udp_meta_data(meta, layer, M_TRUE);
+		mdata->addr_len     = msg->addr_len;
+		mdata->segment_size = (msg->segment_size != 0 && msg->len > msg->segment_size)?msg->segment_size:0;
+		mdata->ipaddr[0]    = '\0';
+		if (msg->addr_len)
+			M_mem_copy(&mdata->addr, &msg->addr, (size_t)msg->addr_len);
+	}
+
+	handle->rx_idx++;
+
+	/* Once drained wait on the OS, otherwise make sure the user is told there's
+	 * more waiting as the OS won't signal for data we already pulled */
+	if (handle->rx_idx == handle->rx_cnt) {
+		M_event_handle_modify(event, M_EVENT_MODTYPE_ADD_WAITTYPE, io, handle->evhandle, handle->sock, M_EVENT_WAIT_READ, 0);
+	} else if (!handle->rx_signaled && event != NULL) {
+		handle->rx_signaled = M_TRUE;
+		M_io_layer_softevent_add(layer, M_FALSE, M_EVENT_TYPE_READ, M_IO_ERROR_SUCCESS);
+	}
+
+	return M_IO_ERROR_SUCCESS;
+}
+
+
+static M_io_error_t M_io_udp_write_cb(M_io_layer_t *layer, const unsigned char *buf, size_t *write_len, M_io_meta_t *meta)
+{
+	M_io_handle_t   *handle = M_io_layer_get_handle(layer);
+	M_io_t          *io     = M_io_layer_get_io(layer);
+	M_event_t       *event  = M_io_get_event(io);
+	M_io_udp_meta_t *mdata  = NULL;
+	M_io_udp_addr_t  addr;
+	socklen_t        addr_len;
+	M_io_error_t     err;
+
+	if (layer == NULL || buf == NULL || write_len == NULL || *write_len == 0)
+		return M_IO_ERROR_INVALID;
+
+	if (handle->state != M_IO_UDP_STATE_CONNECTED)
+		return (handle->state == M_IO_UDP_STATE_DISCONNECTED)?M_IO_ERROR_DISCONNECT:M_IO_ERROR_NOTCONNECTED;
+
+	if (meta != NULL)
+		mdata = M_io_udp_meta_data(meta, layer, M_FALSE);
+
+	err = M_io_udp_addr_dest(handle, mdata, &addr, &addr_len);
+	if (err != M_IO_ERROR_SUCCESS)
+		return err;
+
+	/* Need room in the queue */
+	if (handle->tx_cnt == handle->batch && M_io_udp_tx_flush(handle) == M_IO_ERROR_WOULDBLOCK)
+		goto wouldblock;
+
+	/* Without an event loop there's nothing to flush the queue later, and datagrams
+	 * too large for a slot (e.g. GSO) go out directly.  Anything queued is sent first
+	 * to preserve ordering. */
+	if (event == NULL || handle->batch == 1 || *write_len > handle->max_datagram) {
+		if (M_io_udp_tx_flush(handle) == M_IO_ERROR_WOULDBLOCK)
+			goto wouldblock;
+
+		err = M_io_udp_send(handle, buf, *write_len, &addr, addr_len);
+		if (err == M_IO_ERROR_WOULDBLOCK)
+			goto wouldblock;
+		return err;
+	}
+
+	M_io_udp_tx_queue(handle, buf, *write_len, &addr, addr_len);
+
+	/* Flush once control returns to the event loop so writes made together are sent together */
+	if (!handle->tx_signaled) {
+		handle->tx_signaled = M_TRUE;
+		M_io_layer_softevent_add(layer, M_FALSE, M_EVENT_TYPE_WRITE, M_IO_ERROR_SUCCESS);
+	}
+
+	return M_IO_ERROR_SUCCESS;
+
+wouldblock:
+	handle->tx_blocked = M_TRUE;
+	M_event_handle_modify(event, M_EVENT_MODTYPE_ADD_WAITTYPE, io, handle->evhandle, handle->sock, M_EVENT_WAIT_WRITE, 0);
+	return M_IO_ERROR_WOULDBLOCK;
+}
+
+
+static M_bool M_io_udp_process_cb(M_io_layer_t *layer, M_event_type_t *type)
+{
+	M_io_handle_t *handle = M_io_layer_get_handle(layer);
+	M_io_t        *io     = M_io_layer_get_io(layer);
+	M_event_t     *event  = M_io_get_event(io);
+	M_io_error_t   err;
+
+	/* Only pass thru DISCONNECT or ERROR events that may not yet have been delivered */
+	if (handle->state != M_IO_UDP_STATE_CONNECTED) {
+		if (*type == M_EVENT_TYPE_DISCONNECTED || *type == M_EVENT_TYPE_ERROR)
+			return M_FALSE;
+		return M_TRUE;
+	}
+
+	switch (*type) {
+		case M_EVENT_TYPE_READ:
+			handle->rx_signaled = M_FALSE;
+
+			/* Pull the next batch now so the user is only told about real data */
+			err = M_IO_ERROR_SUCCESS;
+			if (handle->rx_idx == handle->rx_cnt)
+				err = M_io_udp_rx_fill(handle);
+
+			if (err == M_IO_ERROR_SUCCESS) {
+				/* The OS doesn't need to tell us about more until what we have is read */
+				M_event_handle_modify(event, M_EVENT_MODTYPE_DEL_WAITTYPE, io, handle->evhandle, handle->sock, M_EVENT_WAIT_READ, 0);
+				return M_FALSE;
+			}
+
+			if (!M_io_udp_error_is_fatal(err)) {
+				M_event_handle_modify(event, M_EVENT_MODTYPE_ADD_WAITTYPE, io, handle->evhandle, handle->sock, M_EVENT_WAIT_READ, 0);
+				return M_TRUE;
+			}
+
+			M_io_udp_close(io, handle);
+			handle->state = M_IO_UDP_STATE_ERROR;
+			M_io_set_error(io, err);
+			*type = M_EVENT_TYPE_ERROR;
+			return M_FALSE;
+
+		case M_EVENT_TYPE_WRITE:
+			handle->tx_signaled = M_FALSE;
+
+			if (M_io_udp_tx_flush(handle) == M_IO_ERROR_WOULDBLOCK) {
+				M_event_handle_modify(event, M_EVENT_MODTYPE_ADD_WAITTYPE, io, handle->evhandle, handle->sock, M_EVENT_WAIT_WRITE, 0);
+				return M_TRUE;
+			}
+			M_event_handle_modify(event, M_EVENT_MODTYPE_DEL_WAITTYPE, io, handle->evhandle, handle->sock, M_EVENT_WAIT_WRITE, 0);
+
+			/* Only the user's own writes being refused warrant telling them */
+			if (!handle->tx_blocked)
+				return M_TRUE;
+			handle->tx_blocked = M_FALSE;
+			return M_FALSE;
+
+		case M_EVENT_TYPE_ERROR:
+		case M_EVENT_TYPE_DISCONNECTED:
+			/* A queued ICMP error (e.g. port unreachable) only applies to a
+			 * single datagram.  Clear it, the socket is still usable. */
+			{
+				int       sockerr = 0;
+				socklen_t arglen  = sizeof(sockerr);
+				(void)getsockopt(handle->sock, SOL_SOCKET, SO_ERROR, (void *)&sockerr, &arglen);
+			}
+			return M_TRUE;
+
+		default:
+			break;
+	}
+
+	return M_FALSE;
+}
+
+
+static M_bool M_io_udp_disconnect_cb(M_io_layer_t *layer)
+{
+	M_io_handle_t *handle = M_io_layer_get_handle(layer);
+	M_io_t        *io     = M_io_layer_get_io(layer);
+
+	/* No shutdown sequence, just get out what we can and stop */
+	if (handle->state == M_IO_UDP_STATE_CONNECTED) {
+		M_io_udp_tx_flush(handle);
+		M_io_udp_close(io, handle);
+		handle->state = M_IO_UDP_STATE_DISCONNECTED;
+	}
+
+	return M_TRUE;
+}
+
+
+static void M_io_udp_unregister_cb(M_io_layer_t *layer)
+{
+	M_io_t        *io     = M_io_layer_get_io(layer);
+	M_io_handle_t *handle = M_io_layer_get_handle(layer);
+	M_event_t     *event  = M_io_get_event(io);
+
+	if (handle->evhandle != M_EVENT_INVALID_HANDLE)
+		M_event_handle_modify(event, M_EVENT_MODTYPE_DEL_HANDLE, io, handle->evhandle, handle->sock, 0, 0);
+
+	/* Soft events are discarded with the registration */
+	handle->rx_signaled = M_FALSE;
+	handle->tx_signaled = M_FALSE;
+}
+
+
+static M_bool M_io_udp_reset_cb(M_io_layer_t *layer)
+{
+	M_io_handle_t *handle = M_io_layer_get_handle(layer);
+	M_io_t        *io     = M_io_layer_get_io(layer);
+
+	if (handle == NULL)
+		return M_FALSE;
+
+	if (handle->state == M_IO_UDP_STATE_CONNECTED)
+		M_io_udp_tx_flush(handle);
+
+	M_io_udp_close(io, handle);
+
+	/* Cleanup for re-init */
+	handle->state          = M_IO_UDP_STATE_INIT;
+	handle->rx_cnt         = 0;
+	handle->rx_idx         = 0;
+	handle->tx_cnt         = 0;
+	handle->tx_idx         = 0;
+	handle->rx_signaled    = M_FALSE;
+	handle->tx_signaled    = M_FALSE;
+	handle->tx_blocked     = M_FALSE;
+	handle->last_error     = M_IO_ERROR_SUCCESS;
+	handle->last_error_sys = 0;
+	return M_TRUE;
+}
+
+
+static void M_io_udp_destroy_cb(M_io_layer_t *layer)
+{
+	M_io_handle_t *handle = M_io_layer_get_handle(layer);
+
+	if (handle == NULL)
+		return;
+
+	/* reset_cb() ensures handle is closed */
+
+	M_io_udp_buffers_free(handle);
+	M_free(handle->host);
+	M_free(handle);
+}
+
+
+static M_io_state_t M_io_udp_state_cb(M_io_layer_t *layer)
+{
+	M_io_handle_t *handle = M_io_layer_get_handle(layer);
+
+	switch (handle->state) {
+		case M_IO_UDP_STATE_INIT:
+			return M_IO_STATE_INIT;
+		case M_IO_UDP_STATE_CONNECTED:
+			return M_IO_STATE_CONNECTED;
+		case M_IO_UDP_STATE_DISCONNECTED:
+			return M_IO_STATE_DISCONNECTED;
+		case M_IO_UDP_STATE_ERROR:
+			return M_IO_STATE_ERROR;
+	}
+	return M_IO_STATE_INIT;
+}
+
+
+static M_bool M_io_udp_errormsg_cb(M_io_layer_t *layer, char *error, size_t err_len)
+{
+	M_io_handle_t *handle = M_io_layer_get_handle(layer);
+
+	if (handle->state == M_IO_UDP_STATE_DISCONNECTED) {
+		M_snprintf(error, err_len, "Closed");
+		return M_TRUE;
+	}
+
+#ifdef _WIN32
+	return M_io_win32_errormsg(handle->last_error_sys, error, err_len);
+#else
+	return M_io_posix_errormsg(handle->last_error_sys, error, err_len);
+#endif
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static M_io_error_t M_io_udp_create_int(M_io_t **io_out, const char *host, unsigned short port, M_io_net_type_t type, M_bool is_client)
+{
+	M_io_handle_t    *handle;
+	M_io_callbacks_t *callbacks;
+	M_io_error_t      err;
+
+	if (io_out == NULL)
+		return M_IO_ERROR_INVALID;
+
+	*io_out = NULL;
+
+	if (is_client && (M_str_isempty(host) || port == 0))
+		return M_IO_ERROR_INVALID;
+
+	M_io_net_init_system();
+
+	handle               = M_malloc_zero(sizeof(*handle));
+	handle->evhandle     = M_EVENT_INVALID_HANDLE;
+	handle->sock         = M_EVENT_INVALID_SOCKET;
+	handle->host         = M_strdup(host);
+	handle->port         = port;
+	handle->type         = type;
+	handle->is_client    = is_client;
+	handle->batch        = M_IO_UDP_BATCH_DEFAULT;
+	handle->max_datagram = M_IO_UDP_DATAGRAM_DEFAULT;
+
+	/* Open now so errors can be returned rather than delayed until init_cb */
+	err = M_io_udp_open(handle);
+
+	/* Some OS's may allow disabling of IPv6 completely, re-try IPv4 since they
+	 * really requested ANY */
+	if (err != M_IO_ERROR_SUCCESS && !is_client && type == M_IO_NET_ANY && M_str_isempty(host)) {
+		handle->type = M_IO_NET_IPV4;
+		err          = M_io_udp_open(handle);
+	}
+
+	if (err != M_IO_ERROR_SUCCESS) {
+		M_free(handle->host);
+		M_free(handle);
+		return err;
+	}
+
+	*io_out   = M_io_init(M_IO_TYPE_STREAM);
+	callbacks = M_io_callbacks_create();
+	M_io_callbacks_reg_init(callbacks, M_io_udp_init_cb);
+	M_io_callbacks_reg_read(callbacks, M_io_udp_read_cb);
+	M_io_callbacks_reg_write(callbacks, M_io_udp_write_cb);
+	M_io_callbacks_reg_processevent(callbacks, M_io_udp_process_cb);
+	M_io_callbacks_reg_unregister(callbacks, M_io_udp_unregister_cb);
+	M_io_callbacks_reg_disconnect(callbacks, M_io_udp_disconnect_cb);
+	M_io_callbacks_reg_reset(callbacks, M_io_udp_reset_cb);
+	M_io_callbacks_reg_destroy(callbacks, M_io_udp_destroy_cb);
+	M_io_callbacks_reg_state(callbacks, M_io_udp_state_cb);
+	M_io_callbacks_reg_errormsg(callbacks, M_io_udp_errormsg_cb);
+	M_io_layer_add(*io_out, M_IO_UDP_NAME, handle, callbacks);
+	M_io_callbacks_destroy(callbacks);
+
+	return M_IO_ERROR_SUCCESS;
+}
+
+
+M_io_error_t M_io_udp_create(M_io_t **io_out, unsigned short port, const char *bind_ip, M_io_net_type_t type)
+{
+	return M_io_udp_create_int(io_out, bind_ip, port, type, M_FALSE);
+}
+
+
+M_io_error_t M_io_udp_client_create(M_io_t **io_out, const char *ipaddr, unsigned short port, M_io_net_type_t type)
+{
+	return M_io_udp_create_int(io_out, ipaddr, port, type, M_TRUE);
+}
+
+
+unsigned short M_io_udp_get_port(M_io_t *io)
+{
+	M_io_layer_t   *layer  = M_io_layer_acquire(io, 0, M_IO_UDP_NAME);
+	M_io_handle_t  *handle = M_io_layer_get_handle(layer);
+	unsigned short  port;
+
+	if (layer == NULL || handle == NULL)
+		return 0;
+
+	port = handle->local_port;
+
+	M_io_layer_release(layer);
+	return port;
+}
+
+
+M_bool M_io_udp_set_batch(M_io_t *io, size_t num_msgs, size_t max_datagram_size)
+{
+	M_io_layer_t  *layer;
+	M_io_handle_t *handle;
+
+	if (num_msgs == 0 || num_msgs > M_IO_UDP_BATCH_MAX || max_datagram_size == 0 || max_datagram_size > M_IO_UDP_DATAGRAM_MAX)
+		return M_FALSE;
+
+	layer  = M_io_layer_acquire(io, 0, M_IO_UDP_NAME);
+	handle = M_io_layer_get_handle(layer);
+	if (layer == NULL || handle == NULL)
+		return M_FALSE;
+
+	/* Can't resize with datagrams in flight */
+	if (handle->rx_idx < handle->rx_cnt || handle->tx_cnt != 0) {
+		M_io_layer_release(layer);
+		return M_FALSE;
+	}
+
+	M_io_udp_buffers_free(handle);
+	handle->batch        = num_msgs;
+	handle->max_datagram = max_datagram_size;
+
+	M_io_layer_release(layer);
+	return M_TRUE;
+}
+
+
+M_bool M_io_udp_set_gso(M_io_t *io, size_t segment_size)
+{
+#ifdef UDP_SEGMENT
+	M_io_layer_t  *layer;
+	M_io_handle_t *handle;
+	M_bool         ret;
+
+	if (segment_size > M_IO_UDP_DATAGRAM_MAX)
+		return M_FALSE;
+
+	layer  = M_io_layer_acquire(io, 0, M_IO_UDP_NAME);
+	handle = M_io_layer_get_handle(layer);
+	if (layer == NULL || handle == NULL)
+		return M_FALSE;
+
+	ret = M_io_udp_set_sockopt_int(handle, UDP_SEGMENT, (int)segment_size);
+	if (ret)
+		handle->gso_size = segment_size;
+
+	M_io_layer_release(layer);
+	return ret;
+#else
+	(void)io;
+	(void)segment_size;
+	return M_FALSE;
+#endif
+}
+
+
+M_bool M_io_udp_set_gro(M_io_t *io, M_bool enable)
+{
+#if defined(UDP_GRO) && defined(M_IO_UDP_CONTROL_LEN)
+	M_io_layer_t  *layer  = M_io_layer_acquire(io, 0, M_IO_UDP_NAME);
+	M_io_handle_t *handle = M_io_layer_get_handle(layer);
+	M_bool         ret    = M_FALSE;
+
+	if (layer == NULL || handle == NULL)
+		return M_FALSE;
+
+	/* Receive slots change size, can't have anything buffered */
+	if (handle->rx_idx < handle->rx_cnt) {
+		M_io_layer_release(layer);
+		return M_FALSE;
+	}
+
+	if (M_io_udp_set_sockopt_int(handle, UDP_GRO, enable?1:0)) {
+		handle->gro = enable;
+		ret         = M_TRUE;
+
+		/* Re-allocated with the new slot size on next read */
+		M_free(handle->rx_data);
+		M_free(handle->rx);
+		M_free(handle->rx_hdr);
+		M_free(handle->rx_iov);
+		M_free(handle->rx_control);
+		handle->rx_data    = NULL;
+		handle->rx         = NULL;
+		handle->rx_hdr     = NULL;
+		handle->rx_iov     = NULL;
+		handle->rx_control = NULL;
+		handle->rx_cnt     = 0;
+		handle->rx_idx     = 0;
+	}
+
+	M_io_layer_release(layer);
+	return ret;
+#else
+	(void)io;
+	(void)enable;
+	return M_FALSE;
+#endif
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static M_io_udp_meta_t *M_io_udp_get_meta(M_io_t *io, M_io_meta_t *meta, M_bool create)
+{
+	M_io_layer_t    *layer;
+	M_io_udp_meta_t *mdata;
+
+	if (io == NULL || meta == NULL)
+		return NULL;
+
+	layer = M_io_layer_acquire(io, 0, M_IO_UDP_NAME);
+	if (layer == NULL)
+		return NULL;
+
+	mdata = M_io_udp_meta_data(meta, layer, create);
+
+	M_io_layer_release(layer);
+	return mdata;
+}
+
+
+const char *M_io_udp_meta_get_ipaddr(M_io_t *io, M_io_meta_t *meta)
+{
+	M_io_udp_meta_t       *mdata = M_io_udp_get_meta(io, meta, M_FALSE);
+	const struct sockaddr *sa;
+
+	if (mdata == NULL || mdata->addr_len == 0)
+		return NULL;
+
+	if (mdata->ipaddr[0] != '\0')
+		return mdata->ipaddr;
+
+	sa = (const struct sockaddr *)((const void *)&mdata->addr);
+	if (sa->sa_family == AF_INET) {
+		M_dns_ntop(AF_INET, &((const struct sockaddr_in *)((const void *)sa))->sin_addr, mdata->ipaddr, sizeof(mdata->ipaddr));
+#ifdef AF_INET6
+	} else if (sa->sa_family == AF_INET6) {
+		M_dns_ntop(AF_INET6, &((const struct sockaddr_in6 *)((const void *)sa))->sin6_addr, mdata->ipaddr, sizeof(mdata->ipaddr));
+		/* Rewrite an IPv4 datagram coming in on an IPv6 socket as if it was IPv4 */
+		if (M_str_caseeq_max(mdata->ipaddr, "::ffff:", 7) && M_str_chr(mdata->ipaddr, '.') != NULL) {
+			M_mem_move(mdata->ipaddr, mdata->ipaddr + 7, M_str_len(mdata->ipaddr + 7) + 1);
+		}
+#endif
+	}
+
+	if (mdata->ipaddr[0] == '\0')
+		return NULL;
+	return mdata->ipaddr;
+}
+
+
+unsigned short M_io_udp_meta_get_port(M_io_t *io, M_io_meta_t *meta)
+{
+	M_io_udp_meta_t       *mdata = M_io_udp_get_meta(io, meta, M_FALSE);
+	const struct sockaddr *sa;
+
+	if (mdata == NULL || mdata->addr_len == 0)
+		return 0;
+
+	sa = (const struct sockaddr *)((const void *)&mdata->addr);
+	if (sa->sa_family == AF_INET)
+		return M_ntoh16(((const struct sockaddr_in *)((const void *)sa))->sin_port);
+#ifdef AF_INET6
+	if (sa->sa_family == AF_INET6)
+		return M_ntoh16(((const struct sockaddr_in6 *)((const void *)sa))->sin6_port);
+#endif
+	return 0;
+}
+
+
+size_t M_io_udp_meta_get_segment_size(M_io_t *io, M_io_meta_t *meta)
+{
+	M_io_udp_meta_t *mdata = M_io_udp_get_meta(io, meta, M_FALSE);
+
+	if (mdata == NULL)
+		return 0;
+	return mdata->segment_size;
+}
+
+
+M_bool M_io_udp_meta_set_peer(M_io_t *io, M_io_meta_t *meta, const char *ipaddr, unsigned short port)
+{
+	M_io_udp_meta_t *mdata;
+	M_io_udp_addr_t  addr;
+	socklen_t        addr_len;
+
+	if (!M_io_udp_addr_set(&addr, &addr_len, ipaddr, port))
+		return M_FALSE;
+
+	mdata = M_io_udp_get_meta(io, meta, M_TRUE);
+	if (mdata == NULL)
+		return M_FALSE;
+
+	M_mem_copy(&mdata->addr, &addr, sizeof(addr));
+	mdata->addr_len     = addr_len;
+	mdata->segment_size = 0;
+	mdata->ipaddr[0]    = '\0';
+	return M_TRUE;
+}
@@ -0,0 +1,278 @@
+#include "m_config.h"
+#include <stdlib.h> /* EXIT_SUCCESS, EXIT_FAILURE, srand, rand */
+#include <check.h>
+
+#include <mstdlib/mstdlib.h>
+#include <mstdlib/mstdlib_thread.h>
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+extern Suite *M_cache_concurrent_suite(void);
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define NUM_THREADS     8
+#define OPS_PER_THREAD  20000
+
+static M_cache_concurrent_t *create_strstr(size_t num_shards, size_t max_size)
+{
+	struct M_cache_callbacks callbacks = {
+		M_hash_void_strdup,
+		M_free,
+		NULL,
+		M_free
+	};
+
+	return M_cache_concurrent_create(num_shards, max_size, M_hash_func_hash_str, M_sort_compar_str, M_CACHE_NONE, &callbacks);
+}
+
+START_TEST(check_stats)
+{
+	M_cache_concurrent_t *c;
+	M_cache_stats_t       stats;
+	char                 *val;
+
+	c = create_strstr(1, 2);
+
+	M_cache_concurrent_insert(c, "key1", M_strdup("val1"));
+	M_cache_concurrent_insert(c, "key2", M_strdup("val2"));
+	ck_assert_msg(M_cache_concurrent_get(c, "key1", NULL), "key1 not found");
+	/* key2 is now the coldest. */
+	M_cache_concurrent_insert(c, "key3", M_strdup("val3"));
+	ck_assert_msg(!M_cache_concurrent_get(c, "key2", NULL), "key2 should have been evicted");
+	ck_assert_msg(M_cache_concurrent_get_copy(c, "key3", M_hash_void_strdup, (void **)&val) && M_str_eq(val, "val3"), "key3 copy wrong");
+	M_free(val);
+
+	M_cache_concurrent_stats(c, &stats);
+	ck_assert_msg(stats.hits == 2, "hits %llu != 2", stats.hits);
+	ck_assert_msg(stats.misses == 1, "misses %llu != 1", stats.misses);
+	ck_assert_msg(stats.evictions == 1, "evictions %llu != 1", stats.evictions);
+	ck_assert_msg(stats.expirations == 0, "expirations %llu != 0", stats.expirations);
+
+	M_cache_concurrent_stats_reset(c);
+	M_cache_concurrent_stats(c, &stats);
+	ck_assert_msg(stats.hits == 0 && stats.misses == 0 && stats.evictions == 0, "stats not reset");
+
+	M_cache_concurrent_destroy(c);
+}
+END_TEST
+
+START_TEST(check_cost)
+{
+	M_cache_concurrent_t *c;
+	M_cache_stats_t       stats;
+	char                 *val;
+	size_t                cost;
+
+	c = create_strstr(1, 100);
+	M_cache_concurrent_set_max_cost(c, 100);
+
+	M_cache_concurrent_insert_ex(c, "key1", M_strdup("val1"), 40, 0);
+	M_cache_concurrent_insert_ex(c, "key2", M_strdup("val2"), 40, 0);
+	cost = M_cache_concurrent_cost(c);
+	ck_assert_msg(cost == 80, "cost %zu != 80", cost);
+
+	/* Make key1 hot so key2 is evicted to fit key3. */
+	ck_assert_msg(M_cache_concurrent_get(c, "key1", NULL), "key1 not found");
+	M_cache_concurrent_insert_ex(c, "key3", M_strdup("val3"), 50, 0);
+	ck_assert_msg(!M_cache_concurrent_get(c, "key2", NULL), "key2 should have been evicted");
+	ck_assert_msg(M_cache_concurrent_get(c, "key1", NULL), "key1 should not have been evicted");
+	cost = M_cache_concurrent_cost(c);
+	ck_assert_msg(cost == 90, "cost %zu != 90", cost);
+
+	/* Replacing a value replaces its cost. */
+	M_cache_concurrent_insert_ex(c, "key1", M_strdup("val1b"), 10, 0);
+	cost = M_cache_concurrent_cost(c);
+	ck_assert_msg(cost == 60, "cost %zu != 60", cost);
+
+	/* Larger than the whole cache. */
+	val = M_strdup("big");
+	ck_assert_msg(!M_cache_concurrent_insert_ex(c, "big", val, 101, 0), "oversize insert succeeded");
+	M_free(val);
+
+	/* Shrinking evicts. */
+	M_cache_concurrent_set_max_cost(c, 20);
+	cost = M_cache_concurrent_cost(c);
+	ck_assert_msg(cost == 10, "cost %zu != 10", cost);
+	ck_assert_msg(M_cache_concurrent_size(c) == 1, "size %zu != 1", M_cache_concurrent_size(c));
+
+	M_cache_concurrent_stats(c, &stats);
+	ck_assert_msg(stats.evictions == 2, "evictions %llu != 2", stats.evictions);
+
+	M_cache_concurrent_destroy(c);
+}
+END_TEST
+
+START_TEST(check_cost_shared)
+{
+	M_cache_concurrent_t *c;
+	char                 *val;
+	char                  key[32];
+	size_t                cost;
+	size_t                i;
+
+	c = create_strstr(4, 100);
+	M_cache_concurrent_set_max_cost(c, 100);
+
+	/* Larger than a quarter of the max cost but fits in the cache. */
+	ck_assert_msg(M_cache_concurrent_insert_ex(c, "big", M_strdup("big"), 90, 0), "insert within max cost failed");
+	cost = M_cache_concurrent_cost(c);
+	ck_assert_msg(cost == 90, "cost %zu != 90", cost);
+
+	/* Whichever shard this lands in, big is the only entry that can make room. */
+	ck_assert_msg(M_cache_concurrent_insert_ex(c, "key", M_strdup("key"), 20, 0), "insert key failed");
+	ck_assert_msg(!M_cache_concurrent_get(c, "big", NULL), "big should have been evicted");
+	cost = M_cache_concurrent_cost(c);
+	ck_assert_msg(cost == 20, "cost %zu != 20", cost);
+
+	for (i=0; i<16; i++) {
+		M_snprintf(key, sizeof(key), "key%zu", i);
+		ck_assert_msg(M_cache_concurrent_insert_ex(c, key, M_strdup(key), 10, 0), "insert %s failed", key);
+		cost = M_cache_concurrent_cost(c);
+		ck_assert_msg(cost <= 100, "cost %zu > 100 after inserting %s", cost, key);
+	}
+
+	val = M_strdup("huge");
+	ck_assert_msg(!M_cache_concurrent_insert_ex(c, "huge", val, 101, 0), "oversize insert succeeded");
+	M_free(val);
+
+	M_cache_concurrent_destroy(c);
+}
+END_TEST
+
+START_TEST(check_ttl)
+{
+	M_cache_concurrent_t *c;
+	M_cache_stats_t       stats;
+
+	c = create_strstr(1, 100);
+
+	M_cache_concurrent_insert_ex(c, "short", M_strdup("val"), 0, 50);
+	M_cache_concurrent_insert_ex(c, "long", M_strdup("val"), 0, 60*1000);
+	M_cache_concurrent_insert(c, "forever", M_strdup("val"));
+	M_cache_concurrent_set_default_ttl(c, 50);
+	M_cache_concurrent_insert(c, "default", M_strdup("val"));
+	M_cache_concurrent_insert(c, "default2", M_strdup("val"));
+
+	ck_assert_msg(M_cache_concurrent_get(c, "short", NULL), "short expired early");
+	M_thread_sleep(150*1000);
+
+	ck_assert_msg(!M_cache_concurrent_get(c, "short", NULL), "short didn't expire");
+	ck_assert_msg(!M_cache_concurrent_get(c, "default", NULL), "default didn't expire");
+	ck_assert_msg(M_cache_concurrent_get(c, "long", NULL), "long expired early");
+	ck_assert_msg(M_cache_concurrent_get(c, "forever", NULL), "forever expired");
+
+	/* default2 hasn't been accessed so it's still taking space until purged. */
+	ck_assert_msg(M_cache_concurrent_size(c) == 3, "size %zu != 3", M_cache_concurrent_size(c));
+	ck_assert_msg(M_cache_concurrent_expire(c) == 1, "expire didn't remove default2");
+	ck_assert_msg(M_cache_concurrent_size(c) == 2, "size %zu != 2", M_cache_concurrent_size(c));
+
+	M_cache_concurrent_stats(c, &stats);
+	ck_assert_msg(stats.expirations == 3, "expirations %llu != 3", stats.expirations);
+	ck_assert_msg(stats.evictions == 0, "evictions %llu != 0", stats.evictions);
+
+	M_cache_concurrent_destroy(c);
+}
+END_TEST
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static void *thread_worker(void *arg)
+{
+	M_cache_concurrent_t *c    = arg;
+	M_rand_t             *rand = M_rand_create(0);
+	char                  key[32];
+	char                 *val;
+	size_t                i;
+
+	for (i=0; i<OPS_PER_THREAD; i++) {
+		M_snprintf(key, sizeof(key), "%llu", M_rand_max(rand, 2000));
+		if (M_cache_concurrent_get_copy(c, key, M_hash_void_strdup, (void **)&val)) {
+			ck_assert_msg(M_str_eq(key, val), "key '%s' has value '%s'", key, val);
+			M_free(val);
+		} else {
+			M_cache_concurrent_insert_ex(c, key, M_strdup(key), M_str_len(key), 0);
+		}
+	}
+
+	M_rand_destroy(rand);
+	return NULL;
+}
+
+START_TEST(check_threads)
+{
+	M_cache_concurrent_t *c;
+	M_cache_stats_t       stats;
+	M_thread_attr_t      *tattr;
+	M_threadid_t          threads[NUM_THREADS];
+	size_t                i;
+
+	c = create_strstr(4, 1000);
+	M_cache_concurrent_set_max_cost(c, 2000);
+	ck_assert_msg(M_cache_concurrent_num_shards(c) == 4, "shards %zu != 4", M_cache_concurrent_num_shards(c));
+
+	tattr = M_thread_attr_create();
+	M_thread_attr_set_create_joinable(tattr, M_TRUE);
+	for (i=0; i<NUM_THREADS; i++)
+		threads[i] = M_thread_create(tattr, thread_worker, c);
+	M_thread_attr_destroy(tattr);
+	for (i=0; i<NUM_THREADS; i++)
+		M_thread_join(threads[i], NULL);
+
+	ck_assert_msg(M_cache_concurrent_size(c) <= 1000, "size %zu > 1000", M_cache_concurrent_size(c));
+	ck_assert_msg(M_cache_concurrent_cost(c) <= 2000, "cost %zu > 2000", M_cache_concurrent_cost(c));
+
+	M_cache_concurrent_stats(c, &stats);
+	ck_assert_msg(stats.hits + stats.misses == NUM_THREADS*OPS_PER_THREAD, "hits + misses %llu != %d", stats.hits + stats.misses, NUM_THREADS*OPS_PER_THREAD);
+	ck_assert_msg(stats.evictions > 0, "nothing evicted");
+
+	M_cache_concurrent_destroy(c);
+}
+END_TEST
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+Suite *M_cache_concurrent_suite(void)
+{
+	Suite *suite;
+	TCase *tc_stats;
+	TCase *tc_cost;
+	TCase *tc_ttl;
+	TCase *tc_threads;
+
+	suite = suite_create("cache_concurrent");
+
+	tc_stats = tcase_create("cache_concurrent_stats");
+	tcase_add_test(tc_stats, check_stats);
+	suite_add_tcase(suite, tc_stats);
+
+	tc_cost = tcase_create("cache_concurrent_cost");
+	tcase_add_test(tc_cost, check_cost);
+	tcase_add_test(tc_cost, check_cost_shared);
+	suite_add_tcase(suite, tc_cost);
+
+	tc_ttl = tcase_create("cache_concurrent_ttl");
+	tcase_add_test(tc_ttl, check_ttl);
+	suite_add_tcase(suite, tc_ttl);
+
+	tc_threads = tcase_create("cache_concurrent_threads");
+	tcase_add_test(tc_threads, check_threads);
+	suite_add_tcase(suite, tc_threads);
+
+	return suite;
+}
+
+int main(void)
+{
+	SRunner *sr;
+	int      nf;
+
+	sr = srunner_create(M_cache_concurrent_suite());
+	if (getenv("CK_LOG_FILE_NAME")==NULL) srunner_set_log(sr, "check_cache_concurrent.log");
+
+	srunner_run_all(sr, CK_NORMAL);
+	nf = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	return nf == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,312 @@
+#include "m_config.h"
+#include <stdlib.h> /* EXIT_SUCCESS, EXIT_FAILURE, srand, rand */
+#include <check.h>
+
+#include <mstdlib/mstdlib.h>
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+extern Suite *M_cache_policy_suite(void);
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define CACHE_SIZE      500
+#define TRACE_KEYS      10000
+#define TRACE_LEN       200000
+#define SCAN_EVERY      20000
+#define SCAN_LEN        2000
+#define LOOP_KEYS       600
+
+typedef struct {
+	M_uint64 *keys;
+	size_t    len;
+	size_t    alloc;
+} trace_t;
+
+static M_cache_t *create_u64(size_t max_size, M_uint32 flags)
+{
+	struct M_cache_callbacks callbacks = {
+		M_hash_func_u64dup,
+		M_free,
+		NULL,
+		NULL
+	};
+
+	return M_cache_create(max_size, M_hash_func_hash_u64, M_sort_compar_u64, flags, &callbacks);
+}
+
+static void trace_add(trace_t *trace, M_uint64 key)
+{
+	if (trace->len == trace->alloc) {
+		trace->alloc = trace->alloc == 0 ? 1024 : trace->alloc * 2;
+		trace->keys  = M_realloc(trace->keys, sizeof(*trace->keys) * trace->alloc);
+	}
+	trace->keys[trace->len++] = key;
+}
+
+static void trace_free(trace_t *trace)
+{
+	M_free(trace->keys);
+	M_mem_set(trace, 0, sizeof(*trace));
+}
+
+/* Zipf distributed keys. Optionally interleaved with scans of keys that are
+ * never requested again, like a batch report reading every record once. */
+static void trace_zipf(trace_t *trace, M_bool scans)
+{
+	M_rand_t *rand;
+	double   *cdf;
+	double    total = 0;
+	double    u;
+	M_uint64  scan_key = TRACE_KEYS;
+	size_t    lo;
+	size_t    hi;
+	size_t    mid;
+	size_t    i;
+	size_t    j;
+
+	cdf = M_malloc(sizeof(*cdf) * TRACE_KEYS);
+	for (i=0; i<TRACE_KEYS; i++) {
+		/* s = 1 */
+		total  += 1.0 / (double)(i+1);
+		cdf[i]  = total;
+	}
+
+	rand = M_rand_create(1);
+	for (i=0; i<TRACE_LEN; i++) {
+		if (scans && i % SCAN_EVERY == SCAN_EVERY/2) {
+			for (j=0; j<SCAN_LEN; j++) {
+				trace_add(trace, scan_key++);
+			}
+		}
+
+		u  = ((double)M_rand_max(rand, M_UINT32_MAX) / (double)M_UINT32_MAX) * total;
+		lo = 0;
+		hi = TRACE_KEYS-1;
+		while (lo < hi) {
+			mid = (lo + hi) / 2;
+			if (cdf[mid] < u) {
+				lo = mid+1;
+			} else {
+				hi = mid;
+			}
+		}
+		trace_add(trace, lo);
+	}
+
+	M_rand_destroy(rand);
+	M_free(cdf);
+}
+
+/* Repeatedly walk a working set slightly larger than the cache. */
+static void trace_loop(trace_t *trace)
+{
+	size_t i;
+
+	for (i=0; i<TRACE_LEN; i++) {
+		trace_add(trace, i % LOOP_KEYS);
+	}
+}
+
+/* One key per line, numeric keys are used as is. Other keys are hashed. */
+static M_bool trace_file(trace_t *trace, const char *path)
+{
+	unsigned char  *buf = NULL;
+	size_t          len;
+	char          **lines;
+	size_t          num_lines;
+	M_uint64        key;
+	size_t          i;
+
+	if (M_fs_file_read_bytes(path, 0, &buf, &len) != M_FS_ERROR_SUCCESS)
+		return M_FALSE;
+
+	lines = M_str_explode_str('\n', (const char *)buf, &num_lines);
+	for (i=0; i<num_lines; i++) {
+		M_str_trim(lines[i]);
+		if (M_str_isempty(lines[i]))
+			continue;
+		if (M_str_to_uint64_ex(lines[i], M_str_len(lines[i]), 10, &key, NULL) != M_STR_INT_SUCCESS)
+			key = M_hash_func_hash_str(lines[i], 0);
+		trace_add(trace, key);
+	}
+
+	M_str_explode_free(lines, num_lines);
+	M_free(buf);
+	return M_TRUE;
+}
+
+static double trace_hit_ratio(const trace_t *trace, M_uint32 flags)
+{
+	M_cache_t       *c;
+	M_cache_stats_t  stats;
+	size_t           i;
+
+	c = create_u64(CACHE_SIZE, flags);
+	for (i=0; i<trace->len; i++) {
+		if (!M_cache_get(c, &trace->keys[i], NULL)) {
+			M_cache_insert(c, &trace->keys[i], NULL);
+		}
+	}
+	ck_assert_msg(M_cache_size(c) <= CACHE_SIZE, "cache size %zu > %d", M_cache_size(c), CACHE_SIZE);
+
+	M_cache_stats(c, &stats);
+	M_cache_destroy(c);
+
+	return (double)stats.hits * 100 / (double)(stats.hits + stats.misses);
+}
+
+static void trace_compare(const char *name, const trace_t *trace, double *lru, double *tinylfu)
+{
+	*lru     = trace_hit_ratio(trace, M_CACHE_NONE);
+	*tinylfu = trace_hit_ratio(trace, M_CACHE_POLICY_TINYLFU);
+	M_printf("  %-12s %8zu requests: lru %6.2f%%, tinylfu %6.2f%%\n", name, trace->len, *lru, *tinylfu);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+START_TEST(check_tinylfu_basic)
+{
+	M_cache_t *c;
+	M_uint64   key;
+	size_t     i;
+
+	c = create_u64(100, M_CACHE_POLICY_TINYLFU);
+
+	for (key=0; key<1000; key++) {
+		ck_assert_msg(M_cache_insert(c, &key, (void *)((M_uintptr)key+1)), "%llu: insert failed", key);
+		ck_assert_msg(M_cache_size(c) <= 100, "%llu: size %zu > 100", key, M_cache_size(c));
+	}
+
+	/* Whatever is cached must have the right value. */
+	for (key=0, i=0; key<1000; key++) {
+		void *val = NULL;
+		if (M_cache_get(c, &key, &val)) {
+			ck_assert_msg(val == (void *)((M_uintptr)key+1), "%llu: wrong value", key);
+			i++;
+		}
+	}
+	ck_assert_msg(i == M_cache_size(c), "found %zu keys, size %zu", i, M_cache_size(c));
+
+	for (key=0; key<1000; key++)
+		M_cache_remove(c, &key);
+	ck_assert_msg(M_cache_size(c) == 0, "size %zu != 0 after removing", M_cache_size(c));
+
+	M_cache_destroy(c);
+}
+END_TEST
+
+START_TEST(check_tinylfu_scan)
+{
+	M_cache_t *c;
+	M_uint64   key;
+	M_uint64   hot;
+	size_t     i;
+
+	c = create_u64(100, M_CACHE_POLICY_TINYLFU);
+
+	/* Build up a hot set. */
+	for (i=0; i<10; i++) {
+		for (key=0; key<50; key++) {
+			if (!M_cache_get(c, &key, NULL)) {
+				M_cache_insert(c, &key, NULL);
+			}
+		}
+	}
+
+	/* Scan through keys that are only seen once while the hot set is still
+	 * in use. Each burst of scanned keys is larger than the cache so LRU
+	 * would lose the entire hot set every time. */
+	for (key=1000; key<5000; key++) {
+		M_cache_insert(c, &key, NULL);
+		if (key % 200 == 0) {
+			for (hot=0; hot<50; hot++) {
+				ck_assert_msg(M_cache_get(c, &hot, NULL), "%llu: hot key evicted by scan at %llu", hot, key);
+			}
+		}
+	}
+
+	/* Shrinking still keeps the size bound. */
+	M_cache_set_max_size(c, 10);
+	ck_assert_msg(M_cache_size(c) <= 10, "size %zu > 10", M_cache_size(c));
+
+	M_cache_destroy(c);
+}
+END_TEST
+
+START_TEST(check_hit_ratio)
+{
+	trace_t     trace;
+	const char *path;
+	double      lru;
+	double      tinylfu;
+
+	M_printf("cache hit ratio: %d entries\n", CACHE_SIZE);
+
+	M_mem_set(&trace, 0, sizeof(trace));
+	trace_zipf(&trace, M_FALSE);
+	trace_compare("zipf", &trace, &lru, &tinylfu);
+	ck_assert_msg(tinylfu >= lru, "tinylfu worse than lru on zipf");
+	trace_free(&trace);
+
+	trace_zipf(&trace, M_TRUE);
+	trace_compare("zipf+scan", &trace, &lru, &tinylfu);
+	ck_assert_msg(tinylfu > lru, "tinylfu not better than lru with scans");
+	trace_free(&trace);
+
+	trace_loop(&trace);
+	trace_compare("loop", &trace, &lru, &tinylfu);
+	ck_assert_msg(tinylfu > lru, "tinylfu not better than lru on loop");
+	trace_free(&trace);
+
+	/* Replay a real trace if one is provided. */
+	path = getenv("CHECK_CACHE_TRACE");
+	if (!M_str_isempty(path)) {
+		ck_assert_msg(trace_file(&trace, path), "could not read trace '%s'", path);
+		trace_compare("file", &trace, &lru, &tinylfu);
+		trace_free(&trace);
+	}
+}
+END_TEST
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+Suite *M_cache_policy_suite(void)
+{
+	Suite *suite;
+	TCase *tc_tinylfu_basic;
+	TCase *tc_tinylfu_scan;
+	TCase *tc_hit_ratio;
+
+	suite = suite_create("cache_policy");
+
+	tc_tinylfu_basic = tcase_create("cache_policy_tinylfu_basic");
+	tcase_add_test(tc_tinylfu_basic, check_tinylfu_basic);
+	suite_add_tcase(suite, tc_tinylfu_basic);
+
+	tc_tinylfu_scan = tcase_create("cache_policy_tinylfu_scan");
+	tcase_add_test(tc_tinylfu_scan, check_tinylfu_scan);
+	suite_add_tcase(suite, tc_tinylfu_scan);
+
+	tc_hit_ratio = tcase_create("cache_policy_hit_ratio");
+	tcase_add_test(tc_hit_ratio, check_hit_ratio);
+	tcase_set_timeout(tc_hit_ratio, 60);
+	suite_add_tcase(suite, tc_hit_ratio);
+
+	return suite;
+}
+
+int main(void)
+{
+	SRunner *sr;
+	int      nf;
+
+	sr = srunner_create(M_cache_policy_suite());
+	if (getenv("CK_LOG_FILE_NAME")==NULL) srunner_set_log(sr, "check_cache_policy.log");
+
+	srunner_run_all(sr, CK_NORMAL);
+	nf = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	return nf == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
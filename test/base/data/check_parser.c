@@ -343,6 +343,142 @@ START_TEST(check_parser_truncate_charset)
 }
 END_TEST
 
+static size_t check_parser_charset_span(const unsigned char *data, size_t len, const unsigned char *set, size_t set_len, M_bool inclusion)
+{
+	size_t i;
+
+	for (i=0; i<len; i++) {
+		if ((M_mem_chr(set, data[i], set_len) != NULL) != inclusion) {
+			break;
+		}
+	}
+	return i;
+}
+
+static size_t check_parser_charset_rspan(const unsigned char *data, size_t len, const unsigned char *set, size_t set_len)
+{
+	for ( ; len>0; len--) {
+		if (M_mem_chr(set, data[len-1], set_len) == NULL) {
+			break;
+		}
+	}
+	return len;
+}
+
+START_TEST(check_parser_charset_random)
+{
+	unsigned char       data[300];
+	unsigned char       set[64];
+	M_parser_charset_t  cs;
+	M_parser_t         *parser;
+	M_buf_t            *buf;
+	size_t              set_len;
+	size_t              len;
+	size_t              off;
+	size_t              expect;
+	size_t              r;
+	size_t              i;
+	size_t              j;
+
+	srand(0x5A17);
+	for (i=0; i<2000; i++) {
+		/* Draw from a small alphabet most of the time so runs are long
+		 * enough to cross vector boundaries. */
+		set_len = (size_t)(rand() % 40) + 1;
+		for (j=0; j<set_len; j++)
+			set[j] = (unsigned char)((i & 1) ? rand() : (rand() % 8) + 0x7C);
+		for (j=0; j<sizeof(data); j++)
+			data[j] = (unsigned char)((rand() % 16 == 0) ? rand() : (rand() % 8) + 0x7C);
+		off = (size_t)rand() % 32;
+		len = (size_t)rand() % (sizeof(data) - off);
+
+		M_parser_charset_compile(&cs, set, set_len);
+		for (j=0; j<256; j++)
+			ck_assert(M_parser_charset_contains(&cs, (unsigned char)j) == (M_mem_chr(set, (unsigned char)j, set_len) != NULL));
+
+		expect = check_parser_charset_span(data + off, len, set, set_len, M_TRUE);
+		parser = M_parser_create_const(data + off, len, M_PARSER_FLAG_NONE);
+		r      = M_parser_consume_charset(parser, set, set_len);
+		ck_assert_msg(r == expect, "%zu: consume_charset got %zu, expected %zu", i, r, expect);
+		M_parser_destroy(parser);
+
+		parser = M_parser_create_const(data + off, len, M_PARSER_FLAG_NONE);
+		r      = M_parser_consume_charset_compiled(parser, &cs);
+		ck_assert_msg(r == expect, "%zu: consume_charset_compiled got %zu, expected %zu", i, r, expect);
+		ck_assert(M_parser_is_charset_compiled(parser, 0, &cs) == M_FALSE);
+		M_parser_destroy(parser);
+
+		parser = M_parser_create_const(data + off, len, M_PARSER_FLAG_NONE);
+		ck_assert(M_parser_is_charset(parser, len, set, set_len) == (len != 0 && expect == len));
+		ck_assert(M_parser_is_charset_compiled(parser, len, &cs) == (len != 0 && expect == len));
+		M_parser_destroy(parser);
+
+		expect = check_parser_charset_span(data + off, len, set, set_len, M_FALSE);
+		parser = M_parser_create_const(data + off, len, M_PARSER_FLAG_NONE);
+		r      = M_parser_consume_not_charset(parser, set, set_len);
+		ck_assert_msg(r == expect, "%zu: consume_not_charset got %zu, expected %zu", i, r, expect);
+		M_parser_destroy(parser);
+
+		parser = M_parser_create_const(data + off, len, M_PARSER_FLAG_NONE);
+		buf    = M_buf_create();
+		r      = M_parser_read_buf_not_charset_compiled(parser, buf, &cs);
+		ck_assert_msg(r == expect, "%zu: read_buf_not_charset_compiled got %zu, expected %zu", i, r, expect);
+		ck_assert(M_buf_len(buf) == expect && (expect == 0 || M_mem_eq(M_buf_peek(buf), data + off, expect)));
+		ck_assert(M_parser_len(parser) == len - expect);
+		M_buf_cancel(buf);
+		M_parser_destroy(parser);
+
+		expect = len - check_parser_charset_rspan(data + off, len, set, set_len);
+		parser = M_parser_create_const(data + off, len, M_PARSER_FLAG_NONE);
+		r      = M_parser_truncate_charset(parser, set, set_len);
+		ck_assert_msg(r == expect, "%zu: truncate_charset got %zu, expected %zu", i, r, expect);
+		M_parser_destroy(parser);
+
+		parser = M_parser_create_const(data + off, len, M_PARSER_FLAG_NONE);
+		r      = M_parser_truncate_charset_compiled(parser, &cs);
+		ck_assert_msg(r == expect, "%zu: truncate_charset_compiled got %zu, expected %zu", i, r, expect);
+		ck_assert(M_parser_len(parser) == len - expect);
+		M_parser_destroy(parser);
+	}
+}
+END_TEST
+
+START_TEST(check_parser_charset_compiled)
+{
+	M_parser_charset_t  cs;
+	M_parser_t         *parser;
+	unsigned char       buf[8];
+	char               *out;
+
+	M_parser_charset_compile_chr_predicate(&cs, M_chr_isdigit);
+	ck_assert(M_parser_charset_contains(&cs, '0'));
+	ck_assert(M_parser_charset_contains(&cs, '9'));
+	ck_assert(!M_parser_charset_contains(&cs, 'a'));
+	ck_assert(!M_parser_charset_contains(&cs, 0xB0));
+
+	M_parser_charset_add(&cs, (const unsigned char *)"-", 1);
+	parser = M_parser_create_const((const unsigned char *)"2026-10-17T12:00:00Z", 20, M_PARSER_FLAG_NONE);
+
+	out = M_parser_read_strdup_charset_compiled(parser, &cs);
+	ck_assert_str_eq(out, "2026-10-17");
+	M_free(out);
+
+	ck_assert(M_parser_read_bytes_charset_compiled(parser, &cs, buf, sizeof(buf)) == 0);
+	ck_assert(M_parser_read_bytes_not_charset_compiled(parser, &cs, buf, sizeof(buf)) == 1 && buf[0] == 'T');
+
+	M_parser_charset_compile_str(&cs, "Z:");
+	ck_assert(M_parser_truncate_charset_compiled(parser, &cs) == 1);
+	out = M_parser_read_strdup_not_charset_compiled(parser, &cs);
+	ck_assert_str_eq(out, "12");
+	M_free(out);
+	ck_assert(M_parser_consume_charset_compiled(parser, &cs) == 1);
+	ck_assert(M_parser_consume_not_charset_compiled(parser, &cs) == 2);
+	ck_assert(M_parser_len(parser) == 3);
+
+	M_parser_destroy(parser);
+}
+END_TEST
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 static Suite *M_parser_suite(void)
@@ -384,6 +520,14 @@ static Suite *M_parser_suite(void)
 	tcase_add_test(tc, check_parser_truncate_charset);
 	suite_add_tcase(suite, tc);
 
+	tc = tcase_create("check_parser_charset_random");
+	tcase_add_test(tc, check_parser_charset_random);
+	suite_add_tcase(suite, tc);
+
+	tc = tcase_create("check_parser_charset_compiled");
+	tcase_add_test(tc, check_parser_charset_compiled);
+	suite_add_tcase(suite, tc);
+
 	return suite;
 }
 
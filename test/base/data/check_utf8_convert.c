@@ -0,0 +1,371 @@
+#include "m_config.h"
+#include <stdlib.h> /* EXIT_SUCCESS, EXIT_FAILURE, srand, rand */
+#include <check.h>
+
+#include <mstdlib/mstdlib.h>
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+extern Suite *M_utf8_convert_suite(void);
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define BENCH_SIZE   (8 * 1024 * 1024)
+#define BENCH_ROUNDS 20
+
+/* Character at a time validation, how M_utf8_is_valid used to work. */
+static M_bool ref_is_valid(const char *str, const char **endptr)
+{
+	const char *next;
+
+	while (*str != '\0') {
+		if (M_utf8_get_cp(str, NULL, &next) != M_UTF8_ERROR_SUCCESS) {
+			*endptr = str;
+			return M_FALSE;
+		}
+		str = next;
+	}
+	*endptr = str;
+	return M_TRUE;
+}
+
+/* Random valid utf-8 weighted towards ascii so runs of both occur. */
+static void gen_utf8(M_rand_t *rand, M_buf_t *buf, size_t num_chrs)
+{
+	M_uint32 cp;
+	size_t   i;
+
+	for (i=0; i<num_chrs; i++) {
+		switch (M_rand_max(rand, 8)) {
+			case 0:
+				cp = (M_uint32)M_rand_range(rand, 0x80, 0x800);
+				break;
+			case 1:
+				cp = (M_uint32)M_rand_range(rand, 0x800, 0x10000);
+				break;
+			case 2:
+				cp = (M_uint32)M_rand_range(rand, 0x10000, 0x110000);
+				break;
+			default:
+				cp = (M_uint32)M_rand_range(rand, 1, 0x80);
+				break;
+		}
+		/* Skips surrogates and noncharacters. */
+		M_utf8_from_cp_buf(buf, cp);
+	}
+}
+
+static double mb_per_sec(size_t len, M_uint64 ms)
+{
+	if (ms == 0)
+		ms = 1;
+	return ((double)len * BENCH_ROUNDS / (1024 * 1024)) / ((double)ms / 1000);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static const struct {
+	const char *str;
+	M_bool      valid;
+} utf8_cases[] = {
+	{ "\xC2\xA9",                 M_TRUE  },
+	{ "\xE0\xBF\xBF",             M_TRUE  }, /* U+0FFF, looks like a noncharacter to the fast path. */
+	{ "\xEF\xB7\x8F",             M_TRUE  }, /* U+FDCF */
+	{ "\xEF\xB7\xB0",             M_TRUE  }, /* U+FDF0 */
+	{ "\xF4\x8F\xBF\xBD",         M_TRUE  }, /* U+10FFFD */
+	{ "\xF0\x9F\x98\x80",         M_TRUE  },
+	{ "\xEF\xB7\x90",             M_FALSE }, /* U+FDD0 */
+	{ "\xEF\xBF\xBE",             M_FALSE }, /* U+FFFE */
+	{ "\xF0\x9F\xBF\xBF",         M_FALSE }, /* U+1FFFF */
+	{ "\xF4\x8F\xBF\xBF",         M_FALSE }, /* U+10FFFF */
+	{ "\xED\xA0\x80",             M_FALSE }, /* Surrogate */
+	{ "\xC0\x80",                 M_FALSE }, /* Overlong */
+	{ "\xC1\xBF",                 M_FALSE },
+	{ "\xE0\x80\x80",             M_FALSE },
+	{ "\xE0\x9F\xBF",             M_FALSE },
+	{ "\xF0\x80\x80\x80",         M_FALSE },
+	{ "\xF0\x8F\xBF\xBD",         M_FALSE },
+	{ "\xF4\x90\x80\x80",         M_FALSE }, /* Too large */
+	{ "\xF5\x80\x80\x80",         M_FALSE },
+	{ "\xFF",                     M_FALSE },
+	{ "\x80",                     M_FALSE }, /* Continue without a start */
+	{ "\xC2\xA9\xA9",             M_FALSE },
+	{ "\xE2\x82",                 M_FALSE }, /* Truncated */
+	{ "\xF0\x9F\x98",             M_FALSE },
+	{ "\xE2\x82" "a",             M_FALSE },
+	{ "\xF0\x9F\x98\x80\x80",     M_FALSE }
+};
+
+START_TEST(check_utf8_convert_cases)
+{
+	M_buf_t    *buf = M_buf_create();
+	const char *str;
+	const char *endptr;
+	const char *ref_endptr;
+	M_bool      valid;
+	size_t      pad;
+	size_t      i;
+
+	/* Every case at every position across a few vector boundaries. */
+	for (i=0; i<sizeof(utf8_cases)/sizeof(*utf8_cases); i++) {
+		for (pad=0; pad<70; pad++) {
+			M_buf_truncate(buf, 0);
+			M_buf_add_fill(buf, 'a', pad);
+			M_buf_add_str(buf, utf8_cases[i].str);
+			M_buf_add_fill(buf, 'b', (pad * 7) % 40);
+			str = M_buf_peek(buf);
+
+			valid = M_utf8_is_valid(str, &endptr);
+			ck_assert_msg(valid == utf8_cases[i].valid, "case %zu pad %zu: valid %d", i, pad, valid);
+			ref_is_valid(str, &ref_endptr);
+			ck_assert_msg(endptr == ref_endptr, "case %zu pad %zu: endptr %zu, expected %zu", i, pad, (size_t)(endptr - str), (size_t)(ref_endptr - str));
+		}
+	}
+
+	/* Length based validation treats NULL bytes as data. */
+	ck_assert(M_utf8_is_valid_len("a\0b", 3, &endptr));
+	ck_assert(M_utf8_is_valid_len(NULL, 0, NULL));
+	ck_assert(!M_utf8_is_valid_len(NULL, 1, NULL));
+
+	ck_assert(M_utf8_cnt("a\xC2\xA9\xE2\x82\xAC\xF0\x9F\x98\x80") == 4);
+	ck_assert(M_utf8_cnt("a\xC2") == 0);
+
+	M_buf_cancel(buf);
+}
+END_TEST
+
+START_TEST(check_utf8_convert_random)
+{
+	M_rand_t   *rand = M_rand_create(1);
+	M_buf_t    *buf  = M_buf_create();
+	char       *str;
+	size_t      len;
+	const char *endptr;
+	const char *ref_endptr;
+	M_bool      valid;
+	M_bool      ref_valid;
+	size_t      i;
+	size_t      j;
+
+	for (i=0; i<3000; i++) {
+		gen_utf8(rand, buf, (size_t)M_rand_max(rand, 200));
+		str = M_buf_finish_str(buf, &len);
+		buf = M_buf_create();
+		if (str == NULL)
+			continue;
+
+		/* Corrupt some of them. Never add a NULL, the reference stops at it. */
+		if (len > 0 && i % 2 == 0) {
+			for (j=0; j<(size_t)M_rand_range(rand, 1, 3); j++) {
+				str[M_rand_max(rand, len)] = (char)M_rand_range(rand, 1, 256);
+			}
+		}
+
+		valid     = M_utf8_is_valid(str, &endptr);
+		ref_valid = ref_is_valid(str, &ref_endptr);
+		ck_assert_msg(valid == ref_valid, "%zu: valid %d, expected %d", i, valid, ref_valid);
+		ck_assert_msg(endptr == ref_endptr, "%zu: endptr %zu, expected %zu", i, (size_t)(endptr - str), (size_t)(ref_endptr - str));
+
+		M_free(str);
+	}
+
+	M_buf_cancel(buf);
+	M_rand_destroy(rand);
+}
+END_TEST
+
+START_TEST(check_utf8_convert_roundtrip)
+{
+	M_rand_t       *rand = M_rand_create(2);
+	M_buf_t        *buf  = M_buf_create();
+	M_buf_t        *wide = M_buf_create();
+	M_buf_t        *back = M_buf_create();
+	const char     *next;
+	const M_uint8  *w;
+	M_uint32        cp;
+	M_uint32        u;
+	M_endian_t      e;
+	size_t          i;
+	size_t          j;
+
+	for (i=0; i<1000; i++) {
+		M_buf_truncate(buf, 0);
+		gen_utf8(rand, buf, (size_t)M_rand_max(rand, 300));
+		e = (i % 2) ? M_ENDIAN_BIG : M_ENDIAN_LITTLE;
+
+		/* utf-32 is the code points in order. */
+		M_buf_truncate(wide, 0);
+		ck_assert(M_utf8_to_utf32_buf(M_buf_peek(buf), M_buf_len(buf), e, wide) == M_UTF8_ERROR_SUCCESS);
+		w    = (const M_uint8 *)M_buf_peek(wide);
+		next = M_buf_peek(buf);
+		for (j=0; *next != '\0'; j+=4) {
+			M_utf8_get_cp(next, &cp, &next);
+			u = (e == M_ENDIAN_BIG) ? ((M_uint32)w[j] << 24 | (M_uint32)w[j+1] << 16 | (M_uint32)w[j+2] << 8 | w[j+3])
+			                        : ((M_uint32)w[j+3] << 24 | (M_uint32)w[j+2] << 16 | (M_uint32)w[j+1] << 8 | w[j]);
+			ck_assert_msg(u == cp, "%zu: utf-32 %X != %X", i, u, cp);
+		}
+		ck_assert(j == M_buf_len(wide));
+
+		M_buf_truncate(back, 0);
+		ck_assert(M_utf8_from_utf32_buf(back, w, M_buf_len(wide), e) == M_UTF8_ERROR_SUCCESS);
+		ck_assert_msg(M_buf_len(back) == M_buf_len(buf) && M_mem_eq(M_buf_peek(back), M_buf_peek(buf), M_buf_len(buf)), "%zu: utf-32 roundtrip", i);
+
+		M_buf_truncate(wide, 0);
+		ck_assert(M_utf8_to_utf16_buf(M_buf_peek(buf), M_buf_len(buf), e, wide) == M_UTF8_ERROR_SUCCESS);
+		M_buf_truncate(back, 0);
+		ck_assert(M_utf8_from_utf16_buf(back, (const M_uint8 *)M_buf_peek(wide), M_buf_len(wide), e) == M_UTF8_ERROR_SUCCESS);
+		ck_assert_msg(M_buf_len(back) == M_buf_len(buf) && M_mem_eq(M_buf_peek(back), M_buf_peek(buf), M_buf_len(buf)), "%zu: utf-16 roundtrip", i);
+	}
+
+	/* Surrogate pairs. */
+	M_buf_truncate(wide, 0);
+	ck_assert(M_utf8_to_utf16_buf("\xF0\x9F\x98\x80", 4, M_ENDIAN_BIG, wide) == M_UTF8_ERROR_SUCCESS);
+	ck_assert(M_buf_len(wide) == 4 && M_mem_eq(M_buf_peek(wide), "\xD8\x3D\xDE\x00", 4));
+
+	/* Errors leave the buffer alone. */
+	M_buf_truncate(back, 0);
+	M_buf_add_str(back, "x");
+	ck_assert(M_utf8_from_utf16_buf(back, (const M_uint8 *)"\x3D\xD8" "a\0", 4, M_ENDIAN_LITTLE) == M_UTF8_ERROR_BAD_CODE_POINT);
+	ck_assert(M_utf8_from_utf16_buf(back, (const M_uint8 *)"\x00\xDC", 2, M_ENDIAN_LITTLE) == M_UTF8_ERROR_BAD_CODE_POINT);
+	ck_assert(M_utf8_from_utf16_buf(back, (const M_uint8 *)"\x3D\xD8", 2, M_ENDIAN_LITTLE) == M_UTF8_ERROR_TRUNCATED);
+	ck_assert(M_utf8_from_utf16_buf(back, (const M_uint8 *)"a\0b", 3, M_ENDIAN_LITTLE) == M_UTF8_ERROR_TRUNCATED);
+	ck_assert(M_utf8_from_utf32_buf(back, (const M_uint8 *)"\x00\x00\x11\x00", 4, M_ENDIAN_LITTLE) == M_UTF8_ERROR_BAD_CODE_POINT);
+	ck_assert(M_utf8_from_utf32_buf(back, (const M_uint8 *)"\xFE\xFF\x00\x00", 4, M_ENDIAN_LITTLE) == M_UTF8_ERROR_BAD_CODE_POINT);
+	ck_assert(M_utf8_to_utf16_buf("abc\xE0\x80\x80", 6, M_ENDIAN_LITTLE, back) == M_UTF8_ERROR_OVERLONG);
+	ck_assert(M_utf8_to_utf32_buf("abc\xE2\x82", 5, M_ENDIAN_LITTLE, back) == M_UTF8_ERROR_TRUNCATED);
+	ck_assert(M_buf_len(back) == 1);
+
+	M_buf_cancel(back);
+	M_buf_cancel(wide);
+	M_buf_cancel(buf);
+	M_rand_destroy(rand);
+}
+END_TEST
+
+START_TEST(check_utf8_convert_bench)
+{
+	M_rand_t     *rand = M_rand_create(3);
+	M_buf_t      *buf  = M_buf_create();
+	M_buf_t      *out  = M_buf_create();
+	char         *ascii;
+	char         *mixed;
+	const char   *volatile vstr;
+	const char   *endptr;
+	size_t        mixed_len;
+	M_timeval_t   start;
+	M_uint64      t_lib;
+	M_uint64      t_ref;
+	size_t        i;
+
+	ascii = M_malloc(BENCH_SIZE + 1);
+	for (i=0; i<BENCH_SIZE; i++)
+		ascii[i] = (char)M_rand_range(rand, 0x20, 0x7F);
+	ascii[BENCH_SIZE] = '\0';
+
+	while (M_buf_len(buf) < BENCH_SIZE)
+		gen_utf8(rand, buf, 1024);
+	mixed = M_buf_finish_str(buf, &mixed_len);
+	buf   = M_buf_create();
+
+	M_printf("utf8: %d MB\n", BENCH_SIZE / (1024 * 1024));
+
+	vstr = ascii;
+	M_time_elapsed_start(&start);
+	for (i=0; i<BENCH_ROUNDS; i++)
+		ck_assert(M_utf8_is_valid_len(vstr, BENCH_SIZE, NULL));
+	t_lib = M_time_elapsed(&start);
+	M_time_elapsed_start(&start);
+	for (i=0; i<BENCH_ROUNDS; i++)
+		ck_assert(ref_is_valid(vstr, &endptr));
+	t_ref = M_time_elapsed(&start);
+	M_printf("  valid ascii %8.0f MB/s, per character %8.0f MB/s\n", mb_per_sec(BENCH_SIZE, t_lib), mb_per_sec(BENCH_SIZE, t_ref));
+
+	vstr = mixed;
+	M_time_elapsed_start(&start);
+	for (i=0; i<BENCH_ROUNDS; i++)
+		ck_assert(M_utf8_is_valid_len(vstr, mixed_len, NULL));
+	t_lib = M_time_elapsed(&start);
+	M_time_elapsed_start(&start);
+	for (i=0; i<BENCH_ROUNDS; i++)
+		ck_assert(ref_is_valid(vstr, &endptr));
+	t_ref = M_time_elapsed(&start);
+	M_printf("  valid mixed %8.0f MB/s, per character %8.0f MB/s\n", mb_per_sec(mixed_len, t_lib), mb_per_sec(mixed_len, t_ref));
+
+	M_time_elapsed_start(&start);
+	for (i=0; i<BENCH_ROUNDS; i++) {
+		M_buf_truncate(out, 0);
+		ck_assert(M_utf8_to_utf16_buf(ascii, BENCH_SIZE, M_ENDIAN_LITTLE, out) == M_UTF8_ERROR_SUCCESS);
+	}
+	t_lib = M_time_elapsed(&start);
+	M_time_elapsed_start(&start);
+	for (i=0; i<BENCH_ROUNDS; i++) {
+		M_buf_truncate(out, 0);
+		ck_assert(M_utf8_to_utf16_buf(mixed, mixed_len, M_ENDIAN_LITTLE, out) == M_UTF8_ERROR_SUCCESS);
+	}
+	t_ref = M_time_elapsed(&start);
+	M_printf("  to utf-16   %8.0f MB/s ascii, %8.0f MB/s mixed\n", mb_per_sec(BENCH_SIZE, t_lib), mb_per_sec(mixed_len, t_ref));
+
+	M_time_elapsed_start(&start);
+	for (i=0; i<BENCH_ROUNDS; i++) {
+		M_buf_truncate(out, 0);
+		ck_assert(M_utf8_to_utf16_buf(ascii, BENCH_SIZE, M_ENDIAN_LITTLE, out) == M_UTF8_ERROR_SUCCESS);
+		M_buf_truncate(buf, 0);
+		ck_assert(M_utf8_from_utf16_buf(buf, (const M_uint8 *)M_buf_peek(out), M_buf_len(out), M_ENDIAN_LITTLE) == M_UTF8_ERROR_SUCCESS);
+	}
+	t_lib = M_time_elapsed(&start);
+	M_printf("  utf-16 roundtrip ascii %8.0f MB/s\n", mb_per_sec(BENCH_SIZE, t_lib));
+
+	M_free(mixed);
+	M_free(ascii);
+	M_buf_cancel(out);
+	M_buf_cancel(buf);
+	M_rand_destroy(rand);
+}
+END_TEST
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+Suite *M_utf8_convert_suite(void)
+{
+	Suite *suite;
+	TCase *tc_cases;
+	TCase *tc_random;
+	TCase *tc_roundtrip;
+	TCase *tc_bench;
+
+	suite = suite_create("utf8_convert");
+
+	tc_cases = tcase_create("utf8_convert_cases");
+	tcase_add_test(tc_cases, check_utf8_convert_cases);
+	suite_add_tcase(suite, tc_cases);
+
+	tc_random = tcase_create("utf8_convert_random");
+	tcase_add_test(tc_random, check_utf8_convert_random);
+	suite_add_tcase(suite, tc_random);
+
+	tc_roundtrip = tcase_create("utf8_convert_roundtrip");
+	tcase_add_test(tc_roundtrip, check_utf8_convert_roundtrip);
+	suite_add_tcase(suite, tc_roundtrip);
+
+	tc_bench = tcase_create("utf8_convert_bench");
+	tcase_add_test(tc_bench, check_utf8_convert_bench);
+	tcase_set_timeout(tc_bench, 60);
+	suite_add_tcase(suite, tc_bench);
+
+	return suite;
+}
+
+int main(void)
+{
+	SRunner *sr;
+	int      nf;
+
+	sr = srunner_create(M_utf8_convert_suite());
+	if (getenv("CK_LOG_FILE_NAME")==NULL) srunner_set_log(sr, "check_utf8_convert.log");
+
+	srunner_run_all(sr, CK_NORMAL);
+	nf = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	return nf == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
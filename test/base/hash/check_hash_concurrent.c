@@ -0,0 +1,378 @@
+#include "m_config.h"
+#include <stdlib.h> /* EXIT_SUCCESS, EXIT_FAILURE, srand, rand */
+#include <check.h>
+
+#include <mstdlib/mstdlib.h>
+#include <mstdlib/mstdlib_thread.h>
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+extern Suite *M_hash_concurrent_suite(void);
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define NUM_THREADS      8
+#define KEYS_PER_THREAD  5000
+#define BENCH_KEYS       65536
+#define BENCH_OPS        200000
+#define BENCH_WRITE_PCT  10
+
+static M_hash_concurrent_t *create_strstr(size_t num_shards)
+{
+	struct M_hashtable_callbacks callbacks = {
+		M_hash_void_strdup,
+		M_hash_void_strdup,
+		M_free,
+		M_hash_void_strdup,
+		M_hash_void_strdup,
+		NULL,
+		M_free
+	};
+
+	return M_hash_concurrent_create(num_shards, 16, 75, M_hash_func_hash_str, M_sort_compar_str, M_HASHTABLE_NONE, &callbacks);
+}
+
+static M_bool foreach_count(const void *key, const void *value, void *thunk)
+{
+	size_t *cnt = thunk;
+
+	ck_assert_msg(M_str_eq(key, value), "key '%s' != value '%s'", (const char *)key, (const char *)value);
+	(*cnt)++;
+	return M_TRUE;
+}
+
+static M_bool foreach_stop(const void *key, const void *value, void *thunk)
+{
+	(void)key;
+	(void)value;
+	(void)thunk;
+	return M_FALSE;
+}
+
+START_TEST(check_basic)
+{
+	M_hash_concurrent_t *h;
+	char                 key[32];
+	char                *val;
+	size_t               cnt;
+	size_t               i;
+
+	ck_assert_msg(M_hash_concurrent_create(4, 16, 75, NULL, NULL, M_HASHTABLE_KEYS_ORDERED, NULL) == NULL, "ordered keys should not be allowed");
+
+	h = create_strstr(3);
+	ck_assert_msg(M_hash_concurrent_num_shards(h) == 4, "shards %zu != 4", M_hash_concurrent_num_shards(h));
+
+	for (i=0; i<1000; i++) {
+		M_snprintf(key, sizeof(key), "%zu", i);
+		ck_assert_msg(M_hash_concurrent_insert(h, key, key), "%zu: insert failed", i);
+	}
+	ck_assert_msg(M_hash_concurrent_num_keys(h) == 1000, "num keys %zu != 1000", M_hash_concurrent_num_keys(h));
+
+	for (i=0; i<1000; i++) {
+		M_snprintf(key, sizeof(key), "%zu", i);
+		ck_assert_msg(M_hash_concurrent_get(h, key, (void **)&val) && M_str_eq(val, key), "%zu: get failed", i);
+		ck_assert_msg(M_hash_concurrent_get_copy(h, key, (void **)&val) && M_str_eq(val, key), "%zu: get copy failed", i);
+		M_free(val);
+	}
+	ck_assert_msg(!M_hash_concurrent_get(h, "missing", NULL), "missing key found");
+	ck_assert_msg(!M_hash_concurrent_get_copy(h, "missing", (void **)&val) && val == NULL, "missing key copied");
+
+	ck_assert_msg(!M_hash_concurrent_insert_unique(h, "5", "x"), "insert unique replaced existing key");
+	ck_assert_msg(M_hash_concurrent_get(h, "5", (void **)&val) && M_str_eq(val, "5"), "insert unique changed value");
+	ck_assert_msg(M_hash_concurrent_insert_unique(h, "1000", "1000"), "insert unique of new key failed");
+
+	cnt = 0;
+	ck_assert_msg(M_hash_concurrent_foreach(h, foreach_count, &cnt) == 1001, "foreach count wrong");
+	ck_assert_msg(cnt == 1001, "foreach called %zu times", cnt);
+	ck_assert_msg(M_hash_concurrent_foreach(h, foreach_stop, NULL) == 1, "foreach didn't stop");
+
+	for (i=0; i<1001; i+=2) {
+		M_snprintf(key, sizeof(key), "%zu", i);
+		ck_assert_msg(M_hash_concurrent_remove(h, key, M_TRUE), "%zu: remove failed", i);
+		ck_assert_msg(!M_hash_concurrent_remove(h, key, M_TRUE), "%zu: second remove succeeded", i);
+	}
+	ck_assert_msg(M_hash_concurrent_num_keys(h) == 500, "num keys %zu != 500", M_hash_concurrent_num_keys(h));
+
+	M_hash_concurrent_destroy(h, M_TRUE);
+}
+END_TEST
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+typedef struct {
+	M_hash_concurrent_t *h;
+	size_t               id;
+	size_t               cnt;
+} thread_arg_t;
+
+static void *thread_insert(void *arg)
+{
+	thread_arg_t *targ = arg;
+	char          key[32];
+	char         *val;
+	size_t        i;
+
+	for (i=0; i<KEYS_PER_THREAD; i++) {
+		M_snprintf(key, sizeof(key), "%zu-%zu", targ->id, i);
+		M_hash_concurrent_insert(targ->h, key, key);
+
+		/* Read back something recently written by any thread. */
+		M_snprintf(key, sizeof(key), "%zu-%zu", (targ->id + i) % NUM_THREADS, i / 2);
+		if (M_hash_concurrent_get_copy(targ->h, key, (void **)&val)) {
+			if (M_str_eq(key, val))
+				targ->cnt++;
+			M_free(val);
+		}
+	}
+
+	return NULL;
+}
+
+static void *thread_insert_unique(void *arg)
+{
+	thread_arg_t *targ = arg;
+	char          key[32];
+	size_t        i;
+
+	for (i=0; i<KEYS_PER_THREAD; i++) {
+		M_snprintf(key, sizeof(key), "%zu", i);
+		if (M_hash_concurrent_insert_unique(targ->h, key, key)) {
+			targ->cnt++;
+		}
+	}
+
+	return NULL;
+}
+
+static void run_threads(M_hash_concurrent_t *h, void *(*func)(void *), thread_arg_t *args)
+{
+	M_thread_attr_t *tattr;
+	M_threadid_t     threads[NUM_THREADS];
+	size_t           i;
+
+	tattr = M_thread_attr_create();
+	M_thread_attr_set_create_joinable(tattr, M_TRUE);
+	for (i=0; i<NUM_THREADS; i++) {
+		args[i].h   = h;
+		args[i].id  = i;
+		args[i].cnt = 0;
+		threads[i]  = M_thread_create(tattr, func, &args[i]);
+	}
+	M_thread_attr_destroy(tattr);
+
+	for (i=0; i<NUM_THREADS; i++) {
+		M_thread_join(threads[i], NULL);
+	}
+}
+
+START_TEST(check_threads)
+{
+	M_hash_concurrent_t *h;
+	thread_arg_t         args[NUM_THREADS];
+	char                 key[32];
+	char                *val;
+	size_t               i;
+	size_t               j;
+
+	h = create_strstr(0);
+	run_threads(h, thread_insert, args);
+
+	ck_assert_msg(M_hash_concurrent_num_keys(h) == NUM_THREADS*KEYS_PER_THREAD, "num keys %zu != %d", M_hash_concurrent_num_keys(h), NUM_THREADS*KEYS_PER_THREAD);
+	for (i=0; i<NUM_THREADS; i++) {
+		for (j=0; j<KEYS_PER_THREAD; j++) {
+			M_snprintf(key, sizeof(key), "%zu-%zu", i, j);
+			ck_assert_msg(M_hash_concurrent_get(h, key, (void **)&val) && M_str_eq(key, val), "%s: get failed", key);
+		}
+	}
+
+	M_hash_concurrent_destroy(h, M_TRUE);
+}
+END_TEST
+
+START_TEST(check_threads_unique)
+{
+	M_hash_concurrent_t *h;
+	thread_arg_t         args[NUM_THREADS];
+	size_t               cnt = 0;
+	size_t               i;
+
+	h = create_strstr(0);
+	run_threads(h, thread_insert_unique, args);
+
+	for (i=0; i<NUM_THREADS; i++)
+		cnt += args[i].cnt;
+	ck_assert_msg(cnt == KEYS_PER_THREAD, "%zu unique inserts succeeded, expected %d", cnt, KEYS_PER_THREAD);
+	ck_assert_msg(M_hash_concurrent_num_keys(h) == KEYS_PER_THREAD, "num keys %zu != %d", M_hash_concurrent_num_keys(h), KEYS_PER_THREAD);
+
+	M_hash_concurrent_destroy(h, M_TRUE);
+}
+END_TEST
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* Compare against the pattern this type replaces: one hashtable behind one rwlock. */
+typedef struct {
+	M_hash_strvp_t      *strvp;
+	M_thread_rwlock_t   *lock;
+	M_hash_concurrent_t *h;
+	char               **keys;
+	M_uint64             seed;
+} bench_arg_t;
+
+static void *bench_rwlock(void *arg)
+{
+	bench_arg_t *barg = arg;
+	M_rand_t    *rand = M_rand_create(barg->seed);
+	const char  *key;
+	size_t       i;
+
+	for (i=0; i<BENCH_OPS; i++) {
+		key = barg->keys[M_rand_max(rand, BENCH_KEYS)];
+		if (M_rand_max(rand, 100) < BENCH_WRITE_PCT) {
+			M_thread_rwlock_lock(barg->lock, M_THREAD_RWLOCK_TYPE_WRITE);
+			M_hash_strvp_insert(barg->strvp, key, barg);
+		} else {
+			M_thread_rwlock_lock(barg->lock, M_THREAD_RWLOCK_TYPE_READ);
+			M_hash_strvp_get(barg->strvp, key, NULL);
+		}
+		M_thread_rwlock_unlock(barg->lock);
+	}
+
+	M_rand_destroy(rand);
+	return NULL;
+}
+
+static void *bench_concurrent(void *arg)
+{
+	bench_arg_t *barg = arg;
+	M_rand_t    *rand = M_rand_create(barg->seed);
+	const char  *key;
+	size_t       i;
+
+	for (i=0; i<BENCH_OPS; i++) {
+		key = barg->keys[M_rand_max(rand, BENCH_KEYS)];
+		if (M_rand_max(rand, 100) < BENCH_WRITE_PCT) {
+			M_hash_concurrent_insert(barg->h, key, barg);
+		} else {
+			M_hash_concurrent_get(barg->h, key, NULL);
+		}
+	}
+
+	M_rand_destroy(rand);
+	return NULL;
+}
+
+static M_uint64 bench_run(bench_arg_t *base, size_t num_threads, void *(*func)(void *))
+{
+	M_thread_attr_t *tattr;
+	M_threadid_t    *threads;
+	bench_arg_t     *args;
+	M_timeval_t      start;
+	size_t           i;
+
+	threads = M_malloc_zero(sizeof(*threads) * num_threads);
+	args    = M_malloc_zero(sizeof(*args) * num_threads);
+	tattr   = M_thread_attr_create();
+	M_thread_attr_set_create_joinable(tattr, M_TRUE);
+
+	M_time_elapsed_start(&start);
+	for (i=0; i<num_threads; i++) {
+		args[i]      = *base;
+		args[i].seed = i+1;
+		threads[i]   = M_thread_create(tattr, func, &args[i]);
+	}
+	for (i=0; i<num_threads; i++) {
+		M_thread_join(threads[i], NULL);
+	}
+
+	M_thread_attr_destroy(tattr);
+	M_free(args);
+	M_free(threads);
+	return M_time_elapsed(&start);
+}
+
+START_TEST(check_speed)
+{
+	bench_arg_t barg;
+	char        key[32];
+	M_uint64    rwlock_ms;
+	M_uint64    concurrent_ms;
+	size_t      num_threads;
+	size_t      i;
+
+	M_mem_set(&barg, 0, sizeof(barg));
+	barg.strvp = M_hash_strvp_create(16, 75, M_HASH_STRVP_NONE, NULL);
+	barg.lock  = M_thread_rwlock_create();
+	barg.h     = M_hash_concurrent_create(0, 16, 75, M_hash_func_hash_str, M_sort_compar_str, M_HASHTABLE_NONE, NULL);
+	barg.keys  = M_malloc(sizeof(*barg.keys) * BENCH_KEYS);
+	for (i=0; i<BENCH_KEYS; i++) {
+		M_snprintf(key, sizeof(key), "key%zu", i);
+		barg.keys[i] = M_strdup(key);
+		M_hash_strvp_insert(barg.strvp, key, &barg);
+		M_hash_concurrent_insert(barg.h, barg.keys[i], &barg);
+	}
+
+	M_printf("hash concurrent: %d ops/thread, %d%% writes, %zu shards\n", BENCH_OPS, BENCH_WRITE_PCT, M_hash_concurrent_num_shards(barg.h));
+	for (num_threads=1; num_threads<=16; num_threads*=2) {
+		rwlock_ms     = bench_run(&barg, num_threads, bench_rwlock);
+		concurrent_ms = bench_run(&barg, num_threads, bench_concurrent);
+		M_printf("  %2zu threads: rwlock %6llums, concurrent %6llums\n", num_threads, rwlock_ms, concurrent_ms);
+	}
+
+	ck_assert_msg(M_hash_concurrent_num_keys(barg.h) == BENCH_KEYS, "num keys %zu != %d", M_hash_concurrent_num_keys(barg.h), BENCH_KEYS);
+
+	M_hash_concurrent_destroy(barg.h, M_FALSE);
+	M_thread_rwlock_destroy(barg.lock);
+	M_hash_strvp_destroy(barg.strvp, M_FALSE);
+	for (i=0; i<BENCH_KEYS; i++)
+		M_free(barg.keys[i]);
+	M_free(barg.keys);
+}
+END_TEST
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+Suite *M_hash_concurrent_suite(void)
+{
+	Suite *suite;
+	TCase *tc_basic;
+	TCase *tc_threads;
+	TCase *tc_threads_unique;
+	TCase *tc_speed;
+
+	suite = suite_create("hash_concurrent");
+
+	tc_basic = tcase_create("hash_concurrent_basic");
+	tcase_add_test(tc_basic, check_basic);
+	suite_add_tcase(suite, tc_basic);
+
+	tc_threads = tcase_create("hash_concurrent_threads");
+	tcase_add_test(tc_threads, check_threads);
+	suite_add_tcase(suite, tc_threads);
+
+	tc_threads_unique = tcase_create("hash_concurrent_threads_unique");
+	tcase_add_test(tc_threads_unique, check_threads_unique);
+	suite_add_tcase(suite, tc_threads_unique);
+
+	tc_speed = tcase_create("hash_concurrent_speed");
+	tcase_add_test(tc_speed, check_speed);
+	tcase_set_timeout(tc_speed, 120);
+	suite_add_tcase(suite, tc_speed);
+
+	return suite;
+}
+
+int main(void)
+{
+	SRunner *sr;
+	int      nf;
+
+	sr = srunner_create(M_hash_concurrent_suite());
+	if (getenv("CK_LOG_FILE_NAME")==NULL) srunner_set_log(sr, "check_hash_concurrent.log");
+
+	srunner_run_all(sr, CK_NORMAL);
+	nf = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	return nf == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,263 @@
+#include "m_config.h"
+#include <stdlib.h> /* EXIT_SUCCESS, EXIT_FAILURE, srand, rand */
+#include <check.h>
+
+#include <mstdlib/mstdlib.h>
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+extern Suite *M_hash_u64vp_suite(void);
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define NUM_KEYS 100000
+
+static void check_many(M_uint32 flags)
+{
+	M_hash_u64vp_t      *d;
+	M_hash_u64vp_enum_t *d_enum;
+	M_uint64             key;
+	void                *val;
+	M_uint64             i;
+	size_t               cnt;
+
+	d = M_hash_u64vp_create(8, 75, flags, NULL);
+
+	for (i=1; i<=NUM_KEYS; i++)
+		ck_assert_msg(M_hash_u64vp_insert(d, i, (void *)((M_uintptr)i)), "%llu: insert failed", i);
+	ck_assert_msg(M_hash_u64vp_num_keys(d) == NUM_KEYS, "num keys %zu != %d", M_hash_u64vp_num_keys(d), NUM_KEYS);
+
+	for (i=1; i<=NUM_KEYS; i++)
+		ck_assert_msg(M_hash_u64vp_get_direct(d, i) == (void *)((M_uintptr)i), "%llu: get failed", i);
+	ck_assert_msg(!M_hash_u64vp_get(d, NUM_KEYS+1, NULL), "get of missing key succeeded");
+
+	/* Remove every other key. */
+	for (i=1; i<=NUM_KEYS; i+=2)
+		ck_assert_msg(M_hash_u64vp_remove(d, i, M_TRUE), "%llu: remove failed", i);
+	ck_assert_msg(M_hash_u64vp_num_keys(d) == NUM_KEYS/2, "num keys %zu != %d", M_hash_u64vp_num_keys(d), NUM_KEYS/2);
+
+	for (i=1; i<=NUM_KEYS; i++) {
+		if (i % 2) {
+			ck_assert_msg(!M_hash_u64vp_get(d, i, NULL), "%llu: removed key found", i);
+		} else {
+			ck_assert_msg(M_hash_u64vp_get_direct(d, i) == (void *)((M_uintptr)i), "%llu: get after remove failed", i);
+		}
+	}
+
+	/* Enumeration should see each remaining key exactly once. */
+	cnt = 0;
+	ck_assert_msg(M_hash_u64vp_enumerate(d, &d_enum) == NUM_KEYS/2, "enumerate count wrong");
+	while (M_hash_u64vp_enumerate_next(d, d_enum, &key, &val)) {
+		ck_assert_msg(key % 2 == 0 && val == (void *)((M_uintptr)key), "%llu: bad enumerated entry", key);
+		cnt++;
+	}
+	M_hash_u64vp_enumerate_free(d_enum);
+	ck_assert_msg(cnt == NUM_KEYS/2, "enumerated %zu != %d", cnt, NUM_KEYS/2);
+
+	/* Replace existing values. */
+	for (i=2; i<=NUM_KEYS; i+=2)
+		ck_assert_msg(M_hash_u64vp_insert(d, i, (void *)((M_uintptr)(i+1))), "%llu: replace failed", i);
+	for (i=2; i<=NUM_KEYS; i+=2)
+		ck_assert_msg(M_hash_u64vp_get_direct(d, i) == (void *)((M_uintptr)(i+1)), "%llu: get after replace failed", i);
+	ck_assert_msg(M_hash_u64vp_num_keys(d) == NUM_KEYS/2, "num keys after replace %zu != %d", M_hash_u64vp_num_keys(d), NUM_KEYS/2);
+
+	M_hash_u64vp_destroy(d, M_TRUE);
+}
+
+START_TEST(check_chained)
+{
+	check_many(M_HASH_U64VP_NONE);
+}
+END_TEST
+
+START_TEST(check_open_addressing)
+{
+	check_many(M_HASH_U64VP_OPEN_ADDRESSING);
+}
+END_TEST
+
+START_TEST(check_open_addressing_ordered)
+{
+	M_hash_u64vp_t      *d;
+	M_hash_u64vp_enum_t *d_enum;
+	M_uint64             key;
+	M_uint64             expect = 1;
+
+	d = M_hash_u64vp_create(16, 75, M_HASH_U64VP_OPEN_ADDRESSING|M_HASH_U64VP_KEYS_ORDERED|M_HASH_U64VP_KEYS_SORTASC, NULL);
+	for (key=1000; key>0; key--)
+		M_hash_u64vp_insert(d, key, NULL);
+	M_hash_u64vp_remove(d, 500, M_TRUE);
+
+	M_hash_u64vp_enumerate(d, &d_enum);
+	while (M_hash_u64vp_enumerate_next(d, d_enum, &key, NULL)) {
+		if (expect == 500)
+			expect++;
+		ck_assert_msg(key == expect, "%llu != %llu", key, expect);
+		expect++;
+	}
+	M_hash_u64vp_enumerate_free(d_enum);
+	ck_assert_msg(expect == 1001, "enumeration stopped early at %llu", expect);
+
+	M_hash_u64vp_destroy(d, M_TRUE);
+}
+END_TEST
+
+START_TEST(check_open_addressing_churn)
+{
+	M_hash_u64vp_t *d;
+	M_uint64        i;
+
+	/* A sliding window of keys leaves lots of tombstones behind. The table
+	 * must clean them up rather than grow forever or fill up. */
+	d = M_hash_u64vp_create(16, 75, M_HASH_U64VP_OPEN_ADDRESSING, NULL);
+	for (i=1; i<=NUM_KEYS; i++) {
+		ck_assert_msg(M_hash_u64vp_insert(d, i, NULL), "%llu: insert failed", i);
+		if (i > 8) {
+			ck_assert_msg(M_hash_u64vp_remove(d, i-8, M_TRUE), "%llu: remove failed", i-8);
+		}
+		ck_assert_msg(M_hash_u64vp_get(d, i, NULL), "%llu: get failed", i);
+	}
+	ck_assert_msg(M_hash_u64vp_num_keys(d) == 8, "num keys %zu != 8", M_hash_u64vp_num_keys(d));
+	ck_assert_msg(M_hash_u64vp_size(d) <= 64, "table grew to %u", M_hash_u64vp_size(d));
+
+	M_hash_u64vp_destroy(d, M_TRUE);
+}
+END_TEST
+
+static void check_incremental(M_uint32 flags)
+{
+	M_hash_u64vp_t      *d;
+	M_hash_u64vp_enum_t *d_enum;
+	M_uint64             key;
+	M_uint64             sum;
+	M_uint64             i;
+	M_uint64             j;
+
+	d = M_hash_u64vp_create(16, 75, flags|M_HASH_U64VP_INCREMENTAL_REHASH, NULL);
+
+	/* Every key must be reachable and enumerated exactly once no matter how far
+	 * along moving entries into the expanded table is. */
+	for (i=1; i<=2000; i++) {
+		ck_assert_msg(M_hash_u64vp_insert(d, i, (void *)((M_uintptr)i)), "%llu: insert failed", i);
+		ck_assert_msg(M_hash_u64vp_num_keys(d) == i, "%llu: num keys %zu", i, M_hash_u64vp_num_keys(d));
+
+		sum = 0;
+		ck_assert_msg(M_hash_u64vp_enumerate(d, &d_enum) == i, "%llu: enumerate count wrong", i);
+		while (M_hash_u64vp_enumerate_next(d, d_enum, &key, NULL))
+			sum += key;
+		M_hash_u64vp_enumerate_free(d_enum);
+		ck_assert_msg(sum == i*(i+1)/2, "%llu: enumerated key sum %llu != %llu", i, sum, i*(i+1)/2);
+
+		if (i % 97 == 0) {
+			for (j=1; j<=i; j++) {
+				ck_assert_msg(M_hash_u64vp_get_direct(d, j) == (void *)((M_uintptr)j), "%llu: get %llu failed", i, j);
+			}
+		}
+	}
+
+	/* Replacing and removing keys that may still be in the old bucket list. */
+	for (i=1; i<=2000; i+=2)
+		ck_assert_msg(M_hash_u64vp_insert(d, i, NULL), "%llu: replace failed", i);
+	for (i=2; i<=2000; i+=2)
+		ck_assert_msg(M_hash_u64vp_remove(d, i, M_TRUE), "%llu: remove failed", i);
+	for (i=1; i<=2000; i++) {
+		if (i % 2) {
+			ck_assert_msg(M_hash_u64vp_get(d, i, NULL) && M_hash_u64vp_get_direct(d, i) == NULL, "%llu: replaced value wrong", i);
+		} else {
+			ck_assert_msg(!M_hash_u64vp_get(d, i, NULL), "%llu: removed key found", i);
+		}
+	}
+	ck_assert_msg(M_hash_u64vp_num_keys(d) == 1000, "num keys %zu != 1000", M_hash_u64vp_num_keys(d));
+
+	M_hash_u64vp_destroy(d, M_TRUE);
+}
+
+START_TEST(check_incremental_chained)
+{
+	check_incremental(M_HASH_U64VP_NONE);
+}
+END_TEST
+
+START_TEST(check_incremental_open_addressing)
+{
+	check_incremental(M_HASH_U64VP_OPEN_ADDRESSING);
+}
+END_TEST
+
+START_TEST(check_incremental_multi)
+{
+	M_hash_u64vp_t *d;
+	M_uint64        i;
+	size_t          len;
+
+	d = M_hash_u64vp_create(16, 75, M_HASH_U64VP_INCREMENTAL_REHASH|M_HASH_U64VP_MULTI_VALUE|M_HASH_U64VP_KEYS_ORDERED, NULL);
+	for (i=0; i<3000; i++)
+		M_hash_u64vp_insert(d, i % 1000, (void *)((M_uintptr)i));
+
+	for (i=0; i<1000; i++) {
+		ck_assert_msg(M_hash_u64vp_multi_len(d, i, &len) && len == 3, "%llu: multi len %zu != 3", i, len);
+		ck_assert_msg(M_hash_u64vp_multi_get_direct(d, i, 2) == (void *)((M_uintptr)(i+2000)), "%llu: multi get failed", i);
+	}
+
+	M_hash_u64vp_destroy(d, M_TRUE);
+}
+END_TEST
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+Suite *M_hash_u64vp_suite(void)
+{
+	Suite *suite = suite_create("hash_u64vp");
+	TCase *tc_chained;
+	TCase *tc_open_addressing;
+	TCase *tc_open_addressing_ordered;
+	TCase *tc_open_addressing_churn;
+	TCase *tc_incremental_chained;
+	TCase *tc_incremental_open_addressing;
+	TCase *tc_incremental_multi;
+
+	tc_chained = tcase_create("hash_u64vp_chained");
+	tcase_add_test(tc_chained, check_chained);
+	suite_add_tcase(suite, tc_chained);
+
+	tc_open_addressing = tcase_create("hash_u64vp_open_addressing");
+	tcase_add_test(tc_open_addressing, check_open_addressing);
+	suite_add_tcase(suite, tc_open_addressing);
+
+	tc_open_addressing_ordered = tcase_create("hash_u64vp_open_addressing_ordered");
+	tcase_add_test(tc_open_addressing_ordered, check_open_addressing_ordered);
+	suite_add_tcase(suite, tc_open_addressing_ordered);
+
+	tc_open_addressing_churn = tcase_create("hash_u64vp_open_addressing_churn");
+	tcase_add_test(tc_open_addressing_churn, check_open_addressing_churn);
+	suite_add_tcase(suite, tc_open_addressing_churn);
+
+	tc_incremental_chained = tcase_create("hash_u64vp_incremental_chained");
+	tcase_add_test(tc_incremental_chained, check_incremental_chained);
+	suite_add_tcase(suite, tc_incremental_chained);
+
+	tc_incremental_open_addressing = tcase_create("hash_u64vp_incremental_open_addressing");
+	tcase_add_test(tc_incremental_open_addressing, check_incremental_open_addressing);
+	suite_add_tcase(suite, tc_incremental_open_addressing);
+
+	tc_incremental_multi = tcase_create("hash_u64vp_incremental_multi");
+	tcase_add_test(tc_incremental_multi, check_incremental_multi);
+	suite_add_tcase(suite, tc_incremental_multi);
+
+	return suite;
+}
+
+int main(void)
+{
+	SRunner *sr;
+	int      nf;
+
+	sr = srunner_create(M_hash_u64vp_suite());
+	if (getenv("CK_LOG_FILE_NAME")==NULL) srunner_set_log(sr, "check_hash_u64vp.log");
+
+	srunner_run_all(sr, CK_NORMAL);
+	nf = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	return nf == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,238 @@
+#include "m_config.h"
+#include <stdlib.h> /* EXIT_SUCCESS, EXIT_FAILURE, srand, rand */
+#include <check.h>
+
+#include <mstdlib/mstdlib.h>
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+extern Suite *M_arena_suite(void);
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+START_TEST(check_arena_alloc)
+{
+	M_arena_t     *arena;
+	unsigned char *p[100];
+	char          *s;
+	size_t         i;
+	size_t         j;
+
+	arena = M_arena_create(256);
+
+	ck_assert_msg(M_arena_alloc(arena, 0) == NULL, "0 byte alloc succeeded");
+	ck_assert_msg(M_arena_alloc(NULL, 1) == NULL, "alloc without arena succeeded");
+
+	/* Enough allocations to span multiple chunks. Each must be aligned and
+	 * not overlap any other. */
+	for (i=0; i<sizeof(p)/sizeof(*p); i++) {
+		p[i] = M_arena_alloc(arena, i+1);
+		ck_assert_msg(p[i] != NULL, "%zu: alloc failed", i);
+		ck_assert_msg(((M_uintptr)p[i] % sizeof(M_uint64)) == 0, "%zu: not aligned", i);
+		M_mem_set(p[i], (int)i, i+1);
+	}
+	for (i=0; i<sizeof(p)/sizeof(*p); i++) {
+		for (j=0; j<i+1; j++) {
+			ck_assert_msg(p[i][j] == (unsigned char)i, "%zu: overwritten at %zu", i, j);
+		}
+	}
+
+	p[0] = M_arena_alloc_zero(arena, 32);
+	for (j=0; j<32; j++)
+		ck_assert_msg(p[0][j] == 0, "alloc_zero not zero at %zu", j);
+
+	s = M_arena_strdup(arena, "abc");
+	ck_assert_msg(M_str_eq(s, "abc"), "strdup got '%s'", s);
+	s = M_arena_strdup_max(arena, "abcdef", 3);
+	ck_assert_msg(M_str_eq(s, "abc"), "strdup_max got '%s'", s);
+	s = M_arena_strdup_max(arena, "ab", 3);
+	ck_assert_msg(M_str_eq(s, "ab"), "strdup_max short got '%s'", s);
+	s = M_arena_memdup(arena, "xyz", 3);
+	ck_assert_msg(M_mem_eq(s, "xyz", 3), "memdup wrong");
+	ck_assert_msg(M_arena_strdup(arena, NULL) == NULL, "strdup NULL not NULL");
+
+	ck_assert_msg(M_arena_bytes_used(arena) <= M_arena_bytes_allocated(arena), "used %zu > allocated %zu", M_arena_bytes_used(arena), M_arena_bytes_allocated(arena));
+
+	M_arena_destroy(arena);
+}
+END_TEST
+
+START_TEST(check_arena_large)
+{
+	M_arena_t     *arena;
+	unsigned char *small;
+	unsigned char *large;
+	unsigned char *after;
+
+	arena = M_arena_create(256);
+
+	small = M_arena_alloc(arena, 16);
+	large = M_arena_alloc(arena, 4096);
+	after = M_arena_alloc(arena, 16);
+	ck_assert_msg(large != NULL, "large alloc failed");
+	M_mem_set(large, 'a', 4096);
+
+	/* The large allocation doesn't use up the current chunk. */
+	ck_assert_msg(after > small && after < small+256, "chunk not used after large alloc");
+	ck_assert_msg(M_arena_bytes_allocated(arena) >= 4096+256, "allocated %zu", M_arena_bytes_allocated(arena));
+
+	/* Large chunks are released on reset. */
+	M_arena_reset(arena);
+	ck_assert_msg(M_arena_bytes_used(arena) == 0, "used %zu after reset", M_arena_bytes_used(arena));
+	ck_assert_msg(M_arena_bytes_allocated(arena) == 256, "allocated %zu after reset", M_arena_bytes_allocated(arena));
+
+	M_arena_destroy(arena);
+}
+END_TEST
+
+START_TEST(check_arena_reset)
+{
+	M_arena_t *arena;
+	void      *first;
+	size_t     allocated;
+	size_t     i;
+	size_t     j;
+
+	arena = M_arena_create(0);
+
+	first = M_arena_alloc(arena, 100);
+	for (i=0; i<1000; i++)
+		ck_assert_msg(M_arena_alloc(arena, 100) != NULL, "%zu: alloc failed", i);
+	allocated = M_arena_bytes_allocated(arena);
+	ck_assert_msg(allocated >= 100*1000, "allocated %zu", allocated);
+
+	/* Reuses the same chunks without allocating more. */
+	for (j=0; j<10; j++) {
+		M_arena_reset(arena);
+		ck_assert_msg(M_arena_alloc(arena, 100) == first, "%zu: first chunk not reused", j);
+		for (i=0; i<1000; i++)
+			ck_assert_msg(M_arena_alloc(arena, 100) != NULL, "%zu: alloc failed", i);
+		ck_assert_msg(M_arena_bytes_allocated(arena) == allocated, "%zu: allocated %zu != %zu", j, M_arena_bytes_allocated(arena), allocated);
+	}
+
+	M_arena_destroy(arena);
+}
+END_TEST
+
+START_TEST(check_arena_containers)
+{
+	M_arena_t           *arena;
+	M_list_t            *l;
+	M_hash_strvp_t      *hv;
+	M_hash_strvp_enum_t *hvenum;
+	M_hash_dict_t       *hd;
+	M_hash_dict_t       *dup;
+	M_hash_dict_t       *heap;
+	const char          *ckey;
+	char                 key[16];
+	size_t               len;
+	size_t               i;
+
+	arena = M_arena_create(0);
+
+	ck_assert_msg(M_list_create_arena(NULL, NULL, M_LIST_NONE) == NULL, "list without arena created");
+	ck_assert_msg(M_hash_dict_create_arena(NULL, 8, 75, M_HASH_DICT_NONE) == NULL, "dict without arena created");
+	ck_assert_msg(M_hash_strvp_create_arena(arena, 8, 75, M_HASH_STRVP_KEYS_ORDERED|M_HASH_STRVP_KEYS_SORTASC, NULL) == NULL, "sorted keys created");
+
+	/* Storage grows by copying within the arena. */
+	l = M_list_create_arena(arena, NULL, M_LIST_NONE);
+	for (i=0; i<1000; i++)
+		M_list_insert(l, (void *)(i+1));
+	for (i=0; i<500; i++)
+		M_list_remove_at(l, 0);
+	ck_assert_msg(M_list_len(l) == 500, "list len %zu", M_list_len(l));
+	ck_assert_msg(M_list_at(l, 0) == (void *)501, "list first wrong");
+
+	/* Keys and rehashes in the arena. */
+	hv = M_hash_strvp_create_arena(arena, 8, 75, M_HASH_STRVP_KEYS_ORDERED|M_HASH_STRVP_KEYS_LOWER|M_HASH_STRVP_CASECMP, NULL);
+	for (i=0; i<1000; i++) {
+		M_snprintf(key, sizeof(key), "KEY%zu", i);
+		ck_assert_msg(M_hash_strvp_insert(hv, key, (void *)(i+1)), "%s: insert failed", key);
+	}
+	ck_assert_msg(M_hash_strvp_remove(hv, "key10", M_TRUE), "remove failed");
+	ck_assert_msg(M_hash_strvp_num_keys(hv) == 999, "strvp num keys %zu", M_hash_strvp_num_keys(hv));
+	ck_assert_msg(M_hash_strvp_get_direct(hv, "key999") == (void *)1000, "strvp value wrong");
+	M_hash_strvp_enumerate(hv, &hvenum);
+	ck_assert_msg(M_hash_strvp_enumerate_next(hv, hvenum, &ckey, NULL) && M_str_eq(ckey, "key0"), "strvp first key wrong");
+	M_hash_strvp_enumerate_free(hvenum);
+
+	/* Keys and values in the arena. */
+	hd = M_hash_dict_create_arena(arena, 8, 75, M_HASH_DICT_MULTI_VALUE|M_HASH_DICT_KEYS_ORDERED|M_HASH_DICT_CASECMP);
+	for (i=0; i<100; i++) {
+		M_snprintf(key, sizeof(key), "key%zu", i);
+		M_hash_dict_insert(hd, key, "a");
+		M_hash_dict_insert(hd, key, "b");
+	}
+	ck_assert_msg(M_hash_dict_multi_len(hd, "KEY50", &len) && len == 2, "dict multi len wrong");
+	ck_assert_msg(M_str_eq(M_hash_dict_multi_get_direct(hd, "key50", 1), "b"), "dict value wrong");
+
+	dup = M_hash_dict_duplicate(hd);
+	ck_assert_msg(M_hash_dict_num_keys(dup) == 100, "dup num keys %zu", M_hash_dict_num_keys(dup));
+
+	/* Merging out of the arena copies. */
+	heap = M_hash_dict_create(8, 75, M_HASH_DICT_MULTI_VALUE|M_HASH_DICT_CASECMP);
+	M_hash_dict_insert(heap, "key0", "c");
+	M_hash_dict_merge(&heap, dup);
+	ck_assert_msg(M_hash_dict_multi_len(heap, "key0", &len) && len == 3, "merged multi len wrong");
+
+	/* And into it. */
+	dup = M_hash_dict_create(8, 75, M_HASH_DICT_NONE);
+	M_hash_dict_insert(dup, "new", "d");
+	M_hash_dict_merge(&hd, dup);
+	ck_assert_msg(M_str_eq(M_hash_dict_get_direct(hd, "new"), "d"), "merged value wrong");
+
+	/* Nothing from the arena has to be destroyed. */
+	M_arena_reset(arena);
+
+	ck_assert_msg(M_str_eq(M_hash_dict_multi_get_direct(heap, "key99", 0), "a"), "merged value wrong after reset");
+	M_hash_dict_destroy(heap);
+
+	M_arena_destroy(arena);
+}
+END_TEST
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+Suite *M_arena_suite(void)
+{
+	Suite *suite;
+	TCase *tc_arena_alloc;
+	TCase *tc_arena_large;
+	TCase *tc_arena_reset;
+	TCase *tc_arena_containers;
+
+	suite = suite_create("arena");
+
+	tc_arena_alloc = tcase_create("arena_alloc");
+	tcase_add_test(tc_arena_alloc, check_arena_alloc);
+	suite_add_tcase(suite, tc_arena_alloc);
+
+	tc_arena_large = tcase_create("arena_large");
+	tcase_add_test(tc_arena_large, check_arena_large);
+	suite_add_tcase(suite, tc_arena_large);
+
+	tc_arena_reset = tcase_create("arena_reset");
+	tcase_add_test(tc_arena_reset, check_arena_reset);
+	suite_add_tcase(suite, tc_arena_reset);
+
+	tc_arena_containers = tcase_create("arena_containers");
+	tcase_add_test(tc_arena_containers, check_arena_containers);
+	suite_add_tcase(suite, tc_arena_containers);
+
+	return suite;
+}
+
+int main(void)
+{
+	SRunner *sr;
+	int      nf;
+
+	sr = srunner_create(M_arena_suite());
+	if (getenv("CK_LOG_FILE_NAME")==NULL) srunner_set_log(sr, "check_arena.log");
+
+	srunner_run_all(sr, CK_NORMAL);
+	nf = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	return nf == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
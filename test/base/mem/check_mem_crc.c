@@ -0,0 +1,190 @@
+#include "m_config.h"
+#include <stdlib.h> /* EXIT_SUCCESS, EXIT_FAILURE, srand, rand */
+#include <check.h>
+
+#include <mstdlib/mstdlib.h>
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+extern Suite *M_mem_crc_suite(void);
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define BENCH_SIZE   (8 * 1024 * 1024)
+#define BENCH_ROUNDS 20
+
+/* Bit at a time reference implementation. */
+static M_uint32 ref_crc(M_uint32 poly, const M_uint8 *s, size_t s_len)
+{
+	M_uint32 crc = 0xFFFFFFFF;
+	size_t   i;
+	size_t   j;
+
+	for (i=0; i<s_len; i++) {
+		crc ^= s[i];
+		for (j=0; j<8; j++) {
+			crc = (crc & 1) ? (crc >> 1) ^ poly : crc >> 1;
+		}
+	}
+	return ~crc;
+}
+
+static double mb_per_sec(size_t len, M_uint64 ms)
+{
+	if (ms == 0)
+		ms = 1;
+	return ((double)len * BENCH_ROUNDS / (1024 * 1024)) / ((double)ms / 1000);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+START_TEST(check_mem_crc_vectors)
+{
+	const char *check = "123456789";
+
+	ck_assert_msg(M_mem_calc_crc32(check, 9) == 0xCBF43926, "crc32 %08X", M_mem_calc_crc32(check, 9));
+	ck_assert_msg(M_mem_calc_crc32c(check, 9) == 0xE3069283, "crc32c %08X", M_mem_calc_crc32c(check, 9));
+
+	ck_assert(M_mem_calc_crc32(NULL, 0) == 0);
+	ck_assert(M_mem_calc_crc32c(NULL, 0) == 0);
+	ck_assert(M_mem_calc_crc32_update(0x1234, NULL, 0) == 0x1234);
+	ck_assert(M_mem_calc_crc32c_update(0x1234, check, 0) == 0x1234);
+}
+END_TEST
+
+START_TEST(check_mem_crc_random)
+{
+	M_rand_t *rand;
+	M_uint8  *data;
+	M_uint8  *buf;
+	size_t    len;
+	size_t    off;
+	size_t    chunk;
+	M_uint32  crc;
+	M_uint32  crcc;
+	size_t    i;
+
+	rand = M_rand_create(1);
+	data = M_malloc(4096);
+	for (i=0; i<4096; i++)
+		data[i] = (M_uint8)M_rand_max(rand, 256);
+
+	for (i=0; i<2000; i++) {
+		/* Mostly short lengths around the kernel block sizes. */
+		len = (size_t)M_rand_max(rand, i % 4 == 0 ? 4096 : 300);
+		off = (size_t)M_rand_max(rand, 16);
+		if (off + len > 4096)
+			len = 4096 - off;
+
+		/* Exact size copy so reading past the end is caught. */
+		buf = M_memdup(data + off, len);
+
+		ck_assert_msg(M_mem_calc_crc32(buf, len) == ref_crc(0xEDB88320, buf, len), "crc32 len %zu", len);
+		ck_assert_msg(M_mem_calc_crc32c(buf, len) == ref_crc(0x82F63B78, buf, len), "crc32c len %zu", len);
+
+		/* Random chunking gives the same result as one call. */
+		crc  = 0;
+		crcc = 0;
+		for (off=0; off<len; off+=chunk) {
+			chunk = (size_t)M_rand_range(rand, 1, 200);
+			if (chunk > len - off)
+				chunk = len - off;
+			crc  = M_mem_calc_crc32_update(crc, buf + off, chunk);
+			crcc = M_mem_calc_crc32c_update(crcc, buf + off, chunk);
+		}
+		ck_assert_msg(crc == M_mem_calc_crc32(buf, len), "crc32 chunked len %zu", len);
+		ck_assert_msg(crcc == M_mem_calc_crc32c(buf, len), "crc32c chunked len %zu", len);
+
+		M_free(buf);
+	}
+
+	M_free(data);
+	M_rand_destroy(rand);
+}
+END_TEST
+
+START_TEST(check_mem_crc_bench)
+{
+	M_uint8     *buf;
+	M_rand_t    *rand;
+	M_timeval_t  start;
+	M_uint64     t_crc;
+	M_uint64     t_crcc;
+	M_uint32     crc  = 0;
+	M_uint32     crcc = 0;
+	M_uint32     res;
+	size_t       i;
+
+	rand = M_rand_create(1);
+	buf  = M_malloc(BENCH_SIZE);
+	for (i=0; i<BENCH_SIZE; i++)
+		buf[i] = (M_uint8)M_rand_max(rand, 256);
+	M_rand_destroy(rand);
+
+	M_printf("mem crc: %d MB\n", BENCH_SIZE / (1024 * 1024));
+
+	/* Chain the rounds so none can be skipped. */
+	M_time_elapsed_start(&start);
+	for (i=0; i<BENCH_ROUNDS; i++)
+		crc = M_mem_calc_crc32_update(crc, buf, BENCH_SIZE);
+	t_crc = M_time_elapsed(&start);
+
+	M_time_elapsed_start(&start);
+	for (i=0; i<BENCH_ROUNDS; i++)
+		crcc = M_mem_calc_crc32c_update(crcc, buf, BENCH_SIZE);
+	t_crcc = M_time_elapsed(&start);
+
+	M_printf("  M_mem_calc_crc32  %8.0f MB/s\n", mb_per_sec(BENCH_SIZE, t_crc));
+	M_printf("  M_mem_calc_crc32c %8.0f MB/s\n", mb_per_sec(BENCH_SIZE, t_crcc));
+
+	/* Large input through the hardware kernels matches the reference. */
+	res = M_mem_calc_crc32(buf, BENCH_SIZE);
+	ck_assert(res == ref_crc(0xEDB88320, buf, BENCH_SIZE));
+	res = M_mem_calc_crc32c(buf, BENCH_SIZE);
+	ck_assert(res == ref_crc(0x82F63B78, buf, BENCH_SIZE));
+
+	M_free(buf);
+}
+END_TEST
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+Suite *M_mem_crc_suite(void)
+{
+	Suite *suite;
+	TCase *tc_vectors;
+	TCase *tc_random;
+	TCase *tc_bench;
+
+	suite = suite_create("mem_crc");
+
+	tc_vectors = tcase_create("mem_crc_vectors");
+	tcase_add_test(tc_vectors, check_mem_crc_vectors);
+	suite_add_tcase(suite, tc_vectors);
+
+	tc_random = tcase_create("mem_crc_random");
+	tcase_add_test(tc_random, check_mem_crc_random);
+	suite_add_tcase(suite, tc_random);
+
+	tc_bench = tcase_create("mem_crc_bench");
+	tcase_add_test(tc_bench, check_mem_crc_bench);
+	tcase_set_timeout(tc_bench, 60);
+	suite_add_tcase(suite, tc_bench);
+
+	return suite;
+}
+
+int main(void)
+{
+	SRunner *sr;
+	int      nf;
+
+	sr = srunner_create(M_mem_crc_suite());
+	if (getenv("CK_LOG_FILE_NAME")==NULL) srunner_set_log(sr, "check_mem_crc.log");
+
+	srunner_run_all(sr, CK_NORMAL);
+	nf = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	return nf == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,258 @@
+#include "m_config.h"
+#include <stdlib.h> /* EXIT_SUCCESS, EXIT_FAILURE, srand, rand */
+#include <check.h>
+
+#include <mstdlib/mstdlib.h>
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+extern Suite *M_mem_search_suite(void);
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define BENCH_SIZE   (8 * 1024 * 1024)
+#define BENCH_ROUNDS 50
+
+/* Reference implementations checking every position one at a time. */
+static const M_uint8 *ref_mem(const M_uint8 *h, size_t h_len, const M_uint8 *n, size_t n_len)
+{
+	size_t i;
+	size_t j;
+
+	for (i=0; i + n_len <= h_len; i++) {
+		for (j=0; j<n_len && h[i+j] == n[j]; j++)
+			;
+		if (j == n_len) {
+			return h + i;
+		}
+	}
+	return NULL;
+}
+
+static const M_uint8 *ref_rmem(const M_uint8 *h, size_t h_len, const M_uint8 *n, size_t n_len)
+{
+	size_t i;
+	size_t j;
+
+	for (i=h_len-n_len+1; i-->0; ) {
+		for (j=0; j<n_len && h[i+j] == n[j]; j++)
+			;
+		if (j == n_len) {
+			return h + i;
+		}
+	}
+	return NULL;
+}
+
+static size_t ref_count(const M_uint8 *s, size_t s_len, M_uint8 b)
+{
+	size_t cnt = 0;
+	size_t i;
+
+	for (i=0; i<s_len; i++) {
+		if (s[i] == b) {
+			cnt++;
+		}
+	}
+	return cnt;
+}
+
+static double mb_per_sec(size_t len, M_uint64 ms)
+{
+	if (ms == 0)
+		ms = 1;
+	return ((double)len * BENCH_ROUNDS / (1024 * 1024)) / ((double)ms / 1000);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+START_TEST(check_mem_search_random)
+{
+	M_rand_t *rand;
+	M_uint8   buf[300];
+	M_uint8   needle[40];
+	M_uint8  *h;
+	size_t    round;
+	size_t    h_off;
+	size_t    h_len;
+	size_t    n_len;
+	size_t    i;
+
+	rand = M_rand_create(1);
+
+	/* Small alphabets so first and last byte matches are common and
+	 * partial matches get through to the full compare. Haystacks at every
+	 * alignment and lengths around the block sizes. */
+	for (round=0; round<20000; round++) {
+		M_uint64 alphabet = M_rand_range(rand, 2, 5);
+
+		h_off = (size_t)M_rand_max(rand, 16);
+		h_len = (size_t)M_rand_max(rand, sizeof(buf) - h_off + 1);
+		n_len = (size_t)M_rand_range(rand, 1, sizeof(needle) + 1);
+
+		for (i=0; i<sizeof(buf); i++)
+			buf[i] = (M_uint8)('a' + M_rand_max(rand, alphabet));
+		for (i=0; i<n_len; i++)
+			needle[i] = (M_uint8)('a' + M_rand_max(rand, alphabet));
+
+		/* Plant the needle to get matches in long needles too. */
+		if (h_len >= n_len && round % 3 == 0)
+			M_mem_copy(buf + h_off + M_rand_max(rand, h_len - n_len + 1), needle, n_len);
+
+		/* Exact size copy so reading past the end is caught by memory checkers. */
+		h = M_malloc(h_len + 1);
+		M_mem_copy(h, buf + h_off, h_len);
+
+		if (n_len <= h_len) {
+			ck_assert_msg(M_mem_mem(h, h_len, needle, n_len) == ref_mem(h, h_len, needle, n_len),
+				"%zu: mem wrong, haystack %zu (offset %zu), needle %zu", round, h_len, h_off, n_len);
+			if (h_len > 0) {
+				ck_assert_msg(M_mem_rmem(h, h_len, needle, n_len) == ref_rmem(h, h_len, needle, n_len),
+					"%zu: rmem wrong, haystack %zu (offset %zu), needle %zu", round, h_len, h_off, n_len);
+			}
+		} else {
+			ck_assert_msg(M_mem_mem(h, h_len, needle, n_len) == NULL, "%zu: needle longer than haystack found", round);
+			ck_assert_msg(M_mem_rmem(h, h_len, needle, n_len) == NULL, "%zu: needle longer than haystack rfound", round);
+		}
+
+		ck_assert_msg(M_mem_count(h, h_len, needle[0]) == ref_count(h, h_len, needle[0]),
+			"%zu: count wrong, len %zu (offset %zu)", round, h_len, h_off);
+
+		M_free(h);
+	}
+
+	M_rand_destroy(rand);
+}
+END_TEST
+
+START_TEST(check_mem_search_count_large)
+{
+	M_uint8 *buf;
+	size_t   len = 300 * 1024;
+
+	/* More than 255 blocks of matches to check the per lane counters are
+	 * added up before overflowing. */
+	buf = M_malloc(len);
+	M_mem_set(buf, 'x', len);
+	ck_assert_msg(M_mem_count(buf, len, 'x') == len, "count %zu != %zu", M_mem_count(buf, len, 'x'), len);
+	ck_assert_msg(M_mem_count(buf, len, 'y') == 0, "count of missing byte not 0");
+	buf[len-1] = 'y';
+	ck_assert_msg(M_mem_count(buf, len, 'x') == len-1, "count %zu != %zu", M_mem_count(buf, len, 'x'), len-1);
+	M_free(buf);
+}
+END_TEST
+
+START_TEST(check_mem_search_bench)
+{
+	M_uint8           *buf;
+	M_uint8 *volatile  vbuf;
+	const M_uint8     *needle = (const M_uint8 *)"\r\n--boundary-7MA4YWxkTrZu0gW";
+	size_t             n_len  = M_str_len((const char *)needle);
+	M_rand_t          *rand;
+	M_timeval_t        start;
+	M_uint64           t_lib;
+	M_uint64           t_ref;
+	size_t             cnt    = 0;
+	size_t             i;
+
+	/* Text like data with lots of '\r' and '-' so the first byte of the
+	 * needle is common, needle at the very end. */
+	rand = M_rand_create(1);
+	buf  = M_malloc(BENCH_SIZE);
+	for (i=0; i<BENCH_SIZE; i++) {
+		M_uint64 r = M_rand_max(rand, 64);
+		buf[i] = r == 0 ? '\r' : (r == 1 ? '\n' : (r == 2 ? '-' : (M_uint8)('a' + (r % 26))));
+	}
+	M_mem_copy(buf + BENCH_SIZE - n_len, needle, n_len);
+	M_rand_destroy(rand);
+	/* Read through a volatile each round so the compiler can't hoist the
+	 * reference searches out of the loops. */
+	vbuf = buf;
+
+	M_printf("mem search: %d MB\n", BENCH_SIZE / (1024 * 1024));
+
+	M_time_elapsed_start(&start);
+	for (i=0; i<BENCH_ROUNDS; i++)
+		ck_assert(M_mem_mem(vbuf, BENCH_SIZE, needle, n_len) == buf + BENCH_SIZE - n_len);
+	t_lib = M_time_elapsed(&start);
+	M_time_elapsed_start(&start);
+	for (i=0; i<BENCH_ROUNDS; i++)
+		ck_assert(ref_mem(vbuf, BENCH_SIZE, needle, n_len) == buf + BENCH_SIZE - n_len);
+	t_ref = M_time_elapsed(&start);
+	M_printf("  M_mem_mem   %8.0f MB/s, byte loop %8.0f MB/s\n", mb_per_sec(BENCH_SIZE, t_lib), mb_per_sec(BENCH_SIZE, t_ref));
+
+	/* Needle at the start for the reverse search. */
+	M_mem_copy(buf + BENCH_SIZE - n_len, buf, n_len);
+	M_mem_copy(buf, needle, n_len);
+	M_time_elapsed_start(&start);
+	for (i=0; i<BENCH_ROUNDS; i++)
+		ck_assert(M_mem_rmem(vbuf, BENCH_SIZE, needle, n_len) == buf);
+	t_lib = M_time_elapsed(&start);
+	M_time_elapsed_start(&start);
+	for (i=0; i<BENCH_ROUNDS; i++)
+		ck_assert(ref_rmem(vbuf, BENCH_SIZE, needle, n_len) == buf);
+	t_ref = M_time_elapsed(&start);
+	M_printf("  M_mem_rmem  %8.0f MB/s, byte loop %8.0f MB/s\n", mb_per_sec(BENCH_SIZE, t_lib), mb_per_sec(BENCH_SIZE, t_ref));
+
+	M_time_elapsed_start(&start);
+	for (i=0; i<BENCH_ROUNDS; i++)
+		cnt += M_mem_count(vbuf, BENCH_SIZE, '\n');
+	t_lib = M_time_elapsed(&start);
+	M_time_elapsed_start(&start);
+	for (i=0; i<BENCH_ROUNDS; i++)
+		cnt -= ref_count(vbuf, BENCH_SIZE, '\n');
+	t_ref = M_time_elapsed(&start);
+	ck_assert_msg(cnt == 0, "count mismatch");
+	M_printf("  M_mem_count %8.0f MB/s, byte loop %8.0f MB/s\n", mb_per_sec(BENCH_SIZE, t_lib), mb_per_sec(BENCH_SIZE, t_ref));
+
+	M_time_elapsed_start(&start);
+	for (i=0; i<BENCH_ROUNDS; i++)
+		ck_assert(M_mem_chr(vbuf, 0, BENCH_SIZE) == NULL);
+	t_lib = M_time_elapsed(&start);
+	M_printf("  M_mem_chr   %8.0f MB/s\n", mb_per_sec(BENCH_SIZE, t_lib));
+
+	M_free(buf);
+}
+END_TEST
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+Suite *M_mem_search_suite(void)
+{
+	Suite *suite;
+	TCase *tc_random;
+	TCase *tc_count_large;
+	TCase *tc_bench;
+
+	suite = suite_create("mem_search");
+
+	tc_random = tcase_create("mem_search_random");
+	tcase_add_test(tc_random, check_mem_search_random);
+	suite_add_tcase(suite, tc_random);
+
+	tc_count_large = tcase_create("mem_search_count_large");
+	tcase_add_test(tc_count_large, check_mem_search_count_large);
+	suite_add_tcase(suite, tc_count_large);
+
+	tc_bench = tcase_create("mem_search_bench");
+	tcase_add_test(tc_bench, check_mem_search_bench);
+	tcase_set_timeout(tc_bench, 60);
+	suite_add_tcase(suite, tc_bench);
+
+	return suite;
+}
+
+int main(void)
+{
+	SRunner *sr;
+	int      nf;
+
+	sr = srunner_create(M_mem_search_suite());
+	if (getenv("CK_LOG_FILE_NAME")==NULL) srunner_set_log(sr, "check_mem_search.log");
+
+	srunner_run_all(sr, CK_NORMAL);
+	nf = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	return nf == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,183 @@
+#include "m_config.h"
+#include <stdlib.h> /* EXIT_SUCCESS, EXIT_FAILURE, srand, rand */
+#include <check.h>
+
+#include <mstdlib/mstdlib.h>
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+extern Suite *M_mempool_suite(void);
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+START_TEST(check_mempool_alloc)
+{
+	M_mempool_t   *pool;
+	unsigned char *p[100];
+	unsigned char *obj;
+	size_t         i;
+	size_t         j;
+
+	ck_assert_msg(M_mempool_create(0, 0) == NULL, "0 size pool created");
+
+	pool = M_mempool_create(13, 8);
+	ck_assert_msg(M_mempool_obj_size(pool) >= 13 && M_mempool_obj_size(pool) % sizeof(void *) == 0, "obj size %zu not rounded", M_mempool_obj_size(pool));
+
+	/* Enough objects to span multiple slabs. Each must be zeroed and not
+	 * overlap any other. */
+	for (i=0; i<sizeof(p)/sizeof(*p); i++) {
+		p[i] = M_mempool_alloc(pool);
+		ck_assert_msg(p[i] != NULL, "%zu: alloc failed", i);
+		ck_assert_msg(((M_uintptr)p[i] % sizeof(void *)) == 0, "%zu: not aligned", i);
+		for (j=0; j<13; j++)
+			ck_assert_msg(p[i][j] == 0, "%zu: not zero at %zu", i, j);
+		M_mem_set(p[i], (int)i, 13);
+	}
+	for (i=0; i<sizeof(p)/sizeof(*p); i++) {
+		for (j=0; j<13; j++) {
+			ck_assert_msg(p[i][j] == (unsigned char)i, "%zu: overwritten at %zu", i, j);
+		}
+	}
+	ck_assert_msg(M_mempool_num_used(pool) == 100, "used %zu != 100", M_mempool_num_used(pool));
+	ck_assert_msg(M_mempool_num_allocated(pool) == 104, "allocated %zu != 104", M_mempool_num_allocated(pool));
+
+	/* Freed objects are reused before the pool grows and come back zeroed. */
+	M_mempool_free(pool, p[50]);
+	M_mempool_free(pool, NULL);
+	ck_assert_msg(M_mempool_num_used(pool) == 99, "used %zu != 99", M_mempool_num_used(pool));
+	obj = M_mempool_alloc(pool);
+	ck_assert_msg(obj == p[50], "freed object not reused");
+	for (j=0; j<13; j++)
+		ck_assert_msg(obj[j] == 0, "reused object not zero at %zu", j);
+	ck_assert_msg(M_mempool_num_allocated(pool) == 104, "allocated %zu != 104", M_mempool_num_allocated(pool));
+
+	for (i=0; i<sizeof(p)/sizeof(*p); i++)
+		M_mempool_free(pool, p[i]);
+	ck_assert_msg(M_mempool_num_used(pool) == 0, "used %zu != 0", M_mempool_num_used(pool));
+
+	M_mempool_destroy(pool);
+}
+END_TEST
+
+START_TEST(check_mempool_llist)
+{
+	struct M_llist_callbacks  callbacks = { M_sort_compar_vp, NULL, NULL, NULL };
+	M_llist_t                *l;
+	M_llist_node_t           *n;
+	size_t                    i;
+	size_t                    j;
+
+	/* Unsorted and sorted lists with nodes repeatedly going back to the pool. */
+	for (j=0; j<2; j++) {
+		l = M_llist_create(&callbacks, M_LLIST_MEMPOOL|(j==1?M_LLIST_SORTED:M_LLIST_NONE));
+		for (i=1; i<=1000; i++) {
+			M_llist_insert(l, (void *)i);
+			if (i % 3 == 0) {
+				ck_assert_msg(M_llist_remove_node(M_llist_first(l)), "%zu: remove failed", i);
+			}
+		}
+		ck_assert_msg(M_llist_len(l) == 667, "len %zu != 667", M_llist_len(l));
+
+		/* Order is preserved. */
+		n = M_llist_first(l);
+		i = (size_t)M_llist_node_val(n);
+		while ((n = M_llist_node_next(n)) != NULL) {
+			ck_assert_msg((size_t)M_llist_node_val(n) > i, "out of order after %zu", i);
+			i = (size_t)M_llist_node_val(n);
+		}
+		M_llist_destroy(l, M_FALSE);
+	}
+}
+END_TEST
+
+START_TEST(check_mempool_hashtable)
+{
+	M_hash_u64u64_t *h;
+	M_uint64         val;
+	M_uint64         i;
+
+	/* A small table that doesn't grow so most entries are chained. */
+	h = M_hash_u64u64_create(16, 0, M_HASH_U64U64_MEMPOOL|M_HASH_U64U64_KEYS_ORDERED);
+	for (i=0; i<2000; i++) {
+		M_hash_u64u64_insert(h, i, i*2);
+		if (i % 2 == 0) {
+			ck_assert_msg(M_hash_u64u64_remove(h, i/2), "%llu: remove failed", i/2);
+		}
+	}
+	ck_assert_msg(M_hash_u64u64_num_keys(h) == 1000, "num keys %zu != 1000", M_hash_u64u64_num_keys(h));
+	for (i=0; i<2000; i++) {
+		if (i < 1000) {
+			ck_assert_msg(!M_hash_u64u64_get(h, i, NULL), "%llu: removed key found", i);
+		} else {
+			ck_assert_msg(M_hash_u64u64_get(h, i, &val) && val == i*2, "%llu: key missing or wrong", i);
+		}
+	}
+	M_hash_u64u64_destroy(h);
+}
+END_TEST
+
+START_TEST(check_mempool_queue)
+{
+	M_queue_t *q;
+	size_t     i;
+
+	q = M_queue_create_ex(NULL, NULL, M_QUEUE_MEMPOOL);
+	for (i=1; i<=1000; i++) {
+		ck_assert_msg(M_queue_insert(q, (void *)i), "%zu: insert failed", i);
+		if (i % 2 == 0) {
+			ck_assert_msg(M_queue_take_first(q) == (void *)(i/2), "%zu: wrong first", i);
+		}
+	}
+	ck_assert_msg(M_queue_len(q) == 500, "len %zu != 500", M_queue_len(q));
+	ck_assert_msg(M_queue_remove(q, (void *)(size_t)750), "remove failed");
+	ck_assert_msg(!M_queue_exists(q, (void *)(size_t)750), "removed member exists");
+	ck_assert_msg(M_queue_exists(q, (void *)(size_t)751), "member missing");
+	M_queue_destroy(q);
+}
+END_TEST
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+Suite *M_mempool_suite(void)
+{
+	Suite *suite;
+	TCase *tc_mempool_alloc;
+	TCase *tc_mempool_llist;
+	TCase *tc_mempool_hashtable;
+	TCase *tc_mempool_queue;
+
+	suite = suite_create("mempool");
+
+	tc_mempool_alloc = tcase_create("mempool_alloc");
+	tcase_add_test(tc_mempool_alloc, check_mempool_alloc);
+	suite_add_tcase(suite, tc_mempool_alloc);
+
+	tc_mempool_llist = tcase_create("mempool_llist");
+	tcase_add_test(tc_mempool_llist, check_mempool_llist);
+	suite_add_tcase(suite, tc_mempool_llist);
+
+	tc_mempool_hashtable = tcase_create("mempool_hashtable");
+	tcase_add_test(tc_mempool_hashtable, check_mempool_hashtable);
+	suite_add_tcase(suite, tc_mempool_hashtable);
+
+	tc_mempool_queue = tcase_create("mempool_queue");
+	tcase_add_test(tc_mempool_queue, check_mempool_queue);
+	suite_add_tcase(suite, tc_mempool_queue);
+
+	return suite;
+}
+
+int main(void)
+{
+	SRunner *sr;
+	int      nf;
+
+	sr = srunner_create(M_mempool_suite());
+	if (getenv("CK_LOG_FILE_NAME")==NULL) srunner_set_log(sr, "check_mempool.log");
+
+	srunner_run_all(sr, CK_NORMAL);
+	nf = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	return nf == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,170 @@
+#include "m_config.h"
+#include <stdlib.h> /* EXIT_SUCCESS, EXIT_FAILURE, srand, rand */
+#include <check.h>
+
+#include <mstdlib/mstdlib.h>
+#include <mstdlib/mstdlib_thread.h>
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+extern Suite *M_mempool_concurrent_suite(void);
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define NUM_THREADS     8
+#define OPS_PER_THREAD  200000
+#define LIVE_OBJS       64
+#define OBJ_SIZE        48
+
+typedef struct {
+	M_mempool_concurrent_t *pool; /* NULL to use M_malloc. */
+	M_uint64                tag;
+} worker_t;
+
+static void *thread_worker(void *arg)
+{
+	worker_t *w = arg;
+	M_uint64 *live[LIVE_OBJS];
+	size_t    i;
+	size_t    j;
+
+	M_mem_set(live, 0, sizeof(live));
+
+	/* Keep a window of live objects, replacing one each iteration. Every
+	 * object is tagged so another thread handing out the same memory would
+	 * be noticed. */
+	for (i=0; i<OPS_PER_THREAD; i++) {
+		j = i % LIVE_OBJS;
+		if (live[j] != NULL) {
+			ck_assert_msg(live[j][0] == w->tag && live[j][1] == i - LIVE_OBJS, "object modified by another thread");
+			if (w->pool != NULL) {
+				M_mempool_concurrent_free(w->pool, live[j]);
+			} else {
+				M_free(live[j]);
+			}
+		}
+
+		if (w->pool != NULL) {
+			live[j] = M_mempool_concurrent_alloc(w->pool);
+			ck_assert_msg(live[j][0] == 0 && live[j][1] == 0, "object not zeroed");
+		} else {
+			live[j] = M_malloc_zero(OBJ_SIZE);
+		}
+		live[j][0] = w->tag;
+		live[j][1] = i;
+	}
+
+	for (j=0; j<LIVE_OBJS; j++) {
+		if (w->pool != NULL) {
+			M_mempool_concurrent_free(w->pool, live[j]);
+		} else {
+			M_free(live[j]);
+		}
+	}
+
+	return NULL;
+}
+
+static M_uint64 run_threads(M_mempool_concurrent_t *pool)
+{
+	M_thread_attr_t *tattr;
+	M_threadid_t     threads[NUM_THREADS];
+	worker_t         workers[NUM_THREADS];
+	M_timeval_t      start;
+	size_t           i;
+
+	M_time_elapsed_start(&start);
+
+	tattr = M_thread_attr_create();
+	M_thread_attr_set_create_joinable(tattr, M_TRUE);
+	for (i=0; i<NUM_THREADS; i++) {
+		workers[i].pool = pool;
+		workers[i].tag  = i+1;
+		threads[i]      = M_thread_create(tattr, thread_worker, &workers[i]);
+	}
+	M_thread_attr_destroy(tattr);
+	for (i=0; i<NUM_THREADS; i++)
+		M_thread_join(threads[i], NULL);
+
+	return M_time_elapsed(&start);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+START_TEST(check_mempool_concurrent_basic)
+{
+	M_mempool_concurrent_t *pool;
+	void                   *p[100];
+	size_t                  i;
+
+	ck_assert_msg(M_mempool_concurrent_create(0, 0) == NULL, "0 size pool created");
+
+	pool = M_mempool_concurrent_create(OBJ_SIZE, 8);
+	ck_assert_msg(M_mempool_concurrent_num_caches(pool) > 0, "no caches");
+
+	for (i=0; i<sizeof(p)/sizeof(*p); i++)
+		p[i] = M_mempool_concurrent_alloc(pool);
+	ck_assert_msg(M_mempool_concurrent_num_used(pool) == 100, "used %zu != 100", M_mempool_concurrent_num_used(pool));
+
+	for (i=0; i<sizeof(p)/sizeof(*p); i++)
+		M_mempool_concurrent_free(pool, p[i]);
+	M_mempool_concurrent_free(pool, NULL);
+	ck_assert_msg(M_mempool_concurrent_num_used(pool) == 0, "used %zu != 0", M_mempool_concurrent_num_used(pool));
+
+	M_mempool_concurrent_destroy(pool);
+}
+END_TEST
+
+START_TEST(check_mempool_concurrent_threads)
+{
+	M_mempool_concurrent_t *pool;
+	M_uint64                pool_ms;
+	M_uint64                malloc_ms;
+
+	pool    = M_mempool_concurrent_create(OBJ_SIZE, 0);
+	pool_ms = run_threads(pool);
+	ck_assert_msg(M_mempool_concurrent_num_used(pool) == 0, "used %zu != 0", M_mempool_concurrent_num_used(pool));
+	M_mempool_concurrent_destroy(pool);
+
+	malloc_ms = run_threads(NULL);
+
+	M_printf("mempool: %d threads, %d alloc/free each: pool %llu ms, M_malloc %llu ms\n", NUM_THREADS, OPS_PER_THREAD, pool_ms, malloc_ms);
+}
+END_TEST
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+Suite *M_mempool_concurrent_suite(void)
+{
+	Suite *suite;
+	TCase *tc_basic;
+	TCase *tc_threads;
+
+	suite = suite_create("mempool_concurrent");
+
+	tc_basic = tcase_create("mempool_concurrent_basic");
+	tcase_add_test(tc_basic, check_mempool_concurrent_basic);
+	suite_add_tcase(suite, tc_basic);
+
+	tc_threads = tcase_create("mempool_concurrent_threads");
+	tcase_add_test(tc_threads, check_mempool_concurrent_threads);
+	tcase_set_timeout(tc_threads, 60);
+	suite_add_tcase(suite, tc_threads);
+
+	return suite;
+}
+
+int main(void)
+{
+	SRunner *sr;
+	int      nf;
+
+	sr = srunner_create(M_mempool_concurrent_suite());
+	if (getenv("CK_LOG_FILE_NAME")==NULL) srunner_set_log(sr, "check_mempool_concurrent.log");
+
+	srunner_run_all(sr, CK_NORMAL);
+	nf = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	return nf == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
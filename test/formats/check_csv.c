@@ -91,6 +91,68 @@ START_TEST(check_parse)
 }
 END_TEST
 
+/* Parsing uses a block index of the separators, the streaming reader goes a
+ * byte at a time. Rows from M_csv_parse are truncated and padded to the
+ * number of columns in the first row. */
+START_TEST(check_parse_random)
+{
+	static const char  alpha[] = ",\"\n\r ;a";
+	M_rand_t          *r;
+	M_csv_t           *csv;
+	M_csv_reader_t    *reader;
+	M_buf_t           *buf;
+	const char        *cell;
+	const char        *expected;
+	char              *data;
+	size_t             len;
+	size_t             num_cols;
+	size_t             row;
+	size_t             col;
+	size_t             i;
+	size_t             j;
+
+	r = M_rand_create(1);
+
+	for (i=0; i<2000; i++) {
+		buf = M_buf_create();
+		len = (size_t)(M_rand_max(r, 8) == 0 ? M_rand_max(r, 3000) : M_rand_max(r, 150));
+		for (j=0; j<len; j++) {
+			/* Long runs without separators cross block boundaries. */
+			if (i % 4 == 0 && M_rand_max(r, 3) != 0) {
+				M_buf_add_byte(buf, 'x');
+			} else {
+				M_buf_add_byte(buf, (unsigned char)alpha[M_rand_max(r, sizeof(alpha)-1)]);
+			}
+		}
+		data = M_buf_finish_str(buf, &len);
+
+		csv    = M_csv_parse(data, len, ',', '"', i & 1 ? M_CSV_FLAG_TRIM_WHITESPACE : M_CSV_FLAG_NONE);
+		reader = M_csv_reader_create(',', '"', i & 1 ? M_CSV_FLAG_TRIM_WHITESPACE : M_CSV_FLAG_NONE);
+		M_csv_reader_feed(reader, data, len);
+		M_csv_reader_finish(reader);
+
+		num_cols = M_csv_raw_num_cols(csv);
+		row      = 0;
+		while (M_csv_reader_next_row(reader) == M_CSV_READER_ROW) {
+			ck_assert_msg(row < M_csv_raw_num_rows(csv), "(%zu) more rows than %zu\n%s", i, M_csv_raw_num_rows(csv), data);
+			for (col=0; col<num_cols; col++) {
+				cell     = M_csv_raw_cell(csv, row, col);
+				expected = M_csv_reader_cell(reader, col, NULL);
+				ck_assert_msg(M_str_eq(cell, expected) && (cell == NULL) == (expected == NULL), "(%zu) row %zu col %zu: got '%s', expected '%s'\n%s", i, row, col, cell, expected, data);
+			}
+			row++;
+		}
+		ck_assert_msg(row == M_csv_raw_num_rows(csv), "(%zu) got %zu rows, expected %zu\n%s", i, M_csv_raw_num_rows(csv), row, data);
+
+		M_csv_reader_destroy(reader);
+		M_csv_destroy(csv);
+		M_free(data);
+	}
+
+	M_rand_destroy(r);
+}
+END_TEST
+
 START_TEST(check_parse_add_headers)
 {
 	M_csv_t      *csv;
@@ -269,6 +331,7 @@ int main(void)
 
 	add_test(suite, check_parse_inplace);
 	add_test(suite, check_parse);
+	add_test(suite, check_parse_random);
 	add_test(suite, check_parse_add_headers);
 	add_test(suite, check_write_basic);
 	add_test(suite, check_write_change_headers);
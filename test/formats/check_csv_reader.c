@@ -0,0 +1,331 @@
+#include "m_config.h"
+#include <stdlib.h> /* EXIT_SUCCESS, EXIT_FAILURE, srand, rand */
+#include <check.h>
+
+#include <mstdlib/mstdlib.h>
+#include <mstdlib/mstdlib_formats.h>
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+extern Suite *M_csv_reader_suite(void);
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define BENCH_ROWS 200000
+
+static const char *check_csv_reader_data[] = {
+	"\"header\"\"1\",header2,\"hea,der3\",\"header4\t\"\r\n"
+	"row1-h1,row1-h2,row1-h3,\r\n"
+	"row2-h1,,row2-h3,row2-h4\r\n"
+	"row3-h1,row3-h2,row3-h3,row3-h4\r\n",
+
+	"a,b,c\n"
+	"1,\"multi\nline\",3\n"
+	"\"\",\"say \"\"hi\"\"\",\" pad \"\n"
+	"  x  , y ,z\r\n"
+	"last,row,no newline",
+
+	"\"quoted \r\n new line\",\"\"\"\"\n"
+	"ab\"c,d\"e,f\n"
+	"x,\"unterminated,quote\n",
+
+	"one\n"
+	"\r\n"
+	"two\r\r\n"
+	"three",
+
+	NULL
+};
+
+/* Read everything feeding chunk_size bytes at a time. Each row is written
+ * to out with cells separated by '|' and NULL cells as '~'. */
+static void read_chunked(const char *data, size_t chunk_size, M_uint32 flags, M_buf_t *out)
+{
+	M_csv_reader_t        *reader;
+	M_csv_reader_result_t  res;
+	const char            *cell;
+	size_t                 len  = M_str_len(data);
+	size_t                 off  = 0;
+	size_t                 cell_len;
+	size_t                 i;
+
+	reader = M_csv_reader_create(',', '"', flags);
+	do {
+		if (off == len) {
+			M_csv_reader_finish(reader);
+		} else {
+			M_csv_reader_feed(reader, data+off, M_MIN(chunk_size, len-off));
+			off += M_MIN(chunk_size, len-off);
+		}
+
+		while ((res = M_csv_reader_next_row(reader)) == M_CSV_READER_ROW) {
+			for (i=0; i<M_csv_reader_num_cells(reader); i++) {
+				cell = M_csv_reader_cell(reader, i, &cell_len);
+				ck_assert_msg(cell == NULL || M_str_len(cell) == cell_len, "cell length %zu != %zu", cell_len, M_str_len(cell));
+				if (i != 0)
+					M_buf_add_byte(out, '|');
+				M_buf_add_str(out, cell == NULL ? "~" : cell);
+			}
+			M_buf_add_byte(out, '\n');
+		}
+	} while (res == M_CSV_READER_NEED_MORE);
+	ck_assert_msg(res == M_CSV_READER_DONE, "reader did not finish");
+	ck_assert_msg(M_csv_reader_next_row(reader) == M_CSV_READER_DONE, "reader returned more after finishing");
+
+	M_csv_reader_destroy(reader);
+}
+
+/* Same output format as read_chunked using M_csv_parse. */
+static void read_parse(const char *data, M_uint32 flags, M_buf_t *out)
+{
+	M_csv_t    *csv;
+	const char *cell;
+	size_t      row;
+	size_t      col;
+
+	csv = M_csv_parse(data, M_str_len(data), ',', '"', flags);
+	for (row=0; row<M_csv_raw_num_rows(csv); row++) {
+		for (col=0; col<M_csv_raw_num_cols(csv); col++) {
+			cell = M_csv_raw_cell(csv, row, col);
+			if (col != 0)
+				M_buf_add_byte(out, '|');
+			M_buf_add_str(out, cell == NULL ? "~" : cell);
+		}
+		M_buf_add_byte(out, '\n');
+	}
+	M_csv_destroy(csv);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+START_TEST(check_csv_reader_chunks)
+{
+	M_buf_t      *expected;
+	M_buf_t      *got;
+	size_t        chunk_sizes[] = { 1, 2, 3, 7, 64, 1024*1024 };
+	M_uint32      flags[]       = { M_CSV_FLAG_NONE, M_CSV_FLAG_TRIM_WHITESPACE };
+	size_t        i;
+	size_t        j;
+	size_t        k;
+
+	for (i=0; check_csv_reader_data[i]!=NULL; i++) {
+		for (k=0; k<sizeof(flags)/sizeof(*flags); k++) {
+			expected = M_buf_create();
+			read_parse(check_csv_reader_data[i], flags[k], expected);
+
+			for (j=0; j<sizeof(chunk_sizes)/sizeof(*chunk_sizes); j++) {
+				got = M_buf_create();
+				read_chunked(check_csv_reader_data[i], chunk_sizes[j], flags[k], got);
+				ck_assert_msg(M_str_eq(M_buf_peek(got), M_buf_peek(expected)), "(%zu) flags %u chunk %zu:\ngot:\n%s\nexpected:\n%s", i, flags[k], chunk_sizes[j], M_buf_peek(got), M_buf_peek(expected));
+				M_buf_cancel(got);
+			}
+
+			M_buf_cancel(expected);
+		}
+	}
+}
+END_TEST
+
+START_TEST(check_csv_reader_quotes)
+{
+	M_csv_reader_t *reader;
+	const char     *cell;
+	size_t          len;
+
+	reader = M_csv_reader_create(',', '"', M_CSV_FLAG_NONE);
+
+	/* Doubled quote split across chunks. */
+	M_csv_reader_feed(reader, "a,\"b\nc\"", 7);
+	ck_assert_msg(M_csv_reader_next_row(reader) == M_CSV_READER_NEED_MORE, "row returned before quote was closed");
+	M_csv_reader_feed(reader, "\"d\",e", 5);
+	ck_assert_msg(M_csv_reader_next_row(reader) == M_CSV_READER_NEED_MORE, "row returned without new line");
+	M_csv_reader_feed(reader, "\nf", 2);
+	ck_assert_msg(M_csv_reader_next_row(reader) == M_CSV_READER_ROW, "row not returned");
+	ck_assert_msg(M_csv_reader_num_cells(reader) == 3, "got %zu cells, expected 3", M_csv_reader_num_cells(reader));
+	cell = M_csv_reader_cell(reader, 1, &len);
+	ck_assert_msg(M_str_eq(cell, "b\nc\"d") && len == 5, "got cell '%s' (%zu)", cell, len);
+	ck_assert_msg(M_str_eq(M_csv_reader_cell(reader, 2, NULL), "e"), "third cell wrong");
+	ck_assert_msg(M_csv_reader_cell(reader, 3, NULL) == NULL, "cell past end of row");
+
+	/* Last row without a new line. */
+	ck_assert_msg(M_csv_reader_next_row(reader) == M_CSV_READER_NEED_MORE, "row returned before finish");
+	M_csv_reader_finish(reader);
+	ck_assert_msg(M_csv_reader_next_row(reader) == M_CSV_READER_ROW, "last row not returned");
+	ck_assert_msg(M_str_eq(M_csv_reader_cell(reader, 0, NULL), "f"), "last row cell wrong");
+	ck_assert_msg(M_csv_reader_next_row(reader) == M_CSV_READER_DONE, "not done");
+	ck_assert_msg(M_csv_reader_num_rows(reader) == 2, "got %zu rows, expected 2", M_csv_reader_num_rows(reader));
+
+	/* Reuse after reset with an open quote split across chunks. */
+	M_csv_reader_reset(reader);
+	M_csv_reader_feed(reader, "\"x\"\"", 4);
+	ck_assert_msg(M_csv_reader_next_row(reader) == M_CSV_READER_NEED_MORE, "row returned for open quote");
+	M_csv_reader_feed(reader, "y\"\n", 3);
+	ck_assert_msg(M_csv_reader_next_row(reader) == M_CSV_READER_ROW, "row not returned after reset");
+	ck_assert_msg(M_str_eq(M_csv_reader_cell(reader, 0, NULL), "x\"y"), "got cell '%s'", M_csv_reader_cell(reader, 0, NULL));
+	ck_assert_msg(M_csv_reader_num_rows(reader) == 1, "rows not reset");
+
+	M_csv_reader_destroy(reader);
+}
+END_TEST
+
+START_TEST(check_csv_reader_file)
+{
+	M_csv_reader_t        *reader;
+	M_csv_reader_result_t  res;
+	M_fs_file_t           *fd;
+	M_buf_t               *buf;
+	const char            *path = "check_csv_reader.csv";
+	size_t                 read_len;
+	size_t                 wrote;
+	size_t                 rows = 0;
+	size_t                 i;
+
+	buf = M_buf_create();
+	M_buf_add_str(buf, "id,name,note\n");
+	for (i=0; i<5000; i++) {
+		M_buf_add_uint(buf, i);
+		M_buf_add_str(buf, ",\"name, ");
+		M_buf_add_uint(buf, i);
+		M_buf_add_str(buf, "\",\"a \"\"quoted\"\"\nnote\"\n");
+	}
+
+	ck_assert_msg(M_fs_file_open(&fd, path, 0, M_FS_FILE_MODE_WRITE|M_FS_FILE_MODE_OVERWRITE, NULL) == M_FS_ERROR_SUCCESS, "could not open file for writing");
+	ck_assert_msg(M_fs_file_write(fd, (const unsigned char *)M_buf_peek(buf), M_buf_len(buf), &wrote, M_FS_FILE_RW_FULLBUF) == M_FS_ERROR_SUCCESS && wrote == M_buf_len(buf), "could not write file");
+	M_fs_file_close(fd);
+	M_buf_cancel(buf);
+
+	ck_assert_msg(M_fs_file_open(&fd, path, 0, M_FS_FILE_MODE_READ|M_FS_FILE_MODE_NOCREATE, NULL) == M_FS_ERROR_SUCCESS, "could not open file for reading");
+	reader = M_csv_reader_create(',', '"', M_CSV_FLAG_NONE);
+	do {
+		ck_assert_msg(M_csv_reader_feed_file(reader, fd, 1000, &read_len) == M_FS_ERROR_SUCCESS, "read failed");
+		if (read_len == 0)
+			M_csv_reader_finish(reader);
+
+		while ((res = M_csv_reader_next_row(reader)) == M_CSV_READER_ROW) {
+			ck_assert_msg(M_csv_reader_num_cells(reader) == 3, "row %zu: got %zu cells", rows, M_csv_reader_num_cells(reader));
+			if (rows > 0) {
+				ck_assert_msg(M_str_to_uint32(M_csv_reader_cell(reader, 0, NULL)) == rows-1, "row %zu: wrong id", rows);
+				ck_assert_msg(M_str_eq(M_csv_reader_cell(reader, 2, NULL), "a \"quoted\"\nnote"), "row %zu: wrong note '%s'", rows, M_csv_reader_cell(reader, 2, NULL));
+			}
+			rows++;
+		}
+	} while (res == M_CSV_READER_NEED_MORE);
+	ck_assert_msg(rows == 5001, "got %zu rows, expected 5001", rows);
+
+	M_csv_reader_destroy(reader);
+	M_fs_file_close(fd);
+	M_fs_delete(path, M_FALSE, NULL, 0);
+}
+END_TEST
+
+START_TEST(check_csv_reader_bench)
+{
+	M_csv_reader_t        *reader;
+	M_csv_reader_result_t  res;
+	M_csv_t               *csv;
+	M_buf_t               *buf;
+	M_timeval_t            tv;
+	M_uint64               ms;
+	const char            *data;
+	size_t                 len;
+	size_t                 off   = 0;
+	size_t                 rows  = 0;
+	size_t                 cells = 0;
+	size_t                 i;
+
+	buf = M_buf_create();
+	M_buf_add_str(buf, "id,merchant,amount,currency,status,reference,description\r\n");
+	for (i=0; i<BENCH_ROWS; i++) {
+		M_buf_add_uint(buf, i);
+		M_buf_add_str(buf, ",MERCHANT-");
+		M_buf_add_uint(buf, i % 977);
+		M_buf_add_byte(buf, ',');
+		M_buf_add_uint(buf, (i * 7919) % 100000);
+		M_buf_add_str(buf, ".00,USD,");
+		M_buf_add_str(buf, i % 10 == 0 ? "\"declined, retry\"" : "approved");
+		M_buf_add_str(buf, ",REF");
+		M_buf_add_uint(buf, i * 31);
+		M_buf_add_str(buf, i % 3 == 0 ? ",\"He said \"\"ok\"\"\"\r\n" : ",settlement batch item\r\n");
+	}
+	data = M_buf_peek(buf);
+	len  = M_buf_len(buf);
+
+	M_printf("csv reader: %zu bytes, %d rows\n", len, BENCH_ROWS);
+
+	M_time_elapsed_start(&tv);
+	csv = M_csv_parse(data, len, ',', '"', M_CSV_FLAG_NONE);
+	ms  = M_time_elapsed(&tv);
+	M_printf("  M_csv_parse         %6llu ms (%.1f MB/s)\n", ms, (double)len / 1048576.0 / ((double)(ms == 0 ? 1 : ms) / 1000.0));
+	ck_assert_msg(M_csv_raw_num_rows(csv) == BENCH_ROWS+1, "M_csv_parse got %zu rows", M_csv_raw_num_rows(csv));
+	M_csv_destroy(csv);
+
+	M_time_elapsed_start(&tv);
+	reader = M_csv_reader_create(',', '"', M_CSV_FLAG_NONE);
+	do {
+		if (off == len) {
+			M_csv_reader_finish(reader);
+		} else {
+			M_csv_reader_feed(reader, data+off, M_MIN(64*1024, len-off));
+			off += M_MIN(64*1024, len-off);
+		}
+		while ((res = M_csv_reader_next_row(reader)) == M_CSV_READER_ROW) {
+			rows++;
+			cells += M_csv_reader_num_cells(reader);
+		}
+	} while (res == M_CSV_READER_NEED_MORE);
+	M_csv_reader_destroy(reader);
+	ms = M_time_elapsed(&tv);
+	M_printf("  M_csv_reader 64K    %6llu ms (%.1f MB/s)\n", ms, (double)len / 1048576.0 / ((double)(ms == 0 ? 1 : ms) / 1000.0));
+	ck_assert_msg(rows == BENCH_ROWS+1, "reader got %zu rows", rows);
+	ck_assert_msg(cells == (BENCH_ROWS+1)*7, "reader got %zu cells", cells);
+
+	M_buf_cancel(buf);
+}
+END_TEST
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+Suite *M_csv_reader_suite(void)
+{
+	Suite *suite;
+	TCase *tc_chunks;
+	TCase *tc_quotes;
+	TCase *tc_file;
+	TCase *tc_bench;
+
+	suite = suite_create("csv_reader");
+
+	tc_chunks = tcase_create("check_csv_reader_chunks");
+	tcase_add_test(tc_chunks, check_csv_reader_chunks);
+	suite_add_tcase(suite, tc_chunks);
+
+	tc_quotes = tcase_create("check_csv_reader_quotes");
+	tcase_add_test(tc_quotes, check_csv_reader_quotes);
+	suite_add_tcase(suite, tc_quotes);
+
+	tc_file = tcase_create("check_csv_reader_file");
+	tcase_add_test(tc_file, check_csv_reader_file);
+	suite_add_tcase(suite, tc_file);
+
+	tc_bench = tcase_create("check_csv_reader_bench");
+	tcase_add_test(tc_bench, check_csv_reader_bench);
+	tcase_set_timeout(tc_bench, 60);
+	suite_add_tcase(suite, tc_bench);
+
+	return suite;
+}
+
+int main(void)
+{
+	SRunner *sr;
+	int      nf;
+
+	sr = srunner_create(M_csv_reader_suite());
+	if (getenv("CK_LOG_FILE_NAME")==NULL) srunner_set_log(sr, "check_csv_reader.log");
+
+	srunner_run_all(sr, CK_NORMAL);
+	nf = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	return nf == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
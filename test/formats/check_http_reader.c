@@ -1201,6 +1201,46 @@ START_TEST(check_body_len)
 }
 END_TEST
 
+START_TEST(check_arena)
+{
+	M_arena_t       *arena;
+	M_http_reader_t *hr;
+	httpr_test_t    *ht;
+	M_http_error_t   res;
+	size_t           len_read;
+	size_t           len;
+	size_t           allocated = 0;
+	size_t           i;
+
+	arena = M_arena_create(512);
+
+	for (i=0; i<10; i++) {
+		ht = httpr_test_create();
+		hr = gen_reader(ht);
+		M_http_reader_set_arena(hr, arena);
+
+		res = M_http_reader_read(hr, (const unsigned char *)http2_data, M_str_len(http2_data), &len_read);
+		ck_assert_msg(res == M_HTTP_ERROR_SUCCESS || res == M_HTTP_ERROR_SUCCESS_MORE_POSSIBLE, "%zu: Parse failed: %d", i, res);
+		ck_assert_msg(M_str_eq(ht->reason, "OK"), "%zu: Wrong reason: got '%s'", i, ht->reason);
+		ck_assert_msg(M_str_eq(M_hash_dict_get_direct(ht->headers_full, "list_header"), "1, 2, 3"), "%zu: list_header wrong", i);
+		ck_assert_msg(M_hash_dict_multi_len(ht->headers, "list_header", &len) && len == 3, "%zu: list_header not split", i);
+		ck_assert_msg(M_hash_dict_multi_len(ht->headers, "dup_header", &len) && len == 3, "%zu: dup_header missing values", i);
+		ck_assert_msg(M_arena_bytes_used(arena) > 0, "%zu: arena not used", i);
+
+		httpr_test_destroy(ht);
+		M_http_reader_destroy(hr);
+
+		/* Same chunks are reused for every message. */
+		if (i == 0)
+			allocated = M_arena_bytes_allocated(arena);
+		ck_assert_msg(M_arena_bytes_allocated(arena) == allocated, "%zu: arena grew", i);
+		M_arena_reset(arena);
+	}
+
+	M_arena_destroy(arena);
+}
+END_TEST
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 int main(void)
@@ -1227,6 +1267,7 @@ int main(void)
 	add_test(suite, check_header_format);
 	add_test(suite, check_query_string);
 	add_test(suite, check_body_len);
+	add_test(suite, check_arena);
 
 	sr = srunner_create(suite);
 	if (getenv("CK_LOG_FILE_NAME")==NULL) srunner_set_log(sr, "check_http_reader.log");
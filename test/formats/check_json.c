@@ -599,6 +599,74 @@ START_TEST(check_json_jsonpath_array)
 }
 END_TEST
 
+START_TEST(check_json_jsonpath_compile)
+{
+	M_json_node_t       *json;
+	M_json_node_t       *json2;
+	M_json_tape_t       *tape;
+	M_json_jsonpath_t   *path;
+	M_json_node_t      **results;
+	M_json_node_t      **expected;
+	M_json_tape_node_t **tape_results;
+	size_t               num_matches;
+	size_t               num_expected;
+	size_t               num_tape;
+	size_t               i;
+	size_t               j;
+
+	json  = M_json_read(JSONPATH_BOOKS, M_str_len(JSONPATH_BOOKS), M_JSON_READER_NONE, NULL, NULL, NULL, NULL);
+	json2 = M_json_read(JSONPATH_STR, M_str_len(JSONPATH_STR), M_JSON_READER_NONE, NULL, NULL, NULL, NULL);
+	tape  = M_json_tape_read(JSONPATH_BOOKS, M_str_len(JSONPATH_BOOKS), M_JSON_READER_NONE, NULL, NULL, NULL, NULL);
+	ck_assert_msg(json != NULL && json2 != NULL && tape != NULL, "JSON could not be parsed");
+
+	for (i=0; check_json_jsonpath_book_data[i].search!=NULL; i++) {
+		path = M_json_jsonpath_compile(check_json_jsonpath_book_data[i].search);
+		ck_assert_msg(path != NULL, "(%zu) '%s': could not compile", i, check_json_jsonpath_book_data[i].search);
+
+		/* Evaluating multiple times gives the same result as M_json_jsonpath. */
+		for (j=0; j<2; j++) {
+			results  = M_json_jsonpath_eval(path, json, &num_matches);
+			expected = M_json_jsonpath(json, check_json_jsonpath_book_data[i].search, &num_expected);
+			ck_assert_msg(num_matches == num_expected, "(%zu) '%s': got %zu matches, expected %zu", i, check_json_jsonpath_book_data[i].search, num_matches, num_expected);
+			ck_assert_msg(M_mem_eq(results, expected, num_matches * sizeof(*results)), "(%zu) '%s': matches differ", i, check_json_jsonpath_book_data[i].search);
+			M_free(results);
+			M_free(expected);
+		}
+
+		tape_results = M_json_tape_jsonpath_eval(path, M_json_tape_root(tape), &num_tape);
+		ck_assert_msg(num_tape == num_expected, "(%zu) '%s': got %zu tape matches, expected %zu", i, check_json_jsonpath_book_data[i].search, num_tape, num_expected);
+		M_free(tape_results);
+
+		M_json_jsonpath_destroy(path);
+	}
+
+	for (i=0; check_json_jsonpath_str_data[i].search!=NULL; i++) {
+		path     = M_json_jsonpath_compile(check_json_jsonpath_str_data[i].search);
+		results  = M_json_jsonpath_eval(path, json2, &num_matches);
+		expected = M_json_jsonpath(json2, check_json_jsonpath_str_data[i].search, &num_expected);
+		ck_assert_msg(num_matches == num_expected, "(%zu) '%s': got %zu matches, expected %zu", i, check_json_jsonpath_str_data[i].search, num_matches, num_expected);
+		ck_assert_msg(M_mem_eq(results, expected, num_matches * sizeof(*results)), "(%zu) '%s': matches differ", i, check_json_jsonpath_str_data[i].search);
+		M_free(results);
+		M_free(expected);
+		M_json_jsonpath_destroy(path);
+	}
+
+	/* Indexes are resolved against each array they're evaluated on. */
+	path    = M_json_jsonpath_compile("$..book[-1]");
+	results = M_json_jsonpath_eval(path, json, &num_matches);
+	ck_assert_msg(num_matches == 1 && M_str_eq(M_json_object_value_string(results[0], "title"), "The Lord of the Rings"), "'$..book[-1]': wrong match");
+	M_free(results);
+	M_json_jsonpath_destroy(path);
+
+	ck_assert_msg(M_json_jsonpath_compile("store") == NULL, "compiled expression without '$'");
+	ck_assert_msg(M_json_jsonpath_compile(NULL) == NULL, "compiled NULL expression");
+
+	M_json_tape_destroy(tape);
+	M_json_node_destroy(json2);
+	M_json_node_destroy(json);
+}
+END_TEST
+
 START_TEST(check_json_values)
 {
 	M_json_node_t *json;
@@ -863,6 +931,87 @@ START_TEST(check_json_large_number)
 }
 END_TEST
 
+START_TEST(check_json_arena)
+{
+	M_arena_t      *arena;
+	M_json_node_t  *json;
+	M_json_node_t  *n;
+	char           *out;
+	const char     *invalid = "[ 1, \"abc\", { \"a\": 1 }, tru ]";
+	const char     *escaped = "{ \"k\\\"1\": \"a\\\"bcdefgh\\u00e9\\n\", \"k2\": \"\" }";
+	char            key[16];
+	M_json_error_t  error;
+	size_t          allocated;
+	size_t          i;
+
+	arena = M_arena_create(512);
+
+	for (i=0; check_json_valid_data[i].data!=NULL; i++) {
+		json = M_json_read_arena(arena, check_json_valid_data[i].data, M_str_len(check_json_valid_data[i].data), M_JSON_READER_NONE, NULL, &error, NULL, NULL);
+		ck_assert_msg(json != NULL, "JSON (%zu) '%s' could not be parsed: %d", i, check_json_valid_data[i].data, error);
+
+		/* Modifying arena nodes. */
+		if (M_json_node_type(json) == M_JSON_TYPE_ARRAY) {
+			M_json_array_insert_string(json, "abc");
+			M_json_set_string(M_json_array_at(json, M_json_array_len(json)-1), "def");
+			M_json_node_destroy(M_json_array_at(json, M_json_array_len(json)-1));
+		}
+
+		if (check_json_valid_data[i].out != NULL) {
+			out = M_json_write(json, check_json_valid_data[i].writer_flags, NULL);
+			ck_assert_msg(M_str_eq(out, check_json_valid_data[i].out), "Output not as expected (%zu):\ngot='%s'\nexpected='%s'", i, out, check_json_valid_data[i].out);
+			M_free(out);
+		}
+
+		/* Everything is released by the reset, destroy isn't needed. */
+		M_arena_reset(arena);
+	}
+
+	/* What was already parsed stays in the arena until it's reset. */
+	json = M_json_read_arena(arena, invalid, M_str_len(invalid), M_JSON_READER_NONE, NULL, &error, NULL, NULL);
+	ck_assert_msg(json == NULL, "Invalid JSON parsed");
+	M_arena_reset(arena);
+
+	/* Strings are decoded directly into the arena. Decoded longer than the
+	 * text up to the first quote has to grow. */
+	json = M_json_read_arena(arena, escaped, M_str_len(escaped), M_JSON_READER_NONE, NULL, &error, NULL, NULL);
+	ck_assert_msg(json != NULL, "Escaped JSON could not be parsed: %d", error);
+	ck_assert_msg(M_str_eq(M_json_object_value_string(json, "k\"1"), "a\"bcdefgh\xc3\xa9\n"), "Escaped string wrong: '%s'", M_json_object_value_string(json, "k\"1"));
+	ck_assert_msg(M_str_eq(M_json_object_value_string(json, "k2"), ""), "Empty string wrong");
+
+	/* Object storage grows in the arena. */
+	for (i=0; i<200; i++) {
+		M_snprintf(key, sizeof(key), "key%zu", i);
+		ck_assert_msg(M_json_object_insert_int(json, key, (M_int64)i), "Could not insert %s", key);
+	}
+	for (i=0; i<200; i++) {
+		M_snprintf(key, sizeof(key), "key%zu", i);
+		ck_assert_msg(M_json_object_value_int(json, key) == (M_int64)i, "Wrong value for %s", key);
+	}
+
+	/* Arena and non-arena nodes can't be mixed. */
+	n = M_json_node_create(M_JSON_TYPE_NULL);
+	ck_assert_msg(!M_json_object_insert(json, "null", n), "Inserted non-arena node into arena node");
+	ck_assert_msg(!M_json_object_insert(n, "k2", M_json_object_value(json, "k2")), "Inserted arena node into non-arena node");
+	M_json_node_destroy(n);
+	M_arena_reset(arena);
+
+	/* Reused chunks once the arena is warmed up. */
+	M_arena_reset(arena);
+	json = M_json_read_arena(arena, check_json_valid_data[0].data, M_str_len(check_json_valid_data[0].data), M_JSON_READER_NONE, NULL, NULL, NULL, NULL);
+	ck_assert_msg(json != NULL, "JSON could not be parsed");
+	allocated = M_arena_bytes_allocated(arena);
+	for (i=0; i<10; i++) {
+		M_arena_reset(arena);
+		json = M_json_read_arena(arena, check_json_valid_data[0].data, M_str_len(check_json_valid_data[0].data), M_JSON_READER_NONE, NULL, NULL, NULL, NULL);
+		ck_assert_msg(json != NULL, "JSON could not be parsed");
+	}
+	ck_assert_msg(M_arena_bytes_allocated(arena) == allocated, "Arena grew: %zu != %zu", M_arena_bytes_allocated(arena), allocated);
+
+	M_arena_destroy(arena);
+}
+END_TEST
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 Suite *M_json_suite(void)
@@ -874,12 +1023,14 @@ Suite *M_json_suite(void)
 	TCase *tc_json_jsonpath_book;
 	TCase *tc_json_jsonpath_str;
 	TCase *tc_json_jsonpath_array;
+	TCase *tc_json_jsonpath_compile;
 	TCase *tc_json_values;
 	TCase *tc_json_parent_object;
 	TCase *tc_json_parent_array;
 	TCase *tc_json_object_unique_keys;
 	TCase *tc_json_object_get_string;
 	TCase *tc_json_large_number;
+	TCase *tc_json_arena;
 
 	suite = suite_create("json");
 
@@ -913,6 +1064,11 @@ Suite *M_json_suite(void)
 	tcase_set_timeout(tc_json_jsonpath_array, 300);
 	suite_add_tcase(suite, tc_json_jsonpath_array);
 
+	tc_json_jsonpath_compile = tcase_create("check_json_jsonpath_compile");
+	tcase_add_test(tc_json_jsonpath_compile, check_json_jsonpath_compile);
+	tcase_set_timeout(tc_json_jsonpath_compile, 300);
+	suite_add_tcase(suite, tc_json_jsonpath_compile);
+
 	tc_json_values = tcase_create("check_json_values");
 	tcase_add_test(tc_json_values, check_json_values);
 	tcase_set_timeout(tc_json_values, 300);
@@ -943,6 +1099,11 @@ Suite *M_json_suite(void)
 	tcase_set_timeout(tc_json_large_number, 300);
 	suite_add_tcase(suite, tc_json_large_number);
 
+	tc_json_arena = tcase_create("check_json_arena");
+	tcase_add_test(tc_json_arena, check_json_arena);
+	tcase_set_timeout(tc_json_arena, 300);
+	suite_add_tcase(suite, tc_json_arena);
+
 	return suite;
 }
 
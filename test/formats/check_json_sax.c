@@ -0,0 +1,463 @@
+#include "m_config.h"
+#include <stdlib.h> /* EXIT_SUCCESS, EXIT_FAILURE, srand, rand */
+#include <check.h>
+
+#include <mstdlib/mstdlib.h>
+#include <mstdlib/mstdlib_formats.h>
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+extern Suite *M_json_sax_suite(void);
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* Builds a node tree from events so the result can be compared to M_json_read. */
+typedef struct {
+	M_json_node_t *root;
+	M_json_node_t *cur;
+	char          *key;
+	M_json_sax_t  *sax;
+	size_t         abort_after;
+	size_t         events;
+} builder_t;
+
+static M_json_error_t builder_add(builder_t *b, M_json_node_t *node)
+{
+	b->events++;
+	if (b->abort_after != 0 && b->events >= b->abort_after) {
+		M_json_node_destroy(node);
+		return M_JSON_ERROR_GENERIC;
+	}
+
+	if (b->cur == NULL) {
+		b->root = node;
+	} else if (M_json_node_type(b->cur) == M_JSON_TYPE_OBJECT) {
+		ck_assert_msg(b->key != NULL, "value without key");
+		M_json_object_insert(b->cur, b->key, node);
+		M_free(b->key);
+		b->key = NULL;
+	} else {
+		M_json_array_insert(b->cur, node);
+	}
+
+	if (M_json_node_type(node) == M_JSON_TYPE_OBJECT || M_json_node_type(node) == M_JSON_TYPE_ARRAY)
+		b->cur = node;
+	return M_JSON_ERROR_SUCCESS;
+}
+
+static M_json_error_t builder_object_start(void *thunk)
+{
+	return builder_add(thunk, M_json_node_create(M_JSON_TYPE_OBJECT));
+}
+
+static M_json_error_t builder_array_start(void *thunk)
+{
+	return builder_add(thunk, M_json_node_create(M_JSON_TYPE_ARRAY));
+}
+
+static M_json_error_t builder_end(void *thunk)
+{
+	builder_t *b = thunk;
+
+	b->events++;
+	ck_assert_msg(b->cur != NULL, "end without start");
+	b->cur = M_json_get_parent(b->cur);
+	return M_JSON_ERROR_SUCCESS;
+}
+
+static M_json_error_t builder_key(const char *key, size_t len, void *thunk)
+{
+	builder_t *b = thunk;
+
+	b->events++;
+	ck_assert_msg(M_str_len(key) == len, "key length %zu != %zu", len, M_str_len(key));
+	ck_assert_msg(b->key == NULL, "two keys in a row");
+	b->key = M_strdup(key);
+	return M_JSON_ERROR_SUCCESS;
+}
+
+static M_json_error_t builder_string(const char *val, size_t len, void *thunk)
+{
+	M_json_node_t *node = M_json_node_create(M_JSON_TYPE_STRING);
+
+	ck_assert_msg(M_str_len(val) == len, "string length %zu != %zu", len, M_str_len(val));
+	M_json_set_string(node, val);
+	return builder_add(thunk, node);
+}
+
+static M_json_error_t builder_int(M_int64 val, void *thunk)
+{
+	M_json_node_t *node = M_json_node_create(M_JSON_TYPE_INTEGER);
+
+	M_json_set_int(node, val);
+	return builder_add(thunk, node);
+}
+
+static M_json_error_t builder_decimal(const M_decimal_t *val, void *thunk)
+{
+	M_json_node_t *node = M_json_node_create(M_JSON_TYPE_DECIMAL);
+
+	M_json_set_decimal(node, val);
+	return builder_add(thunk, node);
+}
+
+static M_json_error_t builder_bool(M_bool val, void *thunk)
+{
+	M_json_node_t *node = M_json_node_create(M_JSON_TYPE_BOOL);
+
+	M_json_set_bool(node, val);
+	return builder_add(thunk, node);
+}
+
+static M_json_error_t builder_null(void *thunk)
+{
+	return builder_add(thunk, M_json_node_create(M_JSON_TYPE_NULL));
+}
+
+static M_json_sax_t *builder_create(builder_t *b, M_uint32 flags)
+{
+	struct M_json_sax_callbacks cbs = {
+		builder_object_start,
+		builder_end,
+		builder_array_start,
+		builder_end,
+		builder_key,
+		builder_string,
+		builder_int,
+		builder_decimal,
+		builder_bool,
+		builder_null
+	};
+
+	M_mem_set(b, 0, sizeof(*b));
+	b->sax = M_json_sax_create(&cbs, flags, b);
+	return b->sax;
+}
+
+static void builder_destroy(builder_t *b)
+{
+	M_json_sax_destroy(b->sax);
+	M_json_node_destroy(b->root);
+	M_free(b->key);
+	M_mem_set(b, 0, sizeof(*b));
+}
+
+/* Feed data in chunks of chunk_len. 0 uses random chunk sizes. */
+static M_json_error_t sax_read(builder_t *b, const char *data, size_t len, size_t chunk_len, M_rand_t *rand)
+{
+	M_json_error_t res = M_JSON_ERROR_SUCCESS;
+	size_t         pos = 0;
+	size_t         n;
+
+	while (pos < len && res == M_JSON_ERROR_SUCCESS) {
+		n = chunk_len;
+		if (n == 0)
+			n = (size_t)M_rand_range(rand, 1, 64);
+		if (n > len - pos)
+			n = len - pos;
+		res  = M_json_sax_feed(b->sax, data+pos, n);
+		pos += n;
+	}
+
+	if (res == M_JSON_ERROR_SUCCESS)
+		res = M_json_sax_finish(b->sax);
+	return res;
+}
+
+/* Read with both readers and compare. */
+static void check_compare(const char *data, M_uint32 flags, M_rand_t *rand)
+{
+	static const size_t  chunks[] = { 1, 2, 3, 7, 4096, 0 };
+	builder_t            b;
+	M_json_node_t       *json;
+	M_json_error_t       error;
+	M_json_error_t       res;
+	char                *expected;
+	char                *out;
+	size_t               i;
+
+	json = M_json_read(data, M_str_len(data), flags, NULL, &error, NULL, NULL);
+	ck_assert_msg(json != NULL, "'%s' could not be parsed: %s", data, M_json_errcode_to_str(error));
+	expected = M_json_write(json, M_JSON_WRITER_DONT_ENCODE_UNICODE, NULL);
+	M_json_node_destroy(json);
+
+	for (i=0; i<sizeof(chunks)/sizeof(*chunks); i++) {
+		builder_create(&b, flags);
+		res = sax_read(&b, data, M_str_len(data), chunks[i], rand);
+		ck_assert_msg(res == M_JSON_ERROR_SUCCESS, "'%s' chunk %zu: %s", data, chunks[i], M_json_errcode_to_str(res));
+		ck_assert_msg(M_json_sax_depth(b.sax) == 0, "'%s' chunk %zu: depth %zu", data, chunks[i], M_json_sax_depth(b.sax));
+
+		out = M_json_write(b.root, M_JSON_WRITER_DONT_ENCODE_UNICODE, NULL);
+		ck_assert_msg(M_str_eq(out, expected), "'%s' chunk %zu:\ngot='%s'\nexpected='%s'", data, chunks[i], out, expected);
+		M_free(out);
+		builder_destroy(&b);
+	}
+
+	M_free(expected);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static const char *check_json_sax_valid_data[] = {
+	"{}",
+	"[]",
+	" \n{ \n }\r\n ",
+	"{ \"a\":1 }",
+	"{ \"a\":-1234567890123 }",
+	"{ \"a\":0.5500, \"b\":-2.5e3 }",
+	"{ \"a\":\"\" }",
+	"{ \"a\":\"1\\n2\\t\\\"\\\\\\/\\b\\f\\r\" }",
+	"{ \"a\":true, \"b\":false, \"c\":null }",
+	"[1,2,[3,[4,[5,{\"a\":[6]}]]],{},[],\"x\"]",
+	"[ \"DÂ€™S K\" ]",
+	"[\"D\\u00C2\\u20AC\\u2122S K\"]",
+	"{ \"key with \\\"quotes\\\"\" : { \"nested\" : [ null, true ] } }",
+	"/* c1 */ [ // c2\n 1 /* c3 */, /**/ 2 /***/ ] // c4",
+	"[ 1 ] /* trailing */",
+	"[ 1 ] // trailing",
+	NULL
+};
+
+START_TEST(check_json_sax_valid)
+{
+	M_rand_t *rand = M_rand_create(0);
+	size_t    i;
+
+	for (i=0; check_json_sax_valid_data[i]!=NULL; i++) {
+		check_compare(check_json_sax_valid_data[i], M_JSON_READER_NONE, rand);
+	}
+
+	M_rand_destroy(rand);
+}
+END_TEST
+
+static struct {
+	const char     *data;
+	M_uint32        flags;
+	M_json_error_t  error;
+	size_t          error_line;
+	size_t          error_pos;
+} check_json_sax_invalid_data[] = {
+	{ "",                          M_JSON_READER_NONE,               M_JSON_ERROR_UNEXPECTED_END,          1, 1  },
+	{ "   ",                       M_JSON_READER_NONE,               M_JSON_ERROR_UNEXPECTED_END,          1, 4  },
+	{ "1",                         M_JSON_READER_NONE,               M_JSON_ERROR_INVALID_START,           1, 1  },
+	{ "\"a\"",                     M_JSON_READER_NONE,               M_JSON_ERROR_INVALID_START,           1, 1  },
+	{ "{",                         M_JSON_READER_NONE,               M_JSON_ERROR_UNCLOSED_OBJECT,         1, 2  },
+	{ "[ 1",                       M_JSON_READER_NONE,               M_JSON_ERROR_UNCLOSED_ARRAY,          1, 4  },
+	{ "{ 1",                       M_JSON_READER_NONE,               M_JSON_ERROR_INVALID_PAIR_START,      1, 3  },
+	{ "[ \"a\nb\" ]",              M_JSON_READER_NONE,               M_JSON_ERROR_UNEXPECTED_NEWLINE,      2, 2  },
+	{ "[ \"a\tb\" ]",              M_JSON_READER_NONE,               M_JSON_ERROR_UNEXPECTED_CONTROL_CHAR, 1, 7  },
+	{ "{ \"a\": 1\n\n\n 2: 3 }",   M_JSON_READER_NONE,               M_JSON_ERROR_OBJECT_UNEXPECTED_CHAR,  4, 2  },
+	{ "{ \"a\" 1 }",               M_JSON_READER_NONE,               M_JSON_ERROR_MISSING_PAIR_SEPARATOR,  1, 7  },
+	{ "{ \"a\":  }",               M_JSON_READER_NONE,               M_JSON_ERROR_EXPECTED_VALUE,          1, 9  },
+	{ "{ \"a\": 1, }",             M_JSON_READER_NONE,               M_JSON_ERROR_EXPECTED_VALUE,          1, 11 },
+	{ "[ 1, ]",                    M_JSON_READER_NONE,               M_JSON_ERROR_EXPECTED_VALUE,          1, 6  },
+	{ "[ 1 }",                     M_JSON_READER_NONE,               M_JSON_ERROR_ARRAY_UNEXPECTED_CHAR,   1, 5  },
+	{ "[ 1 2 ]",                   M_JSON_READER_NONE,               M_JSON_ERROR_ARRAY_UNEXPECTED_CHAR,   1, 5  },
+	{ "[ -3[2] ]",                 M_JSON_READER_NONE,               M_JSON_ERROR_ARRAY_UNEXPECTED_CHAR,   1, 5  },
+	{ "{ \"a\": 1 \"b\": 2 }",     M_JSON_READER_NONE,               M_JSON_ERROR_OBJECT_UNEXPECTED_CHAR,  1, 10 },
+	{ "[ 1, 2, 3, { \"a\"",        M_JSON_READER_NONE,               M_JSON_ERROR_UNCLOSED_OBJECT,         1, 17 },
+	{ "[ 1, a ]",                  M_JSON_READER_NONE,               M_JSON_ERROR_INVALID_IDENTIFIER,      1, 6  },
+	{ "[ \"abc",                   M_JSON_READER_NONE,               M_JSON_ERROR_UNCLOSED_STRING,         1, 7  },
+	{ "[ truq ]",                  M_JSON_READER_NONE,               M_JSON_ERROR_INVALID_BOOL,            1, 7  },
+	{ "[ falseq ]",                M_JSON_READER_NONE,               M_JSON_ERROR_INVALID_BOOL,            1, 8  },
+	{ "[ nul ]",                   M_JSON_READER_NONE,               M_JSON_ERROR_INVALID_NULL,            1, 6  },
+	{ "[ 1.2.3 ]",                 M_JSON_READER_NONE,               M_JSON_ERROR_INVALID_NUMBER,          1, 8  },
+	{ "[ 9.999999999999999999999 ]", M_JSON_READER_NONE,             M_JSON_ERROR_INVALID_NUMBER,          1, 26 },
+	{ "[ 1 ] 123",                 M_JSON_READER_NONE,               M_JSON_ERROR_EXPECTED_END,            1, 7  },
+	{ "[ 1 ] [2]",                 M_JSON_READER_NONE,               M_JSON_ERROR_EXPECTED_END,            1, 7  },
+	{ "[ /* ]",                    M_JSON_READER_NONE,               M_JSON_ERROR_MISSING_COMMENT_CLOSE,   1, 7  },
+	{ "[ / ]",                     M_JSON_READER_NONE,               M_JSON_ERROR_UNEXPECTED_COMMENT_START, 1, 4 },
+	{ "[ /*1*/ 2 ]",               M_JSON_READER_DISALLOW_COMMENTS,  M_JSON_ERROR_INVALID_IDENTIFIER,      1, 3  },
+	{ "[ 2 ] // abc",              M_JSON_READER_DISALLOW_COMMENTS,  M_JSON_ERROR_EXPECTED_END,            1, 7  },
+	{ "[ \"\\uAB\" ]",             M_JSON_READER_NONE,               M_JSON_ERROR_INVALID_UNICODE_ESACPE,  1, 8  },
+	{ "[ \"\\uDCBA\" ]",           M_JSON_READER_NONE,               M_JSON_ERROR_INVALID_UNICODE_ESACPE,  1, 10 },
+	{ "[ \"\\q\" ]",               M_JSON_READER_NONE,               M_JSON_ERROR_UNEXPECTED_ESCAPE,       1, 6  },
+	{ "{ \"a\":1, \"a\":2 }",      M_JSON_READER_OBJECT_UNIQUE_KEYS, M_JSON_ERROR_DUPLICATE_KEY,           1, 12 },
+	{ "[ 1, \0 ]",                 M_JSON_READER_NONE,               M_JSON_ERROR_UNEXPECTED_TERMINATION,  1, 6  },
+	{ NULL, 0, M_JSON_ERROR_SUCCESS, 0, 0 }
+};
+
+START_TEST(check_json_sax_invalid)
+{
+	M_rand_t       *rand = M_rand_create(0);
+	builder_t       b;
+	M_json_error_t  res;
+	const char     *data;
+	size_t          len;
+	size_t          line;
+	size_t          pos;
+	size_t          chunk;
+	size_t          i;
+
+	for (i=0; check_json_sax_invalid_data[i].data!=NULL; i++) {
+		data = check_json_sax_invalid_data[i].data;
+		len  = M_str_len(data);
+		/* The embedded NULL case. */
+		if (check_json_sax_invalid_data[i].error == M_JSON_ERROR_UNEXPECTED_TERMINATION)
+			len = 8;
+
+		for (chunk=0; chunk<4; chunk++) {
+			builder_create(&b, check_json_sax_invalid_data[i].flags);
+			res = sax_read(&b, data, len, chunk, rand);
+			ck_assert_msg(res == check_json_sax_invalid_data[i].error, "(%zu) '%s' chunk %zu: got %s, expected %s", i, data, chunk, M_json_errcode_to_str(res), M_json_errcode_to_str(check_json_sax_invalid_data[i].error));
+
+			M_json_sax_position(b.sax, &line, &pos);
+			ck_assert_msg(line == check_json_sax_invalid_data[i].error_line && pos == check_json_sax_invalid_data[i].error_pos, "(%zu) '%s' chunk %zu: error at %zu:%zu, expected %zu:%zu", i, data, chunk, line, pos, check_json_sax_invalid_data[i].error_line, check_json_sax_invalid_data[i].error_pos);
+
+			/* Errors are sticky. */
+			ck_assert_msg(M_json_sax_feed(b.sax, "[]", 2) != M_JSON_ERROR_SUCCESS, "(%zu) feed after error succeeded", i);
+			builder_destroy(&b);
+		}
+	}
+
+	M_rand_destroy(rand);
+}
+END_TEST
+
+START_TEST(check_json_sax_flags)
+{
+	M_rand_t       *rand = M_rand_create(0);
+	builder_t       b;
+	M_json_error_t  res;
+	char           *out;
+
+	check_compare("[ 9.999999999999999999999 ]", M_JSON_READER_ALLOW_DECIMAL_TRUNCATION, rand);
+	check_compare("[ \"\\uABr\" ]", M_JSON_READER_REPLACE_BAD_CHARS, rand);
+	check_compare("[ \"\\uDCBA\" ]", M_JSON_READER_REPLACE_BAD_CHARS, rand);
+	check_compare("[ \"\\uABCD\" ]", M_JSON_READER_DONT_DECODE_UNICODE, rand);
+	check_compare("{ \"a\":1, \"b\":{ \"a\":2 }, \"c\":[{ \"a\":3 }] }", M_JSON_READER_OBJECT_UNIQUE_KEYS, rand);
+
+	/* Control characters are replaced, not kept. */
+	builder_create(&b, M_JSON_READER_REPLACE_BAD_CHARS);
+	res = sax_read(&b, "[ \"a\tb\" ]", 9, 1, rand);
+	ck_assert_msg(res == M_JSON_ERROR_SUCCESS, "replace control char failed: %s", M_json_errcode_to_str(res));
+	out = M_json_write(b.root, M_JSON_WRITER_NONE, NULL);
+	ck_assert_msg(M_str_eq(out, "[\"a?b\"]"), "got '%s', expected '[\"a?b\"]'", out);
+	M_free(out);
+	builder_destroy(&b);
+
+	M_rand_destroy(rand);
+}
+END_TEST
+
+START_TEST(check_json_sax_abort)
+{
+	builder_t      b;
+	M_json_error_t res;
+	const char    *data = "[ 1, 2, 3, 4 ]";
+
+	builder_create(&b, M_JSON_READER_NONE);
+	b.abort_after = 3;
+	res = M_json_sax_feed(b.sax, data, M_str_len(data));
+	ck_assert_msg(res == M_JSON_ERROR_GENERIC, "callback error not returned: %s", M_json_errcode_to_str(res));
+	ck_assert_msg(b.events == 3, "%zu events after abort", b.events);
+	ck_assert_msg(M_json_sax_finish(b.sax) == M_JSON_ERROR_GENERIC, "finish didn't return callback error");
+	M_json_node_destroy(b.root);
+	b.root = NULL;
+
+	/* Reset allows reuse. */
+	M_json_sax_reset(b.sax);
+	b.abort_after = 0;
+	b.cur         = NULL;
+	res = M_json_sax_feed(b.sax, data, M_str_len(data));
+	ck_assert_msg(res == M_JSON_ERROR_SUCCESS, "feed after reset failed: %s", M_json_errcode_to_str(res));
+	ck_assert_msg(M_json_sax_finish(b.sax) == M_JSON_ERROR_SUCCESS, "finish after reset failed");
+	ck_assert_msg(M_json_array_len(b.root) == 4, "array len %zu != 4", M_json_array_len(b.root));
+
+	builder_destroy(&b);
+}
+END_TEST
+
+static M_json_error_t count_object(void *thunk)
+{
+	(*(size_t *)thunk)++;
+	return M_JSON_ERROR_SUCCESS;
+}
+
+/* Stream a large document without ever holding all of it. */
+START_TEST(check_json_sax_large)
+{
+	struct M_json_sax_callbacks  cbs;
+	M_json_sax_t                *sax;
+	M_buf_t                     *buf;
+	M_json_error_t               res;
+	size_t                       objects = 0;
+	size_t                       records = 0;
+	size_t                       i;
+
+	M_mem_set(&cbs, 0, sizeof(cbs));
+	cbs.object_start_func = count_object;
+	sax = M_json_sax_create(&cbs, M_JSON_READER_NONE, &objects);
+
+	res = M_json_sax_feed(sax, "[", 1);
+	buf = M_buf_create();
+	for (i=0; i<200000 && res == M_JSON_ERROR_SUCCESS; i++) {
+		M_buf_truncate(buf, 0);
+		M_bprintf(buf, "%s{ \"id\": %zu, \"name\": \"record \\u00e9 %zu\", \"tags\": [ \"a\", \"b\" ], \"amount\": %zu.25 }\n", i == 0 ? "" : ",", i, i, i);
+		res = M_json_sax_feed(sax, M_buf_peek(buf), M_buf_len(buf));
+		records++;
+	}
+	M_buf_cancel(buf);
+	if (res == M_JSON_ERROR_SUCCESS)
+		res = M_json_sax_feed(sax, "]", 1);
+	if (res == M_JSON_ERROR_SUCCESS)
+		res = M_json_sax_finish(sax);
+
+	ck_assert_msg(res == M_JSON_ERROR_SUCCESS, "large document failed: %s", M_json_errcode_to_str(res));
+	ck_assert_msg(objects == records, "%zu objects, expected %zu", objects, records);
+	M_json_sax_destroy(sax);
+}
+END_TEST
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+Suite *M_json_sax_suite(void)
+{
+	Suite *suite;
+	TCase *tc_json_sax_valid;
+	TCase *tc_json_sax_invalid;
+	TCase *tc_json_sax_flags;
+	TCase *tc_json_sax_abort;
+	TCase *tc_json_sax_large;
+
+	suite = suite_create("json_sax");
+
+	tc_json_sax_valid = tcase_create("check_json_sax_valid");
+	tcase_add_test(tc_json_sax_valid, check_json_sax_valid);
+	suite_add_tcase(suite, tc_json_sax_valid);
+
+	tc_json_sax_invalid = tcase_create("check_json_sax_invalid");
+	tcase_add_test(tc_json_sax_invalid, check_json_sax_invalid);
+	suite_add_tcase(suite, tc_json_sax_invalid);
+
+	tc_json_sax_flags = tcase_create("check_json_sax_flags");
+	tcase_add_test(tc_json_sax_flags, check_json_sax_flags);
+	suite_add_tcase(suite, tc_json_sax_flags);
+
+	tc_json_sax_abort = tcase_create("check_json_sax_abort");
+	tcase_add_test(tc_json_sax_abort, check_json_sax_abort);
+	suite_add_tcase(suite, tc_json_sax_abort);
+
+	tc_json_sax_large = tcase_create("check_json_sax_large");
+	tcase_add_test(tc_json_sax_large, check_json_sax_large);
+	tcase_set_timeout(tc_json_sax_large, 60);
+	suite_add_tcase(suite, tc_json_sax_large);
+
+	return suite;
+}
+
+int main(void)
+{
+	SRunner *sr;
+	int      nf;
+
+	sr = srunner_create(M_json_sax_suite());
+	if (getenv("CK_LOG_FILE_NAME")==NULL) srunner_set_log(sr, "check_json_sax.log");
+
+	srunner_run_all(sr, CK_NORMAL);
+	nf = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	return nf == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
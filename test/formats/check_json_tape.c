@@ -0,0 +1,644 @@
+#include "m_config.h"
+#include <stdlib.h> /* EXIT_SUCCESS, EXIT_FAILURE, srand, rand */
+#include <check.h>
+
+#include <mstdlib/mstdlib.h>
+#include <mstdlib/mstdlib_formats.h>
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+extern Suite *M_json_tape_suite(void);
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define JSONPATH_BOOKS "{"                       \
+"  \"store\": {"                                 \
+"    \"book\": ["                                \
+"      {"                                        \
+"        \"category\": \"reference\","           \
+"        \"author\": \"Nigel Rees\","            \
+"        \"title\": \"Sayings of the Century\"," \
+"        \"price\": 8.95"                        \
+"      },"                                       \
+"      {"                                        \
+"        \"category\": \"fiction\","             \
+"        \"author\": \"Evelyn Waugh\","          \
+"        \"title\": \"Sword of Honour\","        \
+"        \"price\": 12.99"                       \
+"      },"                                       \
+"      {"                                        \
+"        \"category\": \"fiction\","             \
+"        \"author\": \"Herman Melville\","       \
+"        \"title\": \"Moby Dick\","              \
+"        \"isbn\": \"0-553-21311-3\","           \
+"        \"price\": 8.99"                        \
+"      },"                                       \
+"      {"                                        \
+"        \"category\": \"fiction\","             \
+"        \"author\": \"J. R. R. Tolkien\","      \
+"        \"title\": \"The Lord of the Rings\","  \
+"        \"isbn\": \"0-395-19395-8\","           \
+"        \"price\": 22.99"                       \
+"      }"                                        \
+"    ],"                                         \
+"    \"bicycle\": {"                             \
+"      \"color\": \"red\","                      \
+"      \"price\": 19.95"                         \
+"    }"                                          \
+"  }"                                            \
+"}"
+
+static char *node_str(const M_json_node_t *node)
+{
+	if (M_json_node_type(node) == M_JSON_TYPE_OBJECT || M_json_node_type(node) == M_JSON_TYPE_ARRAY)
+		return M_json_write(node, M_JSON_WRITER_DONT_ENCODE_UNICODE|M_JSON_WRITER_REPLACE_BAD_CHARS, NULL);
+	return M_json_get_value_dup(node);
+}
+
+static char *tape_str(M_json_tape_node_t *node)
+{
+	M_json_node_t *json;
+	char          *out;
+
+	json = M_json_tape_to_node(node);
+	out  = node_str(json);
+	M_json_node_destroy(json);
+	return out;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static const char *check_json_tape_valid_data[] = {
+	"{}",
+	"[]",
+	" \n{ \n }\r\n ",
+	"{ \"a\":1 }",
+	"{ \"a\":-1234567890123, \"b\":123456789012345678 }",
+	"{ \"a\":0.5500, \"b\":-2.5e3, \"c\":1E2, \"d\":-0 }",
+	"{ \"a\":\"\" }",
+	"{ \"a\":\"1\\n2\\t\\\"\\\\\\/\\b\\f\\r\" }",
+	"{ \"a\":true, \"b\":false, \"c\":null }",
+	"[1,2,[3,[4,[5,{\"a\":[6]}]]],{},[],\"x\"]",
+	"[ \"DÂ€™S K\" ]",
+	"[\"D\\u00C2\\u20AC\\u2122S K\"]",
+	"{ \"key with \\\"quotes\\\"\" : { \"nested\" : [ null, true ] } }",
+	"/* c1 */ [ // c2\n 1 /* c3 */, /**/ 2 /***/ ] // c4",
+	"[ 1 ] /* trailing */",
+	JSONPATH_BOOKS,
+	NULL
+};
+
+START_TEST(check_json_tape_valid)
+{
+	M_json_tape_t  *tape;
+	M_json_node_t  *json;
+	M_json_error_t  error;
+	char           *expected;
+	char           *out;
+	size_t          i;
+
+	for (i=0; check_json_tape_valid_data[i]!=NULL; i++) {
+		json = M_json_read(check_json_tape_valid_data[i], M_str_len(check_json_tape_valid_data[i]), M_JSON_READER_NONE, NULL, &error, NULL, NULL);
+		ck_assert_msg(json != NULL, "(%zu) could not be parsed: %s", i, M_json_errcode_to_str(error));
+		expected = node_str(json);
+		M_json_node_destroy(json);
+
+		tape = M_json_tape_read(check_json_tape_valid_data[i], M_str_len(check_json_tape_valid_data[i]), M_JSON_READER_NONE, NULL, &error, NULL, NULL);
+		ck_assert_msg(tape != NULL, "(%zu) tape could not be parsed: %s", i, M_json_errcode_to_str(error));
+		out = tape_str(M_json_tape_root(tape));
+		ck_assert_msg(M_str_eq(out, expected), "(%zu) output not as expected:\ngot='%s'\nexpected='%s'", i, out, expected);
+
+		M_free(out);
+		M_free(expected);
+		M_json_tape_destroy(tape);
+	}
+}
+END_TEST
+
+static struct {
+	const char     *data;
+	M_uint32        flags;
+	M_json_error_t  error;
+	size_t          line;
+	size_t          pos;
+} check_json_tape_invalid_data[] = {
+	{ "",                             M_JSON_READER_NONE,                M_JSON_ERROR_MISUSE,                   0, 0  },
+	{ "1",                            M_JSON_READER_NONE,                M_JSON_ERROR_INVALID_START,            1, 1  },
+	{ "\"a\"",                        M_JSON_READER_NONE,                M_JSON_ERROR_INVALID_START,            1, 1  },
+	{ "{",                            M_JSON_READER_NONE,                M_JSON_ERROR_UNCLOSED_OBJECT,          1, 2  },
+	{ "{ 1",                          M_JSON_READER_NONE,                M_JSON_ERROR_INVALID_PAIR_START,       1, 3  },
+	{ "[",                            M_JSON_READER_NONE,                M_JSON_ERROR_UNCLOSED_ARRAY,           1, 2  },
+	{ "[ 1",                          M_JSON_READER_NONE,                M_JSON_ERROR_UNCLOSED_ARRAY,           1, 4  },
+	{ "[ \"a\nb\" ]",                 M_JSON_READER_NONE,                M_JSON_ERROR_UNEXPECTED_NEWLINE,       1, 5  },
+	{ "[ \"a\tb\" ]",                 M_JSON_READER_NONE,                M_JSON_ERROR_UNEXPECTED_CONTROL_CHAR,  1, 5  },
+	{ "{ \"a\": 1\n\n\n 2: 3 }",      M_JSON_READER_NONE,                M_JSON_ERROR_OBJECT_UNEXPECTED_CHAR,   4, 2  },
+	{ "{ \"a\" 1 }",                  M_JSON_READER_NONE,                M_JSON_ERROR_MISSING_PAIR_SEPARATOR,   1, 7  },
+	{ "{ \"a\"}",                     M_JSON_READER_NONE,                M_JSON_ERROR_MISSING_PAIR_SEPARATOR,   1, 6  },
+	{ "{ \"a\": 1, }",                M_JSON_READER_NONE,                M_JSON_ERROR_EXPECTED_VALUE,           1, 11 },
+	{ "{ \"a\": 1, a }",              M_JSON_READER_NONE,                M_JSON_ERROR_INVALID_PAIR_START,       1, 11 },
+	{ "[ 1, ]",                       M_JSON_READER_NONE,                M_JSON_ERROR_EXPECTED_VALUE,           1, 6  },
+	{ "[ 1, a ]",                     M_JSON_READER_NONE,                M_JSON_ERROR_INVALID_IDENTIFIER,       1, 6  },
+	{ "[ 1 }",                        M_JSON_READER_NONE,                M_JSON_ERROR_ARRAY_UNEXPECTED_CHAR,    1, 5  },
+	{ "[ 1 2 ]",                      M_JSON_READER_NONE,                M_JSON_ERROR_ARRAY_UNEXPECTED_CHAR,    1, 5  },
+	{ "[ -3[2] ]",                    M_JSON_READER_NONE,                M_JSON_ERROR_ARRAY_UNEXPECTED_CHAR,    1, 5  },
+	{ "{ \"a\": 1 \"b\": 2 }",        M_JSON_READER_NONE,                M_JSON_ERROR_OBJECT_UNEXPECTED_CHAR,   1, 10 },
+	{ "[ 1, 2, 3, { \"a\"",           M_JSON_READER_NONE,                M_JSON_ERROR_UNCLOSED_OBJECT,          1, 17 },
+	{ "[ \\a ]",                      M_JSON_READER_NONE,                M_JSON_ERROR_INVALID_IDENTIFIER,       1, 3  },
+	{ "[ truq ]",                     M_JSON_READER_NONE,                M_JSON_ERROR_INVALID_BOOL,             1, 3  },
+	{ "[ trueq ]",                    M_JSON_READER_NONE,                M_JSON_ERROR_ARRAY_UNEXPECTED_CHAR,    1, 7  },
+	{ "[ fales]",                     M_JSON_READER_NONE,                M_JSON_ERROR_INVALID_BOOL,             1, 3  },
+	{ "[ nul]",                       M_JSON_READER_NONE,                M_JSON_ERROR_INVALID_NULL,             1, 3  },
+	{ "[ 1.2.3 ]",                    M_JSON_READER_NONE,                M_JSON_ERROR_ARRAY_UNEXPECTED_CHAR,    1, 6  },
+	{ "[ 1. ]",                       M_JSON_READER_NONE,                M_JSON_ERROR_INVALID_NUMBER,           1, 3  },
+	{ "[ 1.]",                        M_JSON_READER_NONE,                M_JSON_ERROR_INVALID_NUMBER,           1, 3  },
+	{ "[ 99999999999999999999999 ]",  M_JSON_READER_NONE,                M_JSON_ERROR_INVALID_NUMBER,           1, 3  },
+	{ "[ 9.999999999999999999999 ]",  M_JSON_READER_NONE,                M_JSON_ERROR_INVALID_NUMBER,           1, 3  },
+	{ "[ /* ]",                       M_JSON_READER_NONE,                M_JSON_ERROR_MISSING_COMMENT_CLOSE,    1, 6  },
+	{ "[ 1 ] 123",                    M_JSON_READER_NONE,                M_JSON_ERROR_EXPECTED_END,             1, 7  },
+	{ "[ \"\\uAB\" ]",                M_JSON_READER_NONE,                M_JSON_ERROR_INVALID_UNICODE_ESACPE,   1, 4  },
+	{ "[ \"\\uDCBA\" ]",              M_JSON_READER_NONE,                M_JSON_ERROR_INVALID_UNICODE_ESACPE,   1, 4  },
+	{ "[ \"\\q\" ]",                  M_JSON_READER_NONE,                M_JSON_ERROR_UNEXPECTED_ESCAPE,        1, 4  },
+	{ "[ \"abc ]",                    M_JSON_READER_NONE,                M_JSON_ERROR_UNCLOSED_STRING,          1, 9  },
+	{ "[ /*1*/ 2 ]",                  M_JSON_READER_DISALLOW_COMMENTS,   M_JSON_ERROR_INVALID_IDENTIFIER,       1, 3  },
+	{ "{ \"a\":1, \"a\":2 }",         M_JSON_READER_OBJECT_UNIQUE_KEYS,  M_JSON_ERROR_DUPLICATE_KEY,            1, 12 },
+	{ "{ \"\\u0061\":1, \"a\":2 }",   M_JSON_READER_OBJECT_UNIQUE_KEYS,  M_JSON_ERROR_DUPLICATE_KEY,            1, 17 },
+	{ "{ \"a\\nb\":1, \"a\\nb\":2 }", M_JSON_READER_OBJECT_UNIQUE_KEYS,  M_JSON_ERROR_DUPLICATE_KEY,            1, 18 },
+	{ NULL, 0, M_JSON_ERROR_SUCCESS, 0, 0 }
+};
+
+START_TEST(check_json_tape_invalid)
+{
+	M_json_tape_t  *tape;
+	M_json_error_t  error;
+	size_t          line;
+	size_t          pos;
+	size_t          i;
+
+	for (i=0; check_json_tape_invalid_data[i].data!=NULL; i++) {
+		tape = M_json_tape_read(check_json_tape_invalid_data[i].data, M_str_len(check_json_tape_invalid_data[i].data), check_json_tape_invalid_data[i].flags, NULL, &error, &line, &pos);
+		ck_assert_msg(tape == NULL, "(%zu) '%s': invalid JSON was parsed", i, check_json_tape_invalid_data[i].data);
+		ck_assert_msg(error == check_json_tape_invalid_data[i].error, "(%zu) '%s': got %s, expected %s", i, check_json_tape_invalid_data[i].data, M_json_errcode_to_str(error), M_json_errcode_to_str(check_json_tape_invalid_data[i].error));
+		ck_assert_msg(line == check_json_tape_invalid_data[i].line && pos == check_json_tape_invalid_data[i].pos, "(%zu) '%s': error at %zu:%zu, expected %zu:%zu", i, check_json_tape_invalid_data[i].data, line, pos, check_json_tape_invalid_data[i].line, check_json_tape_invalid_data[i].pos);
+	}
+}
+END_TEST
+
+START_TEST(check_json_tape_flags)
+{
+	static const struct {
+		const char *data;
+		M_uint32    flags;
+	} data[] = {
+		{ "[ 9.999999999999999999999 ]",                      M_JSON_READER_ALLOW_DECIMAL_TRUNCATION },
+		{ "[ \"\\uABr\" ]",                                   M_JSON_READER_REPLACE_BAD_CHARS        },
+		{ "[ \"\\uDCBA\" ]",                                  M_JSON_READER_REPLACE_BAD_CHARS        },
+		{ "[ \"\\uABCD\" ]",                                  M_JSON_READER_DONT_DECODE_UNICODE      },
+		{ "{ \"a\":1, \"b\":{ \"a\":2 }, \"c\":[{ \"a\":3 }] }", M_JSON_READER_OBJECT_UNIQUE_KEYS      },
+		{ NULL, 0 }
+	};
+	M_json_tape_t  *tape;
+	M_json_node_t  *json;
+	char           *expected;
+	char           *out;
+	size_t          i;
+
+	for (i=0; data[i].data!=NULL; i++) {
+		json     = M_json_read(data[i].data, M_str_len(data[i].data), data[i].flags, NULL, NULL, NULL, NULL);
+		expected = node_str(json);
+		M_json_node_destroy(json);
+
+		tape = M_json_tape_read(data[i].data, M_str_len(data[i].data), data[i].flags, NULL, NULL, NULL, NULL);
+		ck_assert_msg(tape != NULL, "(%zu) could not be parsed", i);
+		out = tape_str(M_json_tape_root(tape));
+		ck_assert_msg(M_str_eq(out, expected), "(%zu) output not as expected:\ngot='%s'\nexpected='%s'", i, out, expected);
+
+		M_free(out);
+		M_free(expected);
+		M_json_tape_destroy(tape);
+	}
+}
+END_TEST
+
+START_TEST(check_json_tape_getters)
+{
+	const char          *data = "{ \"s\":\"a\\tb\", \"i\":42, \"d\":1.50, \"b\":true, \"n\":null, \"k\\u00e9y\":\"v\", \"arr\":[ \"x\", 7, 2.25, false, [1], {} ] } ";
+	M_json_tape_t       *tape;
+	M_json_tape_node_t  *root;
+	M_json_tape_node_t  *arr;
+	M_list_str_t        *keys;
+	char                 buf[32];
+	char                *str;
+	size_t               processed;
+	size_t               i;
+
+	tape = M_json_tape_read(data, M_str_len(data), M_JSON_READER_NONE, &processed, NULL, NULL, NULL);
+	ck_assert_msg(tape != NULL, "could not be parsed");
+	ck_assert_msg(processed == M_str_len(data), "processed %zu != %zu", processed, M_str_len(data));
+	root = M_json_tape_root(tape);
+
+	ck_assert_msg(M_json_tape_node_type(root) == M_JSON_TYPE_OBJECT, "root not an object");
+	ck_assert_msg(M_json_tape_object_num_children(root) == 7, "children %zu != 7", M_json_tape_object_num_children(root));
+	ck_assert_msg(M_json_tape_num_nodes(tape) == 22, "nodes %zu != 22", M_json_tape_num_nodes(tape));
+
+	/* Out of order lookups wrap around. */
+	ck_assert_msg(M_json_tape_object_value_int(root, "i") == 42, "i wrong");
+	ck_assert_msg(M_str_eq(M_json_tape_object_value_string(root, "s"), "a\tb"), "s wrong");
+	ck_assert_msg(M_json_tape_object_value_bool(root, "b"), "b wrong");
+	ck_assert_msg(M_json_tape_node_type(M_json_tape_object_value(root, "n")) == M_JSON_TYPE_NULL, "n wrong");
+	ck_assert_msg(M_str_eq(M_json_tape_object_value_string(root, "k\xC3\xA9y"), "v"), "escaped key not found");
+	ck_assert_msg(M_json_tape_object_value(root, "missing") == NULL, "missing key found");
+	ck_assert_msg(M_json_tape_object_value(root, "I") == NULL, "keys are case sensitive");
+	ck_assert_msg(M_json_tape_object_value_decimal(root, "d") != NULL, "d wrong");
+	ck_assert_msg(M_json_tape_get_value(M_json_tape_object_value(root, "d"), buf, sizeof(buf)) && M_str_eq(buf, "1.5"), "d value '%s'", buf);
+	ck_assert_msg(M_json_tape_object_value_int(root, "d") == 2, "d as int wrong");
+
+	keys = M_json_tape_object_keys(root);
+	ck_assert_msg(M_list_str_len(keys) == 7 && M_str_eq(M_list_str_at(keys, 5), "k\xC3\xA9y"), "keys wrong");
+	M_list_str_destroy(keys);
+
+	arr = M_json_tape_object_value(root, "arr");
+	ck_assert_msg(M_json_tape_array_len(arr) == 6, "array len %zu != 6", M_json_tape_array_len(arr));
+	ck_assert_msg(M_json_tape_get_int(arr) == 6, "array as int wrong");
+	/* Backwards then forwards. */
+	for (i=6; i-->0; ) {
+		ck_assert_msg(M_json_tape_array_at(arr, i) != NULL, "array_at %zu NULL", i);
+	}
+	ck_assert_msg(M_str_eq(M_json_tape_array_at_string(arr, 0), "x"), "arr[0] wrong");
+	ck_assert_msg(M_json_tape_array_at_int(arr, 1) == 7, "arr[1] wrong");
+	ck_assert_msg(M_json_tape_array_at_decimal(arr, 2) != NULL, "arr[2] wrong");
+	ck_assert_msg(!M_json_tape_array_at_bool(arr, 3), "arr[3] wrong");
+	ck_assert_msg(M_json_tape_array_len(M_json_tape_array_at(arr, 4)) == 1, "arr[4] wrong");
+	ck_assert_msg(M_json_tape_node_type(M_json_tape_array_at(arr, 5)) == M_JSON_TYPE_OBJECT, "arr[5] wrong");
+	ck_assert_msg(M_json_tape_array_at(arr, 6) == NULL, "arr[6] not NULL");
+	ck_assert_msg(M_json_tape_array_at(root, 0) == NULL, "array_at on object");
+
+	str = M_json_tape_get_value_dup(M_json_tape_array_at(arr, 3));
+	ck_assert_msg(M_str_eq(str, "false"), "value dup '%s'", str);
+	M_free(str);
+	ck_assert_msg(M_json_tape_get_value_dup(arr) == NULL, "value dup of array");
+
+	M_json_tape_destroy(tape);
+}
+END_TEST
+
+START_TEST(check_json_tape_jsonpath)
+{
+	static const char *searches[] = {
+		"$.store.book[*].author",
+		"$.store.book[1].author",
+		"$.store.book[0,2,3].author",
+		"$.store.book[1:3].author",
+		"$.store.book[1:3:4].author",
+		"$.store.book[0::2].author",
+		"$.store.book[-1].title",
+		"$.store.book[4:0:-1].title",
+		"$..author",
+		"$.store..price",
+		"$.store.*",
+		"$..*",
+		"$.store.book",
+		"$..book",
+		"$..book[2]",
+		"$.STORE.bicycle.color",
+		"$.store.bicycle[0]",
+		"$.cake",
+		"store",
+		NULL
+	};
+	M_json_node_t       *json;
+	M_json_node_t      **results;
+	M_json_tape_t       *tape;
+	M_json_tape_node_t **tape_results;
+	size_t               num_matches;
+	size_t               tape_num_matches;
+	char                *expected;
+	char                *out;
+	size_t               i;
+	size_t               j;
+
+	json = M_json_read(JSONPATH_BOOKS, M_str_len(JSONPATH_BOOKS), M_JSON_READER_NONE, NULL, NULL, NULL, NULL);
+	tape = M_json_tape_read(JSONPATH_BOOKS, M_str_len(JSONPATH_BOOKS), M_JSON_READER_NONE, NULL, NULL, NULL, NULL);
+	ck_assert_msg(json != NULL && tape != NULL, "could not be parsed");
+
+	for (i=0; searches[i]!=NULL; i++) {
+		results      = M_json_jsonpath(json, searches[i], &num_matches);
+		tape_results = M_json_tape_jsonpath(M_json_tape_root(tape), searches[i], &tape_num_matches);
+		ck_assert_msg(num_matches == tape_num_matches, "'%s': got %zu matches, expected %zu", searches[i], tape_num_matches, num_matches);
+
+		for (j=0; j<num_matches; j++) {
+			expected = node_str(results[j]);
+			out      = tape_str(tape_results[j]);
+			ck_assert_msg(M_str_eq(out, expected), "'%s' match %zu:\ngot='%s'\nexpected='%s'", searches[i], j, out, expected);
+			M_free(out);
+			M_free(expected);
+		}
+
+		M_free(results);
+		M_free(tape_results);
+	}
+
+	M_json_tape_destroy(tape);
+	M_json_node_destroy(json);
+}
+END_TEST
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static void gen_space(M_buf_t *buf, M_rand_t *r)
+{
+	static const char space[] = { ' ', ' ', ' ', '\n', '\t', '\r' };
+	size_t            n       = (size_t)M_rand_max(r, 4) == 0 ? (size_t)M_rand_max(r, 70) : (size_t)M_rand_max(r, 2);
+
+	while (n-- > 0)
+		M_buf_add_byte(buf, (unsigned char)space[M_rand_max(r, sizeof(space))]);
+}
+
+/* Strings with runs of backslashes and escaped quotes that land on every
+ * offset within a block. */
+static void gen_string(M_buf_t *buf, M_rand_t *r)
+{
+	static const char *parts[] = { "a", "bcdefgh", "\\\"", "\\\\", "\\\\\\\"", "\\\\\\\\", "\\n", "\\u00e9", "\xC3\xA9", "/", "{[,:]}", "                                " };
+	size_t             n       = (size_t)M_rand_max(r, 12);
+
+	M_buf_add_byte(buf, '"');
+	while (n-- > 0)
+		M_buf_add_str(buf, parts[M_rand_max(r, sizeof(parts)/sizeof(*parts))]);
+	M_buf_add_byte(buf, '"');
+}
+
+static void gen_value(M_buf_t *buf, M_rand_t *r, size_t depth)
+{
+	size_t n;
+	size_t i;
+
+	switch (depth == 0 ? 0 : depth >= 6 ? 2 + M_rand_max(r, 6) : M_rand_max(r, 8)) {
+		case 0:
+		case 1:
+			n = (size_t)M_rand_max(r, 6);
+			M_buf_add_byte(buf, depth & 1 ? '[' : '{');
+			for (i=0; i<n; i++) {
+				if (i != 0)
+					M_buf_add_byte(buf, ',');
+				gen_space(buf, r);
+				if (!(depth & 1)) {
+					M_bprintf(buf, "\"k%zu\"", i);
+					gen_space(buf, r);
+					M_buf_add_byte(buf, ':');
+					gen_space(buf, r);
+				}
+				gen_value(buf, r, depth+1);
+				gen_space(buf, r);
+			}
+			M_buf_add_byte(buf, depth & 1 ? ']' : '}');
+			break;
+		case 2:
+		case 3:
+			gen_string(buf, r);
+			break;
+		case 4:
+			M_bprintf(buf, "%lld", (long long)M_rand_range(r, 0, 2000000) - 1000000);
+			break;
+		case 5:
+			M_bprintf(buf, "%lld.%llu", (long long)M_rand_range(r, 0, 2000) - 1000, M_rand_max(r, 1000));
+			break;
+		case 6:
+			M_buf_add_str(buf, M_rand_max(r, 2) ? "true" : "false");
+			break;
+		default:
+			M_buf_add_str(buf, "null");
+			break;
+	}
+}
+
+/* Documents parsed with the structural index have to give the same result as
+ * the byte at a time parser. A leading comment stops the index so the second
+ * parse always uses the latter. */
+START_TEST(check_json_tape_index)
+{
+	static const char  mutations[] = "\"\\,:[]{}/ \nax1\x01";
+	M_rand_t          *r;
+	M_buf_t           *buf;
+	M_json_tape_t     *tape;
+	M_json_tape_t     *tape_bytes;
+	M_json_node_t     *json;
+	M_json_error_t     error;
+	M_json_error_t     error_bytes;
+	M_uint32           flags;
+	size_t             line;
+	size_t             line_bytes;
+	size_t             pos;
+	size_t             pos_bytes;
+	char              *doc;
+	char              *doc_bytes;
+	char              *expected;
+	char              *out;
+	size_t             len;
+	size_t             i;
+	size_t             j;
+
+	r = M_rand_create(1);
+
+	for (i=0; i<2000; i++) {
+		buf = M_buf_create();
+		gen_space(buf, r);
+		gen_value(buf, r, 0);
+		gen_space(buf, r);
+		doc   = M_buf_finish_str(buf, &len);
+		flags = i & 1 ? M_JSON_READER_OBJECT_UNIQUE_KEYS : M_JSON_READER_NONE;
+
+		json = M_json_read(doc, len, flags, NULL, &error, NULL, NULL);
+		ck_assert_msg(json != NULL, "(%zu) could not be parsed: %s\n%s", i, M_json_errcode_to_str(error), doc);
+		expected = node_str(json);
+		M_json_node_destroy(json);
+
+		tape = M_json_tape_read(doc, len, flags, NULL, &error, NULL, NULL);
+		ck_assert_msg(tape != NULL, "(%zu) tape could not be parsed: %s\n%s", i, M_json_errcode_to_str(error), doc);
+		out = tape_str(M_json_tape_root(tape));
+		ck_assert_msg(M_str_eq(out, expected), "(%zu) output not as expected:\ngot='%s'\nexpected='%s'", i, out, expected);
+		M_free(out);
+		M_free(expected);
+		M_json_tape_destroy(tape);
+
+		/* Break the document in a few places. */
+		for (j=0; j<4; j++) {
+			doc[M_rand_max(r, len)] = mutations[M_rand_max(r, sizeof(mutations)-1)];
+			M_asprintf(&doc_bytes, "/**/\n%s", doc);
+
+			tape       = M_json_tape_read(doc, len, flags, NULL, &error, &line, &pos);
+			tape_bytes = M_json_tape_read(doc_bytes, len+5, flags, NULL, &error_bytes, &line_bytes, &pos_bytes);
+			ck_assert_msg(error == error_bytes, "(%zu, %zu) got %s, expected %s\n%s", i, j, M_json_errcode_to_str(error), M_json_errcode_to_str(error_bytes), doc);
+			if (tape == NULL) {
+				ck_assert_msg(line+1 == line_bytes && pos == pos_bytes, "(%zu, %zu) error at %zu:%zu, expected %zu:%zu", i, j, line, pos, line_bytes-1, pos_bytes);
+			} else {
+				expected = tape_str(M_json_tape_root(tape_bytes));
+				out      = tape_str(M_json_tape_root(tape));
+				ck_assert_msg(M_str_eq(out, expected), "(%zu, %zu) output not as expected:\ngot='%s'\nexpected='%s'", i, j, out, expected);
+				M_free(out);
+				M_free(expected);
+			}
+
+			M_json_tape_destroy(tape_bytes);
+			M_json_tape_destroy(tape);
+			M_free(doc_bytes);
+		}
+
+		M_free(doc);
+	}
+
+	M_rand_destroy(r);
+}
+END_TEST
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define BENCH_RECORDS 100000
+
+static char *bench_doc(size_t *len)
+{
+	M_buf_t *buf = M_buf_create();
+	size_t   i;
+
+	M_buf_add_str(buf, "{ \"records\": [\n");
+	for (i=0; i<BENCH_RECORDS; i++) {
+		M_bprintf(buf, "%s  { \"id\": %zu, \"name\": \"customer %zu\", \"email\": \"user%zu@example.com\", \"note\": \"line one\\nline \\\"two\\\"\", \"balance\": %zu.%02zu, \"active\": %s, \"tags\": [ \"a\", \"b\", \"c\" ], \"parent\": null }\n",
+			i == 0 ? "" : ",", i, i, i, i * 7, i % 100, i % 3 == 0 ? "true" : "false");
+	}
+	M_buf_add_str(buf, "] }");
+
+	return M_buf_finish_str(buf, len);
+}
+
+START_TEST(check_json_tape_bench)
+{
+	M_timeval_t          tv;
+	M_arena_t           *arena;
+	M_json_node_t       *json;
+	M_json_node_t       *records;
+	M_json_tape_t       *tape;
+	M_json_tape_node_t  *tape_records;
+	char                *doc;
+	size_t               len;
+	size_t               i;
+	M_int64              sum;
+	M_int64              tape_sum;
+	M_uint64             ms;
+
+	doc = bench_doc(&len);
+	M_printf("json tape: %zu bytes, %d records\n", len, BENCH_RECORDS);
+
+	M_time_elapsed_start(&tv);
+	json = M_json_read(doc, len, M_JSON_READER_NONE, NULL, NULL, NULL, NULL);
+	ms   = M_time_elapsed(&tv);
+	ck_assert_msg(json != NULL, "M_json_read failed");
+	M_printf("  M_json_read       %6llu ms (%.1f MB/s)\n", ms, (double)len / 1048576.0 / ((double)(ms == 0 ? 1 : ms) / 1000.0));
+
+	records = M_json_object_value(json, "records");
+	sum     = 0;
+	M_time_elapsed_start(&tv);
+	for (i=0; i<M_json_array_len(records); i++) {
+		sum += M_json_object_value_int(M_json_array_at(records, i), "id");
+		sum += (M_int64)M_str_len(M_json_object_value_string(M_json_array_at(records, i), "note"));
+	}
+	ms = M_time_elapsed(&tv);
+	M_printf("    access          %6llu ms\n", ms);
+
+	M_time_elapsed_start(&tv);
+	M_json_node_destroy(json);
+	ms = M_time_elapsed(&tv);
+	M_printf("    destroy         %6llu ms\n", ms);
+
+	arena = M_arena_create(64 * 1024);
+	M_time_elapsed_start(&tv);
+	json = M_json_read_arena(arena, doc, len, M_JSON_READER_NONE, NULL, NULL, NULL, NULL);
+	M_json_node_destroy(json);
+	ms   = M_time_elapsed(&tv);
+	M_printf("  M_json_read_arena %6llu ms (read + destroy)\n", ms);
+	M_arena_destroy(arena);
+
+	M_time_elapsed_start(&tv);
+	tape = M_json_tape_read(doc, len, M_JSON_READER_NONE, NULL, NULL, NULL, NULL);
+	ms   = M_time_elapsed(&tv);
+	ck_assert_msg(tape != NULL, "M_json_tape_read failed");
+	M_printf("  M_json_tape_read  %6llu ms (%.1f MB/s), %zu nodes\n", ms, (double)len / 1048576.0 / ((double)(ms == 0 ? 1 : ms) / 1000.0), M_json_tape_num_nodes(tape));
+
+	tape_records = M_json_tape_object_value(M_json_tape_root(tape), "records");
+	tape_sum     = 0;
+	M_time_elapsed_start(&tv);
+	for (i=0; i<M_json_tape_array_len(tape_records); i++) {
+		tape_sum += M_json_tape_object_value_int(M_json_tape_array_at(tape_records, i), "id");
+		tape_sum += (M_int64)M_str_len(M_json_tape_object_value_string(M_json_tape_array_at(tape_records, i), "note"));
+	}
+	ms = M_time_elapsed(&tv);
+	M_printf("    access          %6llu ms\n", ms);
+	ck_assert_msg(sum == tape_sum, "sum %lld != %lld", tape_sum, sum);
+
+	M_time_elapsed_start(&tv);
+	M_json_tape_destroy(tape);
+	ms = M_time_elapsed(&tv);
+	M_printf("    destroy         %6llu ms\n", ms);
+
+	M_free(doc);
+}
+END_TEST
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+Suite *M_json_tape_suite(void)
+{
+	Suite *suite;
+	TCase *tc_json_tape_valid;
+	TCase *tc_json_tape_invalid;
+	TCase *tc_json_tape_flags;
+	TCase *tc_json_tape_getters;
+	TCase *tc_json_tape_jsonpath;
+	TCase *tc_json_tape_index;
+	TCase *tc_json_tape_bench;
+
+	suite = suite_create("json_tape");
+
+	tc_json_tape_valid = tcase_create("check_json_tape_valid");
+	tcase_add_test(tc_json_tape_valid, check_json_tape_valid);
+	suite_add_tcase(suite, tc_json_tape_valid);
+
+	tc_json_tape_invalid = tcase_create("check_json_tape_invalid");
+	tcase_add_test(tc_json_tape_invalid, check_json_tape_invalid);
+	suite_add_tcase(suite, tc_json_tape_invalid);
+
+	tc_json_tape_flags = tcase_create("check_json_tape_flags");
+	tcase_add_test(tc_json_tape_flags, check_json_tape_flags);
+	suite_add_tcase(suite, tc_json_tape_flags);
+
+	tc_json_tape_getters = tcase_create("check_json_tape_getters");
+	tcase_add_test(tc_json_tape_getters, check_json_tape_getters);
+	suite_add_tcase(suite, tc_json_tape_getters);
+
+	tc_json_tape_jsonpath = tcase_create("check_json_tape_jsonpath");
+	tcase_add_test(tc_json_tape_jsonpath, check_json_tape_jsonpath);
+	suite_add_tcase(suite, tc_json_tape_jsonpath);
+
+	tc_json_tape_index = tcase_create("check_json_tape_index");
+	tcase_add_test(tc_json_tape_index, check_json_tape_index);
+	suite_add_tcase(suite, tc_json_tape_index);
+
+	tc_json_tape_bench = tcase_create("check_json_tape_bench");
+	tcase_add_test(tc_json_tape_bench, check_json_tape_bench);
+	tcase_set_timeout(tc_json_tape_bench, 60);
+	suite_add_tcase(suite, tc_json_tape_bench);
+
+	return suite;
+}
+
+int main(void)
+{
+	SRunner *sr;
+	int      nf;
+
+	sr = srunner_create(M_json_tape_suite());
+	if (getenv("CK_LOG_FILE_NAME")==NULL) srunner_set_log(sr, "check_json_tape.log");
+
+	srunner_run_all(sr, CK_NORMAL);
+	nf = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	return nf == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,413 @@
+#include "m_config.h"
+#include <stdlib.h> /* EXIT_SUCCESS, EXIT_FAILURE, srand, rand */
+#include <check.h>
+
+#include <mstdlib/mstdlib.h>
+#include <mstdlib/mstdlib_formats.h>
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+extern Suite *M_json_writer_suite(void);
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static const char *docs[] = {
+	"{}",
+	"[]",
+	"{ \"a\": [] }",
+	"{ \"a\": {}, \"b\": [ {}, [] ] }",
+	"[ 1, 2.5, -3, true, false, null, \"x\\ty\\\"z\\/\\u0001\" ]",
+	"{ \"big\": 9007199254740993, \"small\": -9007199254740993, \"dec\": 1.1234567890123456789 }",
+	"{ \"utf8\": \"h\xc3\xa9llo \xe2\x82\xac\", \"nested\": { \"a\": { \"b\": [ [ [ 1 ] ], { \"c\": null } ] } } }",
+	"[ { \"id\": 1, \"name\": \"one\" }, { \"id\": 2, \"name\": \"two\" }, { \"id\": 3, \"name\": \"three\" } ]",
+	NULL
+};
+
+static const M_uint32 write_flags[] = {
+	M_JSON_WRITER_NONE,
+	M_JSON_WRITER_PRETTYPRINT_SPACE,
+	M_JSON_WRITER_PRETTYPRINT_TAB|M_JSON_WRITER_PRETTYPRINT_WINLINEEND,
+	M_JSON_WRITER_PRETTYPRINT_SPACE|M_JSON_WRITER_DONT_ENCODE_UNICODE|M_JSON_WRITER_NUMBER_NOCOMPAT
+};
+
+/* Write a tree one element at a time. */
+static void write_events(M_json_writer_t *w, const M_json_node_t *node)
+{
+	M_list_str_t *keys;
+	size_t        len;
+	size_t        i;
+
+	switch (M_json_node_type(node)) {
+		case M_JSON_TYPE_OBJECT:
+			ck_assert_msg(M_json_writer_object_begin(w), "object begin failed");
+			keys = M_json_object_keys(node);
+			len  = M_list_str_len(keys);
+			for (i=0; i<len; i++) {
+				ck_assert_msg(M_json_writer_key(w, M_list_str_at(keys, i)), "key failed");
+				write_events(w, M_json_object_value(node, M_list_str_at(keys, i)));
+			}
+			M_list_str_destroy(keys);
+			ck_assert_msg(M_json_writer_object_end(w), "object end failed");
+			break;
+		case M_JSON_TYPE_ARRAY:
+			ck_assert_msg(M_json_writer_array_begin(w), "array begin failed");
+			len = M_json_array_len(node);
+			for (i=0; i<len; i++) {
+				write_events(w, M_json_array_at(node, i));
+			}
+			ck_assert_msg(M_json_writer_array_end(w), "array end failed");
+			break;
+		case M_JSON_TYPE_STRING:
+			ck_assert_msg(M_json_writer_value_string(w, M_json_get_string(node)), "string failed");
+			break;
+		case M_JSON_TYPE_INTEGER:
+			ck_assert_msg(M_json_writer_value_int(w, M_json_get_int(node)), "int failed");
+			break;
+		case M_JSON_TYPE_DECIMAL:
+			ck_assert_msg(M_json_writer_value_decimal(w, M_json_get_decimal(node)), "decimal failed");
+			break;
+		case M_JSON_TYPE_BOOL:
+			ck_assert_msg(M_json_writer_value_bool(w, M_json_get_bool(node)), "bool failed");
+			break;
+		case M_JSON_TYPE_NULL:
+			ck_assert_msg(M_json_writer_value_null(w), "null failed");
+			break;
+		default:
+			ck_abort_msg("unknown node type");
+	}
+}
+
+typedef struct {
+	M_buf_t *buf;
+	size_t   flushes;
+	size_t   max_len;
+	size_t   fail_after;
+} sink_t;
+
+static M_bool sink_flush(const unsigned char *data, size_t len, void *thunk)
+{
+	sink_t *sink = thunk;
+
+	sink->flushes++;
+	if (sink->fail_after != 0 && sink->flushes >= sink->fail_after)
+		return M_FALSE;
+
+	if (len > sink->max_len)
+		sink->max_len = len;
+	M_buf_add_bytes(sink->buf, data, len);
+	return M_TRUE;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+START_TEST(check_json_writer_tree)
+{
+	M_json_node_t   *node;
+	M_json_writer_t *w;
+	M_buf_t         *buf;
+	char            *expected;
+	size_t           i;
+	size_t           j;
+
+	for (i=0; docs[i]!=NULL; i++) {
+		node = M_json_read(docs[i], M_str_len(docs[i]), M_JSON_READER_NONE, NULL, NULL, NULL, NULL);
+		ck_assert_msg(node != NULL, "%zu: could not parse", i);
+
+		for (j=0; j<sizeof(write_flags)/sizeof(*write_flags); j++) {
+			expected = M_json_write(node, write_flags[j], NULL);
+			ck_assert_msg(expected != NULL, "%zu: M_json_write failed", i);
+
+			/* Element at a time. */
+			buf = M_buf_create();
+			w   = M_json_writer_create(buf, write_flags[j]);
+			write_events(w, node);
+			ck_assert_msg(M_json_writer_depth(w) == 0, "%zu: depth %zu != 0", i, M_json_writer_depth(w));
+			ck_assert_msg(M_json_writer_finish(w), "%zu: finish failed", i);
+			M_json_writer_destroy(w);
+			ck_assert_msg(M_str_eq(M_buf_peek(buf), expected), "%zu/%zu: got\n%s\nexpected\n%s", i, j, M_buf_peek(buf), expected);
+
+			/* Whole tree as one value. */
+			M_buf_truncate(buf, 0);
+			w = M_json_writer_create(buf, write_flags[j]);
+			ck_assert_msg(M_json_writer_value_node(w, node), "%zu: value_node failed", i);
+			ck_assert_msg(M_json_writer_finish(w), "%zu: finish failed", i);
+			M_json_writer_destroy(w);
+			ck_assert_msg(M_str_eq(M_buf_peek(buf), expected), "%zu/%zu: node got\n%s\nexpected\n%s", i, j, M_buf_peek(buf), expected);
+
+			M_buf_cancel(buf);
+			M_free(expected);
+		}
+
+		M_json_node_destroy(node);
+	}
+}
+END_TEST
+
+START_TEST(check_json_writer_nested_node)
+{
+	M_json_node_t   *node;
+	M_json_writer_t *w;
+	M_buf_t         *buf;
+	const char      *s = "{ \"a\": [ 1, { \"b\": 2 } ] }";
+	char            *expected;
+	char            *wrapped;
+
+	node = M_json_read(s, M_str_len(s), M_JSON_READER_NONE, NULL, NULL, NULL, NULL);
+
+	/* A tree written part way into a document is indented to match. */
+	buf = M_buf_create();
+	w   = M_json_writer_create(buf, M_JSON_WRITER_PRETTYPRINT_SPACE);
+	ck_assert_msg(M_json_writer_array_begin(w), "array begin failed");
+	ck_assert_msg(M_json_writer_object_begin(w), "object begin failed");
+	ck_assert_msg(M_json_writer_key(w, "x"), "key failed");
+	ck_assert_msg(M_json_writer_value_node(w, node), "value_node failed");
+	ck_assert_msg(M_json_writer_object_end(w), "object end failed");
+	ck_assert_msg(M_json_writer_array_end(w), "array end failed");
+	ck_assert_msg(M_json_writer_finish(w), "finish failed");
+	M_json_writer_destroy(w);
+
+	M_asprintf(&wrapped, "[ { \"x\": %s } ]", s);
+	M_json_node_destroy(node);
+	node     = M_json_read(wrapped, M_str_len(wrapped), M_JSON_READER_NONE, NULL, NULL, NULL, NULL);
+	expected = M_json_write(node, M_JSON_WRITER_PRETTYPRINT_SPACE, NULL);
+	ck_assert_msg(M_str_eq(M_buf_peek(buf), expected), "got\n%s\nexpected\n%s", M_buf_peek(buf), expected);
+
+	M_free(expected);
+	M_free(wrapped);
+	M_buf_cancel(buf);
+	M_json_node_destroy(node);
+}
+END_TEST
+
+START_TEST(check_json_writer_misuse)
+{
+	M_json_writer_t *w;
+	M_buf_t         *buf;
+
+	ck_assert_msg(M_json_writer_create(NULL, M_JSON_WRITER_NONE) == NULL, "created without buffer");
+	ck_assert_msg(M_json_writer_create_cb(NULL, NULL, 0, M_JSON_WRITER_NONE) == NULL, "created without callback");
+
+	buf = M_buf_create();
+	w   = M_json_writer_create(buf, M_JSON_WRITER_NONE);
+
+	ck_assert_msg(!M_json_writer_finish(w), "finished empty document");
+	ck_assert_msg(!M_json_writer_key(w, "a"), "key at root");
+	ck_assert_msg(!M_json_writer_object_end(w), "object end at root");
+
+	ck_assert_msg(M_json_writer_object_begin(w), "object begin failed");
+	ck_assert_msg(!M_json_writer_value_int(w, 1), "value without key");
+	ck_assert_msg(!M_json_writer_array_end(w), "array end in object");
+	ck_assert_msg(!M_json_writer_key(w, NULL), "NULL key");
+	ck_assert_msg(M_json_writer_key(w, "a\"b"), "key failed");
+	ck_assert_msg(!M_json_writer_key(w, "c"), "two keys in a row");
+	ck_assert_msg(!M_json_writer_object_end(w), "object end with pending key");
+
+	/* Rejected values leave nothing behind and the key is still pending. */
+	ck_assert_msg(!M_json_writer_value_string(w, "bad \xff utf-8"), "invalid utf-8 accepted");
+	ck_assert_msg(!M_json_writer_value_string(w, NULL), "NULL string accepted");
+	ck_assert_msg(M_json_writer_array_begin(w), "array begin failed");
+	ck_assert_msg(!M_json_writer_key(w, "c"), "key in array");
+	ck_assert_msg(!M_json_writer_value_string(w, "\xc3"), "truncated utf-8 accepted");
+	ck_assert_msg(M_json_writer_value_string(w, "ok"), "string failed");
+	ck_assert_msg(!M_json_writer_value_string(w, "\xc3"), "truncated utf-8 accepted");
+	ck_assert_msg(!M_json_writer_object_end(w), "object end in array");
+	ck_assert_msg(!M_json_writer_finish(w), "finished with open containers");
+	ck_assert_msg(M_json_writer_depth(w) == 2, "depth %zu != 2", M_json_writer_depth(w));
+	ck_assert_msg(M_json_writer_array_end(w), "array end failed");
+	ck_assert_msg(M_json_writer_object_end(w), "object end failed");
+
+	ck_assert_msg(!M_json_writer_object_begin(w), "second root value");
+	ck_assert_msg(!M_json_writer_value_null(w), "second root value");
+	ck_assert_msg(M_json_writer_finish(w), "finish failed");
+	M_json_writer_destroy(w);
+
+	ck_assert_msg(M_str_eq(M_buf_peek(buf), "{\"a\\\"b\":[\"ok\"]}"), "got '%s'", M_buf_peek(buf));
+	M_buf_cancel(buf);
+
+	/* Invalid utf-8 can be replaced instead. */
+	buf = M_buf_create();
+	w   = M_json_writer_create(buf, M_JSON_WRITER_REPLACE_BAD_CHARS);
+	ck_assert_msg(M_json_writer_value_string(w, "a\xff"), "string failed");
+	ck_assert_msg(M_json_writer_finish(w), "finish failed");
+	M_json_writer_destroy(w);
+	ck_assert_msg(M_str_eq(M_buf_peek(buf), "\"a?\""), "got '%s'", M_buf_peek(buf));
+	M_buf_cancel(buf);
+}
+END_TEST
+
+START_TEST(check_json_writer_flush)
+{
+	M_json_writer_t *w;
+	M_json_node_t   *node;
+	M_buf_t         *buf;
+	sink_t           sink;
+	char            *expected;
+	char             name[32];
+	size_t           i;
+
+	/* Build the same document in a buffer and through a callback with a
+	 * small flush size. */
+	buf = M_buf_create();
+	M_mem_set(&sink, 0, sizeof(sink));
+	sink.buf = M_buf_create();
+
+	w = M_json_writer_create(buf, M_JSON_WRITER_PRETTYPRINT_SPACE);
+	M_json_writer_array_begin(w);
+	for (i=0; i<2000; i++) {
+		M_snprintf(name, sizeof(name), "name %zu", i);
+		M_json_writer_object_begin(w);
+		M_json_writer_key(w, "id");
+		M_json_writer_value_int(w, (M_int64)i);
+		M_json_writer_key(w, "name");
+		M_json_writer_value_string(w, name);
+		M_json_writer_object_end(w);
+	}
+	M_json_writer_array_end(w);
+	ck_assert_msg(M_json_writer_flush(w), "flush failed");
+	ck_assert_msg(M_json_writer_finish(w), "finish failed");
+	M_json_writer_destroy(w);
+	expected = M_buf_finish_str(buf, NULL);
+
+	w = M_json_writer_create_cb(sink_flush, &sink, 1024, M_JSON_WRITER_PRETTYPRINT_SPACE);
+	M_json_writer_array_begin(w);
+	for (i=0; i<2000; i++) {
+		M_snprintf(name, sizeof(name), "name %zu", i);
+		M_json_writer_object_begin(w);
+		M_json_writer_key(w, "id");
+		M_json_writer_value_int(w, (M_int64)i);
+		M_json_writer_key(w, "name");
+		M_json_writer_value_string(w, name);
+		M_json_writer_object_end(w);
+	}
+	M_json_writer_array_end(w);
+	ck_assert_msg(M_json_writer_finish(w), "finish failed");
+	M_json_writer_destroy(w);
+
+	ck_assert_msg(sink.flushes > 10, "only %zu flushes", sink.flushes);
+	/* Flushing happens after each element so a flush can exceed the flush
+	 * size by at most one element. */
+	ck_assert_msg(sink.max_len < 1024+64, "flushed %zu bytes", sink.max_len);
+	ck_assert_msg(M_str_eq(M_buf_peek(sink.buf), expected), "callback output differs");
+	M_buf_cancel(sink.buf);
+
+	/* A failing sink fails everything after it. */
+	M_mem_set(&sink, 0, sizeof(sink));
+	sink.buf        = M_buf_create();
+	sink.fail_after = 2;
+	w = M_json_writer_create_cb(sink_flush, &sink, 16, M_JSON_WRITER_NONE);
+	M_json_writer_array_begin(w);
+	for (i=0; i<100; i++) {
+		if (!M_json_writer_value_string(w, "0123456789"))
+			break;
+	}
+	ck_assert_msg(i < 100 && sink.flushes == 2, "sink failure not reported: %zu writes, %zu flushes", i, sink.flushes);
+	ck_assert_msg(!M_json_writer_array_end(w), "array end after sink failure");
+	ck_assert_msg(!M_json_writer_flush(w), "flush after sink failure");
+	M_json_writer_destroy(w);
+	M_buf_cancel(sink.buf);
+
+	/* File. */
+	w = M_json_writer_create_file("check_json_writer.json", 1024, M_JSON_WRITER_PRETTYPRINT_SPACE);
+	ck_assert_msg(w != NULL, "could not create file");
+	M_json_writer_array_begin(w);
+	for (i=0; i<2000; i++) {
+		M_snprintf(name, sizeof(name), "name %zu", i);
+		M_json_writer_object_begin(w);
+		M_json_writer_key(w, "id");
+		M_json_writer_value_int(w, (M_int64)i);
+		M_json_writer_key(w, "name");
+		M_json_writer_value_string(w, name);
+		M_json_writer_object_end(w);
+	}
+	M_json_writer_array_end(w);
+	ck_assert_msg(M_json_writer_finish(w), "finish failed");
+	M_json_writer_destroy(w);
+
+	node = M_json_read_file("check_json_writer.json", M_JSON_READER_NONE, 0, NULL, NULL, NULL);
+	ck_assert_msg(node != NULL, "could not read file back");
+	ck_assert_msg(M_json_array_len(node) == 2000, "file has %zu records", M_json_array_len(node));
+	M_json_node_destroy(node);
+	M_fs_delete("check_json_writer.json", M_FALSE, NULL, 0);
+
+	M_free(expected);
+}
+END_TEST
+
+START_TEST(check_json_writer_tree_errors)
+{
+	M_json_node_t *node;
+	M_json_node_t *obj;
+	char          *out;
+
+	/* A failure inside an object doesn't leak. */
+	node = M_json_node_create(M_JSON_TYPE_OBJECT);
+	obj  = M_json_node_create(M_JSON_TYPE_OBJECT);
+	M_json_object_insert_string(obj, "bad", "\xff");
+	M_json_object_insert(node, "a", obj);
+	out = M_json_write(node, M_JSON_WRITER_NONE, NULL);
+	ck_assert_msg(out == NULL, "invalid utf-8 written: %s", out);
+	M_json_node_destroy(node);
+
+	/* Large integers are only quoted in compatibility mode. */
+	node = M_json_node_create(M_JSON_TYPE_INTEGER);
+	M_json_set_int(node, 9007199254740993LL);
+	out = M_json_write(node, M_JSON_WRITER_NONE, NULL);
+	ck_assert_msg(M_str_eq(out, "\"9007199254740993\""), "got '%s'", out);
+	M_free(out);
+	out = M_json_write(node, M_JSON_WRITER_NUMBER_NOCOMPAT, NULL);
+	ck_assert_msg(M_str_eq(out, "9007199254740993"), "got '%s'", out);
+	M_free(out);
+	M_json_node_destroy(node);
+}
+END_TEST
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+Suite *M_json_writer_suite(void)
+{
+	Suite *suite;
+	TCase *tc_json_writer_tree;
+	TCase *tc_json_writer_nested_node;
+	TCase *tc_json_writer_misuse;
+	TCase *tc_json_writer_flush;
+	TCase *tc_json_writer_tree_errors;
+
+	suite = suite_create("json_writer");
+
+	tc_json_writer_tree = tcase_create("check_json_writer_tree");
+	tcase_add_test(tc_json_writer_tree, check_json_writer_tree);
+	suite_add_tcase(suite, tc_json_writer_tree);
+
+	tc_json_writer_nested_node = tcase_create("check_json_writer_nested_node");
+	tcase_add_test(tc_json_writer_nested_node, check_json_writer_nested_node);
+	suite_add_tcase(suite, tc_json_writer_nested_node);
+
+	tc_json_writer_misuse = tcase_create("check_json_writer_misuse");
+	tcase_add_test(tc_json_writer_misuse, check_json_writer_misuse);
+	suite_add_tcase(suite, tc_json_writer_misuse);
+
+	tc_json_writer_flush = tcase_create("check_json_writer_flush");
+	tcase_add_test(tc_json_writer_flush, check_json_writer_flush);
+	suite_add_tcase(suite, tc_json_writer_flush);
+
+	tc_json_writer_tree_errors = tcase_create("check_json_writer_tree_errors");
+	tcase_add_test(tc_json_writer_tree_errors, check_json_writer_tree_errors);
+	suite_add_tcase(suite, tc_json_writer_tree_errors);
+
+	return suite;
+}
+
+int main(void)
+{
+	SRunner *sr;
+	int      nf;
+
+	sr = srunner_create(M_json_writer_suite());
+	if (getenv("CK_LOG_FILE_NAME")==NULL) srunner_set_log(sr, "check_json_writer.log");
+
+	srunner_run_all(sr, CK_NORMAL);
+	nf = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	return nf == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -159,6 +159,108 @@ START_TEST(check_table_csv)
 }
 END_TEST
 
+/* Runs the tasks backwards so nothing can depend on the order chunks are
+ * processed in. */
+static void check_table_dispatch(void (*task)(void *), void **args, size_t num_args, void *thunk)
+{
+	size_t *num_tasks = thunk;
+
+	while (num_args-- > 0) {
+		task(args[num_args]);
+		(*num_tasks)++;
+	}
+}
+
+/* Parallel loading has to give the same table as loading in one go. Quoted
+ * new lines are common so splits land inside of quotes, and one large quoted
+ * cell covers several splits. */
+START_TEST(check_table_csv_parallel)
+{
+	M_table_t      *table;
+	M_table_t      *table_parallel;
+	M_buf_t        *buf;
+	char           *data;
+	char           *out;
+	char           *out_parallel;
+	size_t          len;
+	size_t          num_tasks;
+	size_t          i;
+	size_t          j;
+	M_bool          have_header;
+
+	buf = M_buf_create();
+	M_buf_add_str(buf, "id,name,note,amount\r\n");
+	for (i=0; i<100000; i++) {
+		if (i == 50000) {
+			/* Spans many splits. */
+			M_buf_add_str(buf, "big,\"");
+			for (j=0; j<40000; j++) {
+				M_buf_add_str(buf, "quoted \"\" text,\r\nmore\n");
+			}
+			M_buf_add_str(buf, "\",,1\r\n");
+			continue;
+		}
+		M_bprintf(buf, "%zu,name %zu,", i, i % 100);
+		switch (i % 5) {
+			case 0:
+				M_buf_add_str(buf, "\"multi\r\nline, \"\"cell\"\"\n\",");
+				break;
+			case 1:
+				M_buf_add_str(buf, ",");
+				break;
+			case 2:
+				M_buf_add_str(buf, "\"\",");
+				break;
+			default:
+				M_buf_add_str(buf, "plain note,");
+				break;
+		}
+		M_bprintf(buf, "%zu.%02zu", i * 3, i % 100);
+		/* Short and long rows. */
+		if (i % 97 == 0) {
+			M_buf_add_str(buf, ",extra");
+		}
+		M_buf_add_str(buf, i % 89 == 0 ? "\n" : "\r\n");
+	}
+	M_buf_add_str(buf, "last,row");
+	data = M_buf_finish_str(buf, &len);
+
+	for (i=0; i<2; i++) {
+		have_header = i == 0 ? M_TRUE : M_FALSE;
+
+		table          = M_table_create(M_TABLE_NONE);
+		table_parallel = M_table_create(M_TABLE_NONE);
+		if (!have_header) {
+			for (j=0; j<3; j++) {
+				M_table_column_insert(table, NULL);
+				M_table_column_insert(table_parallel, NULL);
+			}
+		}
+
+		ck_assert_msg(M_table_load_csv(table, data, len, ',', '"', M_CSV_FLAG_NONE, have_header), "(%zu) Failed to load csv", i);
+
+		num_tasks = 0;
+		ck_assert_msg(M_table_load_csv_parallel(table_parallel, data, len, ',', '"', M_CSV_FLAG_NONE, have_header, 4, check_table_dispatch, &num_tasks), "(%zu) Failed to load csv in parallel", i);
+		/* Counting quotes and parsing are both split. */
+		ck_assert_msg(num_tasks > 2, "(%zu) data was not split, %zu tasks", i, num_tasks);
+
+		ck_assert_msg(M_table_row_count(table) == M_table_row_count(table_parallel), "(%zu) got %zu rows, expected %zu", i, M_table_row_count(table_parallel), M_table_row_count(table));
+		ck_assert_msg(M_table_column_count(table) == M_table_column_count(table_parallel), "(%zu) got %zu columns, expected %zu", i, M_table_column_count(table_parallel), M_table_column_count(table));
+
+		out          = M_table_write_csv(table, ',', '"', have_header);
+		out_parallel = M_table_write_csv(table_parallel, ',', '"', have_header);
+		ck_assert_msg(M_str_eq(out, out_parallel), "(%zu) parallel load does not match", i);
+		M_free(out_parallel);
+		M_free(out);
+
+		M_table_destroy(table_parallel);
+		M_table_destroy(table);
+	}
+
+	M_free(data);
+}
+END_TEST
+
 START_TEST(check_table_json)
 {
 	M_table_t  *table;
@@ -234,6 +336,11 @@ static Suite *test_suite(void)
 	tcase_add_test(tc, check_table_csv);
 	suite_add_tcase(suite, tc);
 
+	tc = tcase_create("table_csv_parallel");
+	tcase_add_test(tc, check_table_csv_parallel);
+	tcase_set_timeout(tc, 60);
+	suite_add_tcase(suite, tc);
+
 	tc = tcase_create("table_json");
 	tcase_add_test(tc, check_table_json);
 	suite_add_tcase(suite, tc);
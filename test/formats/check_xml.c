@@ -173,6 +173,10 @@ static struct {
 	    M_XML_READER_DONT_DECODE_TEXT, M_XML_WRITER_NONE                                                             },
 	{ "<a><b>x&#xD;</b></a>", "<a><b>x\r</b></a>",
 	    M_XML_READER_NONE, M_XML_WRITER_NONE                                                                         },
+	{ "<a><![CDATA[x&amp;]]><b/></a>", "<a>x&amp;<b/></a>",
+	    M_XML_READER_DONT_DECODE_TEXT, M_XML_WRITER_DONT_ENCODE_TEXT                                                 },
+	{ "<!DOCTYPE a><a/>", "<!DOCTYPE  a><a/>",
+	    M_XML_READER_NONE, M_XML_WRITER_NONE                                                                         },
 	{ "<a><b>x</b>&#xD;</a>", "<a><b>x</b>\r</a>",
 	    M_XML_READER_NONE, M_XML_WRITER_NONE                                                                         },
 	{ "\x7f\x0a\x3c 123>a\x7f\x0a\x3c/\x20 123 >",
@@ -463,6 +467,146 @@ START_TEST(check_xml_xpath_text_first)
 }
 END_TEST
 
+static const char *check_xml_xpath_compile_data[] = {
+	"//account",
+	"//ACCOUNT",
+	"//Trans[@identifier='2']/account",
+	"//ordernum[last()]",
+	"//ordernum[position() >= 1]/text()",
+	"//Trans//ordernum",
+	"//custref/text()",
+	"//*:Action",
+	"//multi[2]",
+	"//multi/..",
+	"MonetraTrans/Trans[2]",
+	"/MonetraTrans//amount",
+	".//username",
+	"//nothere",
+	NULL
+};
+
+START_TEST(check_xml_xpath_compile)
+{
+	M_xml_node_t         *x;
+	M_xml_node_t         *trans;
+	M_xml_xpath_t        *xpath;
+	M_xml_xpath_index_t  *index;
+	M_xml_xpath_index_t  *trans_index;
+	M_xml_node_t        **results;
+	M_xml_node_t        **expected;
+	size_t                num_matches;
+	size_t                num_expected;
+	size_t                i;
+	size_t                j;
+	M_uint32              flags[] = { M_XML_READER_NONE, M_XML_READER_TAG_CASECMP };
+
+	x = M_xml_read(XML2, M_str_len(XML2), M_XML_READER_NONE, NULL, NULL, NULL, NULL);
+	ck_assert_msg(x != NULL, "XML could not be parsed");
+
+	index       = M_xml_xpath_index_create(x);
+	trans       = M_xml_node_child(M_xml_node_child(x, 0), 1);
+	trans_index = M_xml_xpath_index_create(trans);
+	ck_assert_msg(index != NULL && trans_index != NULL, "could not create index");
+
+	for (i=0; check_xml_xpath_compile_data[i]!=NULL; i++) {
+		for (j=0; j<sizeof(flags)/sizeof(*flags); j++) {
+			xpath = M_xml_xpath_compile(check_xml_xpath_compile_data[i], flags[j]);
+			ck_assert_msg(xpath != NULL, "(%zu) '%s': could not compile", i, check_xml_xpath_compile_data[i]);
+
+			expected = M_xml_xpath(x, check_xml_xpath_compile_data[i], flags[j], &num_expected);
+
+			/* Without an index, with a matching index, and with an index of another node. */
+			results = M_xml_xpath_eval(xpath, x, NULL, &num_matches);
+			ck_assert_msg(num_matches == num_expected && M_mem_eq(results, expected, num_matches * sizeof(*results)), "(%zu) '%s' %u: matches differ", i, check_xml_xpath_compile_data[i], flags[j]);
+			M_free(results);
+
+			results = M_xml_xpath_eval(xpath, x, index, &num_matches);
+			ck_assert_msg(num_matches == num_expected && M_mem_eq(results, expected, num_matches * sizeof(*results)), "(%zu) '%s' %u: indexed matches differ", i, check_xml_xpath_compile_data[i], flags[j]);
+			M_free(results);
+
+			results = M_xml_xpath_eval(xpath, x, trans_index, &num_matches);
+			ck_assert_msg(num_matches == num_expected && M_mem_eq(results, expected, num_matches * sizeof(*results)), "(%zu) '%s' %u: other index matches differ", i, check_xml_xpath_compile_data[i], flags[j]);
+			M_free(results);
+			M_free(expected);
+
+			/* Relative to a sub node. */
+			expected = M_xml_xpath(trans, check_xml_xpath_compile_data[i], flags[j], &num_expected);
+			results  = M_xml_xpath_eval(xpath, trans, trans_index, &num_matches);
+			ck_assert_msg(num_matches == num_expected && M_mem_eq(results, expected, num_matches * sizeof(*results)), "(%zu) '%s' %u: sub node matches differ", i, check_xml_xpath_compile_data[i], flags[j]);
+			M_free(results);
+			M_free(expected);
+
+			M_xml_xpath_destroy(xpath);
+		}
+	}
+
+	/* Case insensitive index lookups. */
+	xpath   = M_xml_xpath_compile("//ACCOUNT", M_XML_READER_TAG_CASECMP);
+	results = M_xml_xpath_eval(xpath, x, index, &num_matches);
+	ck_assert_msg(num_matches == 2, "'//ACCOUNT' got %zu matches, expected 2", num_matches);
+	M_free(results);
+	M_xml_xpath_destroy(xpath);
+
+	xpath   = M_xml_xpath_compile("//ACCOUNT", M_XML_READER_NONE);
+	results = M_xml_xpath_eval(xpath, x, index, &num_matches);
+	ck_assert_msg(results == NULL && num_matches == 0, "'//ACCOUNT' case sensitive got %zu matches", num_matches);
+	M_xml_xpath_destroy(xpath);
+
+	ck_assert_msg(M_xml_xpath_compile("a[1", M_XML_READER_NONE) == NULL, "compiled invalid expression");
+	ck_assert_msg(M_xml_xpath_index_create(M_xml_node_child(M_xml_node_child(trans, 0), 0)) == NULL, "indexed text node");
+
+	M_xml_xpath_index_destroy(trans_index);
+	M_xml_xpath_index_destroy(index);
+	M_xml_node_destroy(x);
+}
+END_TEST
+
+START_TEST(check_xml_arena)
+{
+	M_arena_t     *arena;
+	M_xml_node_t  *x;
+	M_xml_node_t  *n;
+	char          *out;
+	M_xml_error_t  eh;
+	size_t         i;
+
+	arena = M_arena_create(1024);
+
+	for (i=0; check_xml_valid_data[i].data!=NULL; i++) {
+		x = M_xml_read_arena(arena, check_xml_valid_data[i].data, M_str_len(check_xml_valid_data[i].data), check_xml_valid_data[i].in_flags, NULL, &eh, NULL, NULL);
+		ck_assert_msg(x != NULL, "XML (%zu) could not be parsed: error=%d", i, eh);
+		if (check_xml_valid_data[i].out != NULL) {
+			out = M_xml_write(x, check_xml_valid_data[i].out_flags, NULL);
+			ck_assert_msg(M_str_eq(out, check_xml_valid_data[i].out), "Output not as expected (%zu):\ngot='%s'\nexpected='%s'", i, out, check_xml_valid_data[i].out);
+			M_free(out);
+		}
+
+		/* Modifying arena nodes. */
+		n = M_xml_create_element_with_text("added", "text", 0, x);
+		ck_assert_msg(n != NULL, "Could not add element (%zu)", i);
+		ck_assert_msg(M_xml_node_set_name(n, "renamed"), "Could not rename element (%zu)", i);
+		ck_assert_msg(M_xml_node_insert_attribute(n, "attr", "value", 0, M_FALSE), "Could not add attribute (%zu)", i);
+		M_xml_node_destroy(n);
+
+		/* Arena and non-arena nodes can't be mixed. */
+		n = M_xml_create_element("other", NULL);
+		ck_assert_msg(!M_xml_node_insert_node(x, n), "Inserted non-arena node into arena node (%zu)", i);
+		M_xml_node_destroy(n);
+
+		/* Everything is released by the reset, destroy isn't needed. */
+		M_arena_reset(arena);
+	}
+
+	for (i=0; check_xml_invalid_data[i].data!=NULL; i++) {
+		x = M_xml_read_arena(arena, check_xml_invalid_data[i].data, M_str_len(check_xml_invalid_data[i].data), M_XML_READER_NONE, NULL, &eh, NULL, NULL);
+		ck_assert_msg(x == NULL, "Invalid xml (%zu) parsed successfully", i);
+		ck_assert_msg(eh == check_xml_invalid_data[i].error, "Invalid xml (%zu) error incorrect. got=%d, expected=%d", i, eh, check_xml_invalid_data[i].error);
+	}
+
+	M_arena_destroy(arena);
+}
+END_TEST
+
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
@@ -478,6 +622,8 @@ int main(void)
 	add_test(suite, check_xml_invalid);
 	add_test(suite, check_xml_xpath);
 	add_test(suite, check_xml_xpath_text_first);
+	add_test(suite, check_xml_xpath_compile);
+	add_test(suite, check_xml_arena);
 
 	sr = srunner_create(suite);
 	if (getenv("CK_LOG_FILE_NAME")==NULL) srunner_set_log(sr, "check_xml.log");
@@ -0,0 +1,448 @@
+#include "m_config.h"
+#include <stdlib.h> /* EXIT_SUCCESS, EXIT_FAILURE, srand, rand */
+#include <check.h>
+
+#include <mstdlib/mstdlib.h>
+#include <mstdlib/mstdlib_formats.h>
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+extern Suite *M_xml_pull_suite(void);
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static const char *docs[] = {
+	"<a/>",
+	"<a></a>",
+	"<?xml encoding=\"UTF-8\" version=\"1.0\"?>"
+	"<doc>"
+	"  <e1   /><e2   ></e2><e3   name = \"elem3\" />"
+	"  <e5>"
+	"    <e6>"
+	"      <e7>abc</e7>"
+	"    </e6>"
+	"  </e5>"
+	"</doc>",
+	"<!DOCTYPE html PUBLIC \"-//W3C//DTD XHTML 1.0 Strict//EN\">\n"
+	"<!-- leading comment -->\n"
+	"<html lang='en' data-x=\"a > b\">\n"
+	"  <body>\n"
+	"    text &amp; more &lt;stuff&gt;\n"
+	"    <![CDATA[ raw <data> &amp; ]]>\n"
+	"    <!--inner comment-->\n"
+	"    <p class=\"x &quot;y&quot;\">one<br/>two</p>\n"
+	"  </body>\n"
+	"</html>\n",
+	"<Document xmlns=\"urn:iso:std:iso:20022:tech:xsd:pain.001.001.03\">"
+	"<CstmrCdtTrfInitn><GrpHdr><MsgId>ABC-123</MsgId><NbOfTxs>2</NbOfTxs></GrpHdr>"
+	"<PmtInf><CdtTrfTxInf><Amt><InstdAmt Ccy=\"EUR\">100.00</InstdAmt></Amt></CdtTrfTxInf>"
+	"<CdtTrfTxInf><Amt><InstdAmt Ccy=\"USD\">5.25</InstdAmt></Amt></CdtTrfTxInf></PmtInf>"
+	"</CstmrCdtTrfInitn></Document>",
+	NULL
+};
+
+static const size_t chunk_sizes[] = { 1, 2, 5, 13, 0 };
+
+static void pull_attributes(M_xml_pull_t *pull, M_xml_node_t *node)
+{
+	const char *key;
+	const char *val;
+	size_t      i;
+
+	for (i=0; M_xml_pull_attribute(pull, i, &key, &val); i++) {
+		ck_assert_msg(M_xml_node_insert_attribute(node, key, val, 0, M_FALSE), "could not insert attribute '%s'", key);
+	}
+	ck_assert_msg(i == M_xml_pull_num_attributes(pull), "attribute count %zu != %zu", i, M_xml_pull_num_attributes(pull));
+}
+
+/* Read a document fed chunk_size bytes at a time (all at once for 0) and
+ * build a tree from the tokens. */
+static M_xml_node_t *pull_tree(const char *data, size_t chunk_size, M_uint32 flags, M_xml_error_t *error)
+{
+	M_parser_t         *parser;
+	M_xml_pull_t       *pull;
+	M_xml_node_t       *doc;
+	M_xml_node_t       *cur;
+	M_xml_node_t       *node;
+	M_xml_pull_token_t  token;
+	size_t              len = M_str_len(data);
+	size_t              fed = 0;
+	size_t              n;
+
+	parser = M_parser_create(M_PARSER_FLAG_NONE);
+	pull   = M_xml_pull_create(parser, flags);
+	doc    = M_xml_create_doc();
+	cur    = doc;
+	*error = M_XML_ERROR_SUCCESS;
+
+	while (1) {
+		token = M_xml_pull_next(pull);
+		if (token == M_XML_PULL_END_DOCUMENT)
+			break;
+
+		switch (token) {
+			case M_XML_PULL_NEED_MORE:
+				if (fed == len) {
+					*error = M_XML_ERROR_MISSING_CLOSE_TAG;
+					goto done;
+				}
+				n = chunk_size == 0 ? len : chunk_size;
+				if (n > len-fed)
+					n = len-fed;
+				M_parser_append(parser, (const unsigned char *)data+fed, n);
+				fed += n;
+				break;
+			case M_XML_PULL_ERROR:
+				*error = M_xml_pull_error(pull, NULL);
+				goto done;
+			case M_XML_PULL_START_ELEMENT:
+				cur = M_xml_create_element(M_xml_pull_name(pull), cur);
+				pull_attributes(pull, cur);
+				ck_assert_msg(M_xml_pull_depth(pull) != 0, "depth 0 after start");
+				break;
+			case M_XML_PULL_END_ELEMENT:
+				ck_assert_msg(M_str_eq(M_xml_node_name(cur), M_xml_pull_name(pull)), "end '%s' doesn't match '%s'", M_xml_pull_name(pull), M_xml_node_name(cur));
+				cur = M_xml_node_parent(cur);
+				break;
+			case M_XML_PULL_TEXT:
+				M_xml_create_text(M_xml_pull_text(pull, NULL), 0, cur);
+				break;
+			case M_XML_PULL_COMMENT:
+				M_xml_create_comment(M_xml_pull_text(pull, NULL), cur);
+				break;
+			case M_XML_PULL_PROCESSING_INSTRUCTION:
+				node = M_xml_create_processing_instruction(M_xml_pull_name(pull), cur);
+				pull_attributes(pull, node);
+				break;
+			case M_XML_PULL_DECLARATION:
+				M_xml_create_declaration_with_tag_data(M_xml_pull_name(pull), M_xml_pull_text(pull, NULL), cur);
+				break;
+			case M_XML_PULL_END_DOCUMENT:
+				break;
+		}
+	}
+
+	ck_assert_msg(M_xml_pull_depth(pull) == 0, "depth %zu at end", M_xml_pull_depth(pull));
+	ck_assert_msg(cur == doc, "not back at the document");
+
+done:
+	M_xml_pull_destroy(pull);
+	M_parser_destroy(parser);
+	if (*error != M_XML_ERROR_SUCCESS) {
+		M_xml_node_destroy(doc);
+		return NULL;
+	}
+	return doc;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+START_TEST(check_xml_pull_tree)
+{
+	static const M_uint32 flags[] = {
+		M_XML_READER_NONE,
+		M_XML_READER_IGNORE_COMMENTS,
+		M_XML_READER_DONT_DECODE_TEXT|M_XML_READER_DONT_DECODE_ATTRS
+	};
+	M_xml_node_t  *x;
+	M_xml_node_t  *p;
+	M_xml_error_t  error;
+	char          *expected;
+	char          *out;
+	size_t         i;
+	size_t         j;
+	size_t         k;
+
+	for (i=0; docs[i]!=NULL; i++) {
+		for (j=0; j<sizeof(flags)/sizeof(*flags); j++) {
+			x = M_xml_read(docs[i], M_str_len(docs[i]), flags[j], NULL, &error, NULL, NULL);
+			ck_assert_msg(x != NULL, "%zu: could not parse: %s", i, M_xml_errcode_to_str(error));
+			expected = M_xml_write(x, M_XML_WRITER_DONT_ENCODE_TEXT|M_XML_WRITER_DONT_ENCODE_ATTRS, NULL);
+			M_xml_node_destroy(x);
+
+			for (k=0; k<sizeof(chunk_sizes)/sizeof(*chunk_sizes); k++) {
+				p = pull_tree(docs[i], chunk_sizes[k], flags[j], &error);
+				ck_assert_msg(p != NULL, "%zu/%zu/%zu: pull failed: %s", i, j, chunk_sizes[k], M_xml_errcode_to_str(error));
+				out = M_xml_write(p, M_XML_WRITER_DONT_ENCODE_TEXT|M_XML_WRITER_DONT_ENCODE_ATTRS, NULL);
+				ck_assert_msg(M_str_eq(out, expected), "%zu/%zu/%zu: got\n%s\nexpected\n%s", i, j, chunk_sizes[k], out, expected);
+				M_free(out);
+				M_xml_node_destroy(p);
+			}
+
+			M_free(expected);
+		}
+	}
+}
+END_TEST
+
+static struct {
+	const char    *data;
+	M_xml_error_t  error;
+} check_xml_pull_invalid_data[] = {
+	{ "<x",                      M_XML_ERROR_MISSING_CLOSE_TAG                  },
+	{ "<d><b></b>",              M_XML_ERROR_MISSING_CLOSE_TAG                  },
+	{ "<a attr=\"abc>text</a>",  M_XML_ERROR_MISSING_CLOSE_TAG                  },
+	{ "<d>abc</b>",              M_XML_ERROR_UNEXPECTED_CLOSE                   },
+	{ "<a t1=\"1\" t1=\"2\" />", M_XML_ERROR_ATTR_EXISTS                        },
+	{ "<a t1=\"1\" T1=\"2\" />", M_XML_ERROR_ATTR_EXISTS                        },
+	{ "<>",                      M_XML_ERROR_INVALID_START_TAG                  },
+	{ "<!>",                     M_XML_ERROR_INVALID_START_TAG                  },
+	{ "<?xml>",                  M_XML_ERROR_MISSING_PROCESSING_INSTRUCTION_END },
+	{ "<a></A>",                 M_XML_ERROR_UNEXPECTED_CLOSE                   },
+	{ "</a>",                    M_XML_ERROR_INELIGIBLE_FOR_CLOSE               },
+	{ "<a><<b/></a>",            M_XML_ERROR_INVALID_CHAR_IN_START_TAG          },
+	{ NULL, 0 }
+};
+
+START_TEST(check_xml_pull_invalid)
+{
+	M_xml_node_t  *x;
+	M_xml_error_t  error;
+	M_xml_error_t  tree_error;
+	size_t         i;
+	size_t         k;
+
+	for (i=0; check_xml_pull_invalid_data[i].data!=NULL; i++) {
+		x = M_xml_read(check_xml_pull_invalid_data[i].data, M_str_len(check_xml_pull_invalid_data[i].data), M_XML_READER_NONE, NULL, &tree_error, NULL, NULL);
+		ck_assert_msg(x == NULL && tree_error == check_xml_pull_invalid_data[i].error, "%zu: tree reader error %s", i, M_xml_errcode_to_str(tree_error));
+
+		for (k=0; k<sizeof(chunk_sizes)/sizeof(*chunk_sizes); k++) {
+			x = pull_tree(check_xml_pull_invalid_data[i].data, chunk_sizes[k], M_XML_READER_NONE, &error);
+			ck_assert_msg(x == NULL, "%zu/%zu: invalid xml parsed", i, chunk_sizes[k]);
+			ck_assert_msg(error == check_xml_pull_invalid_data[i].error, "%zu/%zu: got %s, expected %s", i, chunk_sizes[k], M_xml_errcode_to_str(error), M_xml_errcode_to_str(check_xml_pull_invalid_data[i].error));
+		}
+	}
+}
+END_TEST
+
+START_TEST(check_xml_pull_attributes)
+{
+	M_parser_t   *parser;
+	M_xml_pull_t *pull;
+	const char   *s = "<a  Z = \"1\" b='x &amp; y' c=\"&lt;&quot;\">text</a>";
+	const char   *key;
+	const char   *val;
+	size_t        len;
+
+	parser = M_parser_create_const((const unsigned char *)s, M_str_len(s), M_PARSER_FLAG_NONE);
+	pull   = M_xml_pull_create(parser, M_XML_READER_NONE);
+
+	ck_assert_msg(M_xml_pull_next(pull) == M_XML_PULL_START_ELEMENT, "expected start");
+	ck_assert_msg(M_str_eq(M_xml_pull_name(pull), "a"), "wrong name '%s'", M_xml_pull_name(pull));
+	ck_assert_msg(M_xml_pull_num_attributes(pull) == 3, "%zu attributes", M_xml_pull_num_attributes(pull));
+	ck_assert_msg(M_xml_pull_attribute(pull, 0, &key, &val) && M_str_eq(key, "Z") && M_str_eq(val, "1"), "attribute 0 wrong");
+	ck_assert_msg(M_xml_pull_attribute(pull, 1, &key, &val) && M_str_eq(key, "b") && M_str_eq(val, "x & y"), "attribute 1 wrong");
+	ck_assert_msg(M_xml_pull_attribute(pull, 2, &key, &val) && M_str_eq(key, "c") && M_str_eq(val, "<\""), "attribute 2 wrong");
+	ck_assert_msg(!M_xml_pull_attribute(pull, 3, &key, &val), "attribute 3 exists");
+	ck_assert_msg(M_str_eq(M_xml_pull_attribute_value(pull, "z"), "1"), "lookup is case sensitive");
+	ck_assert_msg(M_xml_pull_attribute_value(pull, "d") == NULL, "d exists");
+	ck_assert_msg(M_xml_pull_skip(pull), "skip failed");
+
+	ck_assert_msg(M_xml_pull_next(pull) == M_XML_PULL_END_ELEMENT, "expected end after skip");
+	ck_assert_msg(M_xml_pull_num_attributes(pull) == 0, "end has attributes");
+	ck_assert_msg(M_xml_pull_text(pull, &len) == NULL && len == 0, "end has text");
+	ck_assert_msg(M_xml_pull_next(pull) == M_XML_PULL_END_DOCUMENT, "expected end of document");
+	ck_assert_msg(M_xml_pull_next(pull) == M_XML_PULL_END_DOCUMENT, "end of document not repeated");
+	ck_assert_msg(!M_xml_pull_skip(pull), "skip accepted after the end");
+
+	M_xml_pull_destroy(pull);
+	M_parser_destroy(parser);
+}
+END_TEST
+
+START_TEST(check_xml_pull_skip)
+{
+	M_parser_t         *parser;
+	M_xml_pull_t       *pull;
+	M_xml_pull_token_t  token;
+	M_buf_t            *seen;
+	const char         *s = "<r><skip a=\"1\"><x><y/>text<!--c--></x><skip>inner</skip></skip><empty/><keep>k</keep></r>";
+	size_t              fed;
+	size_t              n;
+	size_t              k;
+
+	for (k=0; k<sizeof(chunk_sizes)/sizeof(*chunk_sizes); k++) {
+		parser = M_parser_create(M_PARSER_FLAG_NONE);
+		pull   = M_xml_pull_create(parser, M_XML_READER_NONE);
+		seen   = M_buf_create();
+		fed    = 0;
+
+		while ((token = M_xml_pull_next(pull)) != M_XML_PULL_END_DOCUMENT) {
+			ck_assert_msg(token != M_XML_PULL_ERROR, "%zu: error", chunk_sizes[k]);
+			switch (token) {
+				case M_XML_PULL_NEED_MORE:
+					ck_assert_msg(fed < M_str_len(s), "%zu: ran out of data", chunk_sizes[k]);
+					n = M_str_len(s)-fed;
+					if (chunk_sizes[k] != 0 && chunk_sizes[k] < n)
+						n = chunk_sizes[k];
+					M_parser_append(parser, (const unsigned char *)s+fed, n);
+					fed += n;
+					break;
+				case M_XML_PULL_START_ELEMENT:
+					M_bprintf(seen, "<%s>", M_xml_pull_name(pull));
+					if (M_str_eq(M_xml_pull_name(pull), "skip") || M_str_eq(M_xml_pull_name(pull), "empty"))
+						ck_assert_msg(M_xml_pull_skip(pull), "skip failed");
+					break;
+				case M_XML_PULL_END_ELEMENT:
+					M_bprintf(seen, "</%s>", M_xml_pull_name(pull));
+					break;
+				case M_XML_PULL_TEXT:
+					M_bprintf(seen, "%s", M_xml_pull_text(pull, NULL));
+					break;
+				default:
+					ck_abort_msg("unexpected token %d", token);
+			}
+		}
+
+		ck_assert_msg(M_str_eq(M_buf_peek(seen), "<r><skip></skip><empty></empty><keep>k</keep></r>"), "%zu: got '%s'", chunk_sizes[k], M_buf_peek(seen));
+
+		M_buf_cancel(seen);
+		M_xml_pull_destroy(pull);
+		M_parser_destroy(parser);
+	}
+
+	/* Nesting is still checked while skipping. */
+	s      = "<r><skip><x></y></skip></r>";
+	parser = M_parser_create_const((const unsigned char *)s, M_str_len(s), M_PARSER_FLAG_NONE);
+	pull   = M_xml_pull_create(parser, M_XML_READER_NONE);
+	ck_assert_msg(M_xml_pull_next(pull) == M_XML_PULL_START_ELEMENT, "expected start");
+	ck_assert_msg(M_xml_pull_next(pull) == M_XML_PULL_START_ELEMENT, "expected start");
+	ck_assert_msg(M_xml_pull_skip(pull), "skip failed");
+	ck_assert_msg(M_xml_pull_next(pull) == M_XML_PULL_ERROR, "expected error");
+	ck_assert_msg(M_xml_pull_error(pull, &fed) == M_XML_ERROR_UNEXPECTED_CLOSE, "wrong error");
+	ck_assert_msg(fed == 12, "error at %zu", fed);
+	M_xml_pull_destroy(pull);
+	M_parser_destroy(parser);
+}
+END_TEST
+
+START_TEST(check_xml_pull_multi)
+{
+	M_parser_t         *parser;
+	M_xml_pull_t       *pull;
+	M_xml_pull_token_t  token;
+	const char         *s = "<a>1</a>\n<b>2</b> trailing";
+
+	parser = M_parser_create_const((const unsigned char *)s, M_str_len(s), M_PARSER_FLAG_NONE);
+	pull   = M_xml_pull_create(parser, M_XML_READER_NONE);
+
+	while ((token = M_xml_pull_next(pull)) != M_XML_PULL_END_DOCUMENT)
+		ck_assert_msg(token != M_XML_PULL_ERROR && token != M_XML_PULL_NEED_MORE, "first document failed");
+	ck_assert_msg(M_parser_len(parser) == 18, "%zu bytes left after the first document", M_parser_len(parser));
+
+	M_xml_pull_reset(pull);
+	ck_assert_msg(M_xml_pull_next(pull) == M_XML_PULL_START_ELEMENT && M_str_eq(M_xml_pull_name(pull), "b"), "second document didn't start");
+	ck_assert_msg(M_xml_pull_next(pull) == M_XML_PULL_TEXT && M_str_eq(M_xml_pull_text(pull, NULL), "2"), "second document text");
+	ck_assert_msg(M_xml_pull_next(pull) == M_XML_PULL_END_ELEMENT, "second document didn't end");
+	ck_assert_msg(M_xml_pull_next(pull) == M_XML_PULL_END_DOCUMENT, "second document didn't end");
+	ck_assert_msg(M_str_eq((const char *)M_parser_peek(parser), " trailing"), "trailing data consumed");
+
+	M_xml_pull_destroy(pull);
+	M_parser_destroy(parser);
+}
+END_TEST
+
+START_TEST(check_xml_pull_bounded)
+{
+	M_parser_t         *parser;
+	M_xml_pull_t       *pull;
+	M_xml_pull_token_t  token;
+	M_buf_t            *buf;
+	const char         *data;
+	size_t              len;
+	size_t              fed     = 0;
+	size_t              max_len = 0;
+	size_t              records = 0;
+	size_t              i;
+
+	buf = M_buf_create();
+	M_buf_add_str(buf, "<Document><Pmts>");
+	for (i=0; i<50000; i++) {
+		M_bprintf(buf, "<Pmt id=\"%zu\"><Amt Ccy=\"EUR\">%zu.00</Amt><Nm>Name &amp; %zu</Nm><Sig><![CDATA[0123456789abcdef]]></Sig></Pmt>\n", i, i, i);
+	}
+	M_buf_add_str(buf, "</Pmts></Document>");
+	data = M_buf_peek(buf);
+	len  = M_buf_len(buf);
+
+	parser = M_parser_create(M_PARSER_FLAG_NONE);
+	pull   = M_xml_pull_create(parser, M_XML_READER_NONE);
+	while ((token = M_xml_pull_next(pull)) != M_XML_PULL_END_DOCUMENT) {
+		ck_assert_msg(token != M_XML_PULL_ERROR, "error at %zu", fed);
+		if (token == M_XML_PULL_NEED_MORE) {
+			ck_assert_msg(fed < len, "ran out of data");
+			M_parser_append(parser, (const unsigned char *)data+fed, M_MIN(4096, len-fed));
+			fed += M_MIN(4096, len-fed);
+			if (M_parser_len(parser) > max_len)
+				max_len = M_parser_len(parser);
+		} else if (token == M_XML_PULL_START_ELEMENT && M_str_eq(M_xml_pull_name(pull), "Pmt")) {
+			records++;
+		} else if (token == M_XML_PULL_START_ELEMENT && M_str_eq(M_xml_pull_name(pull), "Sig")) {
+			M_xml_pull_skip(pull);
+		}
+	}
+
+	ck_assert_msg(records == 50000, "read %zu records", records);
+	/* Only a chunk and part of a token is ever buffered. */
+	ck_assert_msg(max_len < 4096*2, "parser grew to %zu bytes", max_len);
+
+	M_xml_pull_destroy(pull);
+	M_parser_destroy(parser);
+	M_buf_cancel(buf);
+}
+END_TEST
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+Suite *M_xml_pull_suite(void)
+{
+	Suite *suite;
+	TCase *tc_xml_pull_tree;
+	TCase *tc_xml_pull_invalid;
+	TCase *tc_xml_pull_attributes;
+	TCase *tc_xml_pull_skip;
+	TCase *tc_xml_pull_multi;
+	TCase *tc_xml_pull_bounded;
+
+	suite = suite_create("xml_pull");
+
+	tc_xml_pull_tree = tcase_create("check_xml_pull_tree");
+	tcase_add_test(tc_xml_pull_tree, check_xml_pull_tree);
+	suite_add_tcase(suite, tc_xml_pull_tree);
+
+	tc_xml_pull_invalid = tcase_create("check_xml_pull_invalid");
+	tcase_add_test(tc_xml_pull_invalid, check_xml_pull_invalid);
+	suite_add_tcase(suite, tc_xml_pull_invalid);
+
+	tc_xml_pull_attributes = tcase_create("check_xml_pull_attributes");
+	tcase_add_test(tc_xml_pull_attributes, check_xml_pull_attributes);
+	suite_add_tcase(suite, tc_xml_pull_attributes);
+
+	tc_xml_pull_skip = tcase_create("check_xml_pull_skip");
+	tcase_add_test(tc_xml_pull_skip, check_xml_pull_skip);
+	suite_add_tcase(suite, tc_xml_pull_skip);
+
+	tc_xml_pull_multi = tcase_create("check_xml_pull_multi");
+	tcase_add_test(tc_xml_pull_multi, check_xml_pull_multi);
+	suite_add_tcase(suite, tc_xml_pull_multi);
+
+	tc_xml_pull_bounded = tcase_create("check_xml_pull_bounded");
+	tcase_add_test(tc_xml_pull_bounded, check_xml_pull_bounded);
+	suite_add_tcase(suite, tc_xml_pull_bounded);
+
+	return suite;
+}
+
+int main(void)
+{
+	SRunner *sr;
+	int      nf;
+
+	sr = srunner_create(M_xml_pull_suite());
+	if (getenv("CK_LOG_FILE_NAME")==NULL) srunner_set_log(sr, "check_xml_pull.log");
+
+	srunner_run_all(sr, CK_NORMAL);
+	nf = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	return nf == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -73,6 +73,74 @@ static void el_many_cb(M_event_t *el, M_event_type_t etype, M_io_t *io, void *th
 	M_thread_mutex_unlock(data->mutex);
 }
 
+static void el_pool_task_cb(M_event_t *el, M_event_type_t etype, M_io_t *io, void *thunk)
+{
+	cb_data_t *data = thunk;
+	size_t     count;
+
+	(void)el;
+	(void)etype;
+	(void)io;
+
+	M_thread_mutex_lock(data->mutex);
+	count = ++data->count;
+	if (count == data->num)
+		M_event_done(data->el1);
+	M_thread_mutex_unlock(data->mutex);
+
+	/* Some slow tasks so others back up behind them */
+	if (count % 16 == 0)
+		M_thread_sleep(1000);
+}
+
+static void el_pool_slow_task_cb(M_event_t *el, M_event_type_t etype, M_io_t *io, void *thunk)
+{
+	cb_data_t *data = thunk;
+
+	(void)el;
+	(void)etype;
+	(void)io;
+
+	/* Slow enough that an idle thread has time to take some */
+	M_thread_sleep(20000);
+
+	M_thread_mutex_lock(data->mutex);
+	data->count++;
+	M_thread_mutex_unlock(data->mutex);
+}
+
+static void el_pool_busy_cb(M_event_t *el, M_event_type_t etype, M_io_t *io, void *thunk)
+{
+	(void)el;
+	(void)etype;
+	(void)io;
+	(void)thunk;
+
+	/* Time spent in a callback counts towards the thread's load */
+	M_thread_sleep(1500000);
+}
+
+static void el_pool_io_cb(M_event_t *el, M_event_type_t etype, M_io_t *io, void *thunk)
+{
+	(void)el;
+	(void)etype;
+	(void)io;
+	(void)thunk;
+}
+
+static void el_pool_oneshot_cb(M_event_t *el, M_event_type_t etype, M_io_t *io, void *thunk)
+{
+	cb_data_t *data = thunk;
+
+	(void)el;
+	(void)etype;
+	(void)io;
+
+	M_thread_mutex_lock(data->mutex);
+	data->count++;
+	M_thread_mutex_unlock(data->mutex);
+}
+
 static void el_many_remove_cb(M_event_t *el, M_event_type_t etype, M_io_t *io, void *thunk)
 {
 	cb_data_t       *data = thunk;
@@ -472,6 +540,152 @@ START_TEST(check_event_many_remove)
 }
 END_TEST
 
+START_TEST(check_event_pool_tasks)
+{
+	M_thread_attr_t *tattr;
+	M_threadid_t     t1;
+	M_event_t       *thread;
+	size_t           i;
+	M_uint64         ran = 0;
+	cb_data_t        data;
+
+	M_mem_set(&data, 0, sizeof(data));
+
+	data.num   = 5000;
+	data.el1   = M_event_pool_create(0);
+	data.mutex = M_thread_mutex_create(M_THREAD_MUTEXATTR_NONE);
+
+	for (i=0; i<data.num; i++) {
+		ck_assert_msg(M_event_queue_task(data.el1, el_pool_task_cb, &data), "Failed to queue task %zu", i);
+	}
+
+	tattr = M_thread_attr_create();
+	M_thread_attr_set_create_joinable(tattr, M_TRUE);
+	t1 = M_thread_create(tattr, run_els, &data);
+	M_thread_attr_destroy(tattr);
+
+	M_thread_join(t1, NULL);
+
+	ck_assert_msg(data.count == data.num, "Pool tasks called event cb unexpected number of times (%zu) expected (%zu)", data.count, data.num);
+
+	/* Every task ran on exactly one of the threads */
+	for (i=0; (thread = M_event_get_pool_thread(data.el1, i)) != NULL; i++) {
+		ck_assert_msg(M_event_get_statistic(thread, M_EVENT_STATISTIC_LOAD) <= 1000, "Thread %zu load out of range", i);
+		ran += M_event_get_statistic(thread, M_EVENT_STATISTIC_TIMER_COUNT);
+	}
+	ck_assert_msg(i > 0, "Pool has no threads");
+	ck_assert_msg(ran == data.num, "Pool threads ran %llu tasks, expected %zu", ran, data.num);
+
+	M_event_destroy(data.el1);
+	M_thread_mutex_destroy(data.mutex);
+}
+END_TEST
+
+START_TEST(check_event_pool_rebalance)
+{
+	M_thread_attr_t *tattr;
+	M_threadid_t     t1;
+	M_event_t       *thread0;
+	M_event_t       *thread1;
+	M_io_t          *ios[16];
+	M_uint64         stolen;
+	size_t           count;
+	size_t           i;
+	size_t           wait;
+	cb_data_t        data;
+
+	M_mem_set(&data, 0, sizeof(data));
+
+	data.num   = 16;
+	data.el1   = M_event_pool_create(2);
+	data.mutex = M_thread_mutex_create(M_THREAD_MUTEXATTR_NONE);
+	thread0    = M_event_get_pool_thread(data.el1, 0);
+	thread1    = M_event_get_pool_thread(data.el1, 1);
+
+	/* Single core systems get a plain event loop, nothing to move between */
+	if (thread1 == NULL) {
+		M_event_destroy(data.el1);
+		M_thread_mutex_destroy(data.mutex);
+		return;
+	}
+
+	/* All the io objects go to the second thread */
+	for (i=0; i<sizeof(ios) / sizeof(*ios); i+=2) {
+		ck_assert_msg(M_io_pipe_create(M_IO_PIPE_NONE, &ios[i], &ios[i+1]) == M_IO_ERROR_SUCCESS, "Failed to create pipe %zu", i/2);
+		ck_assert_msg(M_event_add(thread1, ios[i], el_pool_io_cb, NULL), "Failed to add pipe reader %zu", i/2);
+		ck_assert_msg(M_event_add(thread1, ios[i+1], el_pool_io_cb, NULL), "Failed to add pipe writer %zu", i/2);
+	}
+
+	/* Tasks go to the thread with the fewest objects, so they all pile up on
+	 * the first thread */
+	for (i=0; i<data.num; i++) {
+		ck_assert_msg(M_event_queue_task(data.el1, el_pool_slow_task_cb, &data), "Failed to queue task %zu", i);
+	}
+	ck_assert_msg(M_event_num_objects(thread0) == data.num, "Tasks not all queued to the first thread");
+
+	tattr = M_thread_attr_create();
+	M_thread_attr_set_create_joinable(tattr, M_TRUE);
+	t1 = M_thread_create(tattr, run_els, &data);
+	M_thread_attr_destroy(tattr);
+
+	for (wait=0; wait<500; wait++) {
+		M_thread_mutex_lock(data.mutex);
+		count = data.count;
+		M_thread_mutex_unlock(data.mutex);
+		if (count == data.num)
+			break;
+		M_thread_sleep(10000);
+	}
+	ck_assert_msg(count == data.num, "Pool tasks ran %zu times, expected %zu", count, data.num);
+
+	stolen = M_event_get_statistic(thread1, M_EVENT_STATISTIC_TASKS_STOLEN);
+	ck_assert_msg(stolen > 0 && stolen < data.num, "Idle thread stole %llu tasks", stolen);
+
+	/* Keep the second thread busy until its io objects have been idle long
+	 * enough to be moved */
+	ck_assert_msg(M_event_queue_task(thread1, el_pool_busy_cb, NULL), "Failed to queue busy task");
+	M_thread_sleep(1200000);
+	ck_assert_msg(M_event_pool_rebalance(data.el1), "Pool not rebalanced");
+
+	for (wait=0; wait<500 && M_event_get_statistic(thread0, M_EVENT_STATISTIC_IO_MIGRATED) == 0; wait++) {
+		M_thread_sleep(10000);
+	}
+	ck_assert_msg(M_event_get_statistic(thread0, M_EVENT_STATISTIC_IO_MIGRATED) > 0, "No io objects moved to the idle thread");
+	ck_assert_msg(M_event_get_statistic(thread1, M_EVENT_STATISTIC_IO_MIGRATED) == 0, "io objects moved to the busy thread");
+
+	M_event_done(data.el1);
+	M_thread_join(t1, NULL);
+
+	for (i=0; i<sizeof(ios) / sizeof(*ios); i++) {
+		M_io_destroy(ios[i]);
+	}
+	M_event_destroy(data.el1);
+	M_thread_mutex_destroy(data.mutex);
+}
+END_TEST
+
+START_TEST(check_event_pool_flags)
+{
+	M_event_err_t err;
+	cb_data_t     data;
+
+	M_mem_set(&data, 0, sizeof(data));
+
+	data.el1   = M_event_pool_create_ex(2, M_EVENT_FLAG_EXITONEMPTY);
+	data.mutex = M_thread_mutex_create(M_THREAD_MUTEXATTR_NONE);
+
+	ck_assert_msg(M_event_timer_oneshot(data.el1, 50, M_TRUE, el_pool_oneshot_cb, &data) != NULL, "Failed to add oneshot timer");
+
+	/* Every thread exits once it runs out of objects rather than waiting for the timeout */
+	err = M_event_loop(data.el1, 20000);
+	ck_assert_msg(err == M_EVENT_ERR_DONE, "Pool loop returned %d, expected done", (int)err);
+	ck_assert_msg(data.count == 1, "Oneshot timer ran %zu times, expected 1", data.count);
+
+	M_event_destroy(data.el1);
+	M_thread_mutex_destroy(data.mutex);
+}
+END_TEST
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 /* Checks the following:
@@ -490,6 +704,16 @@ END_TEST
  *
  * stop:
  * 1. Stopping a timer will prevent it from running if it's queued.
+ *
+ * pool_tasks:
+ * 1. Tasks queued to a pool run exactly once, on whichever thread takes them.
+ *
+ * pool_rebalance:
+ * 1. An idle pool thread takes tasks queued to a loaded one.
+ * 2. Rebalancing moves idle io objects off a busy thread.
+ *
+ * pool_flags:
+ * 1. Flags given when creating a pool apply to each of its threads.
  */
 static Suite *event_interactions_suite(void)
 {
@@ -515,6 +739,21 @@ static Suite *event_interactions_suite(void)
 	tcase_set_timeout(tc, 60);
 	suite_add_tcase(suite, tc);
 
+	tc = tcase_create("event_pool_tasks");
+	tcase_add_test(tc, check_event_pool_tasks);
+	tcase_set_timeout(tc, 60);
+	suite_add_tcase(suite, tc);
+
+	tc = tcase_create("event_pool_rebalance");
+	tcase_add_test(tc, check_event_pool_rebalance);
+	tcase_set_timeout(tc, 60);
+	suite_add_tcase(suite, tc);
+
+	tc = tcase_create("event_pool_flags");
+	tcase_add_test(tc, check_event_pool_flags);
+	tcase_set_timeout(tc, 60);
+	suite_add_tcase(suite, tc);
+
 	tc = tcase_create("event_self");
 	tcase_add_test(tc, check_event_self);
 	tcase_set_timeout(tc, 60);
@@ -272,9 +272,9 @@ typedef struct {
 	M_uint64 runtime_ms;
 } stats_t;
 
-static M_event_err_t check_event_net_test(M_uint64 num_connections, M_uint64 delay_ms, M_bool use_pool, M_bool nonscalable, stats_t *stats)
+static M_event_err_t check_event_net_test(M_uint64 num_connections, M_uint64 delay_ms, M_bool use_pool, M_uint32 flags, stats_t *stats)
 {
-	M_event_t         *event = use_pool?M_event_pool_create(0):M_event_create(nonscalable?M_EVENT_FLAG_NON_SCALABLE:M_EVENT_FLAG_NONE);
+	M_event_t         *event = use_pool?M_event_pool_create(0):M_event_create(flags);
 	M_io_t            *netclient;
 	size_t             i;
 	M_event_err_t      err;
@@ -370,7 +370,20 @@ START_TEST(check_event_net_pool)
 	size_t   i;
 
 	for (i=0; tests[i] != 0; i++) {
-		M_event_err_t err = check_event_net_test(tests[i], 0, M_TRUE, M_FALSE, NULL);
+		M_event_err_t err = check_event_net_test(tests[i], 0, M_TRUE, M_EVENT_FLAG_NONE, NULL);
+		ck_assert_msg(err == M_EVENT_ERR_DONE, "%d cnt%d expected M_EVENT_ERR_DONE got %s", (int)i, (int)tests[i], event_err_msg(err));
+	}
+}
+END_TEST
+
+START_TEST(check_event_net_io_uring)
+{
+	M_uint64 tests[] = { 1, 5, 25, 50, 0 };
+	size_t   i;
+
+	/* Falls back to epoll (or whatever is native) if io_uring isn't available */
+	for (i=0; tests[i] != 0; i++) {
+		M_event_err_t err = check_event_net_test(tests[i], 0, M_FALSE, M_EVENT_FLAG_IO_URING, NULL);
 		ck_assert_msg(err == M_EVENT_ERR_DONE, "%d cnt%d expected M_EVENT_ERR_DONE got %s", (int)i, (int)tests[i], event_err_msg(err));
 	}
 }
@@ -415,7 +428,7 @@ START_TEST(check_event_net_stat)
 	for (i=0; i < cnt; i++) {
 		M_timeval_t starttv;
 		M_time_elapsed_start(&starttv);
-		err = check_event_net_test(tests[i].num_conns, tests[i].delay_response_ms, M_FALSE, tests[i].nonscalable, &stats[i]);
+		err = check_event_net_test(tests[i].num_conns, tests[i].delay_response_ms, M_FALSE, tests[i].nonscalable?M_EVENT_FLAG_NON_SCALABLE:M_EVENT_FLAG_NONE, &stats[i]);
 		ck_assert_msg(err == M_EVENT_ERR_DONE, "%s expected M_EVENT_ERR_DONE got %s", tests[i].name, event_err_msg(err));
 		stats[i].runtime_ms = M_time_elapsed(&starttv);
 	}
@@ -453,6 +466,124 @@ START_TEST(check_event_net_addrinuse)
 }
 END_TEST
 
+#define REUSEPORT_LISTENERS 4
+#define REUSEPORT_CLIENTS   50
+
+static M_event_t *reuseport_pool;
+static M_uint64   reuseport_accepted;
+static M_uint64   reuseport_remaining;
+static M_uint64   reuseport_per_listener[REUSEPORT_LISTENERS];
+
+/* Every client connect and server accept counts down, last one out stops the pool */
+static void reuseport_check_done(void)
+{
+	if (M_atomic_dec_u64(&reuseport_remaining) == 1)
+		M_event_done(reuseport_pool);
+}
+
+static void reuseport_server_cb(M_event_t *event, M_event_type_t type, M_io_t *io, void *data)
+{
+	M_uint64 *cnt   = data;
+	M_io_t   *newio = NULL;
+
+	(void)event;
+
+	if (type != M_EVENT_TYPE_ACCEPT)
+		return;
+
+	while (M_io_accept(&newio, io) == M_IO_ERROR_SUCCESS) {
+		M_io_destroy(newio);
+		M_atomic_inc_u64(cnt);
+		M_atomic_inc_u64(&reuseport_accepted);
+		reuseport_check_done();
+	}
+}
+
+static void reuseport_client_cb(M_event_t *event, M_event_type_t type, M_io_t *io, void *data)
+{
+	(void)event;
+	(void)data;
+
+	/* The server closes immediately after accepting, so a client may see the
+	 * disconnect without ever being told it connected */
+	switch (type) {
+		case M_EVENT_TYPE_CONNECTED:
+		case M_EVENT_TYPE_DISCONNECTED:
+			M_io_destroy(io);
+			reuseport_check_done();
+			break;
+		case M_EVENT_TYPE_ERROR:
+			M_io_destroy(io);
+			break;
+		default:
+			break;
+	}
+}
+
+START_TEST(check_event_net_reuseport)
+{
+	M_io_t        *listeners[REUSEPORT_LISTENERS];
+	M_io_t        *io;
+	M_dns_t       *rdns;
+	M_io_error_t   ioerr;
+	M_event_err_t  err;
+	M_uint16       port = 0;
+	size_t         num_threads;
+	size_t         i;
+
+	ioerr = M_io_net_server_create_reuseport(&listeners[0], 0, "127.0.0.1", M_IO_NET_IPV4);
+	if (ioerr == M_IO_ERROR_NOTIMPL)
+		return;
+	ck_assert_msg(ioerr == M_IO_ERROR_SUCCESS, "server_create_reuseport returned %s", M_io_error_string(ioerr));
+	port = M_io_net_get_port(listeners[0]);
+
+	/* Additional listeners can share the port */
+	for (i=1; i<REUSEPORT_LISTENERS; i++) {
+		ioerr = M_io_net_server_create_reuseport(&listeners[i], port, "127.0.0.1", M_IO_NET_IPV4);
+		ck_assert_msg(ioerr == M_IO_ERROR_SUCCESS, "listener %zu server_create_reuseport returned %s", i, M_io_error_string(ioerr));
+	}
+
+	/* But a listener that didn't request sharing can't */
+	ioerr = M_io_net_server_create(&io, port, "127.0.0.1", M_IO_NET_IPV4);
+	ck_assert_msg(ioerr == M_IO_ERROR_ADDRINUSE, "server_create returned %s, not %s", M_io_error_string(ioerr), M_io_error_string(M_IO_ERROR_ADDRINUSE));
+
+#ifdef __linux__
+	ck_assert_msg(M_io_net_server_set_cpu_steering(listeners[1], REUSEPORT_LISTENERS), "cpu steering failed");
+#endif
+
+	reuseport_pool      = M_event_pool_create(0);
+	reuseport_accepted  = 0;
+	reuseport_remaining = REUSEPORT_CLIENTS * 2;
+	for (num_threads=0; M_event_get_pool_thread(reuseport_pool, num_threads) != NULL; num_threads++)
+		;
+	ck_assert_msg(num_threads > 0, "no pool threads");
+
+	for (i=0; i<REUSEPORT_LISTENERS; i++) {
+		reuseport_per_listener[i] = 0;
+		M_event_add(M_event_get_pool_thread(reuseport_pool, i % num_threads), listeners[i], reuseport_server_cb, &reuseport_per_listener[i]);
+	}
+
+	rdns = M_dns_create(reuseport_pool);
+	for (i=0; i<REUSEPORT_CLIENTS; i++) {
+		ck_assert_msg(M_io_net_client_create(&io, rdns, "127.0.0.1", port, M_IO_NET_IPV4) == M_IO_ERROR_SUCCESS, "client create failed");
+		M_event_add(reuseport_pool, io, reuseport_client_cb, NULL);
+	}
+
+	err = M_event_loop(reuseport_pool, 10000);
+	ck_assert_msg(err == M_EVENT_ERR_DONE, "expected M_EVENT_ERR_DONE got %s", event_err_msg(err));
+	ck_assert_msg(reuseport_accepted == REUSEPORT_CLIENTS, "accepted %llu of %d", reuseport_accepted, REUSEPORT_CLIENTS);
+
+	for (i=0; i<REUSEPORT_LISTENERS; i++) {
+		event_debug("listener %zu accepted %llu", i, reuseport_per_listener[i]);
+		M_io_destroy(listeners[i]);
+	}
+
+	M_event_destroy(reuseport_pool);
+	M_dns_destroy(rdns);
+	reuseport_pool = NULL;
+}
+END_TEST
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 static Suite *event_net_suite(void)
@@ -467,11 +598,21 @@ static Suite *event_net_suite(void)
 	tcase_set_timeout(tc, 20);
 	suite_add_tcase(suite, tc);
 
+	tc    = tcase_create("event_net_io_uring");
+	tcase_add_test(tc, check_event_net_io_uring);
+	tcase_set_timeout(tc, 20);
+	suite_add_tcase(suite, tc);
+
 	tc    = tcase_create("event_net_stat");
 	tcase_add_test(tc, check_event_net_stat);
 	tcase_set_timeout(tc, 20);
 	suite_add_tcase(suite, tc);
 
+	tc    = tcase_create("event_net_reuseport");
+	tcase_add_test(tc, check_event_net_reuseport);
+	tcase_set_timeout(tc, 20);
+	suite_add_tcase(suite, tc);
+
 	tc    = tcase_create("event_net_addrinuse");
 	tcase_add_test(tc, check_event_net_addrinuse);
 	tcase_set_timeout(tc, 2);
@@ -181,6 +181,169 @@ END_TEST
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
+#define ORDER_TIMERS 300
+
+typedef struct {
+	M_timeval_t  start;
+	size_t       fired[ORDER_TIMERS];
+	M_uint64     fired_ms[ORDER_TIMERS];
+	size_t       fired_cnt;
+} order_data_t;
+
+typedef struct {
+	order_data_t    *odata;
+	size_t           idx;
+	M_uint64         interval_ms;
+	M_event_timer_t *timer;
+} order_timer_t;
+
+static void order_cb(M_event_t *event, M_event_type_t type, M_io_t *comm, void *data)
+{
+	order_timer_t *ot    = data;
+	order_data_t  *odata = ot->odata;
+	(void)event;
+	(void)type;
+	(void)comm;
+
+	odata->fired[odata->fired_cnt]    = ot->idx;
+	odata->fired_ms[odata->fired_cnt] = M_time_elapsed(&odata->start);
+	odata->fired_cnt++;
+}
+
+START_TEST(check_event_timer_order)
+{
+	M_event_t       *event = M_event_create(M_EVENT_FLAG_NONE);
+	order_data_t     odata;
+	order_timer_t    ots[ORDER_TIMERS];
+	M_event_timer_t *far_timer;
+	size_t           expected = 0;
+	size_t           i;
+
+	M_mem_set(&odata, 0, sizeof(odata));
+
+	/* Intervals cross the first wheel level so some timers are cascaded
+	 * down before they fire. */
+	for (i=0; i<ORDER_TIMERS; i++) {
+		ots[i].odata       = &odata;
+		ots[i].idx         = i;
+		ots[i].interval_ms = (M_uint64)i * 2;
+		ots[i].timer       = M_event_timer_add(event, order_cb, &ots[i]);
+		M_event_timer_set_firecount(ots[i].timer, 1);
+	}
+	far_timer = M_event_timer_add(event, order_cb, &ots[0]);
+
+	M_time_elapsed_start(&odata.start);
+	for (i=0; i<ORDER_TIMERS; i++) {
+		ck_assert(M_event_timer_start(ots[i].timer, ots[i].interval_ms));
+	}
+	ck_assert(M_event_timer_start(far_timer, 2 * 60 * 60 * 1000));
+
+	/* Every 7th is stopped, every 5th is pushed out past the run time, and
+	 * every 3rd is restarted with the same interval. */
+	for (i=0; i<ORDER_TIMERS; i++) {
+		if (i % 7 == 0) {
+			ck_assert(M_event_timer_stop(ots[i].timer));
+		} else if (i % 5 == 0) {
+			ck_assert(M_event_timer_reset(ots[i].timer, 5000));
+		} else if (i % 3 == 0) {
+			ck_assert(M_event_timer_reset(ots[i].timer, 0));
+			ck_assert(M_event_timer_get_interval_ms(ots[i].timer) == ots[i].interval_ms);
+			expected++;
+		} else {
+			expected++;
+		}
+	}
+
+	M_event_loop(event, 1000);
+
+	ck_assert_msg(odata.fired_cnt == expected, "expected %zu timers to fire, got %zu", expected, odata.fired_cnt);
+	for (i=0; i<odata.fired_cnt; i++) {
+		size_t idx = odata.fired[i];
+
+		ck_assert_msg(idx % 7 != 0 && idx % 5 != 0, "stopped timer %zu fired", idx);
+		ck_assert_msg(odata.fired_ms[i] + 1 >= ots[idx].interval_ms, "timer %zu fired early at %llu ms", idx, odata.fired_ms[i]);
+		if (i > 0) {
+			ck_assert_msg(ots[odata.fired[i-1]].interval_ms <= ots[idx].interval_ms, "timer %zu fired before timer %zu", odata.fired[i-1], idx);
+		}
+	}
+
+	ck_assert(M_event_timer_get_status(far_timer));
+	ck_assert(M_event_timer_get_remaining_ms(far_timer) > 60 * 60 * 1000);
+	ck_assert(M_event_timer_get_status(ots[5].timer));
+	ck_assert(!M_event_timer_get_status(ots[7].timer));
+
+	M_event_destroy(event);
+}
+END_TEST
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static void churn_cb(M_event_t *event, M_event_type_t type, M_io_t *comm, void *data)
+{
+	(void)event;
+	(void)type;
+	(void)comm;
+	(void)data;
+}
+
+/* Arm, re-arm, stop and remove a timer per connection the way a server with
+ * read and idle timeouts does. Nothing fires since the loop isn't run. */
+START_TEST(check_event_timer_churn)
+{
+	static const size_t  counts[] = { 10000, 100000, 1000000 };
+	M_event_timer_t    **timers;
+	M_event_t           *event;
+	M_timeval_t          tv;
+	M_uint64             start_ms;
+	M_uint64             reset_ms;
+	M_uint64             stop_ms;
+	M_uint64             remove_ms;
+	size_t               n;
+	size_t               i;
+	size_t               j;
+
+	for (j=0; j<sizeof(counts) / sizeof(*counts); j++) {
+		n      = counts[j];
+		event  = M_event_create(M_EVENT_FLAG_NONE);
+		timers = M_malloc(n * sizeof(*timers));
+		for (i=0; i<n; i++) {
+			timers[i] = M_event_timer_add(event, churn_cb, NULL);
+		}
+
+		M_time_elapsed_start(&tv);
+		for (i=0; i<n; i++) {
+			M_event_timer_start(timers[i], 1000 + ((M_uint64)i * 7919) % 60000);
+		}
+		start_ms = M_time_elapsed(&tv);
+
+		M_time_elapsed_start(&tv);
+		for (i=0; i<n; i++) {
+			M_event_timer_reset(timers[i], 1000 + ((M_uint64)i * 104729) % 60000);
+		}
+		reset_ms = M_time_elapsed(&tv);
+
+		M_time_elapsed_start(&tv);
+		for (i=0; i<n; i++) {
+			M_event_timer_stop(timers[i]);
+		}
+		stop_ms = M_time_elapsed(&tv);
+
+		M_time_elapsed_start(&tv);
+		for (i=0; i<n; i++) {
+			M_event_timer_remove(timers[i]);
+		}
+		remove_ms = M_time_elapsed(&tv);
+
+		M_printf("timer churn %7zu timers: start %5llu ms, reset %5llu ms, stop %5llu ms, remove %5llu ms\n", n, start_ms, reset_ms, stop_ms, remove_ms);
+
+		M_free(timers);
+		M_event_destroy(event);
+	}
+}
+END_TEST
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
 static Suite *event_timer_suite(void)
 {
 	Suite *suite;
@@ -193,6 +356,16 @@ static Suite *event_timer_suite(void)
 	tcase_set_timeout(tc_event_timer, 60);
 	suite_add_tcase(suite, tc_event_timer);
 
+	tc_event_timer = tcase_create("event_timer_order");
+	tcase_add_test(tc_event_timer, check_event_timer_order);
+	tcase_set_timeout(tc_event_timer, 30);
+	suite_add_tcase(suite, tc_event_timer);
+
+	tc_event_timer = tcase_create("event_timer_churn");
+	tcase_add_test(tc_event_timer, check_event_timer_churn);
+	tcase_set_timeout(tc_event_timer, 120);
+	suite_add_tcase(suite, tc_event_timer);
+
 	return suite;
 }
 
@@ -0,0 +1,249 @@
+#include "m_config.h"
+#include <stdlib.h>
+#include <check.h>
+
+#include <mstdlib/mstdlib.h>
+#include <mstdlib/mstdlib_thread.h>
+#include <mstdlib/mstdlib_io.h>
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define UDP_DATAGRAMS 2000
+#define UDP_WINDOW    16
+#define UDP_LEN       64
+
+typedef struct {
+	M_io_t      *server;
+	M_io_t      *client;
+	M_io_meta_t *server_meta;
+	M_io_meta_t *client_meta;
+	size_t       sent;
+	size_t       received;
+	size_t       echoed;
+	size_t       bad_peer;
+	size_t       bad_len;
+	M_bool       done;
+} udp_state_t;
+
+static void udp_fill(unsigned char *buf, size_t seq)
+{
+	size_t i;
+
+	for (i=0; i<UDP_LEN; i++)
+		buf[i] = (unsigned char)(seq + i);
+}
+
+static void udp_client_send(M_event_t *event, udp_state_t *state)
+{
+	unsigned char buf[UDP_LEN];
+	size_t        len;
+
+	(void)event;
+
+	while (state->sent < UDP_DATAGRAMS && state->sent - state->echoed < UDP_WINDOW) {
+		udp_fill(buf, state->sent);
+		if (M_io_write_meta(state->client, buf, sizeof(buf), &len, state->client_meta) != M_IO_ERROR_SUCCESS)
+			break;
+		state->sent++;
+	}
+}
+
+static void udp_server_cb(M_event_t *event, M_event_type_t type, M_io_t *io, void *cb_arg)
+{
+	udp_state_t   *state = cb_arg;
+	unsigned char  buf[UDP_LEN * 2];
+	size_t         len;
+
+	(void)event;
+
+	if (type != M_EVENT_TYPE_READ)
+		return;
+
+	while (M_io_read_meta(io, buf, sizeof(buf), &len, state->server_meta) == M_IO_ERROR_SUCCESS) {
+		state->received++;
+		if (len != UDP_LEN)
+			state->bad_len++;
+		if (!M_str_eq(M_io_udp_meta_get_ipaddr(io, state->server_meta), "127.0.0.1") ||
+			M_io_udp_meta_get_port(io, state->server_meta) != M_io_udp_get_port(state->client))
+			state->bad_peer++;
+
+		/* Reply to whoever sent it */
+		M_io_write_meta(io, buf, len, &len, state->server_meta);
+	}
+}
+
+static void udp_client_cb(M_event_t *event, M_event_type_t type, M_io_t *io, void *cb_arg)
+{
+	udp_state_t   *state = cb_arg;
+	unsigned char  buf[UDP_LEN];
+	unsigned char  expect[UDP_LEN];
+	size_t         len;
+
+	switch (type) {
+		case M_EVENT_TYPE_CONNECTED:
+		case M_EVENT_TYPE_WRITE:
+			udp_client_send(event, state);
+			break;
+		case M_EVENT_TYPE_READ:
+			while (M_io_read_meta(io, buf, sizeof(buf), &len, state->client_meta) == M_IO_ERROR_SUCCESS) {
+				udp_fill(expect, state->echoed);
+				if (len != UDP_LEN || !M_mem_eq(buf, expect, len))
+					state->bad_len++;
+				state->echoed++;
+			}
+			if (state->echoed == UDP_DATAGRAMS) {
+				state->done = M_TRUE;
+				M_event_done(event);
+				break;
+			}
+			udp_client_send(event, state);
+			break;
+		default:
+			M_event_done(event);
+			break;
+	}
+}
+
+START_TEST(check_event_udp_echo)
+{
+	M_event_t    *event = M_event_create(M_EVENT_FLAG_NONE);
+	udp_state_t   state;
+	M_io_t       *io    = NULL;
+	unsigned char buf[UDP_LEN];
+	size_t        len;
+
+	M_mem_set(&state, 0, sizeof(state));
+	state.server_meta = M_io_meta_create();
+	state.client_meta = M_io_meta_create();
+
+	ck_assert(M_io_udp_create(&state.server, 0, "127.0.0.1", M_IO_NET_ANY) == M_IO_ERROR_SUCCESS);
+	ck_assert(M_io_udp_get_port(state.server) != 0);
+	ck_assert(M_io_udp_client_create(&state.client, "127.0.0.1", M_io_udp_get_port(state.server), M_IO_NET_ANY) == M_IO_ERROR_SUCCESS);
+	ck_assert(M_io_udp_get_port(state.client) != 0);
+
+	/* Unconnected socket needs to know where to send */
+	ck_assert(M_io_write(state.server, buf, sizeof(buf), &len) == M_IO_ERROR_INVALID);
+	ck_assert(!M_io_udp_meta_set_peer(state.server, state.server_meta, "not an ip", 1));
+
+	/* Can't bind a port already in use */
+	ck_assert(M_io_udp_create(&io, M_io_udp_get_port(state.server), "127.0.0.1", M_IO_NET_ANY) == M_IO_ERROR_ADDRINUSE);
+
+	ck_assert(M_event_add(event, state.server, udp_server_cb, &state));
+	ck_assert(M_event_add(event, state.client, udp_client_cb, &state));
+	ck_assert(M_event_loop(event, 10000) == M_EVENT_ERR_DONE);
+
+	ck_assert_msg(state.done, "echoed %zu of %zu datagrams", state.echoed, (size_t)UDP_DATAGRAMS);
+	ck_assert_msg(state.received == UDP_DATAGRAMS, "server received %zu datagrams", state.received);
+	ck_assert_msg(state.bad_peer == 0, "%zu datagrams with wrong peer", state.bad_peer);
+	ck_assert_msg(state.bad_len == 0, "%zu datagrams with wrong data", state.bad_len);
+
+	M_io_destroy(state.client);
+	M_io_destroy(state.server);
+	M_io_meta_destroy(state.client_meta);
+	M_io_meta_destroy(state.server_meta);
+	M_event_destroy(event);
+}
+END_TEST
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static size_t udp_dgram_cnt;
+static size_t udp_dgram_bytes;
+
+static void udp_dgram_cb(M_event_t *event, M_event_type_t type, M_io_t *io, void *cb_arg)
+{
+	M_io_meta_t   *meta = cb_arg;
+	unsigned char  buf[4096];
+	size_t         len;
+	size_t         segment_size;
+
+	if (type != M_EVENT_TYPE_READ)
+		return;
+
+	while (M_io_read_meta(io, buf, sizeof(buf), &len, meta) == M_IO_ERROR_SUCCESS) {
+		segment_size = M_io_udp_meta_get_segment_size(io, meta);
+		udp_dgram_cnt   += segment_size?(len + segment_size - 1) / segment_size:1;
+		udp_dgram_bytes += len;
+	}
+
+	if (udp_dgram_bytes >= 1000)
+		M_event_done(event);
+}
+
+/* A write larger than the GSO segment size arrives as multiple datagrams, or
+ * coalesced again into one read with GRO */
+START_TEST(check_event_udp_segment)
+{
+	M_event_t    *event = M_event_create(M_EVENT_FLAG_NONE);
+	M_io_meta_t  *meta  = M_io_meta_create();
+	M_io_t       *server;
+	M_io_t       *client;
+	unsigned char buf[1000];
+	size_t        len;
+
+	ck_assert(M_io_udp_create(&server, 0, "127.0.0.1", M_IO_NET_IPV4) == M_IO_ERROR_SUCCESS);
+	ck_assert(M_io_udp_client_create(&client, "127.0.0.1", M_io_udp_get_port(server), M_IO_NET_IPV4) == M_IO_ERROR_SUCCESS);
+
+	if (!M_io_udp_set_gso(client, 100)) {
+		/* Not supported */
+		goto done;
+	}
+	M_io_udp_set_gro(server, M_TRUE);
+
+	M_mem_set(buf, 'a', sizeof(buf));
+	ck_assert(M_io_write(client, buf, sizeof(buf), &len) == M_IO_ERROR_SUCCESS);
+
+	udp_dgram_cnt   = 0;
+	udp_dgram_bytes = 0;
+	ck_assert(M_event_add(event, server, udp_dgram_cb, meta));
+	ck_assert(M_event_loop(event, 5000) == M_EVENT_ERR_DONE);
+	ck_assert_msg(udp_dgram_bytes == sizeof(buf), "received %zu bytes", udp_dgram_bytes);
+	ck_assert_msg(udp_dgram_cnt == 10, "received %zu datagrams", udp_dgram_cnt);
+
+done:
+	M_io_destroy(client);
+	M_io_destroy(server);
+	M_io_meta_destroy(meta);
+	M_event_destroy(event);
+}
+END_TEST
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static Suite *event_udp_suite(void)
+{
+	Suite *suite;
+	TCase *tc;
+
+	suite = suite_create("event_udp");
+
+	tc    = tcase_create("event_udp_echo");
+	tcase_add_test(tc, check_event_udp_echo);
+	tcase_set_timeout(tc, 20);
+	suite_add_tcase(suite, tc);
+
+	tc    = tcase_create("event_udp_segment");
+	tcase_add_test(tc, check_event_udp_segment);
+	tcase_set_timeout(tc, 10);
+	suite_add_tcase(suite, tc);
+
+	return suite;
+}
+
+int main(int argc, char **argv)
+{
+	SRunner *sr;
+	int      nf;
+
+	(void)argc;
+	(void)argv;
+
+	sr = srunner_create(event_udp_suite());
+	if (getenv("CK_LOG_FILE_NAME")==NULL) srunner_set_log(sr, "check_event_udp.log");
+
+	srunner_run_all(sr, CK_NORMAL);
+	nf = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	return nf == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,488 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2026 Monetra Technologies, LLC.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "m_config.h"
+
+#include <mstdlib/mstdlib_thread.h>
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* Upper bound on the shard count chosen when the caller doesn't specify one. */
+#define M_CACHE_CONCURRENT_MAX_AUTO_SHARDS 256
+/* Automatic sharding won't split the cache into shards smaller than this. Eviction
+ * is per shard and tiny shards would evict far from least recently used order. */
+#define M_CACHE_CONCURRENT_MIN_SHARD_SIZE  64
+
+typedef struct {
+	M_thread_mutex_t *lock;  /*!< Protects cache. Gets update hotness so a mutex is used. */
+	M_cache_t        *cache; /*!< Entries whose key maps to this shard. */
+} M_cache_concurrent_shard_t;
+
+struct M_cache_concurrent {
+	M_cache_concurrent_shard_t *shards;        /*!< Array of shards. */
+	size_t                      num_shards;    /*!< Number of shards. Always a power of 2. */
+	size_t                      max_size;      /*!< Max size across all shards. */
+	size_t                      max_cost;      /*!< Max cost across all shards. */
+	volatile M_uint64           cost;          /*!< Total cost of all shards. */
+	M_hashtable_hash_func       key_hash;      /*!< Hash function used to pick the shard. */
+	M_uint32                    key_hash_seed; /*!< Seed for picking the shard. */
+};
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static M_cache_concurrent_shard_t *M_cache_concurrent_shard(const M_cache_concurrent_t *c, const void *key)
+{
+	M_uint32 hash;
+
+	hash  = c->key_hash(key, c->key_hash_seed);
+	/* Fold the high bits in since only the low bits select the shard. */
+	hash ^= hash >> 16;
+
+	return &c->shards[hash & (c->num_shards - 1)];
+}
+
+/* Split a limit between the shards, rounding up so the total is never less than requested. */
+static size_t M_cache_concurrent_shard_limit(const M_cache_concurrent_t *c, size_t limit)
+{
+	if (limit == 0)
+		return 0;
+	return (limit + c->num_shards - 1) / c->num_shards;
+}
+
+/* Apply the change in a shard's cost since before to the total. Shard must be locked. */
+static void M_cache_concurrent_account(M_cache_concurrent_t *c, const M_cache_concurrent_shard_t *shard, size_t before)
+{
+	size_t after = M_cache_cost(shard->cache);
+
+	if (after > before) {
+		M_atomic_add_u64(&c->cost, after - before);
+	} else if (after < before) {
+		M_atomic_sub_u64(&c->cost, before - after);
+	}
+}
+
+/* Evict the shard's coldest entries until the total is within the max cost, or
+ * only keep is left in the shard. Returns M_TRUE if the total is within the max
+ * cost. Shard must be locked. */
+static M_bool M_cache_concurrent_trim_shard(M_cache_concurrent_t *c, M_cache_concurrent_shard_t *shard, size_t keep)
+{
+	M_uint64 total = M_atomic_add_u64(&c->cost, 0);
+	size_t   before;
+	size_t   excess;
+	size_t   target;
+
+	if (c->max_cost == 0 || total <= c->max_cost)
+		return M_TRUE;
+
+	before = M_cache_cost(shard->cache);
+	if (before <= keep)
+		return M_FALSE;
+
+	excess = (size_t)(total - c->max_cost);
+	target = (before - keep > excess)?before - excess:keep;
+	/* A max cost of 0 is unlimited, so the shard can only be emptied down to a cost of 1. */
+	if (target == 0)
+		target = 1;
+
+	/* Lowering the max cost evicts, then put it back. */
+	M_cache_set_max_cost(shard->cache, target);
+	M_cache_set_max_cost(shard->cache, c->max_cost);
+	M_cache_concurrent_account(c, shard, before);
+
+	return (M_atomic_add_u64(&c->cost, 0) <= c->max_cost)?M_TRUE:M_FALSE;
+}
+
+/* Evict from the other shards while the total is over the max cost. Only one
+ * shard lock is held at a time. */
+static void M_cache_concurrent_trim(M_cache_concurrent_t *c, const M_cache_concurrent_shard_t *skip)
+{
+	size_t i;
+
+	for (i=0; i<c->num_shards; i++) {
+		M_bool done;
+
+		if (&c->shards[i] == skip)
+			continue;
+
+		M_thread_mutex_lock(c->shards[i].lock);
+		done = M_cache_concurrent_trim_shard(c, &c->shards[i], 0);
+		M_thread_mutex_unlock(c->shards[i].lock);
+
+		if (done) {
+			break;
+		}
+	}
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+M_cache_concurrent_t *M_cache_concurrent_create(size_t num_shards, size_t max_size,
+		M_hashtable_hash_func key_hash, M_sort_compar_t key_equality,
+		M_uint32 flags, const struct M_cache_callbacks *callbacks)
+{
+	M_cache_concurrent_t *c;
+	size_t                i;
+
+	if (num_shards == 0) {
+		num_shards = M_size_t_round_up_to_power_of_two(M_thread_num_cpu_cores() * 4);
+		if (num_shards > M_CACHE_CONCURRENT_MAX_AUTO_SHARDS)
+			num_shards = M_CACHE_CONCURRENT_MAX_AUTO_SHARDS;
+		while (num_shards > 1 && max_size / num_shards < M_CACHE_CONCURRENT_MIN_SHARD_SIZE)
+			num_shards /= 2;
+	}
+	num_shards = M_size_t_round_up_to_power_of_two(num_shards);
+
+	if (key_hash == NULL)
+		key_hash = M_hash_func_hash_vp;
+
+	c                = M_malloc_zero(sizeof(*c));
+	c->num_shards    = num_shards;
+	c->max_size      = max_size;
+	c->key_hash      = key_hash;
+	c->key_hash_seed = (M_uint32)M_rand_range(NULL, 1, (M_uint64)(M_UINT32_MAX)+1);
+
+	c->shards = M_malloc_zero(sizeof(*c->shards) * num_shards);
+	for (i=0; i<num_shards; i++) {
+		c->shards[i].lock  = M_thread_mutex_create(M_THREAD_MUTEXATTR_NONE);
+		c->shards[i].cache = M_cache_create(M_cache_concurrent_shard_limit(c, max_size), key_hash, key_equality, flags, callbacks);
+		if (c->shards[i].cache == NULL) {
+			c->num_shards = i+1;
+			M_cache_concurrent_destroy(c);
+			return NULL;
+		}
+	}
+
+	return c;
+}
+
+void M_cache_concurrent_destroy(M_cache_concurrent_t *c)
+{
+	size_t i;
+
+	if (c == NULL)
+		return;
+
+	for (i=0; i<c->num_shards; i++) {
+		M_cache_destroy(c->shards[i].cache);
+		M_thread_mutex_destroy(c->shards[i].lock);
+	}
+
+	M_free(c->shards);
+	M_free(c);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+M_bool M_cache_concurrent_insert(M_cache_concurrent_t *c, const void *key, const void *value)
+{
+	M_cache_concurrent_shard_t *shard;
+	size_t                      before;
+	M_bool                      ret;
+
+	if (c == NULL || key == NULL)
+		return M_FALSE;
+
+	shard = M_cache_concurrent_shard(c, key);
+	M_thread_mutex_lock(shard->lock);
+	before = M_cache_cost(shard->cache);
+	ret    = M_cache_insert(shard->cache, key, value);
+	M_cache_concurrent_account(c, shard, before);
+	M_thread_mutex_unlock(shard->lock);
+
+	return ret;
+}
+
+M_bool M_cache_concurrent_insert_ex(M_cache_concurrent_t *c, const void *key, const void *value, size_t cost, M_uint64 ttl_ms)
+{
+	M_cache_concurrent_shard_t *shard;
+	size_t                      before;
+	M_bool                      ret;
+	M_bool                      done = M_TRUE;
+
+	if (c == NULL || key == NULL)
+		return M_FALSE;
+
+	/* Each shard may use the whole max cost as long as the total stays within
+	 * it. Whatever is over is taken back from the coldest entries of this shard
+	 * first, then the others. */
+	shard = M_cache_concurrent_shard(c, key);
+	M_thread_mutex_lock(shard->lock);
+	before = M_cache_cost(shard->cache);
+	ret    = M_cache_insert_ex(shard->cache, key, value, cost, ttl_ms);
+	M_cache_concurrent_account(c, shard, before);
+	if (ret)
+		done = M_cache_concurrent_trim_shard(c, shard, cost);
+	M_thread_mutex_unlock(shard->lock);
+
+	if (!done)
+		M_cache_concurrent_trim(c, shard);
+
+	return ret;
+}
+
+M_bool M_cache_concurrent_remove(M_cache_concurrent_t *c, const void *key)
+{
+	M_cache_concurrent_shard_t *shard;
+	size_t                      before;
+	M_bool                      ret;
+
+	if (c == NULL || key == NULL)
+		return M_FALSE;
+
+	shard = M_cache_concurrent_shard(c, key);
+	M_thread_mutex_lock(shard->lock);
+	before = M_cache_cost(shard->cache);
+	ret    = M_cache_remove(shard->cache, key);
+	M_cache_concurrent_account(c, shard, before);
+	M_thread_mutex_unlock(shard->lock);
+
+	return ret;
+}
+
+M_bool M_cache_concurrent_get(M_cache_concurrent_t *c, const void *key, void **value)
+{
+	M_cache_concurrent_shard_t *shard;
+	size_t                      before;
+	M_bool                      ret;
+
+	if (value != NULL)
+		*value = NULL;
+
+	if (c == NULL || key == NULL)
+		return M_FALSE;
+
+	/* Expired entries are removed when accessed. */
+	shard = M_cache_concurrent_shard(c, key);
+	M_thread_mutex_lock(shard->lock);
+	before = M_cache_cost(shard->cache);
+	ret    = M_cache_get(shard->cache, key, value);
+	M_cache_concurrent_account(c, shard, before);
+	M_thread_mutex_unlock(shard->lock);
+
+	return ret;
+}
+
+M_bool M_cache_concurrent_get_copy(M_cache_concurrent_t *c, const void *key, M_cache_duplicate_func duplicate, void **value)
+{
+	M_cache_concurrent_shard_t *shard;
+	void                       *myvalue = NULL;
+	size_t                      before;
+	M_bool                      ret;
+
+	if (value != NULL)
+		*value = NULL;
+
+	if (c == NULL || key == NULL || duplicate == NULL || value == NULL)
+		return M_FALSE;
+
+	shard = M_cache_concurrent_shard(c, key);
+	M_thread_mutex_lock(shard->lock);
+	before = M_cache_cost(shard->cache);
+	ret    = M_cache_get(shard->cache, key, &myvalue);
+	M_cache_concurrent_account(c, shard, before);
+	if (ret && myvalue != NULL)
+		*value = duplicate(myvalue);
+	M_thread_mutex_unlock(shard->lock);
+
+	return ret;
+}
+
+size_t M_cache_concurrent_expire(M_cache_concurrent_t *c)
+{
+	size_t cnt = 0;
+	size_t i;
+
+	if (c == NULL)
+		return 0;
+
+	for (i=0; i<c->num_shards; i++) {
+		size_t before;
+
+		M_thread_mutex_lock(c->shards[i].lock);
+		before  = M_cache_cost(c->shards[i].cache);
+		cnt    += M_cache_expire(c->shards[i].cache);
+		M_cache_concurrent_account(c, &c->shards[i], before);
+		M_thread_mutex_unlock(c->shards[i].lock);
+	}
+
+	return cnt;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+size_t M_cache_concurrent_size(M_cache_concurrent_t *c)
+{
+	size_t cnt = 0;
+	size_t i;
+
+	if (c == NULL)
+		return 0;
+
+	for (i=0; i<c->num_shards; i++) {
+		M_thread_mutex_lock(c->shards[i].lock);
+		cnt += M_cache_size(c->shards[i].cache);
+		M_thread_mutex_unlock(c->shards[i].lock);
+	}
+
+	return cnt;
+}
+
+size_t M_cache_concurrent_max_size(const M_cache_concurrent_t *c)
+{
+	if (c == NULL)
+		return 0;
+	return c->max_size;
+}
+
+M_bool M_cache_concurrent_set_max_size(M_cache_concurrent_t *c, size_t max_size)
+{
+	size_t shard_max;
+	size_t i;
+
+	if (c == NULL)
+		return M_FALSE;
+
+	c->max_size = max_size;
+	shard_max   = M_cache_concurrent_shard_limit(c, max_size);
+	for (i=0; i<c->num_shards; i++) {
+		size_t before;
+
+		M_thread_mutex_lock(c->shards[i].lock);
+		before = M_cache_cost(c->shards[i].cache);
+		M_cache_set_max_size(c->shards[i].cache, shard_max);
+		M_cache_concurrent_account(c, &c->shards[i], before);
+		M_thread_mutex_unlock(c->shards[i].lock);
+	}
+
+	return M_TRUE;
+}
+
+size_t M_cache_concurrent_cost(M_cache_concurrent_t *c)
+{
+	size_t cost = 0;
+	size_t i;
+
+	if (c == NULL)
+		return 0;
+
+	for (i=0; i<c->num_shards; i++) {
+		M_thread_mutex_lock(c->shards[i].lock);
+		cost += M_cache_cost(c->shards[i].cache);
+		M_thread_mutex_unlock(c->shards[i].lock);
+	}
+
+	return cost;
+}
+
+size_t M_cache_concurrent_max_cost(const M_cache_concurrent_t *c)
+{
+	if (c == NULL)
+		return 0;
+	return c->max_cost;
+}
+
+M_bool M_cache_concurrent_set_max_cost(M_cache_concurrent_t *c, size_t max_cost)
+{
+	size_t i;
+
+	if (c == NULL)
+		return M_FALSE;
+
+	/* Shards aren't limited to a share of the max cost, an entry only has to
+	 * fit in the whole cache. */
+	c->max_cost = max_cost;
+	for (i=0; i<c->num_shards; i++) {
+		size_t before;
+
+		M_thread_mutex_lock(c->shards[i].lock);
+		before = M_cache_cost(c->shards[i].cache);
+		M_cache_set_max_cost(c->shards[i].cache, max_cost);
+		M_cache_concurrent_account(c, &c->shards[i], before);
+		M_thread_mutex_unlock(c->shards[i].lock);
+	}
+
+	M_cache_concurrent_trim(c, NULL);
+
+	return M_TRUE;
+}
+
+void M_cache_concurrent_set_default_ttl(M_cache_concurrent_t *c, M_uint64 ttl_ms)
+{
+	size_t i;
+
+	if (c == NULL)
+		return;
+
+	for (i=0; i<c->num_shards; i++) {
+		M_thread_mutex_lock(c->shards[i].lock);
+		M_cache_set_default_ttl(c->shards[i].cache, ttl_ms);
+		M_thread_mutex_unlock(c->shards[i].lock);
+	}
+}
+
+size_t M_cache_concurrent_num_shards(const M_cache_concurrent_t *c)
+{
+	if (c == NULL)
+		return 0;
+	return c->num_shards;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+void M_cache_concurrent_stats(M_cache_concurrent_t *c, M_cache_stats_t *stats)
+{
+	M_cache_stats_t shard_stats;
+	size_t          i;
+
+	if (stats == NULL)
+		return;
+
+	M_mem_set(stats, 0, sizeof(*stats));
+	if (c == NULL)
+		return;
+
+	for (i=0; i<c->num_shards; i++) {
+		M_thread_mutex_lock(c->shards[i].lock);
+		M_cache_stats(c->shards[i].cache, &shard_stats);
+		M_thread_mutex_unlock(c->shards[i].lock);
+
+		stats->hits        += shard_stats.hits;
+		stats->misses      += shard_stats.misses;
+		stats->evictions   += shard_stats.evictions;
+		stats->expirations += shard_stats.expirations;
+	}
+}
+
+void M_cache_concurrent_stats_reset(M_cache_concurrent_t *c)
+{
+	size_t i;
+
+	if (c == NULL)
+		return;
+
+	for (i=0; i<c->num_shards; i++) {
+		M_thread_mutex_lock(c->shards[i].lock);
+		M_cache_stats_reset(c->shards[i].cache);
+		M_thread_mutex_unlock(c->shards[i].lock);
+	}
+}
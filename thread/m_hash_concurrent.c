@@ -0,0 +1,273 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2026 Monetra Technologies, LLC.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "m_config.h"
+
+#include <mstdlib/mstdlib_thread.h>
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* Upper bound on the shard count chosen when the caller doesn't specify one. */
+#define M_HASH_CONCURRENT_MAX_AUTO_SHARDS 256
+
+typedef struct {
+	M_thread_rwlock_t *lock;  /*!< Protects table. */
+	M_hashtable_t     *table; /*!< Entries whose key maps to this shard. */
+} M_hash_concurrent_shard_t;
+
+struct M_hash_concurrent {
+	M_hash_concurrent_shard_t  *shards;               /*!< Array of shards. */
+	size_t                      num_shards;           /*!< Number of shards. Always a power of 2. */
+	M_hashtable_hash_func       key_hash;             /*!< Hash function used to pick the shard. */
+	M_uint32                    key_hash_seed;        /*!< Seed for picking the shard. Different from the
+	                                                       seeds used by the shards so the shard and
+	                                                       bucket index are independent. */
+	M_hashtable_duplicate_func  value_duplicate_copy; /*!< Used by get_copy. NULL returns the value directly. */
+};
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static M_hash_concurrent_shard_t *M_hash_concurrent_shard(const M_hash_concurrent_t *h, const void *key)
+{
+	M_uint32 hash;
+
+	hash  = h->key_hash(key, h->key_hash_seed);
+	/* Fold the high bits in since only the low bits select the shard. */
+	hash ^= hash >> 16;
+
+	return &h->shards[hash & (h->num_shards - 1)];
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+M_hash_concurrent_t *M_hash_concurrent_create(size_t num_shards, size_t size, M_uint8 fillpct,
+		M_hashtable_hash_func key_hash, M_sort_compar_t key_equality,
+		M_uint32 flags, const struct M_hashtable_callbacks *callbacks)
+{
+	M_hash_concurrent_t *h;
+	size_t               shard_size;
+	size_t               i;
+
+	if (size == 0 || fillpct >= 100)
+		return NULL;
+
+	/* A key order would only be per shard which isn't useful. */
+	if (flags & (M_HASHTABLE_KEYS_ORDERED|M_HASHTABLE_KEYS_SORTED))
+		return NULL;
+
+	if (num_shards == 0) {
+		num_shards = M_thread_num_cpu_cores() * 4;
+		if (num_shards > M_HASH_CONCURRENT_MAX_AUTO_SHARDS) {
+			num_shards = M_HASH_CONCURRENT_MAX_AUTO_SHARDS;
+		}
+	}
+	num_shards = M_size_t_round_up_to_power_of_two(num_shards);
+
+	/* Spread the requested size across the shards. */
+	size       = M_size_t_round_up_to_power_of_two(size);
+	shard_size = size / num_shards;
+	if (shard_size == 0)
+		shard_size = 1;
+
+	if (key_hash == NULL)
+		key_hash = M_hash_func_hash_vp;
+
+	h                = M_malloc_zero(sizeof(*h));
+	h->num_shards    = num_shards;
+	h->key_hash      = key_hash;
+	h->key_hash_seed = (M_uint32)M_rand_range(NULL, 1, (M_uint64)(M_UINT32_MAX)+1);
+	if (callbacks != NULL)
+		h->value_duplicate_copy = callbacks->value_duplicate_copy;
+
+	h->shards = M_malloc_zero(sizeof(*h->shards) * num_shards);
+	for (i=0; i<num_shards; i++) {
+		h->shards[i].lock  = M_thread_rwlock_create();
+		h->shards[i].table = M_hashtable_create(shard_size, fillpct, key_hash, key_equality, flags, callbacks);
+		if (h->shards[i].table == NULL) {
+			h->num_shards = i+1;
+			M_hash_concurrent_destroy(h, M_TRUE);
+			return NULL;
+		}
+	}
+
+	return h;
+}
+
+void M_hash_concurrent_destroy(M_hash_concurrent_t *h, M_bool destroy_vals)
+{
+	size_t i;
+
+	if (h == NULL)
+		return;
+
+	for (i=0; i<h->num_shards; i++) {
+		M_hashtable_destroy(h->shards[i].table, destroy_vals);
+		M_thread_rwlock_destroy(h->shards[i].lock);
+	}
+
+	M_free(h->shards);
+	M_free(h);
+}
+
+M_bool M_hash_concurrent_insert(M_hash_concurrent_t *h, const void *key, const void *value)
+{
+	M_hash_concurrent_shard_t *shard;
+	M_bool                     ret;
+
+	if (h == NULL)
+		return M_FALSE;
+
+	shard = M_hash_concurrent_shard(h, key);
+	M_thread_rwlock_lock(shard->lock, M_THREAD_RWLOCK_TYPE_WRITE);
+	ret = M_hashtable_insert(shard->table, key, value);
+	M_thread_rwlock_unlock(shard->lock);
+
+	return ret;
+}
+
+M_bool M_hash_concurrent_insert_unique(M_hash_concurrent_t *h, const void *key, const void *value)
+{
+	M_hash_concurrent_shard_t *shard;
+	M_bool                     ret = M_FALSE;
+
+	if (h == NULL)
+		return M_FALSE;
+
+	shard = M_hash_concurrent_shard(h, key);
+	M_thread_rwlock_lock(shard->lock, M_THREAD_RWLOCK_TYPE_WRITE);
+	if (!M_hashtable_get(shard->table, key, NULL))
+		ret = M_hashtable_insert(shard->table, key, value);
+	M_thread_rwlock_unlock(shard->lock);
+
+	return ret;
+}
+
+M_bool M_hash_concurrent_remove(M_hash_concurrent_t *h, const void *key, M_bool destroy_vals)
+{
+	M_hash_concurrent_shard_t *shard;
+	M_bool                     ret;
+
+	if (h == NULL)
+		return M_FALSE;
+
+	shard = M_hash_concurrent_shard(h, key);
+	M_thread_rwlock_lock(shard->lock, M_THREAD_RWLOCK_TYPE_WRITE);
+	ret = M_hashtable_remove(shard->table, key, destroy_vals);
+	M_thread_rwlock_unlock(shard->lock);
+
+	return ret;
+}
+
+M_bool M_hash_concurrent_get(const M_hash_concurrent_t *h, const void *key, void **value)
+{
+	M_hash_concurrent_shard_t *shard;
+	M_bool                     ret;
+
+	if (value != NULL)
+		*value = NULL;
+
+	if (h == NULL)
+		return M_FALSE;
+
+	shard = M_hash_concurrent_shard(h, key);
+	M_thread_rwlock_lock(shard->lock, M_THREAD_RWLOCK_TYPE_READ);
+	ret = M_hashtable_get(shard->table, key, value);
+	M_thread_rwlock_unlock(shard->lock);
+
+	return ret;
+}
+
+M_bool M_hash_concurrent_get_copy(const M_hash_concurrent_t *h, const void *key, void **value)
+{
+	M_hash_concurrent_shard_t *shard;
+	void                      *myvalue = NULL;
+	M_bool                     ret;
+
+	if (value != NULL)
+		*value = NULL;
+
+	if (h == NULL || value == NULL)
+		return M_FALSE;
+
+	shard = M_hash_concurrent_shard(h, key);
+	M_thread_rwlock_lock(shard->lock, M_THREAD_RWLOCK_TYPE_READ);
+	ret = M_hashtable_get(shard->table, key, &myvalue);
+	if (ret && myvalue != NULL && h->value_duplicate_copy != NULL)
+		myvalue = h->value_duplicate_copy(myvalue);
+	M_thread_rwlock_unlock(shard->lock);
+
+	*value = myvalue;
+	return ret;
+}
+
+size_t M_hash_concurrent_foreach(const M_hash_concurrent_t *h, M_hash_concurrent_foreach_cb cb, void *thunk)
+{
+	M_hashtable_enum_t  hashenum;
+	const void         *key;
+	const void         *value;
+	size_t              cnt  = 0;
+	M_bool              stop = M_FALSE;
+	size_t              i;
+
+	if (h == NULL || cb == NULL)
+		return 0;
+
+	for (i=0; i<h->num_shards && !stop; i++) {
+		M_thread_rwlock_lock(h->shards[i].lock, M_THREAD_RWLOCK_TYPE_READ);
+		M_hashtable_enumerate(h->shards[i].table, &hashenum);
+		while (M_hashtable_enumerate_next(h->shards[i].table, &hashenum, &key, &value)) {
+			cnt++;
+			if (!cb(key, value, thunk)) {
+				stop = M_TRUE;
+				break;
+			}
+		}
+		M_thread_rwlock_unlock(h->shards[i].lock);
+	}
+
+	return cnt;
+}
+
+size_t M_hash_concurrent_num_keys(const M_hash_concurrent_t *h)
+{
+	size_t cnt = 0;
+	size_t i;
+
+	if (h == NULL)
+		return 0;
+
+	for (i=0; i<h->num_shards; i++) {
+		M_thread_rwlock_lock(h->shards[i].lock, M_THREAD_RWLOCK_TYPE_READ);
+		cnt += M_hashtable_num_keys(h->shards[i].table);
+		M_thread_rwlock_unlock(h->shards[i].lock);
+	}
+
+	return cnt;
+}
+
+size_t M_hash_concurrent_num_shards(const M_hash_concurrent_t *h)
+{
+	if (h == NULL)
+		return 0;
+	return h->num_shards;
+}
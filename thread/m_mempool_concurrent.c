@@ -0,0 +1,236 @@
+/* The MIT License (MIT)
+ * 
+ * Copyright (c) 2026 Monetra Technologies, LLC.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "m_config.h"
+
+#include <mstdlib/mstdlib_thread.h>
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* Bounds on the cache count. */
+#define M_MEMPOOL_CONCURRENT_MIN_CACHES 8
+#define M_MEMPOOL_CONCURRENT_MAX_CACHES 64
+
+/* Bytes worth of objects each cache holds when the caller doesn't specify a size. */
+#define M_MEMPOOL_CONCURRENT_CACHE_BYTES 16384
+
+typedef struct {
+	volatile M_uint32   busy; /*!< 1 while a thread is using the cache. Protects objs and cnt. */
+	void              **objs; /*!< Zeroed objects ready to be handed out. */
+	size_t              cnt;  /*!< Number of objects in objs. */
+} M_mempool_concurrent_cache_t;
+
+struct M_mempool_concurrent {
+	M_thread_mutex_t             *depot_lock; /*!< Protects depot. */
+	M_mempool_t                  *depot;      /*!< Backing pool all objects come from. */
+	M_mempool_concurrent_cache_t *caches;     /*!< Thread caches. */
+	size_t                        num_caches; /*!< Number of caches. Always a power of 2. */
+	size_t                        cache_size; /*!< Maximum objects per cache. */
+	size_t                        obj_size;   /*!< Object size from the depot. */
+};
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+/* Claim a cache for the calling thread. A cache is only held for a few
+ * pointer operations so a mutex is more overhead than it's worth. If the
+ * thread's cache is in use by a thread that hashed to the same slot the
+ * next one is tried instead of waiting. */
+static M_mempool_concurrent_cache_t *M_mempool_concurrent_cache_acquire(M_mempool_concurrent_t *pool)
+{
+	M_uint64 id = (M_uint64)M_thread_self();
+	size_t   idx;
+	size_t   i;
+
+	/* Thread ids are often pointers or sequential so mix all bits into the
+	 * high bits and use those. */
+	id *= 0x9E3779B97F4A7C15ULL;
+	id ^= id >> 32;
+	idx = (size_t)(id >> 16);
+
+	while (1) {
+		for (i=0; i<pool->num_caches; i++) {
+			M_mempool_concurrent_cache_t *cache = &pool->caches[(idx + i) & (pool->num_caches - 1)];
+			if (cache->busy == 0 && M_atomic_cas32(&cache->busy, 0, 1)) {
+				return cache;
+			}
+		}
+		M_thread_yield(M_TRUE);
+	}
+}
+
+static void M_mempool_concurrent_cache_release(M_mempool_concurrent_cache_t *cache)
+{
+	M_atomic_cas32(&cache->busy, 1, 0);
+}
+
+/* Move up to half a cache worth of objects from the depot into cache. */
+static void M_mempool_concurrent_refill(M_mempool_concurrent_t *pool, M_mempool_concurrent_cache_t *cache)
+{
+	size_t batch = pool->cache_size / 2;
+
+	if (batch == 0)
+		batch = 1;
+
+	M_thread_mutex_lock(pool->depot_lock);
+	while (cache->cnt < batch) {
+		cache->objs[cache->cnt++] = M_mempool_alloc(pool->depot);
+	}
+	M_thread_mutex_unlock(pool->depot_lock);
+}
+
+/* Move half of a full cache back to the depot. */
+static void M_mempool_concurrent_flush(M_mempool_concurrent_t *pool, M_mempool_concurrent_cache_t *cache)
+{
+	size_t keep = pool->cache_size / 2;
+
+	M_thread_mutex_lock(pool->depot_lock);
+	while (cache->cnt > keep) {
+		M_mempool_free(pool->depot, cache->objs[--cache->cnt]);
+	}
+	M_thread_mutex_unlock(pool->depot_lock);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+M_mempool_concurrent_t *M_mempool_concurrent_create(size_t obj_size, size_t cache_size)
+{
+	M_mempool_concurrent_t *pool;
+	M_mempool_t            *depot;
+	size_t                  num_caches;
+	size_t                  i;
+
+	depot = M_mempool_create(obj_size, 0);
+	if (depot == NULL)
+		return NULL;
+
+	if (cache_size == 0)
+		cache_size = M_MAX(M_MEMPOOL_CONCURRENT_CACHE_BYTES / M_mempool_obj_size(depot), 16);
+
+	/* Threads outnumber cores so more caches than cores keeps threads that
+	 * were preempted while holding a cache from blocking others. */
+	num_caches = M_MAX(M_thread_num_cpu_cores() * 2, M_MEMPOOL_CONCURRENT_MIN_CACHES);
+	if (num_caches > M_MEMPOOL_CONCURRENT_MAX_CACHES)
+		num_caches = M_MEMPOOL_CONCURRENT_MAX_CACHES;
+	num_caches = M_size_t_round_up_to_power_of_two(num_caches);
+
+	pool             = M_malloc_zero(sizeof(*pool));
+	pool->depot_lock = M_thread_mutex_create(M_THREAD_MUTEXATTR_NONE);
+	pool->depot      = depot;
+	pool->num_caches = num_caches;
+	pool->cache_size = cache_size;
+	pool->obj_size   = M_mempool_obj_size(depot);
+
+	pool->caches = M_malloc_zero(sizeof(*pool->caches) * num_caches);
+	for (i=0; i<num_caches; i++) {
+		pool->caches[i].objs = M_malloc_zero(sizeof(*pool->caches[i].objs) * cache_size);
+	}
+
+	return pool;
+}
+
+void M_mempool_concurrent_destroy(M_mempool_concurrent_t *pool)
+{
+	size_t i;
+
+	if (pool == NULL)
+		return;
+
+	/* Cached objects belong to the depot's slabs so they go with it. */
+	for (i=0; i<pool->num_caches; i++) {
+		M_free(pool->caches[i].objs);
+	}
+	M_free(pool->caches);
+
+	M_mempool_destroy(pool->depot);
+	M_thread_mutex_destroy(pool->depot_lock);
+	M_free(pool);
+}
+
+void *M_mempool_concurrent_alloc(M_mempool_concurrent_t *pool)
+{
+	M_mempool_concurrent_cache_t *cache;
+	void                         *obj;
+
+	if (pool == NULL)
+		return NULL;
+
+	cache = M_mempool_concurrent_cache_acquire(pool);
+	if (cache->cnt == 0)
+		M_mempool_concurrent_refill(pool, cache);
+	obj = cache->objs[--cache->cnt];
+	M_mempool_concurrent_cache_release(cache);
+
+	return obj;
+}
+
+void M_mempool_concurrent_free(M_mempool_concurrent_t *pool, void *obj)
+{
+	M_mempool_concurrent_cache_t *cache;
+
+	if (pool == NULL || obj == NULL)
+		return;
+
+	/* Clear outside of any lock. Cached objects are always zeroed. */
+	M_mem_set(obj, 0, pool->obj_size);
+
+	cache = M_mempool_concurrent_cache_acquire(pool);
+	if (cache->cnt == pool->cache_size)
+		M_mempool_concurrent_flush(pool, cache);
+	cache->objs[cache->cnt++] = obj;
+	M_mempool_concurrent_cache_release(cache);
+}
+
+size_t M_mempool_concurrent_num_used(M_mempool_concurrent_t *pool)
+{
+	size_t cached = 0;
+	size_t used;
+	size_t i;
+
+	if (pool == NULL)
+		return 0;
+
+	/* Always cache then depot, the same order as alloc and free. */
+	for (i=0; i<pool->num_caches; i++) {
+		while (!M_atomic_cas32(&pool->caches[i].busy, 0, 1)) {
+			M_thread_yield(M_TRUE);
+		}
+	}
+
+	M_thread_mutex_lock(pool->depot_lock);
+	used = M_mempool_num_used(pool->depot);
+	M_thread_mutex_unlock(pool->depot_lock);
+
+	for (i=0; i<pool->num_caches; i++) {
+		cached += pool->caches[i].cnt;
+		M_mempool_concurrent_cache_release(&pool->caches[i]);
+	}
+
+	return used - cached;
+}
+
+size_t M_mempool_concurrent_num_caches(const M_mempool_concurrent_t *pool)
+{
+	if (pool == NULL)
+		return 0;
+	return pool->num_caches;
+}